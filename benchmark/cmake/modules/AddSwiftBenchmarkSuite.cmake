@@ -49,7 +49,8 @@ function (swift_benchmark_compile_archopts)
       "-${BENCH_COMPILE_ARCHOPTS_OPT}"
       "-D" "INTERNAL_CHECKS_ENABLED"
       "-no-link-objc-runtime"
-      "-I" "${srcdir}/utils/ObjectiveCTests")
+      "-I" "${srcdir}/utils/ObjectiveCTests"
+      "-I" "${srcdir}/utils/PerfCounters")
 
   # Always optimize the driver modules.
   # Note that we compile the driver for Ounchecked also with -Ounchecked
@@ -63,7 +64,8 @@ function (swift_benchmark_compile_archopts)
       "-F" "${sdk}/../../../Developer/Library/Frameworks"
       "-${driver_opt}"
       "-D" "INTERNAL_CHECKS_ENABLED"
-      "-no-link-objc-runtime")
+      "-no-link-objc-runtime"
+      "-I" "${srcdir}/utils/PerfCounters")
 
   set(bench_library_objects)
   set(bench_library_sibfiles)
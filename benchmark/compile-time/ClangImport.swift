@@ -0,0 +1,39 @@
+//===--- ClangImport.swift ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Importing a large Clang module and type checking uses of its declarations,
+// which measures the Clang importer and name lookup into imported modules.
+
+#if os(OSX) || os(iOS) || os(watchOS) || os(tvOS)
+import Foundation
+
+public func useImportedDeclarations() -> Int {
+  let string = NSString(string: "compile time")
+  let array = NSArray(array: [string, string])
+  let date = NSDate(timeIntervalSinceReferenceDate: 0)
+  return string.length + array.count
+    + Int(date.timeIntervalSinceReferenceDate)
+    + Int(strlen("compile time"))
+}
+#else
+import Glibc
+
+public func useImportedDeclarations() -> Int {
+  var buffer = [Int8](repeating: 0x41, count: 64)
+  buffer[63] = 0
+  let length = strlen(buffer)
+  var time = timespec()
+  clock_gettime(CLOCK_MONOTONIC, &time)
+  return Int(length) + Int(time.tv_sec % 2) + Int(sqrt(Double(16)))
+    + Int(getpid() % 2)
+}
+#endif
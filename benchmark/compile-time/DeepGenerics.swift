@@ -0,0 +1,92 @@
+//===--- DeepGenerics.swift -----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Deeply nested generic types, protocols with associated types and chains of
+// lazy collection adaptors, which stress generic signature building, type
+// substitution and, with optimization, specialization.
+
+public protocol Container {
+  associatedtype Content
+  var content: Content { get }
+}
+
+public struct Box<T> : Container {
+  public var content: T
+  public init(_ content: T) { self.content = content }
+}
+
+public struct Pair<First : Container, Second : Container> : Container {
+  public var first: First
+  public var second: Second
+  public init(_ first: First, _ second: Second) {
+    self.first = first
+    self.second = second
+  }
+  public var content: (First.Content, Second.Content) {
+    return (first.content, second.content)
+  }
+}
+
+public func box<T>(_ x: T) -> Box<T> {
+  return Box(x)
+}
+
+public func pair<A : Container, B : Container>(_ a: A, _ b: B) -> Pair<A, B> {
+  return Pair(a, b)
+}
+
+public typealias Box4<T> = Box<Box<Box<Box<T>>>>
+
+public func nest4<T>(_ x: T) -> Box4<T> {
+  return box(box(box(box(x))))
+}
+
+public func nest16<T>(_ x: T) -> Box4<Box4<Box4<Box4<T>>>> {
+  return nest4(nest4(nest4(nest4(x))))
+}
+
+public func deepPairs<T>(_ x: T)
+    -> Pair<Pair<Pair<Box<T>, Box<T>>, Pair<Box<T>, Box<T>>>,
+            Pair<Pair<Box<T>, Box<T>>, Pair<Box<T>, Box<T>>>> {
+  let b = box(x)
+  let p = pair(b, b)
+  let q = pair(p, p)
+  return pair(q, q)
+}
+
+public func lazyChain<C : Collection>(_ c: C) -> Int
+    where C.Iterator.Element == Int {
+  return c.lazy
+    .map { $0 &* 3 }
+    .filter { $0 % 2 == 0 }
+    .map { $0 &+ 1 }
+    .filter { $0 % 3 != 0 }
+    .map { $0 &- 7 }
+    .reduce(0, combine: &+)
+}
+
+public func nestedCollections() -> Int {
+  let arrays = (0..<10).map { i in (0..<i).map { [$0, $0 + 1] } }
+  let flattened = arrays.joined().joined()
+  let zipped = zip(flattened, flattened.reversed())
+  return zipped.map { $0 &* $1 }.reduce(0, combine: &+)
+    &+ lazyChain(Array(flattened))
+    &+ lazyChain(0..<100)
+    &+ lazyChain(Set(flattened))
+}
+
+public func useAll() -> Int {
+  let n = nest16(1).content.content.content.content.content.content.content
+    .content.content.content.content.content.content.content.content.content
+  let p = deepPairs("x").content
+  return n &+ p.0.0.0.characters.count &+ nestedCollections()
+}
@@ -0,0 +1,238 @@
+//===--- LiteralExpressions.swift -----------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Type checking of expressions made of untyped literals and overloaded
+// operators, which is dominated by the constraint solver.
+
+let value0: Double = 11.6 - 21 + 27 + 12 + 30 * 2
+let value1: Double = 14 + 19 - 8 - 19.9 + 19 * 8
+let value2: Double = 4 * 18.2 + 4 - 21 * 4 * 3
+let value3: Double = 14.7 - 19.5 * 10 - 6 - 8 * 10
+let value4: Double = 3 - 14 - 11 * 16 - 22 * 18
+let value5: Double = 19.1 * 27 - 9 * 22 - 24.9 + 22.4
+let value6: Double = 15 + 20 - 2 - 10 * 8 - 30.1
+let value7: Double = 29 + 14.4 * 23 + 12 + 13.2 - 3
+let value8: Double = 27 * 9 + 5 - 12 * 11.8 * 20
+let value9: Float = 13 + 13 + 21 + 7 * 7 + 4
+let value10: Double = 4.9 - 1 - 7 - 5 - 12 - 16
+let value11: Float = 3 * 24 * 9 + 23 * 1 - 17
+let value12: Double = 28 + 28 + 12.5 - 25 * 18.5 + 21
+let value13: Double = 7 - 12.0 + 26 + 9 + 20.7 + 26.5
+let value14: Double = 16 * 7 + 29 - 1 * 21 + 21
+let value15: Double = 29 * 26 - 3.6 * 15 + 3.2 * 5
+let value16: Double = 27 - 16 + 12 + 18 + 1.1 - 17.2
+let value17: Double = 7 * 8.5 - 9 * 27 + 30.7 * 22
+let value18: Double = 5 + 1.2 - 20 * 26 * 5 * 24
+let value19: Float = 18 + 25 - 18 - 7 * 25 * 15
+let value20: Double = 17 + 9 - 18.8 + 8 - 29.4 + 30
+let value21: Double = 13 - 3 + 14 - 22 + 4.2 - 23
+let value22: Double = 8.1 - 13.2 + 22.2 * 23 - 17 + 14
+let value23: Double = 11 + 15.6 - 11 - 10 + 3 + 30.1
+let value24: Double = 9.6 * 28.4 + 13 - 30 + 16.1 - 9
+let value25: Double = 1 - 26 * 20.1 + 9.7 + 1 * 18
+let value26: Double = 23 * 4.4 * 2 + 30 - 10 - 7
+let value27: Double = 26 * 9 - 1.8 * 7 - 8.1 * 22.6
+let value28: Double = 10 - 8 - 27.2 + 13.0 + 27 + 3
+let value29: Double = 22.8 - 22.9 * 8 - 2 + 6 + 1
+let value30: Double = 29 - 12 + 11 + 16 - 21 * 17.1
+let value31: Double = 2 + 10 - 8 * 17.2 * 22.9 * 13.7
+let value32: Double = 5 + 27.8 * 21 * 23.2 * 30 * 17
+let value33: Int = 23 * 3 * 5 + 4 - 15 - 21
+let value34: Double = 15.8 + 29 + 22 * 24.4 * 26 - 9
+let value35: Double = 16.1 * 16.4 * 25 - 21 * 3 * 11
+let value36: Double = 5 + 2 * 22 + 7 - 10.4 + 15
+let value37: Double = 30 + 10 * 27 * 15.6 - 7.3 - 3
+let value38: Double = 5 - 21 * 29 - 12 - 29.6 - 1
+let value39: Double = 24 * 12 - 4.0 - 11.6 - 4.3 + 23
+let value40: Double = 13 + 28 + 12.4 - 28 - 4 * 22
+let value41: Double = 11 + 12.6 + 29 * 25 - 30.8 - 18
+let value42: Double = 20.4 - 16 * 30 + 6 - 11 - 9.4
+let value43: Double = 18 - 4 - 6 + 17.7 * 18 + 30
+let value44: Double = 8 - 11 * 11 * 9.3 + 29 - 28
+let value45: Double = 9 + 2 - 19.2 - 22 * 21.3 - 3
+let value46: Double = 14.0 - 5 - 23.7 + 19 + 3 + 30.8
+let value47: Double = 5 + 22 * 27.7 * 3 - 2 + 5
+let value48: Double = 21 * 21 + 25 + 3 * 19 - 9
+let value49: Double = 9.3 + 16 - 18 + 14.4 * 2 - 16.6
+let value50: Double = 30 + 16 - 11.5 + 22 + 1.8 - 3
+let value51: Double = 8 - 29 + 20 + 6.7 + 14.0 * 20
+let value52: Double = 5 * 23 * 13 - 23.1 + 3.5 - 7
+let value53: Double = 22.5 - 11 - 4 - 9 - 14.1 + 18.3
+let value54: Double = 2.3 + 12 - 15 + 12.7 - 1 + 8.6
+let value55: Double = 26.4 - 7.9 - 11 + 11.9 * 2 * 23
+let value56: Double = 30.1 + 1.1 * 16.7 - 25 * 9.7 + 5.2
+let value57: Double = 20 + 28 - 12.9 * 3 * 13.3 - 14
+let value58: Double = 6.1 - 3 * 3 * 14 + 23.2 * 8
+let value59: Double = 18.1 + 25.4 + 9 - 12 * 9 + 8
+let value60: Double = 11 + 9.8 - 17 - 26 + 15.1 - 1
+let value61: Double = 8 * 7 + 27 + 30 * 17.7 * 20
+let value62: Double = 23 - 7 - 11 * 7.0 - 20.3 + 27
+let value63: Float = 20 * 7 + 16 * 3 + 26 - 18
+let value64: Double = 9 * 10 + 14.4 - 24 * 12 - 1.5
+let value65: Double = 7.6 + 29 * 4.6 - 19.7 + 25 * 1
+let value66: Double = 20.8 - 6 + 10 + 6.1 - 13 - 26.3
+let value67: Double = 2 - 21 + 29.2 * 21.3 + 20 + 28
+let value68: Double = 13.2 - 13 * 5 - 24.3 * 2.0 * 22.1
+let value69: Double = 25 - 14 - 8 + 22 - 17 * 1
+let value70: Double = 27 + 16 * 3 + 14 + 26 * 17
+let value71: Double = 25.1 - 2.6 - 21.2 + 1.9 * 24 * 4
+let value72: Double = 30 - 27 + 25 * 11.4 - 29.2 * 9
+let value73: Double = 17 * 12 + 6 * 21.5 - 29 - 26.1
+let value74: Double = 18 + 23.1 - 9.6 + 24.4 + 13.9 * 5
+let value75: Double = 24.4 + 27 - 10 * 28 * 22.0 - 24
+let value76: Float = 14 * 29 - 16 * 21 + 2 - 12
+let value77: Double = 10 + 7 * 27 + 5 * 26 - 5
+let value78: Int = 26 - 1 + 27 + 12 + 19 + 30
+let value79: Double = 18 * 6 * 2.1 * 1 * 22.2 * 14
+let value80: Double = 14.2 + 17 * 10 * 29.7 - 23 + 13.7
+let value81: Double = 8.4 - 8 * 4 * 24.4 - 23 - 21
+let value82: Double = 21.3 * 3.0 + 6 - 8.3 * 6.5 * 7.5
+let value83: Double = 22.8 + 16 - 17 * 28 * 24 + 29
+let value84: Double = 19.2 * 2 * 4 + 6 * 5.0 + 2
+let value85: Double = 24 + 28 + 12 + 27 + 22 + 28.6
+let value86: Double = 2 - 28.1 - 27.4 + 16 - 4.3 - 10
+let value87: Double = 30 * 23.5 + 25.8 - 16.9 - 24 * 14
+let value88: Double = 2 - 7.1 - 19.2 + 14 - 7 * 25.0
+let value89: Double = 26.7 + 19 + 27 * 19.4 + 27 - 23
+let value90: Double = 26.8 - 26 - 11 * 13.1 * 14.0 + 12
+let value91: Double = 13.3 * 15 * 20.9 * 21 - 19 + 5.7
+let value92: Int = 15 * 25 * 8 + 15 * 23 + 7
+let value93: Double = 24 - 17 + 8 + 7 - 24.2 * 22
+let value94: Double = 10 * 7 * 30 - 7.7 - 2 + 28.3
+let value95: Float = 5 + 24 * 24 * 28 * 19 * 21
+let value96: Double = 19.2 - 21 + 14 * 21.6 - 8.2 * 9.7
+let value97: Double = 22 + 28 + 21 * 1 + 16.1 * 2
+let value98: Double = 12 - 19 + 7.8 * 1 + 27 - 11
+let value99: Double = 17.1 * 24.5 - 21 + 9 + 2 - 14.5
+let value100: Double = 24 * 17.6 + 15 + 5.1 - 26.3 * 16
+let value101: Double = 21.6 - 15.8 - 21 * 27 + 26.4 - 23
+let value102: Double = 1.4 - 12 - 10 + 16 + 21 * 29
+let value103: Double = 29 * 5 + 12 + 1 + 7.4 - 9
+let value104: Double = 12.3 + 29 - 18 * 29 + 26 * 29.4
+let value105: Double = 3.7 + 22.8 * 4 - 8.7 + 16 - 16
+let value106: Double = 6 - 28.2 * 27 + 23 + 22 * 15
+let value107: Double = 12 + 1 * 2 - 30.1 * 17 + 25.0
+let value108: Double = 11 - 22 - 16.8 - 25.4 - 14 - 9
+let value109: Double = 11 * 9.5 + 7 + 26 - 7 * 10
+let value110: Double = 18.8 * 19 * 10 * 2 - 30 * 25
+let value111: Float = 5 * 23 + 29 + 7 - 21 + 25
+let value112: Double = 1 * 27 * 10 + 9.2 - 14 * 1
+let value113: Double = 17 * 4.6 + 19 - 13 - 1 * 20
+let value114: Float = 4 + 16 + 5 - 14 + 22 - 28
+let value115: Double = 19 - 24.0 + 12.2 * 24.4 + 21 + 16
+let value116: Double = 2 + 21 - 20 - 10 * 20 * 28.9
+let value117: Double = 15 - 6 * 26 - 21 - 26 - 13.7
+let value118: Double = 2 - 21.9 - 11.0 * 27 - 27 * 14.3
+let value119: Double = 25.7 + 10 - 11 * 14 * 30.0 - 10.9
+
+let array0: [Double] = [87, 496, 205, 739, 29.5, 58, 476, 948, 769]
+let array1: [Double] = [394, 89, 363, 238, 533, 66.5, 518, 193, 94]
+let array2: [Double] = [717, 591, 412, 877, 45, 63.5, 108, 474, 159]
+let array3: [Double] = [31, 531, 96, 891, 62.5, 218, 797, 99, 98.5]
+let array4: [Double] = [623, 32.5, 43.5, 185, 28, 570, 722, 969, 8.5]
+let array5: [Double] = [81.5, 122, 92, 578, 91, 85.5, 187, 163, 240]
+let array6: [Double] = [28.5, 964, 360, 566, 6.5, 525, 662, 495, 148]
+let array7: [Double] = [5, 86.5, 603, 776, 482, 263, 383, 172, 826]
+let array8: [Double] = [693, 59.5, 199, 160, 28.5, 633, 95.5, 457, 49.5]
+let array9: [Double] = [80.5, 995, 842, 118, 146, 753, 730, 910, 891]
+let array10: [Double] = [428, 159, 584, 42.5, 33.5, 325, 494, 525, 916]
+let array11: [Double] = [947, 488, 15.5, 206, 55.5, 30.5, 12.5, 425, 7.5]
+let array12: [Double] = [37.5, 655, 826, 523, 1, 966, 190, 41, 27.5]
+let array13: [Double] = [185, 184, 235, 201, 848, 623, 779, 210, 685]
+let array14: [Double] = [831, 315, 67, 532, 738, 66.5, 42.5, 654, 63.5]
+let array15: [Double] = [419, 61.5, 681, 190, 375, 719, 609, 45.5, 456]
+let array16: [Double] = [9.5, 731, 849, 41.5, 888, 769, 37.5, 93.5, 525]
+let array17: [Double] = [823, 21, 90, 186, 319, 836, 2.5, 715, 267]
+let array18: [Double] = [613, 475, 719, 359, 91.5, 279, 505, 779, 124]
+let array19: [Double] = [905, 606, 232, 586, 406, 845, 650, 430, 617]
+let array20: [Double] = [405, 6.5, 346, 858, 446, 72.5, 41.5, 71.5, 529]
+let array21: [Double] = [696, 31.5, 84.5, 373, 191, 443, 685, 142, 406]
+let array22: [Double] = [959, 47, 5.5, 656, 939, 279, 825, 79.5, 124]
+let array23: [Double] = [444, 40, 312, 170, 608, 65.5, 10.5, 546, 56.5]
+let array24: [Double] = [134, 52.5, 280, 89, 294, 78.5, 226, 206, 375]
+let array25: [Double] = [561, 489, 317, 341, 524, 992, 12, 20.5, 30.5]
+let array26: [Double] = [333, 291, 27.5, 790, 564, 892, 673, 397, 45.5]
+let array27: [Double] = [111, 982, 956, 345, 143, 631, 283, 66.5, 876]
+let array28: [Double] = [777, 34.5, 725, 720, 891, 420, 599, 407, 73.5]
+let array29: [Double] = [870, 893, 113, 463, 294, 299, 538, 393, 6]
+let array30: [Double] = [869, 48.5, 188, 822, 589, 237, 942, 992, 31.5]
+let array31: [Double] = [26.5, 1.5, 262, 509, 549, 551, 447, 529, 440]
+let array32: [Double] = [366, 692, 970, 69, 101, 512, 574, 19.5, 53.5]
+let array33: [Double] = [450, 920, 43.5, 764, 21.5, 375, 39.5, 113, 301]
+let array34: [Double] = [840, 65.5, 53.5, 536, 523, 914, 186, 578, 361]
+let array35: [Double] = [646, 43, 10, 314, 566, 311, 100, 684, 179]
+let array36: [Double] = [566, 892, 544, 147, 420, 148, 777, 29, 174]
+let array37: [Double] = [62.5, 78.5, 819, 12, 592, 732, 282, 273, 879]
+let array38: [Double] = [74.5, 196, 394, 225, 74.5, 44, 635, 228, 953]
+let array39: [Double] = [177, 920, 58.5, 617, 908, 972, 693, 735, 423]
+
+let dictionary0: [String : Int] = ["k0": 39, "k1": 51, "k2": 91, "k3": 62]
+let dictionary1: [String : Int] = ["k0": 2, "k1": 31, "k2": 11, "k3": 22]
+let dictionary2: [String : Int] = ["k0": 21, "k1": 45, "k2": 48, "k3": 23]
+let dictionary3: [String : Int] = ["k0": 0, "k1": 37, "k2": 50, "k3": 71]
+let dictionary4: [String : Int] = ["k0": 46, "k1": 14, "k2": 42, "k3": 68]
+let dictionary5: [String : Int] = ["k0": 49, "k1": 42, "k2": 51, "k3": 83]
+let dictionary6: [String : Int] = ["k0": 8, "k1": 15, "k2": 54, "k3": 44]
+let dictionary7: [String : Int] = ["k0": 70, "k1": 31, "k2": 49, "k3": 24]
+let dictionary8: [String : Int] = ["k0": 59, "k1": 36, "k2": 44, "k3": 30]
+let dictionary9: [String : Int] = ["k0": 55, "k1": 4, "k2": 35, "k3": 85]
+let dictionary10: [String : Int] = ["k0": 3, "k1": 43, "k2": 19, "k3": 30]
+let dictionary11: [String : Int] = ["k0": 90, "k1": 16, "k2": 11, "k3": 25]
+let dictionary12: [String : Int] = ["k0": 34, "k1": 69, "k2": 16, "k3": 71]
+let dictionary13: [String : Int] = ["k0": 56, "k1": 59, "k2": 30, "k3": 20]
+let dictionary14: [String : Int] = ["k0": 47, "k1": 45, "k2": 27, "k3": 92]
+let dictionary15: [String : Int] = ["k0": 51, "k1": 48, "k2": 80, "k3": 74]
+let dictionary16: [String : Int] = ["k0": 26, "k1": 38, "k2": 60, "k3": 64]
+let dictionary17: [String : Int] = ["k0": 26, "k1": 29, "k2": 57, "k3": 86]
+let dictionary18: [String : Int] = ["k0": 16, "k1": 90, "k2": 33, "k3": 76]
+let dictionary19: [String : Int] = ["k0": 56, "k1": 75, "k2": 47, "k3": 68]
+
+let mixed0 = Double(value0) * 4 + array0[6] - 9.25
+let mixed1 = Double(value1) * 4 + array1[2] - 2.25
+let mixed2 = Double(value2) * 9 + array2[1] - 9.25
+let mixed3 = Double(value3) * 5 + array3[6] - 1.25
+let mixed4 = Double(value4) * 3 + array4[4] - 1.25
+let mixed5 = Double(value5) * 7 + array5[1] - 3.25
+let mixed6 = Double(value6) * 4 + array6[5] - 4.25
+let mixed7 = Double(value7) * 2 + array7[1] - 9.25
+let mixed8 = Double(value8) * 6 + array8[8] - 5.25
+let mixed9 = Double(value9) * 4 + array9[1] - 5.25
+let mixed10 = Double(value10) * 2 + array10[3] - 5.25
+let mixed11 = Double(value11) * 3 + array11[6] - 5.25
+let mixed12 = Double(value12) * 6 + array12[6] - 8.25
+let mixed13 = Double(value13) * 3 + array13[4] - 3.25
+let mixed14 = Double(value14) * 1 + array14[5] - 6.25
+let mixed15 = Double(value15) * 7 + array15[0] - 8.25
+let mixed16 = Double(value16) * 4 + array16[6] - 6.25
+let mixed17 = Double(value17) * 2 + array17[2] - 5.25
+let mixed18 = Double(value18) * 2 + array18[4] - 4.25
+let mixed19 = Double(value19) * 1 + array19[6] - 1.25
+let mixed20 = Double(value20) * 3 + array20[6] - 4.25
+let mixed21 = Double(value21) * 5 + array21[2] - 7.25
+let mixed22 = Double(value22) * 1 + array22[8] - 5.25
+let mixed23 = Double(value23) * 3 + array23[3] - 8.25
+let mixed24 = Double(value24) * 9 + array24[4] - 7.25
+let mixed25 = Double(value25) * 6 + array25[0] - 2.25
+let mixed26 = Double(value26) * 5 + array26[0] - 1.25
+let mixed27 = Double(value27) * 4 + array27[1] - 1.25
+let mixed28 = Double(value28) * 6 + array28[3] - 6.25
+let mixed29 = Double(value29) * 2 + array29[6] - 7.25
+let mixed30 = Double(value30) * 4 + array30[4] - 9.25
+let mixed31 = Double(value31) * 2 + array31[5] - 7.25
+let mixed32 = Double(value32) * 8 + array32[5] - 9.25
+let mixed33 = Double(value33) * 8 + array33[8] - 1.25
+let mixed34 = Double(value34) * 4 + array34[6] - 9.25
+let mixed35 = Double(value35) * 3 + array35[7] - 4.25
+let mixed36 = Double(value36) * 1 + array36[8] - 5.25
+let mixed37 = Double(value37) * 3 + array37[8] - 3.25
+let mixed38 = Double(value38) * 4 + array38[8] - 5.25
+let mixed39 = Double(value39) * 4 + array39[0] - 3.25
@@ -0,0 +1,297 @@
+//===--- UseLists.swift ---------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Functions whose values have hundreds of uses, most of them through casts
+// and struct projections of the same references, which stress the walks
+// over use lists in ARC optimization, RC identity and escape analysis.
+
+public final class Node {
+  public var value: Int = 0
+  public var next: Node?
+  public init() {}
+}
+
+public struct Wrapper {
+  public var node: Node
+  public var other: Node
+}
+
+@inline(never)
+public func consume(_ node: Node) -> Int {
+  return node.value
+}
+
+public func manyUses(_ w: Wrapper) -> Int {
+  var sum = 0
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  sum = sum &+ consume(w.node) &+ consume(w.other) &+ w.node.value
+  w.node.next = w.other
+  return sum
+}
+
+public func manyCopies(_ node: Node) -> [Node] {
+  var nodes: [Node] = []
+  let copy0: AnyObject = node
+  nodes.append(copy0 as! Node)
+  let copy1: AnyObject = node
+  nodes.append(copy1 as! Node)
+  let copy2: AnyObject = node
+  nodes.append(copy2 as! Node)
+  let copy3: AnyObject = node
+  nodes.append(copy3 as! Node)
+  let copy4: AnyObject = node
+  nodes.append(copy4 as! Node)
+  let copy5: AnyObject = node
+  nodes.append(copy5 as! Node)
+  let copy6: AnyObject = node
+  nodes.append(copy6 as! Node)
+  let copy7: AnyObject = node
+  nodes.append(copy7 as! Node)
+  let copy8: AnyObject = node
+  nodes.append(copy8 as! Node)
+  let copy9: AnyObject = node
+  nodes.append(copy9 as! Node)
+  let copy10: AnyObject = node
+  nodes.append(copy10 as! Node)
+  let copy11: AnyObject = node
+  nodes.append(copy11 as! Node)
+  let copy12: AnyObject = node
+  nodes.append(copy12 as! Node)
+  let copy13: AnyObject = node
+  nodes.append(copy13 as! Node)
+  let copy14: AnyObject = node
+  nodes.append(copy14 as! Node)
+  let copy15: AnyObject = node
+  nodes.append(copy15 as! Node)
+  let copy16: AnyObject = node
+  nodes.append(copy16 as! Node)
+  let copy17: AnyObject = node
+  nodes.append(copy17 as! Node)
+  let copy18: AnyObject = node
+  nodes.append(copy18 as! Node)
+  let copy19: AnyObject = node
+  nodes.append(copy19 as! Node)
+  let copy20: AnyObject = node
+  nodes.append(copy20 as! Node)
+  let copy21: AnyObject = node
+  nodes.append(copy21 as! Node)
+  let copy22: AnyObject = node
+  nodes.append(copy22 as! Node)
+  let copy23: AnyObject = node
+  nodes.append(copy23 as! Node)
+  let copy24: AnyObject = node
+  nodes.append(copy24 as! Node)
+  let copy25: AnyObject = node
+  nodes.append(copy25 as! Node)
+  let copy26: AnyObject = node
+  nodes.append(copy26 as! Node)
+  let copy27: AnyObject = node
+  nodes.append(copy27 as! Node)
+  let copy28: AnyObject = node
+  nodes.append(copy28 as! Node)
+  let copy29: AnyObject = node
+  nodes.append(copy29 as! Node)
+  let copy30: AnyObject = node
+  nodes.append(copy30 as! Node)
+  let copy31: AnyObject = node
+  nodes.append(copy31 as! Node)
+  let copy32: AnyObject = node
+  nodes.append(copy32 as! Node)
+  let copy33: AnyObject = node
+  nodes.append(copy33 as! Node)
+  let copy34: AnyObject = node
+  nodes.append(copy34 as! Node)
+  let copy35: AnyObject = node
+  nodes.append(copy35 as! Node)
+  let copy36: AnyObject = node
+  nodes.append(copy36 as! Node)
+  let copy37: AnyObject = node
+  nodes.append(copy37 as! Node)
+  let copy38: AnyObject = node
+  nodes.append(copy38 as! Node)
+  let copy39: AnyObject = node
+  nodes.append(copy39 as! Node)
+  let copy40: AnyObject = node
+  nodes.append(copy40 as! Node)
+  let copy41: AnyObject = node
+  nodes.append(copy41 as! Node)
+  let copy42: AnyObject = node
+  nodes.append(copy42 as! Node)
+  let copy43: AnyObject = node
+  nodes.append(copy43 as! Node)
+  let copy44: AnyObject = node
+  nodes.append(copy44 as! Node)
+  let copy45: AnyObject = node
+  nodes.append(copy45 as! Node)
+  let copy46: AnyObject = node
+  nodes.append(copy46 as! Node)
+  let copy47: AnyObject = node
+  nodes.append(copy47 as! Node)
+  let copy48: AnyObject = node
+  nodes.append(copy48 as! Node)
+  let copy49: AnyObject = node
+  nodes.append(copy49 as! Node)
+  let copy50: AnyObject = node
+  nodes.append(copy50 as! Node)
+  let copy51: AnyObject = node
+  nodes.append(copy51 as! Node)
+  let copy52: AnyObject = node
+  nodes.append(copy52 as! Node)
+  let copy53: AnyObject = node
+  nodes.append(copy53 as! Node)
+  let copy54: AnyObject = node
+  nodes.append(copy54 as! Node)
+  let copy55: AnyObject = node
+  nodes.append(copy55 as! Node)
+  let copy56: AnyObject = node
+  nodes.append(copy56 as! Node)
+  let copy57: AnyObject = node
+  nodes.append(copy57 as! Node)
+  let copy58: AnyObject = node
+  nodes.append(copy58 as! Node)
+  let copy59: AnyObject = node
+  nodes.append(copy59 as! Node)
+  let copy60: AnyObject = node
+  nodes.append(copy60 as! Node)
+  let copy61: AnyObject = node
+  nodes.append(copy61 as! Node)
+  let copy62: AnyObject = node
+  nodes.append(copy62 as! Node)
+  let copy63: AnyObject = node
+  nodes.append(copy63 as! Node)
+  return nodes
+}
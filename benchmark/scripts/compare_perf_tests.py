@@ -15,6 +15,7 @@
 
 import argparse
 import csv
+import math
 import sys
 
 TESTNAME = 1
@@ -25,6 +26,15 @@ MEAN = 5
 SD = 6
 MEDIAN = 7
 
+# Rows of the benchmark logs may end with a column listing the values of the
+# samples of the test, like "104;103;107". Tests compared with enough samples
+# in both files are tested for a significant change with the Mann-Whitney U
+# test, and are only reported as changed if the change is significant.
+
+# Exact p-values of the U test are computed for up to this many samples on
+# each side, if there are no ties. Otherwise the normal approximation is used.
+EXACT_U_MAX_SAMPLES = 20
+
 HTML = """
 <!DOCTYPE html>
 <html>
@@ -60,6 +70,7 @@ HTML_ROW = """
 """
 
 MARKDOWN_ROW = "{0} | {1} | {2} | {3} | {4} \n"
+MARKDOWN_STATS_ROW = "{0} | {1} | {2} | {3} | {4} | {5} | {6} \n"
 HEADER_SPLIT = "---"
 MARKDOWN_DETAIL = """
 <details {3}>
@@ -80,9 +91,13 @@ def main():
     new_results = {}
     old_max_results = {}
     new_max_results = {}
+    old_samples = {}
+    new_samples = {}
     ratio_list = {}
     delta_list = {}
     unknown_list = {}
+    significance_list = {}
+    insignificant_list = set()
     complete_perf_list = []
     increased_perf_list = []
     decreased_perf_list = []
@@ -107,6 +122,12 @@ def main():
                         help='Name of the old branch', default="OLD_MIN")
     parser.add_argument('--delta-threshold',
                         help='delta threshold', default="0.05")
+    parser.add_argument('--significance',
+                        help='significance level of the test for a change '
+                        'of the samples', default="0.05")
+    parser.add_argument('--min-samples',
+                        help='minimum number of samples on each side for '
+                        'testing the significance of a change', default="5")
 
     args = parser.parse_args()
 
@@ -132,6 +153,8 @@ def main():
             else:
                 old_results[row[TESTNAME]] = int(row[MIN])
                 old_max_results[row[TESTNAME]] = int(row[MAX])
+            old_samples.setdefault(row[TESTNAME], []).extend(
+                parse_samples(row))
 
     for row in new_data:
         if (len(row) > 7 and row[MIN].isdigit()):
@@ -143,6 +166,11 @@ def main():
             else:
                 new_results[row[TESTNAME]] = int(row[MIN])
                 new_max_results[row[TESTNAME]] = int(row[MAX])
+            new_samples.setdefault(row[TESTNAME], []).extend(
+                parse_samples(row))
+
+    significance = float(args.significance)
+    min_samples = int(args.min_samples)
 
     ratio_total = 0
     for key in new_results.keys():
@@ -159,11 +187,22 @@ def main():
                     unknown_list[key] = "(?)"
             else:
                     unknown_list[key] = ""
+            if (len(old_samples.get(key, [])) >= min_samples and
+                    len(new_samples[key]) >= min_samples):
+                # The test decides whether the change is real, instead of
+                # the overlap of the ranges.
+                (p_value, effect) = mann_whitney_u(old_samples[key],
+                                                   new_samples[key])
+                significance_list[key] = (p_value, effect)
+                unknown_list[key] = ""
+                if p_value >= significance:
+                    insignificant_list.add(key)
 
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only,
+                                         insignificant_list)
 
     """
     Create markdown formatted table
@@ -173,53 +212,52 @@ def main():
     old_time_width = max_width(old_results, title=old_branch)
     delta_width = max_width(delta_list, title='DELTA (%)')
 
-    markdown_table_header = "\n" + MARKDOWN_ROW.format(
+    # The significance columns are only shown if there are samples.
+    if significance_list:
+        row_format = MARKDOWN_STATS_ROW
+        extra_headers = ["P-VALUE", "EFFECT"]
+    else:
+        row_format = MARKDOWN_ROW
+        extra_headers = []
+
+    markdown_table_header = "\n" + row_format.format(
                                         "TEST".ljust(test_name_width),
                                         old_branch.ljust(old_time_width),
                                         new_branch.ljust(new_time_width),
                                         "DELTA (%)".ljust(delta_width),
-                                        "SPEEDUP".ljust(2))
-    markdown_table_header += MARKDOWN_ROW.format(
+                                        "SPEEDUP".ljust(2), *extra_headers)
+    markdown_table_header += row_format.format(
                                          HEADER_SPLIT.ljust(test_name_width),
                                          HEADER_SPLIT.ljust(old_time_width),
                                          HEADER_SPLIT.ljust(new_time_width),
                                          HEADER_SPLIT.ljust(delta_width),
-                                         HEADER_SPLIT.ljust(2))
-    markdown_regression = ""
-    for i, key in enumerate(decreased_perf_list):
-        ratio = "{0:.2f}x".format(ratio_list[key])
-        if i == 0:
-            markdown_regression = markdown_table_header
-        markdown_regression += MARKDOWN_ROW.format(
-            key.ljust(test_name_width),
-            str(old_results[key]).ljust(old_time_width),
-            str(new_results[key]).ljust(new_time_width),
-            ("{0:+.1f}%".format(delta_list[key])).ljust(delta_width),
-            "**{0}{1}**".format(str(ratio).ljust(2), unknown_list[key]))
-
-    markdown_improvement = ""
-    for i, key in enumerate(increased_perf_list):
-        ratio = "{0:.2f}x".format(ratio_list[key])
-        if i == 0:
-            markdown_improvement = markdown_table_header
-        markdown_improvement += MARKDOWN_ROW.format(
-            key.ljust(test_name_width),
-            str(old_results[key]).ljust(old_time_width),
-            str(new_results[key]).ljust(new_time_width),
-            ("{0:+.1f}%".format(delta_list[key])).ljust(delta_width),
-            "**{0}{1}**".format(str(ratio).ljust(2), unknown_list[key]))
-
-    markdown_normal = ""
-    for i, key in enumerate(normal_perf_list):
-        ratio = "{0:.2f}x".format(ratio_list[key])
-        if i == 0:
-            markdown_normal = markdown_table_header
-        markdown_normal += MARKDOWN_ROW.format(
-            key.ljust(test_name_width),
-            str(old_results[key]).ljust(old_time_width),
-            str(new_results[key]).ljust(new_time_width),
-            ("{0:+.1f}%".format(delta_list[key])).ljust(delta_width),
-            "{0}{1}".format(str(ratio).ljust(2), unknown_list[key]))
+                                         HEADER_SPLIT.ljust(2),
+                                         *[HEADER_SPLIT for _ in extra_headers])
+
+    def markdown_rows(keys, speedup_format):
+        if not keys:
+            return ""
+        rows = markdown_table_header
+        for key in keys:
+            ratio = "{0:.2f}x".format(ratio_list[key])
+            if not extra_headers:
+                extra_columns = []
+            elif key in significance_list:
+                extra_columns = format_significance(significance_list[key])
+            else:
+                extra_columns = ["", ""]
+            rows += row_format.format(
+                key.ljust(test_name_width),
+                str(old_results[key]).ljust(old_time_width),
+                str(new_results[key]).ljust(new_time_width),
+                ("{0:+.1f}%".format(delta_list[key])).ljust(delta_width),
+                speedup_format.format(str(ratio).ljust(2), unknown_list[key]),
+                *extra_columns)
+        return rows
+
+    markdown_regression = markdown_rows(decreased_perf_list, "**{0}{1}**")
+    markdown_improvement = markdown_rows(increased_perf_list, "**{0}{1}**")
+    markdown_normal = markdown_rows(normal_perf_list, "{0}{1}")
 
     markdown_data = MARKDOWN_DETAIL.format("Regression",
                                            len(decreased_perf_list),
@@ -251,7 +289,9 @@ def main():
             """
             html_data = convert_to_html(ratio_list, old_results, new_results,
                                         delta_list, unknown_list, old_branch,
-                                        new_branch, args.changes_only)
+                                        new_branch, args.changes_only,
+                                        significance_list,
+                                        insignificant_list)
 
             if args.output:
                 write_to_file(args.output, html_data)
@@ -267,17 +307,19 @@ def main():
 
 
 def convert_to_html(ratio_list, old_results, new_results, delta_list,
-                    unknown_list, old_branch, new_branch, changes_only):
+                    unknown_list, old_branch, new_branch, changes_only,
+                    significance_list={}, insignificant_list=()):
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, changes_only,
+                                         insignificant_list)
 
     html_rows = ""
     for key in complete_perf_list:
-        if ratio_list[key] < RATIO_MIN:
+        if key in decreased_perf_list:
             color = "red"
-        elif ratio_list[key] > RATIO_MAX:
+        elif key in increased_perf_list:
             color = "green"
         else:
             color = "black"
@@ -294,12 +336,14 @@ def convert_to_html(ratio_list, old_results, new_results, delta_list,
                 "<strong>No Changes:</strong>",
                 "", "", "", "black", "", "")
 
+        speedup = "{0:.2f}x {1}".format(ratio_list[key], unknown_list[key])
+        if key in significance_list:
+            speedup += "(p={0}, effect {1})".format(
+                *format_significance(significance_list[key]))
         html_rows += HTML_ROW.format(key, old_results[key],
                                      new_results[key],
                                      "{0:+.1f}%".format(delta_list[key]),
-                                     color,
-                                     "{0:.2f}x {1}".format(ratio_list[key],
-                                                           unknown_list[key]))
+                                     color, speedup)
 
     html_table = HTML_TABLE.format("TEST", old_branch, new_branch,
                                    "DELTA (%)", "SPEEDUP", html_rows)
@@ -316,9 +360,10 @@ def write_to_file(file_name, data):
     file.close
 
 
-def sort_ratio_list(ratio_list, changes_only=False):
+def sort_ratio_list(ratio_list, changes_only=False, insignificant_list=()):
     """
-    Return 3 sorted list improvement, regression and normal.
+    Return 3 sorted list improvement, regression and normal. The tests in
+    insignificant_list are normal, whatever their ratio.
     """
     decreased_perf_list = []
     increased_perf_list = []
@@ -326,7 +371,9 @@ def sort_ratio_list(ratio_list, changes_only=False):
     normal_perf_list = {}
 
     for key, v in sorted(ratio_list.items(), key=lambda x: x[1]):
-        if ratio_list[key] < RATIO_MIN:
+        if key in insignificant_list:
+            normal_perf_list[key] = v
+        elif ratio_list[key] < RATIO_MIN:
             decreased_perf_list.append(key)
         elif ratio_list[key] > RATIO_MAX:
             increased_perf_list.append(key)
@@ -347,6 +394,100 @@ def sort_ratio_list(ratio_list, changes_only=False):
             decreased_perf_list, sorted_normal_perf_list)
 
 
+def parse_samples(row):
+    """
+    Return the values of the samples listed in the last column of row, or
+    an empty list if the row does not list them.
+    """
+    if len(row) <= MEDIAN + 1 or ';' not in row[-1]:
+        return []
+    return [int(value) for value in row[-1].split(';') if value]
+
+
+def ranks(values):
+    """
+    Return the ranks of values, starting at 1. Tied values get the mean of
+    their ranks.
+    """
+    order = sorted(range(len(values)), key=lambda i: values[i])
+    result = [0.0] * len(values)
+    i = 0
+    while i < len(order):
+        j = i
+        while j + 1 < len(order) and values[order[j + 1]] == values[order[i]]:
+            j += 1
+        for k in range(i, j + 1):
+            result[order[k]] = (i + j) / 2.0 + 1
+        i = j + 1
+    return result
+
+
+def exact_u_cdf(u, n1, n2):
+    """
+    Return the probability that the U statistic of samples of n1 and n2
+    values without ties is at most u, if the samples come from the same
+    distribution.
+    """
+    # counts[i][j][k] is the number of orders of i and j values whose U
+    # statistic is k. The largest value is either one of the i values, which
+    # is larger than all j values, or one of the j values.
+    counts = [[[1]] * (n2 + 1) for _ in range(n1 + 1)]
+    for i in range(1, n1 + 1):
+        for j in range(1, n2 + 1):
+            count = [0] * (i * j + 1)
+            for k, c in enumerate(counts[i - 1][j]):
+                count[k + j] += c
+            for k, c in enumerate(counts[i][j - 1]):
+                count[k] += c
+            counts[i][j] = count
+    distribution = counts[n1][n2]
+    return float(sum(distribution[:u + 1])) / sum(distribution)
+
+
+def mann_whitney_u(old, new):
+    """
+    Return the two-sided p-value of the Mann-Whitney U test of the samples
+    old and new, and the rank-biserial correlation as the effect size. The
+    correlation is between -1 and 1, and positive if the values of new tend
+    to be larger, i.e. the test got slower.
+    """
+    n1 = len(old)
+    n2 = len(new)
+    u_new = sum(ranks(old + new)[n1:]) - n2 * (n2 + 1) / 2.0
+    effect = 2.0 * u_new / (n1 * n2) - 1
+    u = min(u_new, n1 * n2 - u_new)
+
+    tie_sizes = {}
+    for value in old + new:
+        tie_sizes[value] = tie_sizes.get(value, 0) + 1
+    if (len(tie_sizes) == n1 + n2 and n1 <= EXACT_U_MAX_SAMPLES and
+            n2 <= EXACT_U_MAX_SAMPLES):
+        p_value = 2 * exact_u_cdf(int(u), n1, n2)
+    else:
+        # The normal approximation, with the correction for ties and the
+        # continuity correction.
+        n = n1 + n2
+        ties = sum(t ** 3 - t for t in tie_sizes.values())
+        variance = n1 * n2 / 12.0 * ((n + 1) - ties / float(n * (n - 1)))
+        if variance <= 0:
+            return (1.0, effect)
+        z = max(n1 * n2 / 2.0 - u - 0.5, 0) / math.sqrt(variance)
+        p_value = math.erfc(z / math.sqrt(2))
+    return (min(p_value, 1.0), effect)
+
+
+def format_significance(significance):
+    """
+    Return the p-value and the effect size as strings.
+    """
+    (p_value, effect) = significance
+    if p_value < 0.001:
+        p_string = "<0.001"
+    else:
+        p_string = "{0:.3f}".format(p_value)
+    return [p_string, "{0:+.2f}".format(effect)]
+
+
 def max_width(items, title, key_len=False):
     """
     Returns the max length of string in the list
@@ -0,0 +1,55 @@
+//===--- FloatToString.swift ----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of converting Double and Float values to
+// strings, as emitters of JSON and metrics do. Values of ordinary magnitude
+// are formatted without printf; tiny and huge values still go through it, and
+// the two variants compare the two paths.
+import TestsUtils
+
+@inline(never)
+func lengthOfDescriptions(_ values: [Double]) -> Int {
+  var length = 0
+  for v in values {
+    length += v.description.utf8.count
+    length += v.debugDescription.utf8.count
+    length += Float(v).description.utf8.count
+  }
+  return length
+}
+
+@inline(never)
+public func run_FloatToString(_ N: Int) {
+  var values: [Double] = []
+  for i in 0..<100 {
+    values.append(Double(i) * 0.37 + 0.001)
+  }
+  var length = 0
+  for _ in 0..<N {
+    length += lengthOfDescriptions(values)
+  }
+  CheckResults(length > 0, "Incorrect results in FloatToString")
+}
+
+@inline(never)
+public func run_FloatToStringExtremeMagnitudes(_ N: Int) {
+  var values: [Double] = []
+  for i in 1...100 {
+    values.append(Double(i) * 1.0e-200)
+  }
+  var length = 0
+  for _ in 0..<N {
+    length += lengthOfDescriptions(values)
+  }
+  CheckResults(length > 0,
+               "Incorrect results in FloatToStringExtremeMagnitudes")
+}
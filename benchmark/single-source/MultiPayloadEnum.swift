@@ -0,0 +1,61 @@
+//===--- MultiPayloadEnum.swift -------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of switching over a generic multi-payload
+// enum. The enum is not specialized, so each switch asks the runtime for the
+// case of the value.
+import TestsUtils
+
+enum Outcome<T, U> {
+  case success(T)
+  case failure(U)
+  case pending
+  case cancelled
+}
+
+@inline(never)
+func classify<T, U>(_ o: Outcome<T, U>) -> Int {
+  switch o {
+  case .success: return 1
+  case .failure: return 2
+  case .pending: return 3
+  case .cancelled: return 4
+  }
+}
+
+@inline(never)
+func makeOutcomes<T, U>(_ t: T, _ u: U) -> [Outcome<T, U>] {
+  return [.success(t), .failure(u), .pending, .cancelled]
+}
+
+@inline(never)
+func sumOfCases<T, U>(_ outcomes: [Outcome<T, U>], _ n: Int) -> Int {
+  var s = 0
+  for _ in 0..<n {
+    for o in outcomes {
+      s += classify(o)
+    }
+  }
+  return s
+}
+
+@inline(never)
+public func run_MultiPayloadEnum(_ N: Int) {
+  let small = makeOutcomes(UInt8(1), Int8(2))
+  let large = makeOutcomes(1, 2.0)
+  var s = 0
+  for _ in 0..<N {
+    s += sumOfCases(small, 1000)
+    s += sumOfCases(large, 1000)
+  }
+  CheckResults(s == N*20000, "Incorrect results in MultiPayloadEnum")
+}
@@ -0,0 +1,201 @@
+//===--- RuntimeConcurrency.swift -----------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// These tests measure how the runtime scales when several threads call into
+// it at once: retains and releases of a shared object, generic metadata
+// lookups, casts to protocols and allocations. Each test runs with 1, 2, 4
+// and 8 threads. Every thread does the same amount of work, so with perfect
+// scaling the time of a test does not depend on the number of threads; the
+// times of a test over the thread counts are its scaling curve.
+import TestsUtils
+
+final class SharedObject {}
+
+let sharedObject = SharedObject()
+
+@inline(never)
+func runRetainRelease(_ N: Int, threads: Int) {
+  let object = Unmanaged.passUnretained(sharedObject)
+  RunConcurrently(threads) { _ in
+    for _ in 0..<(N * 100_000) {
+      _ = object.retain()
+      object.release()
+    }
+  }
+}
+
+struct Pair<T, U> {
+  var first: T
+  var second: U
+}
+
+protocol MetadataLookup {
+  static func lookUp() -> Any.Type
+}
+
+struct PairOfInt<T> : MetadataLookup {
+  static func lookUp() -> Any.Type {
+    return Pair<T, Int>.self
+  }
+}
+
+/// The generic metadata to look up. The lookups go through the existential
+/// metatypes, so that they are not specialized away.
+let metadataLookups: [MetadataLookup.Type] = [
+  PairOfInt<Int>.self, PairOfInt<Int8>.self, PairOfInt<Int16>.self,
+  PairOfInt<Int32>.self, PairOfInt<UInt>.self, PairOfInt<Double>.self,
+  PairOfInt<String>.self, PairOfInt<SharedObject>.self,
+]
+
+@inline(never)
+func runGenericMetadata(_ N: Int, threads: Int) {
+  let lookups = metadataLookups
+  RunConcurrently(threads) { _ in
+    var count = 0
+    for _ in 0..<(N * 10_000) {
+      for lookup in lookups {
+        if lookup.lookUp() == Int.self {
+          count += 1
+        }
+      }
+    }
+    CheckResults(count == 0, "Incorrect results in GenericMetadata")
+  }
+}
+
+protocol Castable {}
+extension Int : Castable {}
+extension String : Castable {}
+extension SharedObject : Castable {}
+
+/// Values of which three conform to Castable.
+let castValues: [Any] = [1, "a", sharedObject, 1.0, Int8(1), [1], UInt(1),
+                         Pair(first: 1, second: 1)]
+
+@inline(never)
+func runProtocolCast(_ N: Int, threads: Int) {
+  let values = castValues
+  RunConcurrently(threads) { _ in
+    var count = 0
+    for _ in 0..<(N * 10_000) {
+      for value in values {
+        if value as? Castable != nil {
+          count += 1
+        }
+      }
+    }
+    CheckResults(count == N * 10_000 * 3,
+                 "Incorrect results in ProtocolCast")
+  }
+}
+
+final class AllocatedObject {
+  var value: Int
+
+  init(_ value: Int) {
+    self.value = value
+  }
+}
+
+@inline(never)
+func runAllocation(_ N: Int, threads: Int) {
+  RunConcurrently(threads) { _ in
+    // Keep the objects alive for a while in an array of the thread, so that
+    // they are heap allocated and freed in a different order.
+    var objects = [AllocatedObject?](repeating: nil, count: 16)
+    for i in 0..<(N * 100_000) {
+      objects[i & 15] = AllocatedObject(i)
+    }
+    CheckResults(objects[15]!.value == N * 100_000 - 1,
+                 "Incorrect results in Allocation")
+  }
+}
+
+@inline(never)
+public func run_ConcurrentRetainRelease1(_ N: Int) {
+  runRetainRelease(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentRetainRelease2(_ N: Int) {
+  runRetainRelease(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentRetainRelease4(_ N: Int) {
+  runRetainRelease(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentRetainRelease8(_ N: Int) {
+  runRetainRelease(N, threads: 8)
+}
+
+@inline(never)
+public func run_ConcurrentGenericMetadata1(_ N: Int) {
+  runGenericMetadata(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentGenericMetadata2(_ N: Int) {
+  runGenericMetadata(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentGenericMetadata4(_ N: Int) {
+  runGenericMetadata(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentGenericMetadata8(_ N: Int) {
+  runGenericMetadata(N, threads: 8)
+}
+
+@inline(never)
+public func run_ConcurrentProtocolCast1(_ N: Int) {
+  runProtocolCast(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentProtocolCast2(_ N: Int) {
+  runProtocolCast(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentProtocolCast4(_ N: Int) {
+  runProtocolCast(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentProtocolCast8(_ N: Int) {
+  runProtocolCast(N, threads: 8)
+}
+
+@inline(never)
+public func run_ConcurrentAllocation1(_ N: Int) {
+  runAllocation(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentAllocation2(_ N: Int) {
+  runAllocation(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentAllocation4(_ N: Int) {
+  runAllocation(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentAllocation8(_ N: Int) {
+  runAllocation(N, threads: 8)
+}
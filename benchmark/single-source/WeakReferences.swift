@@ -0,0 +1,110 @@
+//===--- WeakReferences.swift ---------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of loading, storing and copying weak
+// references, as in the delegate pattern.
+import TestsUtils
+
+final class Delegate {
+  var value: Int
+
+  init(_ v: Int) {
+    value = v
+  }
+}
+
+final class Holder {
+  weak var delegate: Delegate?
+
+  init(_ d: Delegate?) {
+    delegate = d
+  }
+}
+
+struct WeakBox {
+  weak var delegate: Delegate?
+}
+
+@inline(never)
+func loadWeak(_ h: Holder) -> Int {
+  return h.delegate?.value ?? 0
+}
+
+@inline(never)
+func storeWeak(_ h: Holder, _ d: Delegate?) {
+  h.delegate = d
+}
+
+@inline(never)
+func copyWeak(_ boxes: [WeakBox]) -> [WeakBox] {
+  var result = boxes
+  result.append(WeakBox(delegate: nil))
+  return result
+}
+
+@inline(never)
+func makeOrphanedHolder(_ v: Int) -> Holder {
+  return Holder(Delegate(v))
+}
+
+@inline(never)
+public func run_WeakLoadLive(_ N: Int) {
+  let d = Delegate(1)
+  let h = Holder(d)
+  var s = 0
+  for _ in 0..<N*10000 {
+    s += loadWeak(h)
+  }
+  CheckResults(s == N*10000, "Incorrect results in WeakLoadLive")
+}
+
+@inline(never)
+public func run_WeakLoadNil(_ N: Int) {
+  let h = Holder(nil)
+  var s = 0
+  for _ in 0..<N*10000 {
+    s += loadWeak(h)
+  }
+  CheckResults(s == 0, "Incorrect results in WeakLoadNil")
+}
+
+@inline(never)
+public func run_WeakLoadDead(_ N: Int) {
+  var s = 0
+  for _ in 0..<N*1000 {
+    let h = makeOrphanedHolder(1)
+    s += loadWeak(h)
+  }
+  CheckResults(s == 0, "Incorrect results in WeakLoadDead")
+}
+
+@inline(never)
+public func run_WeakStore(_ N: Int) {
+  let d1 = Delegate(1)
+  let d2 = Delegate(2)
+  let h = Holder(nil)
+  for i in 0..<N*10000 {
+    storeWeak(h, (i & 1) == 0 ? d1 : d2)
+  }
+  CheckResults(loadWeak(h) == 2, "Incorrect results in WeakStore")
+}
+
+@inline(never)
+public func run_WeakCopy(_ N: Int) {
+  let delegates = (0..<10).map { Delegate($0) }
+  let boxes = delegates.map { WeakBox(delegate: $0) }
+  var count = 0
+  for _ in 0..<N*1000 {
+    count += copyWeak(boxes).count
+  }
+  CheckResults(count == N*1000*11, "Incorrect results in WeakCopy")
+}
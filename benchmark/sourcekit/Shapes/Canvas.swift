@@ -0,0 +1,21 @@
+public final class Canvas {
+  public private(set) var shapes: [Shape] = []
+
+  public init() {}
+
+  public func add(_ shape: Shape) {
+    shapes.append(shape)
+  }
+
+  public var totalArea: Double {
+    var result = 0.0
+    for shape in shapes {
+      result += shape.area
+    }
+    return result
+  }
+
+  public func shapes(named name: String) -> [Shape] {
+    return shapes.filter { $0.name == name }
+  }
+}
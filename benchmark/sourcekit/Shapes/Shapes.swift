@@ -0,0 +1,22 @@
+public protocol Shape {
+  var area: Double { get }
+  var name: String { get }
+}
+
+public struct Circle : Shape {
+  public var radius: Double
+  public init(radius: Double) { self.radius = radius }
+  public var area: Double { return 3.14159 * radius * radius }
+  public var name: String { return "circle" }
+}
+
+public struct Rectangle : Shape {
+  public var width: Double
+  public var height: Double
+  public init(width: Double, height: Double) {
+    self.width = width
+    self.height = height
+  }
+  public var area: Double { return width * height }
+  public var name: String { return "rectangle" }
+}
@@ -0,0 +1,8 @@
+let canvas = Canvas()
+canvas.add(Circle(radius: 1))
+canvas.add(Rectangle(width: 2, height: 3))
+
+for shape in canvas.shapes {
+  print(shape.name)
+}
+print(canvas.totalArea)
@@ -11,6 +11,19 @@
 //===----------------------------------------------------------------------===//
 
 import Darwin
+import PerfCounters
+
+/// The names of the hardware performance counters, as printed in the column
+/// headers of --perf-counters.
+let perfCounterNames = [
+  "INSTRUCTIONS", "CYCLES", "L1D_MISSES", "LLC_MISSES", "BRANCH_MISSES"]
+
+/// The runtime counters reported with --runtime-counters, by their names in
+/// the runtime and in the column headers.
+let runtimeCounterColumns = [
+  ("Retain", "RETAINS"), ("Release", "RELEASES"),
+  ("AllocObject", "ALLOCATIONS"),
+  ("MetadataCacheMiss", "METADATA_INSTANTIATIONS")]
 
 struct BenchResults {
   var delim: String  = ","
@@ -20,6 +33,12 @@ struct BenchResults {
   var mean: UInt64 = 0
   var sd: UInt64 = 0
   var median: UInt64 = 0
+  /// The mean counts of the hardware performance and runtime counters per
+  /// iteration of the test, in the order of TestConfig.counterNames, if they
+  /// were measured.
+  var counters: [UInt64] = []
+  /// The value of every sample, if they are printed.
+  var samples: [UInt64] = []
   init() {}
   init(delim: String, sampleCount: UInt64, min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64) {
     self.delim = delim
@@ -41,7 +60,14 @@ struct BenchResults {
 
 extension BenchResults : CustomStringConvertible {
   var description: String {
-     return "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     var result = "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     for counter in counters {
+       result += "\(delim)\(counter)"
+     }
+     if !samples.isEmpty {
+       result += delim + samples.map { String($0) }.joined(separator: ";")
+     }
+     return result
   }
 }
 
@@ -88,6 +114,16 @@ struct TestConfig {
   /// The number of samples we should take of each test.
   var numSamples: Int = 1
 
+  /// The time in seconds a sample should take, if the number of iterations
+  /// is not fixed. The harness scales the number of iterations of each test
+  /// to fill the time. Many short samples make for a better estimate of the
+  /// distribution of the run time than few long ones.
+  var sampleTime: Double = 1.0
+
+  /// Should we print the value of every sample, for a statistical comparison
+  /// with compare_perf_tests.py?
+  var printSamples: Bool = false
+
   /// Is verbose output enabled?
   var verbose: Bool = false
 
@@ -98,12 +134,28 @@ struct TestConfig {
   /// like leaks that require a PID to run on the test harness.
   var afterRunSleep: Int? = nil
 
+  /// Should we measure the hardware performance counters of each sample?
+  var perfCounters: Bool = false
+
+  /// Should we measure how often each sample calls into the runtime to
+  /// retain, release and allocate objects and instantiate metadata? This
+  /// requires a runtime built with SWIFT_RUNTIME_ENABLE_COUNTERS.
+  var runtimeCounters: Bool = false
+
+  /// The names of the counters we measure, in the order of their columns.
+  var counterNames: [String] {
+    return (perfCounters ? perfCounterNames : []) +
+      (runtimeCounters ? runtimeCounterColumns.map { $0.1 } : [])
+  }
+
   /// The list of tests to run.
   var tests = [Test]()
 
   mutating func processArguments() -> TestAction {
     let validOptions=["--iter-scale", "--num-samples", "--num-iters",
-      "--verbose", "--delim", "--run-all", "--list", "--sleep"]
+      "--verbose", "--delim", "--run-all", "--list", "--sleep",
+      "--perf-counters", "--runtime-counters", "--sample-time",
+      "--print-samples"]
     let maybeBenchArgs: Arguments? = parseArgs(validOptions)
     if maybeBenchArgs == nil {
       return .Fail("Failed to parse arguments")
@@ -129,6 +181,18 @@ struct TestConfig {
       numSamples = Int(x)!
     }
 
+    if let x = benchArgs.optionalArgsMap["--sample-time"] {
+      if x.isEmpty { return .Fail("--sample-time requires a value") }
+      guard let v = Double(x) where v > 0 else {
+        return .Fail("--sample-time requires a positive number of seconds")
+      }
+      sampleTime = v
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--print-samples"] {
+      printSamples = true
+    }
+
     if let _ = benchArgs.optionalArgsMap["--verbose"] {
       verbose = true
       print("Verbose")
@@ -154,6 +218,14 @@ struct TestConfig {
       afterRunSleep = v!
     }
 
+    if let _ = benchArgs.optionalArgsMap["--perf-counters"] {
+      perfCounters = true
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--runtime-counters"] {
+      runtimeCounters = true
+    }
+
     filters = benchArgs.positionalArgs
 
     return .Run
@@ -224,21 +296,109 @@ func stopTrackingObjects(_: UnsafeMutablePointer<Void>) -> Int
 
 #endif
 
+@_silgen_name("swift_getRuntimeCounters")
+@discardableResult
+func getRuntimeCounters(_ counts: UnsafeMutablePointer<UInt64>,
+                        _ maxCount: Int) -> Int
+@_silgen_name("swift_getRuntimeCounterName")
+func getRuntimeCounterName(_ index: Int) -> UnsafePointer<CChar>?
+
+/// An object whose allocation checks that the runtime counts.
+final class RuntimeCounterProbe {}
+var runtimeCounterProbe: RuntimeCounterProbe? = nil
+
 class SampleRunner {
   var info = mach_timebase_info_data_t(numer: 0, denom: 0)
-  init() {
+
+  /// The file descriptors of the hardware performance counters, if they are
+  /// measured.
+  var counterFDs: [Int32] = []
+
+  /// The counts of the hardware performance counters during the last run.
+  var counters = [UInt64](repeating: 0, count: perfCounterNames.count)
+
+  /// The indices of the runtimeCounterColumns in the counts of the runtime,
+  /// if they are measured.
+  var runtimeCounterIndices: [Int] = []
+
+  /// The counts of the runtime before and after the last run. They are read
+  /// into preallocated arrays, so that reading them does not count.
+  var runtimeCountsAtStart: [UInt64] = []
+  var runtimeCountsAtEnd: [UInt64] = []
+
+  init(measuringPerfCounters: Bool = false,
+       measuringRuntimeCounters: Bool = false) {
     mach_timebase_info(&info)
+    if measuringPerfCounters {
+      counterFDs = [Int32](repeating: -1, count: perfCounterNames.count)
+      if perfcounters_open(&counterFDs) == 0 {
+        fatalError("hardware performance counters are not available")
+      }
+    }
+    if measuringRuntimeCounters {
+      setUpRuntimeCounters()
+    }
+  }
+
+  func setUpRuntimeCounters() {
+    var names = [String]()
+    while let name = getRuntimeCounterName(names.count) {
+      names.append(String(cString: name))
+    }
+    for (runtimeName, _) in runtimeCounterColumns {
+      guard let index = names.index(of: runtimeName) else {
+        fatalError("the runtime has no counter \(runtimeName)")
+      }
+      runtimeCounterIndices.append(index)
+    }
+    runtimeCountsAtStart = [UInt64](repeating: 0, count: names.count)
+    runtimeCountsAtEnd = [UInt64](repeating: 0, count: names.count)
+
+    // A runtime built without counters reports zero counts.
+    getRuntimeCounters(&runtimeCountsAtStart, runtimeCountsAtStart.count)
+    runtimeCounterProbe = RuntimeCounterProbe()
+    getRuntimeCounters(&runtimeCountsAtEnd, runtimeCountsAtEnd.count)
+    if runtimeCounts.reduce(0, combine: +) == 0 {
+      fatalError("the runtime does not count, it must be built with " +
+                 "SWIFT_RUNTIME_ENABLE_COUNTERS")
+    }
+  }
+
+  /// The counts of the runtimeCounterColumns during the last run.
+  var runtimeCounts: [UInt64] {
+    return runtimeCounterIndices.map {
+      runtimeCountsAtEnd[$0] - runtimeCountsAtStart[$0]
+    }
+  }
+
+  deinit {
+    if !counterFDs.isEmpty {
+      perfcounters_close(&counterFDs)
+    }
   }
+
   func run(_ name: String, fn: (Int) -> Void, num_iters: UInt) -> UInt64 {
     // Start the timer.
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
     var str = name
     startTrackingObjects(UnsafeMutablePointer<Void>(str._core.startASCII))
 #endif
+    if !runtimeCounterIndices.isEmpty {
+      getRuntimeCounters(&runtimeCountsAtStart, runtimeCountsAtStart.count)
+    }
+    if !counterFDs.isEmpty {
+      perfcounters_start(counterFDs)
+    }
     let start_ticks = mach_absolute_time()
     fn(Int(num_iters))
     // Stop the timer.
     let end_ticks = mach_absolute_time()
+    if !counterFDs.isEmpty {
+      perfcounters_stop(counterFDs, &counters)
+    }
+    if !runtimeCounterIndices.isEmpty {
+      getRuntimeCounters(&runtimeCountsAtEnd, runtimeCountsAtEnd.count)
+    }
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
     stopTrackingObjects(UnsafeMutablePointer<Void>(str._core.startASCII))
 #endif
@@ -258,15 +418,19 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
     print("Running \(name) for \(c.numSamples) samples.")
   }
 
-  let sampler = SampleRunner()
+  var counterSums = [UInt64](repeating: 0, count: c.counterNames.count)
+
+  let sampler = SampleRunner(measuringPerfCounters: c.perfCounters,
+                             measuringRuntimeCounters: c.runtimeCounters)
   for s in 0..<c.numSamples {
-    let time_per_sample: UInt64 = 1_000_000_000 * UInt64(c.iterationScale)
+    let time_per_sample =
+      UInt64(c.sampleTime * 1_000_000_000) * UInt64(c.iterationScale)
 
     var scale : UInt
     var elapsed_time : UInt64 = 0
     if c.fixedNumIters == 0 {
       elapsed_time = sampler.run(name, fn: fn, num_iters: 1)
-      scale = UInt(time_per_sample / elapsed_time)
+      scale = UInt(time_per_sample / max(elapsed_time, 1))
     } else {
       // Compute the scaling factor if a fixed c.fixedNumIters is not specified.
       scale = c.fixedNumIters
@@ -286,14 +450,30 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
     if c.verbose {
       print("    Sample \(s),\(samples[s])")
     }
+    if !counterSums.isEmpty {
+      let counts = (c.perfCounters ? sampler.counters : []) +
+        (c.runtimeCounters ? sampler.runtimeCounts : [])
+      for i in 0..<counterSums.count {
+        counterSums[i] += counts[i] / UInt64(scale)
+      }
+    }
   }
 
   let (mean, sd) = internalMeanSD(samples)
 
   // Return our benchmark results.
-  return BenchResults(delim: c.delim, sampleCount: UInt64(samples.count),
-                      min: samples.min()!, max: samples.max()!,
-                      mean: mean, sd: sd, median: internalMedian(samples))
+  var results = BenchResults(delim: c.delim,
+                             sampleCount: UInt64(samples.count),
+                             min: samples.min()!, max: samples.max()!,
+                             mean: mean, sd: sd,
+                             median: internalMedian(samples))
+  if !counterSums.isEmpty {
+    results.counters = counterSums.map { $0 / UInt64(c.numSamples) }
+  }
+  if c.printSamples {
+    results.samples = samples
+  }
+  return results
 }
 
 func printRunInfo(_ c: TestConfig) {
@@ -302,6 +482,9 @@ func printRunInfo(_ c: TestConfig) {
     print("NumSamples: \(c.numSamples)")
     print("Verbose: \(c.verbose)")
     print("IterScale: \(c.iterationScale)")
+    print("PerfCounters: \(c.perfCounters)")
+    print("RuntimeCounters: \(c.runtimeCounters)")
+    print("SampleTime: \(c.sampleTime)")
     if c.fixedNumIters != 0 {
       print("FixedIters: \(c.fixedNumIters)")
     }
@@ -320,9 +503,18 @@ func printRunInfo(_ c: TestConfig) {
 
 func runBenchmarks(_ c: TestConfig) {
   let units = "us"
-  print("#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))")
+  var header = "#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))"
   var SumBenchResults = BenchResults()
   SumBenchResults.sampleCount = 0
+  for name in c.counterNames {
+    header += "\(c.delim)\(name)"
+  }
+  SumBenchResults.counters =
+    [UInt64](repeating: 0, count: c.counterNames.count)
+  if c.printSamples {
+    header += "\(c.delim)SAMPLE_VALUES(\(units))"
+  }
+  print(header)
 
   for t in c.tests {
     if !t.run {
@@ -339,6 +531,9 @@ func runBenchmarks(_ c: TestConfig) {
     SumBenchResults.max += results.max
     SumBenchResults.mean += results.mean
     SumBenchResults.sampleCount += 1
+    for i in 0..<results.counters.count {
+      SumBenchResults.counters[i] += results.counters[i]
+    }
     // Don't accumulate SD and Median, as simple sum isn't valid for them.
     // TODO: Compute SD and Median for total results as well.
     // SumBenchResults.sd += results.sd
@@ -0,0 +1,132 @@
+//===--- PerfCounters.h - Hardware performance counters ---------*- C -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Access to the hardware performance counters of the benchmark process, for
+// the --perf-counters mode of the benchmark driver.  The counters are read
+// with perf_event_open(2) on Linux.  On other platforms no counter can be
+// opened.
+//
+// The functions are static inline, so that the driver can use them without
+// linking another library.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BENCHMARK_PERFCOUNTERS_H
+#define SWIFT_BENCHMARK_PERFCOUNTERS_H
+
+#include <stdint.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/// The counters, in the order of the values of perfcounters_read.
+enum {
+  PerfCounterInstructions,
+  PerfCounterCycles,
+  PerfCounterL1DMisses,
+  PerfCounterLLCMisses,
+  PerfCounterBranchMisses,
+  PerfCounterCount
+};
+
+/// Opens the PerfCounterCount counters of this thread, disabled, and stores
+/// their file descriptors to fds.  The descriptor of a counter which is not
+/// supported by the machine is -1.  Returns the number of opened counters.
+static inline int perfcounters_open(int *fds) {
+  int opened = 0;
+#if defined(__linux__)
+  static const struct { uint32_t type; uint64_t config; } events[] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+  };
+  for (int i = 0; i != PerfCounterCount; ++i) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[i].type;
+    attr.config = events[i].config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // The counters are multiplexed if there are not enough of them; the
+    // times let perfcounters_read scale the counts to the whole sample.
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fds[i] >= 0)
+      ++opened;
+  }
+#else
+  for (int i = 0; i != PerfCounterCount; ++i)
+    fds[i] = -1;
+#endif
+  return opened;
+}
+
+/// Resets the counters in fds to zero and starts them.
+static inline void perfcounters_start(const int *fds) {
+#if defined(__linux__)
+  for (int i = 0; i != PerfCounterCount; ++i) {
+    if (fds[i] < 0)
+      continue;
+    ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+}
+
+/// Stops the counters in fds and stores their counts to values.  The count
+/// of a counter which is not open is 0.
+static inline void perfcounters_stop(const int *fds, uint64_t *values) {
+  for (int i = 0; i != PerfCounterCount; ++i)
+    values[i] = 0;
+#if defined(__linux__)
+  for (int i = 0; i != PerfCounterCount; ++i) {
+    if (fds[i] >= 0)
+      ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+  }
+  for (int i = 0; i != PerfCounterCount; ++i) {
+    // The count, the time enabled and the time running.
+    uint64_t data[3];
+    if (fds[i] < 0 || read(fds[i], data, sizeof(data)) != sizeof(data))
+      continue;
+    if (data[2] == 0)
+      continue;
+    values[i] = data[2] < data[1]
+      ? (uint64_t)((double)data[0] * ((double)data[1] / (double)data[2]))
+      : data[0];
+  }
+#endif
+}
+
+/// Closes the counters in fds.
+static inline void perfcounters_close(int *fds) {
+#if defined(__linux__)
+  for (int i = 0; i != PerfCounterCount; ++i) {
+    if (fds[i] >= 0)
+      close(fds[i]);
+    fds[i] = -1;
+  }
+#endif
+}
+
+#endif // SWIFT_BENCHMARK_PERFCOUNTERS_H
@@ -55,6 +55,40 @@ public func CheckResults(_ res: Bool, _ message: String = "") {
 
 public func False() -> Bool { return false }
 
+final class ConcurrentBody {
+  let body: (Int) -> Void
+  let index: Int
+
+  init(_ body: (Int) -> Void, _ index: Int) {
+    self.body = body
+    self.index = index
+  }
+}
+
+/// Calls `body` on `threadCount` threads at once, passing each the index of
+/// its thread, and returns after all calls returned. Index 0 runs on the
+/// calling thread.
+public func RunConcurrently(_ threadCount: Int, _ body: (Int) -> Void) {
+  var threads = [pthread_t?]()
+  for i in 1..<max(threadCount, 1) {
+    let context = Unmanaged.passRetained(ConcurrentBody(body, i)).toOpaque()
+    var thread: pthread_t? = nil
+    let result = pthread_create(&thread, nil, { context in
+      let concurrentBody = Unmanaged<ConcurrentBody>
+        .fromOpaque(context!)
+        .takeRetainedValue()
+      concurrentBody.body(concurrentBody.index)
+      return nil
+    }, context)
+    CheckResults(result == 0, "pthread_create failed")
+    threads.append(thread)
+  }
+  body(0)
+  for thread in threads {
+    pthread_join(thread!, nil)
+  }
+}
+
 /// This is a dummy protocol to test the speed of our protocol dispatch.
 public protocol SomeProtocol { func getValue() -> Int }
 struct MyStruct : SomeProtocol {
@@ -47,6 +47,7 @@ import DictionaryRemove
 import DictionarySwap
 import ErrorHandling
 import Fibonacci
+import FloatToString
 import GlobalClass
 import Hanoi
 import Hash
@@ -58,6 +59,7 @@ import MapReduce
 import Memset
 import MonteCarloE
 import MonteCarloPi
+import MultiPayloadEnum
 import NSDictionaryCastToSwift
 import NSError
 import NSStringConversion
@@ -78,6 +80,7 @@ import RC4
 import RGBHistogram
 import RangeAssignment
 import RecursiveOwnedParameter
+import RuntimeConcurrency
 import SetTests
 import SevenBoom
 import Sim2DArray
@@ -96,6 +99,7 @@ import TwoSum
 import TypeFlood
 import UTF8Decode
 import Walsh
+import WeakReferences
 import XorLoop
 
 precommitTests = [
@@ -120,6 +124,22 @@ precommitTests = [
   "CaptureProp": run_CaptureProp,
   "Chars": run_Chars,
   "ClassArrayGetter": run_ClassArrayGetter,
+  "ConcurrentAllocation1": run_ConcurrentAllocation1,
+  "ConcurrentAllocation2": run_ConcurrentAllocation2,
+  "ConcurrentAllocation4": run_ConcurrentAllocation4,
+  "ConcurrentAllocation8": run_ConcurrentAllocation8,
+  "ConcurrentGenericMetadata1": run_ConcurrentGenericMetadata1,
+  "ConcurrentGenericMetadata2": run_ConcurrentGenericMetadata2,
+  "ConcurrentGenericMetadata4": run_ConcurrentGenericMetadata4,
+  "ConcurrentGenericMetadata8": run_ConcurrentGenericMetadata8,
+  "ConcurrentProtocolCast1": run_ConcurrentProtocolCast1,
+  "ConcurrentProtocolCast2": run_ConcurrentProtocolCast2,
+  "ConcurrentProtocolCast4": run_ConcurrentProtocolCast4,
+  "ConcurrentProtocolCast8": run_ConcurrentProtocolCast8,
+  "ConcurrentRetainRelease1": run_ConcurrentRetainRelease1,
+  "ConcurrentRetainRelease2": run_ConcurrentRetainRelease2,
+  "ConcurrentRetainRelease4": run_ConcurrentRetainRelease4,
+  "ConcurrentRetainRelease8": run_ConcurrentRetainRelease8,
   "DeadArray": run_DeadArray,
   "Dictionary": run_Dictionary,
   "DictionaryOfObjects": run_DictionaryOfObjects,
@@ -134,6 +154,8 @@ precommitTests = [
   "DictionarySwap": run_DictionarySwap,
   "DictionarySwapOfObjects": run_DictionarySwapOfObjects,
   "ErrorHandling": run_ErrorHandling,
+  "FloatToString": run_FloatToString,
+  "FloatToStringExtremeMagnitudes": run_FloatToStringExtremeMagnitudes,
   "GlobalClass": run_GlobalClass,
   "Hanoi": run_Hanoi,
   "HashTest": run_HashTest,
@@ -145,6 +167,7 @@ precommitTests = [
   "Memset": run_Memset,
   "MonteCarloE": run_MonteCarloE,
   "MonteCarloPi": run_MonteCarloPi,
+  "MultiPayloadEnum": run_MultiPayloadEnum,
   "NSDictionaryCastToSwift": run_NSDictionaryCastToSwift,
   "NSError": run_NSError,
   "NSStringConversion": run_NSStringConversion,
@@ -217,7 +240,13 @@ precommitTests = [
   "TwoSum": run_TwoSum,
   "TypeFlood": run_TypeFlood,
   "UTF8Decode": run_UTF8Decode,
+  "UTF8DecodeToString": run_UTF8DecodeToString,
   "Walsh": run_Walsh,
+  "WeakCopy": run_WeakCopy,
+  "WeakLoadDead": run_WeakLoadDead,
+  "WeakLoadLive": run_WeakLoadLive,
+  "WeakLoadNil": run_WeakLoadNil,
+  "WeakStore": run_WeakStore,
   "XorLoop": run_XorLoop,
 ]
 
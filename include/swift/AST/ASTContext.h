@@ -83,6 +83,7 @@ namespace swift {
   class Substitution;
   class TypeCheckerDebugConsumer;
   class DocComment;
+  class UnifiedStatsReporter;
 
   enum class KnownProtocolKind : uint8_t;
 
@@ -102,6 +103,33 @@ enum class AllocationArena {
   ConstraintSolver
 };
 
+/// The kind of AST node an ASTContext allocation is for, which the
+/// ASTContext keeps totals of the allocated bytes for.
+enum class AllocationCategory : uint8_t {
+  Decl,
+  Type,
+  Expr,
+  Stmt,
+  Pattern,
+  Conformance,
+  /// Everything else, like identifiers, arrays and side tables.
+  Other
+};
+const unsigned NumAllocationCategories =
+  unsigned(AllocationCategory::Other) + 1;
+
+/// The part of the compiler which creates the AST nodes being allocated.
+enum class AllocationOrigin : uint8_t {
+  /// Parsing, type checking and everything else.
+  Source,
+  /// Loading declarations and types from serialized modules.
+  Deserialization,
+  /// Importing declarations and types from Clang modules.
+  ClangImporter
+};
+const unsigned NumAllocationOrigins =
+  unsigned(AllocationOrigin::ClangImporter) + 1;
+
 /// Lists the set of "known" Foundation entities that are used in the
 /// compiler.
 ///
@@ -191,11 +219,26 @@ public:
   /// Diags - The diagnostics engine.
   DiagnosticEngine &Diags;
 
+  /// The collector of counters and phase timers for this compilation job, or
+  /// null if the frontend was not passed -stats-output-dir.
+  UnifiedStatsReporter *Stats = nullptr;
+
   /// The set of top-level modules we have loaded.
   /// This map is used for iteration, therefore it's a MapVector and not a
   /// DenseMap.
   llvm::MapVector<Identifier, ModuleDecl*> LoadedModules;
 
+  /// The types the debugger reconstructed from mangled names, see
+  /// swift::ide::getTypeFromMangledTypename(), keyed by the mangled name
+  /// with a prefix telling whether it was a type name ('T') or a symbol name
+  /// ('S'). Names which did not resolve map to a null type and the error.
+  ///
+  /// Loading a module may change how the names resolve, so the entries are
+  /// only valid as long as there are ReconstructedTypesModuleCount loaded
+  /// modules.
+  llvm::StringMap<std::pair<Type, std::string>> ReconstructedTypes;
+  size_t ReconstructedTypesModuleCount = 0;
+
   /// The builtin module.
   ModuleDecl * const TheBuiltinModule;
 
@@ -238,6 +281,14 @@ public:
                  CanGenericSignature> ManglingSignatures;
 
 private:
+  /// The bytes allocated so far, by arena, origin and category.
+  mutable size_t
+    AllocatedBytes[unsigned(AllocationArena::ConstraintSolver) + 1]
+                  [NumAllocationOrigins][NumAllocationCategories] = {};
+
+  /// The origin the allocations are made for at the moment.
+  AllocationOrigin CurrentAllocationOrigin = AllocationOrigin::Source;
+
   /// \brief The current generation number, which reflects the number of
   /// times that external modules have been loaded.
   ///
@@ -253,10 +304,15 @@ public:
 
   /// Allocate - Allocate memory from the ASTContext bump pointer.
   void *Allocate(unsigned long bytes, unsigned alignment,
-                 AllocationArena arena = AllocationArena::Permanent) const {
+                 AllocationArena arena = AllocationArena::Permanent,
+                 AllocationCategory category = AllocationCategory::Other)
+      const {
     if (bytes == 0)
       return nullptr;
 
+    AllocatedBytes[unsigned(arena)][unsigned(CurrentAllocationOrigin)]
+                  [unsigned(category)] += bytes;
+
     if (LangOpts.UseMalloc)
       return AlignedAlloc(bytes, alignment);
     
@@ -771,6 +827,29 @@ public:
   /// \brief Returns memory used exclusively by constraint solver.
   size_t getSolverMemory() const;
 
+  /// Returns the number of bytes allocated so far in \p arena for AST nodes
+  /// of \p category which were created by \p origin. For the constraint
+  /// solver's arena, this includes the memory of the arenas that are gone.
+  size_t getAllocatedBytes(AllocationArena arena, AllocationOrigin origin,
+                           AllocationCategory category) const {
+    return AllocatedBytes[unsigned(arena)][unsigned(origin)]
+                         [unsigned(category)];
+  }
+
+  /// Attributes the allocations made during its lifetime to an origin.
+  class AllocationOriginRAII {
+    ASTContext &Ctx;
+    AllocationOrigin Saved;
+
+  public:
+    AllocationOriginRAII(ASTContext &ctx, AllocationOrigin origin)
+      : Ctx(ctx), Saved(ctx.CurrentAllocationOrigin) {
+      ctx.CurrentAllocationOrigin = origin;
+    }
+
+    ~AllocationOriginRAII() { Ctx.CurrentAllocationOrigin = Saved; }
+  };
+
   /// Complain if @objc or dynamic is used without importing Foundation.
   void diagnoseAttrsRequiringFoundation(SourceFile &SF);
 
@@ -80,6 +80,14 @@ public:
 Optional<DocComment *>getDocComment(swift::markup::MarkupContext &Context,
                                     const Decl *D);
 
+/// Returns the brief description of the documentation comment of \p D, that
+/// is, the paragraph it starts with, if any.
+///
+/// Unlike getDocComment, this only parses the lines up to the first blank
+/// one, which contain the first paragraph.
+const swift::markup::Paragraph *
+getBriefDocComment(swift::markup::MarkupContext &Context, const Decl *D);
+
 } // namespace swift
 
 #endif // LLVM_SWIFT_AST_COMMENT_H
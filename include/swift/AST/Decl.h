@@ -841,7 +841,7 @@ void *allocateMemoryForDecl(AllocatorTy &allocator, size_t baseSize,
   if (includeSpaceForClangNode)
     size += alignof(DeclTy);
 
-  void *mem = allocator.Allocate(size, alignof(DeclTy));
+  void *mem = Decl::operator new(size, allocator, alignof(DeclTy));
   if (includeSpaceForClangNode)
     mem = reinterpret_cast<char *>(mem) + alignof(DeclTy);
   return mem;
@@ -3414,6 +3414,10 @@ class ProtocolDecl : public NominalTypeDecl {
 
   ArrayRef<ProtocolDecl *> InheritedProtocols;
 
+  /// The associated types declared within this protocol, computed lazily
+  /// by getAssociatedTypeMembers().
+  mutable ArrayRef<AssociatedTypeDecl *> AssociatedTypes;
+
   llvm::DenseMap<ValueDecl *, ConcreteDeclRef> DefaultWitnesses;
 
   /// True if the protocol has requirements that cannot be satisfied (e.g.
@@ -3423,6 +3427,9 @@ class ProtocolDecl : public NominalTypeDecl {
   /// Whether we have already set the list of inherited protocols.
   unsigned InheritedProtocolsSet : 1;
 
+  /// Whether AssociatedTypes has been computed.
+  mutable unsigned AssociatedTypesValid : 1;
+
   bool requiresClassSlow();
 
   bool existentialConformsToSelfSlow();
@@ -3441,6 +3448,14 @@ public:
   /// \brief Determine whether this protocol inherits from the given ("super")
   /// protocol.
   bool inheritsFrom(const ProtocolDecl *Super) const;
+
+  /// Retrieve the associated types declared within this protocol, in
+  /// declaration order.
+  ///
+  /// The list is computed from the members the first time it is requested
+  /// and cached afterwards, so this must not be called before all of the
+  /// protocol's members have been added.
+  ArrayRef<AssociatedTypeDecl *> getAssociatedTypeMembers() const;
   
   ProtocolType *getDeclaredType() const {
     return reinterpret_cast<ProtocolType *>(DeclaredTy.getPointer());
@@ -4700,8 +4715,11 @@ public:
 
   /// \brief Note that the body was skipped for this function.  Function body
   /// cannot be attached after this call.
+  ///
+  /// A parsed body may be dropped this way if it is not needed.
   void setBodySkipped(SourceRange bodyRange) {
-    assert(getBodyKind() == BodyKind::None);
+    assert(getBodyKind() == BodyKind::None ||
+           getBodyKind() == BodyKind::Parsed);
     BodyRange = bodyRange;
     setBodyKind(BodyKind::Skipped);
   }
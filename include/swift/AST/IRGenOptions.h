@@ -159,6 +159,26 @@ public:
   /// Enable use of the swiftcall calling convention.
   unsigned UseSwiftCall : 1;
 
+  /// Share the copy and destroy value witnesses of types which only hold
+  /// native references among all types with the same layout.
+  unsigned UseLayoutValueWitnesses : 1;
+
+  /// Copy and destroy loadable values which take several reference counting
+  /// operations by calling helpers shared by all functions, rather than
+  /// emitting the operations inline.
+  unsigned UseOutlinedValueOperations : 1;
+
+  /// In whole-module compilation, free the SIL body of every function as
+  /// soon as IRGen has lowered it, so that the SIL and the LLVM IR of a
+  /// function don't both stay alive until the end of IRGen. Nothing may look
+  /// at the SIL function bodies after IRGen then.
+  unsigned ReleaseSILFunctionBodies : 1;
+
+  /// In whole-module compilation, don't emit the conformance records of
+  /// conformances to non-public protocols which the module never uses as
+  /// existential types. Nothing can dynamically cast to such a protocol.
+  unsigned StripUnusedConformanceRecords : 1;
+
   /// List of backend command-line options for -embed-bitcode.
   std::vector<uint8_t> CmdArgs;
 
@@ -175,7 +195,10 @@ public:
         PrintInlineTree(false), EmbedMode(IRGenEmbedMode::None),
         HasValueNamesSetting(false), ValueNames(false),
         EnableReflectionMetadata(true), EnableReflectionNames(true),
-        UseIncrementalLLVMCodeGen(true), UseSwiftCall(false), CmdArgs(),
+        UseIncrementalLLVMCodeGen(true), UseSwiftCall(false),
+        UseLayoutValueWitnesses(false), UseOutlinedValueOperations(false),
+        ReleaseSILFunctionBodies(false), StripUnusedConformanceRecords(false),
+        CmdArgs(),
         SanitizeCoverage(llvm::SanitizerCoverageOptions()) {}
 
   /// Gets the name of the specified output filename.
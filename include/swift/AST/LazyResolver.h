@@ -17,6 +17,7 @@
 #ifndef SWIFT_AST_LAZYRESOLVER_H
 #define SWIFT_AST_LAZYRESOLVER_H
 
+#include "swift/AST/Identifier.h"
 #include "swift/AST/TypeLoc.h"
 #include "llvm/ADT/PointerEmbeddedInt.h"
 
@@ -26,7 +27,7 @@ class AssociatedTypeDecl;
 class Decl;
 class DeclContext;
 class ExtensionDecl;
-class Identifier;
+class IterableDeclContext;
 class NominalTypeDecl;
 class NormalProtocolConformance;
 class ProtocolConformance;
@@ -189,6 +190,19 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Populates \p members with the members of \p IDC named \p name, without
+  /// loading any of its other members.
+  ///
+  /// The implementation should \em not add the members to \p IDC.
+  ///
+  /// Returns true if the members could not be loaded by name, in which case
+  /// the caller must load all members instead.
+  virtual bool
+  loadNamedMembers(const IterableDeclContext *IDC, Identifier name,
+                   uint64_t contextData, SmallVectorImpl<ValueDecl *> &members) {
+    return true;
+  }
+
   /// Populates the given vector with all conformances for \p D.
   ///
   /// The implementation should \em not call setConformances on \p D.
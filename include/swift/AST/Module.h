@@ -211,6 +211,16 @@ private:
   /// The magic __dso_handle variable.
   VarDecl *DSOHandle;
 
+  /// The name of the group of modules which are always built together with
+  /// this one, or empty if there is no such group.
+  ///
+  /// \see isInSameResilienceDomain
+  Identifier ResilienceDomain;
+
+  /// Incremented whenever the set of top-level declarations which lookups
+  /// into this module can find may have changed.
+  unsigned LookupGeneration = 0;
+
   ModuleDecl(Identifier name, ASTContext &ctx);
 
 public:
@@ -230,6 +240,15 @@ public:
   void addFile(FileUnit &newFile);
   void removeFile(FileUnit &existingFile);
 
+  /// Returns a number which changes whenever files are added to or removed
+  /// from this module, or when one of its source files drops its lookup
+  /// cache.
+  ///
+  /// Lookup results which are cached outside of the module are only valid
+  /// while this number stays the same.
+  unsigned getLookupGeneration() const { return LookupGeneration; }
+  void bumpLookupGeneration() { ++LookupGeneration; }
+
   /// Convenience accessor for clients that know what kind of file they're
   /// dealing with.
   SourceFile &getMainSourceFile(SourceFileKind expectedKind) const;
@@ -272,6 +291,23 @@ public:
     Flags.ResilienceStrategy = unsigned(strategy);
   }
 
+  Identifier getResilienceDomain() const { return ResilienceDomain; }
+  void setResilienceDomain(Identifier domain) { ResilienceDomain = domain; }
+
+  /// Returns true if \p other is this module, or is built together with it
+  /// as part of the same named resilience domain.
+  ///
+  /// Modules in the same resilience domain may use fixed layouts and direct
+  /// access for each other's resilient declarations, since they are always
+  /// recompiled together. Clients outside the domain still see the resilient
+  /// interfaces.
+  bool isInSameResilienceDomain(const ModuleDecl *other) const {
+    if (this == other)
+      return true;
+    return !ResilienceDomain.empty() &&
+           ResilienceDomain == other->ResilienceDomain;
+  }
+
   /// Look up a (possibly overloaded) value set at top-level scope
   /// (but with the specified access path, which may come from an import decl)
   /// within the current module.
@@ -385,6 +421,14 @@ public:
   /// The order of the results is not guaranteed to be meaningful.
   void getLocalTypeDecls(SmallVectorImpl<TypeDecl*> &Results) const;
 
+  /// Finds all conformances to \p protocol declared in this module.
+  ///
+  /// This does a simple local lookup, not recursively looking through imports.
+  /// The order of the results is not guaranteed to be meaningful.
+  void lookupConformancesTo(ProtocolDecl *protocol,
+                            SmallVectorImpl<ProtocolConformance *> &results)
+    const;
+
   /// Finds all top-level decls that should be displayed to a client of this
   /// module.
   ///
@@ -640,6 +684,15 @@ public:
   /// The order of the results is not guaranteed to be meaningful.
   virtual void getLocalTypeDecls(SmallVectorImpl<TypeDecl*> &results) const {}
 
+  /// Finds all conformances to \p protocol declared in this file, including
+  /// the ones of nested types.
+  ///
+  /// This does a simple local lookup, not recursively looking through imports.
+  /// The order of the results is not guaranteed to be meaningful.
+  virtual void
+  lookupConformancesTo(ProtocolDecl *protocol,
+                       SmallVectorImpl<ProtocolConformance *> &results) const {}
+
   /// Adds all top-level decls to the given vector.
   ///
   /// This includes all decls that should be displayed to clients of the module.
@@ -892,6 +945,16 @@ public:
   OperatorMap<PostfixOperatorDecl*> PostfixOperators;
   OperatorMap<PrefixOperatorDecl*> PrefixOperators;
 
+  /// The results of unqualified lookups which did not find anything in a
+  /// local scope of this file and had to look into the module and its
+  /// imports, keyed by name and whether only types were requested.
+  llvm::DenseMap<std::pair<DeclName, unsigned>, TinyPtrVector<ValueDecl *>>
+    ModuleScopeLookups;
+
+  /// The module lookup generation and AST generation for which
+  /// ModuleScopeLookups is valid.
+  std::pair<unsigned, unsigned> ModuleScopeLookupsGeneration;
+
   /// Describes what kind of file this is, which can affect some type checking
   /// and other behavior.
   const SourceFileKind Kind;
@@ -950,6 +1013,10 @@ public:
   virtual void
   getLocalTypeDecls(SmallVectorImpl<TypeDecl*> &results) const override;
 
+  virtual void lookupConformancesTo(
+      ProtocolDecl *protocol,
+      SmallVectorImpl<ProtocolConformance *> &results) const override;
+
   virtual void
   getImportedModules(SmallVectorImpl<ModuleDecl::ImportedModule> &imports,
                      ModuleDecl::ImportFilter filter) const override;
@@ -1080,7 +1147,7 @@ public:
     InterfaceHash.update(a);
   }
 
-  const llvm::MD5 &getInterfaceHashState() { return InterfaceHash; }
+  const llvm::MD5 &getInterfaceHashState() const { return InterfaceHash; }
   void setInterfaceHashState(const llvm::MD5 &state) { InterfaceHash = state; }
 
   void getInterfaceHash(llvm::SmallString<32> &str) {
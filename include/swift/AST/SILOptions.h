@@ -31,6 +31,17 @@ public:
 
   /// The number of threads for multi-threaded code generation.
   int NumThreads = 0;
+
+  /// Run function passes which support it on independent functions in
+  /// parallel, using NumThreads threads.
+  bool ParallelFunctionPasses = false;
+
+  /// Record the time, the change of the instruction count and the analysis
+  /// invalidations of every SIL pass in the -stats-output-dir statistics.
+  bool PassStats = false;
+
+  /// With PassStats, also record them for every function a pass runs on.
+  bool PassStatsPerFunction = false;
   
   enum LinkingMode {
     /// Skip SIL linking.
@@ -101,6 +112,18 @@ public:
   /// Emit a mapping of profile counters for use in coverage.
   bool EmitProfileCoverageMapping = false;
 
+  /// The path of an indexed profile (.profdata) from an instrumented run. If
+  /// it is set, SILGen attaches the execution counts to the SIL.
+  std::string UseProfile;
+
+  /// The path of a sampled profile of the targets of class_method and
+  /// witness_method calls. See SILReceiverProfile.
+  std::string UseReceiverProfile;
+
+  /// If set, the generic specializers append a JSON record of every
+  /// specialization they create, reuse or reject to this file.
+  std::string SpecializationRemarksPath;
+
   /// Should we use a pass pipeline passed in via a json file? Null by default.
   llvm::StringRef ExternalPassPipelineFilename;
   
@@ -155,8 +155,19 @@ private:
 
   AvailabilityContext AvailabilityInfo;
 
+  /// The child contexts. Their source ranges don't overlap, so once they
+  /// are sorted by their start, a lookup can binary-search them.
   std::vector<TypeRefinementContext *> Children;
 
+  /// Whether Children is known to be sorted by the start of the source
+  /// ranges.
+  bool ChildrenSorted = true;
+
+  /// The context which the last lookup starting at this context found.
+  /// Lookups tend to come in source order, so the next one is likely to be
+  /// in it or one of its descendants.
+  TypeRefinementContext *LastFound = nullptr;
+
   TypeRefinementContext(ASTContext &Ctx, IntroNode Node,
                         TypeRefinementContext *Parent, SourceRange SrcRange,
                         const AvailabilityContext &Info);
@@ -239,6 +250,7 @@ public:
   void addChild(TypeRefinementContext *Child) {
     assert(Child->getSourceRange().isValid());
     Children.push_back(Child);
+    ChildrenSorted = false;
   }
 
   /// Returns the inner-most TypeRefinementContext descendant of this context
@@ -246,6 +258,11 @@ public:
   TypeRefinementContext *findMostRefinedSubContext(SourceLoc Loc,
                                                    SourceManager &SM);
 
+private:
+  /// Returns the child context whose source range contains \p Loc, if any.
+  TypeRefinementContext *findChildContaining(SourceLoc Loc, SourceManager &SM);
+
+public:
   LLVM_ATTRIBUTE_DEPRECATED(
       void dump(SourceManager &SrcMgr) const LLVM_ATTRIBUTE_USED,
       "only for use within the debugger");
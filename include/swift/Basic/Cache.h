@@ -71,6 +71,15 @@ public:
     void (*valueDestroyCB)(void *Value, void *UserData);
   };
 
+  /// Counts of the lookups and evictions of a cache.
+  struct Statistics {
+    size_t Hits = 0;
+    size_t Misses = 0;
+    size_t Evictions = 0;
+    /// The total cost of the values in the cache.
+    size_t TotalCost = 0;
+  };
+
 protected:
   CacheImpl() = default;
 
@@ -129,6 +138,19 @@ protected:
   /// Invokes \c remove on all keys.
   void removeAll();
 
+  /// Bounds the total cost of the values in the cache.
+  ///
+  /// When the total cost exceeds the limit, the least recently used values
+  /// which are not retained are evicted. By default, the limit is a quarter
+  /// of the memory limit of the process's cgroup on Linux; the caches also
+  /// evict half of their values when the cgroup is close to its limit. On
+  /// Darwin, libcache manages memory pressure itself and ignores the limit.
+  void setCostLimit(size_t Limit);
+
+  /// Returns the cache's counts of hits, misses and evictions. libcache
+  /// doesn't report these, so they are all zero on Darwin.
+  Statistics getStatistics();
+
   /// Destroys cache.
   void destroy();
 };
@@ -192,6 +214,10 @@ public:
     removeAll();
   }
 
+  using CacheImpl::Statistics;
+  using CacheImpl::getStatistics;
+  using CacheImpl::setCostLimit;
+
 private:
   static uintptr_t keyHash(void *Key, void *UserData) {
     return KeyInfoT::getHashValue(*static_cast<KeyT*>(Key));
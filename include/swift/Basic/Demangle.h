@@ -14,10 +14,13 @@
 #define SWIFT_BASIC_DEMANGLE_H
 
 #include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include "llvm/ADT/StringRef.h"
 #include "swift/Basic/Malloc.h"
 
@@ -69,7 +72,8 @@ struct DemangleOptions {
 };
 
 class Node;
-typedef std::shared_ptr<Node> NodePointer;
+typedef Node *NodePointer;
+class NodeFactory;
 
 enum class FunctionSigSpecializationParamKind : unsigned {
   // Option Flags use bits 0-5. This give us 6 bits implying 64 entries to
@@ -135,7 +139,13 @@ enum class Directness {
   Direct, Indirect
 };
 
-class Node : public std::enable_shared_from_this<Node> {
+/// A node in a demangle tree.
+///
+/// Nodes and their children are allocated in the NodeFactory which created
+/// them and they are never destroyed individually: the whole tree is freed
+/// at once when the factory is cleared or destroyed. A node may be the child
+/// of several parents, e.g. when a substitution is referenced repeatedly.
+class Node {
 public:
   enum class Kind : uint16_t {
 #define NODE(ID) ID,
@@ -152,21 +162,25 @@ private:
   };
   PayloadKind NodePayloadKind;
 
+  uint32_t NumChildren = 0;
+  uint32_t ReservedChildren = 0;
+  NodePointer *Children = nullptr;
+
   union {
-    std::string TextPayload;
+    struct {
+      const char *Data;
+      size_t Length;
+    } TextPayload;
     IndexType IndexPayload;
   };
 
-  // FIXME: use allocator.
-  typedef std::vector<NodePointer> NodeVector;
-  NodeVector Children;
-
   Node(Kind k)
       : NodeKind(k), NodePayloadKind(PayloadKind::None) {
   }
-  Node(Kind k, std::string &&t)
+  Node(Kind k, llvm::StringRef t)
       : NodeKind(k), NodePayloadKind(PayloadKind::Text) {
-    new (&TextPayload) std::string(std::move(t));
+    TextPayload.Data = t.data();
+    TextPayload.Length = t.size();
   }
   Node(Kind k, IndexType index)
       : NodeKind(k), NodePayloadKind(PayloadKind::Index) {
@@ -175,17 +189,15 @@ private:
   Node(const Node &) = delete;
   Node &operator=(const Node &) = delete;
 
-  friend struct NodeFactory;
+  friend class NodeFactory;
 
 public:
-  ~Node();
-
   Kind getKind() const { return NodeKind; }
 
   bool hasText() const { return NodePayloadKind == PayloadKind::Text; }
-  const std::string &getText() const {
+  llvm::StringRef getText() const {
     assert(hasText());
-    return TextPayload;
+    return llvm::StringRef(TextPayload.Data, TextPayload.Length);
   }
 
   bool hasIndex() const { return NodePayloadKind == PayloadKind::Index; }
@@ -194,60 +206,190 @@ public:
     return IndexPayload;
   }
   
-  typedef NodeVector::iterator iterator;
-  typedef NodeVector::const_iterator const_iterator;
-  typedef NodeVector::size_type size_type;
-
-  bool hasChildren() const { return !Children.empty(); }
-  size_t getNumChildren() const { return Children.size(); }
-  iterator begin() { return Children.begin(); }
-  iterator end() { return Children.end(); }
-  const_iterator begin() const { return Children.begin(); }
-  const_iterator end() const { return Children.end(); }
-
-  NodePointer getFirstChild() const { return Children.front(); }
-  NodePointer getChild(size_t index) const { return Children[index]; }
+  typedef NodePointer *iterator;
+  typedef const NodePointer *const_iterator;
+  typedef size_t size_type;
+
+  bool hasChildren() const { return NumChildren != 0; }
+  size_t getNumChildren() const { return NumChildren; }
+  iterator begin() { return Children; }
+  iterator end() { return Children + NumChildren; }
+  const_iterator begin() const { return Children; }
+  const_iterator end() const { return Children + NumChildren; }
+
+  NodePointer getFirstChild() const {
+    assert(NumChildren != 0);
+    return Children[0];
+  }
+  NodePointer getChild(size_t index) const {
+    assert(index < NumChildren);
+    return Children[index];
+  }
 
-  /// Add a new node as a child of this one.
+  /// Add a new node as a child of this one. The child array is (re)allocated
+  /// in \p Factory, which must be the factory that created this node.
   ///
-  /// \param child - should have no parent or siblings
   /// \returns child
-  NodePointer addChild(NodePointer child) {
-    assert(child && "adding null child!");
-    Children.push_back(child);
-    return child;
-  }
+  NodePointer addChild(NodePointer child, NodeFactory &Factory);
 
   /// A convenience method for adding two children at once.
-  void addChildren(NodePointer child1, NodePointer child2) {
-    addChild(std::move(child1));
-    addChild(std::move(child2));
+  void addChildren(NodePointer child1, NodePointer child2,
+                   NodeFactory &Factory) {
+    addChild(child1, Factory);
+    addChild(child2, Factory);
   }
 };
 
+/// A bump-pointer arena which owns all the nodes of demangle trees and the
+/// strings and child arrays they refer to.
+///
+/// Memory is carved out of a list of slabs which only grows until the factory
+/// is cleared or destroyed. This replaces per-node reference counting: a
+/// tree stays valid exactly as long as the factory which created it.
+///
+/// The factory is deliberately self-contained (it does not use the LLVM
+/// support library) because it is also compiled into the runtime.
+class NodeFactory {
+  /// The header of a slab. The slab's memory follows the header.
+  struct Slab {
+    Slab *Previous;
+    size_t Size;
+  };
+
+  /// The most recently allocated slab.
+  Slab *CurrentSlab = nullptr;
+
+  /// The next free byte in the current slab.
+  char *CurPtr = nullptr;
+
+  /// The end of the current slab.
+  char *End = nullptr;
+
+  /// The size of the next slab that will be allocated. Slabs grow
+  /// geometrically so that large trees need few of them.
+  size_t NextSlabSize = InitialSlabSize;
+
+  /// The number of bytes handed out since the last clear().
+  size_t BytesAllocated = 0;
+
+  static const size_t InitialSlabSize = 1024;
+  static const size_t MaxSlabSize = 64 * 1024;
+
+  void *allocateSlow(size_t Size, size_t Alignment);
+  void freeSlabs(Slab *Until);
+
+  static char *alignPtr(char *Ptr, size_t Alignment) {
+    return (char *)(((uintptr_t)Ptr + Alignment - 1) & ~(Alignment - 1));
+  }
+
+public:
+  NodeFactory() {}
+  NodeFactory(const NodeFactory &) = delete;
+  NodeFactory &operator=(const NodeFactory &) = delete;
+  ~NodeFactory() { freeSlabs(nullptr); }
+
+  /// Allocate \p Size bytes with the given \p Alignment.
+  void *allocate(size_t Size, size_t Alignment) {
+    char *Result = alignPtr(CurPtr, Alignment);
+    if (!CurPtr || Result + Size > End)
+      return allocateSlow(Size, Alignment);
+    CurPtr = Result + Size;
+    BytesAllocated += Size;
+    return Result;
+  }
+
+  /// Allocate uninitialized memory for \p NumObjects objects of type T.
+  template <typename T> T *Allocate(size_t NumObjects = 1) {
+    return static_cast<T *>(allocate(sizeof(T) * NumObjects, alignof(T)));
+  }
+
+  /// Grow the array \p Objects, which holds \p OldCapacity objects, to hold
+  /// \p NewCapacity objects. If the array is the last allocation in the
+  /// current slab it is extended in place, otherwise it is copied.
+  template <typename T>
+  T *Reallocate(T *Objects, size_t OldCapacity, size_t NewCapacity) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "arena arrays are copied with memcpy");
+    assert(NewCapacity > OldCapacity);
+    char *OldEnd = (char *)(Objects + OldCapacity);
+    if (Objects && OldEnd == CurPtr &&
+        (char *)(Objects + NewCapacity) <= End) {
+      CurPtr = (char *)(Objects + NewCapacity);
+      BytesAllocated += (NewCapacity - OldCapacity) * sizeof(T);
+      return Objects;
+    }
+    T *NewObjects = Allocate<T>(NewCapacity);
+    if (OldCapacity)
+      memcpy(NewObjects, Objects, OldCapacity * sizeof(T));
+    return NewObjects;
+  }
+
+  /// Copy \p Text into the arena.
+  llvm::StringRef copyString(llvm::StringRef Text) {
+    if (Text.empty())
+      return llvm::StringRef();
+    char *Mem = Allocate<char>(Text.size());
+    memcpy(Mem, Text.data(), Text.size());
+    return llvm::StringRef(Mem, Text.size());
+  }
+
+  NodePointer createNode(Node::Kind K) {
+    return new (Allocate<Node>()) Node(K);
+  }
+  NodePointer createNode(Node::Kind K, Node::IndexType Index) {
+    return new (Allocate<Node>()) Node(K, Index);
+  }
+  NodePointer createNode(Node::Kind K, llvm::StringRef Text) {
+    return new (Allocate<Node>()) Node(K, copyString(Text));
+  }
+
+  /// Free all nodes allocated by this factory. All trees created by it are
+  /// invalidated. The first slab is kept for reuse.
+  void clear();
+
+  /// Returns the number of bytes allocated since the last clear().
+  size_t getBytesAllocated() const { return BytesAllocated; }
+};
+
+inline NodePointer Node::addChild(NodePointer child, NodeFactory &Factory) {
+  assert(child && "adding null child!");
+  if (NumChildren == ReservedChildren) {
+    size_t NewCapacity = ReservedChildren ? ReservedChildren * 2 : 4;
+    Children = Factory.Reallocate(Children, ReservedChildren, NewCapacity);
+    ReservedChildren = NewCapacity;
+  }
+  Children[NumChildren++] = child;
+  return child;
+}
+
 /// \brief Demangle the given string as a Swift symbol.
 ///
 /// Typical usage:
 /// \code
+///   NodeFactory Factory;
 ///   NodePointer aDemangledName =
-/// swift::Demangler::demangleSymbolAsNode("SomeSwiftMangledName")
+/// swift::Demangler::demangleSymbolAsNode("SomeSwiftMangledName", Factory)
 /// \endcode
 ///
 /// \param mangledName The mangled string.
+/// \param Factory The arena which owns the returned tree.
 /// \param options An object encapsulating options to use to perform this demangling.
 ///
 ///
 /// \returns A parse tree for the demangled string - or a null pointer
-/// on failure.
+/// on failure. The tree is valid as long as \p Factory is not cleared or
+/// destroyed.
 ///
 NodePointer
 demangleSymbolAsNode(const char *mangledName, size_t mangledNameLength,
+                     NodeFactory &Factory,
                      const DemangleOptions &options = DemangleOptions());
 
 inline NodePointer
-demangleSymbolAsNode(const std::string &mangledName,
+demangleSymbolAsNode(const std::string &mangledName, NodeFactory &Factory,
                      const DemangleOptions &options = DemangleOptions()) {
-  return demangleSymbolAsNode(mangledName.data(), mangledName.size(), options);
+  return demangleSymbolAsNode(mangledName.data(), mangledName.size(), Factory,
+                              options);
 }
 
 /// \brief Demangle the given string as a Swift symbol.
@@ -279,25 +421,30 @@ demangleSymbolAsString(const std::string &mangledName,
 ///
 /// Typical usage:
 /// \code
+///   NodeFactory Factory;
 ///   NodePointer aDemangledName =
-/// swift::Demangler::demangleTypeAsNode("SomeSwiftMangledName")
+/// swift::Demangler::demangleTypeAsNode("SomeSwiftMangledName", Factory)
 /// \endcode
 ///
 /// \param mangledName The mangled string.
+/// \param Factory The arena which owns the returned tree.
 /// \param options An object encapsulating options to use to perform this demangling.
 ///
 ///
 /// \returns A parse tree for the demangled string - or a null pointer
-/// on failure.
+/// on failure. The tree is valid as long as \p Factory is not cleared or
+/// destroyed.
 ///
 NodePointer
 demangleTypeAsNode(const char *mangledName, size_t mangledNameLength,
+                   NodeFactory &Factory,
                    const DemangleOptions &options = DemangleOptions());
 
 inline NodePointer
-demangleTypeAsNode(const std::string &mangledName,
+demangleTypeAsNode(const std::string &mangledName, NodeFactory &Factory,
                    const DemangleOptions &options = DemangleOptions()) {
-  return demangleTypeAsNode(mangledName.data(), mangledName.size(), options);
+  return demangleTypeAsNode(mangledName.data(), mangledName.size(), Factory,
+                            options);
 }
 
 /// \brief Demangle the given string as a Swift type mangling.
@@ -317,6 +464,24 @@ demangleTypeAsString(const std::string &mangledName,
   return demangleTypeAsString(mangledName.data(), mangledName.size(), options);
 }
 
+/// \brief Demangle a simple symbol directly into a buffer.
+///
+/// The symbols handled are the top-level type manglings ("_Tt") of
+/// non-generic nominal types, nested ones included, and of the standard
+/// library types with substitutions of their own, like "_TtSi". These are
+/// demangled without building a node tree and without allocating memory,
+/// to the same string demangleSymbolAsString() would return.
+///
+/// \param buffer Receives the demangled name, truncated to
+///   \p bufferSize - 1 characters and NUL-terminated, as with strlcpy.
+///
+/// \returns The length of the full demangled name, or 0 if the symbol is
+/// not one of the simple kinds, in which case the contents of \p buffer
+/// are unspecified and the symbol has to be demangled the usual way.
+size_t demangleSimpleSymbol(const char *mangledName, size_t mangledNameLength,
+                            char *buffer, size_t bufferSize,
+                            const DemangleOptions &options = DemangleOptions());
+
 enum class OperatorKind {
   NotOperator,
   Prefix,
@@ -350,24 +515,6 @@ std::string mangleNode(const NodePointer &root);
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
-struct NodeFactory {
-  static NodePointer create(Node::Kind K) {
-    return NodePointer(new Node(K));
-  }
-  static NodePointer create(Node::Kind K, Node::IndexType Index) {
-    return NodePointer(new Node(K, Index));
-  }
-  static NodePointer create(Node::Kind K, llvm::StringRef Text) {
-    return NodePointer(new Node(K, Text));
-  }
-  static NodePointer create(Node::Kind K, std::string &&Text) {
-    return NodePointer(new Node(K, std::move(Text)));
-  }
-  template <size_t N>
-  static NodePointer create(Node::Kind K, const char (&Text)[N]) {
-    return NodePointer(new Node(K, llvm::StringRef(Text)));
-  }
-};
 
   /// A class for printing to a std::string.
 class DemanglerPrinter {
@@ -28,19 +28,21 @@ namespace demangle_wrappers {
 
 using swift::Demangle::Node;
 using swift::Demangle::NodePointer;
+using swift::Demangle::NodeFactory;
 using swift::Demangle::DemangleOptions;
 
 class NodeDumper {
   NodePointer Root;
 
 public:
-  NodeDumper(NodePointer Root): Root(std::move(Root)) {}
+  NodeDumper(NodePointer Root): Root(Root) {}
   void dump() const;
   void print(llvm::raw_ostream &Out) const;
 };
 
+/// Demangle \p MangledName into a tree owned by \p Factory.
 NodePointer
-demangleSymbolAsNode(StringRef MangledName,
+demangleSymbolAsNode(StringRef MangledName, NodeFactory &Factory,
                      const DemangleOptions &Options = DemangleOptions());
 
 std::string nodeToString(NodePointer Root,
@@ -93,6 +93,17 @@ public:
   virtual void handleDiagnostic(SourceManager &SM, SourceLoc Loc,
                                 DiagnosticKind Kind, StringRef Text,
                                 const DiagnosticInfo &Info) = 0;
+
+  /// \brief Invoked before the text of a diagnostic is formatted.
+  ///
+  /// Returns false if the consumer would ignore the diagnostic, in which case
+  /// handleDiagnostic is not called for it. If no consumer wants a
+  /// diagnostic, its text is never formatted.
+  virtual bool wantsDiagnostic(SourceManager &SM, SourceLoc Loc,
+                               DiagnosticKind Kind,
+                               const DiagnosticInfo &Info) {
+    return true;
+  }
 };
   
 /// \brief DiagnosticConsumer that discards all diagnostics.
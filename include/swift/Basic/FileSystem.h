@@ -24,6 +24,12 @@ namespace swift {
   /// the file at \p source will still be present at \p source.
   std::error_code moveFileIfDifferent(const llvm::Twine &source,
                                       const llvm::Twine &destination);
+
+  /// Copies the file at \p source to \p destination by way of a temporary
+  /// file, so that nobody ever sees a partially written file at
+  /// \p destination.
+  std::error_code copyFileAtomically(const llvm::Twine &source,
+                                     const llvm::Twine &destination);
 } // end namespace swift
 
 #endif // SWIFT_BASIC_FILESYSTEM_H
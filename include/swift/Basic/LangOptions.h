@@ -160,6 +160,10 @@ namespace swift {
     /// Enable typealiases in protocols.
     bool EnableProtocolTypealiases = false;
 
+    /// Whether name lookup into a type from a serialized module should only
+    /// deserialize the members with the given name, rather than all of them.
+    bool NamedLazyMemberLoading = false;
+
     /// Sets the target we are building for and updates platform conditions
     /// to match.
     ///
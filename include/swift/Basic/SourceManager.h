@@ -14,10 +14,12 @@
 #define SWIFT_BASIC_SOURCEMANAGER_H
 
 #include "swift/Basic/SourceLoc.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/SourceMgr.h"
 #include <map>
+#include <vector>
 
 namespace swift {
 
@@ -42,6 +44,10 @@ class SourceManager {
   std::map<const char *, VirtualFile> VirtualFiles;
   mutable std::pair<const char *, const VirtualFile*> CachedVFile = {};
 
+  /// The offsets at which the lines of each buffer start, built the first
+  /// time a location in the buffer is converted to a line.
+  mutable llvm::DenseMap<unsigned, std::vector<unsigned>> LineStarts;
+
 public:
   llvm::SourceMgr &getLLVMSourceMgr() {
     return LLVMSourceMgr;
@@ -184,7 +190,7 @@ public:
     assert(Loc.isValid());
     int LineOffset = getLineOffset(Loc);
     int l, c;
-    std::tie(l, c) = LLVMSourceMgr.getLineAndColumn(Loc.Value, BufferID);
+    std::tie(l, c) = getRealLineAndColumn(Loc, BufferID);
     assert(LineOffset+l > 0 && "bogus line offset");
     return { LineOffset + l, c };
   }
@@ -196,7 +202,7 @@ public:
   /// This does not respect #line directives.
   unsigned getLineNumber(SourceLoc Loc, unsigned BufferID = 0) const {
     assert(Loc.isValid());
-    return LLVMSourceMgr.FindLineNumber(Loc.Value, BufferID);
+    return getRealLineAndColumn(Loc, BufferID).first;
   }
 
   StringRef extractText(CharSourceRange Range,
@@ -223,6 +229,16 @@ public:
 private:
   const VirtualFile *getVirtualFile(SourceLoc Loc) const;
 
+  /// Returns the offsets at which the lines of the buffer start.
+  const std::vector<unsigned> &getLineStarts(unsigned BufferID) const;
+
+  /// Returns the line and column of \p Loc, like llvm::SourceMgr, but by
+  /// way of the buffer's line table rather than by scanning the buffer.
+  ///
+  /// This does not respect #line directives.
+  std::pair<unsigned, unsigned> getRealLineAndColumn(SourceLoc Loc,
+                                                     unsigned BufferID) const;
+
   int getLineOffset(SourceLoc Loc) const {
     if (auto VFile = getVirtualFile(Loc))
       return VFile->LineOffset;
@@ -0,0 +1,252 @@
+//===--- Statistic.h - Per-job compilation statistics -----------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_STATISTIC_H
+#define SWIFT_BASIC_STATISTIC_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/Timer.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace swift {
+
+/// Records a timeline of the work of one process, and writes it in the
+/// Chrome trace event format, which chrome://tracing and other trace viewers
+/// can display.
+///
+/// The timestamps are wall clock times, so that the timelines of several
+/// processes of a build can be merged into one.
+class TraceEventRecorder {
+  /// A "complete" event, i.e. a named region of time on one thread.
+  struct Event {
+    std::string Category;
+    std::string Name;
+    std::string Detail;
+    int64_t Start;
+    int64_t Duration;
+    unsigned Thread;
+  };
+
+  std::string ProcessName;
+  std::vector<Event> Events;
+  std::map<std::thread::id, unsigned> Threads;
+  llvm::sys::Mutex Lock;
+
+public:
+  /// \p ProcessName labels the timeline of this process in the viewer.
+  explicit TraceEventRecorder(StringRef ProcessName)
+    : ProcessName(ProcessName) {}
+
+  TraceEventRecorder(const TraceEventRecorder &) = delete;
+  TraceEventRecorder &operator=(const TraceEventRecorder &) = delete;
+
+  /// The current time in microseconds, the unit of all timestamps.
+  static int64_t now();
+
+  /// Returns a small number identifying the calling thread, in the order in
+  /// which the threads first asked for it.
+  unsigned getCurrentThread();
+
+  /// Record that \p Thread worked on \p Name from \p Start to \p End.
+  /// \p Detail is shown with the event, if not empty.
+  void recordEvent(StringRef Category, StringRef Name, StringRef Detail,
+                   int64_t Start, int64_t End, unsigned Thread);
+
+  /// Write the events to \p OS as a JSON array.
+  void print(raw_ostream &OS);
+
+  /// Write the events to \p OS as a JSON array, together with the events of
+  /// the trace files \p Paths written by other processes.
+  void printMerged(raw_ostream &OS, ArrayRef<std::string> Paths);
+};
+
+/// Collects the counters and phase timers of a single compilation job, and
+/// writes them to a JSON file in a statistics directory when destroyed.
+///
+/// Unlike LLVM's statistics, the counters are collected in release builds
+/// too, and every job writes its own file, so the results of many jobs can
+/// be aggregated by an external tool.
+class UnifiedStatsReporter {
+public:
+  /// The counters every frontend job collects.
+  struct AlwaysOnFrontendCounters {
+#define FRONTEND_STATISTIC(Group, Name) size_t Name = 0;
+#include "swift/Basic/Statistics.def"
+  };
+
+  /// The counters the driver collects.
+  struct AlwaysOnDriverCounters {
+#define DRIVER_STATISTIC(Name) size_t Name = 0;
+#include "swift/Basic/Statistics.def"
+  };
+
+  /// The time and solver work it took to type-check one expression.
+  struct ExpressionProfile {
+    /// The source range of the expression, as file:line:column-line:column.
+    std::string Range;
+    double Milliseconds = 0;
+    /// The constraint solver counters, by name.
+    SmallVector<std::pair<const char *, size_t>, 10> Counters;
+  };
+
+  /// The work done by one or more runs of a SIL pass.
+  struct SILPassProfile {
+    size_t Runs = 0;
+    double WallTime = 0;
+    /// The instruction count of the function, or for module passes the
+    /// module, grew or shrank by this much over the runs.
+    size_t InstructionsAdded = 0;
+    size_t InstructionsRemoved = 0;
+    /// The number of runs which invalidated analyses.
+    size_t Invalidations = 0;
+    /// The number of bytes by which the runs raised the high-water mark of
+    /// the memory taken by the module's instructions.
+    size_t PeakInstructionBytesGrowth = 0;
+
+    SILPassProfile &operator+=(const SILPassProfile &Other) {
+      Runs += Other.Runs;
+      WallTime += Other.WallTime;
+      InstructionsAdded += Other.InstructionsAdded;
+      InstructionsRemoved += Other.InstructionsRemoved;
+      Invalidations += Other.Invalidations;
+      PeakInstructionBytesGrowth += Other.PeakInstructionBytesGrowth;
+      return *this;
+    }
+  };
+
+private:
+  SmallString<128> Filename;
+  AlwaysOnFrontendCounters FrontendCounters;
+
+  /// Set if this reporter belongs to the driver, which reports only these
+  /// counters.
+  std::unique_ptr<AlwaysOnDriverCounters> DriverCounters;
+
+  /// Written next to the statistics, as "expressions-<...>.json", if any
+  /// expression profiles were recorded.
+  SmallString<128> ExpressionsFilename;
+  std::vector<ExpressionProfile> ExpressionProfiles;
+
+  /// The SIL pass profiles, per pass name.
+  llvm::StringMap<SILPassProfile> SILPassProfiles;
+
+  /// Written next to the statistics, as "sil-pass-functions-<...>.json", if
+  /// any per-function SIL pass profiles were recorded.
+  SmallString<128> SILPassFunctionsFilename;
+  std::map<std::pair<std::string, std::string>, SILPassProfile>
+    SILPassFunctionProfiles;
+
+  /// Guards the SIL pass profiles; function passes can run on several
+  /// threads.
+  llvm::sys::Mutex SILPassProfilesLock;
+
+  /// The accumulated times per phase, keyed by the name of the timer.
+  llvm::StringMap<llvm::TimeRecord> Timers;
+
+  /// Guards Timers; LLVM optimization and output can run on several threads.
+  llvm::sys::Mutex TimersLock;
+
+  /// Written next to the statistics, as "trace-<...>.json", if tracing is
+  /// enabled.
+  SmallString<128> TraceFilename;
+  std::string ProcessName;
+  std::unique_ptr<TraceEventRecorder> TraceEvents;
+
+public:
+  /// Create a reporter which writes its statistics to a uniquely named file
+  /// in \p Directory. \p ProgramName and \p AuxName become part of the file
+  /// name, to make it easier to find the file of a particular job.
+  UnifiedStatsReporter(StringRef ProgramName, StringRef AuxName,
+                       StringRef Directory);
+  ~UnifiedStatsReporter();
+
+  UnifiedStatsReporter(const UnifiedStatsReporter &) = delete;
+  UnifiedStatsReporter &operator=(const UnifiedStatsReporter &) = delete;
+
+  AlwaysOnFrontendCounters &getFrontendCounters() { return FrontendCounters; }
+
+  /// Returns the driver counters, and makes this a driver's reporter.
+  AlwaysOnDriverCounters &getDriverCounters() {
+    if (!DriverCounters)
+      DriverCounters.reset(new AlwaysOnDriverCounters());
+    return *DriverCounters;
+  }
+
+  /// Add \p Time to the time recorded for the phase \p Name.
+  void recordTime(StringRef Name, const llvm::TimeRecord &Time);
+
+  /// Record a timeline of the job, for -trace-stats-events.
+  void enableTraceEvents();
+
+  /// Returns the recorder of the timeline, or null if tracing is disabled.
+  TraceEventRecorder *getTraceEvents() { return TraceEvents.get(); }
+
+  void recordExpressionProfile(ExpressionProfile Profile) {
+    ExpressionProfiles.push_back(std::move(Profile));
+  }
+
+  /// Add \p Run to the profile of the SIL pass \p Pass, and if \p Function
+  /// is not empty, to the profile of the pass on that function.
+  void recordSILPassRun(StringRef Pass, StringRef Function,
+                        const SILPassProfile &Run);
+
+  /// Write the statistics to \p OS as a JSON object.
+  void printJSON(raw_ostream &OS);
+
+  /// Write the expression profiles to \p OS as a JSON array, in the order
+  /// they were recorded.
+  void printExpressionProfilesJSON(raw_ostream &OS);
+
+  /// Write the per-function SIL pass profiles to \p OS as a JSON array,
+  /// sorted by pass and function name.
+  void printSILPassFunctionsJSON(raw_ostream &OS);
+};
+
+/// Records the lifetime of a scope as a trace event, if \p Stats is tracing
+/// events. A no-op otherwise.
+///
+/// Computing a name can be expensive; set it with setName() if isActive().
+class StatsTraceScope {
+  TraceEventRecorder *Recorder = nullptr;
+  StringRef Category;
+  std::string Name;
+  std::string Detail;
+  int64_t Start = 0;
+
+public:
+  StatsTraceScope(UnifiedStatsReporter *Stats, StringRef Category,
+                  StringRef Name = StringRef(),
+                  StringRef Detail = StringRef());
+  ~StatsTraceScope();
+
+  StatsTraceScope(const StatsTraceScope &) = delete;
+  StatsTraceScope &operator=(const StatsTraceScope &) = delete;
+
+  bool isActive() const { return Recorder != nullptr; }
+
+  void setName(StringRef NewName) { Name = NewName; }
+  void setDetail(StringRef NewDetail) { Detail = NewDetail; }
+};
+
+} // end namespace swift
+
+#endif // SWIFT_BASIC_STATISTIC_H
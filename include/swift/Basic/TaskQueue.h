@@ -19,6 +19,7 @@
 #include "llvm/Support/Program.h"
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <queue>
 
@@ -40,8 +41,10 @@ enum class TaskFinishedResponse {
 
 /// \brief A class encapsulating the execution of multiple tasks in parallel.
 class TaskQueue {
-  /// Tasks which have not begun execution.
-  std::queue<std::unique_ptr<Task>> QueuedTasks;
+  /// Tasks which have not begun execution, by descending priority. Tasks of
+  /// the same priority begin in the order in which they were added.
+  std::multimap<double, std::unique_ptr<Task>, std::greater<double>>
+    QueuedTasks;
 
   /// The number of tasks to execute in parallel.
   unsigned NumberOfParallelTasks;
@@ -120,9 +123,10 @@ public:
   /// \param Env the environment which should be used for the task;
   /// must be null-terminated. If empty, inherits the parent's environment.
   /// \param Context an optional context which will be associated with the task
+  /// \param Priority queued tasks of higher priority begin execution first
   virtual void addTask(const char *ExecPath, ArrayRef<const char *> Args,
                        ArrayRef<const char *> Env = llvm::None,
-                       void *Context = nullptr);
+                       void *Context = nullptr, double Priority = 0);
 
   /// \brief Synchronously executes the tasks in the TaskQueue.
   ///
@@ -159,7 +163,8 @@ class DummyTaskQueue : public TaskQueue {
       : ExecPath(ExecPath), Args(Args), Env(Env), Context(Context) {}
   };
 
-  std::queue<std::unique_ptr<DummyTask>> QueuedTasks;
+  std::multimap<double, std::unique_ptr<DummyTask>, std::greater<double>>
+    QueuedTasks;
 
 public:
   /// \brief Create a new DummyTaskQueue instance.
@@ -168,7 +173,7 @@ public:
 
   virtual void addTask(const char *ExecPath, ArrayRef<const char *> Args,
                        ArrayRef<const char *> Env = llvm::None,
-                       void *Context = nullptr);
+                       void *Context = nullptr, double Priority = 0);
 
   virtual bool
   execute(TaskBeganCallback Began = TaskBeganCallback(),
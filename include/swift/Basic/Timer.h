@@ -16,8 +16,11 @@
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/Support/Timer.h"
+#include <cstdint>
 
 namespace swift {
+  class UnifiedStatsReporter;
+
   /// A convenience class for declaring a timer that's part of the Swift
   /// compilation timers group.
   class SharedTimer {
@@ -28,22 +31,48 @@ namespace swift {
     };
     static State CompilationTimersEnabled;
 
+    /// If set, all timers also add their time to this reporter.
+    static UnifiedStatsReporter *StatsReporter;
+
     Optional<llvm::NamedRegionTimer> Timer;
 
+    StringRef Name;
+    UnifiedStatsReporter *Reporter;
+    llvm::TimeRecord StartTime;
+    /// The start of the trace event of this timer, if the reporter is
+    /// tracing events.
+    int64_t TraceStartTime = 0;
+
+    void startReporting();
+
   public:
-    explicit SharedTimer(StringRef name) {
+    explicit SharedTimer(StringRef name)
+        : Name(name), Reporter(StatsReporter) {
       if (CompilationTimersEnabled == State::Enabled)
         Timer.emplace(name, StringRef("Swift compilation"));
       else
         CompilationTimersEnabled = State::Skipped;
+
+      if (Reporter)
+        startReporting();
     }
 
+    ~SharedTimer();
+
     /// Must be called before any SharedTimers have been created.
     static void enableCompilationTimers() {
       assert(CompilationTimersEnabled != State::Skipped &&
              "a timer has already been created");
       CompilationTimersEnabled = State::Enabled;
     }
+
+    /// Report the time of all timers created from now on to \p reporter,
+    /// or stop reporting if \p reporter is null.
+    ///
+    /// The timer names must outlive the reporter.
+    static void setStatsReporter(UnifiedStatsReporter *reporter) {
+      StatsReporter = reporter;
+    }
   };
 } // end namespace swift
 
@@ -211,6 +211,16 @@ public:
   std::string getBridgingHeaderContents(StringRef headerPath, off_t &fileSize,
                                         time_t &fileModTime);
 
+  /// Precompiles the bridging header \p headerPath into \p outputPCHPath,
+  /// which can then be passed to importers created with the same options as
+  /// ClangImporterOptions::PrecompiledBridgingHeader.
+  ///
+  /// An existing PCH at \p outputPCHPath is kept if none of the files it was
+  /// written from has changed since.
+  ///
+  /// \returns true if there was an error.
+  bool emitBridgingPCH(StringRef headerPath, StringRef outputPCHPath);
+
   const clang::Module *getClangOwningModule(ClangNode Node) const;
   bool hasTypedef(const clang::Decl *typeDecl) const;
 
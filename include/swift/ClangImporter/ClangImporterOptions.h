@@ -73,6 +73,13 @@ public:
 
   /// Whether we should honor the swift_newtype attribute.
   bool HonorSwiftNewtypeAttr = false;
+
+  /// The precompiled form of the bridging header, loaded with -include-pch
+  /// when the Clang importer is created.
+  ///
+  /// The PCH must have been written by ClangImporter::emitBridgingPCH with
+  /// the same options.
+  std::string PrecompiledBridgingHeader;
 };
 
 } // end namespace swift
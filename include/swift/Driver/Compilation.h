@@ -22,6 +22,7 @@
 #include "swift/Basic/ArrayRefView.h"
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/TimeValue.h"
 
@@ -132,6 +133,34 @@ private:
   /// rebuilt.
   bool ShowIncrementalBuildDecisions = false;
 
+  /// If non-empty, the -stats-output-dir directory, to which the driver
+  /// writes its statistics of the job scheduling.
+  std::string StatsOutputDir;
+
+  /// With StatsOutputDir, the driver also writes a timeline of the jobs it
+  /// runs, merged with the timelines the jobs themselves write.
+  bool TraceStatsEvents = false;
+
+  /// The wall times in seconds of the jobs of the last build, as recorded in
+  /// the build record, keyed by getJobCostKey(). The driver runs the jobs on
+  /// the longest paths through the job graph first, and estimates the length
+  /// of the paths from these.
+  llvm::StringMap<double> PreviousJobDurations;
+
+  /// The interface hashes of the Swift modules which the files of the last
+  /// build depended on, as recorded in the build record. A module which was
+  /// rewritten since with the same interface hash doesn't make the files
+  /// which depend on it out of date.
+  llvm::StringMap<std::string> PreviousInterfaceHashes;
+
+  /// If non-empty, the directory of the JobCache from which the outputs of
+  /// compile jobs are restored instead of running the jobs.
+  std::string JobCachePath;
+
+  /// When non-null, compile jobs which are ready to run at the same time are
+  /// combined into batch jobs, which this toolchain constructs.
+  const ToolChain *BatchModeToolChain = nullptr;
+
   static const Job *unwrap(const std::unique_ptr<const Job> &p) {
     return p.get();
   }
@@ -189,6 +218,30 @@ public:
     ShowIncrementalBuildDecisions = value;
   }
 
+  void setStatsOutputDir(StringRef dir, bool traceEvents) {
+    StatsOutputDir = dir;
+    TraceStatsEvents = traceEvents;
+  }
+
+  void setPreviousJobDurations(llvm::StringMap<double> durations) {
+    PreviousJobDurations = std::move(durations);
+  }
+
+  void setPreviousInterfaceHashes(llvm::StringMap<std::string> hashes) {
+    PreviousInterfaceHashes = std::move(hashes);
+  }
+
+  void setJobCachePath(StringRef path) {
+    JobCachePath = path;
+  }
+
+  bool getBatchModeEnabled() const {
+    return BatchModeToolChain != nullptr;
+  }
+  void enableBatchMode(const ToolChain &TC) {
+    BatchModeToolChain = &TC;
+  }
+
   void setCompilationRecordPath(StringRef path) {
     assert(CompilationRecordPath.empty() && "already set");
     CompilationRecordPath = path;
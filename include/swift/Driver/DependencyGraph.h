@@ -23,7 +23,10 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/PointerLikeTypeTraits.h"
+#include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -129,7 +132,92 @@ private:
   /// \sa SourceFile::getInterfaceHash
   llvm::DenseMap<const void *, std::string> InterfaceHashes;
 
-  LoadResult loadFromBuffer(const void *node, llvm::MemoryBuffer &buffer);
+  /// The fingerprint of each (kind, string) pair that a node provided when
+  /// its dependency file was last loaded, keyed by the kind followed by the
+  /// string. An empty fingerprint means the file didn't describe the entry,
+  /// so it has to be assumed to change whenever the file does.
+  llvm::DenseMap<const void *, llvm::StringMap<std::string>>
+    ProvidesFingerprints;
+
+  using ChangedKindsTy = llvm::StringMap<DependencyMaskTy>;
+
+  /// For nodes whose dependency file was just reloaded, the kinds of each
+  /// outgoing edge whose fingerprint shows that it changed since the
+  /// previous load.
+  ///
+  /// When one of these nodes is next marked, only the nodes which depend on
+  /// these edges are traversed, instead of everything that depends on any
+  /// part of the node.
+  llvm::DenseMap<const void *, ChangedKindsTy> ChangedProvides;
+
+  /// What has been seen while loading a single dependency file.
+  struct LoadStateTy {
+    /// The provided (kind, string) pairs, keyed like ProvidesFingerprints.
+    llvm::StringMap<std::string> fingerprints;
+
+    /// Whether the file has a fingerprint for any of the pairs.
+    bool hasFingerprints = false;
+
+    /// Whether a cascading dependency of the file has already been marked,
+    /// which means anything it provides may have changed.
+    bool dependsOnMarked = false;
+  };
+
+  /// The contents of a dependency file, in the form in which it is written
+  /// to a snapshot of the graph.
+  ///
+  /// \sa loadSnapshot
+  struct SnapshotFileTy {
+    struct EntryTy {
+      StringRef name;
+      DependencyKind kind;
+      bool isProvides;
+      bool isCascading;
+      /// Non-empty if this entry sets the fingerprint of a provided name,
+      /// rather than adding an edge.
+      StringRef fingerprint;
+    };
+
+    /// The MD5 hash of the file the entries were parsed from.
+    std::array<uint8_t, 16> contentHash{};
+    std::vector<EntryTy> entries;
+    StringRef interfaceHash;
+    bool hasInterfaceHash = false;
+
+    /// Whether the file was loaded into this graph, either by parsing it or
+    /// by replaying the entries from a snapshot. Only such files are written
+    /// to a new snapshot.
+    bool wasLoaded = false;
+  };
+
+  /// The dependency files known to this graph, keyed by path.
+  ///
+  /// This holds the files read from a snapshot as well as the ones loaded
+  /// by loadFromPath since.
+  llvm::StringMap<SnapshotFileTy> SnapshotFiles;
+
+  /// The snapshots loaded into this graph. The strings of the entries in
+  /// SnapshotFiles which came from a snapshot point into these buffers.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> SnapshotBuffers;
+
+  /// Storage for the strings of the entries parsed from dependency files.
+  llvm::BumpPtrAllocator SnapshotStrings;
+
+  StringRef copySnapshotString(StringRef str);
+
+  LoadResult addProvides(const void *node, StringRef name,
+                         DependencyKind kind, LoadStateTy &state);
+  LoadResult addDepends(const void *node, StringRef name, DependencyKind kind,
+                        bool isCascading, LoadStateTy &state);
+  LoadResult addFingerprint(StringRef name, DependencyKind kind,
+                            StringRef fingerprint, LoadStateTy &state);
+  LoadResult updateInterfaceHash(const void *node, StringRef hash);
+  void updateChangedProvides(const void *node, LoadStateTy &state);
+
+  LoadResult loadFromBuffer(const void *node, llvm::MemoryBuffer &buffer,
+                            SnapshotFileTy *record = nullptr);
+  LoadResult loadFromSnapshotFile(const void *node,
+                                  const SnapshotFileTy &file);
 
   // FIXME: We should be able to use llvm::mapped_iterator for this, but
   // StringMapConstIterator isn't quite an InputIterator (no ->).
@@ -183,6 +271,25 @@ protected:
   }
 
 public:
+  DependencyGraphImpl();
+  ~DependencyGraphImpl();
+
+  /// Reads a snapshot written by writeSnapshot.
+  ///
+  /// Afterwards loadFromPath replays the contents of any dependency file
+  /// that has not changed since the snapshot was written, rather than
+  /// parsing the file again.
+  ///
+  /// \returns true if the snapshot could not be read, in which case the
+  /// graph is unchanged.
+  bool loadSnapshot(StringRef path);
+
+  /// Writes the contents of every dependency file loaded by loadFromPath to
+  /// \p path, in a compact binary form with a shared string table.
+  ///
+  /// \returns true if there was an error.
+  bool writeSnapshot(StringRef path) const;
+
   llvm::iterator_range<StringSetIterator> getExternalDependencies() const {
     return llvm::make_range(StringSetIterator(ExternalDependencies.begin()),
                             StringSetIterator(ExternalDependencies.end()));
@@ -238,6 +345,9 @@ public:
   /// Load "depends" and "provides" data for \p node from the file at the given
   /// path.
   ///
+  /// If the file is unchanged since a snapshot loaded with loadSnapshot was
+  /// written, its contents are taken from the snapshot instead.
+  ///
   /// If \p node is already in the graph, outgoing edges ("provides") are
   /// cleared and replaced with the newly loaded data. Incoming edges
   /// ("depends") are not cleared; new dependencies are considered additive.
@@ -277,6 +387,10 @@ public:
   /// Nodes that are only reachable through "non-cascading" edges are added to
   /// the \p visited set, but are \em not added to the graph's marked set.
   ///
+  /// If \p node was just reloaded and its dependency file has fingerprints
+  /// for what it provides, only the nodes depending on entries whose
+  /// fingerprints changed are traversed from \p node itself.
+  ///
   /// If you want to see how each node gets added to \p visited, pass a local
   /// MarkTracer instance to \p tracer.
   template <unsigned N>
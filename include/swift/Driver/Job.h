@@ -75,6 +75,11 @@ public:
 
   const std::string &getAnyOutputForType(types::ID type) const;
 
+  const llvm::SmallDenseMap<types::ID, std::string, 4> &
+  getAdditionalOutputs() const {
+    return AdditionalOutputsMap;
+  }
+
   StringRef getBaseInput(int Index) const { return BaseInputs[Index]; }
 };
 
@@ -181,6 +186,26 @@ public:
                              const llvm::opt::ArgStringList &Args);
 };
 
+/// A frontend job which compiles the primary files of several compile Jobs at
+/// once, so that the work shared between them (like importing modules) is
+/// done once.
+///
+/// A batch job is formed while the compilation runs, from Jobs which are
+/// ready at the same time. It isn't part of the Compilation's job graph: the
+/// combined Jobs are still the ones that other Jobs and the incremental build
+/// machinery refer to.
+class BatchJob : public Job {
+  /// The Jobs whose work this batch job performs.
+  SmallVector<const Job *, 4> CombinedJobs;
+
+public:
+  BatchJob(const JobAction &Source, std::unique_ptr<CommandOutput> Output,
+           const char *Executable, llvm::opt::ArgStringList Arguments,
+           ArrayRef<const Job *> Combined);
+
+  ArrayRef<const Job *> getCombinedJobs() const { return CombinedJobs; }
+};
+
 } // end namespace driver
 } // end namespace swift
 
@@ -0,0 +1,83 @@
+//===--- JobCache.h - Reusing the Outputs of Earlier Jobs -------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_DRIVER_JOBCACHE_H
+#define SWIFT_DRIVER_JOBCACHE_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+
+namespace swift {
+namespace driver {
+
+class Job;
+
+/// A content-addressed store of the outputs of compile jobs, with which the
+/// driver reuses the outputs of a job that ran before with the same flags
+/// and the same inputs, instead of running the job again.
+///
+/// An entry is keyed by a hash of the job's command line, in which the paths
+/// of the job's outputs are replaced by their types, so that jobs writing
+/// to different temporary files may share an entry. Alongside the outputs,
+/// an entry records the files the job's dependencies file (-emit-dependencies)
+/// lists, like the source files and the imported modules, together with
+/// hashes of their contents. The entry is used only if all of those files
+/// still have the same contents. Jobs without a dependencies file cannot be
+/// cached, because nothing would tell which files they read.
+///
+/// Merge-modules jobs are cached as well. They read nothing but the partial
+/// modules on their command line, so those are hashed into the key instead.
+/// A build in which no file changed its interface then skips merging the
+/// module, although the compile jobs produced new partial modules.
+///
+/// Entries are written by way of temporary files and renames, so the cache
+/// directory may be shared by several builds at once, for example on a
+/// network file system shared by the machines of a build farm.
+class JobCache {
+  std::string Directory;
+
+public:
+  /// The number of jobs whose outputs were restored from the cache.
+  unsigned NumHits = 0;
+
+  /// The number of cacheable jobs which were not in the cache.
+  unsigned NumMisses = 0;
+
+  explicit JobCache(StringRef Directory) : Directory(Directory) {}
+
+  /// Returns the key of the entry for \p Cmd, or the empty string if \p Cmd
+  /// cannot be cached. \p IsTemporaryFile tells which of the files named on
+  /// the command line are temporary files of this build. Temporary inputs
+  /// are identified by their contents rather than by their paths.
+  std::string
+  computeKey(const Job &Cmd,
+             llvm::function_ref<bool(StringRef)> IsTemporaryFile) const;
+
+  /// Restores the outputs of \p Cmd from the entry \p Key, if there is one
+  /// whose recorded dependencies are unchanged.
+  ///
+  /// Returns true if all of the outputs were restored.
+  bool restore(const Job &Cmd, StringRef Key);
+
+  /// Records the outputs of \p Cmd, which just ran successfully, as the
+  /// entry \p Key. Failing to write the entry only means that later builds
+  /// have to run the job again, so errors are ignored.
+  void store(const Job &Cmd, StringRef Key) const;
+};
+
+} // end namespace driver
+} // end namespace swift
+
+#endif
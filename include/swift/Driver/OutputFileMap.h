@@ -17,6 +17,7 @@
 #include "swift/Driver/Types.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/YAMLParser.h"
@@ -27,12 +28,21 @@
 namespace swift {
 namespace driver {
 
-typedef llvm::DenseMap<types::ID, std::string> TypeToPathMap;
+/// The output paths of one input. The paths are owned by the OutputFileMap
+/// and stay valid as long as it does.
+typedef llvm::DenseMap<types::ID, StringRef> TypeToPathMap;
 
 class OutputFileMap {
 private:
   llvm::StringMap<TypeToPathMap> InputToOutputsMap;
 
+  /// Storage for the output paths. A map for a large target has thousands of
+  /// entries, which are allocated together here rather than one by one.
+  llvm::BumpPtrAllocator PathStorage;
+
+  /// Copies \p Path into PathStorage, null-terminated.
+  StringRef copyPath(StringRef Path);
+
   OutputFileMap() {}
 
 public:
@@ -122,6 +122,9 @@ protected:
   constructInvocation(const GenerateDSYMJobAction &job,
                       const JobContext &context) const;
   virtual InvocationInfo
+  constructInvocation(const GeneratePCHJobAction &job,
+                      const JobContext &context) const;
+  virtual InvocationInfo
   constructInvocation(const AutolinkExtractJobAction &job,
                       const JobContext &context) const;
   virtual InvocationInfo
@@ -160,6 +163,14 @@ public:
                                     std::unique_ptr<CommandOutput> output,
                                     const OutputInfo &OI) const;
 
+  /// Returns true if \p J is a frontend job for a single primary file which
+  /// can be combined with similar jobs into a BatchJob.
+  bool jobIsBatchable(const Job *J) const;
+
+  /// Construct a BatchJob which performs the work of all of \p Jobs, which
+  /// must be batchable and belong to the same Compilation.
+  std::unique_ptr<BatchJob> constructBatchJob(ArrayRef<const Job *> Jobs) const;
+
   /// Return the default language type to use for the given extension.
   virtual types::ID lookupTypeForExtension(StringRef Ext) const;
 };
@@ -45,6 +45,7 @@
 
 namespace swift {
 
+class ModuleBufferCache;
 class SerializedModuleLoader;
 
 /// The abstract configuration of the compiler, including:
@@ -73,6 +74,11 @@ class CompilerInvocation {
 
   CodeCompletionCallbacksFactory *CodeCompletionFactory = nullptr;
 
+  /// \brief Offset in bytes from the beginning of the primary source file of
+  /// the only function body which is parsed in that file, or ~0U if all of
+  /// them are.
+  unsigned FocusedFunctionBodyOffset = ~0U;
+
 public:
   CompilerInvocation();
 
@@ -289,6 +295,23 @@ public:
   bool isDelayedFunctionBodyParsing() const {
     return FrontendOpts.DelayedFunctionBodyParsing;
   }
+
+  /// Only parse and type-check the body of the function in the primary source
+  /// file which contains \p Offset. The parsing of the bodies of the other
+  /// functions in that file is delayed.
+  void setFocusedFunctionBodyOffset(unsigned Offset) {
+    FocusedFunctionBodyOffset = Offset;
+  }
+
+  unsigned getFocusedFunctionBodyOffset() const {
+    return FocusedFunctionBodyOffset;
+  }
+
+  /// \returns true if only one function body of the primary source file is
+  /// parsed.
+  bool hasFocusedFunctionBody() const {
+    return FocusedFunctionBodyOffset != ~0U;
+  }
 };
 
 /// A class which manages the state and execution of the compiler.
@@ -307,7 +330,11 @@ class CompilerInstance {
   std::unique_ptr<SILModule> TheSILModule;
 
   DependencyTracker *DepTracker = nullptr;
-  ReferencedNameTracker *NameTracker = nullptr;
+  ModuleBufferCache *SharedModuleBuffers = nullptr;
+
+  /// The trackers for the names referenced from each primary source file, in
+  /// the same order as PrimaryBufferIDs.
+  SmallVector<ReferencedNameTracker *, 1> NameTrackers;
 
   Module *MainModule = nullptr;
   SerializedModuleLoader *SML = nullptr;
@@ -326,13 +353,25 @@ class CompilerInstance {
 
   enum : unsigned { NO_SUCH_BUFFER = ~0U };
   unsigned MainBufferID = NO_SUCH_BUFFER;
-  unsigned PrimaryBufferID = NO_SUCH_BUFFER;
 
-  SourceFile *PrimarySourceFile = nullptr;
+  /// The buffers of the primary inputs, in the order of the -primary-file
+  /// options. A batch-mode job has more than one. An entry is NO_SUCH_BUFFER
+  /// if that primary input is not a source file.
+  SmallVector<unsigned, 1> PrimaryBufferIDs;
+
+  /// The source files of the primary inputs, at the same positions as
+  /// PrimaryBufferIDs.
+  SmallVector<SourceFile *, 1> PrimarySourceFiles;
 
   void createSILModule(bool WholeModule = false);
   void setPrimarySourceFile(SourceFile *SF);
 
+  /// Returns true if any primary input is a source file. Otherwise the whole
+  /// module is compiled.
+  bool hasPrimaryBuffers() const;
+  bool isPrimaryBuffer(unsigned BufferID) const;
+  bool isPrimarySourceFile(const SourceFile *SF) const;
+
 public:
   SourceManager &getSourceMgr() { return SourceMgr; }
 
@@ -358,12 +397,27 @@ public:
     return DepTracker;
   }
 
+  /// Reads serialized modules through \p cache, which must outlive the
+  /// instance. Processes which set up many instances share one cache so that
+  /// they don't read the same module files again for each instance.
+  void setModuleBufferCache(ModuleBufferCache *cache) {
+    assert(!Context && "must be called before setup()");
+    SharedModuleBuffers = cache;
+  }
+
   void setReferencedNameTracker(ReferencedNameTracker *tracker) {
-    assert(!PrimarySourceFile && "must be called before performSema()");
-    NameTracker = tracker;
+    assert(PrimarySourceFiles.empty() && "must be called before performSema()");
+    NameTrackers.assign(1, tracker);
   }
   ReferencedNameTracker *getReferencedNameTracker() {
-    return NameTracker;
+    return NameTrackers.empty() ? nullptr : NameTrackers.front();
+  }
+
+  /// Sets a separate tracker for each primary input of a batch-mode job, in
+  /// the order of the -primary-file options.
+  void setReferencedNameTrackers(ArrayRef<ReferencedNameTracker *> trackers) {
+    assert(PrimarySourceFiles.empty() && "must be called before performSema()");
+    NameTrackers.assign(trackers.begin(), trackers.end());
   }
 
   /// Set the SIL module for this compilation instance.
@@ -401,7 +455,16 @@ public:
 
   /// Gets the SourceFile which is the primary input for this CompilerInstance.
   /// \returns the primary SourceFile, or nullptr if there is no primary input
-  SourceFile *getPrimarySourceFile() { return PrimarySourceFile; }
+  ///
+  /// For a batch-mode job this is the first primary input.
+  SourceFile *getPrimarySourceFile() {
+    return PrimarySourceFiles.empty() ? nullptr : PrimarySourceFiles.front();
+  }
+
+  /// Gets the SourceFiles of all primary inputs, in the order of the
+  /// -primary-file options. An entry is null if that input is not a source
+  /// file.
+  ArrayRef<SourceFile *> getPrimarySourceFiles() { return PrimarySourceFiles; }
 
   /// \brief Returns true if there was an error during setup.
   bool setup(const CompilerInvocation &Invocation);
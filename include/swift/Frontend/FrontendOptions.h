@@ -52,6 +52,20 @@ public:
   bool isBuffer() const { return Kind == InputKind::Buffer; }
 };
 
+/// A primary input of a frontend job which compiles several primary files at
+/// once (batch mode), together with the outputs to produce for it.
+struct BatchPrimaryInput {
+  SelectedInput Input;
+
+  std::string OutputFilename;
+  std::string ModuleOutputPath;
+  std::string ModuleDocOutputPath;
+  std::string DependenciesFilePath;
+  std::string ReferenceDependenciesFilePath;
+
+  explicit BatchPrimaryInput(SelectedInput Input) : Input(Input) {}
+};
+
 enum class InputFileKind {
   IFK_None,
   IFK_Swift,
@@ -74,6 +88,14 @@ public:
   /// be generated for the whole module.
   Optional<SelectedInput> PrimaryInput;
 
+  /// For a job with more than one -primary-file, each primary input and its
+  /// outputs, in command-line order; empty otherwise.
+  ///
+  /// PrimaryInput and the per-file output paths below describe the first
+  /// entry. Use getOptionsForBatchPrimary() to get the options for any one
+  /// entry.
+  std::vector<BatchPrimaryInput> BatchPrimaryInputs;
+
   /// The kind of input on which the frontend should operate.
   InputFileKind InputKind = InputFileKind::IFK_Swift;
 
@@ -134,6 +156,12 @@ public:
   /// Intended for debugging purposes only.
   unsigned WarnLongFunctionBodies = 0;
 
+  /// If non-zero, warn when an expression takes longer than this many
+  /// milliseconds to type-check.
+  ///
+  /// Intended for debugging purposes only.
+  unsigned WarnLongExpressionTypeChecking = 0;
+
   enum ActionType {
     NoneAction, ///< No specific action
     Parse, ///< Parse and type-check only
@@ -145,6 +173,8 @@ public:
     /// Parse, type-check, and dump type refinement context hierarchy
     DumpTypeRefinementContexts,
 
+    EmitPCH, ///< Emit a precompiled Objective-C header
+
     EmitSILGen, ///< Emit raw SIL
     EmitSIL, ///< Emit canonical SIL
 
@@ -175,6 +205,10 @@ public:
   /// If set, dumps wall time taken to check each function body to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If set, dumps wall time taken and the solver work done to type-check
+  /// each expression to llvm::errs().
+  bool DebugTimeExpressionTypeChecking = false;
+
   /// If set, prints the time taken in each major compilation phase to 
   /// llvm::errs().
   ///
@@ -185,6 +219,14 @@ public:
   /// until the end of all files.
   bool DelayedFunctionBodyParsing = false;
 
+  /// Indicates whether the bodies of functions in source files which are not
+  /// primary files should be skipped, except where they may be inlined.
+  bool SkipNonPrimaryFunctionBodies = true;
+
+  /// Indicates whether the bodies of functions which are not serialized into
+  /// the module should be skipped when the only output is the module.
+  bool SkipNonInlinableFunctionBodies = false;
+
   /// Indicates whether or not an import statement can pick up a Swift source
   /// file (as opposed to a module file).
   bool EnableSourceImport = false;
@@ -199,6 +241,11 @@ public:
   /// \see ResilienceStrategy::Resilient
   bool EnableResilience = false;
 
+  /// The resilience domain of the module, or empty if it has none.
+  ///
+  /// \see ModuleDecl::isInSameResilienceDomain
+  std::string ResilienceDomain;
+
   /// Indicates that the frontend should emit "verbose" SIL
   /// (if asked to emit SIL).
   bool EmitVerboseSIL = false;
@@ -224,6 +271,30 @@ public:
   /// termination.
   bool PrintClangStats = false;
 
+  /// If non-empty, the frontend writes a JSON file of counters and phase
+  /// timers to this directory.
+  ///
+  /// \sa swift::UnifiedStatsReporter
+  std::string StatsOutputDir;
+
+  /// With StatsOutputDir, also write a timeline of the job in the Chrome
+  /// trace event format.
+  bool TraceStatsEvents = false;
+
+  /// If non-empty, the frontend caches the outputs it generates from
+  /// optimized SIL in this directory, and reuses them instead of optimizing
+  /// again when the canonical SIL and everything else they depend on is
+  /// unchanged.
+  std::string SILOptimizationCachePath;
+
+  /// If non-empty, immediate mode keeps the machine code it generates in
+  /// this directory, and reuses it when the same LLVM IR runs again.
+  std::string ImmediateCachePath;
+
+  /// If non-empty, the frontend indexes the primary source file after type
+  /// checking it, and writes the record into this directory.
+  std::string IndexRecordsPath;
+
   /// Indicates whether the playground transformation should be applied.
   bool PlaygroundTransform = false;
 
@@ -258,6 +329,13 @@ public:
   bool actionIsImmediate() const;
 
   void forAllOutputPaths(std::function<void(const std::string &)> fn) const;
+
+  /// Indicates whether this job compiles several primary files at once.
+  bool isBatchMode() const { return !BatchPrimaryInputs.empty(); }
+
+  /// Returns a copy of these options which only describes the \p Index-th
+  /// primary input of a batch-mode job and its outputs.
+  FrontendOptions getOptionsForBatchPrimary(unsigned Index) const;
   
   /// Gets the name of the specified output filename.
   /// If multiple files are specified, the last one is returned.
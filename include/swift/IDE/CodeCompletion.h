@@ -16,6 +16,7 @@
 #include "swift/AST/Identifier.h"
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/TimeValue.h"
@@ -783,6 +784,11 @@ struct CodeCompletionResultSink {
   /// clang::Module * or swift::ModuleDecl *.
   std::pair<void *, StringRef> LastModule;
 
+  /// The chunk texts stored in Allocator. The results of a sink share their
+  /// copies of the type names, argument labels and keywords they have in
+  /// common, instead of copying them once per result.
+  llvm::DenseSet<StringRef> InternedStrings;
+
   CodeCompletionResultSink()
       : Allocator(std::make_shared<llvm::BumpPtrAllocator>()) {}
 };
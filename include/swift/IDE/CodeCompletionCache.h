@@ -51,6 +51,7 @@ public:
 
   struct Value : public ThreadSafeRefCountedBase<Value> {
     llvm::sys::TimeValue ModuleModificationTime;
+    uint64_t ModuleSize = 0;
     CodeCompletionResultSink Sink;
   };
   using ValueRefCntPtr = llvm::IntrusiveRefCntPtr<Value>;
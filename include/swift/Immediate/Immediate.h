@@ -35,9 +35,13 @@ namespace swift {
 
   /// Attempt to run the script identified by the given compiler instance.
   ///
+  /// If \p CachePath is not empty, the machine code of the script is kept in
+  /// that directory and reused when the same script runs again.
+  ///
   /// \return the result returned from main(), if execution succeeded
   int RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
-                     IRGenOptions &IRGenOpts, const SILOptions &SILOpts);
+                     IRGenOptions &IRGenOpts, const SILOptions &SILOpts,
+                     const std::string &CachePath = std::string());
 
   void runREPL(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
                bool ParseStdlib);
@@ -0,0 +1,69 @@
+//===--- IndexRecord.h - Index records written while building ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// An index record holds what the indexer reports for one source file, in the
+// order it reports it, so that an IDE can replay it into its own index
+// without type-checking the file again:
+//
+//   record     ::= "SIDX" version:u32 string-count:u32 string* entry*
+//   string     ::= length:u32 byte*
+//   entry      ::= 'D' kind:u8 is-system:u8 name:str path:str hash:str
+//                | 'd'                                   (end of dependency)
+//                | 'S' symbol                            (start of entity)
+//                | 'R' symbol                            (related entity)
+//                | 's' kind:u8 sub-kinds:u32 roles:u32   (end of entity)
+//   symbol     ::= kind:u8 sub-kinds:u32 roles:u32 line:u32 column:u32
+//                  name:str usr:str group:str receiver-usr:str
+//
+// All integers are little-endian, and "str" is an index into the strings,
+// each of which is stored once.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_INDEX_INDEXRECORD_H
+#define SWIFT_INDEX_INDEXRECORD_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+
+namespace swift {
+class SourceFile;
+
+namespace index {
+
+/// The version of the format of index records.
+const uint32_t IndexRecordVersion = 1;
+
+enum class IndexRecordStatus {
+  /// A new record was written.
+  Written,
+  /// The directory already had the record, so the file wasn't indexed.
+  UpToDate,
+  /// The record couldn't be written.
+  Failed
+};
+
+/// Indexes \p SF and writes a record of it into \p directory.
+///
+/// The record is named after the file and the indexer's hash of the file
+/// together with the modules it imports, so that unchanged files keep their
+/// records. Returns the outcome, with a description in \p error if it
+/// failed.
+IndexRecordStatus writeIndexRecord(SourceFile *SF, StringRef directory,
+                                   std::string &error);
+
+} // end namespace index
+} // end namespace swift
+
+#endif // SWIFT_INDEX_INDEXRECORD_H
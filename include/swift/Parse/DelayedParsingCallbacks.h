@@ -35,6 +35,52 @@ public:
                                               SourceRange BodyRange) = 0;
 };
 
+/// Decides which function bodies are skipped instead of parsed in place, for
+/// clients which keep what they need of them from an earlier parse of the
+/// same text.
+class SkippedFunctionBodyCallbacks {
+  virtual void anchor();
+
+public:
+  virtual ~SkippedFunctionBodyCallbacks() = default;
+
+  /// Checks if the body starting at \p LBraceLoc should be skipped.
+  virtual bool shouldSkipFunctionBody(Parser &TheParser,
+                                      AbstractFunctionDecl *AFD,
+                                      SourceLoc LBraceLoc) = 0;
+
+  /// Called after skipping a body to confirm that \p BodyRange is the body
+  /// the client expected. If not, the body is parsed after all.
+  virtual bool acceptSkippedFunctionBody(Parser &TheParser,
+                                         AbstractFunctionDecl *AFD,
+                                         SourceRange BodyRange) = 0;
+};
+
+/// Skips the bodies of functions in source files which are not primary files
+/// of the current compilation. Only their declarations are needed, except
+/// for the bodies of functions which may be inlined into a primary file by
+/// mandatory inlining.
+class NonPrimaryFunctionBodyCallbacks : public SkippedFunctionBodyCallbacks {
+public:
+  bool shouldSkipFunctionBody(Parser &TheParser, AbstractFunctionDecl *AFD,
+                              SourceLoc LBraceLoc) override {
+    if (AFD->getDeclContext()->isLocalContext())
+      return false;
+    const DeclAttributes &Attrs = AFD->getAttrs();
+    if (Attrs.hasAttribute<TransparentAttr>())
+      return false;
+    if (auto *Inline = Attrs.getAttribute<InlineAttr>())
+      if (Inline->getKind() == InlineKind::Always)
+        return false;
+    return true;
+  }
+
+  bool acceptSkippedFunctionBody(Parser &TheParser, AbstractFunctionDecl *AFD,
+                                 SourceRange BodyRange) override {
+    return true;
+  }
+};
+
 class AlwaysDelayedCallbacks : public DelayedParsingCallbacks {
   bool shouldDelayFunctionBodyParsing(Parser &TheParser,
                                       AbstractFunctionDecl *AFD,
@@ -63,6 +109,32 @@ public:
   }
 };
 
+/// \brief Implementation of callbacks that delay parsing of all function
+/// bodies in a source file, except for the one containing a given location.
+class FocusedFunctionBodyDelayedCallbacks : public DelayedParsingCallbacks {
+  SourceLoc FocusLoc;
+public:
+  explicit FocusedFunctionBodyDelayedCallbacks(SourceLoc FocusLoc)
+    : FocusLoc(FocusLoc) {
+  }
+
+  bool shouldDelayFunctionBodyParsing(Parser &TheParser,
+                                      AbstractFunctionDecl *AFD,
+                                      const DeclAttributes &Attrs,
+                                      SourceRange BodyRange) override {
+    // SILGen expects initializers and deinitializers to have bodies. Local
+    // functions are parsed along with the body they are part of.
+    if (!isa<FuncDecl>(AFD) || AFD->getDeclContext()->getLocalContext())
+      return false;
+
+    SourceManager &SM = TheParser.SourceMgr;
+    if (SM.findBufferContainingLoc(BodyRange.Start) !=
+        SM.findBufferContainingLoc(FocusLoc))
+      return false;
+    return !SM.rangeContainsTokenLoc(BodyRange, FocusLoc);
+  }
+};
+
 } // namespace swift
 
 #endif
@@ -43,6 +43,7 @@ namespace swift {
   class PersistentParserState;
   class CodeCompletionCallbacks;
   class DelayedParsingCallbacks;
+  class SkippedFunctionBodyCallbacks;
   
   struct EnumElementInfo;
   
@@ -139,6 +140,12 @@ public:
     this->DelayedParseCB = DelayedParseCB;
   }
 
+  SkippedFunctionBodyCallbacks *SkippedBodyCB = nullptr;
+
+  void setSkippedFunctionBodyCallbacks(SkippedFunctionBodyCallbacks *CB) {
+    SkippedBodyCB = CB;
+  }
+
   void setCodeCompletionCallbacks(CodeCompletionCallbacks *Callbacks) {
     CodeCompletion = Callbacks;
   }
@@ -805,6 +812,7 @@ public:
   
   void consumeAbstractFunctionBody(AbstractFunctionDecl *AFD,
                                    const DeclAttributes &Attrs);
+  bool skipFunctionBodyIfRequested(AbstractFunctionDecl *AFD);
   ParserResult<FuncDecl> parseDeclFunc(SourceLoc StaticLoc,
                                        StaticSpellingKind StaticSpelling,
                                        ParseDeclOptions Flags,
@@ -82,9 +82,12 @@ public:
   }
 
   void addString(const std::string &String) {
-    if (String.empty()) {
-      Bits.push_back(0);
-    } else {
+    // Strings of different lengths must not produce the same bits together
+    // with what follows them, otherwise two different TypeRefs share an ID:
+    // for example, the name "ab" followed by the integer 'c' and the name
+    // "abc" followed by nothing.
+    Bits.push_back(String.size());
+    if (!String.empty()) {
       size_t i = 0;
       size_t chunks = String.size() / 4;
       for (size_t chunk = 0; chunk < chunks; ++chunk, i+=4) {
@@ -271,6 +271,34 @@ private:
 
   std::vector<ReflectionInfo> ReflectionInfos;
 
+  /// The number of the ReflectionInfos whose descriptors have been added to
+  /// the indexes below. The indexes are built up lazily on the first lookup
+  /// after an image was added, so that each section is scanned once.
+  size_t NumIndexedReflectionInfos = 0;
+
+  /// Maps mangled type names to the first field descriptor for them.
+  std::unordered_map<std::string, const FieldDescriptor *> FieldTypeInfoIndex;
+
+  /// Maps mangled type names to the first builtin type descriptor for them.
+  std::unordered_map<std::string, const BuiltinTypeDescriptor *>
+    BuiltinTypeInfoIndex;
+
+  /// Maps mangled type names to the associated type descriptors of their
+  /// conformances, in the order of the sections.
+  std::unordered_map<std::string, std::vector<const AssociatedTypeDescriptor *>>
+    AssociatedTypeIndex;
+
+  /// Memoizes getFieldTypeRefs for the field descriptor of a type.
+  std::unordered_map<const TypeRef *,
+                     std::pair<const FieldDescriptor *,
+                               std::vector<std::pair<std::string,
+                                                     const TypeRef *>>>>
+    FieldTypeRefsCache;
+
+  /// Adds the descriptors of the ReflectionInfos added since the last call
+  /// to the indexes.
+  void updateIndexes();
+
   const AssociatedTypeDescriptor *
   lookupAssociatedTypes(const std::string &MangledTypeName,
                         const DependentMemberTypeRef *DependentMember);
@@ -20,15 +20,49 @@
 
 #include "swift/SwiftRemoteMirror/MemoryReaderInterface.h"
 #include "swift/Remote/MemoryReader.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
 
 namespace swift {
 namespace remote {
 
 /// An implementation of MemoryReader which wraps the C interface offered
 /// by SwiftRemoteMirror.
+///
+/// Every call through the C interface may be a round trip into a debugger
+/// or another process, so memory is read a whole page at a time and kept
+/// until invalidateCache() is called. The fields of a metadata record or a
+/// nominal type descriptor thus usually cost a single read between them.
 class CMemoryReader final : public MemoryReader {
   MemoryReaderImpl Impl;
 
+  /// The size and alignment of the blocks in which memory is read.
+  static constexpr uint64_t PageSize = 4096;
+
+  /// The pages read since the cache was last invalidated, keyed by their
+  /// address. A null page could not be read as a whole, for example because
+  /// the implementation only reads from the sections of a binary.
+  llvm::DenseMap<uint64_t, std::unique_ptr<uint8_t[]>> Pages;
+
+  /// Returns the cached contents of the page at \p pageAddress, reading it
+  /// first if necessary, or null if it cannot be read.
+  const uint8_t *getPage(uint64_t pageAddress) {
+    auto found = Pages.find(pageAddress);
+    if (found != Pages.end())
+      return found->second.get();
+
+    std::unique_ptr<uint8_t[]> page(new uint8_t[PageSize]);
+    if (!Impl.readBytes(Impl.reader_context, pageAddress, page.get(),
+                        PageSize))
+      page.reset();
+    const uint8_t *result = page.get();
+    Pages[pageAddress] = std::move(page);
+    return result;
+  }
+
 public:
   CMemoryReader(MemoryReaderImpl Impl) : Impl(Impl) {
     assert(this->Impl.getPointerSize && "No getPointerSize implementation");
@@ -71,8 +105,29 @@ public:
   }
 
   bool readBytes(RemoteAddress address, uint8_t *dest, uint64_t size) override {
-    return Impl.readBytes(Impl.reader_context,
-                          address.getAddressData(), dest, size) != 0;
+    uint64_t current = address.getAddressData();
+    uint8_t *currentDest = dest;
+    uint64_t remaining = size;
+    while (remaining != 0) {
+      uint64_t pageAddress = current & ~(PageSize - 1);
+      uint64_t offset = current - pageAddress;
+      uint64_t chunk = std::min(remaining, PageSize - offset);
+      const uint8_t *page = getPage(pageAddress);
+      // Reads which fall outside of the readable pages are left to the
+      // implementation to satisfy exactly as requested.
+      if (!page)
+        return Impl.readBytes(Impl.reader_context,
+                              address.getAddressData(), dest, size) != 0;
+      memcpy(currentDest, page + offset, chunk);
+      current += chunk;
+      currentDest += chunk;
+      remaining -= chunk;
+    }
+    return true;
+  }
+
+  void invalidateCache() override {
+    Pages.clear();
   }
 };
 
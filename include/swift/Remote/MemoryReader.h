@@ -63,6 +63,12 @@ public:
                      sizeof(IntegerType));
   }
 
+  /// Forget the contents of any memory the reader has cached.
+  ///
+  /// This must be called whenever the remote process may have written to
+  /// its memory since it was last read, for example after it resumed.
+  virtual void invalidateCache() {}
+
   virtual ~MemoryReader() = default;
 };
 
@@ -104,7 +104,7 @@ class TypeDecoder {
         if (repr->getKind() != NodeKind::MetatypeRepresentation ||
             !repr->hasText())
           return BuiltType();
-        auto &str = repr->getText();
+        auto str = repr->getText();
         if (str != "@thin")
           wasAbstract = true;
       }
@@ -141,12 +141,13 @@ class TypeDecoder {
       auto name = Node->getChild(1)->getText();
 
       // Consistent handling of protocols and protocol compositions
-      auto protocolList = Demangle::NodeFactory::create(NodeKind::ProtocolList);
-      auto typeList = Demangle::NodeFactory::create(NodeKind::TypeList);
-      auto type = Demangle::NodeFactory::create(NodeKind::Type);
-      type->addChild(Node);
-      typeList->addChild(type);
-      protocolList->addChild(typeList);
+      Demangle::NodeFactory Factory;
+      auto protocolList = Factory.createNode(NodeKind::ProtocolList);
+      auto typeList = Factory.createNode(NodeKind::TypeList);
+      auto type = Factory.createNode(NodeKind::Type);
+      type->addChild(Node, Factory);
+      typeList->addChild(type, Factory);
+      protocolList->addChild(typeList, Factory);
 
       auto mangledName = Demangle::mangleNode(protocolList);
       return Builder.createProtocolType(mangledName, moduleName, name);
@@ -198,7 +199,7 @@ class TypeDecoder {
           if (!child->hasText())
             return BuiltType();
 
-          auto &text = child->getText();
+          auto text = child->getText();
 
           if (text == "@convention(thin)") {
             flags =
@@ -208,7 +209,7 @@ class TypeDecoder {
           if (!child->hasText())
             return BuiltType();
 
-          auto &text = child->getText();
+          auto text = child->getText();
           if (text == "@convention(c)") {
             flags =
               flags.withConvention(FunctionMetadataConvention::CFunctionPointer);
@@ -540,6 +541,40 @@ public:
     return {true, isaMask};
   }
 
+  /// Read the remote process's runtime performance counters, summed over all
+  /// of its threads. See swift/Runtime/RuntimeCounters.h for the layout.
+  ///
+  /// Returns false if the remote runtime doesn't maintain counters.
+  bool readRuntimeCounters(std::vector<uint64_t> &counts) {
+    auto countAddress = Reader->getSymbolAddress("_swift_runtimeCounterCount");
+    auto blocksAddress =
+      Reader->getSymbolAddress("_swift_runtimeCounterBlocks");
+    if (!countAddress || !blocksAddress)
+      return false;
+
+    uint32_t numCounters;
+    StoredPointer block;
+    if (!Reader->readInteger(countAddress, &numCounters) ||
+        !Reader->readInteger(blocksAddress, &block))
+      return false;
+
+    counts.assign(numCounters, 0);
+    std::vector<uint64_t> blockCounts(numCounters);
+    while (block) {
+      if (!Reader->readBytes(RemoteAddress(block),
+                             reinterpret_cast<uint8_t *>(blockCounts.data()),
+                             numCounters * sizeof(uint64_t)))
+        return false;
+      for (uint32_t i = 0; i != numCounters; ++i)
+        counts[i] += blockCounts[i];
+
+      auto nextAddress = block + numCounters * sizeof(uint64_t);
+      if (!Reader->readInteger(RemoteAddress(nextAddress), &block))
+        return false;
+    }
+    return true;
+  }
+
   /// Given a remote pointer to metadata, attempt to discover its MetadataKind.
   std::pair<bool, MetadataKind>
   readKindFromMetadata(StoredPointer MetadataAddress) {
@@ -701,7 +736,8 @@ public:
         if (!Reader->readString(RemoteAddress(ProtocolDescriptor->Name),
                                 MangledName))
           return BuiltType();
-        auto Demangled = Demangle::demangleSymbolAsNode(MangledName);
+        Demangle::NodeFactory Factory;
+        auto Demangled = Demangle::demangleSymbolAsNode(MangledName, Factory);
         auto Protocol = decodeMangledType(Demangled);
         if (!Protocol)
           return BuiltType();
@@ -769,7 +805,9 @@ public:
 
   BuiltType readTypeFromMangledName(const char *MangledTypeName,
                                     size_t Length) {
-    auto Demangled = Demangle::demangleSymbolAsNode(MangledTypeName, Length);
+    Demangle::NodeFactory Factory;
+    auto Demangled = Demangle::demangleSymbolAsNode(MangledTypeName, Length,
+                                                    Factory);
     return decodeMangledType(Demangled);
   }
 
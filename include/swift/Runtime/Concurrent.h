@@ -189,6 +189,16 @@ template <class EntryTy> class ConcurrentMap {
   /// searches the same value in a loop.
   std::atomic<Node*> LastSearch;
 
+  /// Remember \p node as the result of the last search.
+  ///
+  /// Lookups of an existing key are otherwise read-only, so skip the store
+  /// if the cache already holds the node; an unconditional store makes every
+  /// reader of a hot entry write to the same cache line.
+  void cacheLastSearch(Node *node) {
+    if (LastSearch.load(std::memory_order_relaxed) != node)
+      LastSearch.store(node, std::memory_order_release);
+  }
+
 public:
   constexpr ConcurrentMap() : Root(nullptr), LastSearch(nullptr) {}
 
@@ -229,7 +239,7 @@ public:
     while (node) {
       int comparisonResult = node->Payload.compareWithKey(key);
       if (comparisonResult == 0) {
-        LastSearch.store(node, std::memory_order_release);
+        cacheLastSearch(node);
         return &node->Payload;
       } else if (comparisonResult < 0) {
         node = node->Left.load(std::memory_order_acquire);
@@ -278,7 +288,7 @@ public:
           ::delete newNode;
 
           // Cache and report that we found an existing node.
-          LastSearch.store(node, std::memory_order_release);
+          cacheLastSearch(node);
           return { &node->Payload, false };
         }
 
@@ -300,7 +310,7 @@ public:
                                                   std::memory_order_acq_rel,
                                                   std::memory_order_acquire)) {
         // If that succeeded, cache and report that we created a new node.
-        LastSearch.store(newNode, std::memory_order_release);
+        cacheLastSearch(newNode);
         return { &newNode->Payload, true };
       }
 
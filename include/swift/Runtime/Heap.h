@@ -18,5 +18,33 @@
 #define SWIFT_RUNTIME_HEAP_H
 
 #include <llvm/Support/Compiler.h>
+#include <cstdint>
+
+namespace swift {
+
+/// Counters for the thread-local size-class cache behind swift_slowAlloc and
+/// swift_slowDealloc. The cache is only present if the runtime was built with
+/// SWIFT_RUNTIME_ENABLE_HEAP_CACHE; otherwise all counters stay zero.
+struct HeapCacheStatistics {
+  /// The number of allocations small enough to be served by the cache.
+  uint64_t Allocations;
+
+  /// The number of those allocations which were served from a free list
+  /// instead of calling malloc.
+  uint64_t AllocationHits;
+
+  /// The number of deallocations small enough to be kept by the cache.
+  uint64_t Deallocations;
+
+  /// The number of those deallocations which were put on a free list
+  /// instead of calling free.
+  uint64_t DeallocationHits;
+};
+
+/// Return the heap cache counters of the current thread, added to the
+/// counters of all threads which have already exited.
+HeapCacheStatistics _swift_getHeapCacheStatistics();
+
+} // end namespace swift
 
 #endif /* SWIFT_RUNTIME_HEAP_H */
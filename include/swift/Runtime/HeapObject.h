@@ -336,6 +336,23 @@ SWIFT_RUNTIME_EXPORT
 extern "C" void (*SWIFT_CC(RegisterPreservingCC)
                      _swift_release_n)(HeapObject *object, uint32_t n);
 
+/// Atomically increments the retain count of each object referenced from the
+/// aggregate at \p base. \p offsets holds the byte offsets of \p count
+/// references to native Swift objects within the aggregate. Null references
+/// are skipped.
+///
+/// The compiler uses this to copy values with several references at once.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_bulkRetain(void *base, const uint32_t *offsets,
+                                 uint32_t count);
+
+/// Atomically decrements the retain count of each object referenced from the
+/// aggregate at \p base, destroying the objects whose count reaches zero.
+/// The references are described as for swift_bulkRetain.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_bulkRelease(void *base, const uint32_t *offsets,
+                                  uint32_t count);
+
 /// Sets the RC_DEALLOCATING_FLAG flag. This is done non-atomically.
 /// The strong reference count of \p object must be 1 and no other thread may
 /// retain the object during executing this function.
@@ -19,12 +19,30 @@
 #define SWIFT_RUNTIME_MUTEX_PHTREAD_H
 
 #include <pthread.h>
+#include <stdint.h>
+
+// On Linux the read/write lock is implemented directly on top of futexes,
+// because pthread_rwlock_t serializes readers on an internal lock.
+#if defined(__linux__)
+#define SWIFT_READWRITELOCK_USES_FUTEX 1
+#else
+#define SWIFT_READWRITELOCK_USES_FUTEX 0
+#endif
 
 namespace swift {
 
 typedef pthread_cond_t ConditionHandle;
 typedef pthread_mutex_t MutexHandle;
+#if SWIFT_READWRITELOCK_USES_FUTEX
+/// The state of a futex-based read/write lock: the number of readers holding
+/// the lock, and whether a writer holds it or threads are waiting for it.
+/// See MutexPThread.cpp.
+struct ReadWriteLockHandle {
+  uint32_t State;
+};
+#else
 typedef pthread_rwlock_t ReadWriteLockHandle;
+#endif
 
 #if defined(__CYGWIN__) || defined(__ANDROID__)
 // At the moment CYGWIN pthreads implementation doesn't support the use of
@@ -34,7 +52,7 @@ typedef pthread_rwlock_t ReadWriteLockHandle;
 // being marked as constexpr.
 #define CONDITION_SUPPORTS_CONSTEXPR 0
 #define MUTEX_SUPPORTS_CONSTEXPR 0
-#define READWRITELOCK_SUPPORTS_CONSTEXPR 0
+#define READWRITELOCK_SUPPORTS_CONSTEXPR SWIFT_READWRITELOCK_USES_FUTEX
 #else
 #define CONDITION_SUPPORTS_CONSTEXPR 1
 #define MUTEX_SUPPORTS_CONSTEXPR 1
@@ -91,8 +109,8 @@ struct MutexPlatformHelper {
   }
 };
 
-/// PThread low-level implementation that supports ReadWriteLock
-/// found in Mutex.h
+/// PThread (or, on Linux, futex) low-level implementation that supports
+/// ReadWriteLock found in Mutex.h
 ///
 /// See ReadWriteLock
 struct ReadWriteLockPlatformHelper {
@@ -103,7 +121,11 @@ struct ReadWriteLockPlatformHelper {
 #endif
       ReadWriteLockHandle
       staticInit() {
+#if SWIFT_READWRITELOCK_USES_FUTEX
+    return ReadWriteLockHandle{0};
+#else
     return PTHREAD_RWLOCK_INITIALIZER;
+#endif
   };
 
   static void init(ReadWriteLockHandle &rwlock);
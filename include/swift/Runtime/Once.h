@@ -32,6 +32,13 @@ typedef long swift_once_t;
 // On Cygwin, std::once_flag can not be used because it is larger than the
 // platform word.
 typedef uintptr_t swift_once_t;
+
+#elif defined(__linux__)
+
+// On Linux, swift_once is implemented with a futex. The compiler checks
+// inline for the "done" value -1, like it does for dispatch_once_t.
+typedef intptr_t swift_once_t;
+
 #else
 
 // On other platforms swift_once_t is std::once_flag
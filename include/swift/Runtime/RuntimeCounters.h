@@ -0,0 +1,79 @@
+//===--- RuntimeCounters.h - Runtime performance counters -------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counters of how often a process calls into the hot entry points of the
+// runtime. The counters are only maintained if the runtime was built with
+// SWIFT_RUNTIME_ENABLE_COUNTERS; otherwise they all stay zero.
+//
+// Every thread counts into its own block, so counting is a plain increment.
+// The blocks are linked into a list which is never freed; the block of an
+// exited thread is reused by the next new thread. Reading the counters
+// sums up all blocks.
+//
+// Out-of-process readers find the list through two exported symbols:
+//
+//   _swift_runtimeCounterCount  - a uint32_t, the number of counters N
+//   _swift_runtimeCounterBlocks - a pointer to the first block
+//
+// A block starts with N uint64_t counts, followed by a pointer to the next
+// block.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_RUNTIMECOUNTERS_H
+#define SWIFT_RUNTIME_RUNTIMECOUNTERS_H
+
+#include "swift/Runtime/Config.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace swift {
+
+enum class RuntimeCounter : unsigned {
+#define RUNTIME_COUNTER(Name) Name,
+#include "swift/Runtime/RuntimeCounters.def"
+};
+
+enum : unsigned {
+  NumRuntimeCounters = 0
+#define RUNTIME_COUNTER(Name) + 1
+#include "swift/Runtime/RuntimeCounters.def"
+};
+
+/// Copy the current values of the counters, summed over all threads, to
+/// \p counts, which has room for \p maxCount values.
+///
+/// Returns the number of counters, which may be more than \p maxCount.
+SWIFT_RUNTIME_EXPORT
+extern "C" size_t swift_getRuntimeCounters(uint64_t *counts, size_t maxCount);
+
+/// Return the name of counter \p index, or null if there is no such counter.
+SWIFT_RUNTIME_EXPORT
+extern "C" const char *swift_getRuntimeCounterName(size_t index);
+
+#if SWIFT_RUNTIME_ENABLE_COUNTERS
+
+/// Add one to counter \p counter of the current thread.
+void _swift_incrementRuntimeCounter(RuntimeCounter counter);
+
+#define SWIFT_RUNTIME_COUNT(Name) \
+  ::swift::_swift_incrementRuntimeCounter(::swift::RuntimeCounter::Name)
+
+#else
+
+#define SWIFT_RUNTIME_COUNT(Name) do {} while (false)
+
+#endif
+
+} // end namespace swift
+
+#endif /* SWIFT_RUNTIME_RUNTIMECOUNTERS_H */
@@ -30,6 +30,7 @@ class AbstractClosureExpr;
 enum class SpecializationKind : uint8_t {
   Generic,
   NotReAbstractedGeneric,
+  Partial,
   FunctionSignature,
 };
 
@@ -73,6 +74,9 @@ protected:
     case SpecializationKind::NotReAbstractedGeneric:
       M.append("r");
       break;
+    case SpecializationKind::Partial:
+      M.append("p");
+      break;
     case SpecializationKind::FunctionSignature:
       M.append("f");
       break;
@@ -158,6 +162,29 @@ private:
   void mangleSpecialization();
 };
 
+/// Mangles a specialization which is still generic over \p Sig. The
+/// replacement types in \p Subs are interface types of \p Sig.
+class PartialSpecializationMangler :
+  public SpecializationMangler<PartialSpecializationMangler> {
+
+  friend class SpecializationMangler<PartialSpecializationMangler>;
+
+  CanGenericSignature Sig;
+  ArrayRef<Substitution> Subs;
+
+public:
+  PartialSpecializationMangler(Mangle::Mangler &M, SILFunction *F,
+                               CanGenericSignature Sig,
+                               ArrayRef<Substitution> Subs,
+                               IsFragile_t Fragile)
+    : SpecializationMangler(SpecializationKind::Partial,
+                            SpecializationPass::GenericSpecializer,
+                            M, Fragile, F), Sig(Sig), Subs(Subs) {}
+
+private:
+  void mangleSpecialization();
+};
+
 class FunctionSignatureSpecializationMangler
   : public SpecializationMangler<FunctionSignatureSpecializationMangler> {
 
@@ -915,6 +915,14 @@ public:
     return LiveLeafIndices.size();
   }
 
+  /// Return the number of leafs in the projection, live or not.
+  size_t leafCount() const {
+    return std::count_if(ProjectionTreeNodes.begin(), ProjectionTreeNodes.end(),
+                         [](const ProjectionTreeNode *Node) {
+                           return Node->ChildProjections.empty();
+                         });
+  }
+
   void createTreeFromValue(SILBuilder &B, SILLocation Loc, SILValue NewBase,
                            llvm::SmallVectorImpl<SILValue> &Leafs) const;
 
@@ -165,6 +165,11 @@ private:
   /// The function's effects attribute.
   EffectsKind EffectsKindAttr;
 
+  /// The number of times the function was entered in a profiled run, if the
+  /// module was compiled with -profile-use and the profile covers the
+  /// function.
+  Optional<uint64_t> EntryCount;
+
   /// True if this function is inlined at least once. This means that the
   /// debug info keeps a pointer to this function.
   bool Inlined = false;
@@ -497,6 +502,12 @@ public:
     EffectsKindAttr = E;
   }
 
+  /// Returns the profiled entry count of the function, or None if there is
+  /// no profile data for it. The execution counts of the blocks, see
+  /// SILBasicBlock::getExecutionCount(), are relative to this count.
+  Optional<uint64_t> getEntryCount() const { return EntryCount; }
+  void setEntryCount(Optional<uint64_t> Count) { EntryCount = Count; }
+
   /// Get this function's global_init attribute.
   ///
   /// The implied semantics are:
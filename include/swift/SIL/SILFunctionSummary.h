@@ -0,0 +1,129 @@
+//===--- SILFunctionSummary.h - Interprocedural summary ---------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the SILFunctionSummary class, which describes the memory
+// effects and the escaping behavior of a function, and the size of its body,
+// in a form which does not depend on the function body. Summaries are computed
+// by the optimizer for the public functions of a module and serialized into
+// the module file. The optimizer of a client module uses them for calls to
+// functions whose bodies are not available, and the SIL linker uses them to
+// avoid deserializing bodies which are too large to be inlined.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SIL_SILFUNCTIONSUMMARY_H
+#define SWIFT_SIL_SILFUNCTIONSUMMARY_H
+
+#include "llvm/ADT/SmallVector.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace swift {
+
+/// The interprocedural summary of a function.
+///
+/// It is a conservative condensation of the results of SideEffectAnalysis and
+/// EscapeAnalysis: every effect or escape which is not excluded by the
+/// summary must be assumed to happen.
+class SILFunctionSummary {
+public:
+  /// Memory effects, as bits of an effects mask.
+  enum EffectKind : uint8_t {
+    Reads = 0x1,
+    Writes = 0x2,
+    Retains = 0x4,
+    Releases = 0x8,
+
+    AllEffects = Reads | Writes | Retains | Releases
+  };
+
+  /// Properties of the function as a whole, as bits of a flags mask.
+  enum FlagKind : uint8_t {
+    AllocsObjects = 0x1,
+    Traps = 0x2,
+    ReadsRC = 0x4,
+
+    AllFlags = AllocsObjects | Traps | ReadsRC
+  };
+
+  /// The summary for a single SIL argument of the function, including
+  /// indirect results.
+  struct ArgumentSummary {
+    /// The effects on memory which is reachable from the argument.
+    uint8_t Effects = AllEffects;
+
+    /// True if the argument value may escape the function, e.g. by being
+    /// stored into global memory, into memory reachable from another argument
+    /// or by being returned.
+    ///
+    /// Note that this only describes the value itself. Memory which is
+    /// reachable from the argument must always be assumed to escape.
+    bool MayEscape = true;
+  };
+
+  /// The body cost of a function whose body is not serialized.
+  static const uint32_t UnknownBodyCost = ~0U;
+
+private:
+  /// The effects on memory which cannot be associated to an argument.
+  uint8_t GlobalEffects = AllEffects;
+
+  /// See FlagKind.
+  uint8_t Flags = AllFlags;
+
+  /// The sum of the inline costs of all instructions in the serialized body,
+  /// or UnknownBodyCost.
+  uint32_t BodyCost = UnknownBodyCost;
+
+  llvm::SmallVector<ArgumentSummary, 4> Arguments;
+
+public:
+  /// Creates the worst-case summary for a function with \p numArguments SIL
+  /// arguments.
+  explicit SILFunctionSummary(unsigned numArguments = 0)
+    : Arguments(numArguments) {}
+
+  uint8_t getGlobalEffects() const { return GlobalEffects; }
+  void setGlobalEffects(uint8_t effects) { GlobalEffects = effects; }
+
+  uint8_t getFlags() const { return Flags; }
+  void setFlags(uint8_t flags) { Flags = flags; }
+  bool hasFlag(FlagKind flag) const { return (Flags & flag) != 0; }
+
+  bool hasBodyCost() const { return BodyCost != UnknownBodyCost; }
+  uint32_t getBodyCost() const { return BodyCost; }
+  void setBodyCost(uint32_t cost) {
+    BodyCost = std::min(cost, UnknownBodyCost - 1);
+  }
+
+  unsigned getNumArguments() const { return Arguments.size(); }
+  ArgumentSummary &getArgument(unsigned idx) { return Arguments[idx]; }
+  const ArgumentSummary &getArgument(unsigned idx) const {
+    return Arguments[idx];
+  }
+
+  /// Returns true if the summary doesn't exclude anything. There is no point
+  /// in storing such a summary.
+  bool isWorstCase() const {
+    if (GlobalEffects != AllEffects || Flags != AllFlags || hasBodyCost())
+      return false;
+    for (const ArgumentSummary &arg : Arguments) {
+      if (arg.Effects != AllEffects || !arg.MayEscape)
+        return false;
+    }
+    return true;
+  }
+};
+
+} // end swift namespace
+
+#endif
@@ -27,7 +27,9 @@
 #include "swift/SIL/SILDeclRef.h"
 #include "swift/SIL/SILDefaultWitnessTable.h"
 #include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILFunctionSummary.h"
 #include "swift/SIL/SILGlobalVariable.h"
+#include "swift/SIL/SILReceiverProfile.h"
 #include "swift/SIL/Notifications.h"
 #include "swift/SIL/SILType.h"
 #include "swift/SIL/SILVTable.h"
@@ -37,9 +39,12 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerIntPair.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/ilist.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 #include <functional>
 
@@ -102,6 +107,30 @@ private:
   /// Allocator that manages the memory of all the pieces of the SILModule.
   mutable llvm::BumpPtrAllocator BPA;
 
+  /// Every instruction is preceded by a header which records the size of its
+  /// allocation. The sizes are rounded up to multiples of the header size.
+  static constexpr size_t InstAllocHeaderSize = 16;
+
+  /// Instructions of up to this many bytes, including the header, are carved
+  /// from InstSlabs and recycled; larger ones are malloc'ed.
+  static constexpr size_t MaxRecycledInstAllocSize = 512;
+
+  static constexpr size_t NumInstSizeClasses =
+    MaxRecycledInstAllocSize / InstAllocHeaderSize;
+
+  /// The slabs of the recycled instructions. This is declared before the
+  /// function lists, so that it outlives the instructions.
+  mutable llvm::BumpPtrAllocator InstSlabs;
+
+  /// For each size class, the memory of instructions which were erased, in a
+  /// list linked through the first word of each allocation.
+  mutable void *InstFreeLists[NumInstSizeClasses] = {};
+
+  /// The number of bytes taken by the instructions which are alive, and the
+  /// maximum it ever reached.
+  mutable size_t InstBytes = 0;
+  mutable size_t PeakInstBytes = 0;
+
   /// The swift Module associated with this SILModule.
   ModuleDecl *TheSwiftModule;
 
@@ -177,6 +206,33 @@ private:
   /// constructed. In certain cases this was before all Modules had been loaded
   /// causing us to not
   std::unique_ptr<SerializedSILLoader> SILLoader;
+
+  /// The summaries of functions, keyed by function name. For definitions in
+  /// this module these are the summaries computed by the optimizer, which are
+  /// serialized into the module file. For external declarations these are
+  /// the summaries found in the module files which define the functions,
+  /// including negative results (None).
+  llvm::StringMap<Optional<SILFunctionSummary>> FunctionSummaries;
+
+  /// The number of instructions in the generic specializations which were
+  /// created so far. It is checked against the specialization budget.
+  unsigned NumSpecializedInstructions = 0;
+
+  /// The stream for the decisions of the generic specializers. It is opened on
+  /// first use if SILOptions::SpecializationRemarksPath is set.
+  std::unique_ptr<llvm::raw_fd_ostream> SpecializationRemarks;
+
+  /// True if the specialization remark file could not be opened. The error
+  /// is only diagnosed once.
+  bool SpecializationRemarksFailed = false;
+
+  /// The profile of the targets of dynamically dispatched calls. It is read on
+  /// first use if SILOptions::UseReceiverProfile is set.
+  std::unique_ptr<SILReceiverProfile> ReceiverProfile;
+
+  /// True if the receiver profile could not be read. The error is only
+  /// diagnosed once.
+  bool ReceiverProfileFailed = false;
   
   /// True if this SILModule really contains the whole module, i.e.
   /// optimizations can assume that they see the whole module.
@@ -189,6 +245,14 @@ private:
   /// invalidation message is sent.
   llvm::SetVector<DeleteNotificationHandler*> NotificationHandlers;
 
+  /// True while the pass manager runs function passes on several functions
+  /// concurrently.
+  bool MultiThreaded = false;
+
+  /// Guards the module allocator and the delete notifications while
+  /// \c MultiThreaded is set.
+  mutable llvm::sys::Mutex SharedStateLock;
+
   // Intentionally marked private so that we need to use 'constructSIL()'
   // to construct a SILModule.
   SILModule(ModuleDecl *M, SILOptions &Options, const DeclContext *associatedDC,
@@ -214,6 +278,14 @@ public:
   /// registered handlers. The order of handlers is deterministic but arbitrary.
   void notifyDeleteHandlers(ValueBase *V);
 
+  /// Returns true if functions of this module are currently transformed on
+  /// multiple threads.
+  bool isMultiThreaded() const { return MultiThreaded; }
+
+  /// Called by the pass manager before and after it runs a function pass on
+  /// multiple threads.
+  void setMultiThreaded(bool Value) { MultiThreaded = Value; }
+
   /// \brief This converts Swift types to SILTypes.
   mutable Lowering::TypeConverter Types;
 
@@ -438,6 +510,40 @@ public:
   /// the declaration of a function.
   SILFunction *hasFunction(StringRef Name, SILLinkage Linkage);
 
+  /// Returns the summary of \p F or null if there is none.
+  ///
+  /// If \p F is an external declaration the summary is looked up in the
+  /// serialized modules. Otherwise it is the summary which was set with
+  /// setFunctionSummary().
+  const SILFunctionSummary *lookUpFunctionSummary(SILFunction *F);
+
+  /// Returns the summary of \p F if it is already known, without looking
+  /// into serialized modules.
+  const SILFunctionSummary *getFunctionSummary(const SILFunction *F) const;
+
+  /// Sets the summary of the function definition \p F, which is serialized
+  /// together with the module.
+  void setFunctionSummary(SILFunction *F, SILFunctionSummary Summary);
+
+  /// Returns the number of instructions in the generic specializations which
+  /// were created in this module.
+  unsigned getNumSpecializedInstructions() const {
+    return NumSpecializedInstructions;
+  }
+
+  /// Accounts for a new generic specialization with \p numInsts instructions.
+  void addSpecializedInstructions(unsigned numInsts) {
+    NumSpecializedInstructions += numInsts;
+  }
+
+  /// Returns the stream for specialization remarks or null if remarks are not
+  /// requested or the file cannot be opened.
+  llvm::raw_ostream *getSpecializationRemarkStream();
+
+  /// Returns the receiver profile or null if there is none or it cannot be
+  /// read.
+  const SILReceiverProfile *getReceiverProfile();
+
   /// Link in all Witness Tables in the module.
   void linkAllWitnessTables();
 
@@ -549,6 +655,12 @@ public:
   /// invariants.
   void verify() const;
 
+  /// Run the SIL verifier on the module, but only on the bodies of the
+  /// functions for which \p ShouldVerify returns true. The symbols, the
+  /// globals and the tables of the module are always checked.
+  void
+  verify(llvm::function_ref<bool(const SILFunction &)> ShouldVerify) const;
+
   /// Pretty-print the module.
   void dump(bool Verbose = false) const;
   
@@ -590,9 +702,21 @@ public:
   /// Allocate memory for an instruction using the module's internal allocator.
   void *allocateInst(unsigned Size, unsigned Align) const;
 
-  /// Deallocate memory of an instruction.
+  /// Deallocate memory of an instruction. The memory is reused for later
+  /// instructions of about the same size.
   void deallocateInst(SILInstruction *I);
 
+  /// Returns the number of bytes taken by the instructions of this module.
+  size_t getInstructionMemoryUsage() const { return InstBytes; }
+
+  /// Returns the maximum of getInstructionMemoryUsage() over the lifetime of
+  /// this module.
+  size_t getPeakInstructionMemoryUsage() const { return PeakInstBytes; }
+
+  /// Returns the number of bytes allocated by this module for everything but
+  /// the instructions, like basic blocks, arguments and tables.
+  size_t getOtherMemoryUsage() const { return BPA.getTotalMemory(); }
+
   /// \brief Looks up the llvm intrinsic ID and type for the builtin function.
   ///
   /// \returns Returns llvm::Intrinsic::not_intrinsic if the function is not an
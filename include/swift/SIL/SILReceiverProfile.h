@@ -0,0 +1,58 @@
+//===--- SILReceiverProfile.h - Sampled targets of dynamic calls -*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the SILReceiverProfile class, which records how often the
+// class_method and witness_method calls of a function reached each method
+// implementation in a sampled run of the program. The speculative
+// devirtualizer uses it to decide which receiver types to test for.
+//
+// The profile is a text file with one record per line:
+//
+//   <caller> <implementation> <count>
+//
+// <caller> is the mangled name of the function which contains the call, or
+// '*' for all callers which have no records of their own. <implementation> is
+// the mangled name of the vtable or witness table entry which was called.
+// Records for the same pair are added up. Empty lines and lines starting with
+// '#' are ignored.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SIL_SILRECEIVERPROFILE_H
+#define SWIFT_SIL_SILRECEIVERPROFILE_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include <cstdint>
+#include <string>
+
+namespace swift {
+
+/// The sampled targets of the dynamically dispatched calls in a program.
+class SILReceiverProfile {
+  /// Maps the name of a caller to the number of samples of each
+  /// implementation which was called from it.
+  llvm::StringMap<llvm::StringMap<uint64_t>> Samples;
+
+public:
+  /// Adds the records in \p Buffer to the profile. Returns false and sets
+  /// \p Error if the buffer is malformed.
+  bool read(StringRef Buffer, std::string &Error);
+
+  /// Returns the number of samples in which a call in \p Caller reached
+  /// \p Target.
+  uint64_t getCount(StringRef Caller, StringRef Target) const;
+};
+
+} // end swift namespace
+
+#endif
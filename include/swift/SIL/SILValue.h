@@ -190,25 +190,29 @@ public:
 /// A formal SIL reference to a value, suitable for use as a stored
 /// operand.
 class Operand {
-  /// The value used as this operand.
-  SILValue TheValue;
+  // Walking a use-chain reads the next operand and the owner of every use.
+  // They come first, so that they are always adjacent in memory and share a
+  // cache line unless the operand starts at the very end of one.
 
   /// The next operand in the use-chain.  Note that the chain holds
   /// every use of the current ValueBase, not just those of the
   /// designated result.
   Operand *NextUse = nullptr;
 
-  /// A back-pointer in the use-chain, required for fast patching
-  /// of use-chains.
-  Operand **Back = nullptr;
-
   /// The owner of this operand.
   /// FIXME: this could be space-compressed.
   SILInstruction *Owner;
 
+  /// The value used as this operand.
+  SILValue TheValue;
+
+  /// A back-pointer in the use-chain, required for fast patching
+  /// of use-chains.
+  Operand **Back = nullptr;
+
   Operand(SILInstruction *owner) : Owner(owner) {}
   Operand(SILInstruction *owner, SILValue theValue)
-      : TheValue(theValue), Owner(owner) {
+      : Owner(owner), TheValue(theValue) {
     insertIntoCurrent();
   }
   template<unsigned N> friend class FixedOperandList;
@@ -0,0 +1,97 @@
+//===--- ARCSummaryAnalysis.h - Retain/release summaries --------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This analysis summarizes what a function does with the reference count of
+// each of its arguments. The summary of a function depends on the summaries of
+// the functions it calls: an @owned argument which is only forwarded to an
+// @owned parameter of a callee is consumed if the callee consumes it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SILOPTIMIZER_ANALYSIS_ARCSUMMARYANALYSIS_H
+#define SWIFT_SILOPTIMIZER_ANALYSIS_ARCSUMMARYANALYSIS_H
+
+#include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SILOptimizer/Analysis/Analysis.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace swift {
+
+class RCIdentityAnalysis;
+class SideEffectAnalysis;
+
+/// What a function does with the reference count of one of its arguments.
+enum class ARCArgumentKind {
+  /// Nothing is known about the argument.
+  Unknown,
+
+  /// The function neither retains nor releases the argument.
+  ReadOnly,
+
+  /// The function may retain the argument, but never releases it.
+  Guaranteed,
+
+  /// The argument is @owned and the function releases it exactly once on
+  /// every path to the return (and throw) block, either itself or by
+  /// forwarding it to a callee which consumes it.
+  Consumed
+};
+
+/// Computes and caches the ARC summaries of functions.
+class ARCSummaryAnalysis : public SILAnalysis {
+  SideEffectAnalysis *SEA;
+  RCIdentityAnalysis *RCIA;
+
+  /// The summaries of all functions which were queried so far.
+  llvm::DenseMap<SILFunction *, llvm::SmallVector<ARCArgumentKind, 4>> Cache;
+
+  /// The functions whose summaries are being computed. Used to break
+  /// recursion.
+  llvm::SmallPtrSet<SILFunction *, 8> InProgress;
+
+  /// Computes the summary of \p F.
+  void computeSummary(SILFunction *F,
+                      llvm::SmallVectorImpl<ARCArgumentKind> &Summary);
+
+public:
+  ARCSummaryAnalysis(SILModule *M)
+      : SILAnalysis(AnalysisKind::ARCSummary), SEA(nullptr), RCIA(nullptr) {}
+
+  static bool classof(const SILAnalysis *S) {
+    return S->getKind() == AnalysisKind::ARCSummary;
+  }
+
+  virtual void initialize(SILPassManager *PM) override;
+
+  /// Returns what \p F does with the reference count of argument \p Index.
+  ARCArgumentKind getArgumentKind(SILFunction *F, unsigned Index);
+
+  /// Returns the apply in the return block which consumes the @owned
+  /// argument \p Arg by forwarding it to a callee whose summary says
+  /// Consumed, or null if there is no such apply.
+  ApplyInst *findConsumingCall(SILArgument *Arg);
+
+  /// The summary of a function depends on its callees, so any change
+  /// invalidates all summaries.
+  virtual void invalidate(InvalidationKind K) override { Cache.clear(); }
+
+  virtual void invalidate(SILFunction *F, InvalidationKind K) override {
+    Cache.clear();
+  }
+};
+
+} // end namespace swift
+
+#endif
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Casting.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Optional.h"
@@ -129,6 +130,13 @@ namespace swift {
     /// Notify the analysis about a newly created function.
     virtual void notifyAnalysisOfFunction(SILFunction *F) {}
 
+    /// Called by the pass manager before it runs a function pass on all of
+    /// \p Functions concurrently. Analyses which cache per-function results
+    /// can prepare their storage so that it is not restructured while the
+    /// pass queries results for different functions from different threads.
+    virtual void
+    prepareForParallelAccess(llvm::ArrayRef<SILFunction *> Functions) {}
+
     /// Verify the state of this analysis.
     virtual void verify() const {}
 
@@ -198,6 +206,15 @@ namespace swift {
       }
     }
 
+    /// Create the (empty) storage entries for all \p Functions up front. While
+    /// the pass manager runs a pass in parallel no further entries are
+    /// inserted and each thread only touches the entry of its own function.
+    virtual void prepareForParallelAccess(
+        llvm::ArrayRef<SILFunction *> Functions) override {
+      for (SILFunction *F : Functions)
+        Storage.FindAndConstruct(F);
+    }
+
     FunctionAnalysisBase() {}
     virtual ~FunctionAnalysisBase() {
       for (auto D : Storage)
@@ -19,6 +19,7 @@
 namespace swift {
 class DominanceAnalysis;
 class SILBasicBlock;
+class SILModule;
 
 /// Cache a set of basic blocks that have been determined to be cold or hot.
 ///
@@ -42,7 +43,15 @@ class ColdBlockInfo {
   };
 
   enum {
-    RecursionDepthLimit = 3
+    RecursionDepthLimit = 3,
+
+    /// A block is cold if the profile shows that it is executed in less than
+    /// one of this many calls of its function.
+    ColdCountRatio = 1000,
+
+    /// A block is hot if the profile shows that it is executed at least
+    /// 1/HotCountRatio as often as the hottest block of the module.
+    HotCountRatio = 100
   };
 
   BranchHint getBranchHint(SILValue Cond, int recursionDepth);
@@ -61,6 +70,16 @@ public:
   }
 
   bool isCold(const SILBasicBlock *BB) { return isCold(BB, 0); }
+
+  /// Returns true if the profile data shows that \p BB is executed only in a
+  /// tiny fraction of the calls of its function. Returns false if there is no
+  /// profile data for the block.
+  static bool isColdByProfile(const SILBasicBlock *BB);
+
+  /// Returns the execution count from which on a block of \p M is hot, or
+  /// zero if there is no profile data for the module. This iterates over the
+  /// whole module, so clients should compute it once per pass.
+  static uint64_t getHotCount(SILModule &M);
 };
 } // end namespace swift
 
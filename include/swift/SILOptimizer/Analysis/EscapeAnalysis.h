@@ -766,6 +766,12 @@ public:
   bool canParameterEscape(FullApplySite FAS, int ParamIdx,
                           bool checkContentOfIndirectParam);
 
+  /// Returns true if the value of the argument with index \p ArgIdx of the
+  /// function \p F can escape the function, either globally, via the return
+  /// value or into memory which is reachable from another argument.
+  /// This is what is recorded in the function's SILFunctionSummary.
+  bool canArgumentEscape(SILFunction *F, unsigned ArgIdx);
+
   /// Returns true if the pointers \p V1 and \p V2 can possibly point to the
   /// same memory.
   /// If at least one of the pointers refers to a local object and the
@@ -321,6 +321,12 @@ private:
   /// Get the side-effects of a function, which has an @effects attribute.
   /// Returns true if \a F has an @effects attribute which could be handled.
   static bool getDefinedEffects(FunctionEffects &Effects, SILFunction *F);
+
+  /// Gets the effects of a call to the external function \p F from the
+  /// function summary of the module which defines it. \p Effects must be
+  /// sized for the arguments of the call.
+  /// Returns true if there is such a summary.
+  static bool getSummaryEffects(FunctionEffects &Effects, SILFunction *F);
   
   /// Get the side-effects of a semantic call.
   /// Return true if \p ASC could be handled.
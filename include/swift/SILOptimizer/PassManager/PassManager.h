@@ -15,8 +15,10 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Mutex.h"
 #include <vector>
 
 #ifndef SWIFT_SILOPTIMIZER_PASSMANAGER_PASSMANAGER_H
@@ -24,6 +26,7 @@
 
 namespace swift {
 
+class BottomUpFunctionOrder;
 class SILFunction;
 class SILFunctionTransform;
 class SILModule;
@@ -65,10 +68,29 @@ class SILPassManager {
   /// Set to true when a pass invalidates an analysis.
   bool CurrentPassHasInvalidated = false;
 
+  /// The functions which the current module pass invalidated or created.
+  /// Only those are verified again after the pass, unless the pass
+  /// invalidated the whole module.
+  llvm::SmallPtrSet<SILFunction *, 16> InvalidatedFunctions;
+
+  /// Set to true when a pass invalidates the analyses of the whole module.
+  bool CurrentPassHasInvalidatedModule = false;
+
+  /// Counts the unchanged functions which were considered for the sample
+  /// verification of -sil-verify-unchanged-sample-rate.
+  unsigned NumUnchangedFunctionsSeen = 0;
+
   /// True if we need to stop running passes and restart again on the
   /// same function.
   bool RestartPipeline = false;
 
+  /// True while a function pass is running on multiple threads.
+  bool RunningInParallel = false;
+
+  /// Guards the analyses and the completed-passes masks while a function
+  /// pass is running on multiple threads.
+  llvm::sys::Mutex ParallelStateLock;
+
 public:
   /// C'tor. It creates and registers all analysis passes, which are defined
   /// in Analysis.def.
@@ -100,6 +122,8 @@ public:
   void addFunctionToWorklist(SILFunction *F) {
     assert(F && F->isDefinition() && F->shouldOptimize() &&
            "Expected optimizable function definition!");
+    assert(!RunningInParallel &&
+           "Passes running in parallel must not create functions");
     FunctionWorklist.push_back(F);
   }
 
@@ -113,12 +137,15 @@ public:
   void invalidateAnalysis(SILAnalysis::InvalidationKind K) {
     assert(K != SILAnalysis::InvalidationKind::Nothing &&
            "Invalidation call must invalidate some trait");
+    assert(!RunningInParallel &&
+           "Passes running in parallel must only invalidate their function");
 
     for (auto AP : Analysis)
       if (!AP->isLocked())
         AP->invalidate(K);
 
     CurrentPassHasInvalidated = true;
+    CurrentPassHasInvalidatedModule = true;
 
     // Assume that all functions have changed. Clear all masks of all functions.
     CompletedPassesMap.clear();
@@ -134,21 +161,24 @@ public:
   /// is the job of the analysis to make sure no extra work is done if the
   /// particular analysis has been done on the function.
   void notifyAnalysisOfFunction(SILFunction *F) {
+    assert(!RunningInParallel &&
+           "Passes running in parallel must not create functions");
     for (auto AP : Analysis)
       AP->notifyAnalysisOfFunction(F);
+    InvalidatedFunctions.insert(F);
   }
 
   /// \brief Broadcast the invalidation of the function to all analysis.
   void invalidateAnalysis(SILFunction *F,
                           SILAnalysis::InvalidationKind K) {
-    // Invalidate the analysis (unless they are locked)
-    for (auto AP : Analysis)
-      if (!AP->isLocked())
-        AP->invalidate(F, K);
-    
-    CurrentPassHasInvalidated = true;
-    // Any change let all passes run again.
-    CompletedPassesMap[F].reset();
+    // Other functions may be optimized concurrently. The analyses are shared
+    // between all functions, so serialize the invalidation.
+    if (RunningInParallel) {
+      llvm::sys::ScopedLock Lock(ParallelStateLock);
+      invalidateAnalysisOfFunction(F, K);
+      return;
+    }
+    invalidateAnalysisOfFunction(F, K);
   }
 
   /// \brief Broadcast the invalidation of the function to all analysis.
@@ -156,12 +186,15 @@ public:
   /// module.
   void invalidateAnalysisForDeadFunction(SILFunction *F,
                                          SILAnalysis::InvalidationKind K) {
+    assert(!RunningInParallel &&
+           "Passes running in parallel must not delete functions");
     // Invalidate the analysis (unless they are locked)
     for (auto AP : Analysis)
       if (!AP->isLocked())
         AP->invalidateForDeadFunction(F, K);
     
     CurrentPassHasInvalidated = true;
+    InvalidatedFunctions.erase(F);
     // Any change let all passes run again.
     CompletedPassesMap[F].reset();
   }
@@ -207,10 +240,32 @@ public:
 
   typedef llvm::ArrayRef<SILFunctionTransform *> PassList;
 private:
+  /// Invalidate the analyses of \p F and reset its completed-passes mask.
+  void invalidateAnalysisOfFunction(SILFunction *F,
+                                    SILAnalysis::InvalidationKind K) {
+    // Invalidate the analysis (unless they are locked)
+    for (auto AP : Analysis)
+      if (!AP->isLocked())
+        AP->invalidate(F, K);
+    
+    CurrentPassHasInvalidated = true;
+    InvalidatedFunctions.insert(F);
+    // Any change let all passes run again.
+    CompletedPassesMap[F].reset();
+  }
+
+  /// Records that \p Count runs of function passes were skipped, because the
+  /// functions didn't change since the last run of the pass.
+  void countSkippedPassRuns(unsigned Count);
+
   /// Run the SIL module transform \p SMT over all the functions in
   /// the module.
   void runModulePass(SILModuleTransform *SMT);
 
+  /// Verify the module after a module pass which invalidated the functions
+  /// in InvalidatedFunctions only, skipping the bodies of the other ones.
+  void verifyInvalidatedFunctions();
+
   /// Run the passes in \p FuncTransforms on the function \p F.
   void runPassesOnFunction(PassList FuncTransforms, SILFunction *F,
                            bool runToCompletion);
@@ -220,6 +275,26 @@ private:
   /// of the optimization cycle (this is a debug feature).
   void runFunctionPasses(PassList FuncTransforms);
 
+  /// Run the passes in \p FuncTransforms on the functions in the function
+  /// worklist until the worklist is empty.
+  void processFunctionWorklist(PassList FuncTransforms);
+
+  /// Returns true if the group of function passes \p FuncTransforms should
+  /// be run with runFunctionPassesInParallel.
+  bool shouldRunFunctionPassesInParallel(PassList FuncTransforms);
+
+  /// Run the passes in \p FuncTransforms on groups of functions which don't
+  /// call each other. Passes which support it are run on all functions of a
+  /// group concurrently, all other passes run on the group one function after
+  /// another.
+  void runFunctionPassesInParallel(PassList FuncTransforms,
+                                   BottomUpFunctionOrder &BottomUpOrder);
+
+  /// Run the thread-safe function pass \p SFT on all functions in
+  /// \p Functions, using up to SILOptions::NumThreads threads.
+  void runPassOnFunctionsInParallel(SILFunctionTransform *SFT,
+                                    llvm::ArrayRef<SILFunction *> Functions);
+
   /// A helper function that returns (based on SIL stage and debug
   /// options) whether we should continue running passes.
   bool continueTransforming();
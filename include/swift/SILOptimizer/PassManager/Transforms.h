@@ -96,6 +96,24 @@ namespace swift {
 
     void injectFunction(SILFunction *Func) { F = Func; }
 
+    /// Returns true if the pass may run on several functions at the same
+    /// time, each on its own instance of the pass.
+    ///
+    /// Such a pass must only read and modify the body of the function it is
+    /// run on and may only use analyses which are computed from that body
+    /// alone, like dominance, post-order or loop info. It must not create or
+    /// delete functions, create new types or type lowerings, create uses of
+    /// SILUndef or need delete notifications.
+    virtual bool canRunInParallel() { return false; }
+
+    /// Returns true if running the pass a second time on a function it just
+    /// transformed has no effect, because the pass already iterates to a fix
+    /// point.
+    ///
+    /// The pass manager then doesn't run the pass again on the function until
+    /// some other pass changes the function.
+    virtual bool isIdempotent() { return false; }
+
     /// \brief Notify the pass manager of a function that needs to be
     /// processed by the function passes and the analyses.
     void notifyPassManagerOfFunction(SILFunction *F) {
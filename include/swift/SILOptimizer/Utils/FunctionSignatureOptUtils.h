@@ -64,6 +64,10 @@ struct ArgumentDescriptor {
   /// function which has a throw block.
   ReleaseList CalleeReleaseInThrowBlock;
 
+  /// If non-null, this is the call in the return block of the callee which
+  /// consumes this @owned parameter instead of a release.
+  ApplyInst *ConsumingCall;
+
   /// The projection tree of this arguments.
   ProjectionTree ProjTree;
 
@@ -81,7 +85,7 @@ struct ArgumentDescriptor {
         Decl(A->getDecl()), IsEntirelyDead(false), Explode(false),
         OwnedToGuaranteed(false),
         IsIndirectResult(A->isIndirectResult()),
-        CalleeRelease(), CalleeReleaseInThrowBlock(),
+        CalleeRelease(), CalleeReleaseInThrowBlock(), ConsumingCall(nullptr),
         ProjTree(A->getModule(), A->getType()) {}
 
   ArgumentDescriptor(const ArgumentDescriptor &) = delete;
@@ -121,7 +125,16 @@ struct ArgumentDescriptor {
       return false;
 
     size_t explosionSize = ProjTree.liveLeafCount();
-    return explosionSize >= 1 && explosionSize <= 3;
+    if (explosionSize >= 1 && explosionSize <= 3)
+      return true;
+
+    // If some of the fields of the aggregate are dead, exploding it removes
+    // them from the parameter list, and only the used fields are passed. This
+    // is worth a few more arguments.
+    const size_t MaxPartiallyDeadExplosionSize = 6;
+    return explosionSize >= 1 &&
+           explosionSize <= MaxPartiallyDeadExplosionSize &&
+           explosionSize < ProjTree.leafCount();
   }
 };
 
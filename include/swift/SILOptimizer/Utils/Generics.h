@@ -60,12 +60,27 @@ class ReabstractionInfo {
   /// SubstitutedType.
   CanSILFunctionType SpecializedType;
 
+  /// If specialization is not possible, a short description of the reason.
+  StringRef RejectReason;
+
+  /// For a partial specialization, the caller whose generic parameters the
+  /// specialization keeps. Null for a full specialization.
+  SILFunction *PartialContext = nullptr;
+
+  /// For a partial specialization, the substitutions of the original function
+  /// with the replacement types mapped out of the context of PartialContext.
+  llvm::SmallVector<Substitution, 4> InterfaceParamSubs;
+
 public:
   /// Constructs the ReabstractionInfo for generic function \p Orig with
   /// substitutions \p ParamSubs.
+  /// If \p Caller is given and some of the replacement types are archetypes of
+  /// \p Caller, the specialization may be partial: it is then generic over the
+  /// generic signature of \p Caller.
   /// If specialization is not possible getSpecializedType() will return an
   /// invalid type.
-  ReabstractionInfo(SILFunction *Orig, ArrayRef<Substitution> ParamSubs);
+  ReabstractionInfo(SILFunction *Orig, ArrayRef<Substitution> ParamSubs,
+                    SILFunction *Caller = nullptr);
 
   /// Does the \p ArgIdx refer to an indirect out-parameter?
   bool isResultIndex(unsigned ArgIdx) const {
@@ -123,6 +138,34 @@ public:
   /// possible.
   CanSILFunctionType getSpecializedType() const { return SpecializedType; }
 
+  /// Returns the reason why specialization is not possible, or an empty
+  /// string if it is possible.
+  StringRef getRejectReason() const { return RejectReason; }
+
+  /// Returns true if the specialization keeps the generic parameters of the
+  /// caller.
+  bool isPartialSpecialization() const { return PartialContext != nullptr; }
+
+  /// Returns the generic parameters of the specialized function, which are
+  /// the caller's for a partial specialization and null otherwise.
+  GenericParamList *getSpecializedGenericParams() const {
+    return PartialContext ? PartialContext->getContextGenericParams() : nullptr;
+  }
+
+  /// Returns the substitutions of the original function in terms of the
+  /// generic signature of a partial specialization.
+  ArrayRef<Substitution> getInterfaceParamSubs() const {
+    return InterfaceParamSubs;
+  }
+
+  /// Returns the substitutions which a call site from the caller passes to a
+  /// partial specialization. Empty for a full specialization.
+  ArrayRef<Substitution> getCallerSubstitutions() const {
+    if (!PartialContext)
+      return {};
+    return PartialContext->getForwardingSubstitutions();
+  }
+
   /// Create a specialized function type for a specific substituted type \p
   /// SubstFTy by applying the re-abstractions.
   CanSILFunctionType createSpecializedType(CanSILFunctionType SubstFTy,
@@ -146,6 +189,9 @@ public:
                          IsFragile_t Fragile,
                          const ReabstractionInfo &ReInfo);
 
+  /// Returns the name of the specialized function.
+  StringRef getClonedName() const { return ClonedName; }
+
   /// If we already have this specialization, reuse it.
   SILFunction *lookupSpecialization();
 
@@ -166,6 +212,67 @@ public:
   }
 };
 
+// =============================================================================
+// Specialization cost model.
+// =============================================================================
+
+/// The estimates of the cost model for a single specialization.
+struct SpecializationCost {
+  /// The number of instructions in the generic function. A new specialization
+  /// adds about as many instructions to the module.
+  unsigned Size = 0;
+
+  /// The number of instructions in the generic function which depend on the
+  /// generic parameters. These are the ones which get cheaper in the
+  /// specialization.
+  unsigned GenericInsts = 0;
+
+  /// The execution count of the call site from profile data, or 1 if there is
+  /// no profile.
+  uint64_t Frequency = 1;
+};
+
+/// Estimates the cost of specializing \p Callee for the call site \p Apply
+/// into \p Cost and checks it against the cost model and the specialization
+/// budget of the module.
+///
+/// Returns an empty string if the specialization is worth its size, otherwise
+/// the reason for rejecting it.
+StringRef checkSpecializationCost(ApplySite Apply, SILFunction *Callee,
+                                  SpecializationCost &Cost);
+
+/// Computes Size and GenericInsts of \p Cost for the generic function \p F.
+void computeSpecializationSize(SILFunction *F, SpecializationCost &Cost);
+
+/// A decision of one of the generic specializers.
+///
+/// If -specialization-remarks-path is set, each decision is appended to that
+/// file as a JSON object on a single line.
+struct SpecializationRemark {
+  /// The pass which made the decision.
+  StringRef Pass;
+
+  /// "created", "reused" or "rejected".
+  StringRef Decision;
+
+  /// The reason for a rejection.
+  StringRef Reason;
+
+  /// The function containing the call site, if there is one.
+  StringRef Caller;
+
+  /// The generic function.
+  StringRef Callee;
+
+  /// The name of the created or reused specialization.
+  StringRef Specialization;
+
+  SpecializationCost Cost;
+
+  /// Writes the remark to the remark stream of \p M, if there is one.
+  void emit(SILModule &M) const;
+};
+
 // =============================================================================
 // Prespecialized symbol lookup.
 // =============================================================================
@@ -377,6 +377,13 @@ static inline llvm::hash_code hash_value(const LSLocation &L) {
   return llvm::hash_combine(hash_value((LSBase)L));
 }
 
+/// Returns true if an instruction in \p BB may read or write memory.
+///
+/// The data flows over LSLocations only query alias analysis for such
+/// instructions, so their cost grows with the number of blocks which have
+/// them. All other blocks only pass their bit vectors on.
+bool mayAccessMemory(SILBasicBlock *BB);
+
 } // end swift namespace
 
 /// LSLocation and LSValue are used in DenseMap.
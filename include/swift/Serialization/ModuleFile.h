@@ -73,6 +73,10 @@ class ModuleFile : public LazyMemberLoader {
   /// The target the module was built for.
   StringRef TargetTriple;
 
+  /// The interface hash of the module, or the empty string if the module
+  /// doesn't record one.
+  StringRef InterfaceHash;
+
   /// The data blob containing all of the module's identifiers.
   StringRef IdentifierData;
 
@@ -279,6 +283,7 @@ private:
   std::unique_ptr<SerializedDeclTable> ExtensionDecls;
   std::unique_ptr<SerializedDeclTable> ClassMembersByName;
   std::unique_ptr<SerializedDeclTable> OperatorMethodDecls;
+  std::unique_ptr<SerializedDeclTable> ProtocolConformers;
   std::unique_ptr<SerializedLocalDeclTable> LocalTypeDecls;
 
   class ObjCMethodTableInfo;
@@ -287,6 +292,17 @@ private:
 
   std::unique_ptr<SerializedObjCMethodTable> ObjCMethods;
 
+  class DeclMemberNamesTableInfo;
+  using SerializedDeclMemberNamesTable =
+    llvm::OnDiskIterableChainedHashTable<DeclMemberNamesTableInfo>;
+
+  std::unique_ptr<SerializedDeclMemberNamesTable> DeclMemberNames;
+
+  /// The IDs of the deserialized nominal types and extensions whose members
+  /// can be loaded by name through \c DeclMemberNames.
+  llvm::DenseMap<const IterableDeclContext *, serialization::DeclID>
+    NamedMemberContexts;
+
   llvm::DenseMap<const ValueDecl *, Identifier> PrivateDiscriminatorsByValue;
 
   TinyPtrVector<Decl *> ImportDecls;
@@ -304,6 +320,25 @@ private:
   std::unique_ptr<GroupNameTable> GroupNamesMap;
   std::unique_ptr<SerializedDeclCommentTable> DeclCommentTable;
 
+  /// A block of comment text, see \c comment_block::CommentTextLayout.
+  struct CommentTextBlock {
+    /// The offset of the block in the uncompressed text of all blocks.
+    uint32_t Offset;
+
+    /// The size of the uncompressed block.
+    uint32_t Size;
+
+    /// The block as stored in the module doc file.
+    StringRef Stored;
+
+    /// The uncompressed block, or an empty string if it has not been
+    /// decompressed yet.
+    StringRef Text;
+  };
+
+  /// The blocks of comment text, sorted by offset.
+  std::vector<CommentTextBlock> CommentTextBlocks;
+
   struct {
     /// The decl ID of the main class in this module file, if it has one.
     unsigned EntryPointDeclID : 31;
@@ -395,6 +430,16 @@ private:
   std::unique_ptr<ModuleFile::SerializedObjCMethodTable>
   readObjCMethodTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+  /// Read an on-disk member name table stored in
+  /// index_block::DeclMemberNamesLayout format.
+  std::unique_ptr<ModuleFile::SerializedDeclMemberNamesTable>
+  readDeclMemberNamesTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
+  /// Read an on-disk conformance table stored in
+  /// index_block::ProtocolConformersLayout format.
+  std::unique_ptr<SerializedDeclTable>
+  readProtocolConformersTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
   /// Reads the index block, which contains global tables.
   ///
   /// Returns false if there was an error.
@@ -408,6 +453,16 @@ private:
   std::unique_ptr<GroupNameTable>
   readGroupTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+  /// Reads the index of the comment text blocks stored in
+  /// \c comment_block::CommentTextLayout format.
+  ///
+  /// Returns false if there was an error.
+  bool readCommentTextBlocks(StringRef blobData);
+
+  /// Returns the comment text at \p offset, decompressing the block which
+  /// contains it if necessary.
+  StringRef getCommentText(uint32_t offset, uint32_t size);
+
   /// Reads the comment block, which contains USR to comment mappings.
   ///
   /// Returns false if there was an error.
@@ -587,6 +642,15 @@ public:
   /// Adds all local type decls to the given vector.
   void getLocalTypeDecls(SmallVectorImpl<TypeDecl*> &Results);
 
+  /// Adds all conformances to \p protocol declared in this module to the
+  /// given vector.
+  ///
+  /// This only deserializes the conformances of the nominal types and
+  /// extensions which are listed in the conformance index for the protocol's
+  /// name.
+  void lookupConformancesTo(ProtocolDecl *protocol,
+                            SmallVectorImpl<ProtocolConformance *> &results);
+
   /// Adds all top-level decls to the given vector.
   ///
   /// This includes all decls that should be displayed to clients of the module.
@@ -594,6 +658,10 @@ public:
   /// shadowed clang module.
   void getDisplayDecls(SmallVectorImpl<Decl*> &results);
 
+  /// The hash of the module's interface, or the empty string if the module
+  /// doesn't record one.
+  StringRef getInterfaceHash() const { return InterfaceHash; }
+
   StringRef getModuleFilename() const {
     // FIXME: This seems fragile, maybe store the filename separately ?
     return ModuleInputBuffer->getBufferIdentifier();
@@ -607,6 +675,11 @@ public:
   virtual void loadAllMembers(Decl *D,
                               uint64_t contextData) override;
 
+  virtual bool
+  loadNamedMembers(const IterableDeclContext *IDC, Identifier name,
+                   uint64_t contextData,
+                   SmallVectorImpl<ValueDecl *> &members) override;
+
   virtual void
   loadAllConformances(const Decl *D, uint64_t contextData,
                     SmallVectorImpl<ProtocolConformance*> &Conforms) override;
@@ -53,7 +53,7 @@ const uint16_t VERSION_MAJOR = 0;
 /// in source control, you should also update the comment to briefly
 /// describe what change you made. The content of this comment isn't important;
 /// it just ensures a conflict if two people change the module format.
-const uint16_t VERSION_MINOR = 251; // Last change: SILFunctionType::isPseudogeneric
+const uint16_t VERSION_MINOR = 258; // Last change: interface hash
 
 using DeclID = PointerEmbeddedInt<unsigned, 31>;
 using DeclIDField = BCFixed<31>;
@@ -408,7 +408,8 @@ namespace control_block {
   enum {
     METADATA = 1,
     MODULE_NAME,
-    TARGET
+    TARGET,
+    INTERFACE_HASH
   };
 
   using MetadataLayout = BCRecordLayout<
@@ -428,6 +429,13 @@ namespace control_block {
     TARGET,
     BCBlob // LLVM triple
   >;
+
+  /// A hash of the tokens of the module's source files outside of function
+  /// bodies, which changes only if the module's interface may have changed.
+  using InterfaceHashLayout = BCRecordLayout<
+    INTERFACE_HASH,
+    BCBlob // hash, as a string of hex digits
+  >;
 }
 
 /// The record types within the options block (a sub-block of the control
@@ -442,7 +450,8 @@ namespace options_block {
     XCC,
     IS_SIB,
     IS_TESTABLE,
-    RESILIENCE_STRATEGY
+    RESILIENCE_STRATEGY,
+    RESILIENCE_DOMAIN
   };
 
   using SDKPathLayout = BCRecordLayout<
@@ -468,6 +477,11 @@ namespace options_block {
     RESILIENCE_STRATEGY,
     BCFixed<2>
   >;
+
+  using ResilienceDomainLayout = BCRecordLayout<
+    RESILIENCE_DOMAIN,
+    BCBlob // domain name
+  >;
 }
 
 /// The record types within the input block.
@@ -1465,6 +1479,15 @@ namespace index_block {
     DECL_CONTEXT_OFFSETS,
     LOCAL_TYPE_DECLS,
     NORMAL_CONFORMANCE_OFFSETS,
+
+    /// The member name index, which maps a nominal type or extension and a
+    /// member name to the members with that name.
+    DECL_MEMBER_NAMES,
+
+    /// The conformance index, which maps a protocol name to the nominal types
+    /// and extensions which declare a conformance to a protocol with that
+    /// name.
+    PROTOCOL_CONFORMERS,
   };
 
   using OffsetsLayout = BCGenericRecordLayout<
@@ -1489,6 +1512,18 @@ namespace index_block {
     BCBlob         // map from Objective-C selectors to methods with that selector
   >;
 
+  using DeclMemberNamesLayout = BCRecordLayout<
+    DECL_MEMBER_NAMES,  // record ID
+    BCVBR<16>,          // table offset within the blob (see below)
+    BCBlob              // map from decl IDs and names to member decl IDs
+  >;
+
+  using ProtocolConformersLayout = BCRecordLayout<
+    PROTOCOL_CONFORMERS,  // record ID
+    BCVBR<16>,            // table offset within the blob (see below)
+    BCBlob                // map from protocol names to decl kinds / decl IDs
+  >;
+
   using EntryPointLayout = BCRecordLayout<
     ENTRY_POINT,
     DeclIDField  // the ID of the main class; 0 if there was a main source file
@@ -1500,6 +1535,7 @@ namespace comment_block {
   enum RecordKind {
     DECL_COMMENTS = 1,
     GROUP_NAMES = 2,
+    COMMENT_TEXT = 3,
   };
 
   using DeclCommentListLayout = BCRecordLayout<
@@ -1508,6 +1544,18 @@ namespace comment_block {
     BCBlob         // map from Decl IDs to comments
   >;
 
+  /// The text of all comments, referenced by offset and size from the
+  /// DECL_COMMENTS table.
+  ///
+  /// The blob starts with the number of blocks, followed by the uncompressed
+  /// and the stored size of each block, followed by the stored blocks. A
+  /// block is compressed with zlib if its stored size is smaller than its
+  /// uncompressed size. A comment never spans more than one block.
+  using CommentTextLayout = BCRecordLayout<
+    COMMENT_TEXT, // record ID
+    BCBlob        // the blocks of comment text
+  >;
+
   using GroupNamesLayout = BCRecordLayout<
     GROUP_NAMES,    // record ID
     BCBlob          // actual names
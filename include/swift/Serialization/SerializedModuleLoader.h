@@ -15,29 +15,65 @@
 
 #include "swift/AST/Module.h"
 #include "swift/AST/ModuleLoader.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TimeValue.h"
+#include <memory>
+#include <mutex>
 
 namespace swift {
 class ModuleFile;
 
+/// Keeps the contents of serialized module files loaded across
+/// SerializedModuleLoaders, so that a long-lived process which sets up many
+/// ASTContexts, like SourceKit, reads each module file once instead of once
+/// per context. An entry is read again when the size or modification time of
+/// its file changes.
+///
+/// Buffers which were handed out stay valid when their entry is replaced, so
+/// modules loaded from an older version of a file keep working.
+class ModuleBufferCache {
+  struct Entry {
+    std::shared_ptr<llvm::MemoryBuffer> Buffer;
+    llvm::sys::TimeValue ModificationTime;
+    uint64_t Size = 0;
+  };
+
+  llvm::StringMap<Entry> Entries;
+  std::mutex Lock;
+
+public:
+  /// Returns the contents of the file at \p path, reading the file if it is
+  /// not cached or if the cached contents are out of date.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> getFile(StringRef path);
+
+  /// Drops all cached contents.
+  void clear();
+};
+
 /// \brief Imports serialized Swift modules into an ASTContext.
 class SerializedModuleLoader : public ModuleLoader {
 private:
   ASTContext &Ctx;
+  ModuleBufferCache *SharedBuffers;
   llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> MemoryBuffers;
   /// A { module, generation # } pair.
   using LoadedModulePair = std::pair<std::unique_ptr<ModuleFile>, unsigned>;
   std::vector<LoadedModulePair> LoadedModuleFiles;
 
-  explicit SerializedModuleLoader(ASTContext &ctx, DependencyTracker *tracker);
+  explicit SerializedModuleLoader(ASTContext &ctx, DependencyTracker *tracker,
+                                  ModuleBufferCache *sharedBuffers);
 
 public:
   /// \brief Create a new importer that can load serialized Swift modules
   /// into the given ASTContext.
+  ///
+  /// If \p sharedBuffers is given, module files are read through it.
   static std::unique_ptr<SerializedModuleLoader>
-  create(ASTContext &ctx, DependencyTracker *tracker = nullptr) {
+  create(ASTContext &ctx, DependencyTracker *tracker = nullptr,
+         ModuleBufferCache *sharedBuffers = nullptr) {
     return std::unique_ptr<SerializedModuleLoader>{
-      new SerializedModuleLoader(ctx, tracker)
+      new SerializedModuleLoader(ctx, tracker, sharedBuffers)
     };
   }
 
@@ -112,6 +148,10 @@ class SerializedASTFile final : public LoadedFile {
 public:
   bool isSIB() const { return IsSIB; }
 
+  /// The hash of the interface of the serialized file, or the empty string
+  /// if the file doesn't record one.
+  StringRef getInterfaceHash() const;
+
   virtual bool isSystemModule() const override;
 
   virtual void lookupValue(Module::AccessPathTy accessPath,
@@ -157,6 +197,10 @@ public:
   virtual void
   getLocalTypeDecls(SmallVectorImpl<TypeDecl*> &results) const override;
 
+  virtual void lookupConformancesTo(
+      ProtocolDecl *protocol,
+      SmallVectorImpl<ProtocolConformance *> &results) const override;
+
   virtual void getDisplayDecls(SmallVectorImpl<Decl*> &results) const override;
 
   virtual void
@@ -16,6 +16,7 @@
 #include "swift/AST/Decl.h"
 #include "swift/AST/Identifier.h"
 #include "swift/SIL/SILDeclRef.h"
+#include "swift/SIL/SILFunctionSummary.h"
 #include "swift/SIL/SILLinkage.h"
 #include <memory>
 #include <vector>
@@ -102,6 +103,10 @@ public:
   SILWitnessTable *lookupWitnessTable(SILWitnessTable *C);
   SILDefaultWitnessTable *lookupDefaultWitnessTable(SILDefaultWitnessTable *C);
 
+  /// Returns the serialized summary of the function \p Name from the first
+  /// module which has one.
+  Optional<SILFunctionSummary> lookupFunctionSummary(StringRef Name);
+
   /// Invalidate the cached entries for deserialized SILFunctions.
   void invalidateCaches();
 
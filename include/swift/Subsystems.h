@@ -54,6 +54,7 @@ namespace swift {
   class SILOptions;
   class SILModule;
   class SILParserTUState;
+  class SkippedFunctionBodyCallbacks;
   class SourceFile;
   class SourceManager;
   class Token;
@@ -107,11 +108,16 @@ namespace swift {
   /// \param DelayedParseCB if non-null enables delayed parsing for function
   /// bodies.
   ///
+  /// \param SkippedBodyCB if non-null decides which function bodies are
+  /// skipped instead of parsed.
+  ///
   /// \return true if the parser found code with side effects.
   bool parseIntoSourceFile(SourceFile &SF, unsigned BufferID, bool *Done,
                            SILParserState *SIL = nullptr,
                            PersistentParserState *PersistentState = nullptr,
-                           DelayedParsingCallbacks *DelayedParseCB = nullptr);
+                           DelayedParsingCallbacks *DelayedParseCB = nullptr,
+                           SkippedFunctionBodyCallbacks *SkippedBodyCB =
+                               nullptr);
 
   /// \brief Finish the parsing by going over the nodes that were delayed
   /// during the first parsing pass.
@@ -153,7 +159,15 @@ namespace swift {
 
     /// Indicates that the type checker is checking code that will be
     /// immediately executed.
-    ForImmediateMode = 1 << 2
+    ForImmediateMode = 1 << 2,
+
+    /// If set, dumps wall time taken and the solver work done to check each
+    /// expression to llvm::errs().
+    DebugTimeExpressionTypeChecking = 1 << 3,
+
+    /// If set, the bodies of functions which cannot be inlined into other
+    /// modules are not type-checked.
+    SkipNonInlinableFunctionBodies = 1 << 4
   };
 
   /// Once parsing and name-binding are complete, this walks the AST to resolve
@@ -164,10 +178,14 @@ namespace swift {
   ///
   /// \param WarnLongFunctionBodies If non-zero, warn when a function body takes
   /// longer than this many milliseconds to type-check
+  ///
+  /// \param WarnLongExpressionTypeChecking If non-zero, warn when an
+  /// expression takes longer than this many milliseconds to type-check
   void performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
                            OptionSet<TypeCheckingFlags> Options,
                            unsigned StartElem = 0,
-                           unsigned WarnLongFunctionBodies = 0);
+                           unsigned WarnLongFunctionBodies = 0,
+                           unsigned WarnLongExpressionTypeChecking = 0);
 
   /// Once type checking is complete, this walks protocol requirements
   /// to resolve default witnesses.
@@ -56,12 +56,32 @@ swift_reflection_addReflectionInfo(SwiftReflectionContextRef ContextRef,
                                    swift_reflection_info_t Info);
 
 
+/// Discards the contents of the remote process's memory which the context
+/// has cached. This must be called after the remote process has run, since
+/// it may have changed the memory.
+void
+swift_reflection_invalidateMemoryCache(SwiftReflectionContextRef ContextRef);
+
 /// Returns a boolean indicating if the isa mask was successfully
 /// read, in which case it is stored in the isaMask out parameter.
 int
 swift_reflection_readIsaMask(SwiftReflectionContextRef ContextRef,
                              uintptr_t *outIsaMask);
 
+/// Reads the runtime performance counters of the remote process, summed
+/// over all of its threads, storing at most MaxCount of them in OutCounts.
+///
+/// Returns the number of counters of the remote runtime, which may be more
+/// than MaxCount, or 0 if it wasn't built with counters.
+size_t
+swift_reflection_readRuntimeCounters(SwiftReflectionContextRef ContextRef,
+                                     uint64_t *OutCounts,
+                                     size_t MaxCount);
+
+/// Returns the name of the runtime performance counter at Index, or NULL if
+/// there is no such counter.
+const char *swift_reflection_runtimeCounterName(size_t Index);
+
 /// Returns an opaque type reference for a metadata pointer, or
 /// NULL if one can't be constructed.
 ///
@@ -126,6 +146,31 @@ swift_reflection_childOfInstance(SwiftReflectionContextRef ContextRef,
                                  uintptr_t Object,
                                  unsigned Index);
 
+/// Describes the layouts of Count class or closure context instances at
+/// once, storing the layout of Objects[i] in OutInfos[i].
+///
+/// The offsets of the strong references an instance holds, including those
+/// nested in its struct and tuple fields, are stored consecutively in
+/// OutReferenceOffsets, after those of the instances before it, and their
+/// number in OutNumReferences[i]. At most MaxReferenceOffsets offsets are
+/// stored. Objects whose layout cannot be determined get a layout of kind
+/// SWIFT_UNKNOWN and no references.
+///
+/// The metadata of the objects is only looked at once for each type, so
+/// this is much faster than calling swift_reflection_infoForInstance() and
+/// swift_reflection_childOfInstance() for each of the objects of a heap.
+///
+/// Returns the total number of offsets, which may be more than
+/// MaxReferenceOffsets.
+size_t
+swift_reflection_infoForInstances(SwiftReflectionContextRef ContextRef,
+                                  const uintptr_t *Objects,
+                                  size_t Count,
+                                  swift_typeinfo_t *OutInfos,
+                                  unsigned *OutNumReferences,
+                                  unsigned *OutReferenceOffsets,
+                                  size_t MaxReferenceOffsets);
+
 /// Returns the number of generic arguments of a typeref.
 unsigned
 swift_reflection_genericArgumentCountOfTypeRef(swift_typeref_t OpaqueTypeRef);
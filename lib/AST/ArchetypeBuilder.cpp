@@ -348,11 +348,7 @@ bool ArchetypeBuilder::PotentialArchetype::addConformance(
 
   // Check whether any associated types in this protocol resolve
   // nested types of this potential archetype.
-  for (auto member : proto->getMembers()) {
-    auto assocType = dyn_cast<AssociatedTypeDecl>(member);
-    if (!assocType)
-      continue;
-
+  for (auto assocType : proto->getAssociatedTypeMembers()) {
     auto known = NestedTypes.find(assocType->getName());
     if (known == NestedTypes.end())
       continue;
@@ -989,22 +985,17 @@ bool ArchetypeBuilder::addConformanceRequirement(PotentialArchetype *PAT,
   }
 
   // Add requirements for each of the associated types.
-  // FIXME: This should use the generic signature, not walk the members.
-  for (auto Member : Proto->getMembers()) {
-    if (auto AssocType = dyn_cast<AssociatedTypeDecl>(Member)) {
-      // Add requirements placed directly on this associated type.
-      auto AssocPA = T->getNestedType(AssocType->getName(), *this);
-      if (AssocPA != T) {
-        if (addAbstractTypeParamRequirements(AssocType, AssocPA,
-                                             RequirementSource::Protocol,
-                                             Visited))
-          return true;
-      }
-
-      continue;
+  // FIXME: This should use the generic signature.
+  // FIXME: Requirement declarations.
+  for (auto AssocType : Proto->getAssociatedTypeMembers()) {
+    // Add requirements placed directly on this associated type.
+    auto AssocPA = T->getNestedType(AssocType->getName(), *this);
+    if (AssocPA != T) {
+      if (addAbstractTypeParamRequirements(AssocType, AssocPA,
+                                           RequirementSource::Protocol,
+                                           Visited))
+        return true;
     }
-
-    // FIXME: Requirement declarations.
   }
   
   Visited.erase(Proto);
@@ -90,7 +90,8 @@ const clang::Module *ClangNode::getClangModule() const {
 // Only allow allocation of Decls using the allocator in ASTContext.
 void *Decl::operator new(size_t Bytes, const ASTContext &C,
                          unsigned Alignment) {
-  return C.Allocate(Bytes, Alignment);
+  return C.Allocate(Bytes, Alignment, AllocationArena::Permanent,
+                    AllocationCategory::Decl);
 }
 
 // Only allow allocation of Modules using the allocator in ASTContext.
@@ -1248,7 +1249,7 @@ bool AbstractStorageDecl::hasFixedLayout(ModuleDecl *M,
   case ResilienceExpansion::Minimal:
     return hasFixedLayout();
   case ResilienceExpansion::Maximal:
-    return hasFixedLayout() || M == getModuleContext();
+    return hasFixedLayout() || M->isInSameResilienceDomain(getModuleContext());
   }
   llvm_unreachable("bad resilience expansion");
 }
@@ -1851,7 +1852,7 @@ bool NominalTypeDecl::hasFixedLayout(ModuleDecl *M,
   case ResilienceExpansion::Minimal:
     return hasFixedLayout();
   case ResilienceExpansion::Maximal:
-    return hasFixedLayout() || M == getModuleContext();
+    return hasFixedLayout() || M->isInSameResilienceDomain(getModuleContext());
   }
   llvm_unreachable("bad resilience expansion");
 }
@@ -2483,6 +2484,7 @@ ProtocolDecl::ProtocolDecl(DeclContext *DC, SourceLoc ProtocolLoc,
     = static_cast<unsigned>(CircularityCheck::Unchecked);
   HasMissingRequirements = false;
   InheritedProtocolsSet = false;
+  AssociatedTypesValid = false;
 }
 
 ArrayRef<ProtocolDecl *>
@@ -2490,6 +2492,21 @@ ProtocolDecl::getInheritedProtocols(LazyResolver *resolver) const {
   return InheritedProtocols;
 }
 
+ArrayRef<AssociatedTypeDecl *> ProtocolDecl::getAssociatedTypeMembers() const {
+  if (AssociatedTypesValid)
+    return AssociatedTypes;
+
+  SmallVector<AssociatedTypeDecl *, 4> result;
+  for (auto member : getMembers()) {
+    if (auto assocType = dyn_cast<AssociatedTypeDecl>(member))
+      result.push_back(assocType);
+  }
+
+  AssociatedTypes = getASTContext().AllocateCopy(result);
+  AssociatedTypesValid = true;
+  return AssociatedTypes;
+}
+
 bool ProtocolDecl::inheritsFrom(const ProtocolDecl *super) const {
   if (this == super)
     return false;
@@ -681,6 +681,22 @@ void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
     }
   }
 
+  DiagnosticInfo Info;
+  Info.ID = diagnostic.getID();
+  Info.Ranges = diagnostic.getRanges();
+  Info.FixIts = diagnostic.getFixIts();
+  DiagnosticKind kind = toDiagnosticKind(behavior);
+
+  // Find the consumers which want the diagnostic before formatting its text,
+  // which is wasted on diagnostics nobody reports.
+  SmallVector<DiagnosticConsumer *, 4> interested;
+  for (auto &Consumer : Consumers) {
+    if (Consumer->wantsDiagnostic(SourceMgr, loc, kind, Info))
+      interested.push_back(Consumer);
+  }
+  if (interested.empty())
+    return;
+
   // Actually substitute the diagnostic arguments into the diagnostic text.
   llvm::SmallString<256> Text;
   {
@@ -689,14 +705,8 @@ void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
                          diagnostic.getArgs(), Out);
   }
 
-  // Pass the diagnostic off to the consumer.
-  DiagnosticInfo Info;
-  Info.ID = diagnostic.getID();
-  Info.Ranges = diagnostic.getRanges();
-  Info.FixIts = diagnostic.getFixIts();
-  for (auto &Consumer : Consumers) {
-    Consumer->handleDiagnostic(SourceMgr, loc, toDiagnosticKind(behavior), Text,
-                               Info);
-  }
+  // Pass the diagnostic off to the consumers.
+  for (auto *Consumer : interested)
+    Consumer->handleDiagnostic(SourceMgr, loc, kind, Text, Info);
 }
 
@@ -338,3 +338,45 @@ Optional<DocComment *> swift::getDocComment(swift::markup::MarkupContext &MC,
   auto Parts = extractCommentParts(MC, Doc);
   return new (MC) DocComment(D, Doc, Parts);
 }
+
+static bool isBlankLine(StringRef Text) {
+  return Text.find_first_not_of(" \t\v\f") == StringRef::npos;
+}
+
+/// Returns true if \p Text may be a link reference definition, which can
+/// change how the links of any paragraph are parsed.
+static bool mayBeLinkReferenceDefinition(StringRef Text) {
+  Text = Text.ltrim();
+  return Text.startswith("[") && Text.find("]:") != StringRef::npos;
+}
+
+const swift::markup::Paragraph *
+swift::getBriefDocComment(swift::markup::MarkupContext &MC, const Decl *D) {
+  auto RC = D->getRawComment();
+  if (RC.isEmpty())
+    return nullptr;
+
+  PrettyStackTraceDecl StackTrace("parsing brief comment for", D);
+
+  swift::markup::LineList LL = MC.getLineList(RC);
+  ArrayRef<swift::markup::Line> Lines = LL.getLines();
+
+  // A paragraph ends at a blank line, so the first one is within the lines
+  // up to the first blank line after the leading ones.
+  size_t End = 0;
+  while (End != Lines.size() && isBlankLine(Lines[End].Text))
+    ++End;
+  while (End != Lines.size() && !isBlankLine(Lines[End].Text))
+    ++End;
+  if (std::any_of(Lines.begin() + End, Lines.end(),
+                  [](const swift::markup::Line &L) {
+                    return mayBeLinkReferenceDefinition(L.Text);
+                  }))
+    End = Lines.size();
+
+  swift::markup::LineList FirstLines(MC.allocateCopy(Lines.slice(0, End)));
+  auto *Doc = swift::markup::parseDocument(MC, FirstLines);
+  if (!Doc || Doc->getChildren().empty())
+    return nullptr;
+  return dyn_cast<swift::markup::Paragraph>(Doc->getChildren().front());
+}
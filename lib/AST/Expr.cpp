@@ -37,7 +37,8 @@ using namespace swift;
 // Only allow allocation of Stmts using the allocator in ASTContext.
 void *Expr::operator new(size_t Bytes, ASTContext &C,
                          unsigned Alignment) {
-  return C.Allocate(Bytes, Alignment);
+  return C.Allocate(Bytes, Alignment, AllocationArena::Permanent,
+                    AllocationCategory::Expr);
 }
 
 StringRef Expr::getKindName(ExprKind K) {
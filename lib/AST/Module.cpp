@@ -356,6 +356,7 @@ void Module::addFile(FileUnit &newFile) {
          cast<SourceFile>(newFile).Kind == SourceFileKind::Library ||
          cast<SourceFile>(newFile).Kind == SourceFileKind::SIL);
   Files.push_back(&newFile);
+  bumpLookupGeneration();
 
   switch (newFile.getKind()) {
   case FileUnitKind::Source:
@@ -388,6 +389,7 @@ void Module::removeFile(FileUnit &existingFile) {
   // Adjust for the std::reverse_iterator offset.
   ++I;
   Files.erase(I.base());
+  bumpLookupGeneration();
 }
 
 DerivedFileUnit &Module::getDerivedFileUnit() const {
@@ -657,6 +659,45 @@ void SourceFile::getLocalTypeDecls(SmallVectorImpl<TypeDecl*> &Results) const {
   Results.append(LocalTypeDecls.begin(), LocalTypeDecls.end());
 }
 
+void Module::lookupConformancesTo(
+    ProtocolDecl *Protocol,
+    SmallVectorImpl<ProtocolConformance *> &Results) const {
+  FORWARD(lookupConformancesTo, (Protocol, Results));
+}
+
+/// Adds the conformances to \p Protocol which are declared by \p D, or by
+/// the nominal types nested in it, to \p Results.
+static void
+lookupConformancesInDecl(Decl *D, ProtocolDecl *Protocol,
+                         SmallVectorImpl<ProtocolConformance *> &Results) {
+  IterableDeclContext *IDC;
+  if (auto *Ext = dyn_cast<ExtensionDecl>(D))
+    IDC = Ext;
+  else if (auto *Nominal = dyn_cast<NominalTypeDecl>(D))
+    IDC = Nominal;
+  else
+    return;
+
+  // Protocols don't have conformances.
+  if (isa<ProtocolDecl>(D))
+    return;
+
+  for (auto *Conformance : cast<DeclContext>(D)->getLocalConformances()) {
+    if (Conformance->getProtocol() == Protocol)
+      Results.push_back(Conformance);
+  }
+
+  for (Decl *Member : IDC->getMembers())
+    lookupConformancesInDecl(Member, Protocol, Results);
+}
+
+void SourceFile::lookupConformancesTo(
+    ProtocolDecl *Protocol,
+    SmallVectorImpl<ProtocolConformance *> &Results) const {
+  for (Decl *D : Decls)
+    lookupConformancesInDecl(D, Protocol, Results);
+}
+
 void Module::getDisplayDecls(SmallVectorImpl<Decl*> &Results) const {
   // FIXME: Should this do extra access control filtering?
   FORWARD(getDisplayDecls, (Results));
@@ -1472,6 +1513,9 @@ bool SourceFile::hasTestableImport(const swift::Module *module) const {
 }
 
 void SourceFile::clearLookupCache() {
+  // Module-scope lookups from any file may have found the decls of this one.
+  getParentModule()->bumpLookupGeneration();
+
   if (!Cache)
     return;
 
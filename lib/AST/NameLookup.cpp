@@ -24,6 +24,7 @@
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/STLExtras.h"
+#include "swift/Basic/Statistic.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 
@@ -632,17 +633,58 @@ UnqualifiedLookup::UnqualifiedLookup(DeclName Name, DeclContext *DC,
 
   recordLookupOfTopLevelName(DC, Name, isCascadingUse.getValue());
 
-  // Add private imports to the extra search list.
-  SmallVector<Module::ImportedModule, 8> extraImports;
-  if (auto FU = dyn_cast<FileUnit>(DC))
-    FU->getImportedModules(extraImports, Module::ImportFilter::Private);
-
-  using namespace namelookup;
+  // The same names are looked up at module scope over and over again from
+  // the same file, and finding them means walking all of the imports. Reuse
+  // the results as long as the module and the set of loaded modules haven't
+  // changed. Without a resolver, the results depend on which decls happen
+  // to have been validated already, so don't cache those.
+  auto *Stats = Ctx.Stats;
+  auto *cachingSF = TypeResolver ? dyn_cast<SourceFile>(DC) : nullptr;
+  if (DebugClient)
+    cachingSF = nullptr;
+  std::pair<unsigned, unsigned> generation(M.getLookupGeneration(),
+                                           Ctx.getCurrentGeneration());
+  std::pair<DeclName, unsigned> cacheKey(Name, IsTypeLookup);
   SmallVector<ValueDecl *, 8> CurModuleResults;
-  auto resolutionKind =
-    IsTypeLookup ? ResolutionKind::TypesOnly : ResolutionKind::Overloadable;
-  lookupInModule(&M, {}, Name, CurModuleResults, NLKind::UnqualifiedLookup,
-                 resolutionKind, TypeResolver, DC, extraImports);
+  bool foundInCache = false;
+  if (cachingSF) {
+    if (cachingSF->ModuleScopeLookupsGeneration != generation) {
+      cachingSF->ModuleScopeLookups.clear();
+      cachingSF->ModuleScopeLookupsGeneration = generation;
+    }
+
+    auto known = cachingSF->ModuleScopeLookups.find(cacheKey);
+    if (known != cachingSF->ModuleScopeLookups.end()) {
+      if (Stats)
+        Stats->getFrontendCounters().NumModuleScopeLookupCacheHits++;
+      CurModuleResults.append(known->second.begin(), known->second.end());
+      foundInCache = true;
+    }
+  }
+
+  if (!foundInCache) {
+    // Add private imports to the extra search list.
+    SmallVector<Module::ImportedModule, 8> extraImports;
+    if (auto FU = dyn_cast<FileUnit>(DC))
+      FU->getImportedModules(extraImports, Module::ImportFilter::Private);
+
+    using namespace namelookup;
+    auto resolutionKind =
+      IsTypeLookup ? ResolutionKind::TypesOnly : ResolutionKind::Overloadable;
+    if (Stats)
+      Stats->getFrontendCounters().NumModuleScopeLookups++;
+    lookupInModule(&M, {}, Name, CurModuleResults, NLKind::UnqualifiedLookup,
+                   resolutionKind, TypeResolver, DC, extraImports);
+
+    // Only cache the results if the lookup itself didn't load new modules or
+    // otherwise invalidate them.
+    if (cachingSF &&
+        generation == std::make_pair(M.getLookupGeneration(),
+                                     Ctx.getCurrentGeneration())) {
+      cachingSF->ModuleScopeLookups[cacheKey] =
+        TinyPtrVector<ValueDecl *>(CurModuleResults);
+    }
+  }
 
   for (auto VD : CurModuleResults)
     Results.push_back(UnqualifiedLookupResult(VD));
@@ -922,8 +964,58 @@ void NominalTypeDecl::makeMemberVisible(ValueDecl *member) {
   LookupTable.getPointer()->addMember(member);
 }
 
+/// Adds the members of \p IDC named \p name to \p table. If \p IDC has not
+/// loaded its members yet, only the members with that name are loaded.
+///
+/// Returns true if the members could not be loaded by name.
+static bool addNamedMembers(MemberLookupTable &table,
+                            const IterableDeclContext *IDC, Identifier name) {
+  if (!IDC->isLazy()) {
+    table.addMembers(IDC->getMembers());
+    return false;
+  }
+
+  SmallVector<ValueDecl *, 4> members;
+  if (IDC->getLoader()->loadNamedMembers(IDC, name,
+                                         IDC->getLoaderContextData(),
+                                         members)) {
+    return true;
+  }
+  for (auto member : members)
+    table.addMember(member);
+  return false;
+}
+
 ArrayRef<ValueDecl *> NominalTypeDecl::lookupDirect(DeclName name,
                                                     bool ignoreNewExtensions) {
+  // If the members of this type haven't been loaded yet, try to load just the
+  // ones with this name, from this nominal and from all extensions.
+  if (getASTContext().LangOpts.NamedLazyMemberLoading &&
+      !ignoreNewExtensions && isLazy()) {
+    if (!LookupTable.getPointer()) {
+      auto &ctx = getASTContext();
+      LookupTable.setPointer(new (ctx) MemberLookupTable(ctx));
+    }
+    auto &table = *LookupTable.getPointer();
+
+    bool loadedByName = !addNamedMembers(table, this, name.getBaseName());
+    if (loadedByName) {
+      for (auto E : getExtensions()) {
+        if (addNamedMembers(table, E, name.getBaseName())) {
+          loadedByName = false;
+          break;
+        }
+      }
+    }
+
+    if (loadedByName) {
+      auto known = table.find(name);
+      if (known == table.end())
+        return { };
+      return { known->second.begin(), known->second.size() };
+    }
+  }
+
   // Make sure we have the complete list of members (in this nominal and in all
   // extensions).
   if (!ignoreNewExtensions) {
@@ -302,7 +302,8 @@ case PatternKind::ID: foundRefutablePattern = true; break;
 
 /// Standard allocator for Patterns.
 void *Pattern::operator new(size_t numBytes, const ASTContext &C) {
-  return C.Allocate(numBytes, alignof(Pattern));
+  return C.Allocate(numBytes, alignof(Pattern), AllocationArena::Permanent,
+                    AllocationCategory::Pattern);
 }
 
 /// Find the name directly bound by this pattern.  When used as a
@@ -76,7 +76,8 @@ ProtocolConformanceRef::getInherited(ProtocolDecl *parent) const {
 void *ProtocolConformance::operator new(size_t bytes, ASTContext &context,
                                         AllocationArena arena,
                                         unsigned alignment) {
-  return context.Allocate(bytes, alignment, arena);
+  return context.Allocate(bytes, alignment, arena,
+                          AllocationCategory::Conformance);
 
 }
 
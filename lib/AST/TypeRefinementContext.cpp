@@ -21,6 +21,7 @@
 #include "swift/AST/Expr.h"
 #include "swift/AST/TypeRefinementContext.h"
 #include "swift/Basic/SourceManager.h"
+#include <algorithm>
 
 using namespace swift;
 
@@ -145,17 +146,46 @@ TypeRefinementContext::findMostRefinedSubContext(SourceLoc Loc,
   if (SrcRange.isValid() && !SM.rangeContainsTokenLoc(SrcRange, Loc))
     return nullptr;
 
-  // For the moment, we perform a linear search here, but we can and should
-  // do something more efficient.
-  for (TypeRefinementContext *Child : Children) {
-    if (auto *Found = Child->findMostRefinedSubContext(Loc, SM)) {
-      return Found;
-    }
-  }
+  // The ranges of the contexts nest, so if the context found last contains
+  // Loc, the inner-most context is that one or one of its descendants.
+  TypeRefinementContext *Current = this;
+  if (LastFound && LastFound != this &&
+      SM.rangeContainsTokenLoc(LastFound->SrcRange, Loc))
+    Current = LastFound;
 
-  // Loc is in this context's range but not in any child's, so this context
+  // Once Loc is in a context's range but not in any child's, that context
   // must be the inner-most context.
-  return this;
+  while (TypeRefinementContext *Child = Current->findChildContaining(Loc, SM))
+    Current = Child;
+
+  LastFound = Current;
+  return Current;
+}
+
+TypeRefinementContext *
+TypeRefinementContext::findChildContaining(SourceLoc Loc, SourceManager &SM) {
+  if (Children.empty())
+    return nullptr;
+
+  if (!ChildrenSorted) {
+    std::sort(Children.begin(), Children.end(),
+              [&](TypeRefinementContext *LHS, TypeRefinementContext *RHS) {
+      return SM.isBeforeInBuffer(LHS->SrcRange.Start, RHS->SrcRange.Start);
+    });
+    ChildrenSorted = true;
+  }
+
+  // Only the last child starting at or before Loc can contain it.
+  auto Next = std::upper_bound(Children.begin(), Children.end(), Loc,
+                               [&](SourceLoc L, TypeRefinementContext *C) {
+    return SM.isBeforeInBuffer(L, C->SrcRange.Start);
+  });
+  if (Next == Children.begin())
+    return nullptr;
+  TypeRefinementContext *Child = *std::prev(Next);
+  if (!SM.rangeContainsTokenLoc(Child->SrcRange, Loc))
+    return nullptr;
+  return Child;
 }
 
 void TypeRefinementContext::dump(SourceManager &SrcMgr) const {
@@ -14,12 +14,17 @@
 #include "Darwin/Cache-Mac.cpp"
 #else
 
-//  This file implements a default caching implementation that never evicts
-//  its entries.
+//  This file implements a default caching implementation, which evicts the
+//  least recently used values when their total cost exceeds a limit, or when
+//  the process is close to the memory limit of its cgroup.
 
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Mutex.h"
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <tuple>
 
 using namespace swift::sys;
 using llvm::StringRef;
@@ -33,12 +38,74 @@ struct DefaultCacheKey {
   DefaultCacheKey(void *Key, CacheImpl::CallBacks *CBs) : Key(Key), CBs(CBs) {}
 };
 
+struct DefaultCacheEntry {
+  void *Key;
+  void *Value;
+  size_t Cost;
+};
+
+/// The retains of a value, and the number of entries holding the value
+/// which left the cache while it was retained. Each of those entries
+/// destroys the value once it is released.
+struct DefaultCacheValueState {
+  unsigned RetainCount = 0;
+  unsigned PendingDestroys = 0;
+};
+
 struct DefaultCache {
+  using EntryList = std::list<DefaultCacheEntry>;
+
   llvm::sys::Mutex Mux;
   CacheImpl::CallBacks CBs;
-  llvm::DenseMap<DefaultCacheKey, void *> Entries;
+  /// The entries, the most recently used first.
+  EntryList LRU;
+  llvm::DenseMap<DefaultCacheKey, EntryList::iterator> Entries;
+  llvm::DenseMap<void *, DefaultCacheValueState> RetainedValues;
+  size_t CostLimit;
+  CacheImpl::Statistics Stats;
+
+  DefaultCache(CacheImpl::CallBacks CBs, size_t CostLimit)
+    : CBs(std::move(CBs)), CostLimit(CostLimit) { }
+
+  void retain(void *Value) {
+    ++RetainedValues[Value].RetainCount;
+  }
+
+  bool isRetained(void *Value) const {
+    auto State = RetainedValues.find(Value);
+    return State != RetainedValues.end() && State->second.RetainCount != 0;
+  }
 
-  explicit DefaultCache(CacheImpl::CallBacks CBs) : CBs(std::move(CBs)) { }
+  /// Removes \p Entry, destroying its key now and its value once the value
+  /// is no longer retained.
+  void removeEntry(llvm::DenseMap<DefaultCacheKey,
+                                  EntryList::iterator>::iterator Entry) {
+    auto Node = Entry->second;
+    Entries.erase(Entry);
+    Stats.TotalCost -= Node->Cost;
+    CBs.keyDestroyCB(Node->Key, nullptr);
+    if (isRetained(Node->Value))
+      ++RetainedValues[Node->Value].PendingDestroys;
+    else
+      CBs.valueDestroyCB(Node->Value, nullptr);
+    LRU.erase(Node);
+  }
+
+  /// Evicts the least recently used values which are not retained, until
+  /// the total cost is at most \p TargetCost.
+  void evictDownTo(size_t TargetCost) {
+    auto Node = LRU.end();
+    while (Stats.TotalCost > TargetCost && Node != LRU.begin()) {
+      --Node;
+      if (isRetained(Node->Value))
+        continue;
+      auto Victim = Node++;
+      removeEntry(Entries.find(DefaultCacheKey(Victim->Key, &CBs)));
+      ++Stats.Evictions;
+    }
+  }
+
+  void evictIfNeeded();
 };
 } // end anonymous namespace
 
@@ -67,8 +134,53 @@ template<> struct DenseMapInfo<DefaultCacheKey> {
 };
 }
 
+/// Reads the number in the file at \p Path, which is "max" for cgroup
+/// limits without a bound. Returns 0 if there is no such number.
+static size_t readCgroupValue(const char *Path) {
+  FILE *File = fopen(Path, "r");
+  if (!File)
+    return 0;
+  unsigned long long Value = 0;
+  if (fscanf(File, "%llu", &Value) != 1)
+    Value = 0;
+  fclose(File);
+  // cgroup v1 reports an unbounded limit as a huge number.
+  if (Value >= (1ULL << 60))
+    return 0;
+  return size_t(Value);
+}
+
+/// Returns the memory limit of the process's cgroup and its current memory
+/// usage, or zeros if there is no limit.
+static std::pair<size_t, size_t> getCgroupMemory() {
+#if defined(__linux__)
+  if (size_t Limit = readCgroupValue("/sys/fs/cgroup/memory.max"))
+    return { Limit, readCgroupValue("/sys/fs/cgroup/memory.current") };
+  if (size_t Limit =
+        readCgroupValue("/sys/fs/cgroup/memory/memory.limit_in_bytes"))
+    return { Limit,
+             readCgroupValue("/sys/fs/cgroup/memory/memory.usage_in_bytes") };
+#endif
+  return { 0, 0 };
+}
+
+void DefaultCache::evictIfNeeded() {
+  if (Stats.TotalCost > CostLimit)
+    evictDownTo(CostLimit);
+
+  // Give back memory when the whole process is about to run out of it,
+  // whatever the caches cost.
+  size_t MemoryLimit, MemoryUsage;
+  std::tie(MemoryLimit, MemoryUsage) = getCgroupMemory();
+  if (MemoryLimit != 0 && MemoryUsage > MemoryLimit / 10 * 9)
+    evictDownTo(Stats.TotalCost / 2);
+}
+
 CacheImpl::ImplTy CacheImpl::create(StringRef Name, const CallBacks &CBs) {
-  return new DefaultCache(CBs);
+  size_t CostLimit = getCgroupMemory().first / 4;
+  if (CostLimit == 0)
+    CostLimit = SIZE_MAX;
+  return new DefaultCache(CBs, CostLimit);
 }
 
 void CacheImpl::setAndRetain(void *Key, void *Value, size_t Cost) {
@@ -77,16 +189,14 @@ void CacheImpl::setAndRetain(void *Key, void *Value, size_t Cost) {
 
   DefaultCacheKey CKey(Key, &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-  }
-
-  DCache.Entries[CKey] = Value;
+  if (Entry != DCache.Entries.end())
+    DCache.removeEntry(Entry);
 
-  // FIXME: Not thread-safe! It should avoid deleting the value until
-  // 'releaseValue is called on it.
+  DCache.LRU.push_front({ Key, Value, Cost });
+  DCache.Entries[CKey] = DCache.LRU.begin();
+  DCache.Stats.TotalCost += Cost;
+  DCache.retain(Value);
+  DCache.evictIfNeeded();
 }
 
 bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
@@ -95,17 +205,33 @@ bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
 
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    // FIXME: Not thread-safe! It should avoid deleting the value until
-    // 'releaseValue is called on it.
-    *Value_out = Entry->second;
-    return true;
+  if (Entry == DCache.Entries.end()) {
+    ++DCache.Stats.Misses;
+    return false;
   }
-  return false;
+
+  ++DCache.Stats.Hits;
+  auto Node = Entry->second;
+  DCache.LRU.splice(DCache.LRU.begin(), DCache.LRU, Node);
+  DCache.retain(Node->Value);
+  *Value_out = Node->Value;
+  return true;
 }
 
 void CacheImpl::releaseValue(void *Value) {
-  // FIXME: Implementation.
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+
+  auto State = DCache.RetainedValues.find(Value);
+  assert(State != DCache.RetainedValues.end() &&
+         State->second.RetainCount != 0 && "value is not retained");
+  if (--State->second.RetainCount != 0)
+    return;
+
+  unsigned PendingDestroys = State->second.PendingDestroys;
+  DCache.RetainedValues.erase(State);
+  while (PendingDestroys--)
+    DCache.CBs.valueDestroyCB(Value, nullptr);
 }
 
 bool CacheImpl::remove(const void *Key) {
@@ -114,24 +240,32 @@ bool CacheImpl::remove(const void *Key) {
 
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-    return true;
-  }
-  return false;
+  if (Entry == DCache.Entries.end())
+    return false;
+  DCache.removeEntry(Entry);
+  return true;
 }
 
 void CacheImpl::removeAll() {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
   llvm::sys::ScopedLock L(DCache.Mux);
 
-  for (auto Entry : DCache.Entries) {
-    DCache.CBs.keyDestroyCB(Entry.first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry.second, nullptr);
-  }
-  DCache.Entries.clear();
+  while (!DCache.Entries.empty())
+    DCache.removeEntry(DCache.Entries.begin());
+}
+
+void CacheImpl::setCostLimit(size_t Limit) {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+
+  DCache.CostLimit = Limit;
+  DCache.evictIfNeeded();
+}
+
+CacheImpl::Statistics CacheImpl::getStatistics() {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+  return DCache.Stats;
 }
 
 void CacheImpl::destroy() {
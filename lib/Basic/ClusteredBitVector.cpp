@@ -22,15 +22,23 @@
 using namespace swift;
 
 ClusteredBitVector ClusteredBitVector::fromAPInt(const llvm::APInt &bits) {
-  // This is not a very efficient algorithm.
   ClusteredBitVector result;
-  for (unsigned i = 0, e = bits.getBitWidth(); i != e; ++i) {
-    if (bits[i]) {
-      result.appendSetBits(1);
-    } else {
-      result.appendClearBits(1);
-    }
+  size_t numBits = bits.getBitWidth();
+  if (numBits == 0)
+    return result;
+
+  if (!bits) {
+    result.appendClearBits(numBits);
+    return result;
   }
+
+  // Copy the words of the APInt as whole chunks. This assumes that the chunk
+  // size is the same as APInt's, like asAPInt does; APInt keeps the unused
+  // bits of its last word clear, as the chunks do.
+  static_assert(sizeof(ChunkType) == sizeof(uint64_t),
+                "chunk size doesn't match APInt's word size");
+  result.reserveExtra(numBits);
+  result.appendReserved(numBits, bits.getRawData());
   return result;
 }
 
@@ -65,6 +65,14 @@ void CacheImpl::removeAll() {
   cache_remove_all(static_cast<cache_t*>(Impl));
 }
 
+void CacheImpl::setCostLimit(size_t Limit) {
+  // libcache evicts values under memory pressure by itself.
+}
+
+CacheImpl::Statistics CacheImpl::getStatistics() {
+  return Statistics();
+}
+
 void CacheImpl::destroy() {
   cache_destroy(static_cast<cache_t*>(Impl));
 }
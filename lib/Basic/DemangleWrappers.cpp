@@ -44,15 +44,15 @@ static void printNode(llvm::raw_ostream &Out, const Node *node,
     Out << ", index=" << node->getIndex();
   }
   Out << '\n';
-  for (auto &child : *node) {
-    printNode(Out, child.get(), depth + 1);
+  for (auto child : *node) {
+    printNode(Out, child, depth + 1);
   }
 }
 
 void NodeDumper::dump() const { print(llvm::errs()); }
 
 void NodeDumper::print(llvm::raw_ostream &Out) const {
-  printNode(Out, Root.get(), 0);
+  printNode(Out, Root, 0);
 }
 
 namespace {
@@ -77,16 +77,18 @@ public:
 
 NodePointer
 swift::demangle_wrappers::demangleSymbolAsNode(llvm::StringRef MangledName,
+                                               NodeFactory &Factory,
                                                const DemangleOptions &Options) {
   PrettyStackTraceStringAction prettyStackTrace("demangling string",
                                                 MangledName);
   return swift::Demangle::demangleSymbolAsNode(MangledName.data(),
-                                               MangledName.size(), Options);
+                                               MangledName.size(), Factory,
+                                               Options);
 }
 
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options) {
-  PrettyStackTraceNode trace("printing", Root.get());
+  PrettyStackTraceNode trace("printing", Root);
   return swift::Demangle::nodeToString(Root, Options);
 }
 
@@ -11,8 +11,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/FileSystem.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 
@@ -88,3 +91,35 @@ std::error_code swift::moveFileIfDifferent(const llvm::Twine &source,
   // If we get here, we weren't able to prove that the files are the same.
   return fs::rename(source, destination);
 }
+
+std::error_code swift::copyFileAtomically(const llvm::Twine &source,
+                                          const llvm::Twine &destination) {
+  namespace fs = llvm::sys::fs;
+
+  auto buffer = llvm::MemoryBuffer::getFile(source);
+  if (!buffer)
+    return buffer.getError();
+
+  int FD;
+  llvm::SmallString<128> tempPath;
+  if (std::error_code error =
+        fs::createUniqueFile(destination + "-%%%%%%%%", FD, tempPath))
+    return error;
+
+  {
+    llvm::raw_fd_ostream out(FD, /*shouldClose=*/true);
+    out << buffer.get()->getBuffer();
+    out.close();
+    if (out.has_error()) {
+      out.clear_error();
+      fs::remove(tempPath);
+      return std::make_error_code(std::errc::io_error);
+    }
+  }
+
+  if (std::error_code error = fs::rename(tempPath, destination)) {
+    fs::remove(tempPath);
+    return error;
+  }
+  return std::error_code();
+}
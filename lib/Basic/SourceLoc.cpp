@@ -15,6 +15,8 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
 
 using namespace swift;
 
@@ -281,35 +283,61 @@ void CharSourceRange::dump(const SourceManager &SM) const {
   print(llvm::errs(), SM);
 }
 
+const std::vector<unsigned> &
+SourceManager::getLineStarts(unsigned BufferID) const {
+  auto &Starts = LineStarts[BufferID];
+  if (!Starts.empty())
+    return Starts;
+
+  // memchr skips over the text of the lines many bytes at a time.
+  StringRef Buffer = LLVMSourceMgr.getMemoryBuffer(BufferID)->getBuffer();
+  const char *Begin = Buffer.begin();
+  const char *End = Buffer.end();
+  Starts.push_back(0);
+  for (const char *Ptr = Begin;
+       (Ptr = static_cast<const char *>(memchr(Ptr, '\n', End - Ptr)));) {
+    ++Ptr;
+    Starts.push_back(Ptr - Begin);
+  }
+  return Starts;
+}
+
+std::pair<unsigned, unsigned>
+SourceManager::getRealLineAndColumn(SourceLoc Loc, unsigned BufferID) const {
+  if (BufferID == 0)
+    BufferID = findBufferContainingLoc(Loc);
+  auto &Starts = getLineStarts(BufferID);
+  unsigned Offset = getLocOffsetInBuffer(Loc, BufferID);
+
+  // The first line starts at offset 0, so there is always a line starting
+  // at or before the offset.
+  auto NextLine = std::upper_bound(Starts.begin(), Starts.end(), Offset);
+  unsigned Line = NextLine - Starts.begin();
+  unsigned LineStart = Starts[Line - 1];
+
+  // Like llvm::SourceMgr, count the column from a carriage return, too.
+  StringRef Buffer = LLVMSourceMgr.getMemoryBuffer(BufferID)->getBuffer();
+  StringRef LineText = Buffer.slice(LineStart, Offset);
+  size_t CarriageReturn = LineText.rfind('\r');
+  if (CarriageReturn != StringRef::npos)
+    return { Line, LineText.size() - CarriageReturn };
+  return { Line, LineText.size() + 1 };
+}
+
 llvm::Optional<unsigned> SourceManager::resolveFromLineCol(unsigned BufferId,
                                                            unsigned Line,
                                                            unsigned Col) const {
   if (Line == 0 || Col == 0) {
     return None;
   }
-  auto InputBuf = getLLVMSourceMgr().getMemoryBuffer(BufferId);
-  const char *Ptr = InputBuf->getBufferStart();
-  const char *End = InputBuf->getBufferEnd();
-  const char *LineStart = Ptr;
-  for (; Ptr < End; ++Ptr) {
-    if (*Ptr == '\n') {
-      --Line;
-      if (Line == 0)
-        break;
-      LineStart = Ptr+1;
-    }
-  }
-  if (Line != 0) {
+
+  // Only lines ending with a newline can be resolved. The column may point
+  // at the newline itself.
+  auto &Starts = getLineStarts(BufferId);
+  if (Line >= Starts.size())
     return None;
-  }
-  Ptr = LineStart;
-  for (; Ptr < End; ++Ptr) {
-    --Col;
-    if (Col == 0)
-      return Ptr - InputBuf->getBufferStart();
-    if (*Ptr == '\n')
-      break;
-  }
-  return None;
+  if (Col - 1 >= Starts[Line] - Starts[Line - 1])
+    return None;
+  return Starts[Line - 1] + Col - 1;
 }
 
@@ -0,0 +1,313 @@
+//===--- Statistic.cpp - Per-job compilation statistics -------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Statistic.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+
+using namespace swift;
+
+/// Replace characters which would be awkward in a file name.
+static std::string cleanName(StringRef Name) {
+  std::string Result;
+  for (char C : Name) {
+    if (isalnum(C) || C == '-' || C == '_' || C == '.')
+      Result += C;
+    else
+      Result += '_';
+  }
+  return Result;
+}
+
+UnifiedStatsReporter::UnifiedStatsReporter(StringRef ProgramName,
+                                           StringRef AuxName,
+                                           StringRef Directory)
+  : ProcessName((ProgramName + " " + AuxName).str()) {
+  // Several jobs of the same build may have the same names, so make the file
+  // name unique with the time and the process ID.
+  auto Now = std::chrono::system_clock::now().time_since_epoch();
+  auto Nanoseconds =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(Now).count();
+
+  SmallString<128> Suffix;
+  llvm::raw_svector_ostream SuffixOS(Suffix);
+  SuffixOS << Nanoseconds << "-" << cleanName(ProgramName) << "-"
+           << cleanName(AuxName) << "-" << llvm::sys::Process::getProcessId()
+           << ".json";
+
+  Filename = Directory;
+  llvm::sys::path::append(Filename, "stats-" + SuffixOS.str());
+  ExpressionsFilename = Directory;
+  llvm::sys::path::append(ExpressionsFilename, "expressions-" + SuffixOS.str());
+  SILPassFunctionsFilename = Directory;
+  llvm::sys::path::append(SILPassFunctionsFilename,
+                          "sil-pass-functions-" + SuffixOS.str());
+  TraceFilename = Directory;
+  llvm::sys::path::append(TraceFilename, "trace-" + SuffixOS.str());
+
+  if (std::error_code EC = llvm::sys::fs::create_directories(Directory)) {
+    llvm::errs() << "Error creating -stats-output-dir directory '"
+                 << Directory << "': " << EC.message() << "\n";
+  }
+}
+
+/// Open \p Filename for writing, reporting an error if that fails.
+static std::unique_ptr<llvm::raw_fd_ostream> openStatsFile(StringRef Filename) {
+  std::error_code EC;
+  std::unique_ptr<llvm::raw_fd_ostream> OS(
+      new llvm::raw_fd_ostream(Filename, EC, llvm::sys::fs::F_Text));
+  if (EC) {
+    llvm::errs() << "Error opening -stats-output-dir file '" << Filename
+                 << "' for writing: " << EC.message() << "\n";
+    return nullptr;
+  }
+  return OS;
+}
+
+UnifiedStatsReporter::~UnifiedStatsReporter() {
+  if (auto OS = openStatsFile(Filename))
+    printJSON(*OS);
+
+  if (!ExpressionProfiles.empty()) {
+    if (auto OS = openStatsFile(ExpressionsFilename))
+      printExpressionProfilesJSON(*OS);
+  }
+
+  if (!SILPassFunctionProfiles.empty()) {
+    if (auto OS = openStatsFile(SILPassFunctionsFilename))
+      printSILPassFunctionsJSON(*OS);
+  }
+
+  if (TraceEvents) {
+    if (auto OS = openStatsFile(TraceFilename))
+      TraceEvents->print(*OS);
+  }
+}
+
+void UnifiedStatsReporter::enableTraceEvents() {
+  if (!TraceEvents)
+    TraceEvents.reset(new TraceEventRecorder(ProcessName));
+}
+
+void UnifiedStatsReporter::recordTime(StringRef Name,
+                                      const llvm::TimeRecord &Time) {
+  llvm::sys::ScopedLock Lock(TimersLock);
+  Timers[Name] += Time;
+}
+
+void UnifiedStatsReporter::recordSILPassRun(StringRef Pass,
+                                            StringRef Function,
+                                            const SILPassProfile &Run) {
+  llvm::sys::ScopedLock Lock(SILPassProfilesLock);
+  SILPassProfiles[Pass] += Run;
+  if (!Function.empty())
+    SILPassFunctionProfiles[{Pass.str(), Function.str()}] += Run;
+}
+
+/// Print the members of \p Profile as JSON object members, each preceded by
+/// \p Delim, naming them "<Prefix>runs", "<Prefix>wall" etc.
+static void printSILPassProfile(
+    raw_ostream &OS, const char *Delim, StringRef Prefix,
+    const UnifiedStatsReporter::SILPassProfile &Profile) {
+  OS << Delim << Prefix << "runs\": " << Profile.Runs;
+  OS << Delim << Prefix << "wall\": " << Profile.WallTime;
+  OS << Delim << Prefix << "instructions-added\": "
+     << Profile.InstructionsAdded;
+  OS << Delim << Prefix << "instructions-removed\": "
+     << Profile.InstructionsRemoved;
+  OS << Delim << Prefix << "invalidations\": " << Profile.Invalidations;
+  OS << Delim << Prefix << "peak-instruction-bytes-growth\": "
+     << Profile.PeakInstructionBytesGrowth;
+}
+
+void UnifiedStatsReporter::printJSON(raw_ostream &OS) {
+  OS << "{\n";
+  const char *Delim = "";
+
+  if (DriverCounters) {
+#define DRIVER_STATISTIC(Name)                                                 \
+    OS << Delim << "\t\"Driver." #Name "\": " << DriverCounters->Name;         \
+    Delim = ",\n";
+#include "swift/Basic/Statistics.def"
+  } else {
+#define FRONTEND_STATISTIC(Group, Name)                                        \
+    OS << Delim << "\t\"" #Group "." #Name "\": " << FrontendCounters.Name;    \
+    Delim = ",\n";
+#include "swift/Basic/Statistics.def"
+  }
+
+  // Print the timers sorted by name, so that the output is deterministic.
+  llvm::sys::ScopedLock Lock(TimersLock);
+  std::vector<StringRef> TimerNames;
+  for (auto &Entry : Timers)
+    TimerNames.push_back(Entry.getKey());
+  llvm::array_pod_sort(TimerNames.begin(), TimerNames.end());
+
+  for (StringRef Name : TimerNames) {
+    const llvm::TimeRecord &Time = Timers[Name];
+    OS << Delim << "\t\"time.swift." << Name << ".wall\": "
+       << Time.getWallTime();
+    Delim = ",\n";
+    OS << Delim << "\t\"time.swift." << Name << ".user\": "
+       << Time.getUserTime();
+    OS << Delim << "\t\"time.swift." << Name << ".sys\": "
+       << Time.getSystemTime();
+  }
+
+  llvm::sys::ScopedLock PassLock(SILPassProfilesLock);
+  std::vector<StringRef> PassNames;
+  for (auto &Entry : SILPassProfiles)
+    PassNames.push_back(Entry.getKey());
+  llvm::array_pod_sort(PassNames.begin(), PassNames.end());
+
+  for (StringRef Name : PassNames) {
+    printSILPassProfile(OS, Delim, ("\t\"sil-pass." + Name + ".").str(),
+                        SILPassProfiles[Name]);
+    Delim = ",\n";
+  }
+  OS << "\n}\n";
+}
+
+/// Print \p Str as a JSON string literal.
+static void printJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (char C : Str) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (static_cast<unsigned char>(C) < 0x20)
+      OS << llvm::format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+int64_t TraceEventRecorder::now() {
+  auto Now = std::chrono::system_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::microseconds>(Now).count();
+}
+
+unsigned TraceEventRecorder::getCurrentThread() {
+  llvm::sys::ScopedLock Guard(Lock);
+  return Threads.insert({std::this_thread::get_id(), (unsigned)Threads.size()})
+      .first->second;
+}
+
+void TraceEventRecorder::recordEvent(StringRef Category, StringRef Name,
+                                     StringRef Detail, int64_t Start,
+                                     int64_t End, unsigned Thread) {
+  llvm::sys::ScopedLock Guard(Lock);
+  Events.push_back({Category, Name, Detail, Start, End - Start, Thread});
+}
+
+void TraceEventRecorder::print(raw_ostream &OS) {
+  printMerged(OS, {});
+}
+
+void TraceEventRecorder::printMerged(raw_ostream &OS,
+                                     ArrayRef<std::string> Paths) {
+  llvm::sys::ScopedLock Guard(Lock);
+  auto Pid = llvm::sys::Process::getProcessId();
+
+  OS << "[\n";
+  OS << "\t{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << Pid
+     << ", \"args\": {\"name\": ";
+  printJSONString(OS, ProcessName);
+  OS << "}}";
+
+  for (auto &E : Events) {
+    OS << ",\n\t{\"cat\": ";
+    printJSONString(OS, E.Category);
+    OS << ", \"name\": ";
+    printJSONString(OS, E.Name);
+    OS << ", \"ph\": \"X\", \"ts\": " << E.Start << ", \"dur\": " << E.Duration
+       << ", \"pid\": " << Pid << ", \"tid\": " << E.Thread;
+    if (!E.Detail.empty()) {
+      OS << ", \"args\": {\"detail\": ";
+      printJSONString(OS, E.Detail);
+      OS << "}";
+    }
+    OS << "}";
+  }
+
+  // The other files are JSON arrays of the same form, so their elements can
+  // be spliced in.
+  for (auto &Path : Paths) {
+    auto Buffer = llvm::MemoryBuffer::getFile(Path);
+    if (!Buffer)
+      continue;
+    StringRef Contents = (*Buffer)->getBuffer().trim();
+    if (!Contents.startswith("[") || !Contents.endswith("]"))
+      continue;
+    Contents = Contents.drop_front().drop_back().trim();
+    if (!Contents.empty())
+      OS << ",\n\t" << Contents;
+  }
+  OS << "\n]\n";
+}
+
+StatsTraceScope::StatsTraceScope(UnifiedStatsReporter *Stats,
+                                 StringRef Category, StringRef Name,
+                                 StringRef Detail) {
+  if (!Stats || !Stats->getTraceEvents())
+    return;
+  Recorder = Stats->getTraceEvents();
+  this->Category = Category;
+  this->Name = Name;
+  this->Detail = Detail;
+  Start = TraceEventRecorder::now();
+}
+
+StatsTraceScope::~StatsTraceScope() {
+  if (!Recorder)
+    return;
+  Recorder->recordEvent(Category, Name, Detail, Start,
+                        TraceEventRecorder::now(),
+                        Recorder->getCurrentThread());
+}
+
+void UnifiedStatsReporter::printSILPassFunctionsJSON(raw_ostream &OS) {
+  llvm::sys::ScopedLock Lock(SILPassProfilesLock);
+  OS << "[\n";
+  const char *Delim = "";
+  for (auto &Entry : SILPassFunctionProfiles) {
+    OS << Delim << "\t{\"pass\": ";
+    printJSONString(OS, Entry.first.first);
+    OS << ", \"function\": ";
+    printJSONString(OS, Entry.first.second);
+    printSILPassProfile(OS, ", ", "\"", Entry.second);
+    OS << "}";
+    Delim = ",\n";
+  }
+  OS << "\n]\n";
+}
+
+void UnifiedStatsReporter::printExpressionProfilesJSON(raw_ostream &OS) {
+  OS << "[\n";
+  const char *Delim = "";
+  for (auto &Profile : ExpressionProfiles) {
+    OS << Delim << "\t{\"range\": ";
+    printJSONString(OS, Profile.Range);
+    OS << ", \"time.ms\": " << Profile.Milliseconds;
+    for (auto &Counter : Profile.Counters)
+      OS << ", \"" << Counter.first << "\": " << Counter.second;
+    OS << "}";
+    Delim = ",\n";
+  }
+  OS << "\n]\n";
+}
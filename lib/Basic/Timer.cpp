@@ -11,7 +11,28 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/Timer.h"
+#include "swift/Basic/Statistic.h"
 
 using namespace swift;
 
 SharedTimer::State SharedTimer::CompilationTimersEnabled = State::Initial;
+UnifiedStatsReporter *SharedTimer::StatsReporter = nullptr;
+
+void SharedTimer::startReporting() {
+  if (Reporter->getTraceEvents())
+    TraceStartTime = TraceEventRecorder::now();
+  StartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+}
+
+SharedTimer::~SharedTimer() {
+  if (!Reporter)
+    return;
+
+  llvm::TimeRecord Elapsed = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+  Elapsed -= StartTime;
+  Reporter->recordTime(Name, Elapsed);
+
+  if (auto *Trace = Reporter->getTraceEvents())
+    Trace->recordEvent("phase", Name, StringRef(), TraceStartTime,
+                       TraceEventRecorder::now(), Trace->getCurrentThread());
+}
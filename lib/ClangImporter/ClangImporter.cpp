@@ -55,6 +55,7 @@
 #include "clang/Sema/Sema.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include <algorithm>
 #include <memory>
@@ -242,6 +243,23 @@ void ClangImporter::Implementation::addBridgeHeaderTopLevelDecls(
   BridgeHeaderTopLevelDecls.push_back(D);
 }
 
+void ClangImporter::Implementation::loadBridgingPCHContents() {
+  // The lookup table is extended with whatever is parsed after the PCH, so
+  // resolve all of its entries up front and stop consulting the reader.
+  BridgingHeaderLookupTable.deserializeAll();
+  BridgingHeaderLookupTable.setReader(nullptr);
+
+  // Module imports were recorded as declarations of the PCH itself.
+  for (auto *D : getClangASTContext().getTranslationUnitDecl()->decls()) {
+    if (!D->isFromASTFile() || D->getImportedOwningModule())
+      continue;
+    if (auto *importDecl = dyn_cast<clang::ImportDecl>(D)) {
+      BridgeHeaderTopLevelImports.push_back(importDecl);
+      PendingBridgingPCHImports.push_back(importDecl);
+    }
+  }
+}
+
 bool ClangImporter::Implementation::shouldIgnoreBridgeHeaderTopLevelDecl(
     clang::Decl *D) {
   // Ignore forward references;
@@ -545,6 +563,11 @@ addCommonInvocationArguments(std::vector<std::string> &invocationArgStrs,
   }
   invocationArgStrs.push_back("-iapinotes-modules");
   invocationArgStrs.push_back(searchPathOpts.RuntimeLibraryImportPath);
+
+  if (!importerOpts.PrecompiledBridgingHeader.empty()) {
+    invocationArgStrs.push_back("-include-pch");
+    invocationArgStrs.push_back(importerOpts.PrecompiledBridgingHeader);
+  }
 }
 
 std::unique_ptr<ClangImporter>
@@ -700,6 +723,9 @@ ClangImporter::create(ASTContext &ctx,
   for (auto path : searchPathOpts.ImportSearchPaths)
     importer->addSearchPath(path, /*isFramework*/false);
 
+  if (!importerOpts.PrecompiledBridgingHeader.empty())
+    importer->Impl.loadBridgingPCHContents();
+
   // FIXME: These decls are not being parsed correctly since (a) some of the
   // callbacks are still being added, and (b) the logic to parse them has
   // changed.
@@ -1021,6 +1047,16 @@ bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
       importLine, Implementation::bridgingHeaderBufferName)
   };
 
+  // If the header was precompiled, the #import doesn't enter it again, so
+  // export the modules it imports from here instead.
+  for (auto *importDecl : Impl.PendingBridgingPCHImports) {
+    Module *nativeImported =
+      Impl.finishLoadingClangModule(*this, importDecl->getImportedModule(),
+                                    /*adapter=*/true);
+    Impl.ImportedHeaderExports.push_back({ /*filter=*/{}, nativeImported });
+  }
+  Impl.PendingBridgingPCHImports.clear();
+
   return Impl.importHeader(adapter, header, diagLoc, trackParsedSymbols,
                            std::move(sourceBuffer));
 }
@@ -1072,6 +1108,109 @@ std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
   return result;
 }
 
+namespace {
+  /// Checks that none of the input files of a PCH is missing or has been
+  /// modified since the PCH was written.
+  class PCHInputFileChecker : public clang::ASTReaderListener {
+    clang::FileManager &FileMgr;
+    time_t PCHModTime;
+  public:
+    bool OutOfDate = false;
+
+    PCHInputFileChecker(clang::FileManager &fileMgr, time_t pchModTime)
+      : FileMgr(fileMgr), PCHModTime(pchModTime) {}
+
+    bool needsInputFileVisitation() override { return true; }
+    bool needsSystemInputFileVisitation() override { return true; }
+
+    bool visitInputFile(StringRef filename, bool isSystem,
+                        bool isOverridden, bool isExplicitModule) override {
+      // The buffer with the #import line only exists in memory.
+      if (isOverridden)
+        return true;
+      // Modification times only have a resolution of a second, so a file
+      // modified in the second the PCH was written counts as newer.
+      const clang::FileEntry *file = FileMgr.getFile(filename);
+      if (!file || file->getModificationTime() >= PCHModTime) {
+        OutOfDate = true;
+        return false;
+      }
+      return true;
+    }
+  };
+}
+
+/// Returns true if the PCH at \p pchPath was written by this compiler from
+/// files which are all unchanged, so that it doesn't need to be written again.
+static bool isBridgingPCHUpToDate(StringRef pchPath,
+                                  clang::CompilerInstance &instance) {
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(pchPath, status) || status.getSize() == 0)
+    return false;
+
+  PCHInputFileChecker checker(instance.getFileManager(),
+                              status.getLastModificationTime().toEpochTime());
+  if (clang::ASTReader::readASTFileControlBlock(
+        pchPath, instance.getFileManager(), instance.getPCHContainerReader(),
+        /*FindModuleFileExtensions=*/false, checker))
+    return false;
+  return !checker.OutOfDate;
+}
+
+bool ClangImporter::emitBridgingPCH(StringRef headerPath,
+                                    StringRef outputPCHPath) {
+  if (isBridgingPCHUpToDate(outputPCHPath, *Impl.Instance))
+    return false;
+
+  llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
+    new clang::CompilerInvocation(*Impl.Invocation)
+  };
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getFrontendOpts().OutputFile = outputPCHPath;
+  invocation->getDiagnosticOpts().ShowCarets = false;
+
+  // Precompile the same #import line importBridgingHeader parses, so that
+  // the header is known to be imported already when the PCH is loaded.
+  invocation->getFrontendOpts().Inputs.clear();
+  invocation->getFrontendOpts().Inputs.push_back(
+      clang::FrontendInputFile(Implementation::bridgingHeaderBufferName,
+                               clang::IK_ObjC));
+
+  // This also keeps the remapped buffers owned by the caller.
+  invocation->getPreprocessorOpts().resetNonModularOptions();
+
+  llvm::SmallString<128> importLine{"#import \""};
+  importLine += headerPath;
+  importLine += "\"\n";
+  std::unique_ptr<llvm::MemoryBuffer> importBuffer{
+    llvm::MemoryBuffer::getMemBufferCopy(
+      importLine, Implementation::bridgingHeaderBufferName)
+  };
+  invocation->getPreprocessorOpts().addRemappedFile(
+      Implementation::bridgingHeaderBufferName, importBuffer.get());
+
+  clang::CompilerInstance emitInstance(
+    Impl.Instance->getPCHContainerOperations());
+  emitInstance.setInvocation(&*invocation);
+  emitInstance.createDiagnostics(&Impl.Instance->getDiagnosticClient(),
+                                 /*ShouldOwnClient=*/false);
+
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  emitInstance.setFileManager(&fileManager);
+  emitInstance.createSourceManager(fileManager);
+  emitInstance.setTarget(&Impl.Instance->getTarget());
+
+  clang::GeneratePCHAction action;
+  emitInstance.ExecuteAction(action);
+
+  if (emitInstance.getDiagnostics().hasErrorOccurred()) {
+    Impl.SwiftContext.Diags.diagnose({}, diag::bridging_header_pch_error,
+                                     outputPCHPath, headerPath);
+    return true;
+  }
+  return false;
+}
+
 void ClangImporter::collectSubModuleNames(
     ArrayRef<std::pair<Identifier, SourceLoc>> path,
     std::vector<std::string> &names) {
@@ -1856,6 +1995,12 @@ static bool shouldIgnoreMacro(StringRef name, const clang::MacroInfo *macro) {
   if (macro->isFunctionLike())
     return true;
 
+  // Most of the macros of large headers expand to expressions we cannot
+  // translate. Recognizing them by their tokens keeps them from being
+  // imported, and from being recorded in the lookup tables at all.
+  if (!ClangImporter::Implementation::canImportMacroExpansion(macro))
+    return true;
+
   // Consult the blacklist of macros to suppress.
   auto suppressMacro =
     llvm::StringSwitch<bool>(name)
@@ -2338,6 +2483,27 @@ auto ClangImporter::Implementation::importFullName(
        const clang::NamedDecl *D,
        ImportNameOptions options,
        clang::Sema *clangSemaOverride) -> ImportedName {
+  // Names computed with another Sema, e.g. while building a module, may not
+  // match ours, so don't cache them.
+  if (clangSemaOverride && clangSemaOverride != &getClangSema())
+    return importFullNameImpl(D, options, clangSemaOverride);
+
+  auto key = std::make_pair(D, unsigned(options.toRaw()));
+  auto known = ImportedNames.find(key);
+  if (known != ImportedNames.end())
+    return known->second;
+
+  // Computing the name may import other names, so don't hold on to an
+  // iterator while it runs.
+  auto result = importFullNameImpl(D, options, nullptr);
+  ImportedNames[key] = result;
+  return result;
+}
+
+auto ClangImporter::Implementation::importFullNameImpl(
+       const clang::NamedDecl *D,
+       ImportNameOptions options,
+       clang::Sema *clangSemaOverride) -> ImportedName {
   clang::Sema &clangSema = clangSemaOverride ? *clangSemaOverride
                                              : getClangSema();
   ImportedName result;
@@ -4459,6 +4625,18 @@ ClangImporter::Implementation::SwiftNameLookupExtension::createExtensionReader(
   assert(metadata.MajorVersion == SWIFT_LOOKUP_TABLE_VERSION_MAJOR);
   assert(metadata.MinorVersion == SWIFT_LOOKUP_TABLE_VERSION_MINOR);
 
+  // A precompiled bridging header provides the bridging header lookup table.
+  if (mod.Kind == clang::serialization::MK_PCH) {
+    auto onRemove = [this]() {
+      Impl.BridgingHeaderLookupTable.setReader(nullptr);
+    };
+    auto tableReader = SwiftLookupTableReader::create(this, reader, mod,
+                                                      onRemove, stream);
+    if (!tableReader) return nullptr;
+    Impl.BridgingHeaderLookupTable.setReader(tableReader.get());
+    return std::move(tableReader);
+  }
+
   // Check whether we already have an entry in the set of lookup tables.
   auto &entry = Impl.LookupTables[mod.ModuleName];
   if (entry) return nullptr;
@@ -4587,8 +4765,10 @@ void ClangImporter::Implementation::lookupValue(
 void ClangImporter::Implementation::lookupVisibleDecls(
        SwiftLookupTable &table,
        VisibleDeclConsumer &consumer) {
-  // Retrieve and sort all of the base names in this particular table.
-  auto baseNames = table.allBaseNames();
+  // Retrieve and sort the base names of namespace-scope entities in this
+  // particular table.
+  auto baseNames =
+    table.allBaseNames(SwiftLookupTable::ContextKind::TranslationUnit);
   llvm::array_pod_sort(baseNames.begin(), baseNames.end());
 
   // Look for namespace-scope entities with each base name.
@@ -4644,8 +4824,14 @@ void ClangImporter::Implementation::lookupObjCMembers(
 void ClangImporter::Implementation::lookupAllObjCMembers(
        SwiftLookupTable &table,
        VisibleDeclConsumer &consumer) {
-  // Retrieve and sort all of the base names in this particular table.
-  auto baseNames = table.allBaseNames();
+  // Retrieve and sort the base names of Objective-C members in this
+  // particular table.
+  const SwiftLookupTable::ContextKind memberKinds[] = {
+    SwiftLookupTable::ContextKind::ObjCClass,
+    SwiftLookupTable::ContextKind::ObjCProtocol,
+    SwiftLookupTable::ContextKind::Typedef,
+  };
+  auto baseNames = table.allBaseNames(memberKinds);
   llvm::array_pod_sort(baseNames.begin(), baseNames.end());
 
   // Look for Objective-C members with each base name.
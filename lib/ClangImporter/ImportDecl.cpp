@@ -6606,6 +6606,8 @@ Decl *ClangImporter::Implementation::importDeclAndCacheImpl(
   bool HadForwardDeclaration = false;
 
   ImportingEntityRAII ImportingEntity(*this);
+  ASTContext::AllocationOriginRAII ImportingOrigin(
+      SwiftContext, AllocationOrigin::ClangImporter);
   Decl *Result = importDeclImpl(ClangDecl, useSwift2Name, TypedefIsSuperfluous,
                                 HadForwardDeclaration);
   if (!Result)
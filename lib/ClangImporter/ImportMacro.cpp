@@ -245,6 +245,7 @@ static ValueDecl *importMacro(ClangImporter::Implementation &impl,
 
   // FIXME: Ask Clang to try to parse and evaluate the expansion as a constant
   // expression instead of doing these special-case pattern matches.
+  // Keep these patterns in sync with canImportMacroExpansion.
   switch (numTokens) {
   case 1: {
     // Check for a single-token expansion of the form <literal>.
@@ -359,9 +360,58 @@ static ValueDecl *importMacro(ClangImporter::Implementation &impl,
   return nullptr;
 }
 
+bool ClangImporter::Implementation::canImportMacroExpansion(
+    const clang::MacroInfo *macro) {
+  auto numTokens = macro->getNumTokens();
+  auto tokenI = macro->tokens_begin(), tokenE = macro->tokens_end();
+
+  // Drop one layer of parentheses.
+  if (numTokens > 2 &&
+      tokenI[0].is(clang::tok::l_paren) &&
+      tokenE[-1].is(clang::tok::r_paren)) {
+    ++tokenI;
+    --tokenE;
+    numTokens -= 2;
+  }
+
+  switch (numTokens) {
+  case 1:
+    // <literal>, or an identifier naming another macro.
+    return tokenI[0].isLiteral() || tokenI[0].is(clang::tok::identifier);
+  case 2:
+    // +<number>, -<number>, ~<number> or @"string".
+    return (isSignToken(tokenI[0]) &&
+            tokenI[1].is(clang::tok::numeric_constant)) ||
+           (tokenI[0].is(clang::tok::at) && isStringToken(tokenI[1]));
+  case 3:
+    // <number> << <number>.
+    return tokenI[0].is(clang::tok::numeric_constant) &&
+           tokenI[1].is(clang::tok::lessless) &&
+           tokenI[2].is(clang::tok::numeric_constant);
+  case 4:
+    // CFSTR("string").
+    return tokenI[0].is(clang::tok::identifier) &&
+           tokenI[0].getIdentifierInfo()->isStr("CFSTR") &&
+           tokenI[1].is(clang::tok::l_paren) &&
+           isStringToken(tokenI[2]) &&
+           tokenI[3].is(clang::tok::r_paren);
+  case 5:
+    // (void*)<number>.
+    return tokenI[0].is(clang::tok::l_paren) &&
+           tokenI[1].is(clang::tok::kw_void) &&
+           tokenI[2].is(clang::tok::star) &&
+           tokenI[3].is(clang::tok::r_paren) &&
+           tokenI[4].is(clang::tok::numeric_constant);
+  default:
+    return false;
+  }
+}
+
 ValueDecl *ClangImporter::Implementation::importMacro(Identifier name,
                                                       clang::MacroInfo *macro) {
-  if (!macro)
+  // Macros which are ignored have no name, and would all be cached together
+  // below.
+  if (!macro || name.empty())
     return nullptr;
 
   // Look for macros imported with the same name.
@@ -1241,6 +1241,9 @@ Type ClangImporter::Implementation::importType(clang::QualType type,
   if (type.isNull())
     return Type();
 
+  ASTContext::AllocationOriginRAII allocationOrigin(
+      SwiftContext, AllocationOrigin::ClangImporter);
+
   // The "built-in" Objective-C types id, Class, and SEL can actually be (and
   // are) defined within the library. Clang tracks the redefinition types
   // separately, so it can provide fallbacks in certain cases. For Swift, we
@@ -687,9 +687,17 @@ public:
   /// Tracks included headers from the bridging header.
   llvm::DenseSet<const clang::FileEntry *> BridgeHeaderFiles;
 
+  /// The modules imported by the precompiled bridging header, which still
+  /// have to be exported from the imported header module.
+  std::vector<clang::ImportDecl *> PendingBridgingPCHImports;
+
   void addBridgeHeaderTopLevelDecls(clang::Decl *D);
   bool shouldIgnoreBridgeHeaderTopLevelDecl(clang::Decl *D);
 
+  /// Loads the lookup table and the module imports of the precompiled
+  /// bridging header, whose contents are never parsed.
+  void loadBridgingPCHContents();
+
   /// Add the given named declaration as an entry to the given Swift name
   /// lookup table, including any of its child entries.
   void addEntryToLookupTable(clang::Sema &clangSema, SwiftLookupTable &table,
@@ -930,6 +938,21 @@ public:
                               ImportNameOptions options = None,
                               clang::Sema *clangSemaOverride = nullptr);
 
+private:
+  /// The names computed by importFullName with the importer's own Sema,
+  /// keyed by declaration and options. Building the lookup tables, importing
+  /// a declaration and importing the members which override it all ask for
+  /// the same names again.
+  llvm::DenseMap<std::pair<const clang::NamedDecl *, unsigned>, ImportedName>
+    ImportedNames;
+
+  /// Computes the name for importFullName, without caching.
+  ImportedName importFullNameImpl(const clang::NamedDecl *D,
+                                  ImportNameOptions options,
+                                  clang::Sema *clangSemaOverride);
+
+public:
+
   /// Imports the name of the given Clang macro into Swift.
   Identifier importMacroName(const clang::IdentifierInfo *clangIdentifier,
                              const clang::MacroInfo *macro,
@@ -978,6 +1001,14 @@ public:
   /// translated into Swift.
   ValueDecl *importMacro(Identifier name, clang::MacroInfo *macro);
 
+  /// Whether the expansion of \p macro has one of the forms which
+  /// importMacro translates, judging by its tokens alone.
+  ///
+  /// Macros which fail this check are left out of the lookup tables, so that
+  /// neither name lookup nor the enumeration of a module's declarations
+  /// tries to import them.
+  static bool canImportMacroExpansion(const clang::MacroInfo *macro);
+
   /// Find the swift_newtype attribute on the given typedef, if present.
   clang::SwiftNewtypeAttr *getSwiftNewtypeAttr(
       const clang::TypedefNameDecl *decl,
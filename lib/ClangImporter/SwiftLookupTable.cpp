@@ -474,6 +474,49 @@ SmallVector<StringRef, 4> SwiftLookupTable::allBaseNames() {
   return result;
 }
 
+/// Whether any of \p entries is in a context of one of the given kinds.
+static bool
+hasEntryInContextKind(ArrayRef<SwiftLookupTable::FullTableEntry> entries,
+                      ArrayRef<SwiftLookupTable::ContextKind> kinds) {
+  return std::any_of(entries.begin(), entries.end(),
+                     [&](const SwiftLookupTable::FullTableEntry &entry) {
+    return std::find(kinds.begin(), kinds.end(), entry.Context.first) !=
+           kinds.end();
+  });
+}
+
+SmallVector<StringRef, 4>
+SwiftLookupTable::allBaseNames(ArrayRef<ContextKind> kinds) {
+  SmallVector<StringRef, 4> result;
+
+  // Without a reader, the lookup table has everything.
+  if (!Reader) {
+    for (const auto &entry : LookupTable) {
+      if (hasEntryInContextKind(entry.second, kinds))
+        result.push_back(entry.first);
+    }
+    return result;
+  }
+
+  // Otherwise check each base name of the reader, preferring entries which
+  // are already deserialized.
+  SmallVector<FullTableEntry, 2> entries;
+  for (auto baseName : Reader->getBaseNames()) {
+    auto known = LookupTable.find(baseName);
+    if (known != LookupTable.end()) {
+      if (hasEntryInContextKind(known->second, kinds))
+        result.push_back(baseName);
+      continue;
+    }
+
+    entries.clear();
+    if (Reader->lookup(baseName, entries) &&
+        hasEntryInContextKind(entries, kinds))
+      result.push_back(baseName);
+  }
+  return result;
+}
+
 SmallVector<clang::NamedDecl *, 4>
 SwiftLookupTable::lookupObjCMembers(StringRef baseName) {
   SmallVector<clang::NamedDecl *, 4> result;
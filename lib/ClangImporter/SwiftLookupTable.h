@@ -146,7 +146,7 @@ const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MAJOR = 1;
 /// Lookup table minor version number.
 ///
 /// When the format changes IN ANY WAY, this number should be incremented.
-const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 14; // Swift 2 names
+const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 15; // importable macros
 
 /// A lookup table that maps Swift names to the set of Clang
 /// declarations with that particular name.
@@ -373,6 +373,14 @@ public:
   /// Retrieve the set of base names that are stored in the lookup table.
   SmallVector<StringRef, 4> allBaseNames();
 
+  /// Retrieve the base names which have entries in a context of one of the
+  /// given kinds.
+  ///
+  /// Entries read from the serialized table to answer this are not kept, so
+  /// enumerating the names of a large module only materializes the names
+  /// which are looked up afterwards.
+  SmallVector<StringRef, 4> allBaseNames(ArrayRef<ContextKind> kinds);
+
   /// Lookup Objective-C members with the given base name, regardless
   /// of context.
   SmallVector<clang::NamedDecl *, 4> lookupObjCMembers(StringRef baseName);
@@ -392,6 +400,14 @@ public:
   /// Deserialize all entries.
   void deserializeAll();
 
+  /// Replaces the reader responsible for lazily loading the contents of this
+  /// table.
+  ///
+  /// A table can only be modified once it has no reader, so after
+  /// deserializeAll() this can be used to drop the reader of a table that
+  /// is extended in memory.
+  void setReader(SwiftLookupTableReader *reader) { Reader = reader; }
+
   /// Dump the internal representation of this lookup table.
   void dump() const;
 };
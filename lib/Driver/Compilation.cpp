@@ -16,6 +16,7 @@
 #include "swift/AST/DiagnosticsDriver.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Program.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/TaskQueue.h"
 #include "swift/Basic/Version.h"
 #include "swift/Basic/type_traits.h"
@@ -23,7 +24,13 @@
 #include "swift/Driver/DependencyGraph.h"
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
+#include "swift/Driver/JobCache.h"
 #include "swift/Driver/ParseableOutput.h"
+#include "swift/Driver/ToolChain.h"
+#include "swift/Option/Options.h"
+#include "swift/Serialization/Validation.h"
+#include "swift/Strings.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
@@ -31,7 +38,9 @@
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/YAMLParser.h"
 
@@ -83,6 +92,54 @@ namespace {
     ///
     /// Only intended for source files.
     llvm::SmallDenseMap<const Job *, bool, 16> UnfinishedCommands;
+
+    /// Batchable jobs which are ready to run but haven't been given to the
+    /// TaskQueue yet, in the order in which they became ready.
+    SmallVector<const Job *, 16> PendingBatchableCommands;
+
+    /// The batch jobs given to the TaskQueue, keyed by themselves.
+    llvm::SmallDenseMap<const Job *, std::unique_ptr<BatchJob>, 4> BatchJobs;
+  };
+
+  /// How busy the job slots were, in microseconds.
+  struct JobSlotUsage {
+    unsigned NumSlots;
+    unsigned NumRunning = 0;
+    int64_t LastChange = 0;
+    /// The time during which any job was running.
+    int64_t Wall = 0;
+    /// The sum of the times of the jobs.
+    int64_t Busy = 0;
+    /// The time during which some, but fewer than NumSlots, jobs were
+    /// running.
+    int64_t Underutilized = 0;
+    /// The number of jobs run, counting the jobs of a batch separately.
+    size_t NumJobs = 0;
+    /// The time the merge-modules job ran.
+    int64_t MergeModules = 0;
+
+    explicit JobSlotUsage(unsigned NumSlots) : NumSlots(NumSlots) {}
+
+    void advance(int64_t Now) {
+      if (NumRunning > 0) {
+        Wall += Now - LastChange;
+        if (NumRunning < NumSlots)
+          Underutilized += Now - LastChange;
+      }
+      LastChange = Now;
+    }
+
+    void jobBegan(int64_t Now) {
+      advance(Now);
+      ++NumRunning;
+    }
+
+    void jobEnded(int64_t Now, int64_t Duration, size_t NumCombinedJobs) {
+      advance(Now);
+      --NumRunning;
+      Busy += Duration;
+      NumJobs += NumCombinedJobs;
+    }
   };
 }
 
@@ -109,8 +166,12 @@ using InputInfoMap =
 static void populateInputInfoMap(InputInfoMap &inputs,
                                  const PerformJobsState &endState) {
   for (auto &entry : endState.UnfinishedCommands) {
+    if (!isa<CompileJobAction>(entry.first->getSource()))
+      continue;
     for (auto *action : entry.first->getSource().getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry.first->getInputModTime();
@@ -127,7 +188,9 @@ static void populateInputInfoMap(InputInfoMap &inputs,
       continue;
 
     for (auto *action : compileAction->getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry->getInputModTime();
@@ -174,7 +237,9 @@ static void checkForOutOfDateInputs(DiagnosticEngine &diags,
 
 static void writeCompilationRecord(StringRef path, StringRef argsHash,
                                    llvm::sys::TimeValue buildTime,
-                                   const InputInfoMap &inputs) {
+                                   const InputInfoMap &inputs,
+                                   const llvm::StringMap<std::string> &hashes,
+                                   const llvm::StringMap<double> &durations) {
   std::error_code error;
   llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
   if (out.has_error()) {
@@ -213,6 +278,93 @@ static void writeCompilationRecord(StringRef path, StringRef argsHash,
     writeTimeValue(out, entry.second.previousModTime);
     out << "\n";
   }
+
+  std::vector<StringRef> keys;
+  if (!hashes.empty()) {
+    for (auto &entry : hashes)
+      keys.push_back(entry.getKey());
+    llvm::array_pod_sort(keys.begin(), keys.end());
+
+    out << "external_interface_hashes:\n";
+    for (StringRef key : keys) {
+      out << "  \"" << llvm::yaml::escape(key) << "\": \""
+          << hashes.lookup(key) << "\"\n";
+    }
+    keys.clear();
+  }
+
+  if (durations.empty())
+    return;
+
+  // Sort the durations by key, so that the record is deterministic.
+  for (auto &entry : durations)
+    keys.push_back(entry.getKey());
+  llvm::array_pod_sort(keys.begin(), keys.end());
+
+  out << "job_durations:\n";
+  for (StringRef key : keys) {
+    out << "  \"" << llvm::yaml::escape(key) << "\": "
+        << (unsigned)(durations.lookup(key) * 1000) << "\n";
+  }
+}
+
+/// Returns the interface hash recorded in the Swift module at \p path, or
+/// the empty string if \p path isn't a Swift module which records one.
+static std::string getModuleInterfaceHash(StringRef path) {
+  if (llvm::sys::path::extension(path) !=
+        StringRef(".") + SERIALIZED_MODULE_EXTENSION)
+    return "";
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return "";
+  auto info = serialization::validateSerializedAST(buffer.get()->getBuffer());
+  if (info.status != serialization::Status::Valid)
+    return "";
+  return info.interfaceHash;
+}
+
+/// The estimated compile time of a byte of source, in seconds, for jobs
+/// which didn't run in the last build.
+static const double SecondsPerSourceByte = 1e-5;
+
+/// The estimated time of a job which doesn't compile sources, in seconds,
+/// if it didn't run in the last build. Also the smallest estimate of any job:
+/// the order of jobs which are shorter is not worth changing, and would
+/// change with the noise of their timings.
+static const double DefaultJobSeconds = 0.1;
+
+/// Returns the key under which the build record keeps the duration of
+/// \p Cmd: the first input file of a compile job, or the kind of any other
+/// job.
+static StringRef getJobCostKey(const Job *Cmd) {
+  if (isa<CompileJobAction>(Cmd->getSource()))
+    for (const Action *A : Cmd->getSource().getInputs())
+      if (auto *Input = dyn_cast<InputAction>(A))
+        return Input->getInputArg().getValue();
+  return Cmd->getSource().getClassName();
+}
+
+/// Estimates how long \p Cmd runs, in seconds: as long as in the last build,
+/// or for compile jobs which didn't run then, by the size of their inputs.
+static double estimateJobCost(const Job *Cmd,
+                              const llvm::StringMap<double> &Previous) {
+  auto Found = Previous.find(getJobCostKey(Cmd));
+  if (Found != Previous.end())
+    return std::max(Found->second, DefaultJobSeconds);
+
+  if (!isa<CompileJobAction>(Cmd->getSource()))
+    return DefaultJobSeconds;
+
+  uint64_t Bytes = 0;
+  for (const Action *A : Cmd->getSource().getInputs()) {
+    auto *Input = dyn_cast<InputAction>(A);
+    if (!Input)
+      continue;
+    uint64_t Size;
+    if (!llvm::sys::fs::file_size(Input->getInputArg().getValue(), Size))
+      Bytes += Size;
+  }
+  return std::max(Bytes * SecondsPerSourceByte, DefaultJobSeconds);
 }
 
 static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
@@ -252,6 +404,72 @@ static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
   return true;
 }
 
+/// Write the statistics of the job scheduling to a file in \p Directory, for
+/// -stats-output-dir. \p CriticalPath is the estimate in seconds.
+static void writeDriverStats(StringRef Directory, const ArgList &Args,
+                             const JobSlotUsage &Usage, size_t NumJobs,
+                             double CriticalPath, const JobCache *Cache) {
+  UnifiedStatsReporter Stats("swift-driver",
+                             Args.getLastArgValue(options::OPT_module_name),
+                             Directory);
+  auto &Counters = Stats.getDriverCounters();
+  Counters.NumDriverJobsRun = Usage.NumJobs;
+  Counters.NumDriverJobsSkipped =
+    NumJobs > Usage.NumJobs ? NumJobs - Usage.NumJobs : 0;
+  Counters.NumDriverParallelJobSlots = Usage.NumSlots;
+  Counters.DriverJobsWallMilliseconds = Usage.Wall / 1000;
+  Counters.DriverJobsBusyMilliseconds = Usage.Busy / 1000;
+  if (Usage.Wall > 0)
+    Counters.DriverJobSlotUtilizationPercent =
+      100 * Usage.Busy / (Usage.Wall * Usage.NumSlots);
+  Counters.DriverJobsUnderutilizedMilliseconds = Usage.Underutilized / 1000;
+  Counters.DriverCriticalPathEstimateMilliseconds = CriticalPath * 1000;
+  Counters.DriverMergeModulesMilliseconds = Usage.MergeModules / 1000;
+  if (Cache) {
+    Counters.NumDriverJobCacheHits = Cache->NumHits;
+    Counters.NumDriverJobCacheMisses = Cache->NumMisses;
+  }
+}
+
+/// Write \p JobTrace, merged with the traces which the jobs \p Pids wrote to
+/// \p Directory, to a file "driver-trace-<time>-<pid>.json" in \p Directory.
+static void writeJobTrace(DiagnosticEngine &Diags, StringRef Directory,
+                          TraceEventRecorder &JobTrace,
+                          ArrayRef<ProcessId> Pids) {
+  // The frontend names its trace files "trace-<...>-<pid>.json".
+  llvm::DenseSet<ProcessId> JobPids;
+  for (ProcessId Pid : Pids)
+    JobPids.insert(Pid);
+  std::vector<std::string> Paths;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator Entry(Directory, EC), End;
+       Entry != End && !EC; Entry.increment(EC)) {
+    StringRef Name = llvm::sys::path::filename(Entry->path());
+    if (!Name.startswith("trace-") || !Name.endswith(".json"))
+      continue;
+    StringRef PidString = Name.drop_back(strlen(".json")).rsplit('-').second;
+    ProcessId Pid;
+    if (PidString.getAsInteger(10, Pid))
+      continue;
+    if (JobPids.count(Pid))
+      Paths.push_back(Entry->path());
+  }
+  std::sort(Paths.begin(), Paths.end());
+
+  SmallString<128> Path(Directory);
+  llvm::sys::path::append(Path, "driver-trace-" +
+                          llvm::Twine(TraceEventRecorder::now()) + "-" +
+                          llvm::Twine(llvm::sys::Process::getProcessId()) +
+                          ".json");
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    Diags.diagnose(SourceLoc(), diag::warning_unable_to_write_trace_file,
+                   Path, EC.message());
+    return;
+  }
+  JobTrace.printMerged(OS, Paths);
+}
+
 int Compilation::performJobsImpl() {
   // Create a TaskQueue for execution.
   std::unique_ptr<TaskQueue> TQ;
@@ -272,6 +490,37 @@ int Compilation::performJobsImpl() {
   if (ShowIncrementalBuildDecisions)
     IncrementalTracer = &ActualIncrementalTracer;
 
+  // Estimate for every job how long the longest chain of jobs takes which
+  // starts with it, and run the jobs with the longest chains first, so that
+  // the build doesn't end with a long tail of jobs that wait for each other.
+  llvm::DenseMap<const Job *, double> JobCosts;
+  llvm::DenseMap<const Job *, SmallVector<const Job *, 2>> Dependents;
+  for (const Job *Cmd : getJobs()) {
+    JobCosts[Cmd] = estimateJobCost(Cmd, PreviousJobDurations);
+    for (const Job *Input : Cmd->getInputs())
+      Dependents[Input].push_back(Cmd);
+  }
+
+  llvm::DenseMap<const Job *, double> CriticalPaths;
+  std::function<double(const Job *)> getCriticalPath = [&](const Job *Cmd) {
+    auto Known = CriticalPaths.find(Cmd);
+    if (Known != CriticalPaths.end())
+      return Known->second;
+    double LongestDependent = 0;
+    auto Found = Dependents.find(Cmd);
+    if (Found != Dependents.end())
+      for (const Job *Dependent : Found->second)
+        LongestDependent =
+          std::max(LongestDependent, getCriticalPath(Dependent));
+    double Path = JobCosts.lookup(Cmd) + LongestDependent;
+    CriticalPaths[Cmd] = Path;
+    return Path;
+  };
+
+  // The durations for the next build's estimates: the ones of the last
+  // build, updated with the jobs which run now.
+  llvm::StringMap<double> JobDurations = PreviousJobDurations;
+
   auto noteBuilding = [&] (const Job *cmd, StringRef reason) {
     if (!ShowIncrementalBuildDecisions)
       return;
@@ -286,6 +535,15 @@ int Compilation::performJobsImpl() {
     });
   };
 
+  // With -driver-job-cache-path, the outputs of compile jobs which ran
+  // before with the same flags and inputs are restored from the cache. The
+  // restored jobs are then treated like jobs which just finished.
+  std::unique_ptr<JobCache> Cache;
+  if (!JobCachePath.empty() && !SkipTaskExecution)
+    Cache.reset(new JobCache(JobCachePath));
+  llvm::DenseMap<const Job *, std::string> JobCacheKeys;
+  SmallVector<const Job *, 16> RestoredCommands;
+
   // Set up scheduleCommandIfNecessaryAndPossible.
   // This will only schedule the given command if it has not been scheduled
   // and if all of its inputs are in FinishedCommands.
@@ -307,8 +565,63 @@ int Compilation::performJobsImpl() {
     assert(Cmd->getExtraEnvironment().empty() &&
            "not implemented for compilations with multiple jobs");
     State.ScheduledCommands.insert(Cmd);
+    if (Cache) {
+      std::string Key = Cache->computeKey(*Cmd, [&](StringRef File) {
+        return isTemporaryFile(File);
+      });
+      if (!Key.empty()) {
+        if (Cache->restore(*Cmd, Key)) {
+          RestoredCommands.push_back(Cmd);
+          return;
+        }
+        JobCacheKeys[Cmd] = std::move(Key);
+      }
+    }
+    if (BatchModeToolChain && BatchModeToolChain->jobIsBatchable(Cmd)) {
+      State.PendingBatchableCommands.push_back(Cmd);
+      return;
+    }
     TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
-                (void *)Cmd);
+                (void *)Cmd, getCriticalPath(Cmd));
+  };
+
+  // Give the pending batchable jobs to the TaskQueue, combined into about as
+  // many batch jobs as there may be commands running in parallel.
+  auto addPendingBatchableCommands = [&] {
+    ArrayRef<const Job *> Pending = State.PendingBatchableCommands;
+    size_t NumBatches =
+      std::min<size_t>(Pending.size(), std::max(1U, NumberOfParallelCommands));
+    size_t BatchStart = 0;
+    for (size_t Batch = 0; Batch != NumBatches; ++Batch) {
+      // Spread the remainder over the first batches.
+      size_t BatchSize = Pending.size() / NumBatches +
+                         (Batch < Pending.size() % NumBatches ? 1 : 0);
+      ArrayRef<const Job *> Combined = Pending.slice(BatchStart, BatchSize);
+      BatchStart += BatchSize;
+
+      const Job *Cmd = Combined.front();
+      double Priority = 0;
+      for (const Job *Part : Combined)
+        Priority = std::max(Priority, getCriticalPath(Part));
+      if (Combined.size() > 1) {
+        std::unique_ptr<BatchJob> BJ =
+          BatchModeToolChain->constructBatchJob(Combined);
+        Cmd = BJ.get();
+        State.BatchJobs[Cmd] = std::move(BJ);
+      }
+      TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
+                  (void *)Cmd, Priority);
+    }
+    State.PendingBatchableCommands.clear();
+  };
+
+  // Returns the jobs whose work \p Cmd does: the combined jobs of a batch
+  // job, or \p Cmd itself.
+  auto getCombinedJobs = [&] (const Job *const &Cmd) -> ArrayRef<const Job *> {
+    auto Found = State.BatchJobs.find(Cmd);
+    if (Found != State.BatchJobs.end())
+      return Found->second->getCombinedJobs();
+    return Cmd;
   };
 
   // When a task finishes, we need to reevaluate the other commands that
@@ -325,6 +638,14 @@ int Compilation::performJobsImpl() {
     }
   };
 
+  // The snapshot written at the end of the last build lets the graph skip
+  // parsing the dependency files which haven't changed since.
+  std::string DepGraphSnapshotPath;
+  if (getIncrementalBuildEnabled() && !CompilationRecordPath.empty()) {
+    DepGraphSnapshotPath = CompilationRecordPath + ".depgraph";
+    (void)DepGraph.loadSnapshot(DepGraphSnapshotPath);
+  }
+
   // Schedule all jobs we can.
   for (const Job *Cmd : getJobs()) {
     if (!getIncrementalBuildEnabled()) {
@@ -401,6 +722,13 @@ int Compilation::performJobsImpl() {
         if (depStatus.getLastModificationTime() < LastBuildTime)
           continue;
 
+      // A module which was rewritten with the interface it had in the last
+      // build doesn't affect the files which import it.
+      auto previousHash = PreviousInterfaceHashes.find(dependency);
+      if (previousHash != PreviousInterfaceHashes.end() &&
+          previousHash->second == getModuleInterfaceHash(dependency))
+        continue;
+
       // If the dependency has been modified since the oldest built file,
       // or if we can't stat it for some reason (perhaps it's been deleted?),
       // trigger rebuilds through the dependency graph.
@@ -422,18 +750,142 @@ int Compilation::performJobsImpl() {
 
   int Result = EXIT_SUCCESS;
 
+  // Every running job occupies a lane. For -trace-stats-events, trace
+  // viewers show the lanes as threads of the driver, so that they show how
+  // the jobs were scheduled.
+  std::unique_ptr<TraceEventRecorder> JobTrace;
+  struct RunningJob {
+    int64_t Start;
+    unsigned Lane;
+  };
+  llvm::DenseMap<ProcessId, RunningJob> RunningJobs;
+  std::vector<bool> BusyLanes;
+  SmallVector<ProcessId, 16> FinishedPids;
+  JobSlotUsage SlotUsage(std::max(1U, TQ->getNumberOfParallelTasks()));
+  if (TraceStatsEvents && !StatsOutputDir.empty())
+    JobTrace.reset(new TraceEventRecorder("swift-driver"));
+
+  auto noteJobBegan = [&](ProcessId Pid) {
+    int64_t Now = TraceEventRecorder::now();
+    SlotUsage.jobBegan(Now);
+    auto FreeLane = std::find(BusyLanes.begin(), BusyLanes.end(), false);
+    unsigned Lane = FreeLane - BusyLanes.begin();
+    if (FreeLane == BusyLanes.end())
+      BusyLanes.push_back(true);
+    else
+      *FreeLane = true;
+    RunningJobs[Pid] = {Now, Lane};
+  };
+
+  // Records how long \p Cmd ran, for the statistics, the trace and the
+  // estimates of the next build.
+  auto noteJobEnded = [&](ProcessId Pid, const Job *Cmd, bool Succeeded) {
+    auto Running = RunningJobs.find(Pid);
+    if (Running == RunningJobs.end())
+      return;
+    int64_t Now = TraceEventRecorder::now();
+    int64_t Start = Running->second.Start;
+    ArrayRef<const Job *> Combined = getCombinedJobs(Cmd);
+    SlotUsage.jobEnded(Now, Now - Start, Combined.size());
+    if (isa<MergeModuleJobAction>(Cmd->getSource()))
+      SlotUsage.MergeModules += Now - Start;
+    BusyLanes[Running->second.Lane] = false;
+    unsigned Lane = Running->second.Lane;
+    RunningJobs.erase(Running);
+    FinishedPids.push_back(Pid);
+
+    // Split the time of a batch job among its jobs, by their estimates.
+    double TotalEstimate = 0;
+    for (const Job *Part : Combined)
+      TotalEstimate += JobCosts.lookup(Part);
+    if (Succeeded && TotalEstimate > 0) {
+      for (const Job *Part : Combined)
+        JobDurations[getJobCostKey(Part)] =
+          (Now - Start) / 1e6 * JobCosts.lookup(Part) / TotalEstimate;
+    }
+
+    if (!JobTrace)
+      return;
+    StringRef Detail;
+    if (!Cmd->getOutput().getPrimaryOutputFilenames().empty())
+      Detail = llvm::sys::path::filename(
+          Cmd->getOutput().getPrimaryOutputFilenames().front());
+    JobTrace->recordEvent("job", Cmd->getSource().getClassName(), Detail,
+                          Start, Now, Lane);
+  };
+
   // Set up a callback which will be called immediately after a task has
   // started. This callback may be used to provide output indicating that the
   // task began.
-  auto taskBegan = [this] (ProcessId Pid, void *Context) {
+  auto taskBegan = [&] (ProcessId Pid, void *Context) {
     // TODO: properly handle task began.
     const Job *BeganCmd = (const Job *)Context;
+    noteJobBegan(Pid);
 
     // For verbose output, print out each command as it begins execution.
+    // Parseable output describes the jobs combined into a batch separately,
+    // as if they had been run on their own.
     if (Level == OutputLevel::Verbose)
       BeganCmd->printCommandLine(llvm::errs());
     else if (Level == OutputLevel::Parseable)
-      parseable_output::emitBeganMessage(llvm::errs(), *BeganCmd, Pid);
+      for (const Job *Cmd : getCombinedJobs(BeganCmd))
+        parseable_output::emitBeganMessage(llvm::errs(), *Cmd, Pid);
+  };
+
+  // Marks the jobs \p Cmds, which succeeded, as finished, and schedules the
+  // jobs which depend on them.
+  auto noteCommandsSucceeded = [&](ArrayRef<const Job *> Cmds) {
+    for (const Job *FinishedCmd : Cmds) {
+      // When a task finishes, we need to reevaluate the other commands that
+      // might have been blocked.
+      markFinished(FinishedCmd);
+
+      // In order to handle both old dependencies that have disappeared and new
+      // dependencies that have arisen, we need to reload the dependency file.
+      if (getIncrementalBuildEnabled()) {
+        const CommandOutput &Output = FinishedCmd->getOutput();
+        StringRef DependenciesFile =
+          Output.getAdditionalOutputForType(types::TY_SwiftDeps);
+        if (!DependenciesFile.empty()) {
+          SmallVector<const Job *, 16> Dependents;
+          bool wasCascading = DepGraph.isMarked(FinishedCmd);
+
+          switch (DepGraph.loadFromPath(FinishedCmd, DependenciesFile)) {
+          case DependencyGraphImpl::LoadResult::HadError:
+            disableIncrementalBuild();
+            for (const Job *Cmd : DeferredCommands)
+              scheduleCommandIfNecessaryAndPossible(Cmd);
+            DeferredCommands.clear();
+            Dependents.clear();
+            break;
+          case DependencyGraphImpl::LoadResult::UpToDate:
+            if (!wasCascading)
+              break;
+            SWIFT_FALLTHROUGH;
+          case DependencyGraphImpl::LoadResult::AffectsDownstream:
+            DepGraph.markTransitive(Dependents, FinishedCmd);
+            break;
+          }
+
+          for (const Job *Cmd : Dependents) {
+            DeferredCommands.erase(Cmd);
+            noteBuilding(Cmd, "because of dependencies discovered later");
+            scheduleCommandIfNecessaryAndPossible(Cmd);
+          }
+        }
+      }
+    }
+  };
+
+  // Treats the jobs whose outputs were restored from the cache as if they
+  // had just run, which may restore or schedule more jobs.
+  auto finishRestoredCommands = [&] {
+    while (!RestoredCommands.empty()) {
+      const Job *Cmd = RestoredCommands.pop_back_val();
+      if (Level == OutputLevel::Parseable)
+        parseable_output::emitSkippedMessage(llvm::errs(), *Cmd);
+      noteCommandsSucceeded(Cmd);
+    }
   };
 
   // Set up a callback which will be called immediately after a task has
@@ -444,11 +896,17 @@ int Compilation::performJobsImpl() {
   auto taskFinished = [&] (ProcessId Pid, int ReturnCode, StringRef Output,
                            void *Context) -> TaskFinishedResponse {
     const Job *FinishedCmd = (const Job *)Context;
+    ArrayRef<const Job *> CombinedCmds = getCombinedJobs(FinishedCmd);
+    noteJobEnded(Pid, FinishedCmd, ReturnCode == EXIT_SUCCESS);
 
     if (Level == OutputLevel::Parseable) {
-      // Parseable output was requested.
-      parseable_output::emitFinishedMessage(llvm::errs(), *FinishedCmd, Pid,
-                                            ReturnCode, Output);
+      // Parseable output was requested. The output of a batch job is only
+      // reported once.
+      for (const Job *Cmd : CombinedCmds) {
+        parseable_output::emitFinishedMessage(llvm::errs(), *Cmd, Pid,
+                                              ReturnCode, Output);
+        Output = StringRef();
+      }
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
       // support getting buffered output.
@@ -477,56 +935,31 @@ int Compilation::performJobsImpl() {
           TaskFinishedResponse::StopExecution;
     }
 
-    // When a task finishes, we need to reevaluate the other commands that
-    // might have been blocked.
-    markFinished(FinishedCmd);
-
-    // In order to handle both old dependencies that have disappeared and new
-    // dependencies that have arisen, we need to reload the dependency file.
-    if (getIncrementalBuildEnabled()) {
-      const CommandOutput &Output = FinishedCmd->getOutput();
-      StringRef DependenciesFile =
-        Output.getAdditionalOutputForType(types::TY_SwiftDeps);
-      if (!DependenciesFile.empty()) {
-        SmallVector<const Job *, 16> Dependents;
-        bool wasCascading = DepGraph.isMarked(FinishedCmd);
-
-        switch (DepGraph.loadFromPath(FinishedCmd, DependenciesFile)) {
-        case DependencyGraphImpl::LoadResult::HadError:
-          disableIncrementalBuild();
-          for (const Job *Cmd : DeferredCommands)
-            scheduleCommandIfNecessaryAndPossible(Cmd);
-          DeferredCommands.clear();
-          Dependents.clear();
-          break;
-        case DependencyGraphImpl::LoadResult::UpToDate:
-          if (!wasCascading)
-            break;
-          SWIFT_FALLTHROUGH;
-        case DependencyGraphImpl::LoadResult::AffectsDownstream:
-          DepGraph.markTransitive(Dependents, FinishedCmd);
-          break;
-        }
-
-        for (const Job *Cmd : Dependents) {
-          DeferredCommands.erase(Cmd);
-          noteBuilding(Cmd, "because of dependencies discovered later");
-          scheduleCommandIfNecessaryAndPossible(Cmd);
-        }
-      }
+    for (const Job *Cmd : CombinedCmds) {
+      auto Key = JobCacheKeys.find(Cmd);
+      if (Key != JobCacheKeys.end())
+        Cache->store(*Cmd, Key->second);
     }
 
+    noteCommandsSucceeded(CombinedCmds);
+    finishRestoredCommands();
+    addPendingBatchableCommands();
+
     return TaskFinishedResponse::ContinueExecution;
   };
 
   auto taskSignalled = [&] (ProcessId Pid, StringRef ErrorMsg, StringRef Output,
                             void *Context) -> TaskFinishedResponse {
     const Job *SignalledCmd = (const Job *)Context;
+    noteJobEnded(Pid, SignalledCmd, /*Succeeded=*/false);
 
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
-      parseable_output::emitSignalledMessage(llvm::errs(), *SignalledCmd, Pid,
-                                             ErrorMsg, Output);
+      for (const Job *Cmd : getCombinedJobs(SignalledCmd)) {
+        parseable_output::emitSignalledMessage(llvm::errs(), *Cmd, Pid,
+                                               ErrorMsg, Output);
+        Output = StringRef();
+      }
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
       // support getting buffered output.
@@ -548,6 +981,9 @@ int Compilation::performJobsImpl() {
   };
 
   do {
+    finishRestoredCommands();
+    addPendingBatchableCommands();
+
     // Ask the TaskQueue to execute.
     TQ->execute(taskBegan, taskFinished, taskSignalled);
 
@@ -564,7 +1000,8 @@ int Compilation::performJobsImpl() {
     }
 
     // ...which may allow us to go on and do later tasks.
-  } while (Result == 0 && TQ->hasRemainingTasks());
+  } while (Result == 0 &&
+           (TQ->hasRemainingTasks() || !RestoredCommands.empty()));
 
   if (Result == 0) {
     assert(State.BlockingCommands.empty() &&
@@ -595,9 +1032,38 @@ int Compilation::performJobsImpl() {
     InputInfoMap InputInfo;
     populateInputInfoMap(InputInfo, State);
     checkForOutOfDateInputs(Diags, InputInfo);
+
+    // Record the interface hashes of the modules which the jobs were built
+    // against. Modules which changed during the build are left out, so that
+    // the next build checks their dependents again.
+    llvm::StringMap<std::string> InterfaceHashes;
+    if (getIncrementalBuildEnabled()) {
+      for (StringRef dependency : DepGraph.getExternalDependencies()) {
+        llvm::sys::fs::file_status depStatus;
+        if (llvm::sys::fs::status(dependency, depStatus) ||
+            !(depStatus.getLastModificationTime() < BuildStartTime))
+          continue;
+        std::string hash = getModuleInterfaceHash(dependency);
+        if (!hash.empty())
+          InterfaceHashes[dependency] = std::move(hash);
+      }
+    }
+
     writeCompilationRecord(CompilationRecordPath, ArgsHash, BuildStartTime,
-                           InputInfo);
+                           InputInfo, InterfaceHashes, JobDurations);
+    if (!DepGraphSnapshotPath.empty() && getIncrementalBuildEnabled())
+      (void)DepGraph.writeSnapshot(DepGraphSnapshotPath);
+  }
+
+  if (!StatsOutputDir.empty()) {
+    double CriticalPath = 0;
+    for (const Job *Cmd : getJobs())
+      CriticalPath = std::max(CriticalPath, getCriticalPath(Cmd));
+    writeDriverStats(StatsOutputDir, getArgs(), SlotUsage, getJobs().size(),
+                     CriticalPath, Cache.get());
   }
+  if (JobTrace)
+    writeJobTrace(Diags, StatsOutputDir, *JobTrace, FinishedPids);
 
   if (Result == 0)
     Result = Diags.hadAnyError();
@@ -666,6 +1132,7 @@ int Compilation::performJobs() {
   if (Level < OutputLevel::Parseable &&
       (SaveTemps || TempFilePaths.empty()) &&
       CompilationRecordPath.empty() &&
+      StatsOutputDir.empty() &&
       Jobs.size() == 1) {
     return performSingleCommand(Jobs.front().get());
   }
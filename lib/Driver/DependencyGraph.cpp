@@ -16,6 +16,9 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
@@ -44,16 +47,60 @@ public:
 DependencyGraphImpl::MarkTracerImpl::MarkTracerImpl() = default;
 DependencyGraphImpl::MarkTracerImpl::~MarkTracerImpl() = default;
 
+DependencyGraphImpl::DependencyGraphImpl() = default;
+DependencyGraphImpl::~DependencyGraphImpl() = default;
+
 using LoadResult = DependencyGraphImpl::LoadResult;
 using DependencyKind = DependencyGraphImpl::DependencyKind;
 using DependencyCallbackTy = LoadResult(StringRef, DependencyKind, bool);
 using InterfaceHashCallbackTy = LoadResult(StringRef);
+using FingerprintCallbackTy = LoadResult(StringRef, DependencyKind, StringRef);
+
+/// Reads the fingerprint entries of a dependency file, which are sequences of
+/// the provided name and its fingerprint. For members, the name is again
+/// given as two strings, the mangled base name followed by the member name.
+static LoadResult
+parseFingerprints(llvm::yaml::SequenceNode *entries, DependencyKind kind,
+                  llvm::function_ref<FingerprintCallbackTy> callback) {
+  SmallString<64> scratch;
+  SmallString<64> fingerprintScratch;
+  for (llvm::yaml::Node &rawEntry : *entries) {
+    auto *entry = dyn_cast<llvm::yaml::SequenceNode>(&rawEntry);
+    if (!entry)
+      return LoadResult::HadError;
+
+    SmallVector<llvm::yaml::ScalarNode *, 3> scalars;
+    for (llvm::yaml::Node &rawScalar : *entry) {
+      auto *scalar = dyn_cast<llvm::yaml::ScalarNode>(&rawScalar);
+      if (!scalar)
+        return LoadResult::HadError;
+      scalars.push_back(scalar);
+    }
+
+    size_t expectedSize = (kind == DependencyKind::NominalTypeMember) ? 3 : 2;
+    if (scalars.size() != expectedSize)
+      return LoadResult::HadError;
+
+    SmallString<64> name;
+    name += scalars[0]->getValue(scratch);
+    if (kind == DependencyKind::NominalTypeMember) {
+      // Use the same encoding as the member dependencies themselves.
+      name.push_back('\0');
+      name += scalars[1]->getValue(scratch);
+    }
+    StringRef fingerprint = scalars.back()->getValue(fingerprintScratch);
+    if (callback(name.str(), kind, fingerprint) == LoadResult::HadError)
+      return LoadResult::HadError;
+  }
+  return LoadResult::UpToDate;
+}
 
 static LoadResult
 parseDependencyFile(llvm::MemoryBuffer &buffer,
                     llvm::function_ref<DependencyCallbackTy> providesCallback,
                     llvm::function_ref<DependencyCallbackTy> dependsCallback,
-                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback) {
+                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                    llvm::function_ref<FingerprintCallbackTy> fingerprintCallback) {
   namespace yaml = llvm::yaml;
 
   // FIXME: Switch to a format other than YAML.
@@ -105,6 +152,22 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
       StringRef valueString = value->getValue(scratch);
       UPDATE_RESULT(interfaceHashCallback(valueString));
 
+    } else if (keyString.startswith("fingerprints-")) {
+      DependencyKind kind =
+          llvm::StringSwitch<DependencyKind>(keyString)
+        .Case("fingerprints-top-level", DependencyKind::TopLevelName)
+        .Case("fingerprints-nominal", DependencyKind::NominalType)
+        .Case("fingerprints-member", DependencyKind::NominalTypeMember)
+        .Case("fingerprints-dynamic-lookup", DependencyKind::DynamicLookupName)
+        .Default(DependencyKind());
+      if (kind == DependencyKind())
+        return LoadResult::HadError;
+
+      auto *entries = dyn_cast<yaml::SequenceNode>(i->getValue());
+      if (!entries)
+        return LoadResult::HadError;
+      UPDATE_RESULT(parseFingerprints(entries, kind, fingerprintCallback));
+
     } else {
       enum class DependencyDirection : bool {
         Depends,
@@ -206,11 +269,43 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
   return result;
 }
 
+static std::array<uint8_t, 16> hashContents(StringRef data) {
+  llvm::MD5 hasher;
+  hasher.update(data);
+  llvm::MD5::MD5Result result;
+  hasher.final(result);
+
+  std::array<uint8_t, 16> hash;
+  for (size_t i = 0, e = hash.size(); i != e; ++i)
+    hash[i] = result[i];
+  return hash;
+}
+
 LoadResult DependencyGraphImpl::loadFromPath(const void *node, StringRef path) {
   auto buffer = llvm::MemoryBuffer::getFile(path);
   if (!buffer)
     return LoadResult::HadError;
-  return loadFromBuffer(node, *buffer.get());
+
+  // Reading and hashing the file is much cheaper than parsing it, so a file
+  // which is unchanged since the last snapshot is replayed from there.
+  auto contentHash = hashContents(buffer.get()->getBuffer());
+  auto known = SnapshotFiles.find(path);
+  if (known != SnapshotFiles.end() &&
+      known->getValue().contentHash == contentHash) {
+    known->getValue().wasLoaded = true;
+    return loadFromSnapshotFile(node, known->getValue());
+  }
+
+  auto &file = SnapshotFiles[path];
+  file = SnapshotFileTy();
+  LoadResult result = loadFromBuffer(node, *buffer.get(), &file);
+  if (result == LoadResult::HadError) {
+    SnapshotFiles.erase(path);
+    return result;
+  }
+  file.contentHash = contentHash;
+  file.wasLoaded = true;
+  return result;
 }
 
 LoadResult
@@ -219,74 +314,476 @@ DependencyGraphImpl::loadFromString(const void *node, StringRef data) {
   return loadFromBuffer(node, *buffer);
 }
 
-LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
-                                               llvm::MemoryBuffer &buffer) {
+StringRef DependencyGraphImpl::copySnapshotString(StringRef str) {
+  char *mem = SnapshotStrings.Allocate<char>(str.size());
+  std::uninitialized_copy(str.begin(), str.end(), mem);
+  return StringRef(mem, str.size());
+}
+
+/// Returns the key of a provided (kind, string) pair in
+/// DependencyGraphImpl::ProvidesFingerprints.
+static std::string getFingerprintKey(DependencyKind kind, StringRef name) {
+  std::string key(1, char(kind));
+  key += name;
+  return key;
+}
+
+LoadResult DependencyGraphImpl::addProvides(const void *node, StringRef name,
+                                            DependencyKind kind,
+                                            LoadStateTy &state) {
+  state.fingerprints.insert(std::make_pair(getFingerprintKey(kind, name),
+                                           std::string()));
+
   auto &provides = Provides[node];
+  auto iter = std::find_if(provides.begin(), provides.end(),
+                           [name](const ProvidesEntryTy &entry) -> bool {
+    return name == entry.name;
+  });
 
-  auto dependsCallback = [this, node](StringRef name, DependencyKind kind,
-                                      bool isCascading) -> LoadResult {
-    if (kind == DependencyKind::ExternalFile)
-      ExternalDependencies.insert(name);
+  if (iter == provides.end())
+    provides.push_back({name, kind});
+  else
+    iter->kindMask |= kind;
 
-    auto &entries = Dependencies[name];
-    auto iter = std::find_if(entries.first.begin(), entries.first.end(),
-                             [node](const DependencyEntryTy &entry) -> bool {
-      return node == entry.node;
-    });
+  return LoadResult::UpToDate;
+}
 
-    DependencyFlagsTy flags;
-    if (isCascading)
-      flags |= DependencyFlags::IsCascading;
+LoadResult DependencyGraphImpl::addDepends(const void *node, StringRef name,
+                                           DependencyKind kind,
+                                           bool isCascading,
+                                           LoadStateTy &state) {
+  if (kind == DependencyKind::ExternalFile)
+    ExternalDependencies.insert(name);
+
+  auto &entries = Dependencies[name];
+  auto iter = std::find_if(entries.first.begin(), entries.first.end(),
+                           [node](const DependencyEntryTy &entry) -> bool {
+    return node == entry.node;
+  });
+
+  DependencyFlagsTy flags;
+  if (isCascading)
+    flags |= DependencyFlags::IsCascading;
+
+  if (iter == entries.first.end()) {
+    entries.first.push_back({node, kind, flags});
+  } else {
+    iter->kindMask |= kind;
+    iter->flags |= flags;
+  }
 
-    if (iter == entries.first.end()) {
-      entries.first.push_back({node, kind, flags});
-    } else {
-      iter->kindMask |= kind;
-      iter->flags |= flags;
-    }
+  if (isCascading && (entries.second & kind)) {
+    state.dependsOnMarked = true;
+    return LoadResult::AffectsDownstream;
+  }
+  return LoadResult::UpToDate;
+}
+
+LoadResult DependencyGraphImpl::addFingerprint(StringRef name,
+                                               DependencyKind kind,
+                                               StringRef fingerprint,
+                                               LoadStateTy &state) {
+  // A fingerprint for something the file doesn't provide is meaningless.
+  auto iter = state.fingerprints.find(getFingerprintKey(kind, name));
+  if (iter != state.fingerprints.end()) {
+    iter->getValue() = fingerprint.str();
+    state.hasFingerprints = true;
+  }
+  return LoadResult::UpToDate;
+}
 
-    if (isCascading && (entries.second & kind))
-      return LoadResult::AffectsDownstream;
+LoadResult DependencyGraphImpl::updateInterfaceHash(const void *node,
+                                                    StringRef hash) {
+  auto insertResult = InterfaceHashes.insert(std::make_pair(node, hash));
+
+  if (insertResult.second) {
+    // Treat a newly-added hash as up-to-date. This includes the initial
+    // load of the file.
     return LoadResult::UpToDate;
+  }
+
+  auto iter = insertResult.first;
+  if (hash != iter->second) {
+    iter->second = hash;
+    return LoadResult::AffectsDownstream;
+  }
+
+  return LoadResult::UpToDate;
+}
+
+void DependencyGraphImpl::updateChangedProvides(const void *node,
+                                                LoadStateTy &state) {
+  ChangedProvides.erase(node);
+
+  auto previous = ProvidesFingerprints.find(node);
+  if (previous == ProvidesFingerprints.end()) {
+    // Without an earlier load there's nothing to compare against.
+    ProvidesFingerprints.insert(std::make_pair(node,
+                                               std::move(state.fingerprints)));
+    return;
+  }
+
+  // Files without fingerprints, like those written by older compilers, say
+  // nothing about what changed. And if the file picked up a change from one
+  // of its own dependencies, any part of its interface may have changed along
+  // with it.
+  if (state.hasFingerprints && !state.dependsOnMarked) {
+    ChangedKindsTy changed;
+    auto addChanged = [&changed](StringRef key) {
+      changed[key.drop_front()] |= DependencyKind(key.front());
+    };
+
+    const llvm::StringMap<std::string> &oldFingerprints = previous->second;
+    for (const auto &entry : state.fingerprints) {
+      auto old = oldFingerprints.find(entry.getKey());
+      if (old == oldFingerprints.end() || entry.getValue().empty() ||
+          old->getValue() != entry.getValue()) {
+        addChanged(entry.getKey());
+      }
+    }
+
+    // Anything which is no longer provided changed as well.
+    for (const auto &entry : oldFingerprints)
+      if (!state.fingerprints.count(entry.getKey()))
+        addChanged(entry.getKey());
+
+    ChangedProvides.insert(std::make_pair(node, std::move(changed)));
+  }
+
+  previous->second = std::move(state.fingerprints);
+}
+
+LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
+                                               llvm::MemoryBuffer &buffer,
+                                               SnapshotFileTy *record) {
+  // Make sure the node is in the graph even if the file turns out to be
+  // empty.
+  (void)Provides[node];
+  LoadStateTy state;
+
+  auto dependsCallback = [&](StringRef name, DependencyKind kind,
+                             bool isCascading) -> LoadResult {
+    if (record) {
+      record->entries.push_back({copySnapshotString(name), kind,
+                                 /*isProvides=*/false, isCascading,
+                                 StringRef()});
+    }
+    return addDepends(node, name, kind, isCascading, state);
   };
 
-  auto providesCallback =
-      [this, node, &provides](StringRef name, DependencyKind kind,
+  auto providesCallback = [&](StringRef name, DependencyKind kind,
                               bool isCascading) -> LoadResult {
     assert(isCascading);
-    auto iter = std::find_if(provides.begin(), provides.end(),
-                             [name](const ProvidesEntryTy &entry) -> bool {
-      return name == entry.name;
-    });
+    if (record) {
+      record->entries.push_back({copySnapshotString(name), kind,
+                                 /*isProvides=*/true, /*isCascading=*/true,
+                                 StringRef()});
+    }
+    return addProvides(node, name, kind, state);
+  };
 
-    if (iter == provides.end())
-      provides.push_back({name, kind});
-    else
-      iter->kindMask |= kind;
+  auto interfaceHashCallback = [&](StringRef hash) -> LoadResult {
+    if (record) {
+      record->interfaceHash = copySnapshotString(hash);
+      record->hasInterfaceHash = true;
+    }
+    return updateInterfaceHash(node, hash);
+  };
 
-    return LoadResult::UpToDate;
+  auto fingerprintCallback = [&](StringRef name, DependencyKind kind,
+                                 StringRef fingerprint) -> LoadResult {
+    if (fingerprint.empty())
+      return LoadResult::UpToDate;
+    if (record) {
+      record->entries.push_back({copySnapshotString(name), kind,
+                                 /*isProvides=*/true, /*isCascading=*/true,
+                                 copySnapshotString(fingerprint)});
+    }
+    return addFingerprint(name, kind, fingerprint, state);
   };
 
-  auto interfaceHashCallback = [this, node](StringRef hash) -> LoadResult {
-    auto insertResult = InterfaceHashes.insert(std::make_pair(node, hash));
+  LoadResult result = parseDependencyFile(buffer, providesCallback,
+                                          dependsCallback,
+                                          interfaceHashCallback,
+                                          fingerprintCallback);
+  if (result != LoadResult::HadError)
+    updateChangedProvides(node, state);
+  return result;
+}
 
-    if (insertResult.second) {
-      // Treat a newly-added hash as up-to-date. This includes the initial
-      // load of the file.
-      return LoadResult::UpToDate;
+LoadResult
+DependencyGraphImpl::loadFromSnapshotFile(const void *node,
+                                          const SnapshotFileTy &file) {
+  (void)Provides[node];
+  LoadStateTy state;
+
+  LoadResult result = LoadResult::UpToDate;
+  auto update = [&result](LoadResult entryResult) {
+    assert(entryResult != LoadResult::HadError);
+    if (entryResult == LoadResult::AffectsDownstream)
+      result = entryResult;
+  };
+
+  if (file.hasInterfaceHash)
+    update(updateInterfaceHash(node, file.interfaceHash));
+  for (const auto &entry : file.entries) {
+    if (!entry.fingerprint.empty())
+      update(addFingerprint(entry.name, entry.kind, entry.fingerprint, state));
+    else if (entry.isProvides)
+      update(addProvides(node, entry.name, entry.kind, state));
+    else
+      update(addDepends(node, entry.name, entry.kind, entry.isCascading,
+                        state));
+  }
+
+  updateChangedProvides(node, state);
+  return result;
+}
+
+//===----------------------------------------------------------------------===//
+// Snapshots
+//===----------------------------------------------------------------------===//
+//
+// A snapshot starts with a signature and a version number, followed by a
+// table of all the strings used by the files it describes. Each file then
+// refers to strings by their index in the table:
+//
+//   file     ::= path-index content-hash[16] has-interface-hash
+//                interface-hash-index num-entries entry*
+//   entry    ::= kind flags name-index fingerprint-index?
+//
+// The fingerprint index is only present if the flags say that the entry is
+// the fingerprint of a provided name.
+//
+// All integers are little-endian. Strings are stored as a 32-bit length
+// followed by the bytes of the string, which may include the NUL separating
+// the type and member names of a member dependency.
+
+static const char SnapshotSignature[] = { 'S', 'W', 'D', 'G' };
+static const uint16_t SnapshotVersion = 2;
+
+enum SnapshotEntryFlags : uint8_t {
+  SnapshotEntryIsProvides = 1 << 0,
+  SnapshotEntryIsCascading = 1 << 1,
+  SnapshotEntryIsFingerprint = 1 << 2,
+};
+
+namespace {
+/// Reads little-endian integers and strings from a snapshot, remembering
+/// whether it ever ran off the end of the data.
+class SnapshotReader {
+  StringRef Data;
+  bool HadError = false;
+
+public:
+  explicit SnapshotReader(StringRef data) : Data(data) {}
+
+  bool hadError() const { return HadError; }
+  size_t getBytesRemaining() const { return Data.size(); }
+
+  StringRef readBytes(size_t count) {
+    if (count > Data.size()) {
+      HadError = true;
+      Data = StringRef();
+      return StringRef();
     }
+    StringRef result = Data.substr(0, count);
+    Data = Data.substr(count);
+    return result;
+  }
 
-    auto iter = insertResult.first;
-    if (hash != iter->second) {
-      iter->second = hash;
-      return LoadResult::AffectsDownstream;
+  template <typename T>
+  T read() {
+    StringRef bytes = readBytes(sizeof(T));
+    if (HadError)
+      return 0;
+    using namespace llvm::support;
+    return endian::read<T, little, unaligned>(bytes.data());
+  }
+};
+} // end anonymous namespace
+
+template <typename T>
+static void writeLittleEndian(raw_ostream &out, T value) {
+  using namespace llvm::support;
+  char bytes[sizeof(T)];
+  endian::write<T, little, unaligned>(bytes, value);
+  out.write(bytes, sizeof(T));
+}
+
+static bool isValidDependencyKind(uint8_t rawKind) {
+  switch (DependencyKind(rawKind)) {
+  case DependencyKind::TopLevelName:
+  case DependencyKind::DynamicLookupName:
+  case DependencyKind::NominalType:
+  case DependencyKind::NominalTypeMember:
+  case DependencyKind::ExternalFile:
+    return true;
+  }
+  return false;
+}
+
+bool DependencyGraphImpl::loadSnapshot(StringRef path) {
+  auto bufferOrError = llvm::MemoryBuffer::getFile(path);
+  if (!bufferOrError)
+    return true;
+  std::unique_ptr<llvm::MemoryBuffer> buffer = std::move(bufferOrError.get());
+
+  SnapshotReader reader(buffer->getBuffer());
+  StringRef signature(SnapshotSignature, sizeof(SnapshotSignature));
+  if (reader.readBytes(signature.size()) != signature)
+    return true;
+  if (reader.read<uint16_t>() != SnapshotVersion)
+    return true;
+
+  // Every string takes at least four bytes, which bounds the size of the
+  // table for a truncated or garbage file.
+  uint32_t numStrings = reader.read<uint32_t>();
+  if (numStrings > reader.getBytesRemaining() / sizeof(uint32_t))
+    return true;
+  std::vector<StringRef> strings;
+  strings.reserve(numStrings);
+  for (uint32_t i = 0; i != numStrings; ++i)
+    strings.push_back(reader.readBytes(reader.read<uint32_t>()));
+
+  auto readString = [&]() -> StringRef {
+    uint32_t index = reader.read<uint32_t>();
+    if (index >= strings.size()) {
+      // Force the reader into the error state.
+      reader.readBytes(reader.getBytesRemaining() + 1);
+      return StringRef();
     }
+    return strings[index];
+  };
 
-    return LoadResult::UpToDate;
+  llvm::StringMap<SnapshotFileTy> files;
+  uint32_t numFiles = reader.read<uint32_t>();
+  for (uint32_t i = 0; i != numFiles && !reader.hadError(); ++i) {
+    StringRef filePath = readString();
+    SnapshotFileTy file;
+    StringRef contentHash = reader.readBytes(file.contentHash.size());
+    std::copy(contentHash.begin(), contentHash.end(),
+              file.contentHash.begin());
+    file.hasInterfaceHash = reader.read<uint8_t>();
+    file.interfaceHash = readString();
+
+    uint32_t numEntries = reader.read<uint32_t>();
+    if (numEntries > reader.getBytesRemaining())
+      return true;
+    file.entries.reserve(numEntries);
+    for (uint32_t j = 0; j != numEntries; ++j) {
+      uint8_t kind = reader.read<uint8_t>();
+      uint8_t flags = reader.read<uint8_t>();
+      StringRef name = readString();
+      StringRef fingerprint;
+      if (flags & SnapshotEntryIsFingerprint) {
+        fingerprint = readString();
+        if (fingerprint.empty())
+          return true;
+      }
+      if (reader.hadError() || !isValidDependencyKind(kind))
+        return true;
+      file.entries.push_back({name, DependencyKind(kind),
+                              bool(flags & SnapshotEntryIsProvides),
+                              bool(flags & SnapshotEntryIsCascading),
+                              fingerprint});
+    }
+    files[filePath] = std::move(file);
+  }
+  if (reader.hadError() || reader.getBytesRemaining() != 0)
+    return true;
+
+  // Files which have already been loaded are more up to date than the
+  // snapshot.
+  for (auto &entry : files)
+    SnapshotFiles.insert(std::make_pair(entry.getKey(),
+                                        std::move(entry.getValue())));
+  SnapshotBuffers.push_back(std::move(buffer));
+  return false;
+}
+
+bool DependencyGraphImpl::writeSnapshot(StringRef path) const {
+  llvm::StringMap<uint32_t> stringIndices;
+  std::vector<StringRef> strings;
+  auto addString = [&](StringRef str) {
+    auto insertResult = stringIndices.insert(std::make_pair(str,
+                                                            strings.size()));
+    if (insertResult.second)
+      strings.push_back(insertResult.first->getKey());
+  };
+
+  for (const auto &entry : SnapshotFiles) {
+    if (!entry.getValue().wasLoaded)
+      continue;
+    addString(entry.getKey());
+    addString(entry.getValue().interfaceHash);
+    for (const auto &fileEntry : entry.getValue().entries) {
+      addString(fileEntry.name);
+      if (!fileEntry.fingerprint.empty())
+        addString(fileEntry.fingerprint);
+    }
+  }
+
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (error) {
+    out.clear_error();
+    return true;
+  }
+
+  out.write(SnapshotSignature, sizeof(SnapshotSignature));
+  writeLittleEndian<uint16_t>(out, SnapshotVersion);
+
+  writeLittleEndian<uint32_t>(out, strings.size());
+  for (StringRef str : strings) {
+    writeLittleEndian<uint32_t>(out, str.size());
+    out << str;
+  }
+
+  auto writeString = [&](StringRef str) {
+    writeLittleEndian<uint32_t>(out, stringIndices.lookup(str));
   };
 
-  return parseDependencyFile(buffer, providesCallback, dependsCallback,
-                             interfaceHashCallback);
+  uint32_t numFiles = std::count_if(SnapshotFiles.begin(), SnapshotFiles.end(),
+                                    [](const llvm::StringMapEntry<
+                                           SnapshotFileTy> &entry) {
+    return entry.getValue().wasLoaded;
+  });
+  writeLittleEndian<uint32_t>(out, numFiles);
+
+  for (const auto &entry : SnapshotFiles) {
+    const SnapshotFileTy &file = entry.getValue();
+    if (!file.wasLoaded)
+      continue;
+    writeString(entry.getKey());
+    out.write(reinterpret_cast<const char *>(file.contentHash.data()),
+              file.contentHash.size());
+    writeLittleEndian<uint8_t>(out, file.hasInterfaceHash);
+    writeString(file.interfaceHash);
+
+    writeLittleEndian<uint32_t>(out, file.entries.size());
+    for (const auto &fileEntry : file.entries) {
+      uint8_t flags = 0;
+      if (fileEntry.isProvides)
+        flags |= SnapshotEntryIsProvides;
+      if (fileEntry.isCascading)
+        flags |= SnapshotEntryIsCascading;
+      if (!fileEntry.fingerprint.empty())
+        flags |= SnapshotEntryIsFingerprint;
+      writeLittleEndian<uint8_t>(out, uint8_t(fileEntry.kind));
+      writeLittleEndian<uint8_t>(out, flags);
+      writeString(fileEntry.name);
+      if (!fileEntry.fingerprint.empty())
+        writeString(fileEntry.fingerprint);
+    }
+  }
+
+  out.close();
+  if (out.has_error()) {
+    out.clear_error();
+    return true;
+  }
+  return false;
 }
 
 void DependencyGraphImpl::markExternal(SmallVectorImpl<const void *> &visited,
@@ -322,26 +819,37 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   SmallPtrSet<const void *, 16> visitedSet;
 
   auto addDependentsToWorklist = [&](const void *next,
-                                     ArrayRef<MarkTracerImpl::Entry> reason) {
+                                     ArrayRef<MarkTracerImpl::Entry> reason,
+                                     const ChangedKindsTy *onlyChanged) {
     auto allProvided = Provides.find(next);
     if (allProvided == Provides.end())
       return;
 
     for (const auto &provided : allProvided->second) {
+      DependencyMaskTy providedKinds = provided.kindMask;
+      if (onlyChanged) {
+        auto changedKinds = onlyChanged->find(provided.name);
+        if (changedKinds == onlyChanged->end())
+          continue;
+        providedKinds &= changedKinds->getValue();
+        if (!providedKinds)
+          continue;
+      }
+
       auto allDependents = Dependencies.find(provided.name);
       if (allDependents == Dependencies.end())
         continue;
 
-      if (allDependents->second.second.contains(provided.kindMask))
+      if (allDependents->second.second.contains(providedKinds))
         continue;
 
       // Record that we've traversed this dependency.
-      allDependents->second.second |= provided.kindMask;
+      allDependents->second.second |= providedKinds;
 
       for (const auto &dependent : allDependents->second.first) {
         if (dependent.node == next)
           continue;
-        auto intersectingKinds = provided.kindMask & dependent.kindMask;
+        auto intersectingKinds = providedKinds & dependent.kindMask;
         if (!intersectingKinds)
           continue;
         if (isMarked(dependent.node))
@@ -374,7 +882,17 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
 
   // Always mark through the starting node, even if it's already marked.
   markIntransitive(node);
-  addDependentsToWorklist(node, {});
+
+  // If the node's dependency file was just reloaded and says which of its
+  // entries changed, only the nodes depending on those have to be visited.
+  auto changed = ChangedProvides.find(node);
+  if (changed != ChangedProvides.end()) {
+    ChangedKindsTy changedKinds = std::move(changed->second);
+    ChangedProvides.erase(changed);
+    addDependentsToWorklist(node, {}, &changedKinds);
+  } else {
+    addDependentsToWorklist(node, {}, nullptr);
+  }
 
   while (!worklist.empty()) {
     auto next = worklist.pop_back_val();
@@ -386,7 +904,7 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
       continue;
     }
 
-    addDependentsToWorklist(next.Node, next.Reason);
+    addDependentsToWorklist(next.Node, next.Reason, nullptr);
     if (!markIntransitive(next.Node))
       continue;
     record(next);
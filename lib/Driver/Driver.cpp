@@ -48,6 +48,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/raw_ostream.h"
@@ -191,7 +192,10 @@ class Driver::InputInfoMap
 };
 using InputInfoMap = Driver::InputInfoMap;
 
-static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
+static bool populateOutOfDateMap(InputInfoMap &map,
+                                 llvm::StringMap<double> &jobDurations,
+                                 llvm::StringMap<std::string> &interfaceHashes,
+                                 StringRef argsHashStr,
                                  const InputFileList &inputs,
                                  StringRef buildRecordPath) {
   // Treat a missing file as "no previous build".
@@ -316,6 +320,41 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
         auto inputName = key->getValue(scratch);
         previousInputs[inputName] = { *previousBuildState, timeValue };
       }
+
+    } else if (keyStr == "job_durations") {
+      auto *durationMap = dyn_cast<yaml::MappingNode>(i->getValue());
+      if (!durationMap)
+        return true;
+
+      // The durations are only estimates; skip malformed entries.
+      for (auto i = durationMap->begin(), e = durationMap->end(); i != e;
+           ++i) {
+        auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+        auto *value = dyn_cast<yaml::ScalarNode>(i->getValue());
+        if (!key || !value)
+          continue;
+        unsigned milliseconds;
+        if (value->getValue(scratch).getAsInteger(10, milliseconds))
+          continue;
+        jobDurations[key->getValue(scratch)] = milliseconds / 1000.0;
+      }
+
+    } else if (keyStr == "external_interface_hashes") {
+      auto *hashMap = dyn_cast<yaml::MappingNode>(i->getValue());
+      if (!hashMap)
+        return true;
+
+      // Without its hash, a module is checked by its modification time
+      // alone; skip malformed entries.
+      for (auto i = hashMap->begin(), e = hashMap->end(); i != e; ++i) {
+        auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+        auto *value = dyn_cast<yaml::ScalarNode>(i->getValue());
+        if (!key || !value)
+          continue;
+        // The scratch buffer is shared by both values.
+        std::string path = key->getValue(scratch);
+        interfaceHashes[path] = value->getValue(scratch);
+      }
     }
   }
 
@@ -427,6 +466,8 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   computeArgsHash(ArgsHash, *TranslatedArgList);
 
   InputInfoMap outOfDateMap;
+  llvm::StringMap<double> previousJobDurations;
+  llvm::StringMap<std::string> previousInterfaceHashes;
   bool rebuildEverything = true;
   if (Incremental) {
     if (!OFM) {
@@ -449,7 +490,8 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
         rebuildEverything = true;
 
       } else {
-        if (populateOutOfDateMap(outOfDateMap, ArgsHash, Inputs,
+        if (populateOutOfDateMap(outOfDateMap, previousJobDurations,
+                                 previousInterfaceHashes, ArgsHash, Inputs,
                                  buildRecordPath)) {
           // FIXME: Distinguish errors from "file removed", which is benign.
         } else {
@@ -514,6 +556,19 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   if (ShowIncrementalBuildDecisions)
     C->setShowsIncrementalBuildDecisions();
 
+  if (const Arg *A = C->getArgs().getLastArg(options::OPT_stats_output_dir))
+    C->setStatsOutputDir(A->getValue(),
+                         C->getArgs().hasArg(options::OPT_trace_stats_events));
+
+  if (const Arg *A =
+        C->getArgs().getLastArg(options::OPT_driver_job_cache_path))
+    C->setJobCachePath(A->getValue());
+
+  // Only per-file compile jobs can be batched.
+  if (OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      C->getArgs().hasArg(options::OPT_enable_batch_mode))
+    C->enableBatchMode(*TC);
+
   // This has to happen after building jobs, because otherwise we won't even
   // emit .swiftdeps files for the next build.
   if (rebuildEverything)
@@ -522,6 +577,8 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   if (OFM) {
     if (auto *masterOutputMap = OFM->getOutputMapForSingleOutput()) {
       C->setCompilationRecordPath(masterOutputMap->lookup(types::TY_SwiftDeps));
+      C->setPreviousJobDurations(std::move(previousJobDurations));
+      C->setPreviousInterfaceHashes(std::move(previousInterfaceHashes));
 
       auto buildEntry = outOfDateMap.find(nullptr);
       if (buildEntry != outOfDateMap.end())
@@ -1129,6 +1186,21 @@ void Driver::buildActions(const ToolChain &TC,
   switch (OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::UpdateCode: {
+    // Precompile the bridging header once instead of parsing it again in
+    // every compile job.
+    JobAction *PCH = nullptr;
+    if (OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+        Args.hasFlag(options::OPT_enable_bridging_pch,
+                     options::OPT_disable_bridging_pch, false)) {
+      if (const Arg *A = Args.getLastArg(options::OPT_import_objc_header)) {
+        StringRef Ext = llvm::sys::path::extension(A->getValue());
+        if (TC.lookupTypeForExtension(Ext) == types::TY_ObjCHeader) {
+          PCH = new GeneratePCHJobAction(
+            new InputAction(*A, types::TY_ObjCHeader));
+        }
+      }
+    }
+
     for (const InputPair &Input : Inputs) {
       types::ID InputType = Input.first;
       const Arg *InputArg = Input.second;
@@ -1151,6 +1223,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              types::TY_LLVM_BC,
                                              previousBuildState));
+          if (PCH)
+            cast<JobAction>(Current.get())->addInput(PCH);
           AllModuleInputs.push_back(Current.get());
           Current.reset(new BackendJobAction(Current.release(),
                                              OI.CompilerOutputType, 0));
@@ -1158,6 +1232,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              OI.CompilerOutputType,
                                              previousBuildState));
+          if (PCH)
+            cast<JobAction>(Current.get())->addInput(PCH);
           AllModuleInputs.push_back(Current.get());
         }
         AllLinkerInputs.push_back(Current.release());
@@ -1190,6 +1266,7 @@ void Driver::buildActions(const ToolChain &TC,
       case types::TY_SerializedDiagnostics:
       case types::TY_ObjCHeader:
       case types::TY_ClangModuleFile:
+      case types::TY_PCH:
       case types::TY_SwiftDeps:
       case types::TY_Remapping:
         // We could in theory handle assembly or LLVM input, but let's not.
@@ -1442,6 +1519,49 @@ void Driver::buildJobs(const ActionList &Actions, const OutputInfo &OI,
   }
 }
 
+/// Computes the name of the precompiled bridging header \p header in the
+/// -pch-output-dir.
+///
+/// The name includes a hash of the contents of the header and of everything
+/// else which affects how Clang precompiles it, so that a PCH can be reused
+/// by any later compilation which would write the same one.
+static void getPersistentPCHName(SmallString<128> &out,
+                                 const DerivedArgList &args,
+                                 const OutputInfo &OI, StringRef header) {
+  llvm::MD5 hash;
+  hash.update(version::getSwiftFullVersion());
+  hash.update(header);
+  if (auto buffer = llvm::MemoryBuffer::getFile(header))
+    hash.update((*buffer)->getBuffer());
+
+  if (!args.hasArg(options::OPT_target))
+    hash.update(llvm::sys::getDefaultTargetTriple());
+  hash.update(OI.SDKPath);
+
+  for (options::ID opt : {options::OPT_target, options::OPT_target_cpu,
+                          options::OPT_I, options::OPT_F, options::OPT_Xcc,
+                          options::OPT_Xfrontend, options::OPT_resource_dir,
+                          options::OPT_module_cache_path}) {
+    for (const Arg *arg : make_range(args.filtered_begin(opt),
+                                     args.filtered_end())) {
+      hash.update(arg->getOption().getName());
+      for (const char *value : arg->getValues())
+        hash.update(value);
+    }
+  }
+
+  llvm::MD5::MD5Result hashBuf;
+  hash.final(hashBuf);
+  SmallString<32> hashStr;
+  llvm::MD5::stringifyResult(hashBuf, hashStr);
+
+  out = llvm::sys::path::stem(header);
+  out += '-';
+  out += hashStr;
+  out += '.';
+  out += PCH_EXTENSION;
+}
+
 static StringRef getOutputFilename(Compilation &C,
                                    const JobAction *JA,
                                    const OutputInfo &OI,
@@ -1497,6 +1617,17 @@ static StringRef getOutputFilename(Compilation &C,
     return Buffer.str();
   }
 
+  // A PCH is a temporary file unless it is kept for later builds.
+  if (isa<GeneratePCHJobAction>(JA)) {
+    if (const Arg *A = Args.getLastArg(options::OPT_pch_output_dir)) {
+      SmallString<128> PCHName;
+      getPersistentPCHName(PCHName, Args, OI, BaseInput);
+      Buffer = A->getValue();
+      llvm::sys::path::append(Buffer, PCHName);
+      return Buffer.str();
+    }
+  }
+
   // We don't have an output from an Action-specific command line option,
   // so figure one out using the defaults.
   if (AtTopLevel) {
@@ -1711,6 +1842,8 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
     }
     // Add an output file for each input job.
     for (const Job *job : InputJobs) {
+      if (isa<GeneratePCHJobAction>(job->getSource()))
+        continue;
       OutputFunc(job->getOutput().getBaseInput(0));
     }
   } else {
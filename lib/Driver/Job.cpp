@@ -106,3 +106,11 @@ void Job::printCommandLine(raw_ostream &os, StringRef Terminator) const {
   printArguments(os, Arguments);
   os << Terminator;
 }
+
+BatchJob::BatchJob(const JobAction &Source,
+                   std::unique_ptr<CommandOutput> Output,
+                   const char *Executable, llvm::opt::ArgStringList Arguments,
+                   ArrayRef<const Job *> Combined)
+  : Job(Source, SmallVector<const Job *, 4>(), std::move(Output), Executable,
+        std::move(Arguments)),
+    CombinedJobs(Combined.begin(), Combined.end()) {}
@@ -0,0 +1,307 @@
+//===--- JobCache.cpp - Reusing the Outputs of Earlier Jobs ---------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Driver/JobCache.h"
+
+#include "swift/Basic/FileSystem.h"
+#include "swift/Basic/Version.h"
+#include "swift/Strings.h"
+#include "swift/Driver/Action.h"
+#include "swift/Driver/Job.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift;
+using namespace swift::driver;
+
+namespace {
+  /// The output files of a job, with their types.
+  using OutputList = SmallVector<std::pair<types::ID, StringRef>, 8>;
+}
+
+/// Collects the outputs of \p Cmd. Returns false if \p Cmd has outputs
+/// which a cache entry cannot hold.
+static bool getOutputs(const Job &Cmd, OutputList &Outputs) {
+  const CommandOutput &Output = Cmd.getOutput();
+  if (Output.getPrimaryOutputType() != types::TY_Nothing) {
+    // Only the compiler in multi-threaded compilation has several primary
+    // outputs, and isn't run for single input files.
+    if (Output.getPrimaryOutputFilenames().size() != 1)
+      return false;
+    Outputs.push_back({Output.getPrimaryOutputType(),
+                       Output.getPrimaryOutputFilename()});
+  }
+  for (auto &Additional : Output.getAdditionalOutputs())
+    Outputs.push_back({Additional.first, Additional.second});
+
+  // Keep the entries independent of the order of the map.
+  std::sort(Outputs.begin(), Outputs.end());
+  return true;
+}
+
+static void stringifyHash(llvm::MD5 &Hash, SmallVectorImpl<char> &Result) {
+  llvm::MD5::MD5Result Digest;
+  Hash.final(Digest);
+  llvm::SmallString<32> Str;
+  llvm::MD5::stringifyResult(Digest, Str);
+  Result.assign(Str.begin(), Str.end());
+}
+
+/// Returns the hash of the contents of the file at \p Path, or the empty
+/// string if it cannot be read.
+static std::string getFileHash(StringRef Path) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return "";
+  llvm::MD5 Hash;
+  Hash.update(Buffer.get()->getBuffer());
+  llvm::SmallString<32> Result;
+  stringifyHash(Hash, Result);
+  return Result.str();
+}
+
+/// Parses the dependencies of the first rule of the Makefile-style
+/// dependencies file \p Contents, as written by the frontend. All of the
+/// rules of such a file have the same dependencies.
+static void parseMakeDependencies(StringRef Contents,
+                                  std::vector<std::string> &Dependencies) {
+  StringRef Line = Contents.split('\n').first;
+
+  // Skip the (escaped) target.
+  size_t Index = 0;
+  for (; Index != Line.size() && Line[Index] != ':'; ++Index)
+    if (Line[Index] == '\\')
+      ++Index;
+  if (Index >= Line.size())
+    return;
+  ++Index;
+
+  std::string Current;
+  for (; Index != Line.size(); ++Index) {
+    char C = Line[Index];
+    if (C == ' ') {
+      if (!Current.empty())
+        Dependencies.push_back(std::move(Current));
+      Current.clear();
+      continue;
+    }
+    if ((C == '\\' || C == '$') && Index + 1 != Line.size())
+      C = Line[++Index];
+    Current.push_back(C);
+  }
+  if (!Current.empty())
+    Dependencies.push_back(std::move(Current));
+}
+
+/// Writes \p Contents to \p Path by way of a temporary file.
+static void writeFileAtomically(StringRef Path, StringRef Contents) {
+  int FD;
+  llvm::SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return;
+
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path))
+    llvm::sys::fs::remove(TempPath);
+}
+
+/// Returns true if the command line argument \p Arg names a module file.
+static bool isPartialModule(StringRef Arg) {
+  StringRef Extension = llvm::sys::path::extension(Arg);
+  return !Extension.empty() &&
+         types::lookupTypeForExtension(Extension.drop_front()) ==
+           types::TY_SwiftModuleFile;
+}
+
+/// Returns true if \p Cmd merges partial modules into a module, which is
+/// a function of the partial modules and the command line alone.
+static bool isMergeModulesJob(const Job &Cmd) {
+  return isa<MergeModuleJobAction>(Cmd.getSource());
+}
+
+std::string JobCache::computeKey(
+    const Job &Cmd, llvm::function_ref<bool(StringRef)> IsTemporaryFile) const {
+  bool IsMerge = isMergeModulesJob(Cmd);
+  if (!IsMerge && !isa<CompileJobAction>(Cmd.getSource()))
+    return "";
+  if (!Cmd.getFilelistInfo().path.empty() ||
+      !Cmd.getExtraEnvironment().empty())
+    return "";
+  if (IsMerge) {
+    // A merged module embeds the contents and the modification time of the
+    // bridging header, which nothing here keeps track of.
+    for (StringRef Arg : Cmd.getArguments())
+      if (Arg == "-import-objc-header")
+        return "";
+  } else if (Cmd.getOutput().getAdditionalOutputForType(
+                 types::TY_Dependencies).empty()) {
+    return "";
+  }
+
+  OutputList Outputs;
+  if (!getOutputs(Cmd, Outputs))
+    return "";
+  llvm::StringMap<types::ID> OutputTypes;
+  for (auto &Output : Outputs)
+    OutputTypes[Output.second] = Output.first;
+
+  llvm::MD5 Hash;
+  auto addString = [&](StringRef Str) {
+    Hash.update(Str);
+    Hash.update(StringRef("\0", 1));
+  };
+
+  addString(version::getSwiftFullVersion());
+  addString(llvm::sys::path::filename(Cmd.getExecutable()));
+  // Relative paths on the command line, and the outputs themselves (for
+  // example, the compilation directory in debug info), refer to the working
+  // directory.
+  llvm::SmallString<128> WorkingDirectory;
+  if (llvm::sys::fs::current_path(WorkingDirectory))
+    return "";
+  addString(WorkingDirectory);
+
+  for (StringRef Arg : Cmd.getArguments()) {
+    auto Found = OutputTypes.find(Arg);
+    if (Found != OutputTypes.end()) {
+      addString("<output>");
+      addString(types::getTypeName(Found->second));
+    } else if (IsMerge && isPartialModule(Arg)) {
+      // The partial modules of a merge job are identified by their contents
+      // wherever they are, so that the merge is skipped when none of the
+      // files of the module changed its interface. The frontend reads the
+      // documentation next to each of them as well.
+      std::string FileHash = getFileHash(Arg);
+      if (FileHash.empty())
+        return "";
+      llvm::SmallString<128> DocPath(Arg);
+      llvm::sys::path::replace_extension(DocPath,
+                                         SERIALIZED_MODULE_DOC_EXTENSION);
+      addString("<partial-module>");
+      addString(FileHash);
+      addString(getFileHash(DocPath));
+    } else if (IsTemporaryFile(Arg)) {
+      std::string FileHash = getFileHash(Arg);
+      if (FileHash.empty())
+        return "";
+      addString("<temporary>");
+      addString(FileHash);
+    } else {
+      addString(Arg);
+    }
+  }
+
+  llvm::SmallString<32> Key;
+  stringifyHash(Hash, Key);
+  return Key.str();
+}
+
+bool JobCache::restore(const Job &Cmd, StringRef Key) {
+  llvm::SmallString<128> EntryPath(Directory);
+  llvm::sys::path::append(EntryPath, Key);
+
+  // Check that the files which the job read when the entry was recorded
+  // still have the same contents.
+  llvm::SmallString<128> ManifestPath(EntryPath);
+  llvm::sys::path::append(ManifestPath, "manifest");
+  auto Manifest = llvm::MemoryBuffer::getFile(ManifestPath);
+  if (!Manifest) {
+    ++NumMisses;
+    return false;
+  }
+  StringRef Remaining = Manifest.get()->getBuffer();
+  while (!Remaining.empty()) {
+    StringRef Line;
+    std::tie(Line, Remaining) = Remaining.split('\n');
+    if (Line.empty())
+      continue;
+    StringRef RecordedHash, Path;
+    std::tie(RecordedHash, Path) = Line.split(' ');
+    if (Path.empty() || getFileHash(Path) != RecordedHash) {
+      ++NumMisses;
+      return false;
+    }
+  }
+
+  OutputList Outputs;
+  (void)getOutputs(Cmd, Outputs);
+  for (auto &Output : Outputs) {
+    llvm::SmallString<128> StoredPath(EntryPath);
+    llvm::sys::path::append(StoredPath, types::getTypeName(Output.first));
+    if (copyFileAtomically(StoredPath, Output.second)) {
+      ++NumMisses;
+      return false;
+    }
+  }
+
+  ++NumHits;
+  return true;
+}
+
+void JobCache::store(const Job &Cmd, StringRef Key) const {
+  // All of the inputs of a merge job are part of its key already, so its
+  // manifest is empty.
+  std::vector<std::string> Paths;
+  if (!isMergeModulesJob(Cmd)) {
+    StringRef DependenciesFile =
+      Cmd.getOutput().getAdditionalOutputForType(types::TY_Dependencies);
+    auto Dependencies = llvm::MemoryBuffer::getFile(DependenciesFile);
+    if (!Dependencies)
+      return;
+    parseMakeDependencies(Dependencies.get()->getBuffer(), Paths);
+  }
+
+  std::string Manifest;
+  llvm::raw_string_ostream ManifestOut(Manifest);
+  for (StringRef Path : Paths) {
+    std::string FileHash = getFileHash(Path);
+    if (FileHash.empty())
+      return;
+    ManifestOut << FileHash << ' ' << Path << '\n';
+  }
+  ManifestOut.flush();
+
+  llvm::SmallString<128> EntryPath(Directory);
+  llvm::sys::path::append(EntryPath, Key);
+  if (llvm::sys::fs::create_directories(EntryPath))
+    return;
+
+  OutputList Outputs;
+  (void)getOutputs(Cmd, Outputs);
+  for (auto &Output : Outputs) {
+    llvm::SmallString<128> StoredPath(EntryPath);
+    llvm::sys::path::append(StoredPath, types::getTypeName(Output.first));
+    if (copyFileAtomically(Output.second, StoredPath))
+      return;
+  }
+
+  // The manifest is written last, so that an entry is only ever used once
+  // all of its outputs are there.
+  llvm::SmallString<128> ManifestPath(EntryPath);
+  llvm::sys::path::append(ManifestPath, "manifest");
+  writeFileAtomically(ManifestPath, Manifest);
+}
@@ -56,8 +56,15 @@ const TypeToPathMap *OutputFileMap::getOutputMapForSingleOutput() const {
   return getOutputMapForInput(StringRef());
 }
 
+StringRef OutputFileMap::copyPath(StringRef Path) {
+  char *Mem = PathStorage.Allocate<char>(Path.size() + 1);
+  std::uninitialized_copy(Path.begin(), Path.end(), Mem);
+  Mem[Path.size()] = '\0';
+  return StringRef(Mem, Path.size());
+}
+
 void OutputFileMap::dump(llvm::raw_ostream &os, bool Sort) const {
-  typedef std::pair<types::ID, std::string> TypePathPair;
+  typedef std::pair<types::ID, StringRef> TypePathPair;
 
   auto printOutputPair = [&os] (StringRef InputPath,
                                 const TypePathPair &OutputPair) -> void {
@@ -66,17 +73,17 @@ void OutputFileMap::dump(llvm::raw_ostream &os, bool Sort) const {
   };
 
   if (Sort) {
-    typedef std::pair<StringRef, TypeToPathMap> PathMapPair;
+    typedef std::pair<StringRef, const TypeToPathMap *> PathMapPair;
     std::vector<PathMapPair> Maps;
     for (auto &InputPair : InputToOutputsMap) {
-      Maps.emplace_back(InputPair.first(), InputPair.second);
+      Maps.emplace_back(InputPair.first(), &InputPair.second);
     }
     std::sort(Maps.begin(), Maps.end(), [] (const PathMapPair &LHS,
                                             const PathMapPair &RHS) -> bool {
       return LHS.first < RHS.first;
     });
     for (auto &InputPair : Maps) {
-      const TypeToPathMap &Map = InputPair.second;
+      const TypeToPathMap &Map = *InputPair.second;
       std::vector<TypePathPair> Pairs;
       Pairs.insert(Pairs.end(), Map.begin(), Map.end());
       std::sort(Pairs.begin(), Pairs.end());
@@ -109,6 +116,8 @@ bool OutputFileMap::parse(std::unique_ptr<llvm::MemoryBuffer> Buffer) {
   if (!Map)
     return true;
 
+  llvm::SmallString<16> KindStorage;
+  llvm::SmallString<128> Storage;
   for (auto Pair : *Map) {
     llvm::yaml::Node *Key = Pair.getKey();
     llvm::yaml::Node *Value = Pair.getValue();
@@ -142,7 +151,6 @@ bool OutputFileMap::parse(std::unique_ptr<llvm::MemoryBuffer> Buffer) {
       if (!Path)
         return true;
 
-      llvm::SmallString<16> KindStorage;
       types::ID Kind =
         types::lookupTypeForName(KindNode->getValue(KindStorage));
 
@@ -151,13 +159,10 @@ bool OutputFileMap::parse(std::unique_ptr<llvm::MemoryBuffer> Buffer) {
       if (Kind == types::TY_INVALID)
         continue;
 
-      llvm::SmallString<128> PathStorage;
-      OutputMap.insert(
-        std::pair<types::ID, std::string>(Kind, Path->getValue(PathStorage)));
+      OutputMap.insert({Kind, copyPath(Path->getValue(Storage))});
     }
 
-    llvm::SmallString<128> InputStorage;
-    InputToOutputsMap[InputPath->getValue(InputStorage)] = std::move(OutputMap);
+    InputToOutputsMap[InputPath->getValue(Storage)] = std::move(OutputMap);
   }
 
   return false;
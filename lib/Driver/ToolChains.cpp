@@ -25,6 +25,7 @@
 #include "swift/Config.h"
 #include "clang/Basic/Version.h"
 #include "clang/Driver/Util.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
@@ -120,15 +121,22 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_g_Group);
   inputArgs.AddLastArg(arguments, options::OPT_import_objc_header);
   inputArgs.AddLastArg(arguments, options::OPT_import_underlying_module);
+  inputArgs.AddLastArg(arguments, options::OPT_index_records_path);
   inputArgs.AddLastArg(arguments, options::OPT_module_cache_path);
   inputArgs.AddLastArg(arguments, options::OPT_module_link_name);
   inputArgs.AddLastArg(arguments, options::OPT_nostdimport);
   inputArgs.AddLastArg(arguments, options::OPT_parse_stdlib);
   inputArgs.AddLastArg(arguments, options::OPT_resource_dir);
+  inputArgs.AddLastArg(arguments, options::OPT_sil_optimization_cache_path);
   inputArgs.AddLastArg(arguments, options::OPT_solver_memory_threshold);
+  inputArgs.AddLastArg(arguments, options::OPT_specialization_remarks_path);
+  inputArgs.AddLastArg(arguments, options::OPT_stats_output_dir);
+  inputArgs.AddLastArg(arguments, options::OPT_trace_stats_events);
   inputArgs.AddLastArg(arguments, options::OPT_suppress_warnings);
   inputArgs.AddLastArg(arguments, options::OPT_profile_generate);
   inputArgs.AddLastArg(arguments, options::OPT_profile_coverage_mapping);
+  inputArgs.AddLastArg(arguments, options::OPT_profile_use);
+  inputArgs.AddLastArg(arguments, options::OPT_receiver_profile_use);
   inputArgs.AddLastArg(arguments, options::OPT_warnings_as_errors);
   inputArgs.AddLastArg(arguments, options::OPT_sanitize_EQ);
   inputArgs.AddLastArg(arguments, options::OPT_sanitize_coverage_EQ);
@@ -214,6 +222,7 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -239,8 +248,11 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   
   Arguments.push_back(FrontendModeOption);
 
-  assert(context.Inputs.empty() &&
-         "The Swift frontend does not expect to be fed any input Jobs!");
+  assert(std::all_of(context.Inputs.begin(), context.Inputs.end(),
+                     [](const Job *Input) {
+           return isa<GeneratePCHJobAction>(Input->getSource());
+         }) &&
+         "The Swift frontend only expects a precompiled header as input Job!");
 
   // Add input arguments.
   switch (context.OI.CompilerMode) {
@@ -299,6 +311,12 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
 
+  // Use the bridging header precompiled by an earlier job.
+  for (const Job *PCH : context.Inputs) {
+    Arguments.push_back("-import-objc-pch");
+    Arguments.push_back(PCH->getOutput().getPrimaryOutputFilename().c_str());
+  }
+
   // Pass the optimization level down to the frontend.
   context.Args.AddLastArg(Arguments, options::OPT_O_Group);
 
@@ -386,6 +404,146 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   return II;
 }
 
+/// Returns the value of the -primary-file option of a compile job's
+/// arguments, or null if there is not exactly one.
+static const char *getSinglePrimaryFileArgument(const ArgStringList &args) {
+  const char *primaryFile = nullptr;
+  for (size_t i = 0, e = args.size(); i + 1 < e; ++i) {
+    if (StringRef(args[i]) != "-primary-file")
+      continue;
+    if (primaryFile)
+      return nullptr;
+    primaryFile = args[i + 1];
+  }
+  return primaryFile;
+}
+
+bool ToolChain::jobIsBatchable(const Job *J) const {
+  // A precompiled bridging header is shared by all compile jobs, so it does
+  // not prevent them from being batched.
+  if (!isa<CompileJobAction>(J->getSource()) ||
+      !std::all_of(J->getInputs().begin(), J->getInputs().end(),
+                   [](const Job *Input) {
+        return isa<GeneratePCHJobAction>(Input->getSource());
+      }))
+    return false;
+
+  // The job must compile a single primary file into a single output, which
+  // is passed with -o rather than in a filelist.
+  const CommandOutput &output = J->getOutput();
+  if (output.getPrimaryOutputFilenames().size() != 1 ||
+      !J->getFilelistInfo().path.empty() ||
+      !getSinglePrimaryFileArgument(J->getArguments()))
+    return false;
+
+  // The frontend can only produce these outputs for every primary file of a
+  // batch if each of them gets its own path.
+  for (types::ID perJobType : {types::TY_SerializedDiagnostics,
+                               types::TY_ObjCHeader,
+                               types::TY_Remapping}) {
+    if (!output.getAdditionalOutputForType(perJobType).empty())
+      return false;
+  }
+  return true;
+}
+
+std::unique_ptr<BatchJob>
+ToolChain::constructBatchJob(ArrayRef<const Job *> Jobs) const {
+  assert(Jobs.size() > 1 && "batching a single job");
+
+  // The arguments of jobs from the same compilation only differ in the
+  // primary file and the per-file outputs, so start from the first job's
+  // arguments and give all the per-file values from each job in turn.
+  const Job *First = Jobs.front();
+  const ArgStringList &FirstArgs = First->getArguments();
+
+  // In the plain input list every input argument appears in every job's
+  // arguments, so the other primary files can be found by identity.
+  llvm::SmallPtrSet<const char *, 16> PrimaryFiles;
+  SmallVector<const char *, 16> PrimaryFileOrder;
+  for (const Job *J : Jobs) {
+    assert(jobIsBatchable(J) && J->getExecutable() == First->getExecutable());
+    const char *PrimaryFile = getSinglePrimaryFileArgument(J->getArguments());
+    PrimaryFiles.insert(PrimaryFile);
+    PrimaryFileOrder.push_back(PrimaryFile);
+  }
+  bool UsesFilelist = std::find_if(FirstArgs.begin(), FirstArgs.end(),
+                                   [](const char *Arg) {
+    return StringRef(Arg) == "-filelist";
+  }) != FirstArgs.end();
+
+  const std::pair<StringRef, types::ID> PerFileOutputOptions[] = {
+    {"-emit-module-path", types::TY_SwiftModuleFile},
+    {"-emit-module-doc-path", types::TY_SwiftModuleDocFile},
+    {"-emit-dependencies-path", types::TY_Dependencies},
+    {"-emit-reference-dependencies-path", types::TY_SwiftDeps},
+  };
+
+  ArgStringList Arguments;
+  for (size_t i = 0, e = FirstArgs.size(); i != e; ++i) {
+    StringRef Arg = FirstArgs[i];
+
+    if (Arg == "-primary-file") {
+      ++i;
+      if (UsesFilelist) {
+        for (const char *PrimaryFile : PrimaryFileOrder) {
+          Arguments.push_back("-primary-file");
+          Arguments.push_back(PrimaryFile);
+        }
+      } else {
+        Arguments.push_back("-primary-file");
+        Arguments.push_back(FirstArgs[i]);
+      }
+      continue;
+    }
+
+    if (!UsesFilelist && PrimaryFiles.count(FirstArgs[i])) {
+      Arguments.push_back("-primary-file");
+      Arguments.push_back(FirstArgs[i]);
+      continue;
+    }
+
+    if (Arg == "-o" && i + 1 != e) {
+      ++i;
+      for (const Job *J : Jobs) {
+        Arguments.push_back("-o");
+        Arguments.push_back(
+          J->getOutput().getPrimaryOutputFilename().c_str());
+      }
+      continue;
+    }
+
+    auto PerFileOption =
+      std::find_if(std::begin(PerFileOutputOptions),
+                   std::end(PerFileOutputOptions),
+                   [&](const std::pair<StringRef, types::ID> &Entry) {
+      return Entry.first == Arg;
+    });
+    if (PerFileOption != std::end(PerFileOutputOptions) && i + 1 != e) {
+      ++i;
+      for (const Job *J : Jobs) {
+        Arguments.push_back(FirstArgs[i - 1]);
+        Arguments.push_back(J->getOutput().getAdditionalOutputForType(
+          PerFileOption->second).c_str());
+      }
+      continue;
+    }
+
+    Arguments.push_back(FirstArgs[i]);
+  }
+
+  std::unique_ptr<CommandOutput> Output(
+    new CommandOutput(First->getOutput().getPrimaryOutputType()));
+  for (const Job *J : Jobs) {
+    Output->addPrimaryOutput(J->getOutput().getPrimaryOutputFilename(),
+                             J->getOutput().getBaseInput(0));
+  }
+
+  return std::unique_ptr<BatchJob>(
+    new BatchJob(First->getSource(), std::move(Output),
+                 First->getExecutable(), std::move(Arguments), Jobs));
+}
+
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const InterpretJobAction &job,
                                const JobContext &context) const {
@@ -412,6 +570,7 @@ ToolChain::constructInvocation(const InterpretJobAction &job,
   context.Args.AddLastArg(Arguments, options::OPT_O_Group);
 
   context.Args.AddLastArg(Arguments, options::OPT_parse_sil);
+  context.Args.AddLastArg(Arguments, options::OPT_immediate_cache_path);
 
   Arguments.push_back("-module-name");
   Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
@@ -471,6 +630,7 @@ ToolChain::constructInvocation(const BackendJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -708,6 +868,30 @@ ToolChain::constructInvocation(const GenerateDSYMJobAction &job,
   return {"dsymutil", Arguments};
 }
 
+ToolChain::InvocationInfo
+ToolChain::constructInvocation(const GeneratePCHJobAction &job,
+                               const JobContext &context) const {
+  assert(context.Inputs.empty());
+  assert(context.InputActions.size() == 1);
+  assert(context.Output.getPrimaryOutputType() == types::TY_PCH);
+
+  ArgStringList Arguments;
+
+  Arguments.push_back("-frontend");
+  Arguments.push_back("-emit-pch");
+
+  addInputsOfType(Arguments, context.InputActions, types::TY_ObjCHeader);
+
+  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
+                        Arguments);
+
+  Arguments.push_back("-o");
+  Arguments.push_back(
+      context.Args.MakeArgString(context.Output.getPrimaryOutputFilename()));
+
+  return {SWIFT_EXECUTABLE_NAME, Arguments};
+}
+
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const AutolinkExtractJobAction &job,
                                const JobContext &context) const {
@@ -18,6 +18,7 @@
 #include "swift/Option/Options.h"
 #include "swift/Option/SanitizerOptions.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
@@ -94,14 +95,18 @@ static void debugFailWithCrash() {
 
 /// Try to read a file list file.
 ///
+/// If \p primaryFileArgs is not empty, the index of each primary file in the
+/// list is appended to \p primaryFileIndices, in the same order.
+///
 /// Returns false on error.
 static bool readFileList(DiagnosticEngine &diags,
                          std::vector<std::string> &inputFiles,
                          const llvm::opt::Arg *filelistPath,
-                         const llvm::opt::Arg *primaryFileArg = nullptr,
-                         unsigned *primaryFileIndex = nullptr) {
-  assert((primaryFileArg == nullptr) || (primaryFileIndex != nullptr) &&
-         "did not provide argument for primary file index");
+                         ArrayRef<const llvm::opt::Arg *> primaryFileArgs = {},
+                         SmallVectorImpl<unsigned> *primaryFileIndices =
+                           nullptr) {
+  assert((primaryFileArgs.empty() || primaryFileIndices != nullptr) &&
+         "did not provide argument for primary file indices");
 
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
       llvm::MemoryBuffer::getFile(filelistPath->getValue());
@@ -111,29 +116,146 @@ static bool readFileList(DiagnosticEngine &diags,
     return false;
   }
 
-  bool foundPrimaryFile = false;
-  if (primaryFileIndex) *primaryFileIndex = 0;
-
+  // Remember where each file first appears, so that primary files can be
+  // looked up without rescanning the list for each of them.
+  llvm::StringMap<unsigned> firstIndexOfFile;
   for (StringRef line : make_range(llvm::line_iterator(*buffer.get()), {})) {
+    if (!primaryFileArgs.empty())
+      firstIndexOfFile.insert({line, unsigned(inputFiles.size())});
     inputFiles.push_back(line);
-
-    if (foundPrimaryFile || primaryFileArg == nullptr)
-      continue;
-    if (line == primaryFileArg->getValue())
-      foundPrimaryFile = true;
-    else
-      ++*primaryFileIndex;
   }
 
-  if (primaryFileArg && !foundPrimaryFile) {
-    diags.diagnose(SourceLoc(), diag::error_primary_file_not_found,
-                   primaryFileArg->getValue(), filelistPath->getValue());
-    return false;
+  for (const llvm::opt::Arg *primaryFileArg : primaryFileArgs) {
+    auto found = firstIndexOfFile.find(primaryFileArg->getValue());
+    if (found == firstIndexOfFile.end()) {
+      diags.diagnose(SourceLoc(), diag::error_primary_file_not_found,
+                     primaryFileArg->getValue(), filelistPath->getValue());
+      return false;
+    }
+    primaryFileIndices->push_back(found->second);
   }
 
   return true;
 }
 
+/// Sets up FrontendOptions::BatchPrimaryInputs for a job with several
+/// -primary-file inputs.
+///
+/// Each primary file gets its own outputs, so -o and the paths of the
+/// per-file supplementary outputs have to be given once for each primary
+/// file, and are matched up with the primary files by position. Outputs which
+/// describe the whole job rather than a single file are not supported.
+///
+/// Returns true on error.
+static bool parseBatchPrimaryInputs(FrontendOptions &Opts, ArgList &Args,
+                                    DiagnosticEngine &Diags,
+                                    ArrayRef<unsigned> PrimaryIndices) {
+  using namespace options;
+
+  switch (Opts.RequestedAction) {
+  case FrontendOptions::NoneAction:
+  case FrontendOptions::DumpParse:
+  case FrontendOptions::DumpInterfaceHash:
+  case FrontendOptions::DumpAST:
+  case FrontendOptions::PrintAST:
+  case FrontendOptions::DumpTypeRefinementContexts:
+  case FrontendOptions::EmitPCH:
+  case FrontendOptions::Immediate:
+  case FrontendOptions::REPL:
+    Diags.diagnose(SourceLoc(), diag::error_mode_cannot_batch);
+    return true;
+  case FrontendOptions::Parse:
+  case FrontendOptions::EmitModuleOnly:
+  case FrontendOptions::EmitSILGen:
+  case FrontendOptions::EmitSIL:
+  case FrontendOptions::EmitSIBGen:
+  case FrontendOptions::EmitSIB:
+  case FrontendOptions::EmitIR:
+  case FrontendOptions::EmitBC:
+  case FrontendOptions::EmitAssembly:
+  case FrontendOptions::EmitObject:
+    break;
+  }
+
+  if (const Arg *A = Args.getLastArg(OPT_serialize_diagnostics,
+                                     OPT_serialize_diagnostics_path,
+                                     OPT_emit_objc_header,
+                                     OPT_emit_objc_header_path,
+                                     OPT_emit_fixits_path)) {
+    Diags.diagnose(SourceLoc(), diag::error_batch_mode_unsupported_option,
+                   A->getSpelling());
+    return true;
+  }
+
+  unsigned NumPrimaries = PrimaryIndices.size();
+  if (Opts.actionHasOutput() && Opts.OutputFilenames.size() != NumPrimaries) {
+    Diags.diagnose(SourceLoc(), diag::error_batch_mode_output_count, "-o",
+                   Opts.OutputFilenames.size(), NumPrimaries);
+    return true;
+  }
+
+  // Collects the per-file paths for one kind of supplementary output. If the
+  // output was requested without explicit paths, it can only be written when
+  // it is the main output of the job.
+  auto getPerFilePaths = [&](std::vector<std::string> &paths,
+                             OptSpecifier optWithPath,
+                             const std::string &singlePath,
+                             StringRef optName) -> bool {
+    paths = Args.getAllArgValues(optWithPath);
+    if (paths.empty() && !singlePath.empty()) {
+      if (singlePath != Opts.getSingleOutputFilename()) {
+        Diags.diagnose(SourceLoc(), diag::error_batch_mode_output_count,
+                       optName, 0, NumPrimaries);
+        return true;
+      }
+      paths = Opts.OutputFilenames;
+    }
+    if (!paths.empty() && paths.size() != NumPrimaries) {
+      Diags.diagnose(SourceLoc(), diag::error_batch_mode_output_count,
+                     optName, paths.size(), NumPrimaries);
+      return true;
+    }
+    return false;
+  };
+
+  std::vector<std::string> ModulePaths, ModuleDocPaths, DependenciesPaths,
+                           ReferenceDependenciesPaths;
+  if (getPerFilePaths(ModulePaths, OPT_emit_module_path,
+                      Opts.ModuleOutputPath, "-emit-module-path") ||
+      getPerFilePaths(ModuleDocPaths, OPT_emit_module_doc_path,
+                      Opts.ModuleDocOutputPath, "-emit-module-doc-path") ||
+      getPerFilePaths(DependenciesPaths, OPT_emit_dependencies_path,
+                      Opts.DependenciesFilePath, "-emit-dependencies-path") ||
+      getPerFilePaths(ReferenceDependenciesPaths,
+                      OPT_emit_reference_dependencies_path,
+                      Opts.ReferenceDependenciesFilePath,
+                      "-emit-reference-dependencies-path"))
+    return true;
+
+  for (unsigned i = 0; i != NumPrimaries; ++i) {
+    BatchPrimaryInput Primary{SelectedInput(PrimaryIndices[i])};
+    if (Opts.actionHasOutput())
+      Primary.OutputFilename = Opts.OutputFilenames[i];
+    if (!ModulePaths.empty())
+      Primary.ModuleOutputPath = ModulePaths[i];
+    if (!ModuleDocPaths.empty())
+      Primary.ModuleDocOutputPath = ModuleDocPaths[i];
+    if (!DependenciesPaths.empty())
+      Primary.DependenciesFilePath = DependenciesPaths[i];
+    if (!ReferenceDependenciesPaths.empty())
+      Primary.ReferenceDependenciesFilePath = ReferenceDependenciesPaths[i];
+    Opts.BatchPrimaryInputs.push_back(std::move(Primary));
+  }
+
+  // The singular paths describe the first primary file, like PrimaryInput.
+  const BatchPrimaryInput &First = Opts.BatchPrimaryInputs.front();
+  Opts.ModuleOutputPath = First.ModuleOutputPath;
+  Opts.ModuleDocOutputPath = First.ModuleDocOutputPath;
+  Opts.DependenciesFilePath = First.DependenciesFilePath;
+  Opts.ReferenceDependenciesFilePath = First.ReferenceDependenciesFilePath;
+  return false;
+}
+
 static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
                               DiagnosticEngine &Diags) {
   using namespace options;
@@ -167,13 +289,34 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.EmitSortedSIL |= Args.hasArg(OPT_emit_sorted_sil);
 
   Opts.DelayedFunctionBodyParsing |= Args.hasArg(OPT_delayed_function_body_parsing);
+  if (Args.hasArg(OPT_parse_non_primary_function_bodies))
+    Opts.SkipNonPrimaryFunctionBodies = false;
+  Opts.SkipNonInlinableFunctionBodies |=
+    Args.hasArg(OPT_experimental_skip_non_inlinable_function_bodies);
   Opts.EnableTesting |= Args.hasArg(OPT_enable_testing);
   Opts.EnableResilience |= Args.hasArg(OPT_enable_resilience);
+  if (const Arg *A = Args.getLastArg(OPT_resilience_domain))
+    Opts.ResilienceDomain = A->getValue();
 
   Opts.PrintStats |= Args.hasArg(OPT_print_stats);
   Opts.PrintClangStats |= Args.hasArg(OPT_print_clang_stats);
   Opts.DebugTimeFunctionBodies |= Args.hasArg(OPT_debug_time_function_bodies);
+  Opts.DebugTimeExpressionTypeChecking |=
+    Args.hasArg(OPT_debug_time_expression_type_checking);
   Opts.DebugTimeCompilation |= Args.hasArg(OPT_debug_time_compilation);
+  if (const Arg *A = Args.getLastArg(OPT_stats_output_dir)) {
+    Opts.StatsOutputDir = A->getValue();
+  }
+  Opts.TraceStatsEvents |= Args.hasArg(OPT_trace_stats_events);
+  if (const Arg *A = Args.getLastArg(OPT_sil_optimization_cache_path)) {
+    Opts.SILOptimizationCachePath = A->getValue();
+  }
+  if (const Arg *A = Args.getLastArg(OPT_immediate_cache_path)) {
+    Opts.ImmediateCachePath = A->getValue();
+  }
+  if (const Arg *A = Args.getLastArg(OPT_index_records_path)) {
+    Opts.IndexRecordsPath = A->getValue();
+  }
 
   if (const Arg *A = Args.getLastArg(OPT_warn_long_function_bodies)) {
     unsigned attempt;
@@ -185,6 +328,16 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_warn_long_expression_type_checking)) {
+    unsigned attempt;
+    if (StringRef(A->getValue()).getAsInteger(10, attempt)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+    } else {
+      Opts.WarnLongExpressionTypeChecking = attempt;
+    }
+  }
+
   Opts.PlaygroundTransform |= Args.hasArg(OPT_playground);
   if (Args.hasArg(OPT_disable_playground_transform))
     Opts.PlaygroundTransform = false;
@@ -201,13 +354,14 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  // The indices of all -primary-file inputs, in command-line order. There is
+  // more than one for a batch-mode job.
+  SmallVector<unsigned, 1> PrimaryIndices;
   if (const Arg *A = Args.getLastArg(OPT_filelist)) {
-    const Arg *primaryFileArg = Args.getLastArg(OPT_primary_file);
-    unsigned primaryFileIndex = 0;
+    SmallVector<const Arg *, 1> primaryFileArgs(
+      Args.filtered_begin(OPT_primary_file), Args.filtered_end());
     if (readFileList(Diags, Opts.InputFilenames, A,
-                     primaryFileArg, &primaryFileIndex)) {
-      if (primaryFileArg)
-        Opts.PrimaryInput = SelectedInput(primaryFileIndex);
+                     primaryFileArgs, &PrimaryIndices)) {
       assert(!Args.hasArg(OPT_INPUT) && "mixing -filelist with inputs");
     }
   } else {
@@ -217,13 +371,15 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       if (A->getOption().matches(OPT_INPUT)) {
         Opts.InputFilenames.push_back(A->getValue());
       } else if (A->getOption().matches(OPT_primary_file)) {
-        Opts.PrimaryInput = SelectedInput(Opts.InputFilenames.size());
+        PrimaryIndices.push_back(Opts.InputFilenames.size());
         Opts.InputFilenames.push_back(A->getValue());
       } else {
         llvm_unreachable("Unknown input-related argument!");
       }
     }
   }
+  if (!PrimaryIndices.empty())
+    Opts.PrimaryInput = SelectedInput(PrimaryIndices.front());
 
   Opts.ParseStdlib |= Args.hasArg(OPT_parse_stdlib);
 
@@ -264,6 +420,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Action = FrontendOptions::REPL;
     } else if (Opt.matches(OPT_interpret)) {
       Action = FrontendOptions::Immediate;
+    } else if (Opt.matches(OPT_emit_pch)) {
+      Action = FrontendOptions::EmitPCH;
     } else {
       llvm_unreachable("Unhandled mode option");
     }
@@ -438,6 +596,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Opts.setSingleOutputFilename("-");
       break;
 
+    case FrontendOptions::EmitPCH:
+      Suffix = PCH_EXTENSION;
+      break;
+
     case FrontendOptions::EmitSILGen:
     case FrontendOptions::EmitSIL: {
       if (Opts.OutputFilenames.empty())
@@ -615,6 +777,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
                           SERIALIZED_MODULE_DOC_EXTENSION,
                           false);
 
+  if (PrimaryIndices.size() > 1 &&
+      parseBatchPrimaryInputs(Opts, Args, Diags, PrimaryIndices))
+    return true;
+
   if (!Opts.DependenciesFilePath.empty()) {
     switch (Opts.RequestedAction) {
     case FrontendOptions::NoneAction:
@@ -623,6 +789,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_dependencies);
@@ -649,6 +816,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_header);
@@ -677,6 +845,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::EmitSILGen:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
@@ -740,6 +909,9 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
   Opts.EnableExperimentalPropertyBehaviors |=
     Args.hasArg(OPT_enable_experimental_property_behaviors);
 
+  Opts.NamedLazyMemberLoading |=
+    Args.hasArg(OPT_enable_named_lazy_member_loading);
+
   Opts.DisableAvailabilityChecking |=
       Args.hasArg(OPT_disable_availability_checking);
   
@@ -890,6 +1062,9 @@ static bool ParseClangImporterArgs(ClangImporterOptions &Opts,
 
   Opts.DisableSwiftBridgeAttr |= Args.hasArg(OPT_disable_swift_bridge_attr);
 
+  if (const Arg *A = Args.getLastArg(OPT_import_objc_pch))
+    Opts.PrecompiledBridgingHeader = A->getValue();
+
   return false;
 }
 
@@ -1069,6 +1244,10 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
   Opts.EnableARCOptimizations |= !Args.hasArg(OPT_disable_arc_opts);
   Opts.DisableSILPerfOptimizations |= Args.hasArg(OPT_disable_sil_perf_optzns);
   Opts.VerifyAll |= Args.hasArg(OPT_sil_verify_all);
+  Opts.ParallelFunctionPasses |= Args.hasArg(OPT_sil_parallel_function_passes);
+  Opts.PassStatsPerFunction |= Args.hasArg(OPT_sil_pass_stats_per_function);
+  Opts.PassStats |= Args.hasArg(OPT_sil_pass_stats) ||
+                    Opts.PassStatsPerFunction;
   Opts.DebugSerialization |= Args.hasArg(OPT_sil_debug_serialization);
   Opts.EmitVerboseSIL |= Args.hasArg(OPT_emit_verbose_sil);
   Opts.PrintInstCounts |= Args.hasArg(OPT_print_inst_counts);
@@ -1077,6 +1256,12 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
   Opts.EmitProfileCoverageMapping |= Args.hasArg(OPT_profile_coverage_mapping);
+  if (const Arg *A = Args.getLastArg(OPT_profile_use))
+    Opts.UseProfile = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_receiver_profile_use))
+    Opts.UseReceiverProfile = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_specialization_remarks_path))
+    Opts.SpecializationRemarksPath = A->getValue();
   Opts.EnableGuaranteedClosureContexts |=
     Args.hasArg(OPT_enable_guaranteed_closure_contexts);
 
@@ -1229,6 +1414,13 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
   Opts.PrintInlineTree |= Args.hasArg(OPT_print_llvm_inline_tree);
 
   Opts.UseSwiftCall = Args.hasArg(OPT_enable_swiftcall);
+  Opts.UseLayoutValueWitnesses =
+    Args.hasArg(OPT_enable_layout_value_witnesses);
+  Opts.UseOutlinedValueOperations =
+    Args.hasArg(OPT_enable_outlined_value_operations);
+  Opts.ReleaseSILFunctionBodies |= Args.hasArg(OPT_release_sil_after_irgen);
+  Opts.StripUnusedConformanceRecords =
+    Args.hasArg(OPT_strip_unused_conformance_records);
 
   // This is set to true by default.
   Opts.UseIncrementalLLVMCodeGen &=
@@ -45,11 +45,41 @@ void CompilerInstance::createSILModule(bool WholeModule) {
 void CompilerInstance::setPrimarySourceFile(SourceFile *SF) {
   assert(SF);
   assert(MainModule && "main module not created yet");
-  assert(!PrimarySourceFile && "already has a primary source file");
-  assert(PrimaryBufferID == NO_SUCH_BUFFER || !SF->getBufferID().hasValue() ||
-         SF->getBufferID().getValue() == PrimaryBufferID);
-  PrimarySourceFile = SF;
-  PrimarySourceFile->setReferencedNameTracker(NameTracker);
+
+  unsigned Index = 0;
+  if (SF->getBufferID().hasValue()) {
+    auto Found = std::find(PrimaryBufferIDs.begin(), PrimaryBufferIDs.end(),
+                           SF->getBufferID().getValue());
+    assert((Found != PrimaryBufferIDs.end() || !hasPrimaryBuffers()) &&
+           "not a primary buffer");
+    if (Found != PrimaryBufferIDs.end())
+      Index = Found - PrimaryBufferIDs.begin();
+  }
+
+  if (PrimarySourceFiles.size() <= Index)
+    PrimarySourceFiles.resize(Index + 1);
+  assert(!PrimarySourceFiles[Index] && "already has a primary source file");
+  PrimarySourceFiles[Index] = SF;
+  if (Index < NameTrackers.size())
+    SF->setReferencedNameTracker(NameTrackers[Index]);
+}
+
+bool CompilerInstance::hasPrimaryBuffers() const {
+  return std::any_of(PrimaryBufferIDs.begin(), PrimaryBufferIDs.end(),
+                     [](unsigned BufferID) {
+    return BufferID != NO_SUCH_BUFFER;
+  });
+}
+
+bool CompilerInstance::isPrimaryBuffer(unsigned BufferID) const {
+  return BufferID != NO_SUCH_BUFFER &&
+         std::find(PrimaryBufferIDs.begin(), PrimaryBufferIDs.end(),
+                   BufferID) != PrimaryBufferIDs.end();
+}
+
+bool CompilerInstance::isPrimarySourceFile(const SourceFile *SF) const {
+  return std::find(PrimarySourceFiles.begin(), PrimarySourceFiles.end(),
+                   SF) != PrimarySourceFiles.end();
 }
 
 bool CompilerInstance::setup(const CompilerInvocation &Invok) {
@@ -94,7 +124,8 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
                                                   DepTracker));
   }
   
-  auto SML = SerializedModuleLoader::create(*Context, DepTracker);
+  auto SML = SerializedModuleLoader::create(*Context, DepTracker,
+                                            SharedModuleBuffers);
   this->SML = SML.get();
   Context->addModuleLoader(std::move(SML));
 
@@ -130,8 +161,23 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   if (SILMode)
     Invocation.getLangOptions().EnableAccessControl = false;
 
-  const Optional<SelectedInput> &PrimaryInput =
-    Invocation.getFrontendOptions().PrimaryInput;
+  // Collect the primary inputs in the order of the -primary-file options.
+  const FrontendOptions &FrontendOpts = Invocation.getFrontendOptions();
+  SmallVector<SelectedInput, 1> PrimaryInputs;
+  if (FrontendOpts.isBatchMode()) {
+    for (auto &Primary : FrontendOpts.BatchPrimaryInputs)
+      PrimaryInputs.push_back(Primary.Input);
+  } else if (FrontendOpts.PrimaryInput) {
+    PrimaryInputs.push_back(*FrontendOpts.PrimaryInput);
+  }
+  PrimaryBufferIDs.assign(PrimaryInputs.size(), NO_SUCH_BUFFER);
+
+  auto recordIfPrimary = [&](SelectedInput::InputKind Kind, unsigned Index,
+                             unsigned BufferID) {
+    for (unsigned i = 0, e = PrimaryInputs.size(); i != e; ++i)
+      if (PrimaryInputs[i].Kind == Kind && PrimaryInputs[i].Index == Index)
+        PrimaryBufferIDs[i] = BufferID;
+  };
 
   // Add the memory buffers first, these will be associated with a filename
   // and they can replace the contents of an input filename.
@@ -150,8 +196,7 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
       if (SILMode)
         MainBufferID = BufferID;
 
-      if (PrimaryInput && PrimaryInput->isBuffer() && PrimaryInput->Index == i)
-        PrimaryBufferID = BufferID;
+      recordIfPrimary(SelectedInput::InputKind::Buffer, i, BufferID);
     }
   }
 
@@ -166,9 +211,8 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
       if (SILMode || (MainMode && filename(File) == "main.swift"))
         MainBufferID = ExistingBufferID.getValue();
 
-      if (PrimaryInput && PrimaryInput->isFilename() &&
-          PrimaryInput->Index == i)
-        PrimaryBufferID = ExistingBufferID.getValue();
+      recordIfPrimary(SelectedInput::InputKind::Filename, i,
+                      ExistingBufferID.getValue());
 
       continue; // replaced by a memory buffer.
     }
@@ -209,13 +253,12 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
     if (SILMode || (MainMode && filename(File) == "main.swift"))
       MainBufferID = BufferID;
 
-    if (PrimaryInput && PrimaryInput->isFilename() && PrimaryInput->Index == i)
-      PrimaryBufferID = BufferID;
+    recordIfPrimary(SelectedInput::InputKind::Filename, i, BufferID);
   }
 
   // Set the primary file to the code-completion point if one exists.
   if (CodeCompletionBufferID.hasValue())
-    PrimaryBufferID = *CodeCompletionBufferID;
+    PrimaryBufferIDs.assign(1, *CodeCompletionBufferID);
 
   if (MainMode && MainBufferID == NO_SUCH_BUFFER && BufferIDs.size() == 1)
     MainBufferID = BufferIDs.front();
@@ -234,6 +277,10 @@ Module *CompilerInstance::getMainModule() {
       MainModule->setResilienceStrategy(ResilienceStrategy::Resilient);
     else if (Invocation.getFrontendOptions().SILSerializeAll)
       MainModule->setResilienceStrategy(ResilienceStrategy::Fragile);
+
+    StringRef Domain = Invocation.getFrontendOptions().ResilienceDomain;
+    if (!Domain.empty())
+      MainModule->setResilienceDomain(Context->getIdentifier(Domain));
   }
   return MainModule;
 }
@@ -379,10 +426,27 @@ void CompilerInstance::performSema() {
   if (Invocation.isCodeCompletion()) {
     DelayedCB.reset(
         new CodeCompleteDelayedCallbacks(SourceMgr.getCodeCompletionLoc()));
+  } else if (Invocation.hasFocusedFunctionBody() &&
+             PrimaryBufferIDs.size() == 1) {
+    DelayedCB.reset(new FocusedFunctionBodyDelayedCallbacks(
+        SourceMgr.getLocForOffset(PrimaryBufferIDs.front(),
+                                  Invocation.getFocusedFunctionBodyOffset())));
   } else if (Invocation.isDelayedFunctionBodyParsing()) {
     DelayedCB.reset(new AlwaysDelayedCallbacks);
   }
 
+  // Only the declarations of files which are not primary files are needed.
+  Optional<NonPrimaryFunctionBodyCallbacks> NonPrimaryBodyCB;
+  if (hasPrimaryBuffers() && !Invocation.isCodeCompletion() &&
+      options.SkipNonPrimaryFunctionBodies)
+    NonPrimaryBodyCB.emplace();
+  auto getSkippedBodyCB =
+      [&](unsigned BufferID) -> SkippedFunctionBodyCallbacks * {
+    if (!NonPrimaryBodyCB || isPrimaryBuffer(BufferID))
+      return nullptr;
+    return NonPrimaryBodyCB.getPointer();
+  };
+
   PersistentParserState PersistentState;
 
   // Make sure the main file is the first file in the module. This may only be
@@ -401,7 +465,7 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*MainFile);
     addAdditionalInitialImports(MainFile);
 
-    if (MainBufferID == PrimaryBufferID)
+    if (isPrimaryBuffer(MainBufferID))
       setPrimarySourceFile(MainFile);
   }
 
@@ -427,13 +491,12 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*NextInput);
     addAdditionalInitialImports(NextInput);
 
-    if (BufferID == PrimaryBufferID)
+    if (isPrimaryBuffer(BufferID))
       setPrimarySourceFile(NextInput);
 
     auto &Diags = NextInput->getASTContext().Diags;
     auto DidSuppressWarnings = Diags.getSuppressWarnings();
-    auto IsPrimary
-      = PrimaryBufferID == NO_SUCH_BUFFER || BufferID == PrimaryBufferID;
+    auto IsPrimary = !hasPrimaryBuffers() || isPrimaryBuffer(BufferID);
     Diags.setSuppressWarnings(DidSuppressWarnings || !IsPrimary);
 
     bool Done;
@@ -441,7 +504,8 @@ void CompilerInstance::performSema() {
       // Parser may stop at some erroneous constructions like #else, #endif
       // or '}' in some cases, continue parsing until we are done
       parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState, DelayedCB.get(),
+                          getSkippedBodyCB(BufferID));
     } while (!Done);
 
     Diags.setSuppressWarnings(DidSuppressWarnings);
@@ -462,20 +526,29 @@ void CompilerInstance::performSema() {
 
   // Compute the options we want to use for type checking.
   OptionSet<TypeCheckingFlags> TypeCheckOptions;
-  if (PrimaryBufferID == NO_SUCH_BUFFER) {
+  if (!hasPrimaryBuffers()) {
     TypeCheckOptions |= TypeCheckingFlags::DelayWholeModuleChecking;
   }
   if (options.DebugTimeFunctionBodies) {
     TypeCheckOptions |= TypeCheckingFlags::DebugTimeFunctionBodies;
   }
+  if (options.DebugTimeExpressionTypeChecking) {
+    TypeCheckOptions |= TypeCheckingFlags::DebugTimeExpressionTypeChecking;
+  }
   if (options.actionIsImmediate()) {
     TypeCheckOptions |= TypeCheckingFlags::ForImmediateMode;
   }
+  // Function bodies are only needed for the module if they are serialized.
+  if (options.SkipNonInlinableFunctionBodies &&
+      options.RequestedAction == FrontendOptions::EmitModuleOnly &&
+      !options.SILSerializeAll) {
+    TypeCheckOptions |= TypeCheckingFlags::SkipNonInlinableFunctionBodies;
+  }
 
   // Parse the main file last.
   if (MainBufferID != NO_SUCH_BUFFER) {
     bool mainIsPrimary =
-      (PrimaryBufferID == NO_SUCH_BUFFER || MainBufferID == PrimaryBufferID);
+      (!hasPrimaryBuffers() || isPrimaryBuffer(MainBufferID));
 
     SourceFile &MainFile =
       MainModule->getMainSourceFile(Invocation.getSourceFileKind());
@@ -494,11 +567,13 @@ void CompilerInstance::performSema() {
       // with 'sil' definitions.
       parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
                           TheSILModule ? &SILContext : nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState, DelayedCB.get(),
+                          getSkippedBodyCB(MainBufferID));
       if (mainIsPrimary) {
         performTypeChecking(MainFile, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, CurTUElem,
-                            options.WarnLongFunctionBodies);
+                            options.WarnLongFunctionBodies,
+                            options.WarnLongExpressionTypeChecking);
       }
       CurTUElem = MainFile.Decls.size();
     } while (!Done);
@@ -515,10 +590,11 @@ void CompilerInstance::performSema() {
   // Type-check each top-level input besides the main source file.
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+      if (!hasPrimaryBuffers() || isPrimarySourceFile(SF))
         performTypeChecking(*SF, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, /*curElem*/0,
-                            options.WarnLongFunctionBodies);
+                            options.WarnLongFunctionBodies,
+                            options.WarnLongExpressionTypeChecking);
 
   // Even if there were no source files, we should still record known
   // protocols.
@@ -539,7 +615,7 @@ void CompilerInstance::performSema() {
 
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+      if (!hasPrimaryBuffers() || isPrimarySourceFile(SF))
         finishTypeChecking(*SF);
 }
 
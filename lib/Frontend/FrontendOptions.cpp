@@ -26,6 +26,8 @@ bool FrontendOptions::actionHasOutput() const {
   case PrintAST:
   case DumpTypeRefinementContexts:
     return false;
+  case EmitPCH:
+    return true;
   case EmitSILGen:
   case EmitSIL:
   case EmitSIBGen:
@@ -53,6 +55,7 @@ bool FrontendOptions::actionIsImmediate() const {
   case DumpInterfaceHash:
   case PrintAST:
   case DumpTypeRefinementContexts:
+  case EmitPCH:
   case EmitSILGen:
   case EmitSIL:
   case EmitSIBGen:
@@ -88,3 +91,21 @@ void FrontendOptions::forAllOutputPaths(
       fn(*next);
   }
 }
+
+FrontendOptions
+FrontendOptions::getOptionsForBatchPrimary(unsigned Index) const {
+  assert(isBatchMode() && "not a batch-mode job");
+  const BatchPrimaryInput &Primary = BatchPrimaryInputs[Index];
+
+  FrontendOptions Result = *this;
+  Result.BatchPrimaryInputs.clear();
+  Result.PrimaryInput = Primary.Input;
+  Result.OutputFilenames.clear();
+  if (!Primary.OutputFilename.empty())
+    Result.OutputFilenames.push_back(Primary.OutputFilename);
+  Result.ModuleOutputPath = Primary.ModuleOutputPath;
+  Result.ModuleDocOutputPath = Primary.ModuleDocOutputPath;
+  Result.DependenciesFilePath = Primary.DependenciesFilePath;
+  Result.ReferenceDependenciesFilePath = Primary.ReferenceDependenciesFilePath;
+  return Result;
+}
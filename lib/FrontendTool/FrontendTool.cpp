@@ -28,41 +28,52 @@
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/Mangle.h"
 #include "swift/AST/NameLookup.h"
+#include "swift/AST/PrintOptions.h"
 #include "swift/AST/ReferencedNameTracker.h"
 #include "swift/AST/TypeRefinementContext.h"
 #include "swift/Basic/Dwarf.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/FileSystem.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/Timer.h"
+#include "swift/Basic/Version.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/Frontend/SerializedDiagnosticConsumer.h"
 #include "swift/Immediate/Immediate.h"
+#include "swift/Index/IndexRecord.h"
 #include "swift/Option/Options.h"
 #include "swift/PrintAsObjC/PrintAsObjC.h"
 #include "swift/Serialization/SerializationOptions.h"
+#include "swift/SIL/SILDebugScope.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 
 // FIXME: We're just using CompilerInstance::createOutputFile.
 // This API should be sunk down to LLVM.
 #include "clang/Frontend/CompilerInstance.h"
 
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/YAMLParser.h"
 
+#include <map>
 #include <memory>
+#include <set>
 #include <unordered_set>
 
 using namespace swift;
@@ -180,6 +191,130 @@ static std::string mangleTypeAsContext(const NominalTypeDecl *type) {
   return mangler.finalize();
 }
 
+/// Adds the printed interface of \p D, without any function bodies or the
+/// members of types, to \p fingerprint.
+static void addToFingerprint(llvm::MD5 &fingerprint, const Decl *D) {
+  PrintOptions options;
+  options.FunctionDefinitions = false;
+  options.TypeDefinitions = false;
+  options.PrintAccessibility = true;
+
+  llvm::SmallString<128> buffer;
+  llvm::raw_svector_ostream out(buffer);
+  D->print(out, options);
+  fingerprint.update(out.str());
+  // Add null byte to separate declarations.
+  uint8_t separator[1] = {0};
+  fingerprint.update(separator);
+}
+
+/// Returns true if \p member contributes to the layout of \p type, or to the
+/// layout of its vtable or witness tables. Other files depend on these
+/// members without naming them, just by using the type.
+static bool isLayoutMember(const NominalTypeDecl *type, const Decl *member) {
+  if (isa<ProtocolDecl>(type) || isa<EnumElementDecl>(member))
+    return true;
+  if (auto *var = dyn_cast<VarDecl>(member))
+    if (var->hasStorage())
+      return true;
+  if (auto *classDecl = dyn_cast<ClassDecl>(type)) {
+    auto *VD = dyn_cast<ValueDecl>(member);
+    return VD && !isa<TypeDecl>(VD) && !VD->isFinal() && !classDecl->isFinal();
+  }
+  return false;
+}
+
+/// Adds \p type to \p fingerprint, along with the members that determine its
+/// layout. Other files depend on these members just by using the type.
+static void addTypeToFingerprint(llvm::MD5 &fingerprint,
+                                 const NominalTypeDecl *type) {
+  addToFingerprint(fingerprint, type);
+  for (const Decl *member : type->getMembers())
+    if (isLayoutMember(type, member))
+      addToFingerprint(fingerprint, member);
+}
+
+namespace {
+/// Collects fingerprints for the names provided by a file.
+///
+/// A fingerprint is a hash of the printed interfaces of all the declarations
+/// behind a provided name. When the interface of a file changes, the driver
+/// compares them with the fingerprints from the last build to find out which
+/// names actually changed, and only rebuilds the files that use those.
+class ProvidesFingerprints {
+  using MemberKey = std::pair<std::string, std::string>;
+
+  std::map<std::string, llvm::MD5> TopLevel;
+  std::map<std::string, llvm::MD5> Nominal;
+  std::map<MemberKey, llvm::MD5> Member;
+  std::map<std::string, llvm::MD5> DynamicLookup;
+
+  static std::string stringify(llvm::MD5 &fingerprint) {
+    llvm::MD5::MD5Result result;
+    fingerprint.final(result);
+    llvm::SmallString<32> str;
+    llvm::MD5::stringifyResult(result, str);
+    return str.str();
+  }
+
+  static void writeNames(llvm::raw_ostream &out, StringRef key,
+                         std::map<std::string, llvm::MD5> &fingerprints) {
+    out << key << ":\n";
+    for (auto &entry : fingerprints) {
+      out << "- [\"" << llvm::yaml::escape(entry.first) << "\", \""
+          << stringify(entry.second) << "\"]\n";
+    }
+  }
+
+public:
+  void addTopLevel(Identifier name, const Decl *D) {
+    llvm::MD5 &fingerprint = TopLevel[name.str()];
+    if (auto *type = dyn_cast<NominalTypeDecl>(D))
+      addTypeToFingerprint(fingerprint, type);
+    else
+      addToFingerprint(fingerprint, D);
+  }
+
+  /// Adds a declaration of the nominal type, or one of its extensions, to the
+  /// fingerprint of the type and to that of its set of members as a whole.
+  void addNominal(StringRef mangledName, const Decl *D) {
+    llvm::MD5 &fingerprint = Nominal[mangledName];
+    llvm::MD5 &allMembers = Member[MemberKey(mangledName, "")];
+    if (auto *type = dyn_cast<NominalTypeDecl>(D)) {
+      addTypeToFingerprint(fingerprint, type);
+      addTypeToFingerprint(allMembers, type);
+    } else {
+      addToFingerprint(fingerprint, D);
+      addToFingerprint(allMembers, D);
+    }
+  }
+
+  /// Adds \p member to the fingerprint of its name, and to the fingerprint
+  /// of the type's set of members as a whole.
+  void addMember(StringRef mangledName, Identifier name, const Decl *member) {
+    addToFingerprint(Member[MemberKey(mangledName, name.str())], member);
+    addToFingerprint(Member[MemberKey(mangledName, "")], member);
+  }
+
+  void addDynamicLookup(Identifier name, const Decl *D) {
+    addToFingerprint(DynamicLookup[name.str()], D);
+  }
+
+  void write(llvm::raw_ostream &out) {
+    writeNames(out, "fingerprints-top-level", TopLevel);
+    writeNames(out, "fingerprints-nominal", Nominal);
+    out << "fingerprints-member:\n";
+    for (auto &entry : Member) {
+      out << "- [\"" << entry.first.first << "\", \""
+          << llvm::yaml::escape(entry.first.second) << "\", \""
+          << stringify(entry.second) << "\"]\n";
+    }
+    if (!DynamicLookup.empty())
+      writeNames(out, "fingerprints-dynamic-lookup", DynamicLookup);
+  }
+};
+} // end anonymous namespace
+
 /// Emits a Swift-style dependencies file.
 static bool emitReferenceDependencies(DiagnosticEngine &diags,
                                       SourceFile *SF,
@@ -210,6 +345,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
 
   llvm::MapVector<const NominalTypeDecl *, bool> extendedNominals;
   llvm::SmallVector<const ExtensionDecl *, 8> extensionsWithJustMembers;
+  llvm::SmallVector<const ExtensionDecl *, 8> conformingExtensions;
+  ProvidesFingerprints fingerprints;
 
   out << "provides-top-level:\n";
   for (const Decl *D : SF->Decls) {
@@ -242,6 +379,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           extensionsWithJustMembers.push_back(ED);
         }
       }
+      if (!justMembers)
+        conformingExtensions.push_back(ED);
       extendedNominals[NTD] |= !justMembers;
       findNominals(extendedNominals, ED->getMembers());
       break;
@@ -251,6 +390,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     case DeclKind::PrefixOperator:
     case DeclKind::PostfixOperator:
       out << "- \"" << escape(cast<OperatorDecl>(D)->getName()) << "\"\n";
+      fingerprints.addTopLevel(cast<OperatorDecl>(D)->getName(), D);
       break;
 
     case DeclKind::Enum:
@@ -265,6 +405,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         break;
       }
       out << "- \"" << escape(NTD->getName()) << "\"\n";
+      fingerprints.addTopLevel(NTD->getName(), NTD);
       extendedNominals[NTD] |= true;
       findNominals(extendedNominals, NTD->getMembers());
       break;
@@ -281,6 +422,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         break;
       }
       out << "- \"" << escape(VD->getName()) << "\"\n";
+      fingerprints.addTopLevel(VD->getName(), VD);
       break;
     }
 
@@ -306,9 +448,14 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
   for (auto entry : extendedNominals) {
     if (!entry.second)
       continue;
-    out << "- \"";
-    out << mangleTypeAsContext(entry.first);
-    out << "\"\n";
+    auto mangledName = mangleTypeAsContext(entry.first);
+    out << "- \"" << mangledName << "\"\n";
+
+    if (entry.first->getDeclContext()->getParentSourceFile() == SF)
+      fingerprints.addNominal(mangledName, entry.first);
+    for (auto *ED : conformingExtensions)
+      if (ED->getExtendedType()->getAnyNominal() == entry.first)
+        fingerprints.addNominal(mangledName, ED);
   }
 
   out << "provides-member:\n";
@@ -331,9 +478,35 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
       }
       out << "- [\"" << mangledName << "\", \""
           << escape(VD->getName()) << "\"]\n";
+      fingerprints.addMember(mangledName, VD->getName(), VD);
     }
   }
 
+  // Members of types and conforming extensions declared in this file are
+  // listed too, so that their fingerprints can be compared on their own.
+  // Without fingerprints they are covered by the type's entries above.
+  std::set<std::pair<std::string, Identifier>> listedMembers;
+  auto addMembers = [&](const NominalTypeDecl *NTD, DeclRange members) {
+    auto mangledName = mangleTypeAsContext(NTD);
+    for (auto *member : members) {
+      auto *VD = dyn_cast<ValueDecl>(member);
+      if (!VD || !VD->hasName() ||
+          VD->getFormalAccess() == Accessibility::Private) {
+        continue;
+      }
+      fingerprints.addMember(mangledName, VD->getName(), VD);
+      if (listedMembers.insert({mangledName, VD->getName()}).second) {
+        out << "- [\"" << mangledName << "\", \""
+            << escape(VD->getName()) << "\"]\n";
+      }
+    }
+  };
+  for (auto entry : extendedNominals)
+    if (entry.first->getDeclContext()->getParentSourceFile() == SF)
+      addMembers(entry.first, entry.first->getMembers());
+  for (auto *ED : conformingExtensions)
+    addMembers(ED->getExtendedType()->getAnyNominal(), ED->getMembers());
+
   if (SF->getASTContext().LangOpts.EnableObjCInterop) {
     // FIXME: This requires a traversal of the whole file to compute.
     // We should (a) see if there's a cheaper way to keep it up to date,
@@ -343,15 +516,18 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     private:
       raw_ostream &out;
       std::string (*escape)(Identifier);
+      ProvidesFingerprints &fingerprints;
     public:
-      ValueDeclPrinter(raw_ostream &out, decltype(escape) escape)
-        : out(out), escape(escape) {}
+      ValueDeclPrinter(raw_ostream &out, decltype(escape) escape,
+                       ProvidesFingerprints &fingerprints)
+        : out(out), escape(escape), fingerprints(fingerprints) {}
 
       void foundDecl(ValueDecl *VD, DeclVisibilityKind Reason) override {
         out << "- \"" << escape(VD->getName()) << "\"\n";
+        fingerprints.addDynamicLookup(VD->getName(), VD);
       }
     };
-    ValueDeclPrinter printer(out, escape);
+    ValueDeclPrinter printer(out, escape, fingerprints);
     SF->lookupClassMembers({}, printer);
   }
 
@@ -444,6 +620,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
   SF->getInterfaceHash(interfaceHash);
   out << "interface-hash: \"" << interfaceHash << "\"\n";
 
+  fingerprints.write(out);
+
   return false;
 }
 
@@ -623,124 +801,299 @@ static void debugFailWithCrash() {
 
 /// Performs the compile requested by the user.
 /// \returns true on error
-static bool performCompile(CompilerInstance &Instance,
-                           CompilerInvocation &Invocation,
-                           ArrayRef<const char *> Args,
-                           int &ReturnValue,
-                           FrontendObserver *observer) {
-  FrontendOptions opts = Invocation.getFrontendOptions();
-  FrontendOptions::ActionType Action = opts.RequestedAction;
-
-  IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
+/// Add the number of functions and instructions in \p SM to the given
+/// counters.
+static void countSILStats(SILModule &SM, size_t &NumFunctions,
+                          size_t &NumInstructions) {
+  for (SILFunction &F : SM) {
+    ++NumFunctions;
+    for (SILBasicBlock &BB : F)
+      NumInstructions += std::distance(BB.begin(), BB.end());
+  }
+}
 
-  bool inputIsLLVMIr = Invocation.getInputKind() == InputFileKind::IFK_LLVM_IR;
-  if (inputIsLLVMIr) {
-    auto &LLVMContext = llvm::getGlobalContext();
+/// Counts the debug scopes the instructions of \p SM refer to, directly or
+/// as parents and inlined call sites, and those among them which have the
+/// same location, parent and call site as another one.
+static void countSILDebugScopes(SILModule &SM, size_t &NumScopes,
+                                size_t &NumDuplicateScopes) {
+  llvm::DenseSet<const SILDebugScope *> Visited;
+  std::set<std::tuple<unsigned, const void *, const void *, const void *>>
+    Contents;
+  SmallVector<const SILDebugScope *, 16> Worklist;
+
+  auto addScope = [&](const SILDebugScope *DS) {
+    if (DS && Visited.insert(DS).second)
+      Worklist.push_back(DS);
+  };
 
-    // Load in bitcode file.
-    assert(Invocation.getInputFilenames().size() == 1 &&
-           "We expect a single input for bitcode input!");
-    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
-      llvm::MemoryBuffer::getFileOrSTDIN(Invocation.getInputFilenames()[0]);
-    if (!FileBufOrErr) {
-      Instance.getASTContext().Diags.diagnose(SourceLoc(),
-                                              diag::error_open_input_file,
-                                              Invocation.getInputFilenames()[0],
-                                              FileBufOrErr.getError().message());
-      return true;
+  for (SILFunction &F : SM) {
+    addScope(F.getDebugScope());
+    for (SILBasicBlock &BB : F)
+      for (SILInstruction &I : BB)
+        addScope(I.getDebugScope());
+
+    while (!Worklist.empty()) {
+      const SILDebugScope *DS = Worklist.pop_back_val();
+      ++NumScopes;
+      if (!Contents.insert(std::make_tuple(DS->Loc.getOpaqueKind(),
+                                           DS->Loc.getOpaquePointerValue(),
+                                           DS->Parent.getOpaqueValue(),
+                                           (const void *)DS->InlinedCallSite))
+               .second)
+        ++NumDuplicateScopes;
+      addScope(DS->Parent.dyn_cast<const SILDebugScope *>());
+      addScope(DS->InlinedCallSite);
     }
-    llvm::MemoryBuffer *MainFile = FileBufOrErr.get().get();
+  }
+}
 
-    llvm::SMDiagnostic Err;
-    std::unique_ptr<llvm::Module> Module = llvm::parseIR(
-                                             MainFile->getMemBufferRef(),
-                                             Err, LLVMContext);
-    if (!Module) {
-      // TODO: Translate from the diagnostic info to the SourceManager location
-      // if available.
-      Instance.getASTContext().Diags.diagnose(SourceLoc(),
-                                              diag::error_parse_input_file,
-                                              Invocation.getInputFilenames()[0],
-                                              Err.getMessage());
-      return true;
-    }
+/// Performs the steps after type-checking which produce the outputs for one
+/// primary file, or for the whole module if \p PrimarySourceFile is null and
+/// \p opts has no primary input.
+/// Returns true if \p arg is an option whose value only names a file that a
+/// frontend job writes, and so doesn't affect the contents of its output.
+static bool isOutputPathOption(StringRef arg) {
+  return llvm::StringSwitch<bool>(arg)
+    .Cases("-o", "-emit-dependencies-path",
+           "-emit-reference-dependencies-path", true)
+    .Cases("-serialize-diagnostics-path", "-emit-fixits-path",
+           "-stats-output-dir", "-sil-optimization-cache-path", true)
+    .Default(false);
+}
 
-    // TODO: remove once the frontend understands what action it should perform
-    IRGenOpts.OutputKind = getOutputKind(Action);
+namespace {
+/// A stream that feeds everything written to it into an MD5 hash.
+class MD5Stream : public llvm::raw_ostream {
+  llvm::MD5 &Hash;
+  uint64_t Pos = 0;
+
+  void write_impl(const char *ptr, size_t size) override {
+    Hash.update(ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(ptr),
+                                  size));
+    Pos += size;
+  }
 
-    return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
+  uint64_t current_pos() const override { return Pos; }
+
+public:
+  explicit MD5Stream(llvm::MD5 &hash) : Hash(hash) {}
+  ~MD5Stream() override { flush(); }
+};
+} // end anonymous namespace
+
+/// Returns the path of the SIL optimization cache entry for the output of
+/// this frontend job, or an empty string if the output can't be cached.
+///
+/// The entry is keyed by everything the output is derived from once SIL has
+/// been generated: the compiler and its arguments, the contents of all
+/// imported modules and headers, and the canonical SIL along with the
+/// declarations of the module. Only jobs whose single output is produced
+/// from the optimized SIL are cached, since any module or header outputs
+/// also depend on the AST.
+static std::string
+getSILOptimizationCacheEntryPath(const FrontendOptions &opts,
+                                 ArrayRef<const char *> Args,
+                                 const DependencyTracker *depTracker,
+                                 const SILModule &SM, Module *M) {
+  if (opts.SILOptimizationCachePath.empty() || !depTracker)
+    return "";
+
+  // Specialization remarks are written while optimizing, which a cache hit
+  // would skip.
+  if (!SM.getOptions().SpecializationRemarksPath.empty())
+    return "";
+
+  switch (opts.RequestedAction) {
+  case FrontendOptions::EmitAssembly:
+  case FrontendOptions::EmitIR:
+  case FrontendOptions::EmitBC:
+  case FrontendOptions::EmitObject:
+    break;
+  default:
+    return "";
+  }
+  if (opts.OutputFilenames.size() != 1 || opts.OutputFilenames[0] == "-" ||
+      !opts.ModuleOutputPath.empty() || !opts.ModuleDocOutputPath.empty() ||
+      !opts.ObjCHeaderOutputPath.empty()) {
+    return "";
   }
 
-  ReferencedNameTracker nameTracker;
-  bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
-  if (shouldTrackReferences)
-    Instance.setReferencedNameTracker(&nameTracker);
+  llvm::MD5 hash;
+  auto addString = [&](StringRef str) {
+    hash.update(str);
+    // Add null byte to separate strings.
+    uint8_t separator[1] = {0};
+    hash.update(separator);
+  };
 
-  if (Action == FrontendOptions::DumpParse ||
-      Action == FrontendOptions::DumpInterfaceHash)
-    Instance.performParseOnly();
-  else
-    Instance.performSema();
+  addString(version::getSwiftFullVersion());
 
-  if (observer) {
-    observer->performedSemanticAnalysis(Instance);
+  // Debug info refers to the working directory.
+  llvm::SmallString<128> workingDirectory;
+  if (llvm::sys::fs::current_path(workingDirectory))
+    return "";
+  addString(workingDirectory);
+
+  for (unsigned i = 0, e = Args.size(); i != e; ++i) {
+    if (isOutputPathOption(Args[i])) {
+      ++i;
+      continue;
+    }
+    addString(Args[i]);
   }
 
-  FrontendOptions::DebugCrashMode CrashMode = opts.CrashMode;
-  if (CrashMode == FrontendOptions::DebugCrashMode::AssertAfterParse)
-    debugFailWithAssertion();
-  else if (CrashMode == FrontendOptions::DebugCrashMode::CrashAfterParse)
-    debugFailWithCrash();
+  for (StringRef path : depTracker->getDependencies()) {
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer)
+      return "";
+    addString(path);
+    addString(buffer.get()->getBuffer());
+  }
 
-  ASTContext &Context = Instance.getASTContext();
+  // The receiver profile is only read by the optimizer, so unlike the
+  // execution counts it is not part of the printed SIL.
+  StringRef receiverProfile = SM.getOptions().UseReceiverProfile;
+  if (!receiverProfile.empty()) {
+    auto buffer = llvm::MemoryBuffer::getFile(receiverProfile);
+    if (!buffer)
+      return "";
+    addString(buffer.get()->getBuffer());
+  }
 
-  if (Action == FrontendOptions::REPL) {
-    runREPL(Instance, ProcessCmdLine(Args.begin(), Args.end()),
-            Invocation.getParseStdlib());
-    return false;
+  {
+    MD5Stream out(hash);
+    SM.print(out, /*Verbose=*/true, M);
   }
 
-  SourceFile *PrimarySourceFile = Instance.getPrimarySourceFile();
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+  llvm::SmallString<32> key;
+  llvm::MD5::stringifyResult(result, key);
 
-  // We've been told to dump the AST (either after parsing or type-checking,
-  // which is already differentiated in CompilerInstance::performSema()),
-  // so dump or print the main source file and return.
-  if (Action == FrontendOptions::DumpParse ||
-      Action == FrontendOptions::DumpAST ||
-      Action == FrontendOptions::PrintAST ||
-      Action == FrontendOptions::DumpTypeRefinementContexts ||
-      Action == FrontendOptions::DumpInterfaceHash) {
-    SourceFile *SF = PrimarySourceFile;
-    if (!SF) {
-      SourceFileKind Kind = Invocation.getSourceFileKind();
-      SF = &Instance.getMainModule()->getMainSourceFile(Kind);
+  if (llvm::sys::fs::create_directories(opts.SILOptimizationCachePath))
+    return "";
+
+  llvm::SmallString<128> entryPath(opts.SILOptimizationCachePath);
+  llvm::sys::path::append(entryPath, key);
+  entryPath += llvm::sys::path::extension(opts.OutputFilenames[0]);
+  return entryPath.str();
+}
+
+/// Copies the ASTContext's totals of allocated bytes into \p Counters.
+static void
+countASTAllocations(const ASTContext &Context,
+              UnifiedStatsReporter::AlwaysOnFrontendCounters &Counters) {
+  for (unsigned i = 0; i != NumAllocationOrigins; ++i) {
+    auto origin = AllocationOrigin(i);
+    for (unsigned j = 0; j != NumAllocationCategories; ++j) {
+      auto category = AllocationCategory(j);
+      size_t bytes = Context.getAllocatedBytes(AllocationArena::Permanent,
+                                               origin, category);
+      switch (category) {
+      case AllocationCategory::Decl:
+        Counters.ASTDeclBytes += bytes;
+        break;
+      case AllocationCategory::Type:
+        Counters.ASTTypeBytes += bytes;
+        break;
+      case AllocationCategory::Expr:
+        Counters.ASTExprBytes += bytes;
+        break;
+      case AllocationCategory::Stmt:
+        Counters.ASTStmtBytes += bytes;
+        break;
+      case AllocationCategory::Pattern:
+        Counters.ASTPatternBytes += bytes;
+        break;
+      case AllocationCategory::Conformance:
+        Counters.ASTConformanceBytes += bytes;
+        break;
+      case AllocationCategory::Other:
+        Counters.ASTOtherBytes += bytes;
+        break;
+      }
+
+      switch (origin) {
+      case AllocationOrigin::Source:
+        break;
+      case AllocationOrigin::Deserialization:
+        Counters.ASTDeserializedBytes += bytes;
+        break;
+      case AllocationOrigin::ClangImporter:
+        Counters.ASTClangImportedBytes += bytes;
+        break;
+      }
+
+      Counters.ASTConstraintSolverBytes +=
+        Context.getAllocatedBytes(AllocationArena::ConstraintSolver, origin,
+                                  category);
     }
-    if (Action == FrontendOptions::PrintAST)
-      SF->print(llvm::outs(), PrintOptions::printEverything());
-    else if (Action == FrontendOptions::DumpTypeRefinementContexts)
-      SF->getTypeRefinementContext()->dump(llvm::errs(), Context.SourceMgr);
-    else if (Action == FrontendOptions::DumpInterfaceHash)
-      SF->dumpInterfaceHash(llvm::errs());
-    else
-      SF->dump();
-    return false;
   }
+}
 
-  // If we were asked to print Clang stats, do so.
-  if (opts.PrintClangStats && Context.getClangModuleLoader())
-    Context.getClangModuleLoader()->printStatistics();
+/// Writes the index records of the primary source file, or of all of the
+/// source files if there is none, into IndexRecordsPath.
+static void emitIndexRecords(CompilerInstance &Instance,
+                             const FrontendOptions &opts,
+                             SourceFile *PrimarySourceFile) {
+  ASTContext &Context = Instance.getASTContext();
+  SharedTimer timer("Index records");
+
+  SmallVector<SourceFile *, 8> Files;
+  if (PrimarySourceFile) {
+    Files.push_back(PrimarySourceFile);
+  } else {
+    for (FileUnit *File : Instance.getMainModule()->getFiles())
+      if (auto *SF = dyn_cast<SourceFile>(File))
+        Files.push_back(SF);
+  }
+
+  for (SourceFile *SF : Files) {
+    std::string Error;
+    switch (index::writeIndexRecord(SF, opts.IndexRecordsPath, Error)) {
+    case index::IndexRecordStatus::Written:
+      if (auto *Stats = Context.Stats)
+        Stats->getFrontendCounters().NumIndexRecordsWritten++;
+      break;
+    case index::IndexRecordStatus::UpToDate:
+      if (auto *Stats = Context.Stats)
+        Stats->getFrontendCounters().NumIndexRecordsUpToDate++;
+      break;
+    case index::IndexRecordStatus::Failed:
+      Context.Diags.diagnose(SourceLoc(),
+                             diag::warning_cannot_write_index_record,
+                             SF->getFilename(), Error);
+      break;
+    }
+  }
+}
+
+static bool performCompileStepsPostSema(CompilerInstance &Instance,
+                                        CompilerInvocation &Invocation,
+                                        const FrontendOptions &opts,
+                                        SourceFile *PrimarySourceFile,
+                                        IRGenOptions &IRGenOpts,
+                                        ArrayRef<const char *> Args,
+                                        int &ReturnValue,
+                                        FrontendObserver *observer) {
+  FrontendOptions::ActionType Action = opts.RequestedAction;
+  ASTContext &Context = Instance.getASTContext();
 
   if (!opts.DependenciesFilePath.empty())
     (void)emitMakeDependencies(Context.Diags, *Instance.getDependencyTracker(),
                                opts);
 
-  if (shouldTrackReferences)
-    emitReferenceDependencies(Context.Diags, Instance.getPrimarySourceFile(),
+  if (!opts.ReferenceDependenciesFilePath.empty())
+    emitReferenceDependencies(Context.Diags, PrimarySourceFile,
                               *Instance.getDependencyTracker(), opts);
 
   if (Context.hadError())
     return true;
 
+  if (!opts.IndexRecordsPath.empty())
+    emitIndexRecords(Instance, opts, PrimarySourceFile);
+
   // FIXME: This is still a lousy approximation of whether the module file will
   // be externally consumed.
   bool moduleIsPublic =
@@ -826,6 +1179,27 @@ static bool performCompile(CompilerInstance &Instance,
     SM->verify();
   }
 
+  if (auto *Stats = Context.Stats) {
+    auto &Counters = Stats->getFrontendCounters();
+    countSILStats(*SM, Counters.NumSILGenFunctions,
+                  Counters.NumSILGenInstructions);
+  }
+
+  // If an earlier job already produced the output from the same SIL, reuse it
+  // instead of optimizing again.
+  std::string SILOptCacheEntryPath =
+      getSILOptimizationCacheEntryPath(opts, Args,
+                                       Instance.getDependencyTracker(), *SM,
+                                       Instance.getMainModule());
+  if (!SILOptCacheEntryPath.empty() &&
+      llvm::sys::fs::exists(SILOptCacheEntryPath) &&
+      !copyFileAtomically(SILOptCacheEntryPath,
+                          opts.getSingleOutputFilename())) {
+    if (auto *Stats = Context.Stats)
+      Stats->getFrontendCounters().NumSILOptCacheHits++;
+    return false;
+  }
+
   // Perform SIL optimization passes if optimizations haven't been disabled.
   // These may change across compiler versions.
   {
@@ -853,6 +1227,16 @@ static bool performCompile(CompilerInstance &Instance,
     SM->verify();
   }
 
+  if (auto *Stats = Context.Stats) {
+    auto &Counters = Stats->getFrontendCounters();
+    countSILStats(*SM, Counters.NumSILOptFunctions,
+                  Counters.NumSILOptInstructions);
+    Counters.SILPeakInstructionBytes = SM->getPeakInstructionMemoryUsage();
+    Counters.SILOtherBytes = SM->getOtherMemoryUsage();
+    countSILDebugScopes(*SM, Counters.NumSILDebugScopes,
+                        Counters.NumSILDuplicateDebugScopes);
+  }
+
   // Gather instruction counts if we are asked to do so.
   if (SM->getOptions().PrintInstCounts) {
     performSILInstCount(&*SM);
@@ -951,7 +1335,8 @@ static bool performCompile(CompilerInstance &Instance,
     }
 
     ReturnValue =
-      RunImmediately(Instance, CmdLine, IRGenOpts, Invocation.getSILOptions());
+      RunImmediately(Instance, CmdLine, IRGenOpts, Invocation.getSILOptions(),
+                     opts.ImmediateCachePath);
     return false;
   }
 
@@ -966,9 +1351,158 @@ static bool performCompile(CompilerInstance &Instance,
                         opts.getSingleOutputFilename(), LLVMContext);
   }
 
+  if (!SILOptCacheEntryPath.empty() && !Context.hadError() &&
+      !copyFileAtomically(opts.getSingleOutputFilename(),
+                          SILOptCacheEntryPath)) {
+    if (auto *Stats = Context.Stats)
+      Stats->getFrontendCounters().NumSILOptCacheMisses++;
+  }
+
   return false;
 }
 
+static bool performCompile(CompilerInstance &Instance,
+                           CompilerInvocation &Invocation,
+                           ArrayRef<const char *> Args,
+                           int &ReturnValue,
+                           FrontendObserver *observer) {
+  FrontendOptions opts = Invocation.getFrontendOptions();
+  FrontendOptions::ActionType Action = opts.RequestedAction;
+
+  IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
+
+  bool inputIsLLVMIr = Invocation.getInputKind() == InputFileKind::IFK_LLVM_IR;
+  if (inputIsLLVMIr) {
+    auto &LLVMContext = llvm::getGlobalContext();
+
+    // Load in bitcode file.
+    assert(Invocation.getInputFilenames().size() == 1 &&
+           "We expect a single input for bitcode input!");
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
+      llvm::MemoryBuffer::getFileOrSTDIN(Invocation.getInputFilenames()[0]);
+    if (!FileBufOrErr) {
+      Instance.getASTContext().Diags.diagnose(SourceLoc(),
+                                              diag::error_open_input_file,
+                                              Invocation.getInputFilenames()[0],
+                                              FileBufOrErr.getError().message());
+      return true;
+    }
+    llvm::MemoryBuffer *MainFile = FileBufOrErr.get().get();
+
+    llvm::SMDiagnostic Err;
+    std::unique_ptr<llvm::Module> Module = llvm::parseIR(
+                                             MainFile->getMemBufferRef(),
+                                             Err, LLVMContext);
+    if (!Module) {
+      // TODO: Translate from the diagnostic info to the SourceManager location
+      // if available.
+      Instance.getASTContext().Diags.diagnose(SourceLoc(),
+                                              diag::error_parse_input_file,
+                                              Invocation.getInputFilenames()[0],
+                                              Err.getMessage());
+      return true;
+    }
+
+    // TODO: remove once the frontend understands what action it should perform
+    IRGenOpts.OutputKind = getOutputKind(Action);
+
+    return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
+  }
+
+  if (Action == FrontendOptions::EmitPCH) {
+    auto clangImporter = static_cast<ClangImporter *>(
+      Instance.getASTContext().getClangModuleLoader());
+    return clangImporter->emitBridgingPCH(Invocation.getInputFilenames()[0],
+                                          opts.getSingleOutputFilename());
+  }
+
+  // Each primary file of a batch-mode job records its references separately.
+  unsigned NumPrimaries = opts.isBatchMode() ? opts.BatchPrimaryInputs.size()
+                                             : 1;
+  std::vector<ReferencedNameTracker> nameTrackers(NumPrimaries);
+  if (!opts.ReferenceDependenciesFilePath.empty()) {
+    SmallVector<ReferencedNameTracker *, 1> trackerPtrs;
+    for (ReferencedNameTracker &tracker : nameTrackers)
+      trackerPtrs.push_back(&tracker);
+    Instance.setReferencedNameTrackers(trackerPtrs);
+  }
+
+  if (Action == FrontendOptions::DumpParse ||
+      Action == FrontendOptions::DumpInterfaceHash)
+    Instance.performParseOnly();
+  else
+    Instance.performSema();
+
+  if (observer) {
+    observer->performedSemanticAnalysis(Instance);
+  }
+
+  FrontendOptions::DebugCrashMode CrashMode = opts.CrashMode;
+  if (CrashMode == FrontendOptions::DebugCrashMode::AssertAfterParse)
+    debugFailWithAssertion();
+  else if (CrashMode == FrontendOptions::DebugCrashMode::CrashAfterParse)
+    debugFailWithCrash();
+
+  ASTContext &Context = Instance.getASTContext();
+
+  if (Action == FrontendOptions::REPL) {
+    runREPL(Instance, ProcessCmdLine(Args.begin(), Args.end()),
+            Invocation.getParseStdlib());
+    return false;
+  }
+
+  // We've been told to dump the AST (either after parsing or type-checking,
+  // which is already differentiated in CompilerInstance::performSema()),
+  // so dump or print the main source file and return.
+  if (Action == FrontendOptions::DumpParse ||
+      Action == FrontendOptions::DumpAST ||
+      Action == FrontendOptions::PrintAST ||
+      Action == FrontendOptions::DumpTypeRefinementContexts ||
+      Action == FrontendOptions::DumpInterfaceHash) {
+    SourceFile *SF = Instance.getPrimarySourceFile();
+    if (!SF) {
+      SourceFileKind Kind = Invocation.getSourceFileKind();
+      SF = &Instance.getMainModule()->getMainSourceFile(Kind);
+    }
+    if (Action == FrontendOptions::PrintAST)
+      SF->print(llvm::outs(), PrintOptions::printEverything());
+    else if (Action == FrontendOptions::DumpTypeRefinementContexts)
+      SF->getTypeRefinementContext()->dump(llvm::errs(), Context.SourceMgr);
+    else if (Action == FrontendOptions::DumpInterfaceHash)
+      SF->dumpInterfaceHash(llvm::errs());
+    else
+      SF->dump();
+    return false;
+  }
+
+  // If we were asked to print Clang stats, do so.
+  if (opts.PrintClangStats && Context.getClangModuleLoader())
+    Context.getClangModuleLoader()->printStatistics();
+
+  if (!opts.isBatchMode())
+    return performCompileStepsPostSema(Instance, Invocation, opts,
+                                       Instance.getPrimarySourceFile(),
+                                       IRGenOpts, Args, ReturnValue, observer);
+
+  // In batch mode, generate the outputs of each primary file in turn, sharing
+  // the modules imported and the declarations type-checked so far.
+  bool HadError = false;
+  ArrayRef<SourceFile *> PrimarySourceFiles = Instance.getPrimarySourceFiles();
+  for (unsigned i = 0; i != NumPrimaries; ++i) {
+    FrontendOptions PrimaryOpts = opts.getOptionsForBatchPrimary(i);
+    IRGenOptions PrimaryIRGenOpts = IRGenOpts;
+    PrimaryIRGenOpts.MainInputFilename =
+      opts.InputFilenames[opts.BatchPrimaryInputs[i].Input.Index];
+    SourceFile *PrimarySourceFile =
+      i < PrimarySourceFiles.size() ? PrimarySourceFiles[i] : nullptr;
+    HadError |= performCompileStepsPostSema(Instance, Invocation, PrimaryOpts,
+                                            PrimarySourceFile,
+                                            PrimaryIRGenOpts, Args,
+                                            ReturnValue, observer);
+  }
+  return HadError;
+}
+
 /// Returns true if an error occurred.
 static bool dumpAPI(Module *Mod, StringRef OutDir) {
   using namespace llvm::sys;
@@ -1031,6 +1565,35 @@ static bool dumpAPI(Module *Mod, StringRef OutDir) {
   return false;
 }
 
+/// Describe this frontend job for the name of its -stats-output-dir file:
+/// the module, the primary input, the target and the optimization mode.
+static std::string computeStatsAuxName(const CompilerInvocation &Invocation) {
+  const FrontendOptions &Opts = Invocation.getFrontendOptions();
+
+  StringRef Input = "all";
+  if (Opts.PrimaryInput && Opts.PrimaryInput->isFilename())
+    Input = llvm::sys::path::filename(
+        Opts.InputFilenames[Opts.PrimaryInput->Index]);
+
+  StringRef OptMode;
+  switch (Invocation.getSILOptions().Optimization) {
+  case SILOptions::SILOptMode::NotSet:
+  case SILOptions::SILOptMode::None:
+  case SILOptions::SILOptMode::Debug:
+    OptMode = "Onone";
+    break;
+  case SILOptions::SILOptMode::Optimize:
+    OptMode = "O";
+    break;
+  case SILOptions::SILOptMode::OptimizeUnchecked:
+    OptMode = "Ounchecked";
+    break;
+  }
+
+  return (Invocation.getModuleName() + "-" + Input + "-" +
+          Invocation.getTargetTriple() + "-" + OptMode).str();
+}
+
 int swift::performFrontend(ArrayRef<const char *> Args,
                            const char *Argv0, void *MainAddr,
                            FrontendObserver *observer) {
@@ -1158,7 +1721,8 @@ int swift::performFrontend(ArrayRef<const char *> Args,
 
   DependencyTracker depTracker;
   if (!Invocation.getFrontendOptions().DependenciesFilePath.empty() ||
-      !Invocation.getFrontendOptions().ReferenceDependenciesFilePath.empty()) {
+      !Invocation.getFrontendOptions().ReferenceDependenciesFilePath.empty() ||
+      !Invocation.getFrontendOptions().SILOptimizationCachePath.empty()) {
     Instance.setDependencyTracker(&depTracker);
   }
 
@@ -1166,6 +1730,17 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     return 1;
   }
 
+  std::unique_ptr<UnifiedStatsReporter> StatsReporter;
+  if (!Invocation.getFrontendOptions().StatsOutputDir.empty()) {
+    StatsReporter.reset(new UnifiedStatsReporter(
+        "swift-frontend", computeStatsAuxName(Invocation),
+        Invocation.getFrontendOptions().StatsOutputDir));
+    if (Invocation.getFrontendOptions().TraceStatsEvents)
+      StatsReporter->enableTraceEvents();
+    Instance.getASTContext().Stats = StatsReporter.get();
+    SharedTimer::setStatsReporter(StatsReporter.get());
+  }
+
   // The compiler instance has been configured; notify our observer.
   if (observer) {
     observer->configuredCompiler(Instance);
@@ -1193,6 +1768,18 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     }
   }
 
+  if (StatsReporter) {
+    ASTContext &Context = Instance.getASTContext();
+    auto &Counters = StatsReporter->getFrontendCounters();
+    Counters.NumSourceBuffers = Context.SourceMgr.getLLVMSourceMgr()
+        .getNumBuffers();
+    Counters.NumLoadedModules = Context.LoadedModules.size();
+    countASTAllocations(Context, Counters);
+
+    SharedTimer::setStatsReporter(nullptr);
+    Context.Stats = nullptr;
+  }
+
   return (HadError ? 1 : ReturnValue);
 }
 
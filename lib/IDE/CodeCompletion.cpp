@@ -793,7 +793,14 @@ static ArrayRef<std::pair<StringRef, StringRef>> copyStringPairArray(
 
 void CodeCompletionResultBuilder::addChunkWithText(
     CodeCompletionString::Chunk::ChunkKind Kind, StringRef Text) {
-  addChunkWithTextNoCopy(Kind, copyString(*Sink.Allocator, Text));
+  auto Found = Sink.InternedStrings.find(Text);
+  if (Found != Sink.InternedStrings.end()) {
+    addChunkWithTextNoCopy(Kind, *Found);
+    return;
+  }
+  StringRef Copy = copyString(*Sink.Allocator, Text);
+  Sink.InternedStrings.insert(Copy);
+  addChunkWithTextNoCopy(Kind, Copy);
 }
 
 void CodeCompletionResultBuilder::setAssociatedDecl(const Decl *D) {
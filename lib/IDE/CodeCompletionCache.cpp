@@ -2,6 +2,7 @@
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -46,7 +47,8 @@ CodeCompletionCache::get(const Key &K) {
     llvm::sys::fs::file_status ModuleStatus;
     if (llvm::sys::fs::status(K.ModuleFilename, ModuleStatus) ||
         V.getValue()->ModuleModificationTime !=
-        ModuleStatus.getLastModificationTime()) {
+        ModuleStatus.getLastModificationTime() ||
+        V.getValue()->ModuleSize != ModuleStatus.getSize()) {
       // Cache is stale.
       V = None;
       TheCache.remove(K);
@@ -69,6 +71,7 @@ void CodeCompletionCache::setImpl(const Key &K, ValueRefCntPtr V,
       return;
     } else {
       V->ModuleModificationTime = ModuleStatus.getLastModificationTime();
+      V->ModuleSize = ModuleStatus.getSize();
     }
   }
   Impl->TheCache.set(K, V);
@@ -88,13 +91,19 @@ CodeCompletionCache::~CodeCompletionCache() {}
 ///
 /// This should be incremented any time we commit a change to the format of the
 /// cached results. This isn't expected to change very often.
-static constexpr uint32_t onDiskCompletionCacheVersion = 0;
+static constexpr uint32_t onDiskCompletionCacheVersion = 1;
 
-static StringRef copyString(llvm::BumpPtrAllocator &Allocator, StringRef Str) {
-  char *Mem = Allocator.Allocate<char>(Str.size());
-  std::copy(Str.begin(), Str.end(), Mem);
-  return StringRef(Mem, Str.size());
-}
+namespace {
+/// The storage of results read from a cache file.
+///
+/// The strings of the results point directly into the (usually mapped) file,
+/// so the file is owned together with the allocator of the results. Sinks
+/// which import the results keep the allocator, and with it the file, alive.
+struct CachedFileStorage {
+  llvm::BumpPtrAllocator Allocator;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+};
+} // end anonymous namespace
 
 static ArrayRef<StringRef> copyStringArray(llvm::BumpPtrAllocator &Allocator,
                                            ArrayRef<StringRef> Arr) {
@@ -113,14 +122,20 @@ static ArrayRef<std::pair<StringRef, StringRef>> copyStringPairArray(
 }
 
 /// Deserializes CodeCompletionResults from \p in and stores them in \p V.
+///
+/// Strings are not copied; \p V takes ownership of \p in instead.
 /// \see writeCacheModule.
-static bool readCachedModule(llvm::MemoryBuffer *in,
+static bool readCachedModule(std::unique_ptr<llvm::MemoryBuffer> in,
                              const CodeCompletionCache::Key &K,
                              CodeCompletionCache::Value &V,
                              bool allowOutOfDate = false) {
   const char *cursor = in->getBufferStart();
   const char *end = in->getBufferEnd();
 
+  // Too short to hold the header.
+  if (end - cursor < 24)
+    return false;
+
   auto read32le = [end](const char *&cursor) {
     auto result = llvm::support::endian::read32le(cursor);
     cursor += sizeof(result);
@@ -136,17 +151,27 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 
     auto mtime = llvm::support::endian::read64le(cursor);
     cursor += sizeof(mtime);
+    auto size = llvm::support::endian::read64le(cursor);
+    cursor += sizeof(size);
 
-    // Check the module file's last modification time.
+    // Check the module file's last modification time and size.
     if (!allowOutOfDate) {
       llvm::sys::fs::file_status status;
       if (llvm::sys::fs::status(K.ModuleFilename, status) ||
-          status.getLastModificationTime().toEpochTime() != mtime) {
+          status.getLastModificationTime().toEpochTime() != mtime ||
+          status.getSize() != size) {
         return false; // Out of date, or doesn't exist.
       }
+      V.ModuleModificationTime = status.getLastModificationTime();
+      V.ModuleSize = size;
     }
   }
 
+  auto storage = std::make_shared<CachedFileStorage>();
+  storage->Buffer = std::move(in);
+  V.Sink.Allocator =
+      CodeCompletionResultSink::AllocatorPtr(storage, &storage->Allocator);
+
   // DEBUG INFO
   cursor += read32le(cursor); // Skip the whole debug section.
 
@@ -167,7 +192,7 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 
     const char *p = strings + index;
     auto size = read32le(p);
-    return copyString(*V.Sink.Allocator, StringRef(p, size));
+    return StringRef(p, size);
   };
 
   // CHUNKS
@@ -257,6 +282,7 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 ///   HEADER
 ///     * version, which **must be bumped** if we change the format!
 ///     * mtime for the module file
+///     * size of the module file
 ///
 ///   KEY
 ///     * the original CodeCompletionCache::Key, used for debugging the cache.
@@ -272,6 +298,7 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 ///
 ///   STRINGS
 ///     * A blob of length-prefixed strings referred to in CHUNKS or RESULTS.
+///     * The chunk texts and module names are shared by all of their uses.
 static void writeCachedModule(llvm::raw_ostream &out,
                               const CodeCompletionCache::Key &K,
                               CodeCompletionCache::Value &V) {
@@ -282,6 +309,7 @@ static void writeCachedModule(llvm::raw_ostream &out,
   // Metadata required for reading the completions.
   LE.write(onDiskCompletionCacheVersion);           // Version
   LE.write(V.ModuleModificationTime.toEpochTime()); // Mtime for module file
+  LE.write(V.ModuleSize);                           // Size of module file
 
   // KEY
   // We don't need the stored key to load the results, but it is useful if we
@@ -320,6 +348,19 @@ static void writeCachedModule(llvm::raw_ostream &out,
     return static_cast<uint32_t>(size);
   };
 
+  // The strings which are only referred to by their index are written once,
+  // however many results use them. Runs of associated USRs and keywords are
+  // read sequentially, so those are always written in place.
+  llvm::StringMap<uint32_t> sharedStrings;
+  auto addSharedString = [&](StringRef str) {
+    if (str.empty())
+      return ~0u;
+    auto inserted = sharedStrings.insert(std::make_pair(str, 0));
+    if (inserted.second)
+      inserted.first->second = addString(str);
+    return inserted.first->second;
+  };
+
   auto addCompletionString = [&](const CodeCompletionString *str) {
     auto size = chunks.tell();
     chunksLE.write(static_cast<uint32_t>(str->getChunks().size()));
@@ -328,7 +369,7 @@ static void writeCachedModule(llvm::raw_ostream &out,
       chunksLE.write(static_cast<uint8_t>(chunk.getNestingLevel()));
       chunksLE.write(static_cast<uint8_t>(chunk.isAnnotation()));
       if (chunk.hasText()) {
-        chunksLE.write(addString(chunk.getText()));
+        chunksLE.write(addSharedString(chunk.getText()));
       } else {
         chunksLE.write(static_cast<uint32_t>(~0u));
       }
@@ -355,7 +396,7 @@ static void writeCachedModule(llvm::raw_ostream &out,
       LE.write(static_cast<uint8_t>(R->getNumBytesToErase()));
       LE.write(
           static_cast<uint32_t>(addCompletionString(R->getCompletionString())));
-      LE.write(addString(R->getModuleName()));      // index into strings
+      LE.write(addSharedString(R->getModuleName())); // index into strings
       LE.write(addString(R->getBriefDocComment())); // index into strings
       LE.write(static_cast<uint32_t>(R->getAssociatedUSRs().size()));
       if (R->getAssociatedUSRs().empty()) {
@@ -423,14 +464,17 @@ static std::string getName(StringRef cacheDirectory,
 
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::get(const Key &K) {
-  // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(getName(cacheDirectory, K));
+  // Try to find the cached file. Without a null terminator the file is mapped
+  // rather than read whenever it is large enough.
+  auto bufferOrErr =
+      llvm::MemoryBuffer::getFile(getName(cacheDirectory, K), /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
   if (!bufferOrErr)
     return None;
 
   // Read the cached results, failing if they are out of date.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V))
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V))
     return None;
 
   return V;
@@ -466,7 +510,8 @@ std::error_code OnDiskCodeCompletionCache::set(const Key &K, ValueRefCntPtr V) {
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
   // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(filename);
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(
+      filename, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
   if (!bufferOrErr)
     return None;
 
@@ -475,7 +520,7 @@ OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
 
   // Read the cached results.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V,
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V,
                         /*allowOutOfDate*/ true))
     return None;
 
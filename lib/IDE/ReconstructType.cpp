@@ -15,6 +15,7 @@
 #include "swift/AST/Mangle.h"
 #include "swift/AST/NameLookup.h"
 #include "swift/Basic/Demangle.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/Strings.h"
@@ -900,7 +901,8 @@ static void VisitNodeAssociatedTypeRef(
   }
   result._types.clear();
   result._error = stringWithFormat(
-      "unable to find associated type %s in context", ident->getText().c_str());
+      "unable to find associated type %s in context",
+      ident->getText().str().c_str());
 }
 
 static void VisitNodeBoundGeneric(
@@ -1376,7 +1378,7 @@ static void VisitNodeFunction(
       if (decl_scope_result._decls.size() == 0) {
         result._error = stringWithFormat(
             "demangled identifier %s could not be found by name lookup",
-            (*pos)->getText().c_str());
+            (*pos)->getText().str().c_str());
         break;
       }
       std::copy(decl_scope_result._decls.begin(),
@@ -1543,7 +1545,7 @@ static void VisitNodeSetterGetter(
       VisitNode(ast, nodes, decl_ctx_result, generic_context);
       break;
     case Demangle::Node::Kind::Identifier:
-      identifier.assign((*pos)->getText());
+      identifier.assign((*pos)->getText().str());
       break;
     case Demangle::Node::Kind::Type:
       nodes.push_back(*pos);
@@ -1712,7 +1714,7 @@ static void VisitNodeIdentifier(
     if (result._error.empty())
       result._error =
           stringWithFormat("unable to find Node::Kind::Identifier '%s'",
-                           cur_node->getText().c_str());
+                           cur_node->getText().str().c_str());
   }
 }
 
@@ -1771,7 +1773,8 @@ static void VisitNodePrivateDeclName(
     if (result._error.empty())
       result._error = stringWithFormat(
           "unable to find Node::Kind::PrivateDeclName '%s' in '%s'",
-          id_node->getText().c_str(), priv_decl_id_node->getText().c_str());
+          id_node->getText().str().c_str(),
+          priv_decl_id_node->getText().str().c_str());
   }
 }
 
@@ -1835,8 +1838,8 @@ static void VisitNodeModule(
     Demangle::NodePointer &cur_node, VisitNodeResult &result,
     const VisitNodeResult &generic_context) { // set by GenericType case
   std::string error;
-  const char *module_name = cur_node->getText().c_str();
-  if (!module_name || *module_name == '\0') {
+  std::string module_name = cur_node->getText();
+  if (module_name.empty()) {
     result._error = stringWithFormat("error: empty module name.");
     return;
   }
@@ -1845,7 +1848,7 @@ static void VisitNodeModule(
       DeclsLookupSource::GetDeclsLookupSource(*ast, ConstString(module_name));
   if (!result._module) {
     result._error = stringWithFormat("unable to load module '%s' (%s)",
-                                     module_name, error.data());
+                                     module_name.c_str(), error.data());
   }
 }
 
@@ -2008,14 +2011,14 @@ static void VisitNodeTupleElement(
     ASTContext *ast, std::vector<Demangle::NodePointer> &nodes,
     Demangle::NodePointer &cur_node, VisitNodeResult &result,
     const VisitNodeResult &generic_context) { // set by GenericType case
-  const char *tuple_name = NULL;
+  Optional<StringRef> tuple_name;
   VisitNodeResult tuple_type_result;
   Demangle::Node::iterator end = cur_node->end();
   for (Demangle::Node::iterator pos = cur_node->begin(); pos != end; ++pos) {
     const Demangle::Node::Kind child_node_kind = (*pos)->getKind();
     switch (child_node_kind) {
     case Demangle::Node::Kind::TupleElementName:
-      tuple_name = (*pos)->getText().c_str();
+      tuple_name = (*pos)->getText();
       break;
     case Demangle::Node::Kind::Type:
       nodes.push_back((*pos)->getFirstChild());
@@ -2031,7 +2034,7 @@ static void VisitNodeTupleElement(
     if (tuple_name)
       result._tuple_type_element =
           TupleTypeElt(tuple_type_result._types.front().getPointer(),
-                       ast->getIdentifier(tuple_name));
+                       ast->getIdentifier(*tuple_name));
     else
       result._tuple_type_element =
           TupleTypeElt(tuple_type_result._types.front().getPointer());
@@ -2328,9 +2331,10 @@ Decl *ide::getDeclFromUSR(ASTContext &context, StringRef USR,
 Decl *ide::getDeclFromMangledSymbolName(ASTContext &context,
                                         StringRef mangledName,
                                         std::string &error) {
+  Demangle::NodeFactory factory;
   std::vector<Demangle::NodePointer> nodes;
-  nodes.push_back(
-      Demangle::demangleSymbolAsNode(mangledName.data(), mangledName.size()));
+  nodes.push_back(Demangle::demangleSymbolAsNode(mangledName.data(),
+                                                 mangledName.size(), factory));
   VisitNodeResult emptyGenericContext;
   VisitNodeResult result;
   VisitNode(&context, nodes, result, emptyGenericContext);
@@ -2345,44 +2349,89 @@ Decl *ide::getDeclFromMangledSymbolName(ASTContext &context,
   return nullptr;
 }
 
+/// Returns the entry of ASTContext::ReconstructedTypes for \p mangledName,
+/// which is empty if the name wasn't reconstructed since the last module
+/// was loaded.
+static std::pair<Type, std::string> &
+lookupReconstructedType(ASTContext &Ctx, char prefix, StringRef mangledName,
+                        bool &found) {
+  if (Ctx.ReconstructedTypesModuleCount != Ctx.LoadedModules.size()) {
+    if (!Ctx.ReconstructedTypes.empty()) {
+      Ctx.ReconstructedTypes.clear();
+      if (auto *Stats = Ctx.Stats)
+        Stats->getFrontendCounters().NumTypeReconstructionCacheFlushes++;
+    }
+    Ctx.ReconstructedTypesModuleCount = Ctx.LoadedModules.size();
+  }
+  if (auto *Stats = Ctx.Stats)
+    Stats->getFrontendCounters().NumTypeReconstructions++;
+
+  llvm::SmallString<64> key;
+  key.push_back(prefix);
+  key += mangledName;
+  auto inserted = Ctx.ReconstructedTypes.insert({key, {}});
+  found = !inserted.second;
+  if (found) {
+    if (auto *Stats = Ctx.Stats)
+      Stats->getFrontendCounters().NumTypeReconstructionCacheHits++;
+  }
+  return inserted.first->second;
+}
+
 Type ide::getTypeFromMangledTypename(ASTContext &Ctx,
                                      StringRef mangledName,
                                      std::string &error) {
+  bool found;
+  auto &cached = lookupReconstructedType(Ctx, 'T', mangledName, found);
+  if (found) {
+    error = cached.second;
+    return cached.first;
+  }
+
+  Demangle::NodeFactory factory;
   std::vector<Demangle::NodePointer> nodes;
-  nodes.push_back(
-      Demangle::demangleTypeAsNode(mangledName.data(), mangledName.size()));
+  nodes.push_back(Demangle::demangleTypeAsNode(mangledName.data(),
+                                               mangledName.size(), factory));
   VisitNodeResult empty_generic_context;
   VisitNodeResult result;
 
   VisitNode(&Ctx, nodes, result, empty_generic_context);
   error = result._error;
   if (error.empty() && result._types.size() == 1) {
-    return result._types.front().getPointer();
+    cached.first = result._types.front().getPointer();
   } else {
     error = stringWithFormat("type for typename '%s' was not found",
                              mangledName);
-    return Type();
   }
-  return Type();
+  cached.second = error;
+  return cached.first;
 }
 
 Type ide::getTypeFromMangledSymbolname(ASTContext &Ctx,
                                        StringRef mangledName,
                                        std::string &error) {
+  bool found;
+  auto &cached = lookupReconstructedType(Ctx, 'S', mangledName, found);
+  if (found) {
+    error = cached.second;
+    return cached.first;
+  }
+
+  Demangle::NodeFactory factory;
   std::vector<Demangle::NodePointer> nodes;
-  nodes.push_back(
-      Demangle::demangleSymbolAsNode(mangledName.data(), mangledName.size()));
+  nodes.push_back(Demangle::demangleSymbolAsNode(mangledName.data(),
+                                                 mangledName.size(), factory));
   VisitNodeResult empty_generic_context;
   VisitNodeResult result;
 
   VisitNode(&Ctx, nodes, result, empty_generic_context);
   error = result._error;
   if (error.empty() && result._types.size() == 1) {
-    return result._types.front().getPointer();
+    cached.first = result._types.front().getPointer();
   } else {
     error = stringWithFormat("type for symbolname '%s' was not found",
                              mangledName);
-    return Type();
   }
-  return Type();
+  cached.second = error;
+  return cached.first;
 }
@@ -1271,7 +1271,7 @@ namespace {
                          SILDeclRef::ConstructAtNaturalUncurryLevel,
                          /*isForeign=*/true);
       if (auto silFn = IGM.getSILModule().lookUpFunction(dtorRef))
-        return silFn->isDefinition();
+        return IGM.IRGen.hadSILFunctionDefinition(silFn);
 
       // The Objective-C thunk was never even declared, so it is not defined.
       return false;
@@ -26,6 +26,7 @@
 #include "swift/AST/TypeMemberVisitor.h"
 #include "swift/AST/Types.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/ClangImporter/ClangModule.h"
 #include "swift/SIL/FormalLinkage.h"
 #include "swift/SIL/SILDebugScope.h"
@@ -37,6 +38,7 @@
 #include "llvm/IR/TypeBuilder.h"
 #include "llvm/IR/Value.h"
 #include "llvm/IR/GlobalAlias.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ConvertUTF.h"
@@ -697,11 +699,14 @@ void IRGenModule::addObjCClass(llvm::Constant *classPtr, bool nonlazy) {
 /// runtime records will be emitted in this translation unit.
 void IRGenModule::addProtocolConformanceRecord(
                                        NormalProtocolConformance *conformance) {
+  if (!IRGen.needsConformanceRecords(conformance->getProtocol()))
+    return;
   ProtocolConformances.push_back(conformance);
 }
 
 static bool
-hasExplicitProtocolConformance(NominalTypeDecl *decl) {
+hasExplicitProtocolConformance(const IRGenerator &IRGen,
+                               NominalTypeDecl *decl) {
   auto conformances = decl->getAllConformances();
   for (auto conformance : conformances) {
     // inherited protocols do not emit explicit conformance records
@@ -715,6 +720,10 @@ hasExplicitProtocolConformance(NominalTypeDecl *decl) {
     if (P->isObjC())
       continue;
 
+    // neither do stripped conformances
+    if (!IRGen.needsConformanceRecords(P))
+      continue;
+
     // neither does AnyObject
     if (P->getKnownProtocolKind().hasValue() &&
         *P->getKnownProtocolKind() == KnownProtocolKind::AnyObject)
@@ -731,7 +740,7 @@ void IRGenModule::addRuntimeResolvableType(CanType type) {
   // conformance table as the runtime will search both tables when resolving a
   // type by name.
   if (auto nom = type->getAnyNominal()) {
-    if (!hasExplicitProtocolConformance(nom))
+    if (!hasExplicitProtocolConformance(IRGen, nom))
       RuntimeResolvableTypes.push_back(type);
   }
 }
@@ -782,6 +791,11 @@ void IRGenModule::emitGlobalLists() {
 }
 
 void IRGenerator::emitGlobalTopLevel() {
+  // The existential types are collected before any function bodies are
+  // freed. Only in whole-module compilation are all uses in the module.
+  if (Opts.StripUnusedConformanceRecords && SIL.isWholeModule())
+    computeExistentialProtocols();
+
   // Generate order numbers for the functions in the SIL module that
   // correspond to definitions in the LLVM module.
   unsigned nextOrderNumber = 0;
@@ -795,6 +809,11 @@ void IRGenerator::emitGlobalTopLevel() {
     Decl *decl = v.getDecl();
     CurrentIGMPtr IGM = getGenModule(decl ? decl->getDeclContext() : nullptr);
     IGM->emitSILGlobalVariable(&v);
+
+    // emitSILStaticInitializers reads the initializer after the functions
+    // are emitted.
+    if (SILFunction *initializer = v.getInitializer())
+      RetainedSILFunctionBodies.insert(initializer);
   }
   PrimaryIGM->emitCoverageMapping();
   
@@ -903,6 +922,68 @@ void IRGenerator::emitLazyDefinitions() {
   }
 }
 
+void IRGenerator::noteEmittedSILFunction(SILFunction *f) {
+  if (!ReleasesSILFunctionBodies || RetainedSILFunctionBodies.count(f))
+    return;
+
+  // Later references to the function find the llvm::Function which has just
+  // been emitted, and don't need its body anymore.
+  f->convertToDeclaration();
+  ReleasedSILFunctionBodies.insert(f);
+}
+
+void IRGenerator::computeExistentialProtocols() {
+  StripsUnusedConformanceRecords = true;
+
+  auto addType = [&](Type type) {
+    if (!type)
+      return;
+    type.visit([&](Type t) {
+      SmallVector<ProtocolDecl *, 4> protocols;
+      if (t->isAnyExistentialType(protocols))
+        ExistentialProtocols.insert(protocols.begin(), protocols.end());
+    });
+  };
+  auto addSubstitutions = [&](ArrayRef<Substitution> subs) {
+    for (auto &sub : subs)
+      addType(sub.getReplacement());
+  };
+
+  for (SILGlobalVariable &v : SIL.getSILGlobals())
+    addType(v.getLoweredType().getSwiftRValueType());
+
+  for (SILFunction &f : SIL) {
+    addType(f.getLoweredFunctionType());
+    for (SILBasicBlock &bb : f) {
+      for (SILArgument *arg : bb.getBBArgs())
+        addType(arg->getType().getSwiftRValueType());
+      for (SILInstruction &i : bb) {
+        if (i.hasValue())
+          addType(i.getType().getSwiftRValueType());
+        for (auto &op : i.getAllOperands())
+          addType(op.get()->getType().getSwiftRValueType());
+        if (auto site = ApplySite::isa(&i))
+          addSubstitutions(site.getSubstitutions());
+        else if (auto *bi = dyn_cast<BuiltinInst>(&i))
+          addSubstitutions(bi->getSubstitutions());
+      }
+    }
+  }
+}
+
+bool IRGenerator::needsConformanceRecords(ProtocolDecl *proto) const {
+  if (!StripsUnusedConformanceRecords)
+    return true;
+
+  // Other modules may cast to public protocols.
+  if (proto->getEffectiveAccess() == Accessibility::Public)
+    return true;
+
+  // A dynamic cast to the protocol, even one to a generic type which is
+  // substituted with it, needs the existential type of the protocol.
+  return ExistentialProtocols.count(proto);
+}
+
 /// Emit symbols for eliminated dead methods, which can still be referenced
 /// from other modules. This happens e.g. if a public class contains a (dead)
 /// private method.
@@ -1320,11 +1401,30 @@ static void updateLinkageForDefinition(IRGenModule &IGM,
   }
 }
 
+StringRef IRGenModule::getMangledName(const LinkEntity &entity) {
+  if (auto *Stats = Context.Stats)
+    Stats->getFrontendCounters().NumLinkEntityManglings++;
+
+  StringRef &name = MangledNames[entity];
+  if (!name.empty()) {
+    if (auto *Stats = Context.Stats)
+      Stats->getFrontendCounters().NumLinkEntityManglingCacheHits++;
+    return name;
+  }
+
+  llvm::SmallString<128> buffer;
+  entity.mangle(buffer);
+  char *copy = MangledNameAllocator.Allocate<char>(buffer.size());
+  std::copy(buffer.begin(), buffer.end(), copy);
+  name = StringRef(copy, buffer.size());
+  return name;
+}
+
 LinkInfo LinkInfo::get(IRGenModule &IGM, const LinkEntity &entity,
                        ForDefinition_t isDefinition) {
   LinkInfo result;
 
-  entity.mangle(result.Name);
+  result.Name = IGM.getMangledName(entity);
 
   std::tie(result.Linkage, result.Visibility) =
     getIRLinkage(IGM, entity.getLinkage(IGM, isDefinition),
@@ -2095,6 +2195,17 @@ llvm::Constant *IRGenModule::emitProtocolConformances() {
                                       /*initializer*/ nullptr,
                                       "\x01l_protocol_conformances");
 
+  // Group the records by protocol, in order of first appearance. The runtime
+  // indexes a conformance section by protocol, which is cheap if the records
+  // of each object file form one run per protocol.
+  llvm::MapVector<ProtocolDecl *, SmallVector<NormalProtocolConformance *, 4>>
+    conformancesByProtocol;
+  for (auto *conformance : ProtocolConformances)
+    conformancesByProtocol[conformance->getProtocol()].push_back(conformance);
+  ProtocolConformances.clear();
+  for (auto &entry : conformancesByProtocol)
+    ProtocolConformances.append(entry.second.begin(), entry.second.end());
+
   SmallVector<llvm::Constant*, 8> elts;
   for (auto *conformance : ProtocolConformances) {
     emitAssociatedTypeMetadataRecord(conformance);
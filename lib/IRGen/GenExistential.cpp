@@ -1681,11 +1681,12 @@ Address irgen::emitOpenExistentialBox(IRGenFunction &IGF,
 }
 
 /// Allocate a boxed existential container with uninitialized space to hold a
-/// value of a given type.
+/// value of a given type, or with the value taken from \p initialValue.
 OwnedAddress irgen::emitBoxedExistentialContainerAllocation(IRGenFunction &IGF,
                                   SILType destType,
                                   CanType formalSrcType,
-                                ArrayRef<ProtocolConformanceRef> conformances) {
+                                ArrayRef<ProtocolConformanceRef> conformances,
+                                Address initialValue) {
   // TODO: Non-ErrorProtocol boxed existentials.
   assert(_isErrorProtocol(destType));
 
@@ -1700,12 +1701,17 @@ OwnedAddress irgen::emitBoxedExistentialContainerAllocation(IRGenFunction &IGF,
                                      conformances[0]);
   
   // Call the runtime to allocate the box.
-  // TODO: When there's a store or copy_addr immediately into the box, peephole
-  // it into the initializer parameter to allocError.
+  // TODO: Also pass the source of a copy_addr immediately into the box as the
+  // initializer parameter to allocError.
+  llvm::Value *initialValuePtr =
+    llvm::ConstantPointerNull::get(IGF.IGM.OpaquePtrTy);
+  if (initialValue.isValid())
+    initialValuePtr = IGF.Builder.CreateBitCast(initialValue.getAddress(),
+                                                IGF.IGM.OpaquePtrTy);
   auto result = IGF.Builder.CreateCall(IGF.IGM.getAllocErrorFn(),
-                         {srcMetadata, witness,
-                           llvm::ConstantPointerNull::get(IGF.IGM.OpaquePtrTy),
-                           llvm::ConstantInt::get(IGF.IGM.Int1Ty, 0)});
+                         {srcMetadata, witness, initialValuePtr,
+                           llvm::ConstantInt::get(IGF.IGM.Int1Ty,
+                                                  initialValue.isValid())});
   
   // Extract the box and value address from the result.
   auto box = IGF.Builder.CreateExtractValue(result, 0);
@@ -64,11 +64,13 @@ namespace irgen {
                                  ArrayRef<ProtocolConformanceRef> conformances);
 
   /// Allocate a boxed existential container with uninitialized space to hold a
-  /// value of a given type.
+  /// value of a given type. If \p initialValue is valid, the value is taken
+  /// from there into the container instead.
   OwnedAddress emitBoxedExistentialContainerAllocation(IRGenFunction &IGF,
                                   SILType destType,
                                   CanType formalSrcType,
-                                 ArrayRef<ProtocolConformanceRef> conformances);
+                                 ArrayRef<ProtocolConformanceRef> conformances,
+                                 Address initialValue = Address());
   
   /// "Deinitialize" an existential container whose contained value is allocated
   /// but uninitialized, by deallocating the buffer owned by the container if any.
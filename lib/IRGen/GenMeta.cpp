@@ -123,9 +123,7 @@ static Address createPointerSizedGEP(IRGenFunction &IGF,
 // It should be removed when fixed. rdar://problem/22674524
 static llvm::Constant *getMangledTypeName(IRGenModule &IGM, CanType type,
                                       bool willBeRelativelyAddressed = false) {
-  auto name = LinkEntity::forTypeMangling(type);
-  llvm::SmallString<32> mangling;
-  name.mangle(mangling);
+  StringRef mangling = IGM.getMangledName(LinkEntity::forTypeMangling(type));
   return IGM.getAddrOfGlobalString(mangling, willBeRelativelyAddressed);
 }
 
@@ -1370,6 +1368,26 @@ static llvm::Function *getTypeMetadataAccessFunction(IRGenModule &IGM,
            ? !isa<BoundGenericType>(type)
            : !isa<UnboundGenericType>(type));
 
+  // A non-unique accessor would be emitted and optimized in every LLVM module
+  // which uses it. In multi-threaded compilation all of those modules end up
+  // in the same image, so define it just once, in the primary module, and
+  // let the others call that definition. performParallelIRGeneration turns
+  // the other declarations into external references and keeps the
+  // definition alive with weak linkage.
+  if (shouldDefine && IGM.IRGen.hasMultipleIGMs() &&
+      &IGM != IGM.IRGen.getPrimaryIGM() &&
+      getTypeMetadataAccessStrategy(IGM, type) ==
+        MetadataAccessStrategy::NonUniqueAccessor) {
+    (void) getTypeMetadataAccessFunction(*IGM.IRGen.getPrimaryIGM(), type,
+                                         ForDefinition, std::move(generator));
+
+    llvm::Function *accessor =
+      IGM.getAddrOfTypeMetadataAccessFunction(type, NotForDefinition);
+    accessor->setDoesNotThrow();
+    accessor->setDoesNotAccessMemory();
+    return accessor;
+  }
+
   llvm::Function *accessor =
     IGM.getAddrOfTypeMetadataAccessFunction(type, shouldDefine);
 
@@ -202,6 +202,21 @@ public:
     }
   }
 
+  bool getSwiftRetainablePointerOffsets(Size base,
+                          SmallVectorImpl<Size> &offsets) const override {
+    if (this->isPOD(ResilienceExpansion::Maximal))
+      return true;
+    for (auto &field : getFields()) {
+      if (field.isPOD()) continue;
+      if (field.getKind() != ElementLayout::Kind::Fixed)
+        return false;
+      if (!field.getTypeInfo().getSwiftRetainablePointerOffsets(
+                                base + field.getFixedByteOffset(), offsets))
+        return false;
+    }
+    return true;
+  }
+
   void destroy(IRGenFunction &IGF, Address addr, SILType T) const override {
     auto offsets = asImpl().getNonFixedOffsets(IGF, T);
     for (auto &field : getFields()) {
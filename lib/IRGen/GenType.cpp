@@ -74,6 +74,17 @@ bool TypeInfo::isSingleRetainablePointer(ResilienceExpansion expansion,
   return false;
 }
 
+bool TypeInfo::getSwiftRetainablePointerOffsets(Size base,
+                                   SmallVectorImpl<Size> &offsets) const {
+  if (isPOD(ResilienceExpansion::Maximal))
+    return true;
+  if (!isFixedSize() ||
+      !isSingleSwiftRetainablePointer(ResilienceExpansion::Maximal))
+    return false;
+  offsets.push_back(base);
+  return true;
+}
+
 ExplosionSchema TypeInfo::getSchema() const {
   ExplosionSchema schema;
   getSchema(schema);
@@ -1644,9 +1655,8 @@ llvm::StructType *IRGenModule::createNominalType(CanType type) {
     type = type.getNominalOrBoundGenericNominal()->getDeclaredType()
                                                  ->getCanonicalType();
 
-  llvm::SmallString<32> typeName;
-  LinkEntity::forTypeMangling(type).mangle(typeName);
-  return llvm::StructType::create(getLLVMContext(), typeName.str());
+  StringRef typeName = getMangledName(LinkEntity::forTypeMangling(type));
+  return llvm::StructType::create(getLLVMContext(), typeName);
 }
 
 /// createNominalType - Create a new nominal LLVM type for the given
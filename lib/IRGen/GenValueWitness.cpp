@@ -22,6 +22,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/AST/ASTContext.h"
+#include "swift/AST/IRGenOptions.h"
 #include "swift/AST/Types.h"
 #include "swift/SIL/TypeLowering.h"
 #include "llvm/ADT/SmallString.h"
@@ -568,6 +569,67 @@ static void emitInitializeArrayBackToFrontWitness(IRGenFunction &IGF,
   IGF.Builder.CreateRet(destArray.getAddress());
 }
 
+/// Values with at least this many native Swift references are copied and
+/// destroyed with swift_bulkRetain and swift_bulkRelease.
+static const unsigned MinBulkRefCountReferences = 2;
+
+/// If copying and destroying a value of the given type only has to retain
+/// and release several native Swift references, collect their byte offsets
+/// in \p offsets and return true.
+static bool getRefCountLayout(const TypeInfo &type,
+                              SmallVectorImpl<Size> &offsets) {
+  return type.isFixedSize() &&
+         type.getSwiftRetainablePointerOffsets(Size(0), offsets) &&
+         offsets.size() >= MinBulkRefCountReferences;
+}
+
+/// Return a constant array of the given reference offsets for a call to
+/// swift_bulkRetain or swift_bulkRelease, and set \p count to their number.
+static llvm::Constant *emitRefCountOffsets(IRGenModule &IGM,
+                                           ArrayRef<Size> offsets,
+                                           unsigned &count) {
+  SmallVector<llvm::Constant *, 4> elts;
+  for (auto offset : offsets)
+    elts.push_back(llvm::ConstantInt::get(IGM.Int32Ty, offset.getValue()));
+  auto arrayTy = llvm::ArrayType::get(IGM.Int32Ty, elts.size());
+  auto var = new llvm::GlobalVariable(IGM.Module, arrayTy, /*constant*/ true,
+                                      llvm::GlobalValue::PrivateLinkage,
+                                      llvm::ConstantArray::get(arrayTy, elts),
+                                      "bulk_refcount_offsets");
+  var->setUnnamedAddr(true);
+
+  count = elts.size();
+  auto zero = llvm::ConstantInt::get(IGM.Int32Ty, 0);
+  llvm::Constant *indices[] = {zero, zero};
+  return llvm::ConstantExpr::getInBoundsGetElementPtr(arrayTy, var, indices);
+}
+
+/// If copying and destroying a value of the given type only has to retain
+/// and release several native Swift references, return a constant array of
+/// their byte offsets and set \p count to their number. Otherwise, return
+/// null.
+static llvm::Constant *getBulkRefCountOffsets(IRGenModule &IGM,
+                                              const TypeInfo &type,
+                                              unsigned &count) {
+  SmallVector<Size, 4> offsets;
+  if (!getRefCountLayout(type, offsets))
+    return nullptr;
+  return emitRefCountOffsets(IGM, offsets, count);
+}
+
+/// Call swift_bulkRetain or swift_bulkRelease on the references in the
+/// value at \p addr.
+static void emitBulkRefCountCall(IRGenFunction &IGF, llvm::Constant *fn,
+                                 Address addr, llvm::Constant *offsets,
+                                 unsigned count) {
+  auto base = IGF.Builder.CreateBitCast(addr.getAddress(), IGF.IGM.Int8PtrTy);
+  auto call = IGF.Builder.CreateCall(fn,
+                        {base, offsets,
+                         llvm::ConstantInt::get(IGF.IGM.Int32Ty, count)});
+  call->setCallingConv(IGF.IGM.DefaultCC);
+  call->setDoesNotThrow();
+}
+
 /// Build a specific value-witness function.
 static void buildValueWitnessFunction(IRGenModule &IGM,
                                       llvm::Function *fn,
@@ -625,7 +687,13 @@ static void buildValueWitnessFunction(IRGenModule &IGM,
   case ValueWitness::Destroy: {
     Address object = getArgAs(IGF, argv, type, "object");
     getArgAsLocalSelfTypeMetadata(IGF, argv, abstractType);
-    type.destroy(IGF, object, concreteType);
+
+    unsigned count;
+    if (auto offsets = getBulkRefCountOffsets(IGM, type, count))
+      emitBulkRefCountCall(IGF, IGM.getNativeBulkReleaseFn(), object,
+                           offsets, count);
+    else
+      type.destroy(IGF, object, concreteType);
     IGF.Builder.CreateRetVoid();
     return;
   }
@@ -734,7 +802,19 @@ static void buildValueWitnessFunction(IRGenModule &IGM,
     Address src = getArgAs(IGF, argv, type, "src");
     getArgAsLocalSelfTypeMetadata(IGF, argv, abstractType);
 
-    type.initializeWithCopy(IGF, dest, src, concreteType);
+    // If all the value has to retain are several native references, copy
+    // its bits and retain them all with one call.
+    unsigned count;
+    if (auto offsets = getBulkRefCountOffsets(IGM, type, count)) {
+      auto &fixedTI = cast<FixedTypeInfo>(type);
+      IGF.Builder.CreateMemCpy(dest.getAddress(), src.getAddress(),
+                 fixedTI.getFixedSize().getValue(),
+                 std::min(dest.getAlignment(), src.getAlignment()).getValue());
+      emitBulkRefCountCall(IGF, IGM.getNativeBulkRetainFn(), dest,
+                           offsets, count);
+    } else {
+      type.initializeWithCopy(IGF, dest, src, concreteType);
+    }
     dest = IGF.Builder.CreateBitCast(dest, IGF.IGM.OpaquePtrTy);
     IGF.Builder.CreateRet(dest.getAddress());
     return;
@@ -999,6 +1079,103 @@ static llvm::Constant *getMemCpyFunction(IRGenModule &IGM,
   });
 }
 
+/// Build the name of a value witness which is shared by all types with the
+/// given size, alignment and native reference offsets.
+static void getRefCountLayoutFunctionName(llvm::SmallVectorImpl<char> &name,
+                                          StringRef prefix,
+                                          const FixedTypeInfo &fixedTI,
+                                          ArrayRef<Size> offsets) {
+  llvm::raw_svector_ostream nameStream(name);
+  nameStream << prefix;
+  nameStream << fixedTI.getFixedSize().getValue();
+  nameStream << '_';
+  nameStream << fixedTI.getFixedAlignment().getValue();
+  for (auto offset : offsets)
+    nameStream << '_' << offset.getValue();
+}
+
+/// Return a function which takes a pointer to a value with the given
+/// reference layout and releases all of its references.
+static llvm::Constant *getDestroyRefsFunction(IRGenModule &IGM,
+                                              const FixedTypeInfo &fixedTI,
+                                              ArrayRef<Size> offsets) {
+  llvm::SmallString<40> name;
+  getRefCountLayoutFunctionName(name, "__swift_destroy_refs", fixedTI,
+                                offsets);
+
+  llvm::Type *argTys[] = { IGM.Int8PtrTy, IGM.TypeMetadataPtrTy };
+  return IGM.getOrCreateHelperFunction(name, IGM.VoidTy, argTys,
+                                       [&](IRGenFunction &IGF) {
+    Address object(IGF.CurFn->arg_begin(), fixedTI.getFixedAlignment());
+    unsigned count;
+    auto offsetsArray = emitRefCountOffsets(IGM, offsets, count);
+    emitBulkRefCountCall(IGF, IGM.getNativeBulkReleaseFn(), object,
+                         offsetsArray, count);
+    IGF.Builder.CreateRetVoid();
+  });
+}
+
+/// Return a function which takes two pointers to values with the given
+/// reference layout, copies the second into the uninitialized first,
+/// and returns the first argument.
+static llvm::Constant *getInitWithCopyRefsFunction(IRGenModule &IGM,
+                                             const FixedTypeInfo &fixedTI,
+                                             ArrayRef<Size> offsets) {
+  llvm::SmallString<40> name;
+  getRefCountLayoutFunctionName(name, "__swift_initWithCopy_refs", fixedTI,
+                                offsets);
+
+  llvm::Type *argTys[] = { IGM.Int8PtrTy, IGM.Int8PtrTy, IGM.TypeMetadataPtrTy };
+  return IGM.getOrCreateHelperFunction(name, IGM.Int8PtrTy, argTys,
+                                       [&](IRGenFunction &IGF) {
+    auto it = IGF.CurFn->arg_begin();
+    Address dest(&*(it++), fixedTI.getFixedAlignment());
+    Address src(&*(it++), fixedTI.getFixedAlignment());
+    unsigned count;
+    auto offsetsArray = emitRefCountOffsets(IGM, offsets, count);
+    IGF.emitMemCpy(dest, src, fixedTI.getFixedSize());
+    emitBulkRefCountCall(IGF, IGM.getNativeBulkRetainFn(), dest,
+                         offsetsArray, count);
+    IGF.Builder.CreateRet(dest.getAddress());
+  });
+}
+
+/// Return a function which takes two pointers to values with the given
+/// reference layout, assigns a copy of the second to the first, and
+/// returns the first argument.
+static llvm::Constant *getAssignWithCopyRefsFunction(IRGenModule &IGM,
+                                               const FixedTypeInfo &fixedTI,
+                                               ArrayRef<Size> offsets) {
+  llvm::SmallString<40> name;
+  getRefCountLayoutFunctionName(name, "__swift_assignWithCopy_refs", fixedTI,
+                                offsets);
+
+  llvm::Type *argTys[] = { IGM.Int8PtrTy, IGM.Int8PtrTy, IGM.TypeMetadataPtrTy };
+  return IGM.getOrCreateHelperFunction(name, IGM.Int8PtrTy, argTys,
+                                       [&](IRGenFunction &IGF) {
+    auto it = IGF.CurFn->arg_begin();
+    Address dest(&*(it++), fixedTI.getFixedAlignment());
+    Address src(&*(it++), fixedTI.getFixedAlignment());
+    unsigned count;
+    auto offsetsArray = emitRefCountOffsets(IGM, offsets, count);
+
+    // Retain the new references before releasing the old ones, in case
+    // they are the same, and only release the old ones once the new value
+    // is stored.
+    auto bytesTy = llvm::ArrayType::get(IGM.Int8Ty,
+                                        fixedTI.getFixedSize().getValue());
+    Address old = IGF.createAlloca(bytesTy, fixedTI.getFixedAlignment(),
+                                   "old");
+    emitBulkRefCountCall(IGF, IGM.getNativeBulkRetainFn(), src,
+                         offsetsArray, count);
+    IGF.emitMemCpy(old, dest, fixedTI.getFixedSize());
+    IGF.emitMemCpy(dest, src, fixedTI.getFixedSize());
+    emitBulkRefCountCall(IGF, IGM.getNativeBulkReleaseFn(), old,
+                         offsetsArray, count);
+    IGF.Builder.CreateRet(dest.getAddress());
+  });
+}
+
 /// Return a function which takes two buffer arguments, copies
 /// a pointer from the second to the first, and returns the pointer.
 static llvm::Constant *getCopyOutOfLinePointerFunction(IRGenModule &IGM) {
@@ -1095,6 +1272,14 @@ static llvm::Constant *getValueWitness(IRGenModule &IGM,
                                        CanType abstractType,
                                        SILType concreteType,
                                        const TypeInfo &concreteTI) {
+  // If the type's values only hold native references, its copy and destroy
+  // witnesses can be shared with all types of the same layout.
+  SmallVector<Size, 4> refOffsets;
+  const FixedTypeInfo *layoutTI = nullptr;
+  if (IGM.IRGen.Opts.UseLayoutValueWitnesses &&
+      getRefCountLayout(concreteTI, refOffsets))
+    layoutTI = &cast<FixedTypeInfo>(concreteTI);
+
   // Try to use a standard function.
   switch (index) {
   case ValueWitness::DeallocateBuffer:
@@ -1109,6 +1294,9 @@ static llvm::Constant *getValueWitness(IRGenModule &IGM,
     } else if (concreteTI.isSingleSwiftRetainablePointer(ResilienceExpansion::Maximal)) {
       assert(isNeverAllocated(packing));
       return asOpaquePtr(IGM, getDestroyStrongFunction(IGM));
+    } else if (layoutTI && isNeverAllocated(packing)) {
+      return asOpaquePtr(IGM, getDestroyRefsFunction(IGM, *layoutTI,
+                                                     refOffsets));
     }
     goto standard;
 
@@ -1117,6 +1305,9 @@ static llvm::Constant *getValueWitness(IRGenModule &IGM,
       return asOpaquePtr(IGM, getNoOpVoidFunction(IGM));
     } else if (concreteTI.isSingleSwiftRetainablePointer(ResilienceExpansion::Maximal)) {
       return asOpaquePtr(IGM, getDestroyStrongFunction(IGM));
+    } else if (layoutTI) {
+      return asOpaquePtr(IGM, getDestroyRefsFunction(IGM, *layoutTI,
+                                                     refOffsets));
     }
     goto standard;
 
@@ -1135,6 +1326,9 @@ static llvm::Constant *getValueWitness(IRGenModule &IGM,
         return asOpaquePtr(IGM, getMemCpyFunction(IGM, concreteTI));
       } else if (concreteTI.isSingleSwiftRetainablePointer(ResilienceExpansion::Maximal)) {
         return asOpaquePtr(IGM, getInitWithCopyStrongFunction(IGM));
+      } else if (layoutTI) {
+        return asOpaquePtr(IGM, getInitWithCopyRefsFunction(IGM, *layoutTI,
+                                                            refOffsets));
       }
     }
     goto standard;
@@ -1177,6 +1371,9 @@ static llvm::Constant *getValueWitness(IRGenModule &IGM,
       return asOpaquePtr(IGM, getMemCpyFunction(IGM, concreteTI));
     } else if (concreteTI.isSingleSwiftRetainablePointer(ResilienceExpansion::Maximal)) {
       return asOpaquePtr(IGM, getAssignWithCopyStrongFunction(IGM));
+    } else if (layoutTI) {
+      return asOpaquePtr(IGM, getAssignWithCopyRefsFunction(IGM, *layoutTI,
+                                                            refOffsets));
     }
     goto standard;
 
@@ -1193,6 +1390,9 @@ static llvm::Constant *getValueWitness(IRGenModule &IGM,
       return asOpaquePtr(IGM, getMemCpyFunction(IGM, concreteTI));
     } else if (concreteTI.isSingleSwiftRetainablePointer(ResilienceExpansion::Maximal)) {
       return asOpaquePtr(IGM, getInitWithCopyStrongFunction(IGM));
+    } else if (layoutTI) {
+      return asOpaquePtr(IGM, getInitWithCopyRefsFunction(IGM, *layoutTI,
+                                                          refOffsets));
     }
     goto standard;
 
@@ -21,14 +21,17 @@
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/LinkLibrary.h"
 #include "swift/SIL/SILModule.h"
+#include "swift/Basic/Defer.h"
 #include "swift/Basic/Dwarf.h"
 #include "swift/Basic/Platform.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/Timer.h"
 #include "swift/Basic/Version.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/LLVMPasses/PassesFwd.h"
 #include "swift/LLVMPasses/Passes.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/BasicTTIImpl.h"
@@ -300,6 +303,14 @@ static void getHashOfModule(MD5::MD5Result &Result, IRGenOptions &Opts,
 
 /// Returns false if the hash of the current module \p HashData matches the
 /// hash which is stored in an existing output object file.
+///
+/// The whole object file is the unit of reuse. Reusing the output of
+/// individual functions would not be correct with optimization: the LLVM
+/// inliner and interprocedural passes make the code of a function depend on
+/// the bodies of its callees in the same module. A per-function cache
+/// would need its key to include everything the function was optimized
+/// against, and the object file writer would need to splice cached machine
+/// code into a fresh object file. Neither exists here.
 static bool needsRecompile(StringRef OutputFilename, ArrayRef<uint8_t> HashData,
                            llvm::GlobalVariable *HashGlobal,
                            llvm::sys::Mutex *DiagMutex) {
@@ -571,6 +582,18 @@ static void initLLVMModule(const IRGenModule &IGM) {
 
 /// Generates LLVM IR, runs the LLVM passes and produces the output file.
 /// All this is done in a single thread.
+/// Add the contents of the module emitted by IRGen to the counters of this
+/// compilation job.
+static void countStatsPostIRGen(UnifiedStatsReporter &Stats,
+                                const llvm::Module &Module) {
+  auto &Counters = Stats.getFrontendCounters();
+  Counters.NumIRGlobals += Module.getGlobalList().size();
+  Counters.NumIRFunctions += Module.getFunctionList().size();
+  for (const llvm::Function &F : Module)
+    for (const llvm::BasicBlock &BB : F)
+      Counters.NumIRInstructions += BB.size();
+}
+
 static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
                                                          swift::Module *M,
                                                          SILModule *SILMod,
@@ -582,6 +605,7 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
   assert(!Ctx.hadError());
 
   IRGenerator irgen(Opts, *SILMod);
+  irgen.setReleasesSILFunctionBodies(Opts.ReleaseSILFunctionBodies && !SF);
 
   auto targetMachine = irgen.createTargetMachine();
   if (!targetMachine) return nullptr;
@@ -661,6 +685,9 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
     setModuleFlags(IGM);
   }
 
+  if (auto *Stats = Ctx.Stats)
+    countStatsPostIRGen(*Stats, *IGM.getModule());
+
   // Bail out if there are any errors.
   if (Ctx.hadError()) return nullptr;
 
@@ -674,6 +701,18 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
 
 static void ThreadEntryPoint(IRGenerator *irgen,
                              llvm::sys::Mutex *DiagMutex, int ThreadIdx) {
+  // Record how long each thread was busy, to see how well the work was
+  // balanced between them.
+  llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime(true);
+  defer {
+    if (auto *Stats = irgen->SIL.getASTContext().Stats) {
+      llvm::TimeRecord Elapsed = llvm::TimeRecord::getCurrentTime(false);
+      Elapsed -= StartTime;
+      Stats->recordTime("LLVM.thread" + llvm::utostr(ThreadIdx),
+                        Elapsed);
+    }
+  };
+
   while (IRGenModule *IGM = irgen->fetchFromQueue()) {
     DEBUG(
       DiagMutex->lock();
@@ -702,6 +741,7 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
                                         StringRef ModuleName, int numThreads) {
 
   IRGenerator irgen(Opts, *SILMod);
+  irgen.setReleasesSILFunctionBodies(Opts.ReleaseSILFunctionBodies);
 
   // Enter a cleanup to delete all the IGMs and their associated LLVMContexts
   // that have been associated with the IRGenerator.
@@ -853,11 +893,16 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
       return;
 
     setModuleFlags(*IGM);
+
+    if (auto *Stats = IGM->Context.Stats)
+      countStatsPostIRGen(*Stats, *IGM->getModule());
   }
 
   // Bail out if there are any errors.
   if (Ctx.hadError()) return;
 
+  irgen.sortQueueBySize();
+
   std::vector<std::thread> Threads;
   llvm::sys::Mutex DiagMutex;
 
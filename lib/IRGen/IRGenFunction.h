@@ -222,6 +222,10 @@ public:
   /// Mark a load as dereferenceable to `size` bytes.
   void setDereferenceableLoad(llvm::LoadInst *load, unsigned size);
 
+  /// Return the instruction at the start of the entry block.  Code which
+  /// only uses the function's arguments can be inserted before it.
+  llvm::Instruction *getEntryInsertionPoint() const { return AllocaIP; }
+
 private:
   llvm::Instruction *AllocaIP;
   const SILDebugScope *DbgScope;
@@ -467,9 +471,9 @@ public:
     // If the point is universal, it dominates.
     if (point.isUniversal()) return true;
 
-    assert(!ActiveDominancePoint.isUniversal() &&
-           "active dominance point is universal but there exists a"
-           "non-universal point?");
+    // If the active point is universal, we are emitting code at the start
+    // of the function, which nothing else dominates.
+    if (ActiveDominancePoint.isUniversal()) return false;
 
     // If we don't have a resolver, we're emitting a simple helper
     // function; just assume dominance.
@@ -48,6 +48,7 @@
 #include "IRGenDebugInfo.h"
 #include "Linking.h"
 
+#include <algorithm>
 #include <initializer_list>
 
 using namespace swift;
@@ -1039,6 +1040,22 @@ void IRGenerator::addGenModule(SourceFile *SF, IRGenModule *IGM) {
   Queue.push_back(IGM);
 }
 
+void IRGenerator::sortQueueBySize() {
+  // The number of LLVM instructions is a good enough estimate of how long
+  // LLVM takes to optimize and compile a module.
+  llvm::DenseMap<IRGenModule *, size_t> Sizes;
+  for (IRGenModule *IGM : Queue) {
+    size_t &Size = Sizes[IGM];
+    for (const llvm::Function &F : *IGM->getModule())
+      for (const llvm::BasicBlock &BB : F)
+        Size += BB.size();
+  }
+  std::stable_sort(Queue.begin(), Queue.end(),
+                   [&](IRGenModule *LHS, IRGenModule *RHS) {
+    return Sizes[LHS] > Sizes[RHS];
+  });
+}
+
 IRGenModule *IRGenerator::getGenModule(DeclContext *ctxt) {
   if (GenModules.size() == 1 || !ctxt) {
     return getPrimaryIGM();
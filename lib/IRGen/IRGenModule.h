@@ -35,6 +35,7 @@
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/IR/Attributes.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Target/TargetMachine.h"
 #include "IRGen.h"
 #include "SwiftTargetInfo.h"
@@ -207,6 +208,24 @@ private:
   /// appear in the translation unit.
   llvm::DenseMap<SILFunction*, unsigned> FunctionOrder;
 
+  /// Whether the bodies of SIL functions are freed once they are emitted.
+  bool ReleasesSILFunctionBodies = false;
+
+  /// The functions whose bodies are read after they are emitted, and which
+  /// therefore must not be freed: the static initializers of globals.
+  llvm::SmallPtrSet<SILFunction*, 4> RetainedSILFunctionBodies;
+
+  /// The functions whose bodies were freed after they were emitted.
+  llvm::SmallPtrSet<SILFunction*, 32> ReleasedSILFunctionBodies;
+
+  /// Whether conformance records are only emitted for the protocols in
+  /// ExistentialProtocols, and the non-public ones which aren't in it get
+  /// none.
+  bool StripsUnusedConformanceRecords = false;
+
+  /// The protocols which are used in existential types in the SIL module.
+  llvm::SmallPtrSet<ProtocolDecl*, 16> ExistentialProtocols;
+
   /// The queue of IRGenModules for multi-threaded compilation.
   SmallVector<IRGenModule *, 8> Queue;
 
@@ -272,6 +291,29 @@ public:
 
   /// Emit everything which is reachable from already emitted IR.
   void emitLazyDefinitions();
+
+  /// Free the bodies of SIL functions once they are emitted. Only valid in
+  /// whole-module compilation, in which no later IRGen reads them.
+  void setReleasesSILFunctionBodies(bool value) {
+    ReleasesSILFunctionBodies = value;
+  }
+
+  /// Called after the body of \p f has been emitted.
+  void noteEmittedSILFunction(SILFunction *f);
+
+  /// Collects the protocols used in existential types in the SIL module,
+  /// which must be done before any SIL function bodies are freed.
+  void computeExistentialProtocols();
+
+  /// Returns true if conformances to \p proto need conformance records,
+  /// because the runtime may look them up in a dynamic cast.
+  bool needsConformanceRecords(ProtocolDecl *proto) const;
+
+  /// Returns true if \p f is a definition, or was one before its body was
+  /// freed.
+  bool hadSILFunctionDefinition(SILFunction *f) const {
+    return f->isDefinition() || ReleasedSILFunctionBodies.count(f);
+  }
   
   void addLazyFunction(SILFunction *f) {
     // Add it to the queue if it hasn't already been put there.
@@ -303,6 +345,14 @@ public:
     return it->second;
   }
   
+  /// In multi-threaded compilation, order the queue so that the largest
+  /// IRGenModules are compiled first.
+  ///
+  /// The threads fetch from the queue until it is empty. If a huge module
+  /// were fetched last, all other threads would sit idle while it is being
+  /// optimized and compiled.
+  void sortQueueBySize();
+
   /// In multi-threaded compilation fetch the next IRGenModule from the queue.
   IRGenModule *fetchFromQueue() {
     int idx = QueueIndex++;
@@ -624,6 +674,10 @@ public:
                                             ArrayRef<llvm::Type*> paramTypes,
                         llvm::function_ref<void(IRGenFunction &IGF)> generate);
 
+  /// Returns the mangled name of \p entity, which is only mangled the first
+  /// time it is asked for.
+  StringRef getMangledName(const LinkEntity &entity);
+
 private:
   llvm::Constant *getAddrOfClangGlobalDecl(clang::GlobalDecl global,
                                            ForDefinition_t forDefinition);
@@ -631,6 +685,8 @@ private:
   llvm::DenseMap<LinkEntity, llvm::Constant*> GlobalVars;
   llvm::DenseMap<LinkEntity, llvm::Constant*> GlobalGOTEquivalents;
   llvm::DenseMap<LinkEntity, llvm::Function*> GlobalFuncs;
+  llvm::DenseMap<LinkEntity, StringRef> MangledNames;
+  llvm::BumpPtrAllocator MangledNameAllocator;
   llvm::DenseSet<const clang::Decl *> GlobalClangDecls;
   llvm::StringMap<std::pair<llvm::GlobalVariable*, llvm::Constant*>>
     GlobalStrings;
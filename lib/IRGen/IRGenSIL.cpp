@@ -29,6 +29,7 @@
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Range.h"
 #include "swift/Basic/STLExtras.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/Pattern.h"
@@ -1242,8 +1243,11 @@ void IRGenModule::emitSILFunction(SILFunction *f) {
   if (f->isExternalDeclaration())
     return;
 
-  PrettyStackTraceSILFunction stackTrace("emitting IR", f);
-  IRGenSILFunction(*this, f).emitSILFunction();
+  {
+    PrettyStackTraceSILFunction stackTrace("emitting IR", f);
+    IRGenSILFunction(*this, f).emitSILFunction();
+  }
+  IRGen.noteEmittedSILFunction(f);
 }
 
 void IRGenSILFunction::emitSILFunction() {
@@ -1271,6 +1275,10 @@ void IRGenSILFunction::emitSILFunction() {
   if (IGM.DebugInfo)
     IGM.DebugInfo->emitFunction(*CurSILFn, CurFn);
 
+  // Pass the profile data on to the LLVM optimizer.
+  if (auto EntryCount = CurSILFn->getEntryCount())
+    CurFn->setEntryCount(*EntryCount);
+
   // Map the entry bb.
   LoweredBBs[&*CurSILFn->begin()] = LoweredBB(&*CurFn->begin(), {});
   // Create LLVM basic blocks for the other bbs.
@@ -2910,13 +2918,100 @@ void IRGenSILFunction::visitCondBranchInst(swift::CondBranchInst *i) {
   Builder.CreateCondBr(condValue, trueBB.bb, falseBB.bb);
 }
 
+/// The smallest number of reference counting operations in the copy or
+/// destroy of a value for which IRGen calls a shared outlined helper rather
+/// than emitting the operations inline.
+static const unsigned MinOutlinedRefCountOperations = 3;
+
+/// Decide whether copies and destroys of values of type \p type are done by
+/// calling an outlined helper. The cost model estimates the size of the
+/// inline sequence: the number of native references for types which only
+/// hold those and the number of scalars in the explosion otherwise, which
+/// also counts the tag tests of enums. Outlining only pays off if the
+/// sequence is larger than the call.
+static bool shouldOutlineValueOperations(IRGenModule &IGM, SILType type,
+                                         const LoadableTypeInfo &TI) {
+  if (!IGM.IRGen.Opts.UseOutlinedValueOperations)
+    return false;
+  // The helper has no generic context to take type metadata from.
+  if (type.hasArchetype())
+    return false;
+  if (TI.isPOD(ResilienceExpansion::Maximal) ||
+      TI.getExplosionSize() < MinOutlinedRefCountOperations)
+    return false;
+  auto schema = TI.getSchema();
+  if (schema.containsAggregate())
+    return false;
+
+  SmallVector<Size, 4> offsets;
+  if (TI.isFixedSize() && TI.getSwiftRetainablePointerOffsets(Size(0), offsets))
+    return offsets.size() >= MinOutlinedRefCountOperations;
+  return true;
+}
+
+/// Return the outlined helper which copies (if \p isCopy) or destroys an
+/// exploded value of type \p type. The helpers are shared by all functions
+/// in the image which copy or destroy values of the same type.
+static llvm::Constant *
+getOutlinedValueOperationFunction(IRGenModule &IGM, SILType type,
+                                  const LoadableTypeInfo &TI, bool isCopy,
+                                  irgen::Atomicity atomicity) {
+  SmallVector<llvm::Type *, 8> argTys;
+  for (auto &elt : TI.getSchema())
+    argTys.push_back(elt.getScalarType());
+
+  llvm::SmallString<64> name;
+  name += isCopy ? "__swift_outlined_copy_" : "__swift_outlined_destroy_";
+  llvm::SmallString<64> mangledType;
+  name += IGM.mangleType(type.getSwiftRValueType(), mangledType);
+  if (atomicity == irgen::Atomicity::NonAtomic)
+    name += "_nonatomic";
+
+  return IGM.getOrCreateHelperFunction(name, IGM.VoidTy, argTys,
+                                       [&](IRGenFunction &IGF) {
+    Explosion in;
+    for (auto &arg : IGF.CurFn->args())
+      in.add(&arg);
+    if (isCopy) {
+      Explosion out;
+      TI.copy(IGF, in, out, atomicity);
+      out.claimAll();
+    } else {
+      TI.consume(IGF, in, atomicity);
+    }
+    IGF.Builder.CreateRetVoid();
+  });
+}
+
+/// Copy or destroy the exploded value \p in of type \p type, by calling an
+/// outlined helper if the cost model prefers it.
+static void emitValueOperation(IRGenSILFunction &IGF, SILType type,
+                               Explosion &in, bool isCopy,
+                               irgen::Atomicity atomicity) {
+  auto &TI = cast<LoadableTypeInfo>(IGF.getTypeInfo(type));
+  if (!shouldOutlineValueOperations(IGF.IGM, type, TI)) {
+    if (isCopy) {
+      Explosion out;
+      TI.copy(IGF, in, out, atomicity);
+      out.claimAll();
+    } else {
+      TI.consume(IGF, in, atomicity);
+    }
+    return;
+  }
+
+  auto fn = getOutlinedValueOperationFunction(IGF.IGM, type, TI, isCopy,
+                                              atomicity);
+  auto call = IGF.Builder.CreateCall(fn, in.claimAll());
+  call->setCallingConv(IGF.IGM.DefaultCC);
+  call->setDoesNotThrow();
+}
+
 void IRGenSILFunction::visitRetainValueInst(swift::RetainValueInst *i) {
   Explosion in = getLoweredExplosion(i->getOperand());
-  Explosion out;
-  cast<LoadableTypeInfo>(getTypeInfo(i->getOperand()->getType()))
-      .copy(*this, in, out, i->isAtomic() ? irgen::Atomicity::Atomic
-                                          : irgen::Atomicity::NonAtomic);
-  out.claimAll();
+  emitValueOperation(*this, i->getOperand()->getType(), in, /*isCopy*/ true,
+                     i->isAtomic() ? irgen::Atomicity::Atomic
+                                   : irgen::Atomicity::NonAtomic);
 }
 
 // TODO: Implement this more generally for arbitrary values. Currently the
@@ -2965,9 +3060,9 @@ void IRGenSILFunction::visitSetDeallocatingInst(SetDeallocatingInst *i) {
 
 void IRGenSILFunction::visitReleaseValueInst(swift::ReleaseValueInst *i) {
   Explosion in = getLoweredExplosion(i->getOperand());
-  cast<LoadableTypeInfo>(getTypeInfo(i->getOperand()->getType()))
-      .consume(*this, in, i->isAtomic() ? irgen::Atomicity::Atomic
-                                        : irgen::Atomicity::NonAtomic);
+  emitValueOperation(*this, i->getOperand()->getType(), in, /*isCopy*/ false,
+                     i->isAtomic() ? irgen::Atomicity::Atomic
+                                   : irgen::Atomicity::NonAtomic);
 }
 
 void IRGenSILFunction::visitStructInst(swift::StructInst *i) {
@@ -3097,6 +3192,10 @@ void IRGenSILFunction::visitLoadInst(swift::LoadInst *i) {
 }
 
 void IRGenSILFunction::visitStoreInst(swift::StoreInst *i) {
+  // The value went into the box along with its allocation.
+  if (claimEmissionNote(i))
+    return;
+
   Explosion source = getLoweredExplosion(i->getSrc());
   Address dest = getLoweredAddress(i->getDest());
   auto &type = getTypeInfo(i->getSrc()->getType().getObjectType());
@@ -4256,6 +4355,17 @@ void IRGenSILFunction::visitInitExistentialAddrInst(swift::InitExistentialAddrIn
 
   auto &srcTI = getTypeInfo(i->getLoweredConcreteType());
 
+  // Count how often values end up in an out-of-line buffer.
+  if (auto *Stats = IGM.Context.Stats) {
+    auto &Counters = Stats->getFrontendCounters();
+    if (!srcTI.isFixedSize())
+      Counters.NumExistentialInitsDynamic++;
+    else if (srcTI.getFixedPacking(IGM) == FixedPacking::Allocate)
+      Counters.NumExistentialInitsBoxed++;
+    else
+      Counters.NumExistentialInitsInline++;
+  }
+
   // See if we can defer initialization of the buffer to a copy_addr into it.
   if (tryDeferFixedSizeBufferInitialization(*this, i, srcTI, i, buffer, ""))
     return;
@@ -4378,11 +4488,47 @@ void IRGenSILFunction::visitInitBlockStorageHeaderInst(
   setLoweredExplosion(i, e);
 }
 
+/// Returns the store which initializes the box of \p i right after its
+/// allocation, with a value which is lowered already, or null.
+static StoreInst *getStoreIntoNewBox(IRGenSILFunction &IGF,
+                                     AllocExistentialBoxInst *i) {
+  auto *project =
+    dyn_cast<ProjectExistentialBoxInst>(&*std::next(i->getIterator()));
+  if (!project || project->getOperand() != i)
+    return nullptr;
+  auto *store = dyn_cast<StoreInst>(&*std::next(project->getIterator()));
+  if (!store || store->getDest() != project ||
+      !IGF.LoweredValues.count(store->getSrc()))
+    return nullptr;
+  return store;
+}
+
 void IRGenSILFunction::visitAllocExistentialBoxInst(AllocExistentialBoxInst *i){
+  // Pass a value which is stored into the box right away to the runtime,
+  // which then doesn't need to allocate boxes for small trivial values.
+  StoreInst *store = getStoreIntoNewBox(*this, i);
+  if (!store) {
+    OwnedAddress boxWithAddr =
+      emitBoxedExistentialContainerAllocation(*this, i->getExistentialType(),
+                                              i->getFormalConcreteType(),
+                                              i->getConformances());
+    setLoweredBox(i, boxWithAddr);
+    return;
+  }
+
+  SILType valueType = store->getSrc()->getType();
+  auto &valueTI = cast<LoadableTypeInfo>(getTypeInfo(valueType));
+  ContainedAddress value = valueTI.allocateStack(*this, valueType,
+                                                 "error.value");
+  Explosion source = getLoweredExplosion(store->getSrc());
+  valueTI.initialize(*this, source, value.getAddress());
   OwnedAddress boxWithAddr =
     emitBoxedExistentialContainerAllocation(*this, i->getExistentialType(),
                                             i->getFormalConcreteType(),
-                                            i->getConformances());
+                                            i->getConformances(),
+                                            value.getAddress());
+  valueTI.deallocateStack(*this, value.getContainer(), valueType);
+  addEmissionNote(store);
   setLoweredBox(i, boxWithAddr);
 }
 
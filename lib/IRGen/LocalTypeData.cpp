@@ -91,6 +91,27 @@ llvm::Value *IRGenFunction::tryGetLocalTypeData(LocalTypeDataKey key) {
   return LocalTypeData->tryGet(*this, key);
 }
 
+/// Can a path from \p source, which is available from \p point, be
+/// followed at the start of the function?
+static bool canFollowAtEntry(IRGenFunction &IGF, DominancePoint point,
+                             llvm::Value *source) {
+  // Only bother when optimizing; at -Onone we want the code where the
+  // user expects it.
+  if (!IGF.IGM.IRGen.Opts.Optimize)
+    return false;
+
+  // The source must be available everywhere, and we must not already be
+  // emitting the entry block.
+  if (!point.isUniversal() || IGF.getActiveDominancePoint().isUniversal())
+    return false;
+
+  // Conditional entries must stay at the front of their chains.
+  if (IGF.isConditionalDominancePoint())
+    return false;
+
+  return isa<llvm::Argument>(source) || isa<llvm::Constant>(source);
+}
+
 llvm::Value *LocalTypeDataCache::tryGet(IRGenFunction &IGF, Key key,
                                         bool allowAbstract) {
   auto it = Map.find(key);
@@ -146,9 +167,22 @@ llvm::Value *LocalTypeDataCache::tryGet(IRGenFunction &IGF, Key key,
   // For abstract caches, we need to follow a path.
   case CacheEntry::Kind::Abstract: {
     auto entry = static_cast<AbstractCacheEntry*>(best);
+    auto &source = AbstractSources[entry->SourceIndex];
+
+    // If the source is one of the function's arguments, follow the path at
+    // the start of the function instead, so that the loads along it are
+    // cached for every block rather than redone in each branch.  Paths only
+    // consist of invariant loads from metadata, so this is cheap.
+    if (canFollowAtEntry(IGF, entry->DefinitionPoint, source.getValue())) {
+      llvm::IRBuilderBase::InsertPointGuard guard(IGF.Builder);
+      IRGenFunction::DominanceScope scope(IGF, DominancePoint::universal());
+      auto entryIP = IGF.getEntryInsertionPoint();
+      IGF.Builder.SetInsertPoint(entryIP->getParent(),
+                                 entryIP->getIterator());
+      return entry->follow(IGF, source);
+    }
 
     // Follow the path.
-    auto &source = AbstractSources[entry->SourceIndex];
     auto result = entry->follow(IGF, source);
 
     // Following the path automatically caches at every point along it,
@@ -414,6 +414,15 @@ public:
             refcounting == ReferenceCounting::Native);
   }
 
+  /// Collect the byte offsets, relative to \p base, of the native Swift
+  /// references which make up all of the non-POD contents of a value of
+  /// this type.
+  ///
+  /// \return false if the value has any other non-POD contents, or no fixed
+  /// layout.
+  virtual bool getSwiftRetainablePointerOffsets(Size base,
+                                   SmallVectorImpl<Size> &offsets) const;
+
   /// Does this type statically have extra inhabitants, or may it dynamically
   /// have extra inhabitants based on type arguments?
   virtual bool mayHaveExtraInhabitants(IRGenModule &IGM) const = 0;
@@ -27,15 +27,21 @@
 #include "swift/Frontend/Frontend.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/Basic/LLVM.h"
+#include "swift/Basic/Version.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
 #include <dlfcn.h>
@@ -277,8 +283,94 @@ bool swift::immediate::IRGenImportedModules(
   return hadError;
 }
 
+namespace {
+/// An object cache for MCJIT which keeps the machine code of the module
+/// being run in a directory, keyed by a hash of its IR and of the target.
+/// Running a script again unchanged then needs no code generation.
+///
+/// Entries are written by way of a temporary file and a rename, so several
+/// scripts may run from the same directory at once.
+class ImmediateObjectCache : public llvm::ObjectCache {
+  llvm::SmallString<128> EntryPath;
+
+public:
+  ImmediateObjectCache(StringRef Directory, StringRef Key)
+    : EntryPath(Directory) {
+    llvm::sys::path::append(EntryPath, Key + ".o");
+  }
+
+  void notifyObjectCompiled(const llvm::Module *M,
+                            llvm::MemoryBufferRef Obj) override {
+    // Failing to write the entry only means compiling again next time.
+    if (llvm::sys::fs::create_directories(
+          llvm::sys::path::parent_path(EntryPath)))
+      return;
+    int FD;
+    llvm::SmallString<128> TempPath;
+    if (llvm::sys::fs::createUniqueFile(EntryPath + "-%%%%%%%%", FD,
+                                        TempPath))
+      return;
+    {
+      llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+      Out << Obj.getBuffer();
+      Out.close();
+      if (Out.has_error()) {
+        Out.clear_error();
+        llvm::sys::fs::remove(TempPath);
+        return;
+      }
+    }
+    if (llvm::sys::fs::rename(TempPath, EntryPath))
+      llvm::sys::fs::remove(TempPath);
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer>
+  getObject(const llvm::Module *M) override {
+    auto Buffer = llvm::MemoryBuffer::getFile(EntryPath);
+    if (!Buffer)
+      return nullptr;
+    DEBUG(llvm::dbgs() << "Reusing machine code from " << EntryPath << '\n');
+    return std::move(Buffer.get());
+  }
+};
+} // end anonymous namespace
+
+/// Returns the key under which the machine code of \p Module is cached:
+/// a hash of its IR, of the compiler version, and of everything else which
+/// influences code generation.
+static std::string getObjectCacheKey(llvm::Module *Module,
+                                     IRGenOptions &IRGenOpts,
+                                     StringRef CPU,
+                                     ArrayRef<std::string> Features) {
+  llvm::SmallString<0> Bitcode;
+  {
+    llvm::raw_svector_ostream OS(Bitcode);
+    llvm::WriteBitcodeToFile(Module, OS);
+  }
+
+  llvm::MD5 Hash;
+  auto addString = [&](StringRef Str) {
+    Hash.update(Str);
+    Hash.update(StringRef("\0", 1));
+  };
+  addString(Bitcode);
+  addString(version::getSwiftFullVersion());
+  addString(std::to_string(IRGenOpts.getLLVMCodeGenOptionsHash()));
+  addString(Module->getTargetTriple());
+  addString(CPU);
+  for (auto &Feature : Features)
+    addString(Feature);
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  llvm::SmallString<32> Key;
+  llvm::MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
 int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
-                          IRGenOptions &IRGenOpts, const SILOptions &SILOpts) {
+                          IRGenOptions &IRGenOpts, const SILOptions &SILOpts,
+                          const std::string &CachePath) {
   ASTContext &Context = CI.getASTContext();
   
   // IRGen the main module.
@@ -323,11 +415,21 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
   builder.setMAttrs(Features);
   builder.setErrorStr(&ErrorMsg);
   builder.setEngineKind(llvm::EngineKind::JIT);
+
+  // The key is computed before the engine takes over the module.
+  std::unique_ptr<ImmediateObjectCache> ObjectCache;
+  if (!CachePath.empty()) {
+    ObjectCache.reset(new ImmediateObjectCache(
+        CachePath, getObjectCacheKey(Module, IRGenOpts, CPU, Features)));
+  }
+
   llvm::ExecutionEngine *EE = builder.create();
   if (!EE) {
     llvm::errs() << "Error loading JIT: " << ErrorMsg;
     return -1;
   }
+  if (ObjectCache)
+    EE->setObjectCache(ObjectCache.get());
 
   DEBUG(llvm::dbgs() << "Module to be executed:\n";
         Module->dump());
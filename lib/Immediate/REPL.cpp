@@ -762,7 +762,7 @@ private:
       function.setVisibility(llvm::GlobalValue::DefaultVisibility);
       if (FuncsAlreadyGenerated.count(function.getName()))
         function.deleteBody();
-      else {
+      else if (!function.isDeclaration()) {
         if (function.getName() != SWIFT_ENTRY_POINT_FUNCTION)
           FuncsAlreadyGenerated.insert(function.getName());
       }
@@ -870,15 +870,12 @@ private:
     // LineModule will get destroy by the following link process.
     // Make a copy of it to be able to correct produce DumpModule.
     std::unique_ptr<llvm::Module> SaveLineModule(CloneModule(LineModule.get()));
-    
-    if (!linkLLVMModules(Module, std::move(LineModule))) {
-      return false;
-    }
-
-    std::unique_ptr<llvm::Module> NewModule(CloneModule(Module));
-
-    Module->getFunction("main")->eraseFromParent();
 
+    // Hand only the current line(s) to the JIT. Whatever earlier lines
+    // already defined becomes an external declaration, which the JIT
+    // resolves against the modules it was given before, so the work for
+    // each input doesn't grow with the length of the session.
+    std::unique_ptr<llvm::Module> NewModule = std::move(LineModule);
     stripPreviouslyGenerated(*NewModule);
 
     if (!linkLLVMModules(&DumpModule, std::move(SaveLineModule))) {
@@ -0,0 +1,180 @@
+//===--- IndexRecord.cpp - Index records written while building -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Index/IndexRecord.h"
+#include "swift/AST/Module.h"
+#include "swift/Index/Index.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift;
+using namespace swift::index;
+using namespace llvm::support;
+
+namespace {
+/// Serializes the indexer's callbacks as the entries of a record.
+class IndexRecordWriter : public IndexDataConsumer {
+  StringRef Directory;
+  StringRef FileName;
+  std::string &Error;
+
+  std::vector<StringRef> Strings;
+  llvm::StringMap<uint32_t> StringIDs;
+  SmallString<1024> Entries;
+  llvm::raw_svector_ostream EntriesOS{Entries};
+  endian::Writer<little> Out{EntriesOS};
+
+public:
+  /// The path of the record, once the indexer reported the hash.
+  SmallString<128> RecordPath;
+  bool IsUpToDate = false;
+
+  IndexRecordWriter(StringRef Directory, StringRef FileName,
+                    std::string &Error)
+    : Directory(Directory), FileName(FileName), Error(Error) {}
+
+  void failed(StringRef error) override {
+    if (Error.empty())
+      Error = error;
+  }
+
+  bool recordHash(StringRef hash, bool isKnown) override {
+    RecordPath = Directory;
+    llvm::sys::path::append(RecordPath, FileName + "-" + hash);
+    RecordPath += ".swiftindex";
+    // Stop indexing if the record of this version of the file is there.
+    IsUpToDate = llvm::sys::fs::exists(RecordPath);
+    return !IsUpToDate;
+  }
+
+  bool startDependency(SymbolKind kind, StringRef name, StringRef path,
+                       bool isSystem, StringRef hash) override {
+    Out.write<uint8_t>('D');
+    Out.write<uint8_t>(uint8_t(kind));
+    Out.write<uint8_t>(isSystem);
+    writeString(name);
+    writeString(path);
+    writeString(hash);
+    return true;
+  }
+
+  bool finishDependency(SymbolKind kind) override {
+    Out.write<uint8_t>('d');
+    return true;
+  }
+
+  bool startSourceEntity(const IndexSymbol &symbol) override {
+    Out.write<uint8_t>('S');
+    writeSymbol(symbol);
+    return true;
+  }
+
+  bool recordRelatedEntity(const IndexSymbol &symbol) override {
+    Out.write<uint8_t>('R');
+    writeSymbol(symbol);
+    return true;
+  }
+
+  bool finishSourceEntity(SymbolKind kind, SymbolSubKindSet subKinds,
+                          SymbolRoleSet roles) override {
+    Out.write<uint8_t>('s');
+    Out.write<uint8_t>(uint8_t(kind));
+    Out.write<uint32_t>(subKinds);
+    Out.write<uint32_t>(roles);
+    return true;
+  }
+
+  /// Writes the record to RecordPath, by way of a temporary file.
+  bool write();
+
+private:
+  void writeString(StringRef str) {
+    auto Inserted = StringIDs.insert({str, Strings.size()});
+    if (Inserted.second)
+      Strings.push_back(Inserted.first->getKey());
+    Out.write<uint32_t>(Inserted.first->getValue());
+  }
+
+  void writeSymbol(const IndexSymbol &symbol) {
+    Out.write<uint8_t>(uint8_t(symbol.kind));
+    Out.write<uint32_t>(symbol.subKinds);
+    Out.write<uint32_t>(symbol.roles);
+    Out.write<uint32_t>(symbol.line);
+    Out.write<uint32_t>(symbol.column);
+    writeString(symbol.name);
+    writeString(symbol.USR);
+    writeString(symbol.group);
+    writeString(symbol.receiverUSR);
+  }
+};
+} // end anonymous namespace
+
+bool IndexRecordWriter::write() {
+  int FD;
+  SmallString<128> TempPath;
+  if (auto EC = llvm::sys::fs::createUniqueFile(RecordPath + "-%%%%%%%%", FD,
+                                                TempPath)) {
+    Error = EC.message();
+    return false;
+  }
+
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    endian::Writer<little> Header(OS);
+    OS << "SIDX";
+    Header.write<uint32_t>(IndexRecordVersion);
+    Header.write<uint32_t>(Strings.size());
+    for (StringRef Str : Strings) {
+      Header.write<uint32_t>(Str.size());
+      OS << Str;
+    }
+    OS << Entries;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      Error = "cannot write '" + TempPath.str().str() + "'";
+      return false;
+    }
+  }
+
+  if (auto EC = llvm::sys::fs::rename(TempPath, RecordPath)) {
+    llvm::sys::fs::remove(TempPath);
+    Error = EC.message();
+    return false;
+  }
+  return true;
+}
+
+IndexRecordStatus index::writeIndexRecord(SourceFile *SF, StringRef directory,
+                                          std::string &error) {
+  if (auto EC = llvm::sys::fs::create_directories(directory)) {
+    error = EC.message();
+    return IndexRecordStatus::Failed;
+  }
+
+  IndexRecordWriter Writer(directory,
+                           llvm::sys::path::filename(SF->getFilename()),
+                           error);
+  indexSourceFile(SF, /*hash=*/StringRef(), Writer);
+  if (Writer.IsUpToDate)
+    return IndexRecordStatus::UpToDate;
+  if (!error.empty() || Writer.RecordPath.empty())
+    return IndexRecordStatus::Failed;
+  if (!Writer.write())
+    return IndexRecordStatus::Failed;
+  return IndexRecordStatus::Written;
+}
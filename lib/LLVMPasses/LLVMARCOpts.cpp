@@ -68,6 +68,14 @@ DisableARCOpts("disable-llvm-arc-opts", llvm::cl::init(false));
 //                          Input Function Canonicalizer
 //===----------------------------------------------------------------------===//
 
+/// Returns true if \p V is one of the statically initialized objects of the
+/// runtime, which have an immortal reference count, so that retaining and
+/// releasing them does nothing.
+static bool isImmortalObject(Value *V) {
+  auto *Global = dyn_cast<GlobalVariable>(V->stripPointerCasts());
+  return Global && Global->getName() == "_swiftEmptyArrayStorage";
+}
+
 /// canonicalizeInputFunction - Functions like swift_retain return an
 /// argument as a low-level performance optimization.  This makes it difficult
 /// to reason about pointer equality though, so undo it as an initial
@@ -99,23 +107,34 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
       case RT_BridgeReleaseN:
         llvm_unreachable("These are only created by LLVMARCContract !");
       case RT_Unknown:
-      case RT_BridgeRelease:
       case RT_AllocObject:
       case RT_FixLifetime:
       case RT_NoMemoryAccessed:
       case RT_RetainUnowned:
       case RT_CheckUnowned:
         break;
-      case RT_Retain: {
+      case RT_BridgeRelease: {
         CallInst &CI = cast<CallInst>(Inst);
         Value *ArgVal = RC->getSwiftRCIdentityRoot(CI.getArgOperand(0));
-        // retain(null) is a no-op.
+        // bridgeRelease(null) is a no-op.
         if (isa<ConstantPointerNull>(ArgVal)) {
           CI.eraseFromParent();
           Changed = true;
           ++NumNoopDeleted;
           continue;
         }
+        break;
+      }
+      case RT_Retain: {
+        CallInst &CI = cast<CallInst>(Inst);
+        Value *ArgVal = RC->getSwiftRCIdentityRoot(CI.getArgOperand(0));
+        // retain(null) is a no-op, as is retaining an immortal object.
+        if (isa<ConstantPointerNull>(ArgVal) || isImmortalObject(ArgVal)) {
+          CI.eraseFromParent();
+          Changed = true;
+          ++NumNoopDeleted;
+          continue;
+        }
         // Rewrite unknown retains into swift_retains.
         NativeRefs.insert(ArgVal);
         for (auto &X : UnknownRetains[ArgVal]) {
@@ -131,8 +150,8 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
       case RT_UnknownRetain: {
         CallInst &CI = cast<CallInst>(Inst);
         Value *ArgVal = RC->getSwiftRCIdentityRoot(CI.getArgOperand(0));
-        // unknownRetain(null) is a no-op.
-        if (isa<ConstantPointerNull>(ArgVal)) {
+        // unknownRetain(null) is a no-op, as is retaining an immortal object.
+        if (isa<ConstantPointerNull>(ArgVal) || isImmortalObject(ArgVal)) {
           CI.eraseFromParent();
           Changed = true;
           ++NumNoopDeleted;
@@ -156,8 +175,8 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
       case RT_Release: {
         CallInst &CI = cast<CallInst>(Inst);
         Value *ArgVal = RC->getSwiftRCIdentityRoot(CI.getArgOperand(0));
-        // release(null) is a no-op.
-        if (isa<ConstantPointerNull>(ArgVal)) {
+        // release(null) is a no-op, as is releasing an immortal object.
+        if (isa<ConstantPointerNull>(ArgVal) || isImmortalObject(ArgVal)) {
           CI.eraseFromParent();
           Changed = true;
           ++NumNoopDeleted;
@@ -178,8 +197,8 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
       case RT_UnknownRelease: {
         CallInst &CI = cast<CallInst>(Inst);
         Value *ArgVal = RC->getSwiftRCIdentityRoot(CI.getArgOperand(0));
-        // unknownRelease(null) is a no-op.
-        if (isa<ConstantPointerNull>(ArgVal)) {
+        // unknownRelease(null) is a no-op, as is releasing an immortal object.
+        if (isa<ConstantPointerNull>(ArgVal) || isImmortalObject(ArgVal)) {
           CI.eraseFromParent();
           Changed = true;
           ++NumNoopDeleted;
@@ -716,6 +735,12 @@ static bool performStoreOnlyObjectElimination(CallInst &Allocation,
     case RT_Retain:
     case RT_FixLifetime:
     case RT_CheckUnowned:
+    // The object is a native Swift object, so unknown and bridge object
+    // retains and releases of it are just swift_retain and swift_release.
+    case RT_UnknownRetain:
+    case RT_UnknownRelease:
+    case RT_BridgeRetain:
+    case RT_BridgeRelease:
       // It is perfectly fine to eliminate various retains and releases of this
       // object: we are zapping all accesses or none.
       break;
@@ -725,10 +750,6 @@ static bool performStoreOnlyObjectElimination(CallInst &Allocation,
     case RT_Unknown:
     case RT_ObjCRelease:
     case RT_ObjCRetain:
-    case RT_UnknownRetain:
-    case RT_UnknownRelease:
-    case RT_BridgeRetain:
-    case RT_BridgeRelease:
     case RT_RetainUnowned:
 
       // Otherwise, this really is some unhandled instruction.  Bail out.
@@ -61,6 +61,8 @@ using namespace swift;
 
 STATISTIC(NumSwiftFunctionsMerged, "Number of functions merged");
 STATISTIC(NumSwiftThunksWritten, "Number of thunks generated");
+STATISTIC(NumSwiftInstructionsSaved,
+          "Number of instructions removed by merging functions");
 
 static cl::opt<unsigned> NumFunctionsForSanityCheck(
     "swiftmergefunc-sanity",
@@ -1296,6 +1298,11 @@ FunctionComparator::FunctionHash FunctionComparator::functionHash(Function &F) {
 
   // Walk the blocks in the same order as FunctionComparator::cmpBasicBlocks(),
   // accumulating the hash of the function "structure." (BB and opcode sequence)
+  // Also add what cmpOperations() checks first, the number of operands and
+  // the kind of the result type, so that fewer functions with equal hashes
+  // have to be compared in full. Like cmpTypes(), treat pointers in the
+  // default address space as integers. Constants and callees are not
+  // included.
   BBs.push_back(&F.getEntryBlock());
   VisitedBBs.insert(BBs[0]);
   while (!BBs.empty()) {
@@ -1305,6 +1312,11 @@ FunctionComparator::FunctionHash FunctionComparator::functionHash(Function &F) {
     H.add(45798); 
     for (auto &Inst : *BB) {
       H.add(Inst.getOpcode());
+      H.add(Inst.getNumOperands());
+      Type *Ty = Inst.getType();
+      auto *PTy = dyn_cast<PointerType>(Ty);
+      H.add(PTy && PTy->getAddressSpace() == 0 ? Type::IntegerTyID
+                                               : Ty->getTypeID());
     }
     const TerminatorInst *Term = BB->getTerminator();
     for (unsigned i = 0, e = Term->getNumSuccessors(); i != e; ++i) {
@@ -1947,6 +1959,14 @@ bool SwiftMergeFunctions::tryMapToParameter(FunctionInfos &FInfos,
 
 /// Merge all functions in \p FInfos by creating thunks which call the single
 /// merged function with additional parameters.
+/// Returns the number of instructions in \p F.
+static unsigned getInstructionCount(const Function *F) {
+  unsigned Count = 0;
+  for (const BasicBlock &BB : *F)
+    Count += BB.size();
+  return Count;
+}
+
 void SwiftMergeFunctions::mergeWithParams(const FunctionInfos &FInfos,
                                           ParamInfos &Params) {
   // We reuse the body of the first function for the new merged function.
@@ -1980,6 +2000,11 @@ void SwiftMergeFunctions::mergeWithParams(const FunctionInfos &FInfos,
   
   DEBUG(dbgs() << "  Merge into " << NewFunction->getName() << '\n');
 
+  // All functions of the class have the same structure, so this is the size
+  // of each of them.
+  unsigned FuncSize = getInstructionCount(FirstF);
+  int Saved = -(int)FuncSize;
+
   // Move the body of FirstF into the NewFunction.
   NewFunction->getBasicBlockList().splice(NewFunction->begin(),
                                           FirstF->getBasicBlockList());
@@ -2010,12 +2035,16 @@ void SwiftMergeFunctions::mergeWithParams(const FunctionInfos &FInfos,
       Iter->second->F = nullptr;
       FuncEntries.erase(Iter);
       OrigFunc->eraseFromParent();
+      Saved += FuncSize;
     } else {
       // Otherwise we need a thunk which calls the merged function.
       writeThunk(NewFunction, OrigFunc, Params, FIdx);
+      Saved += (int)FuncSize - (int)getInstructionCount(OrigFunc);
     }
     ++NumSwiftFunctionsMerged;
   }
+  if (Saved > 0)
+    NumSwiftInstructionsSaved += Saved;
 }
 
 /// Remove all functions of \p FE's equivalence class from FnTree. Add them to
@@ -16,6 +16,9 @@
 // is made if stack promotion should be done. If yes, the
 // swift_bufferAllocateOnStack is replace with an alloca plus a call to
 // swift_initStackObject and the swift_bufferDeallocateFromStack is removed.
+// Buffers whose size is only known at runtime get a fixed-size alloca, which
+// is used if the size fits at runtime. Otherwise the buffer is allocated on
+// the heap as usual.
 // TODO: This is a hack and eventually this pass should not be required at all.
 // For details see the comments for the SIL StackPromoter.
 //
@@ -27,18 +30,27 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/Pass.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 
 using namespace llvm;
 using namespace swift;
 
 STATISTIC(NumBufferAllocsPromoted,
           "Number of swift_bufferAllocate promoted");
+STATISTIC(NumDynamicBufferAllocsPromoted,
+          "Number of swift_bufferAllocate with a runtime size promoted");
 
 cl::opt<int> LimitOpt("stack-promotion-limit",
                            llvm::cl::init(1024), llvm::cl::Hidden);
 
+/// The size of the stack space reserved for a buffer whose size is only known
+/// at runtime. Larger buffers are allocated on the heap.
+cl::opt<int> DynamicLimitOpt("stack-promotion-dynamic-limit",
+                             llvm::cl::init(128), llvm::cl::Hidden);
+
 //===----------------------------------------------------------------------===//
 //                            SwiftStackPromotion Pass
 //===----------------------------------------------------------------------===//
@@ -58,7 +70,8 @@ llvm::FunctionPass *swift::createSwiftStackPromotionPass() {
 }
 
 void SwiftStackPromotion::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
-  AU.setPreservesCFG();
+  // The promotion of buffers with a runtime size adds a branch to the heap
+  // allocation, so the CFG is not preserved.
 }
 
 /// Checks if we can promote a buffer and returns the size of the buffer.
@@ -84,6 +97,21 @@ int canPromote(CallInst *CI, unsigned &align, int maxSize) {
   return size;
 }
 
+/// Checks if we can promote a buffer whose size is only known at runtime, by
+/// reserving \p maxSize bytes for it. Returns the alignment of the buffer, or
+/// 0 if it cannot be promoted.
+static unsigned canPromoteDynamic(CallInst *CI, int maxSize) {
+  if (CI->getNumArgOperands() != 3 || isa<ConstantInt>(CI->getArgOperand(1)))
+    return 0;
+  if (DynamicLimitOpt <= 0 || DynamicLimitOpt > maxSize)
+    return 0;
+
+  auto *AlignMaskConst = dyn_cast<ConstantInt>(CI->getArgOperand(2));
+  if (!AlignMaskConst)
+    return 0;
+  return AlignMaskConst->getValue().getZExtValue() + 1;
+}
+
 /// Remove redundant runtime calls for stack allocated buffers.
 /// If a buffer is allocated on the stack it's not needed to explicitly set
 /// the RC_DEALLOCATING_FLAG flag (except there is code which may depend on it).
@@ -164,9 +192,13 @@ bool SwiftStackPromotion::runOnFunction(Function &F) {
   IntegerType *IntType = nullptr;
 
   SmallVector<CallInst *, 8> BufferAllocs;
-  SmallPtrSet<CallInst *, 8> PromotedAllocs;
+  SmallPtrSet<Value *, 8> PromotedAllocs;
   SmallVector<CallInst *, 8> BufferDeallocs;
 
+  // The allocas of the promoted buffers with a runtime size, which may be on
+  // the heap as well.
+  DenseMap<Value *, AllocaInst *> DynamicAllocs;
+
   // Search for allocation- and deallocation-calls in the function.
   for (BasicBlock &BB : F) {
     for (auto Iter = BB.begin(); Iter != BB.end(); ) {
@@ -198,6 +230,28 @@ bool SwiftStackPromotion::runOnFunction(Function &F) {
     }
   }
 
+  auto createInitFunc = [&](Function *Callee) {
+    if (AllocType)
+      return;
+    // Create the swift_initStackObject function and all required types.
+    AllocType = IntegerType::get(M->getContext(), 8);
+    IntType = IntegerType::get(M->getContext(), 32);
+    auto *OrigFT = Callee->getFunctionType();
+    auto *HeapObjTy = OrigFT->getReturnType();
+    auto *MetaDataTy = OrigFT->getParamType(0);
+    auto *NewFTy = FunctionType::get(HeapObjTy,
+                                     {MetaDataTy, HeapObjTy},
+                                     false);
+    initFunc = M->getOrInsertFunction("swift_initStackObject", NewFTy);
+  };
+  auto getAllocFunc = [&](Function *Callee) {
+    if (!allocFunc) {
+      allocFunc = M->getOrInsertFunction("swift_bufferAllocate",
+                                         Callee->getFunctionType());
+    }
+    return allocFunc;
+  };
+
   // First handle allocations.
   for (CallInst *CI : BufferAllocs) {
     Function *Callee = CI->getCalledFunction();
@@ -205,18 +259,7 @@ bool SwiftStackPromotion::runOnFunction(Function &F) {
     unsigned align = 0;
     if (int size = canPromote(CI, align, maxSize)) {
       maxSize -= size;
-      if (!AllocType) {
-        // Create the swift_initStackObject function and all required types.
-        AllocType = IntegerType::get(M->getContext(), 8);
-        IntType = IntegerType::get(M->getContext(), 32);
-        auto *OrigFT = Callee->getFunctionType();
-        auto *HeapObjTy = OrigFT->getReturnType();
-        auto *MetaDataTy = OrigFT->getParamType(0);
-        auto *NewFTy = FunctionType::get(HeapObjTy,
-                                         {MetaDataTy, HeapObjTy},
-                                         false);
-        initFunc = M->getOrInsertFunction("swift_initStackObject", NewFTy);
-      }
+      createInitFunc(Callee);
       // Replace the allocation call with an alloca.
       Value *AllocA = new AllocaInst(AllocType, ConstantInt::get(IntType, size),
                                      align, "buffer", &*F.front().begin());
@@ -229,14 +272,52 @@ bool SwiftStackPromotion::runOnFunction(Function &F) {
       CI->eraseFromParent();
       PromotedAllocs.insert(initCall);
       ++NumBufferAllocsPromoted;
+    } else if (unsigned dynamicAlign = canPromoteDynamic(CI, maxSize)) {
+      int size = DynamicLimitOpt;
+      maxSize -= size;
+      createInitFunc(Callee);
+      auto *AllocA = new AllocaInst(AllocType, ConstantInt::get(IntType, size),
+                                    dynamicAlign, "buffer",
+                                    &*F.front().begin());
+
+      // Use the alloca if the buffer fits into it, and the heap otherwise:
+      //
+      //   if (size <= limit)
+      //     obj = swift_initStackObject(metadata, alloca)
+      //   else
+      //     obj = swift_bufferAllocate(metadata, size, alignMask)
+      Value *Size = CI->getArgOperand(1);
+      IRBuilder<> B(CI);
+      Value *Fits = B.CreateICmpULE(Size, ConstantInt::get(Size->getType(),
+                                                           size));
+      TerminatorInst *StackTerm = nullptr;
+      TerminatorInst *HeapTerm = nullptr;
+      SplitBlockAndInsertIfThenElse(Fits, CI, &StackTerm, &HeapTerm);
+      StackTerm->getParent()->setName("stack.buffer");
+      HeapTerm->getParent()->setName("heap.buffer");
+
+      B.SetInsertPoint(StackTerm);
+      Value *casted = B.CreateBitCast(AllocA, CI->getType());
+      CallInst *initCall = B.CreateCall(initFunc,
+                                        {CI->getArgOperand(0), casted});
+
+      CI->removeFromParent();
+      CI->insertBefore(HeapTerm);
+      CI->setCalledFunction(getAllocFunc(Callee));
+
+      B.SetInsertPoint(&*StackTerm->getSuccessor(0)->begin());
+      PHINode *Buffer = B.CreatePHI(CI->getType(), 2, "promoted.buffer");
+      CI->replaceAllUsesWith(Buffer);
+      Buffer->addIncoming(initCall, StackTerm->getParent());
+      Buffer->addIncoming(CI, HeapTerm->getParent());
+
+      PromotedAllocs.insert(Buffer);
+      DynamicAllocs[Buffer] = AllocA;
+      ++NumDynamicBufferAllocsPromoted;
     } else {
       // We don't do stack promotion. Replace the call with a call to the
       // regular swift_bufferAllocate.
-      if (!allocFunc) {
-        allocFunc = M->getOrInsertFunction("swift_bufferAllocate",
-                                           Callee->getFunctionType());
-      }
-      CI->setCalledFunction(allocFunc);
+      CI->setCalledFunction(getAllocFunc(Callee));
     }
     Changed = true;
   }
@@ -244,9 +325,15 @@ bool SwiftStackPromotion::runOnFunction(Function &F) {
   // After we made the decision for all allocations we can handle the
   // deallocations.
   for (CallInst *CI : BufferDeallocs) {
-    CallInst *Alloc = dyn_cast<CallInst>(CI->getArgOperand(0));
-    assert(Alloc && "alloc buffer obfuscated");
-    if (PromotedAllocs.count(Alloc)) {
+    Value *Alloc = CI->getArgOperand(0);
+    assert((isa<CallInst>(Alloc) || isa<PHINode>(Alloc)) &&
+           "alloc buffer obfuscated");
+    if (AllocaInst *AllocA = DynamicAllocs.lookup(Alloc)) {
+      // The buffer may be on the heap, where the runtime calls which
+      // removeRedundantRTCalls removes do free it.
+      IRBuilder<> B(CI);
+      B.CreateLifetimeEnd(AllocA);
+    } else if (PromotedAllocs.count(Alloc)) {
 
       removeRedundantRTCalls(CI);
 
@@ -40,7 +40,6 @@ SwiftRCIdentity::stripReferenceForwarding(llvm::Value *Val) {
   switch(Kind) {
   case RT_RetainN:
   case RT_UnknownRetainN:
-  case RT_BridgeRetainN:
   case RT_ReleaseN:
   case RT_UnknownReleaseN:
   case RT_BridgeReleaseN:
@@ -53,13 +52,16 @@ SwiftRCIdentity::stripReferenceForwarding(llvm::Value *Val) {
   case RT_AllocObject:
   case RT_NoMemoryAccessed:
   case RT_BridgeRelease:
-  case RT_BridgeRetain:
   case RT_RetainUnowned:
   case RT_CheckUnowned:
   case RT_ObjCRelease:
     break;
   // ObjC forwards references.
   case RT_ObjCRetain:
+  // Bridge retains return the object with its spare bits cleared, which is
+  // still the same reference counted object.
+  case RT_BridgeRetain:
+  case RT_BridgeRetainN:
     Val = cast<CallInst>(Inst)->getArgOperand(0);
     break;
   }
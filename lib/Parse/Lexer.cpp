@@ -28,6 +28,12 @@
 // FIXME: Figure out if this can be migrated to LLVM.
 #include "clang/Basic/CharInfo.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 using namespace swift;
 
 // clang::isIdentifierHead and clang::isIdentifierBody are deliberately not in
@@ -306,8 +312,49 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
       .fixItRemoveChars(NulLoc, NulEndLoc);
 }
 
+/// Skips printable ASCII characters other than \p A and \p B, 16 bytes at a
+/// time. Returns a pointer which is at most the first character in
+/// [\p Ptr, \p End) which is not skipped; the caller has to handle the
+/// remaining characters one by one.
+static const char *skipPlainASCII(const char *Ptr, const char *End,
+                                  char A, char B) {
+#if defined(__SSE2__)
+  const __m128i Space = _mm_set1_epi8(' ');
+  const __m128i Delete = _mm_set1_epi8(0x7F);
+  const __m128i VA = _mm_set1_epi8(A);
+  const __m128i VB = _mm_set1_epi8(B);
+  while (End - Ptr >= 16) {
+    __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+    // The signed comparison also catches bytes with the high bit set.
+    __m128i Special = _mm_or_si128(
+        _mm_or_si128(_mm_cmplt_epi8(Chunk, Space),
+                     _mm_cmpeq_epi8(Chunk, Delete)),
+        _mm_or_si128(_mm_cmpeq_epi8(Chunk, VA), _mm_cmpeq_epi8(Chunk, VB)));
+    if (unsigned Mask = _mm_movemask_epi8(Special))
+      return Ptr + llvm::countTrailingZeros(Mask);
+    Ptr += 16;
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  const uint8x16_t Space = vdupq_n_u8(' ');
+  const uint8x16_t Delete = vdupq_n_u8(0x7F);
+  const uint8x16_t VA = vdupq_n_u8(A);
+  const uint8x16_t VB = vdupq_n_u8(B);
+  while (End - Ptr >= 16) {
+    uint8x16_t Chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(Ptr));
+    uint8x16_t Special = vorrq_u8(
+        vorrq_u8(vcltq_u8(Chunk, Space), vcgeq_u8(Chunk, Delete)),
+        vorrq_u8(vceqq_u8(Chunk, VA), vceqq_u8(Chunk, VB)));
+    if (vmaxvq_u8(Special))
+      return Ptr;
+    Ptr += 16;
+  }
+#endif
+  return Ptr;
+}
+
 void Lexer::skipToEndOfLine() {
   while (1) {
+    CurPtr = skipPlainASCII(CurPtr, BufferEnd, '\n', '\n');
     switch (*CurPtr++) {
     case '\n':
     case '\r':
@@ -361,6 +408,7 @@ void Lexer::skipSlashStarComment() {
   unsigned Depth = 1;
   
   while (1) {
+    CurPtr = skipPlainASCII(CurPtr, BufferEnd, '*', '/');
     switch (*CurPtr++) {
     case '*':
       // Check for a '*/'
@@ -569,6 +617,9 @@ void Lexer::lexIdentifier() {
   (void) didStart;
 
   // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*
+  // Most identifiers are plain ASCII, which does not need to be decoded.
+  while (clang::isIdentifierBody(*CurPtr, /*dollar*/true))
+    ++CurPtr;
   while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
 
   tok Kind = kindOfIdentifier(StringRef(TokStart, CurPtr-TokStart), InSILMode);
@@ -1232,6 +1283,10 @@ void Lexer::lexStringLiteral() {
   bool wasErroneous = false;
   
   while (true) {
+    // Printable ASCII characters other than the quote and escapes are just
+    // part of the string.
+    CurPtr = skipPlainASCII(CurPtr, BufferEnd, *TokStart, '\\');
+
     if (*CurPtr == '\\' && *(CurPtr + 1) == '(') {
       // Consume tokens until we hit the corresponding ')'.
       CurPtr += 2;
@@ -4363,6 +4363,28 @@ void Parser::consumeAbstractFunctionBody(AbstractFunctionDecl *AFD,
   }
 }
 
+/// If the skipped-body callbacks ask for it, skip the body of \p AFD, which
+/// starts at the current '{' token, and return true.
+bool Parser::skipFunctionBodyIfRequested(AbstractFunctionDecl *AFD) {
+  if (!SkippedBodyCB ||
+      !SkippedBodyCB->shouldSkipFunctionBody(*this, AFD, Tok.getLoc()))
+    return false;
+
+  auto BeginParserPosition = getParserPosition();
+  SourceRange BodyRange;
+  BodyRange.Start = Tok.getLoc();
+  unsigned OpenBraces = skipBracedBlock(*this);
+  BodyRange.End = PreviousLoc;
+
+  if (OpenBraces != 0 ||
+      !SkippedBodyCB->acceptSkippedFunctionBody(*this, AFD, BodyRange)) {
+    backtrackToPosition(BeginParserPosition);
+    return false;
+  }
+  AFD->setBodySkipped(BodyRange);
+  return true;
+}
+
 /// \brief Parse a 'func' declaration, returning null on error.  The caller
 /// handles this case and does recovery as appropriate.
 ///
@@ -4582,6 +4604,8 @@ Parser::parseDeclFunc(SourceLoc StaticLoc, StaticSpellingKind StaticSpelling,
       if (Flags.contains(PD_InProtocol)) {
         diagnose(Tok, diag::protocol_method_with_body);
         skipUntilDeclRBrace();
+      } else if (skipFunctionBodyIfRequested(FD)) {
+        // The client keeps what it needs of the body from an earlier parse.
       } else if (!isDelayedParsingEnabled()) {
         ParserResult<BraceStmt> Body =
             parseBraceItemList(diag::func_decl_without_brace);
@@ -5423,7 +5447,9 @@ Parser::parseDeclInit(ParseDeclOptions Flags, DeclAttributes &Attributes) {
       // Parse the body.
       ParseFunctionBody CC(*this, CD);
 
-      if (!isDelayedParsingEnabled()) {
+      if (skipFunctionBodyIfRequested(CD)) {
+        // The client keeps what it needs of the body from an earlier parse.
+      } else if (!isDelayedParsingEnabled()) {
         ParserResult<BraceStmt> Body =
           parseBraceItemList(diag::invalid_diagnostic);
 
@@ -5488,7 +5514,9 @@ parseDeclDeinit(ParseDeclOptions Flags, DeclAttributes &Attributes) {
     llvm::SaveAndRestore<bool> T(IsParsingInterfaceTokens, false);
 
     ParseFunctionBody CC(*this, DD);
-    if (!isDelayedParsingEnabled()) {
+    if (skipFunctionBodyIfRequested(DD)) {
+      // The client keeps what it needs of the body from an earlier parse.
+    } else if (!isDelayedParsingEnabled()) {
       ParserResult<BraceStmt> Body=parseBraceItemList(diag::invalid_diagnostic);
 
       if (!Body.isNull())
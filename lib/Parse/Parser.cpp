@@ -33,6 +33,7 @@
 using namespace swift;
 
 void DelayedParsingCallbacks::anchor() { }
+void SkippedFunctionBodyCallbacks::anchor() { }
 
 namespace {
   /// To assist debugging parser crashes, tell us the location of the
@@ -136,7 +137,8 @@ bool swift::parseIntoSourceFile(SourceFile &SF,
                                 bool *Done,
                                 SILParserState *SIL,
                                 PersistentParserState *PersistentState,
-                                DelayedParsingCallbacks *DelayedParseCB) {
+                                DelayedParsingCallbacks *DelayedParseCB,
+                                SkippedFunctionBodyCallbacks *SkippedBodyCB) {
   SharedTimer timer("Parsing");
   Parser P(BufferID, SF, SIL, PersistentState);
   PrettyStackTraceParser StackTrace(P);
@@ -145,6 +147,8 @@ bool swift::parseIntoSourceFile(SourceFile &SF,
 
   if (DelayedParseCB)
     P.setDelayedParsingCallbacks(DelayedParseCB);
+  if (SkippedBodyCB)
+    P.setSkippedFunctionBodyCallbacks(SkippedBodyCB);
 
   bool FoundSideEffects = P.parseTopLevel();
   *Done = P.Tok.is(tok::eof);
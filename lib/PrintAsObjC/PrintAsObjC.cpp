@@ -1500,6 +1500,15 @@ class ModuleWriter {
   Module &M;
   StringRef bridgingHeader;
   ObjCPrinter printer;
+
+  /// A top-level decl to write, with the keys it is sorted by.
+  struct SortedDecl {
+    const Decl *decl;
+    StringRef name;
+    /// The number of members, for extensions.
+    unsigned numMembers;
+  };
+
 public:
   ModuleWriter(Module &mod, StringRef header, Accessibility access)
     : M(mod), bridgingHeader(header), printer(M, os, access) {}
@@ -1954,55 +1963,57 @@ public:
     });
     decls.erase(newEnd, decls.end());
 
+    // Compute what the decls are sorted by up front, rather than once for
+    // every comparison: counting the members of an extension walks all of
+    // them.
+    SmallVector<SortedDecl, 64> sorted;
+    sorted.reserve(decls.size());
+    for (const Decl *D : decls) {
+      SortedDecl entry{D, StringRef(), 0};
+      if (auto VD = dyn_cast<ValueDecl>(D)) {
+        entry.name = VD->getName().str();
+      } else {
+        auto ED = cast<ExtensionDecl>(D);
+        auto baseClass = ED->getExtendedType()->getClassOrBoundGenericClass();
+        entry.name = baseClass->getName().str();
+        auto members = ED->getMembers();
+        entry.numMembers = std::distance(members.begin(), members.end());
+      }
+      sorted.push_back(entry);
+    }
+
     // REVERSE sort the decls, since we are going to copy them onto a stack.
-    llvm::array_pod_sort(decls.begin(), decls.end(),
-                         [](Decl * const *lhs, Decl * const *rhs) -> int {
+    llvm::array_pod_sort(sorted.begin(), sorted.end(),
+                         [](const SortedDecl *lhs,
+                            const SortedDecl *rhs) -> int {
       enum : int {
         Ascending = -1,
         Equivalent = 0,
         Descending = 1,
       };
 
-      assert(*lhs != *rhs && "duplicate top-level decl");
-
-      auto getSortName = [](const Decl *D) -> StringRef {
-        if (auto VD = dyn_cast<ValueDecl>(D))
-          return VD->getName().str();
-
-        if (auto ED = dyn_cast<ExtensionDecl>(D)) {
-          auto baseClass = ED->getExtendedType()->getClassOrBoundGenericClass();
-          return baseClass->getName().str();
-        }
-        llvm_unreachable("unknown top-level ObjC decl");
-      };
+      assert(lhs->decl != rhs->decl && "duplicate top-level decl");
 
       // Sort by names.
-      int result = getSortName(*rhs).compare(getSortName(*lhs));
+      int result = rhs->name.compare(lhs->name);
       if (result != 0)
         return result;
 
       // Prefer value decls to extensions.
-      assert(!(isa<ValueDecl>(*lhs) && isa<ValueDecl>(*rhs)));
-      if (isa<ValueDecl>(*lhs) && !isa<ValueDecl>(*rhs))
+      assert(!(isa<ValueDecl>(lhs->decl) && isa<ValueDecl>(rhs->decl)));
+      if (isa<ValueDecl>(lhs->decl) && !isa<ValueDecl>(rhs->decl))
         return Descending;
-      if (!isa<ValueDecl>(*lhs) && isa<ValueDecl>(*rhs))
+      if (!isa<ValueDecl>(lhs->decl) && isa<ValueDecl>(rhs->decl))
         return Ascending;
 
       // Break ties in extensions by putting smaller extensions last (in reverse
       // order).
-      // FIXME: This will end up taking linear time.
-      auto lhsMembers = cast<ExtensionDecl>(*lhs)->getMembers();
-      auto rhsMembers = cast<ExtensionDecl>(*rhs)->getMembers();
-      unsigned numLHSMembers = std::distance(lhsMembers.begin(), 
-                                             lhsMembers.end());
-      unsigned numRHSMembers = std::distance(rhsMembers.begin(), 
-                                             rhsMembers.end());
-      if (numLHSMembers != numRHSMembers)
-        return numLHSMembers < numRHSMembers ? Descending : Ascending;
+      if (lhs->numMembers != rhs->numMembers)
+        return lhs->numMembers < rhs->numMembers ? Descending : Ascending;
 
       // Or the extension with fewer protocols.
-      auto lhsProtos = cast<ExtensionDecl>(*lhs)->getLocalProtocols();
-      auto rhsProtos = cast<ExtensionDecl>(*rhs)->getLocalProtocols();
+      auto lhsProtos = cast<ExtensionDecl>(lhs->decl)->getLocalProtocols();
+      auto rhsProtos = cast<ExtensionDecl>(rhs->decl)->getLocalProtocols();
       if (lhsProtos.size() != rhsProtos.size())
         return lhsProtos.size() < rhsProtos.size() ? Descending : Ascending;
 
@@ -2010,7 +2021,7 @@ public:
       // alphabetically first.
       auto mismatch =
         std::mismatch(lhsProtos.begin(), lhsProtos.end(), rhsProtos.begin(),
-                      [getSortName] (const ProtocolDecl *nextLHSProto,
+                      [] (const ProtocolDecl *nextLHSProto,
                                      const ProtocolDecl *nextRHSProto) {
         return nextLHSProto->getName() != nextRHSProto->getName();
       });
@@ -2021,7 +2032,8 @@ public:
     });
 
     assert(declsToWrite.empty());
-    declsToWrite.assign(decls.begin(), decls.end());
+    for (auto &entry : sorted)
+      declsToWrite.push_back(entry.decl);
 
     while (!declsToWrite.empty()) {
       const Decl *D = declsToWrite.back();
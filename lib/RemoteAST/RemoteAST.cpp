@@ -122,7 +122,8 @@ public:
   }
 
   NominalTypeDecl *createNominalTypeDecl(StringRef mangledName) {
-    auto node = Demangle::demangleTypeAsNode(mangledName);
+    Demangle::NodeFactory Factory;
+    auto node = Demangle::demangleTypeAsNode(mangledName, Factory);
     if (!node) return nullptr;
 
     return createNominalTypeDecl(node);
@@ -16,6 +16,7 @@
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "swift/SIL/FormalLinkage.h"
 #include <functional>
@@ -24,6 +25,13 @@ using namespace swift;
 using namespace Lowering;
 
 STATISTIC(NumFuncLinked, "Number of SIL functions linked");
+STATISTIC(NumFuncBodiesSkipped,
+          "Number of SIL function bodies not linked because of their size");
+
+static llvm::cl::opt<unsigned> LinkBodyCostLimit(
+    "sil-link-body-cost-limit", llvm::cl::init(2000),
+    llvm::cl::desc("Don't link the bodies of public functions whose inline "
+                   "cost exceeds this limit (0 means no limit)"));
 
 //===----------------------------------------------------------------------===//
 //                                  Utility
@@ -49,6 +57,38 @@ static bool shouldImportFunction(SILFunction *F) {
 //                               Linker Helpers
 //===----------------------------------------------------------------------===//
 
+bool SILLinkerVisitor::shouldDeserializeBody(SILFunction *F) {
+  if (!isLinkAll() || LinkBodyCostLimit == 0)
+    return true;
+
+  // Bodies of shared functions must always be linked, and transparent, always
+  // inline and semantics functions are handled specially by the optimizer.
+  if (!hasPublicVisibility(F->getLinkage()) || F->isTransparent() ||
+      F->getInlineStrategy() == AlwaysInline || F->hasSemanticsAttrs())
+    return true;
+
+  // Generic functions can be specialized, and functions taking closures can
+  // be specialized for the closure. Both need the body, whatever its size.
+  CanSILFunctionType FnTy = F->getLoweredFunctionType();
+  if (FnTy->isPolymorphic())
+    return true;
+  for (const SILParameterInfo &Param : FnTy->getParameters()) {
+    if (isa<SILFunctionType>(Param.getType()))
+      return true;
+  }
+
+  // Ask the summary before deserializing the body.
+  const SILFunctionSummary *Summary = Mod.lookUpFunctionSummary(F);
+  if (!Summary || !Summary->hasBodyCost() ||
+      Summary->getBodyCost() <= LinkBodyCostLimit)
+    return true;
+
+  DEBUG(llvm::dbgs() << "Skip body of " << F->getName() << " with cost "
+                     << Summary->getBodyCost() << "\n");
+  ++NumFuncBodiesSkipped;
+  return false;
+}
+
 /// Process F, recursively deserializing any thing F may reference.
 bool SILLinkerVisitor::processFunction(SILFunction *F) {
   if (Mode == LinkingMode::LinkNone)
@@ -59,6 +99,9 @@ bool SILLinkerVisitor::processFunction(SILFunction *F) {
 
   // If F is a declaration, first deserialize it.
   if (F->isExternalDeclaration()) {
+    if (!shouldDeserializeBody(F))
+      return false;
+
     auto *NewFn = Loader->lookupSILFunction(F);
 
     if (!NewFn || NewFn->isExternalDeclaration())
@@ -374,7 +417,7 @@ bool SILLinkerVisitor::process() {
                                << F->getName() << "\n");
             F->setBare(IsBare);
 
-            if (F->isExternalDeclaration()) {
+            if (F->isExternalDeclaration() && shouldDeserializeBody(F)) {
               if (auto *NewFn = Loader->lookupSILFunction(F)) {
                 if (NewFn->isExternalDeclaration())
                   continue;
@@ -99,6 +99,11 @@ private:
   /// everything, not just transparent/shared functions.
   bool isLinkAll() const { return Mode == LinkingMode::LinkAll; }
 
+  /// Returns false if the body of the external declaration \p F is only
+  /// useful for inlining, and its serialized summary says that it is too
+  /// large to be inlined.
+  bool shouldDeserializeBody(SILFunction *F);
+
   bool linkInVTable(ClassDecl *D);
 
   // Main loop of the visitor. Called by one of the other *visit* methods.
@@ -73,6 +73,28 @@ void GenericSpecializationMangler::mangleSpecialization() {
   assert(idx == Subs.size() && "subs not parallel to dependent types");
 }
 
+void PartialSpecializationMangler::mangleSpecialization() {
+  Mangler &M = getMangler();
+
+  // The replacement types refer to the generic parameters of the specialized
+  // signature, so mangle it first. This also binds the signature for the
+  // mangling of dependent member types.
+  M.setModuleContext(Function->getModule().getSwiftModule());
+  M.mangleGenericSignature(Sig);
+
+  CanGenericSignature FuncSig =
+    Function->getLoweredFunctionType()->getGenericSignature();
+  unsigned idx = 0;
+  for (Type DepType : FuncSig->getAllDependentTypes()) {
+    if (DepType->is<GenericTypeParamType>()) {
+      mangleSubstitution(M, Subs[idx]);
+      M.append('_');
+    }
+    ++idx;
+  }
+  assert(idx == Subs.size() && "subs not parallel to dependent types");
+}
+
 //===----------------------------------------------------------------------===//
 //                      Function Signature Optimizations
 //===----------------------------------------------------------------------===//
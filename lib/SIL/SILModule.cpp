@@ -12,18 +12,25 @@
 
 #define DEBUG_TYPE "sil-module"
 #include "swift/Serialization/SerializedSILLoader.h"
+#include "swift/AST/DiagnosticsCommon.h"
+#include "swift/AST/DiagnosticsSIL.h"
 #include "swift/SIL/FormalLinkage.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "swift/SIL/SILModule.h"
 #include "Linker.h"
 #include "swift/SIL/SILVisitor.h"
 #include "swift/SIL/SILValue.h"
+#include "swift/Basic/Malloc.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <functional>
+#include <memory>
 using namespace swift;
 using namespace Lowering;
 
@@ -101,15 +108,62 @@ void *SILModule::allocate(unsigned Size, unsigned Align) const {
   if (getASTContext().LangOpts.UseMalloc)
     return AlignedAlloc(Size, Align);
 
+  if (MultiThreaded) {
+    llvm::sys::ScopedLock Lock(SharedStateLock);
+    return BPA.Allocate(Size, Align);
+  }
   return BPA.Allocate(Size, Align);
 }
 
 void *SILModule::allocateInst(unsigned Size, unsigned Align) const {
-  return AlignedAlloc(Size, Align);
+  assert(Align <= InstAllocHeaderSize && "instruction is overaligned");
+  size_t AllocSize = llvm::alignTo(Size + InstAllocHeaderSize,
+                                   InstAllocHeaderSize);
+
+  std::unique_ptr<llvm::sys::ScopedLock> Lock;
+  if (MultiThreaded)
+    Lock.reset(new llvm::sys::ScopedLock(SharedStateLock));
+
+  InstBytes += AllocSize;
+  PeakInstBytes = std::max(PeakInstBytes, InstBytes);
+
+  char *Alloc;
+  if (AllocSize > MaxRecycledInstAllocSize ||
+      getASTContext().LangOpts.UseMalloc) {
+    Alloc = static_cast<char *>(AlignedAlloc(AllocSize, InstAllocHeaderSize));
+  } else {
+    void *&FreeList = InstFreeLists[AllocSize / InstAllocHeaderSize - 1];
+    if (FreeList) {
+      Alloc = static_cast<char *>(FreeList);
+      FreeList = *reinterpret_cast<void **>(FreeList);
+    } else {
+      Alloc = static_cast<char *>(
+          InstSlabs.Allocate(AllocSize, InstAllocHeaderSize));
+    }
+  }
+  *reinterpret_cast<size_t *>(Alloc) = AllocSize;
+  return Alloc + InstAllocHeaderSize;
 }
 
 void SILModule::deallocateInst(SILInstruction *I) {
-  AlignedFree(I);
+  char *Alloc = reinterpret_cast<char *>(I) - InstAllocHeaderSize;
+  size_t AllocSize = *reinterpret_cast<size_t *>(Alloc);
+
+  std::unique_ptr<llvm::sys::ScopedLock> Lock;
+  if (MultiThreaded)
+    Lock.reset(new llvm::sys::ScopedLock(SharedStateLock));
+
+  assert(InstBytes >= AllocSize && "instruction was deallocated twice");
+  InstBytes -= AllocSize;
+
+  if (AllocSize > MaxRecycledInstAllocSize ||
+      getASTContext().LangOpts.UseMalloc) {
+    AlignedFree(Alloc);
+    return;
+  }
+  void *&FreeList = InstFreeLists[AllocSize / InstAllocHeaderSize - 1];
+  *reinterpret_cast<void **>(Alloc) = FreeList;
+  FreeList = Alloc;
 }
 
 SILWitnessTable *
@@ -548,6 +602,76 @@ SILFunction *SILModule::hasFunction(StringRef Name, SILLinkage Linkage) {
   return F;
 }
 
+const SILFunctionSummary *
+SILModule::getFunctionSummary(const SILFunction *F) const {
+  auto Iter = FunctionSummaries.find(F->getName());
+  if (Iter == FunctionSummaries.end() || !Iter->second)
+    return nullptr;
+  return Iter->second.getPointer();
+}
+
+const SILFunctionSummary *SILModule::lookUpFunctionSummary(SILFunction *F) {
+  // Summaries of definitions in this module are only set by the optimizer.
+  if (F->isDefinition() || FunctionSummaries.count(F->getName()))
+    return getFunctionSummary(F);
+
+  auto &Entry = FunctionSummaries[F->getName()];
+  Entry = getSILLoader()->lookupFunctionSummary(F->getName());
+  return Entry ? Entry.getPointer() : nullptr;
+}
+
+void SILModule::setFunctionSummary(SILFunction *F,
+                                   SILFunctionSummary Summary) {
+  assert(F->isDefinition() && "only definitions have computed summaries");
+  FunctionSummaries[F->getName()] = std::move(Summary);
+}
+
+llvm::raw_ostream *SILModule::getSpecializationRemarkStream() {
+  if (SpecializationRemarks)
+    return SpecializationRemarks.get();
+  StringRef Path = Options.SpecializationRemarksPath;
+  if (Path.empty() || SpecializationRemarksFailed)
+    return nullptr;
+
+  // Several frontend jobs may write to the same file, so append to it. Each
+  // remark is a single line.
+  std::error_code EC;
+  SpecializationRemarks.reset(new llvm::raw_fd_ostream(Path, EC,
+                                                       llvm::sys::fs::F_Append |
+                                                       llvm::sys::fs::F_Text));
+  if (EC) {
+    SpecializationRemarks.reset();
+    SpecializationRemarksFailed = true;
+    getASTContext().Diags.diagnose(SourceLoc(), diag::error_opening_output,
+                                   Path, EC.message());
+    return nullptr;
+  }
+  return SpecializationRemarks.get();
+}
+
+const SILReceiverProfile *SILModule::getReceiverProfile() {
+  if (ReceiverProfile)
+    return ReceiverProfile.get();
+  StringRef Path = Options.UseReceiverProfile;
+  if (Path.empty() || ReceiverProfileFailed)
+    return nullptr;
+
+  std::string Error;
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (Buffer) {
+    ReceiverProfile.reset(new SILReceiverProfile());
+    if (ReceiverProfile->read(Buffer.get()->getBuffer(), Error))
+      return ReceiverProfile.get();
+    ReceiverProfile.reset();
+  } else {
+    Error = Buffer.getError().message();
+  }
+  ReceiverProfileFailed = true;
+  getASTContext().Diags.diagnose(SourceLoc(), diag::profile_read_error, Path,
+                                 Error);
+  return nullptr;
+}
+
 void SILModule::linkAllWitnessTables() {
   getSILLoader()->getAllWitnessTables();
 }
@@ -589,7 +713,9 @@ void SILModule::eraseFunction(SILFunction *F) {
 
     // This opens dead-function-removal opportunities for called functions.
     // (References are not needed anymore.)
-    F->dropAllReferences();
+    // Neither IRGen nor debug info need the body, so its memory is released.
+    if (F->isDefinition())
+      F->convertToDeclaration();
   } else {
     FunctionTable.erase(F->getName());
     getFunctionList().erase(F);
@@ -803,6 +929,14 @@ removeDeleteNotificationHandler(DeleteNotificationHandler* Handler) {
 }
 
 void SILModule::notifyDeleteHandlers(ValueBase *V) {
+  // Handlers are shared between all functions. Don't let them see deletions
+  // from different threads at the same time.
+  if (MultiThreaded) {
+    llvm::sys::ScopedLock Lock(SharedStateLock);
+    for (auto *Handler : NotificationHandlers)
+      Handler->handleDeleteNotification(V);
+    return;
+  }
   for (auto *Handler : NotificationHandlers) {
     Handler->handleDeleteNotification(V);
   }
@@ -520,6 +520,13 @@ public:
       for (auto Id : PredIDs)
         *this << ' ' << Id;
     }
+    if (auto Count = BB->getExecutionCount()) {
+      if (BB->pred_empty())
+        PrintState.OS.PadToColumn(50);
+      else
+        *this << ' ';
+      PrintState.OS << "// Count: " << *Count;
+    }
     *this << '\n';
 
     for (const SILInstruction &I : *BB) {
@@ -1685,6 +1692,8 @@ void SILFunction::print(SILPrintContext &PrintCtx) const {
   OS << "\n";
 
   OS << "// " << demangleSymbol(getName()) << '\n';
+  if (auto Count = getEntryCount())
+    OS << "// Entry count: " << *Count << '\n';
   OS << "sil ";
   printLinkage(OS, getLinkage(), isDefinition());
 
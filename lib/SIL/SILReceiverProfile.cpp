@@ -0,0 +1,57 @@
+//===--- SILReceiverProfile.cpp - Sampled targets of dynamic calls --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/SIL/SILReceiverProfile.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Twine.h"
+
+using namespace swift;
+
+/// The caller name of records which apply to all callers.
+static const char WildcardCaller[] = "*";
+
+bool SILReceiverProfile::read(StringRef Buffer, std::string &Error) {
+  unsigned LineNo = 0;
+  while (!Buffer.empty()) {
+    StringRef Line;
+    std::tie(Line, Buffer) = Buffer.split('\n');
+    ++LineNo;
+
+    Line = Line.trim();
+    if (Line.empty() || Line.startswith("#"))
+      continue;
+
+    SmallVector<StringRef, 3> Fields;
+    Line.split(Fields, ' ', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    uint64_t Count;
+    if (Fields.size() != 3 || Fields[2].getAsInteger(10, Count)) {
+      Error = (llvm::Twine("malformed record in line ") +
+               llvm::Twine(LineNo)).str();
+      return false;
+    }
+    Samples[Fields[0]][Fields[1]] += Count;
+  }
+  return true;
+}
+
+uint64_t SILReceiverProfile::getCount(StringRef Caller,
+                                      StringRef Target) const {
+  auto Iter = Samples.find(Caller);
+  if (Iter == Samples.end())
+    Iter = Samples.find(WildcardCaller);
+  if (Iter == Samples.end())
+    return 0;
+  auto TargetIter = Iter->second.find(Target);
+  if (TargetIter == Iter->second.end())
+    return 0;
+  return TargetIter->second;
+}
@@ -3296,6 +3296,11 @@ void SILGlobalVariable::verify() const {
 
 /// Verify the module.
 void SILModule::verify() const {
+  verify([](const SILFunction &) { return true; });
+}
+
+void SILModule::verify(
+    llvm::function_ref<bool(const SILFunction &)> ShouldVerify) const {
 #ifndef NDEBUG
   // Uniquing set to catch symbol name collisions.
   llvm::StringSet<> symbolNames;
@@ -3306,7 +3311,8 @@ void SILModule::verify() const {
       llvm::errs() << "Symbol redefined: " << f.getName() << "!\n";
       assert(false && "triggering standard assertion failure routine");
     }
-    f.verify(/*SingleFunction=*/ false);
+    if (ShouldVerify(f))
+      f.verify(/*SingleFunction=*/ false);
   }
 
   // Check all globals.
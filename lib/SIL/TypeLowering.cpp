@@ -24,6 +24,7 @@
 #include "swift/AST/Pattern.h"
 #include "swift/AST/Types.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/ClangImporter/ClangModule.h"
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILBuilder.h"
@@ -1298,6 +1299,8 @@ const TypeLowering *TypeConverter::find(TypeKey k) {
     return nullptr;
 
   assert(found->second && "type recursion not caught in Sema");
+  if (auto *Stats = Context.Stats)
+    Stats->getFrontendCounters().NumTypeLoweringCacheHits++;
   return found->second;
 }
 
@@ -1614,6 +1617,9 @@ TypeConverter::getTypeLoweringForUncachedLoweredType(TypeKey key) {
   insert(key, nullptr);
 #endif
 
+  if (auto *Stats = Context.Stats)
+    Stats->getFrontendCounters().NumTypeLoweringsComputed++;
+
   CanType contextType = key.SubstType;
   // FIXME: Get expansion from SILFunction
   auto *theInfo = LowerType(*this, key.SubstType,
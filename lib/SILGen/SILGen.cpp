@@ -19,6 +19,7 @@
 #include "swift/AST/NameLookup.h"
 #include "swift/AST/PrettyStackTrace.h"
 #include "swift/AST/ResilienceExpansion.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/Timer.h"
 #include "swift/ClangImporter/ClangModule.h"
 #include "swift/Serialization/SerializedModuleLoader.h"
@@ -27,7 +28,9 @@
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "swift/Subsystems.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Path.h"
 #include "RValue.h"
 using namespace swift;
 using namespace Lowering;
@@ -39,6 +42,15 @@ using namespace Lowering;
 SILGenModule::SILGenModule(SILModule &M, Module *SM, bool makeModuleFragile)
   : M(M), Types(M.Types), SwiftModule(SM), TopLevelSGF(nullptr),
     Profiler(nullptr), makeModuleFragile(makeModuleFragile) {
+  const std::string &ProfilePath = M.getOptions().UseProfile;
+  if (!ProfilePath.empty()) {
+    auto ReaderOrErr = llvm::IndexedInstrProfReader::create(ProfilePath);
+    if (auto EC = ReaderOrErr.getError())
+      diagnose(SourceLoc(), diag::profile_read_error, ProfilePath,
+               EC.message());
+    else
+      ProfileReader = std::move(ReaderOrErr.get());
+  }
 }
 
 SILGenModule::~SILGenModule() {
@@ -1349,6 +1361,8 @@ SILModule::constructSIL(Module *mod, SILOptions &options, FileUnit *SF,
       auto nextSF = dyn_cast<SourceFile>(file);
       if (!nextSF || nextSF->ASTStage != SourceFile::TypeChecked)
         continue;
+      StatsTraceScope Trace(mod->getASTContext().Stats, "silgen-file",
+                            llvm::sys::path::filename(nextSF->getFilename()));
       SGM.emitSourceFile(nextSF, 0);
     }
 
@@ -1364,6 +1378,8 @@ SILModule::constructSIL(Module *mod, SILOptions &options, FileUnit *SF,
   }
 
   // Emit external definitions used by this module.
+  StatsTraceScope Trace(mod->getASTContext().Stats, "silgen-file",
+                        "<external and delayed definitions>");
   for (size_t i = 0, e = mod->getASTContext().LastCheckedExternalDefinition;
        i != e; ++i) {
     auto def = mod->getASTContext().ExternalDefinitions[i];
@@ -18,6 +18,7 @@
 #include "Initialization.h"
 #include "RValue.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FormattedStream.h"
 #include "swift/AST/ASTWalker.h"
@@ -412,6 +413,14 @@ class PatternMatchEmission {
   using CompletionHandlerTy =
     llvm::function_ref<void(PatternMatchEmission &, ArgArray, ClauseRow &)>;
   CompletionHandlerTy CompletionHandler;
+
+  /// For a switch over a String, the number of the string literal case
+  /// which the subject is equal to, as found by _findStringSwitchCase.
+  SILValue StringCaseNumber;
+
+  /// The numbers of the string literal patterns which are tested by
+  /// comparing StringCaseNumber rather than by calling '~='.
+  llvm::DenseMap<ExprPattern *, unsigned> StringCasePatterns;
 public:
   
   PatternMatchEmission(SILGenFunction &SGF, Stmt *S,
@@ -428,6 +437,8 @@ public:
 
   void emitCaseBody(CaseStmt *caseBlock);
 
+  void emitStringCaseNumber(SwitchStmt *S, ManagedValue subject);
+
 private:
   void emitWildcardDispatch(ClauseMatrix &matrix, ArgArray args, unsigned row,
                             const FailureHandler &failure);
@@ -1101,6 +1112,25 @@ void PatternMatchEmission::bindRefutablePattern(Pattern *pattern,
 void PatternMatchEmission::bindExprPattern(ExprPattern *pattern,
                                            ConsumableManagedValue value,
                                            const FailureHandler &failure) {
+  auto stringCase = StringCasePatterns.find(pattern);
+  if (stringCase != StringCasePatterns.end()) {
+    auto &ctx = SGF.getASTContext();
+    auto wordTy = SILType::getBuiltinWordType(ctx);
+    SILValue number = SGF.B.createIntegerLiteral(pattern, wordTy,
+                                                 stringCase->second);
+    SILValue testBool = SGF.B.createBuiltinBinaryFunction(
+        pattern, "cmp_eq", wordTy, SILType::getBuiltinIntegerType(1, ctx),
+        {StringCaseNumber, number});
+
+    SILBasicBlock *falseBB = SGF.B.splitBlockForFallthrough();
+    SILBasicBlock *trueBB = SGF.B.splitBlockForFallthrough();
+    SGF.B.createCondBranch(pattern, testBool, trueBB, falseBB);
+    SGF.B.setInsertionPoint(falseBB);
+    failure(pattern);
+    SGF.B.setInsertionPoint(trueBB);
+    return;
+  }
+
   FullExpr scope(SGF.Cleanups, CleanupLocation(pattern));
   bindVariable(pattern, pattern->getMatchVar(), value,
                pattern->getType()->getCanonicalType(),
@@ -2165,6 +2195,93 @@ namespace {
 }
 
 
+/// The smallest number of distinct string literal cases for which a switch
+/// over a String looks up the matching case with _findStringSwitchCase.
+static const unsigned MinStringSwitchCases = 4;
+
+/// Returns the pattern \p P as a string literal pattern which
+/// _findStringSwitchCase can look up, or null if it is not one.
+///
+/// The literal has to be matched by the standard library's '~=', which
+/// compares Strings for equality. It also has to be ASCII, so that distinct
+/// literals are never canonically equivalent, and short enough for its
+/// length to fit in a single ASCII byte.
+static ExprPattern *getStringCasePattern(const Pattern *P) {
+  auto *pattern =
+    dyn_cast<ExprPattern>(const_cast<Pattern *>(P)
+                            ->getSemanticsProvidingPattern());
+  if (!pattern || !pattern->getMatchExpr())
+    return nullptr;
+  auto *literal = dyn_cast<StringLiteralExpr>(
+      pattern->getSubExpr()->getSemanticsProvidingExpr());
+  if (!literal || literal->getValue().size() > 0x7F)
+    return nullptr;
+  for (unsigned char c : literal->getValue())
+    if (c > 0x7F)
+      return nullptr;
+
+  auto *match = dyn_cast<ApplyExpr>(pattern->getMatchExpr());
+  ValueDecl *matchFn = match ? match->getCalledValue() : nullptr;
+  if (!matchFn || !matchFn->getModuleContext()->isStdlibModule())
+    return nullptr;
+  return pattern;
+}
+
+/// If \p S is a switch over a String with enough string literal cases,
+/// looks up the case which \p subject is equal to once, so that the cases
+/// are tested by comparing integers. The cases are still tested in order,
+/// so guards and the other patterns keep their semantics.
+void PatternMatchEmission::emitStringCaseNumber(SwitchStmt *S,
+                                                ManagedValue subject) {
+  auto &ctx = SGF.getASTContext();
+  Type subjectTy = S->getSubjectExpr()->getType();
+  if (!subjectTy || subjectTy->getAnyNominal() != ctx.getStringDecl())
+    return;
+  FuncDecl *findCase = ctx.getFindStringSwitchCase(nullptr);
+  if (!findCase)
+    return;
+
+  // Lay out the distinct literals one after the other, each preceded by a
+  // byte with its length.
+  std::string table;
+  llvm::StringMap<unsigned> numbers;
+  for (auto caseBlock : S->getCases()) {
+    for (auto &labelItem : caseBlock->getCaseLabelItems()) {
+      ExprPattern *pattern = getStringCasePattern(labelItem.getPattern());
+      if (!pattern)
+        continue;
+      StringRef value =
+        cast<StringLiteralExpr>(
+            pattern->getSubExpr()->getSemanticsProvidingExpr())->getValue();
+      unsigned number = numbers.size();
+      auto inserted = numbers.insert({value, number});
+      if (inserted.second) {
+        table.push_back(char(value.size()));
+        table += value;
+      }
+      StringCasePatterns[pattern] = inserted.first->second;
+    }
+  }
+  if (numbers.size() < MinStringSwitchCases) {
+    StringCasePatterns.clear();
+    return;
+  }
+
+  SILLocation loc = S->getSubjectExpr();
+  auto wordTy = SILType::getBuiltinWordType(ctx);
+  ManagedValue args[] = {
+    subject.copy(SGF, loc),
+    ManagedValue::forUnmanaged(
+      SGF.B.createStringLiteral(loc, table,
+                                StringLiteralInst::Encoding::UTF8)),
+    ManagedValue::forUnmanaged(
+      SGF.B.createIntegerLiteral(loc, wordTy, table.size())),
+  };
+  StringCaseNumber =
+    SGF.emitApplyOfLibraryIntrinsic(loc, findCase, {}, args, SGFContext())
+      .getUnmanagedSingleValue(SGF, loc);
+}
+
 static bool containsFallthrough(Stmt *S) {
   bool Result = false;
   S->walk(FallthroughFinder(Result));
@@ -2297,6 +2414,7 @@ void SILGenFunction::emitSwitchStmt(SwitchStmt *S) {
   // Emit the subject value. Dispatching will consume it.
   ManagedValue subjectMV = emitRValueAsSingleValue(S->getSubjectExpr());
   auto subject = ConsumableManagedValue::forOwned(subjectMV);
+  emission.emitStringCaseNumber(S, subjectMV);
 
   // Add a row for each label of each case.
   // We use std::vector because it supports emplace_back; moving
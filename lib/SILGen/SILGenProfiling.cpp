@@ -23,6 +23,7 @@
 #include "llvm/ProfileData/CoverageMapping.h"
 #include "llvm/ProfileData/CoverageMappingWriter.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 
 #include <forward_list>
 
@@ -63,10 +64,10 @@ static void walkForProfiling(AbstractFunctionDecl *Root, ASTWalker &Walker) {
 ProfilerRAII::ProfilerRAII(SILGenModule &SGM, AbstractFunctionDecl *D)
     : SGM(SGM), PreviousProfiler(std::move(SGM.Profiler)) {
   const auto &Opts = SGM.M.getOptions();
-  if (!Opts.GenerateProfile || isUnmappedDecl(D))
+  if ((!Opts.GenerateProfile && !SGM.ProfileReader) || isUnmappedDecl(D))
     return;
-  SGM.Profiler =
-      llvm::make_unique<SILGenProfiling>(SGM, Opts.EmitProfileCoverageMapping);
+  SGM.Profiler = llvm::make_unique<SILGenProfiling>(
+      SGM, Opts.GenerateProfile, Opts.EmitProfileCoverageMapping);
   SGM.Profiler->assignRegionCounters(D);
 }
 
@@ -82,8 +83,13 @@ struct MapRegionCounters : public ASTWalker {
   /// The map of statements to counters.
   llvm::DenseMap<ASTNode, unsigned> &CounterMap;
 
-  MapRegionCounters(llvm::DenseMap<ASTNode, unsigned> &CounterMap)
-      : NextCounter(0), CounterMap(CounterMap) {}
+  /// The cases whose counts are derived from the counters of their switches,
+  /// mapped to the switches.
+  llvm::DenseMap<CaseStmt *, SwitchStmt *> &DerivedCases;
+
+  MapRegionCounters(llvm::DenseMap<ASTNode, unsigned> &CounterMap,
+                    llvm::DenseMap<CaseStmt *, SwitchStmt *> &DerivedCases)
+      : NextCounter(0), CounterMap(CounterMap), DerivedCases(DerivedCases) {}
 
   bool walkToDeclPre(Decl *D) override {
     if (isUnmappedDecl(D))
@@ -109,8 +115,13 @@ struct MapRegionCounters : public ASTWalker {
       walkForProfiling(FES->getIterator(), *this);
     } else if (auto *SS = dyn_cast<SwitchStmt>(S)) {
       CounterMap[SS] = NextCounter++;
+      // Every time the switch is entered, exactly one of its cases is, so the
+      // last case doesn't need a counter of its own.
+      if (!SS->getCases().empty())
+        DerivedCases[SS->getCases().back()] = SS;
     } else if (auto *CS = dyn_cast<CaseStmt>(S)) {
-      CounterMap[CS] = NextCounter++;
+      if (!DerivedCases.count(CS))
+        CounterMap[CS] = NextCounter++;
     } else if (auto *DCS = dyn_cast<DoCatchStmt>(S)) {
       CounterMap[DCS] = NextCounter++;
     } else if (auto *CS = dyn_cast<CatchStmt>(S)) {
@@ -522,10 +533,18 @@ public:
       walkForProfiling(FES->getIterator(), *this);
 
     } else if (auto *SS = dyn_cast<SwitchStmt>(S)) {
-      assignCounter(SS);
-      // Assign counters for cases so they're available for fallthrough.
-      for (CaseStmt *Case : SS->getCases())
-        assignCounter(Case);
+      CounterExpr *Remaining = &assignCounter(SS);
+      // Assign counters for cases so they're available for fallthrough. The
+      // last case is entered whenever none of the others is.
+      ArrayRef<CaseStmt *> Cases = SS->getCases();
+      if (!Cases.empty()) {
+        for (CaseStmt *Case : Cases.drop_back()) {
+          assignCounter(Case);
+          Remaining = &createCounter(CounterExpr::Sub(
+              *Remaining, createCounter(CounterExpr::Leaf(Case))));
+        }
+        assignCounter(Cases.back(), CounterExpr::Ref(*Remaining));
+      }
 
     } else if (isa<CaseStmt>(S)) {
       pushRegion(S);
@@ -672,12 +691,24 @@ void SILGenProfiling::assignRegionCounters(AbstractFunctionDecl *Root) {
   if (auto *ParentFile = Root->getParentSourceFile())
     CurrentFileName = ParentFile->getFilename();
 
-  MapRegionCounters Mapper(RegionCounterMap);
+  MapRegionCounters Mapper(RegionCounterMap, DerivedCases);
   walkForProfiling(Root, Mapper);
 
   NumRegionCounters = Mapper.NextCounter;
   // TODO: Mapper needs to calculate a function hash as it goes.
   FunctionHash = 0x0;
+  PGOFuncName = llvm::getPGOFuncName(
+      CurrentFuncName, getEquivalentPGOLinkage(CurrentFuncLinkage),
+      CurrentFileName);
+
+  if (SGM.ProfileReader) {
+    // A profile from a different version of the function is useless, so
+    // ignore counts if the number of counters doesn't match.
+    if (SGM.ProfileReader->getFunctionCounts(PGOFuncName, FunctionHash,
+                                             RegionCounts) ||
+        RegionCounts.size() != NumRegionCounters)
+      RegionCounts.clear();
+  }
 
   if (EmitCoverageMapping) {
     CoverageMapping Coverage(SGM.M.getASTContext().SourceMgr);
@@ -689,6 +720,23 @@ void SILGenProfiling::assignRegionCounters(AbstractFunctionDecl *Root) {
   }
 }
 
+void SILGenProfiling::emitDerivedCaseCount(SILGenBuilder &Builder,
+                                           CaseStmt *Case) {
+  auto Derived = DerivedCases.find(Case);
+  assert(Derived != DerivedCases.end() &&
+         "cannot increment non-existent counter");
+  if (RegionCounts.empty())
+    return;
+
+  // The case is entered as often as its switch, less the other cases.
+  SwitchStmt *Switch = Derived->second;
+  uint64_t Count = RegionCounts[RegionCounterMap[Switch]];
+  for (CaseStmt *Other : Switch->getCases())
+    if (Other != Case)
+      Count -= std::min(Count, RegionCounts[RegionCounterMap[Other]]);
+  Builder.getInsertionBB()->setExecutionCount(Count);
+}
+
 static SILLocation getLocation(ASTNode Node) {
   if (Expr *E = Node.dyn_cast<Expr *>())
     return E;
@@ -704,16 +752,29 @@ void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
   auto &C = Builder.getASTContext();
 
   auto CounterIt = RegionCounterMap.find(Node);
-  assert(CounterIt != RegionCounterMap.end() &&
-         "cannot increment non-existent counter");
+  if (CounterIt == RegionCounterMap.end()) {
+    emitDerivedCaseCount(Builder, cast<CaseStmt>(Node.get<Stmt *>()));
+    return;
+  }
+
+  if (!RegionCounts.empty()) {
+    // Region counters are incremented at the start of the region, so the
+    // count of the region is the execution count of the current block.
+    uint64_t Count = RegionCounts[CounterIt->second];
+    SILBasicBlock *BB = Builder.getInsertionBB();
+    BB->setExecutionCount(Count);
+    // The counters of function bodies and closures are incremented in the
+    // entry block.
+    if (BB->isEntry())
+      Builder.getFunction().setEntryCount(Count);
+  }
+
+  if (!EmitIncrements)
+    return;
 
   auto Int32Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(32, C));
   auto Int64Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(64, C));
 
-  std::string PGOFuncName = llvm::getPGOFuncName(
-      CurrentFuncName, getEquivalentPGOLinkage(CurrentFuncLinkage),
-      CurrentFileName);
-
   SILLocation Loc = getLocation(Node);
   SILValue Args[] = {
       // The intrinsic must refer to the function profiling name var, which is
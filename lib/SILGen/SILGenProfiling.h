@@ -33,32 +33,51 @@ struct ProfilerRAII;
 class SILGenProfiling {
 private:
   SILGenModule &SGM;
+  bool EmitIncrements;
   bool EmitCoverageMapping;
 
   // The current function's name and counter data.
   std::string CurrentFuncName;
+  std::string PGOFuncName;
   StringRef CurrentFileName;
   FormalLinkage CurrentFuncLinkage;
   unsigned NumRegionCounters;
   uint64_t FunctionHash;
   llvm::DenseMap<ASTNode, unsigned> RegionCounterMap;
 
+  /// The last case of each switch, which has no counter of its own, mapped
+  /// to the switch.
+  llvm::DenseMap<CaseStmt *, SwitchStmt *> DerivedCases;
+
+  /// The execution counts of the current function's regions, indexed by
+  /// counter, if there is profile data for the function.
+  std::vector<uint64_t> RegionCounts;
+
   std::vector<std::tuple<std::string, uint64_t, std::string>> CoverageData;
 
 public:
-  SILGenProfiling(SILGenModule &SGM, bool EmitCoverageMapping)
-      : SGM(SGM), EmitCoverageMapping(EmitCoverageMapping),
-        NumRegionCounters(0), FunctionHash(0) {}
+  SILGenProfiling(SILGenModule &SGM, bool EmitIncrements,
+                  bool EmitCoverageMapping)
+      : SGM(SGM), EmitIncrements(EmitIncrements),
+        EmitCoverageMapping(EmitCoverageMapping), NumRegionCounters(0),
+        FunctionHash(0) {}
 
   bool hasRegionCounters() const { return NumRegionCounters != 0; }
 
-  /// Emit SIL to increment the counter for \c Node.
+  /// Emit SIL to increment the counter for \c Node, if the code is
+  /// instrumented. If there is profile data for the function, the execution
+  /// count of \c Node is attached to the current block.
   void emitCounterIncrement(SILGenBuilder &Builder, ASTNode Node);
 
 private:
   /// Map counters to ASTNodes and set them up for profiling the given function.
   void assignRegionCounters(AbstractFunctionDecl *Root);
 
+  /// Attach the execution count of \c Case, which is derived from the
+  /// counts of its switch and the switch's other cases, to the current
+  /// block, if there is profile data for the function.
+  void emitDerivedCaseCount(SILGenBuilder &Builder, CaseStmt *Case);
+
   friend struct ProfilerRAII;
 };
 
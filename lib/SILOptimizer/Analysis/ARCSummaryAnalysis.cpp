@@ -0,0 +1,141 @@
+//===--- ARCSummaryAnalysis.cpp - Retain/release summaries ----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "arc-summary-analysis"
+#include "swift/SILOptimizer/Analysis/ARCSummaryAnalysis.h"
+#include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
+#include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
+#include "swift/SILOptimizer/PassManager/PassManager.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+void ARCSummaryAnalysis::initialize(SILPassManager *PM) {
+  SEA = PM->getAnalysis<SideEffectAnalysis>();
+  RCIA = PM->getAnalysis<RCIdentityAnalysis>();
+}
+
+ARCArgumentKind ARCSummaryAnalysis::getArgumentKind(SILFunction *F,
+                                                    unsigned Index) {
+  if (F->isExternalDeclaration())
+    return ARCArgumentKind::Unknown;
+
+  auto Iter = Cache.find(F);
+  if (Iter == Cache.end()) {
+    // We are already computing the summary of F further up the call chain.
+    // Be conservative for recursive functions.
+    if (!InProgress.insert(F).second)
+      return ARCArgumentKind::Unknown;
+    llvm::SmallVector<ARCArgumentKind, 4> Summary;
+    computeSummary(F, Summary);
+    InProgress.erase(F);
+    Iter = Cache.insert({F, Summary}).first;
+  }
+  if (Index >= Iter->second.size())
+    return ARCArgumentKind::Unknown;
+  return Iter->second[Index];
+}
+
+void ARCSummaryAnalysis::computeSummary(
+    SILFunction *F, llvm::SmallVectorImpl<ARCArgumentKind> &Summary) {
+  ArrayRef<SILArgument *> Args = F->begin()->getBBArgs();
+
+  // Guaranteed arguments are classified by their side-effects. Do this before
+  // looking at callees, which may recompute side-effects.
+  {
+    const auto &Effects = SEA->getEffects(F);
+    const auto &GlobalEffects = Effects.getGlobalEffects();
+    auto ParamEffects = Effects.getParameterEffects();
+    for (SILArgument *Arg : Args) {
+      ARCArgumentKind Kind = ARCArgumentKind::Unknown;
+      unsigned Idx = Arg->getIndex();
+      if (!Arg->hasConvention(SILArgumentConvention::Direct_Owned) &&
+          Idx < ParamEffects.size() && !GlobalEffects.mayRelease() &&
+          !ParamEffects[Idx].mayRelease()) {
+        if (GlobalEffects.mayRetain() || ParamEffects[Idx].mayRetain())
+          Kind = ARCArgumentKind::Guaranteed;
+        else
+          Kind = ARCArgumentKind::ReadOnly;
+      }
+      Summary.push_back(Kind);
+    }
+  }
+
+  // An @owned argument must be released on every exit. Either we find the
+  // epilogue releases or the argument is handed over to a callee which
+  // releases it.
+  ConsumedArgToEpilogueReleaseMatcher ReturnReleases(RCIA->get(F), F);
+  ConsumedArgToEpilogueReleaseMatcher ThrowReleases(
+      RCIA->get(F), F, ConsumedArgToEpilogueReleaseMatcher::ExitKind::Throw);
+  for (SILArgument *Arg : Args) {
+    if (!Arg->hasConvention(SILArgumentConvention::Direct_Owned))
+      continue;
+    ARCArgumentKind &Kind = Summary[Arg->getIndex()];
+    if (!ReturnReleases.getReleasesForArgument(Arg).empty()) {
+      if (!ThrowReleases.hasBlock() ||
+          !ThrowReleases.getReleasesForArgument(Arg).empty())
+        Kind = ARCArgumentKind::Consumed;
+    } else if (!ThrowReleases.hasBlock() && findConsumingCall(Arg)) {
+      Kind = ARCArgumentKind::Consumed;
+    }
+  }
+}
+
+ApplyInst *ARCSummaryAnalysis::findConsumingCall(SILArgument *Arg) {
+  if (!Arg->isFunctionArg() ||
+      !Arg->hasConvention(SILArgumentConvention::Direct_Owned))
+    return nullptr;
+
+  SILFunction *F = Arg->getFunction();
+  auto ReturnBB = F->findReturnBB();
+  if (ReturnBB == F->end())
+    return nullptr;
+
+  // Look for the single apply in the return block which takes the argument.
+  ApplyInst *ConsumingCall = nullptr;
+  unsigned ArgIdx = 0;
+  for (auto &I : *ReturnBB) {
+    auto *AI = dyn_cast<ApplyInst>(&I);
+    if (!AI)
+      continue;
+    for (unsigned i = 0, e = AI->getNumArguments(); i != e; ++i) {
+      if (AI->getArgument(i) != SILValue(Arg))
+        continue;
+      // Passing the argument twice, or to two calls, is too complicated.
+      if (ConsumingCall)
+        return nullptr;
+      ConsumingCall = AI;
+      ArgIdx = i;
+    }
+  }
+  if (!ConsumingCall ||
+      ConsumingCall->getArgumentConvention(ArgIdx) !=
+          SILArgumentConvention::Direct_Owned)
+    return nullptr;
+
+  SILFunction *Callee = ConsumingCall->getCalleeFunction();
+  if (!Callee ||
+      getArgumentKind(Callee, ArgIdx) != ARCArgumentKind::Consumed)
+    return nullptr;
+
+  DEBUG(llvm::dbgs() << "    " << F->getName() << " forwards " << *Arg
+                     << "    to consuming callee " << Callee->getName()
+                     << "\n");
+  return ConsumingCall;
+}
+
+SILAnalysis *swift::createARCSummaryAnalysis(SILModule *M) {
+  return new ARCSummaryAnalysis(M);
+}
@@ -13,6 +13,7 @@
 #include "swift/SILOptimizer/Analysis/ColdBlockInfo.h"
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILModule.h"
 
 using namespace swift;
 
@@ -106,11 +107,38 @@ ColdBlockInfo::BranchHint ColdBlockInfo::getBranchHint(SILValue Cond,
   return BranchHint::None;
 }
 
+bool ColdBlockInfo::isColdByProfile(const SILBasicBlock *BB) {
+  auto Count = BB->getExecutionCount();
+  auto EntryCount = BB->getParent()->getEntryCount();
+  if (!Count || !EntryCount)
+    return false;
+  return *Count * ColdCountRatio < *EntryCount;
+}
+
+uint64_t ColdBlockInfo::getHotCount(SILModule &M) {
+  uint64_t MaxCount = 0;
+  for (SILFunction &F : M) {
+    if (!F.getEntryCount())
+      continue;
+    MaxCount = std::max(MaxCount, *F.getEntryCount());
+    for (SILBasicBlock &BB : F) {
+      if (auto Count = BB.getExecutionCount())
+        MaxCount = std::max(MaxCount, *Count);
+    }
+  }
+  if (MaxCount == 0)
+    return 0;
+  return std::max(MaxCount / HotCountRatio, uint64_t(1));
+}
+
 /// \return true if the CFG edge FromBB->ToBB is directly gated by a _slowPath
-/// branch hint.
+/// branch hint or if the profile data shows that the edge is rarely taken.
 bool ColdBlockInfo::isSlowPath(const SILBasicBlock *FromBB,
                                const SILBasicBlock *ToBB,
                                int recursionDepth) {
+  if (isColdByProfile(ToBB) && !isColdByProfile(FromBB))
+    return true;
+
   auto *CBI = dyn_cast<CondBranchInst>(FromBB->getTerminator());
   if (!CBI)
     return false;
@@ -17,6 +17,7 @@
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILModule.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -1229,6 +1230,31 @@ void EscapeAnalysis::analyzeInstruction(SILInstruction *I,
       if (Fn->getName() == "swift_bufferAllocate")
         // The call is a buffer allocation, e.g. for Array.
         return;
+
+      // For a function of another module we may have a summary which tells
+      // which arguments don't escape in the callee.
+      if (Fn->isExternalDeclaration()) {
+        const SILFunctionSummary *Summary = M->lookUpFunctionSummary(Fn);
+        if (Summary && Summary->getNumArguments() == FAS.getNumArguments()) {
+          for (unsigned Idx = 0, End = FAS.getNumArguments(); Idx < End;
+               ++Idx) {
+            SILValue Arg = FAS.getArgument(Idx);
+            if (Summary->getArgument(Idx).MayEscape) {
+              setEscapesGlobal(ConGraph, Arg);
+            } else if (CGNode *ArgNode = ConGraph->getNode(Arg, this)) {
+              // The summary doesn't tell anything about what the callee does
+              // with the content of the argument.
+              ConGraph->setEscapesGlobal(ConGraph->getContentNode(ArgNode));
+            }
+          }
+          if (auto *TAI = dyn_cast<TryApplyInst>(I)) {
+            setEscapesGlobal(ConGraph, TAI->getNormalBB()->getBBArg(0));
+            setEscapesGlobal(ConGraph, TAI->getErrorBB()->getBBArg(0));
+          }
+          setEscapesGlobal(ConGraph, I);
+          return;
+        }
+      }
     }
   }
   if (isProjection(I))
@@ -1837,6 +1863,38 @@ bool EscapeAnalysis::canParameterEscape(FullApplySite FAS, int ParamIdx,
   return false;
 }
 
+bool EscapeAnalysis::canArgumentEscape(SILFunction *F, unsigned ArgIdx) {
+  assert(F->isDefinition() && "a summary graph needs a function body");
+  FunctionInfo *FInfo = getFunctionInfo(F);
+  if (!FInfo->isValid())
+    recompute(FInfo);
+
+  ConnectionGraph *SummaryGraph = &FInfo->SummaryGraph;
+  CGNode *Node = SummaryGraph->getNodeOrNull(F->getArgument(ArgIdx), this);
+  // Either the argument is not a pointer or it is not used at all.
+  if (!Node)
+    return false;
+
+  if (Node->escapes())
+    return true;
+
+  // Check if the value is stored into memory which is reachable from another
+  // argument or from the return value.
+  for (unsigned Idx = 0, End = F->getArguments().size(); Idx < End; ++Idx) {
+    if (Idx == ArgIdx)
+      continue;
+    CGNode *OtherNode =
+        SummaryGraph->getNodeOrNull(F->getArgument(Idx), this);
+    if (OtherNode && SummaryGraph->isReachable(Node, OtherNode))
+      return true;
+  }
+  if (CGNode *RetNode = SummaryGraph->getReturnNodeOrNull()) {
+    if (SummaryGraph->isReachable(Node, RetNode))
+      return true;
+  }
+  return false;
+}
+
 void EscapeAnalysis::invalidate(InvalidationKind K) {
   Function2Info.clear();
   Allocator.DestroyAll();
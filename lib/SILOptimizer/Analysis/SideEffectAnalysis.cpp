@@ -16,6 +16,7 @@
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILModule.h"
 
 using namespace swift;
 
@@ -171,6 +172,33 @@ bool SideEffectAnalysis::getDefinedEffects(FunctionEffects &Effects,
   return false;
 }
 
+bool SideEffectAnalysis::getSummaryEffects(FunctionEffects &Effects,
+                                           SILFunction *F) {
+  if (!F->isExternalDeclaration())
+    return false;
+
+  const SILFunctionSummary *Summary = F->getModule().lookUpFunctionSummary(F);
+  if (!Summary || Summary->getNumArguments() != Effects.ParamEffects.size())
+    return false;
+
+  auto mergeSummaryEffects = [](SideEffectAnalysis::Effects &E,
+                                uint8_t SummaryEffects) {
+    E.Reads |= (SummaryEffects & SILFunctionSummary::Reads) != 0;
+    E.Writes |= (SummaryEffects & SILFunctionSummary::Writes) != 0;
+    E.Retains |= (SummaryEffects & SILFunctionSummary::Retains) != 0;
+    E.Releases |= (SummaryEffects & SILFunctionSummary::Releases) != 0;
+  };
+  mergeSummaryEffects(Effects.GlobalEffects, Summary->getGlobalEffects());
+  for (unsigned Idx = 0, End = Summary->getNumArguments(); Idx < End; ++Idx) {
+    mergeSummaryEffects(Effects.ParamEffects[Idx],
+                        Summary->getArgument(Idx).Effects);
+  }
+  Effects.AllocsObjects |= Summary->hasFlag(SILFunctionSummary::AllocsObjects);
+  Effects.Traps |= Summary->hasFlag(SILFunctionSummary::Traps);
+  Effects.ReadsRC |= Summary->hasFlag(SILFunctionSummary::ReadsRC);
+  return true;
+}
+
 bool SideEffectAnalysis::getSemanticEffects(FunctionEffects &FE,
                                             ArraySemanticsCall ASC) {
   assert(ASC.hasSelf());
@@ -292,6 +320,15 @@ void SideEffectAnalysis::analyzeInstruction(FunctionInfo *FInfo,
       // Does the function have any @effects?
       if (getDefinedEffects(FInfo->FE, SingleCallee))
         return;
+
+      // Does the module which defines the function provide a summary?
+      if (SingleCallee->isExternalDeclaration()) {
+        FunctionEffects ApplyEffects(FAS.getNumArguments());
+        if (getSummaryEffects(ApplyEffects, SingleCallee)) {
+          FInfo->FE.mergeFromApply(ApplyEffects, FAS);
+          return;
+        }
+      }
     }
 
     if (RecursionDepth < MaxRecursionDepth) {
@@ -480,6 +517,9 @@ void SideEffectAnalysis::getEffects(FunctionEffects &ApplyEffects, FullApplySite
     // Does the function have any @effects?
     if (getDefinedEffects(ApplyEffects, SingleCallee))
       return;
+
+    if (getSummaryEffects(ApplyEffects, SingleCallee))
+      return;
   }
 
   auto Callees = BCA->getCalleeList(FAS);
@@ -94,6 +94,36 @@ static bool isSupportedClosureKind(const SILInstruction *I) {
   return isa<ThinToThickFunctionInst>(I) || isa<PartialApplyInst>(I);
 }
 
+/// The number of functions a closure argument may be passed on through
+/// before one of them calls it, for the closure to be specialized.
+static const unsigned MaxClosureForwardingDepth = 4;
+
+/// Returns true if the function argument \p Arg is called in its function,
+/// or passed on to a function which calls it, through at most \p Depth
+/// functions which only pass it on.
+static bool isClosureArgumentCalled(SILValue Arg, unsigned Depth) {
+  for (auto *Op : Arg->getUses()) {
+    auto UserAI = FullApplySite::isa(Op->getUser());
+    if (!UserAI)
+      continue;
+    if (UserAI.getCallee() == Arg)
+      return true;
+
+    // The closure specializer only handles calls without substitutions of
+    // known functions, like the one which passes Arg on.
+    if (Depth == 0 || UserAI.hasSubstitutions())
+      continue;
+    SILFunction *Callee = UserAI.getReferencedFunction();
+    if (!Callee || Callee->isExternalDeclaration())
+      continue;
+    for (unsigned i = 0, e = UserAI.getNumArguments(); i != e; ++i)
+      if (UserAI.getArgument(i) == Arg &&
+          isClosureArgumentCalled(Callee->getArgument(i), Depth - 1))
+        return true;
+  }
+  return false;
+}
+
 //===----------------------------------------------------------------------===//
 //                       Closure Spec Cloner Interface
 //===----------------------------------------------------------------------===//
@@ -426,8 +456,10 @@ void CallSiteDescriptor::extendArgumentLifetime(SILValue Arg) const {
   }
 }
 
-static void specializeClosure(ClosureInfo &CInfo,
-                              CallSiteDescriptor &CallDesc) {
+/// Specializes the callee of \p CallDesc for the closure and rewrites the
+/// call. Returns the specialized function if it has just been created.
+static SILFunction *specializeClosure(ClosureInfo &CInfo,
+                                      CallSiteDescriptor &CallDesc) {
   auto NewFName = CallDesc.createName();
   DEBUG(llvm::dbgs() << "    Perform optimizations with new name " << NewFName
                      << '\n');
@@ -438,11 +470,13 @@ static void specializeClosure(ClosureInfo &CInfo,
 
   // If not, create a specialized version of ApplyCallee calling the closure
   // directly.
+  SILFunction *CreatedF = nullptr;
   if (!NewF)
-    NewF = ClosureSpecCloner::cloneFunction(CallDesc, NewFName);
+    NewF = CreatedF = ClosureSpecCloner::cloneFunction(CallDesc, NewFName);
 
   // Rewrite the call
   rewriteApplyInst(CallDesc, NewF);
+  return CreatedF;
 }
 
 static bool isSupportedClosure(const SILInstruction *Closure) {
@@ -695,6 +729,10 @@ class ClosureSpecializer {
   std::vector<SILInstruction *> PropagatedClosures;
   bool IsPropagatedClosuresUniqued = false;
 
+  /// The specialized functions created by specialize which have not been
+  /// specialized themselves yet.
+  std::vector<SILFunction *> NewSpecializations;
+
 public:
   ClosureSpecializer() = default;
 
@@ -703,6 +741,16 @@ public:
                        llvm::DenseSet<FullApplySite> &MultipleClosureAI);
   bool specialize(SILFunction *Caller);
 
+  /// Returns a specialized function which still has to be specialized
+  /// itself, or null if there is none.
+  SILFunction *popNewSpecialization() {
+    if (NewSpecializations.empty())
+      return nullptr;
+    auto *F = NewSpecializations.back();
+    NewSpecializations.pop_back();
+    return F;
+  }
+
   ArrayRef<SILInstruction *> getPropagatedClosures() {
     if (IsPropagatedClosuresUniqued)
       return PropagatedClosures;
@@ -777,20 +825,18 @@ void ClosureSpecializer::gatherCallSites(
         if (!ClosureIndex.hasValue())
           continue;
 
-        // Make sure that the Closure is invoked in the Apply's callee. We only
-        // want to perform closure specialization if we know that we will be
-        // able to change a partial_apply into an apply.
+        // Make sure that the Closure is invoked in the Apply's callee, or in
+        // a function the callee passes it on to. We only want to perform
+        // closure specialization if we know that we will be able to change a
+        // partial_apply into an apply. If the callee passes the closure on,
+        // the specialized callee creates the closure itself, and its call
+        // which passes the closure on is specialized in turn.
         //
         // TODO: Maybe just call the function directly instead of moving the
         // partial apply?
         SILValue Arg = ApplyCallee->getArgument(ClosureIndex.getValue());
-        if (std::none_of(Arg->use_begin(), Arg->use_end(),
-                         [&Arg](Operand *Op) -> bool {
-                           auto UserAI = FullApplySite::isa(Op->getUser());
-                           return UserAI && UserAI.getCallee() == Arg;
-                         })) {
+        if (!isClosureArgumentCalled(Arg, MaxClosureForwardingDepth))
           continue;
-        }
 
         auto NumIndirectResults =
           AI.getSubstCalleeType()->getNumIndirectResults();
@@ -850,7 +896,8 @@ bool ClosureSpecializer::specialize(SILFunction *Caller) {
       if (MultipleClosureAI.count(CSDesc.getApplyInst()))
         continue;
 
-      specializeClosure(*CInfo, CSDesc);
+      if (SILFunction *NewF = specializeClosure(*CInfo, CSDesc))
+        NewSpecializations.push_back(NewF);
       PropagatedClosures.push_back(CSDesc.getClosure());
       Changed = true;
     }
@@ -889,6 +936,12 @@ public:
         continue;
 
       Changed |= C.specialize(F);
+
+      // A specialized function creates the closure itself, so its calls
+      // which pass the closure on to other higher-order functions can be
+      // specialized in turn. The new functions are not in Ordering.
+      while (SILFunction *NewF = C.popNewSpecialization())
+        Changed |= C.specialize(NewF);
     }
 
     // Invalidate everything since we delete calls as well as add new
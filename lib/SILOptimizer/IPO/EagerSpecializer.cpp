@@ -445,10 +445,38 @@ static SILFunction *eagerSpecialize(SILFunction *GenericFunc,
         FuncSpecializer(GenericFunc, SA.getSubstitutions(),
                         GenericFunc->isFragile(), ReInfo);
 
-  SILFunction *NewFunc = FuncSpecializer.trySpecialization();
-  if (!NewFunc)
-    DEBUG(dbgs() << "  Failed. Cannot specialize function.\n");
+  // The specialization was explicitly requested with @_specialize, so it is
+  // not checked against the cost model. But it counts against the budget of
+  // the module.
+  SpecializationRemark Remark;
+  Remark.Pass = "eager-specializer";
+  Remark.Decision = "rejected";
+  Remark.Callee = GenericFunc->getName();
+  SILModule &M = GenericFunc->getModule();
+
+  if (!ReInfo.getSpecializedType()) {
+    Remark.Reason = ReInfo.getRejectReason();
+    Remark.emit(M);
+    return nullptr;
+  }
 
+  SILFunction *NewFunc = FuncSpecializer.lookupSpecialization();
+  if (NewFunc) {
+    Remark.Decision = "reused";
+  } else {
+    NewFunc = FuncSpecializer.tryCreateSpecialization();
+    if (!NewFunc) {
+      DEBUG(dbgs() << "  Failed. Cannot specialize function.\n");
+      Remark.Reason = "cannot create specialization";
+      Remark.emit(M);
+      return nullptr;
+    }
+    computeSpecializationSize(GenericFunc, Remark.Cost);
+    M.addSpecializedInstructions(Remark.Cost.Size);
+    Remark.Decision = "created";
+  }
+  Remark.Specialization = NewFunc->getName();
+  Remark.emit(M);
   return NewFunc;
 }
 
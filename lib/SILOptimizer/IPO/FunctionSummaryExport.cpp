@@ -0,0 +1,119 @@
+//===--- FunctionSummaryExport.cpp - Compute summaries for clients --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Computes the SILFunctionSummary of all functions which may be called from
+// other modules. The summaries are serialized into the module file, so that
+// SideEffectAnalysis and EscapeAnalysis don't have to be conservative about
+// calls to these functions in client modules, and so that the SIL linker of a
+// client module knows the size of a serialized body before deserializing it.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "function-summary-export"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/Analysis/EscapeAnalysis.h"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/SILInliner.h"
+#include "swift/SIL/SILFunctionSummary.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumSummariesExported, "Number of exported function summaries");
+
+static uint8_t getSummaryEffects(const SideEffectAnalysis::Effects &E) {
+  uint8_t Result = 0;
+  if (E.mayRead())
+    Result |= SILFunctionSummary::Reads;
+  if (E.mayWrite())
+    Result |= SILFunctionSummary::Writes;
+  if (E.mayRetain())
+    Result |= SILFunctionSummary::Retains;
+  if (E.mayRelease())
+    Result |= SILFunctionSummary::Releases;
+  return Result;
+}
+
+/// Returns the inline cost of the whole body of \p F, as the performance
+/// inliner would compute it without any constant propagation.
+static uint32_t getBodyCost(SILFunction &F) {
+  uint32_t Cost = 0;
+  for (SILBasicBlock &BB : F) {
+    for (SILInstruction &I : BB)
+      Cost += unsigned(instructionInlineCost(I));
+  }
+  return Cost;
+}
+
+namespace {
+
+class FunctionSummaryExport : public SILModuleTransform {
+
+  void run() override {
+    auto *SEA = getAnalysis<SideEffectAnalysis>();
+    auto *EA = getAnalysis<EscapeAnalysis>();
+
+    for (SILFunction &F : *getModule()) {
+      // Only functions which are defined in this module and which can be
+      // called from outside the module need a summary.
+      if (!F.isDefinition() || F.isAvailableExternally() ||
+          !F.isPossiblyUsedExternally())
+        continue;
+
+      const auto &FE = SEA->getEffects(&F);
+      ArrayRef<SideEffectAnalysis::Effects> ParamEffects =
+          FE.getParameterEffects();
+      assert(ParamEffects.size() == F.getArguments().size() &&
+             "side-effects must be computed per argument");
+
+      SILFunctionSummary Summary(ParamEffects.size());
+      Summary.setGlobalEffects(getSummaryEffects(FE.getGlobalEffects()));
+      uint8_t Flags = 0;
+      if (FE.mayAllocObjects())
+        Flags |= SILFunctionSummary::AllocsObjects;
+      if (FE.mayTrap())
+        Flags |= SILFunctionSummary::Traps;
+      if (FE.mayReadRC())
+        Flags |= SILFunctionSummary::ReadsRC;
+      Summary.setFlags(Flags);
+
+      // Only the bodies of fragile functions end up in the module file.
+      if (F.isFragile())
+        Summary.setBodyCost(getBodyCost(F));
+
+      for (unsigned Idx = 0, End = ParamEffects.size(); Idx < End; ++Idx) {
+        auto &Arg = Summary.getArgument(Idx);
+        Arg.Effects = getSummaryEffects(ParamEffects[Idx]);
+        Arg.MayEscape = EA->canArgumentEscape(&F, Idx);
+      }
+
+      if (Summary.isWorstCase())
+        continue;
+
+      DEBUG(llvm::dbgs() << "  export summary of " << F.getName() << ": <"
+                         << FE << ">\n");
+      getModule()->setFunctionSummary(&F, std::move(Summary));
+      ++NumSummariesExported;
+    }
+  }
+
+  StringRef getName() override { return "Function Summary Export"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createFunctionSummaryExport() {
+  return new FunctionSummaryExport();
+}
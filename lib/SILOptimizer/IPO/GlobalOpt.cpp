@@ -669,6 +669,121 @@ replaceLoadsByKnownValue(BuiltinInst *CallToOnce, SILFunction *AddrF,
   SILG->setInitializer(InitF);
 }
 
+/// Returns the number of elements of the tuple or struct type \p Ty, or 0 if
+/// it is neither.
+static unsigned getNumAggregateElements(SILType Ty) {
+  if (auto TT = Ty.getAs<TupleType>())
+    return TT->getNumElements();
+  if (auto *SD = Ty.getStructOrBoundGenericStruct()) {
+    auto Fields = SD->getStoredProperties();
+    return std::distance(Fields.begin(), Fields.end());
+  }
+  return 0;
+}
+
+/// Collects the element addresses of \p Addr, by element number. Returns
+/// false unless \p Addr is only used by one projection for every element.
+static bool getElementAddrs(SILValue Addr,
+                            SmallVectorImpl<SILInstruction *> &Elements) {
+  unsigned NumElements = getNumAggregateElements(Addr->getType());
+  if (NumElements == 0)
+    return false;
+  Elements.assign(NumElements, nullptr);
+  for (auto *Use : Addr->getUses()) {
+    auto *User = Use->getUser();
+    unsigned FieldNo;
+    if (auto *TEAI = dyn_cast<TupleElementAddrInst>(User))
+      FieldNo = TEAI->getFieldNo();
+    else if (auto *SEAI = dyn_cast<StructElementAddrInst>(User))
+      FieldNo = SEAI->getFieldNo();
+    else
+      return false;
+    if (Elements[FieldNo])
+      return false;
+    Elements[FieldNo] = User;
+  }
+  return std::find(Elements.begin(), Elements.end(), nullptr) ==
+         Elements.end();
+}
+
+/// Returns true if every part of the memory at \p Addr is written by exactly
+/// one store, through element addresses, and nothing else uses \p Addr.
+static bool isStoredElementwise(SILValue Addr) {
+  if (Addr->hasOneUse()) {
+    auto *SI = dyn_cast<StoreInst>(Addr->use_begin()->getUser());
+    if (SI && SI->getDest() == Addr)
+      return true;
+  }
+  SmallVector<SILInstruction *, 8> Elements;
+  if (!getElementAddrs(Addr, Elements))
+    return false;
+  for (auto *Element : Elements)
+    if (!isStoredElementwise(Element))
+      return false;
+  return true;
+}
+
+/// Builds the value which the stores to the elements of \p Addr write, and
+/// erases those stores and the element addresses. \p Addr must satisfy
+/// isStoredElementwise.
+static SILValue combineElementStores(SILValue Addr, SILBuilder &B,
+                                     SILLocation Loc) {
+  if (Addr->hasOneUse()) {
+    if (auto *SI = dyn_cast<StoreInst>(Addr->use_begin()->getUser())) {
+      SILValue Src = SI->getSrc();
+      SI->eraseFromParent();
+      return Src;
+    }
+  }
+  SmallVector<SILInstruction *, 8> Elements;
+  getElementAddrs(Addr, Elements);
+  SmallVector<SILValue, 8> Values;
+  for (auto *Element : Elements) {
+    Values.push_back(combineElementStores(Element, B, Loc));
+    Element->eraseFromParent();
+  }
+  SILType Ty = Addr->getType().getObjectType();
+  if (Ty.is<TupleType>())
+    return B.createTuple(Loc, Ty, Values);
+  return B.createStruct(Loc, Ty, Values);
+}
+
+/// SILGen initializes a global of tuple type, and the passes before this
+/// one may leave a global of struct type initialized, one element at a
+/// time. If the initializer \p InitF stores every element of the global
+/// exactly once, replaces those stores by one store of the whole value,
+/// which is the form a static initializer needs.
+///
+/// Returns true if the initializer was changed.
+static bool combineGlobalElementStores(SILFunction *InitF) {
+  if (InitF->size() != 1)
+    return false;
+
+  // The stores are moved to the end of the initializer, so nothing else in
+  // it may have side effects.
+  GlobalAddrInst *GAI = nullptr;
+  for (auto &I : InitF->front()) {
+    if (auto *G = dyn_cast<GlobalAddrInst>(&I)) {
+      if (GAI)
+        return false;
+      GAI = G;
+    } else if (!isa<StoreInst>(&I) && !isa<AllocGlobalInst>(&I) &&
+               !isa<TermInst>(&I) && I.mayHaveSideEffects()) {
+      return false;
+    }
+  }
+  if (!GAI || GAI->use_empty() || isa<StoreInst>(GAI->use_begin()->getUser()))
+    return false;
+  if (!isStoredElementwise(GAI))
+    return false;
+
+  SILBuilderWithScope B(InitF->front().getTerminator());
+  SILLocation Loc = GAI->getLoc();
+  SILValue Value = combineElementStores(GAI, B, Loc);
+  B.createStore(Loc, Value, GAI);
+  return true;
+}
+
 /// We analyze the body of globalinit_func to see if it can be statically
 /// initialized. If yes, we set the initial value of the SILGlobalVariable and
 /// remove the "once" call to globalinit_func from the addressor.
@@ -688,6 +803,9 @@ void SILGlobalOpt::optimizeInitializer(SILFunction *AddrF,
       InitializerCount[InitF] > 1)
     return;
 
+  if (combineGlobalElementStores(InitF))
+    HasChanged = true;
+
   // If the globalinit_func is trivial, continue; otherwise bail.
   auto *SILG = SILGlobalVariable::getVariableOfStaticInitializer(InitF);
   if (!SILG || !SILG->isDefinition())
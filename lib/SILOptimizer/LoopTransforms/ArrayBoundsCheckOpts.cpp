@@ -707,21 +707,40 @@ static SILValue getSub(SILLocation Loc, SILValue Val, unsigned SubVal,
   return B.createTupleExtract(Loc, AI, 0);
 }
 
-/// A canonical induction variable incremented by one from Start to End-1.
+/// Add two builtin integer values.
+static SILValue getAdd(SILLocation Loc, SILValue Left, SILValue Right,
+                       SILBuilder &B) {
+  SmallVector<SILValue, 4> Args(1, Left);
+  Args.push_back(Right);
+  Args.push_back(B.createIntegerLiteral(
+      Loc, SILType::getBuiltinIntegerType(1, B.getASTContext()), -1));
+
+  auto *AI = B.createBuiltinBinaryFunctionWithOverflow(
+      Loc, "sadd_with_overflow", Args);
+  return B.createTupleExtract(Loc, AI, 0);
+}
+
+/// An induction variable incremented by a positive constant Step from Start
+/// while it is less than End.
+///
+/// Cmp is ICMP_EQ for a canonical induction variable incremented by one until
+/// it is equal to End, and ICMP_SGE for an induction variable, which may be
+/// strided, incremented until it is greater or equal to End.
 struct InductionInfo {
   SILArgument *HeaderVal;
   BuiltinInst *Inc;
   SILValue Start;
   SILValue End;
+  uint64_t Step;
   BuiltinValueKind Cmp;
   bool IsOverflowCheckInserted;
 
   InductionInfo()
-      : Cmp(BuiltinValueKind::None), IsOverflowCheckInserted(false) {}
+      : Step(1), Cmp(BuiltinValueKind::None), IsOverflowCheckInserted(false) {}
 
   InductionInfo(SILArgument *HV, BuiltinInst *I, SILValue S, SILValue E,
-                BuiltinValueKind C, bool IsOverflowChecked = false)
-      : HeaderVal(HV), Inc(I), Start(S), End(E), Cmp(C),
+                uint64_t St, BuiltinValueKind C, bool IsOverflowChecked = false)
+      : HeaderVal(HV), Inc(I), Start(S), End(E), Step(St), Cmp(C),
         IsOverflowCheckInserted(IsOverflowChecked) {}
 
   bool isValid() { return Start && End; }
@@ -733,8 +752,27 @@ struct InductionInfo {
     return Start;
   }
 
+  /// Returns the value of the induction variable in the last iteration.
+  ///
+  /// For a strided induction variable this is
+  ///   Start + ((End - 1 - Start) / Step) * Step
+  /// The loop is only entered if Start < End, so the computation can't
+  /// overflow if it is done with unsigned arithmetic.
   SILValue getLastValue(SILLocation &Loc, SILBuilder &B) {
-    return getSub(Loc, End, 1, B);
+    if (Step == 1)
+      return getSub(Loc, End, 1, B);
+
+    SILType Ty = Start->getType();
+    auto *One = B.createIntegerLiteral(Loc, Ty, 1);
+    auto *StepVal = B.createIntegerLiteral(Loc, Ty, Step);
+    auto *Last = B.createBuiltinBinaryFunction(Loc, "sub", Ty, Ty, {End, One});
+    auto *Dist = B.createBuiltinBinaryFunction(Loc, "sub", Ty, Ty,
+                                               {Last, Start});
+    auto *Iterations = B.createBuiltinBinaryFunction(Loc, "udiv", Ty, Ty,
+                                                     {Dist, StepVal});
+    auto *Offset = B.createBuiltinBinaryFunction(Loc, "mul", Ty, Ty,
+                                                 {Iterations, StepVal});
+    return B.createBuiltinBinaryFunction(Loc, "add", Ty, Ty, {Start, Offset});
   }
 
   /// If necessary insert an overflow for this induction variable.
@@ -764,8 +802,9 @@ struct InductionInfo {
 
 /// Analyse canonical induction variables in a loop to find their start and end
 /// values.
-/// At the moment we only handle very simple induction variables that increment
-/// by one and use equality comparison.
+/// At the moment we only handle induction variables that increment by one and
+/// use equality comparison, and induction variables that increment by a
+/// positive constant and exit once they reach the end.
 class InductionAnalysis {
   using InductionInfoMap = llvm::DenseMap<SILArgument *, InductionInfo *>;
 
@@ -823,8 +862,10 @@ private:
   /// Analyse one potential induction variable starting at Arg.
   InductionInfo *analyseIndVar(SILArgument *HeaderVal, BuiltinInst *Inc,
                                IntegerLiteralInst *IncVal) {
-    if (IncVal->getValue() != 1)
+    const APInt &IncValue = IncVal->getValue();
+    if (!IncValue.isStrictlyPositive() || IncValue.getActiveBits() > 63)
       return nullptr;
+    uint64_t Step = IncValue.getZExtValue();
 
     // Find the start value.
     auto *PreheaderTerm = dyn_cast<BranchInst>(Preheader->getTerminator());
@@ -837,33 +878,65 @@ private:
     if (!CondBr)
       return nullptr;
 
-    if (ExitBlk == CondBr->getFalseBB())
-      return nullptr;
-    assert(ExitBlk == CondBr->getTrueBB() &&
-           "The loop's exiting blocks terminator must exit");
-
     auto Cond = CondBr->getCondition();
     SILValue End;
+    BuiltinValueKind Cmp = BuiltinValueKind::None;
 
-    // Look for a compare of induction variable + 1.
+    // Look for a compare of the incremented induction variable.
     // TODO: obviously we need to handle many more patterns.
-    if (!match(Cond, m_ApplyInst(BuiltinValueKind::ICMP_EQ,
-                                 m_TupleExtractInst(m_Specific(Inc), 0),
-                                 m_SILValue(End))) &&
-        !match(Cond,
-               m_ApplyInst(BuiltinValueKind::ICMP_EQ, m_SILValue(End),
-                           m_TupleExtractInst(m_Specific(Inc), 0)))) {
+    if (ExitBlk == CondBr->getTrueBB()) {
+      if (match(Cond, m_ApplyInst(BuiltinValueKind::ICMP_EQ,
+                                  m_TupleExtractInst(m_Specific(Inc), 0),
+                                  m_SILValue(End))) ||
+          match(Cond,
+                m_ApplyInst(BuiltinValueKind::ICMP_EQ, m_SILValue(End),
+                            m_TupleExtractInst(m_Specific(Inc), 0)))) {
+        Cmp = BuiltinValueKind::ICMP_EQ;
+      } else if (match(Cond,
+                       m_ApplyInst(BuiltinValueKind::ICMP_SGE,
+                                   m_TupleExtractInst(m_Specific(Inc), 0),
+                                   m_SILValue(End)))) {
+        Cmp = BuiltinValueKind::ICMP_SGE;
+      }
+    } else {
+      assert(ExitBlk == CondBr->getFalseBB() &&
+             "The loop's exiting blocks terminator must exit");
+      // Staying in the loop while "i + Step < End" is the same as exiting if
+      // "i + Step >= End".
+      if (match(Cond, m_ApplyInst(BuiltinValueKind::ICMP_SLT,
+                                  m_TupleExtractInst(m_Specific(Inc), 0),
+                                  m_SILValue(End))))
+        Cmp = BuiltinValueKind::ICMP_SGE;
+    }
+    if (Cmp == BuiltinValueKind::None) {
       DEBUG(llvm::dbgs() << " found no exit condition\n");
       return nullptr;
     }
 
+    // With an equality comparison a strided induction variable might step
+    // over the end value.
+    if (Cmp == BuiltinValueKind::ICMP_EQ && Step != 1)
+      return nullptr;
+
     // Make sure our end value is loop invariant.
     if (!dominates(DT, End, Preheader))
       return nullptr;
 
-    DEBUG(llvm::dbgs() << " found an induction variable (ICMP_EQ): "
-                       << *HeaderVal << "  start: " << *Start
-                       << "  end: " << *End);
+    DEBUG(llvm::dbgs() << " found an induction variable ("
+                       << (Cmp == BuiltinValueKind::ICMP_EQ ? "ICMP_EQ"
+                                                            : "ICMP_SGE")
+                       << ", step " << Step << "): " << *HeaderVal
+                       << "  start: " << *Start << "  end: " << *End);
+
+    if (Cmp == BuiltinValueKind::ICMP_SGE) {
+      // The loop is only entered once if "Start >= End". And if the increment
+      // wraps around, the induction variable does not stay below End.
+      if (!isOverflowChecked(Inc) ||
+          !isRangeChecked(Start, End, Preheader, DT))
+        return nullptr;
+      return new (Allocator.Allocate())
+          InductionInfo(HeaderVal, Inc, Start, End, Step, Cmp);
+    }
 
     // Check whether the addition is overflow checked by a cond_fail or whether
     // code in the preheader's predecessor ensures that we won't overflow.
@@ -874,7 +947,7 @@ private:
         return nullptr;
     }
     return new (Allocator.Allocate()) InductionInfo(
-        HeaderVal, Inc, Start, End, BuiltinValueKind::ICMP_EQ, IsRangeChecked);
+        HeaderVal, Inc, Start, End, Step, Cmp, IsRangeChecked);
   }
 };
 
@@ -890,18 +963,22 @@ static bool isGuaranteedToBeExecuted(DominanceInfo *DT, SILBasicBlock *Block,
   return DT->dominates(Block, SingleExitingBlk);
 }
 
-/// Describes the access function "a[f(i)]" that is based on a canonical
-/// induction variable.
+/// Describes the access function "a[f(i)]" that is based on an induction
+/// variable. f(i) is either "i" or "i + Offset" with a loop invariant Offset.
 class AccessFunction {
   InductionInfo *Ind;
+  SILValue Offset;
 
-  AccessFunction(InductionInfo *I) { Ind = I; }
+  AccessFunction(InductionInfo *I, SILValue Off = SILValue())
+      : Ind(I), Offset(Off) {}
 public:
 
   operator bool() { return Ind != nullptr; }
 
   static AccessFunction getLinearFunction(SILValue Idx,
-                                          InductionAnalysis &IndVars) {
+                                          InductionAnalysis &IndVars,
+                                          DominanceInfo *DT,
+                                          SILBasicBlock *Preheader) {
     // Match the actual induction variable buried in the integer struct.
     // %2 = struct $Int(%1 : $Builtin.Word)
     //    = apply %check_bounds(%array, %2) : $@convention(thin) (Int, ArrayInt) -> ()
@@ -909,20 +986,38 @@ public:
     if (!ArrayIndexStruct)
       return nullptr;
 
-    auto AsArg =
-        dyn_cast<SILArgument>(ArrayIndexStruct->getElements()[0]);
-    if (!AsArg)
+    SILValue IdxVal = ArrayIndexStruct->getElements()[0];
+    if (auto *AsArg = dyn_cast<SILArgument>(IdxVal)) {
+      if (auto *Ind = IndVars[AsArg])
+        return AccessFunction(Ind);
       return nullptr;
+    }
 
-    if (auto *Ind = IndVars[AsArg])
-      return AccessFunction(Ind);
-
+    // Match an induction variable plus a loop invariant offset, e.g. the
+    // column of a row-major two dimensional index "i * n + j".
+    // %3 = builtin "sadd_with_overflow_Word"(%1 : $Builtin.Word, %off, ...)
+    // %4 = tuple_extract %3 : $(Builtin.Word, Builtin.Int1), 0
+    // %2 = struct $Int(%4 : $Builtin.Word)
+    SILValue Left, Right;
+    if (!match(IdxVal, m_TupleExtractInst(
+                           m_ApplyInst(BuiltinValueKind::SAddOver,
+                                       m_SILValue(Left), m_SILValue(Right)),
+                           0)))
+      return nullptr;
+    for (unsigned i = 0; i < 2; ++i, std::swap(Left, Right)) {
+      auto *AsArg = dyn_cast<SILArgument>(Left);
+      if (!AsArg || !dominates(DT, Right, Preheader))
+        continue;
+      if (auto *Ind = IndVars[AsArg])
+        return AccessFunction(Ind, Right);
+    }
     return nullptr;
   }
 
   /// Returns true if the loop iterates from 0 until count of \p Array.
   bool isZeroToCount(SILValue Array) {
-    return getZeroToCountArray(Ind->Start, Ind->End) == Array;
+    return !Offset && Ind->Step == 1 &&
+           getZeroToCountArray(Ind->Start, Ind->End) == Array;
   }
 
   /// Hoists the necessary check for beginning and end of the induction
@@ -935,7 +1030,9 @@ public:
     SILBuilderWithScope Builder(Preheader->getTerminator(), AI);
 
     // Get the first induction value.
-    auto FirstVal = Ind->getFirstValue();
+    SILValue FirstVal = Ind->getFirstValue();
+    if (Offset)
+      FirstVal = getAdd(Loc, FirstVal, Offset, Builder);
     // Clone the struct for the start index.
     auto Start = cast<SILInstruction>(CheckToHoist.getIndex())
                      ->clone(Preheader->getTerminator());
@@ -947,7 +1044,9 @@ public:
     NewCheck->setOperand(1, Start);
 
     // Get the last induction value.
-    auto LastVal = Ind->getLastValue(Loc, Builder);
+    SILValue LastVal = Ind->getLastValue(Loc, Builder);
+    if (Offset)
+      LastVal = getAdd(Loc, LastVal, Offset, Builder);
     // Clone the struct for the end index.
     auto End = cast<SILInstruction>(CheckToHoist.getIndex())
                    ->clone(Preheader->getTerminator());
@@ -964,6 +1063,68 @@ static bool hasArrayType(SILValue Value, SILModule &M) {
            M.getASTContext().getArrayDecl();
 }
 
+/// Returns true if the array index \p Idx is loop invariant or can be made
+/// loop invariant by hoisting its computation to the preheader.
+///
+/// Hoisting bounds checks out of an inner loop leaves the computation of the
+/// first and last index in the inner loop's preheader. This lets us hoist those
+/// checks further out of the enclosing loop. We only hoist arithmetic which
+/// cannot trap.
+static bool isHoistableIndex(SILValue Idx, SILBasicBlock *Preheader,
+                             DominanceInfo *DT, unsigned Depth = 0) {
+  if (dominates(DT, Idx, Preheader))
+    return true;
+  if (Depth > 8)
+    return false;
+
+  auto *I = dyn_cast<SILInstruction>(Idx);
+  if (!I)
+    return false;
+  switch (I->getKind()) {
+  case ValueKind::IntegerLiteralInst:
+  case ValueKind::StructInst:
+  case ValueKind::TupleExtractInst:
+    break;
+  case ValueKind::BuiltinInst:
+    switch (cast<BuiltinInst>(I)->getBuiltinInfo().ID) {
+    case BuiltinValueKind::Add:
+    case BuiltinValueKind::Sub:
+    case BuiltinValueKind::Mul:
+    case BuiltinValueKind::SAddOver:
+    case BuiltinValueKind::SSubOver:
+    case BuiltinValueKind::SMulOver:
+      break;
+    case BuiltinValueKind::UDiv:
+      // Only a constant non-zero divisor is safe to speculate.
+      if (auto *Divisor = dyn_cast<IntegerLiteralInst>(I->getOperand(1)))
+        if (Divisor->getValue() != 0)
+          break;
+      return false;
+    default:
+      return false;
+    }
+    break;
+  default:
+    return false;
+  }
+  for (auto &Op : I->getAllOperands())
+    if (!isHoistableIndex(Op.get(), Preheader, DT, Depth + 1))
+      return false;
+  return true;
+}
+
+/// Hoists the computation of an index for which isHoistableIndex returned
+/// true to the preheader.
+static void hoistIndex(SILValue Idx, SILBasicBlock *Preheader,
+                       DominanceInfo *DT) {
+  if (dominates(DT, Idx, Preheader))
+    return;
+  auto *I = cast<SILInstruction>(Idx);
+  for (auto &Op : I->getAllOperands())
+    hoistIndex(Op.get(), Preheader, DT);
+  I->moveBefore(Preheader->getTerminator());
+}
+
 /// Hoist bounds check in the loop to the loop preheader.
 static bool hoistChecksInLoop(DominanceInfo *DT, DominanceInfoNode *DTNode,
                               ABCAnalysis &ABC, InductionAnalysis &IndVars,
@@ -1011,18 +1172,20 @@ static bool hoistChecksInLoop(DominanceInfo *DT, DominanceInfoNode *DTNode,
       continue;
 
     // Invariant check.
-    if (blockAlwaysExecutes && dominates(DT, ArrayIndex, Preheader)) {
+    if (blockAlwaysExecutes && isHoistableIndex(ArrayIndex, Preheader, DT)) {
       assert(ArrayCall.canHoist(Preheader->getTerminator(), DT) &&
              "Must be able to hoist the instruction.");
       Changed = true;
+      hoistIndex(ArrayIndex, Preheader, DT);
       ArrayCall.hoist(Preheader->getTerminator(), DT);
       DEBUG(llvm::dbgs() << " could hoist invariant bounds check: " << *Inst);
       continue;
     }
 
     // Get the access function "a[f(i)]". At the moment this handles only the
-    // identity function.
-    auto F = AccessFunction::getLinearFunction(ArrayIndex, IndVars);
+    // identity function and the addition of a loop invariant offset.
+    auto F = AccessFunction::getLinearFunction(ArrayIndex, IndVars, DT,
+                                               Preheader);
     if (!F) {
       DEBUG(llvm::dbgs() << " not a linear function " << *Inst);
       continue;
@@ -1107,10 +1270,6 @@ static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
     return false;
   }
 
-  // Only handle innermost loops for now.
-  if (!Loop->getSubLoops().empty())
-    return false;
-
   DEBUG(llvm::dbgs() << "Attempting to remove redundant checks in " << *Loop);
   DEBUG(Header->getParent()->dump());
 
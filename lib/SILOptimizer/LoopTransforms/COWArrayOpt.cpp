@@ -409,6 +409,8 @@ protected:
   bool isArrayValueReleasedBeforeMutate(
       SILValue V, llvm::SmallSet<SILInstruction *, 16> &Releases);
   bool hoistInLoopWithOnlyNonArrayValueMutatingOperations();
+  bool checkSafeCOWContainerUses(SILValue Container, SILValue SelfAddr);
+  bool hoistCOWMakeUnique();
 };
 } // namespace
 
@@ -1505,6 +1507,127 @@ bool COWArrayOpt::hoistMakeMutable(ArraySemanticsCall MakeMutable) {
   return true;
 }
 
+/// Returns true if \p I calls a function with a semantics attribute starting
+/// with "cow." and passes \p SelfAddr as its @inout self argument only.
+///
+/// By annotating a mutating method with a "cow." semantics attribute a
+/// copy-on-write type promises that the method does not store a reference to
+/// the storage of self anywhere, i.e. that it cannot turn uniquely referenced
+/// storage into shared storage.
+static bool isCOWSemanticsCallOnSelf(SILInstruction *I, SILValue SelfAddr) {
+  auto *AI = dyn_cast<ApplyInst>(I);
+  if (!AI)
+    return false;
+  SILFunction *Callee = AI->getReferencedFunction();
+  if (!Callee || !Callee->hasSemanticsAttrThatStartsWith("cow."))
+    return false;
+  auto FnTy = Callee->getLoweredFunctionType();
+  if (!FnTy->hasSelfParam() ||
+      FnTy->getSelfParameter().getConvention() !=
+          ParameterConvention::Indirect_Inout ||
+      AI->getSelfArgument() != SelfAddr)
+    return false;
+  for (unsigned i = 0, e = AI->getNumArguments() - 1; i != e; ++i)
+    if (AI->getArgument(i) == SelfAddr)
+      return false;
+  return true;
+}
+
+/// Returns the call if \p I is a hoistable "cow.make_unique" call, i.e. a
+/// call of a mutating method without arguments whose result is unused.
+static ApplyInst *getCOWMakeUniqueCall(SILInstruction *I) {
+  auto *AI = dyn_cast<ApplyInst>(I);
+  if (!AI || AI->getNumArguments() != 1 || !AI->use_empty())
+    return nullptr;
+  SILFunction *Callee = AI->getReferencedFunction();
+  if (!Callee || !Callee->hasSemanticsAttr("cow.make_unique"))
+    return nullptr;
+  if (!isCOWSemanticsCallOnSelf(AI, AI->getSelfArgument()))
+    return nullptr;
+  return AI;
+}
+
+/// Check that the loop accesses \p Container only through "cow." semantics
+/// calls on \p SelfAddr, which is either the container itself or a
+/// projection of it outside the loop.
+///
+/// Outside the loop the container may be loaded, stored and passed as
+/// @inout argument, but its address must not escape into the loop.
+bool COWArrayOpt::checkSafeCOWContainerUses(SILValue Container,
+                                            SILValue SelfAddr) {
+  llvm::SmallVector<SILValue, 8> Worklist;
+  Worklist.push_back(Container);
+  while (!Worklist.empty()) {
+    SILValue Addr = Worklist.pop_back_val();
+    for (auto *UI : Addr->getUses()) {
+      SILInstruction *User = UI->getUser();
+      if (Loop->contains(User->getParent())) {
+        if (Addr == SelfAddr && isCOWSemanticsCallOnSelf(User, SelfAddr))
+          continue;
+        DEBUG(llvm::dbgs() << "    Skipping COW container: unsafe use in "
+                              "loop " << *User);
+        return false;
+      }
+      if (isa<StructElementAddrInst>(User) ||
+          isa<TupleElementAddrInst>(User)) {
+        Worklist.push_back(User);
+        continue;
+      }
+      if (isa<LoadInst>(User) || isa<StoreInst>(User) ||
+          isa<CopyAddrInst>(User) || isa<ApplyInst>(User) ||
+          isa<DestroyAddrInst>(User) || isa<DeallocStackInst>(User) ||
+          isa<DebugValueAddrInst>(User))
+        continue;
+      DEBUG(llvm::dbgs() << "    Skipping COW container: unknown use "
+                         << *User);
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Hoist "cow.make_unique" calls of copy-on-write types other than Array.
+///
+/// Types opt in by annotating a mutating method, which makes the storage of
+/// self unique, with @_semantics("cow.make_unique") and its other mutating
+/// methods with some "cow." semantics attribute (see
+/// isCOWSemanticsCallOnSelf). If the loop accesses a unique container only
+/// through such calls, the storage stays unique once it was made unique, so
+/// a single make_unique call in the preheader suffices.
+bool COWArrayOpt::hoistCOWMakeUnique() {
+  llvm::SmallMapVector<SILValue, llvm::SmallVector<ApplyInst *, 4>, 4>
+      MakeUniqueCalls;
+  for (auto *BB : Loop->getBlocks())
+    for (auto &Inst : *BB)
+      if (ApplyInst *AI = getCOWMakeUniqueCall(&Inst))
+        MakeUniqueCalls[AI->getSelfArgument()].push_back(AI);
+
+  bool Changed = false;
+  for (auto &Entry : MakeUniqueCalls) {
+    SILValue SelfAddr = Entry.first;
+    if (!DomTree->dominates(SelfAddr->getParentBB(), Preheader))
+      continue;
+
+    SILValue Container = SelfAddr;
+    while (auto *SEAI = dyn_cast<StructElementAddrInst>(Container))
+      Container = SEAI->getOperand();
+    if (!checkUniqueArrayContainer(Container) ||
+        !checkSafeCOWContainerUses(Container, SelfAddr))
+      continue;
+
+    auto &Calls = Entry.second;
+    DEBUG(llvm::dbgs() << "    Hoisting cow.make_unique: " << *Calls[0]);
+    Calls[0]->moveBefore(Preheader->getTerminator());
+    placeFuncRef(Calls[0], DomTree);
+    for (ApplyInst *AI : makeArrayRef(Calls).slice(1)) {
+      DEBUG(llvm::dbgs() << "    Removing cow.make_unique call: " << *AI);
+      AI->eraseFromParent();
+    }
+    Changed = true;
+  }
+  return Changed;
+}
+
 bool COWArrayOpt::run() {
   DEBUG(llvm::dbgs() << "  Array Opts in Loop " << *Loop);
 
@@ -1514,6 +1637,8 @@ bool COWArrayOpt::run() {
     return false;
   }
 
+  HasChanged |= hoistCOWMakeUnique();
+
   // Hoist make_mutable in two dimensional arrays if there are no array value
   // mutating operations in the loop.
   if (Loop->getSubLoops().empty() &&
@@ -18,6 +18,7 @@
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ArraySemantic.h"
+#include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
 #include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
@@ -378,6 +379,152 @@ static bool sinkFixLifetime(SILLoop *Loop, DominanceInfo *DomTree,
   return Changed;
 }
 
+/// Returns true if the retain \p Retain and the release \p Release are of the
+/// same kind.
+static bool isMatchingRetainRelease(SILInstruction *Retain,
+                                    SILInstruction *Release) {
+  return (isa<StrongRetainInst>(Retain) && isa<StrongReleaseInst>(Release)) ||
+         (isa<RetainValueInst>(Retain) && isa<ReleaseValueInst>(Release));
+}
+
+/// Returns true if \p First is executed before \p Second, given that the
+/// block of one of them dominates the block of the other.
+static bool comesBefore(SILInstruction *First, SILInstruction *Second,
+                        DominanceInfo *DT) {
+  SILBasicBlock *BB = First->getParent();
+  if (BB != Second->getParent())
+    return DT->dominates(BB, Second->getParent());
+  for (auto &Inst : *BB) {
+    if (&Inst == First)
+      return true;
+    if (&Inst == Second)
+      return false;
+  }
+  llvm_unreachable("instructions are not in their block");
+}
+
+/// Hoists a retain of a loop-invariant reference to the preheader and sinks
+/// the release which balances it in every iteration to the exit block.
+///
+/// This only increments the reference count during the loop, and the object
+/// is released at the same count after the loop. Uniqueness checks between
+/// the retain and the release see the same count as before, but other ones
+/// in the loop would see one more, so they prevent the transformation.
+static bool hoistAndSinkRetainReleasePairs(SILLoop *Loop, DominanceInfo *DT,
+                                           SILLoopInfo *LI,
+                                           RCIdentityFunctionInfo *RCFI,
+                                           SideEffectAnalysis *SEA) {
+  auto *Preheader = Loop->getLoopPreheader();
+  if (!Preheader)
+    return false;
+
+  // In an innermost loop which is exited at the latch, the blocks which
+  // dominate the latch are executed exactly once in every iteration.
+  if (!Loop->getSubLoops().empty())
+    return false;
+  auto *Latch = Loop->getLoopLatch();
+  if (!Latch || Loop->getExitingBlock() != Latch)
+    return false;
+  auto *ExitBB = Loop->getExitBlock();
+  if (!ExitBB)
+    return false;
+
+  // The single retain and release of each RC identity root in the loop.
+  llvm::SmallDenseMap<SILValue, SILInstruction *, 8> Retains;
+  llvm::SmallDenseMap<SILValue, SILInstruction *, 8> Releases;
+  llvm::SmallPtrSet<ValueBase *, 8> Unpairable;
+  SmallVector<SILValue, 8> Roots;
+
+  // The instructions which may observe reference counts.
+  llvm::SmallPtrSet<SILInstruction *, 8> RCObservers;
+
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      if (isa<IsUniqueInst>(&Inst) || isa<IsUniqueOrPinnedInst>(&Inst)) {
+        RCObservers.insert(&Inst);
+        continue;
+      }
+      if (auto *AI = dyn_cast<ApplyInst>(&Inst)) {
+        SideEffectAnalysis::FunctionEffects E;
+        SEA->getEffects(E, AI);
+        if (E.mayReadRC())
+          RCObservers.insert(AI);
+        continue;
+      }
+
+      auto *RCI = dyn_cast<RefCountingInst>(&Inst);
+      if (!RCI)
+        continue;
+      SILValue Root = RCFI->getRCIdentityRoot(RCI->getOperand(0));
+      llvm::SmallDenseMap<SILValue, SILInstruction *, 8> *Map = nullptr;
+      if (isa<StrongRetainInst>(RCI) || isa<RetainValueInst>(RCI))
+        Map = &Retains;
+      else if (isa<StrongReleaseInst>(RCI) || isa<ReleaseValueInst>(RCI))
+        Map = &Releases;
+
+      if (!Map || !Map->insert({Root, RCI}).second) {
+        Unpairable.insert(Root);
+        continue;
+      }
+      if (Map == &Retains)
+        Roots.push_back(Root);
+    }
+  }
+
+  bool Changed = false;
+  SILBasicBlock *OutsideBB = nullptr;
+  for (SILValue Root : Roots) {
+    if (Unpairable.count(Root) || !Releases.count(Root))
+      continue;
+    SILInstruction *Retain = Retains[Root];
+    SILInstruction *Release = Releases[Root];
+    if (!isMatchingRetainRelease(Retain, Release) ||
+        !hasLoopInvariantOperands(Retain, Loop) ||
+        !hasLoopInvariantOperands(Release, Loop))
+      continue;
+
+    // Both must be executed in every iteration, the retain first.
+    if (!DT->dominates(Retain->getParent(), Latch) ||
+        !DT->dominates(Release->getParent(), Latch) ||
+        !comesBefore(Retain, Release, DT))
+      continue;
+
+    // All reference count observers must be between the retain and the
+    // release.
+    if (!RCObservers.empty()) {
+      if (Retain->getParent() != Release->getParent())
+        continue;
+      unsigned NumObserversBetween = 0;
+      for (auto It = std::next(Retain->getIterator());
+           &*It != Release; ++It)
+        NumObserversBetween += RCObservers.count(&*It);
+      if (NumObserversBetween != RCObservers.size())
+        continue;
+    }
+
+    // The release is sunk to the exit edge, which must not be reached from
+    // outside the loop.
+    if (!OutsideBB) {
+      auto Succs = Latch->getSuccessors();
+      for (unsigned EdgeIdx = 0; EdgeIdx < Succs.size(); ++EdgeIdx) {
+        if (Succs[EdgeIdx] != ExitBB)
+          continue;
+        auto *SplitBB = splitCriticalEdge(Latch->getTerminator(), EdgeIdx,
+                                          DT, LI);
+        OutsideBB = SplitBB ? SplitBB : ExitBB;
+        break;
+      }
+    }
+
+    DEBUG(llvm::dbgs() << "  hoisting " << *Retain << "  and sinking "
+                       << *Release);
+    Retain->moveBefore(Preheader->getTerminator());
+    Release->moveBefore(&*OutsideBB->begin());
+    Changed = true;
+  }
+  return Changed;
+}
+
 namespace {
 /// \brief Summary of may writes occurring in the loop tree rooted at \p
 /// Loop. This includes all writes of the sub loops and the loop itself.
@@ -406,6 +553,7 @@ class LoopTreeOptimization {
   SILLoopInfo *LoopInfo;
   AliasAnalysis *AA;
   SideEffectAnalysis *SEA;
+  RCIdentityFunctionInfo *RCFI;
   DominanceInfo *DomTree;
   bool Changed;
 
@@ -416,9 +564,10 @@ class LoopTreeOptimization {
 public:
   LoopTreeOptimization(SILLoop *TopLevelLoop, SILLoopInfo *LI,
                        AliasAnalysis *AA, SideEffectAnalysis *SEA,
-                       DominanceInfo *DT,
+                       RCIdentityFunctionInfo *RCFI, DominanceInfo *DT,
                        bool RunsOnHighLevelSil)
-      : LoopInfo(LI), AA(AA), SEA(SEA), DomTree(DT), Changed(false),
+      : LoopInfo(LI), AA(AA), SEA(SEA), RCFI(RCFI), DomTree(DT),
+        Changed(false),
         RunsOnHighLevelSil(RunsOnHighLevelSil) {
     // Collect loops for a recursive bottom-up traversal in the loop tree.
     BotUpWorkList.push_back(TopLevelLoop);
@@ -529,6 +678,8 @@ void LoopTreeOptimization::optimizeLoop(SILLoop *CurrentLoop,
   Changed |= hoistInstructions(CurrentLoop, DomTree, SafeReads,
                                RunsOnHighLevelSil);
   Changed |= sinkFixLifetime(CurrentLoop, DomTree, LoopInfo);
+  Changed |= hoistAndSinkRetainReleasePairs(CurrentLoop, DomTree, LoopInfo,
+                                            RCFI, SEA);
 }
 
 namespace {
@@ -562,6 +713,8 @@ public:
     DominanceAnalysis *DA = PM->getAnalysis<DominanceAnalysis>();
     AliasAnalysis *AA = PM->getAnalysis<AliasAnalysis>();
     SideEffectAnalysis *SEA = PM->getAnalysis<SideEffectAnalysis>();
+    RCIdentityAnalysis *RCIA = PM->getAnalysis<RCIdentityAnalysis>();
+    RCIdentityFunctionInfo *RCFI = RCIA->get(F);
     DominanceInfo *DomTree = nullptr;
 
     DEBUG(llvm::dbgs() << "Processing loops in " << F->getName() << "\n");
@@ -569,7 +722,7 @@ public:
 
     for (auto *TopLevelLoop : *LoopInfo) {
       if (!DomTree) DomTree = DA->get(F);
-      LoopTreeOptimization Opt(TopLevelLoop, LoopInfo, AA, SEA, DomTree,
+      LoopTreeOptimization Opt(TopLevelLoop, LoopInfo, AA, SEA, RCFI, DomTree,
                                RunsOnHighLevelSil);
       Changed |= Opt.optimize();
     }
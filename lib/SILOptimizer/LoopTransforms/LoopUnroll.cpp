@@ -13,12 +13,16 @@
 #define DEBUG_TYPE "sil-loopunroll"
 
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/Support/CommandLine.h"
 
+#include "swift/SIL/InstructionUtils.h"
 #include "swift/SIL/PatternMatch.h"
 #include "swift/SIL/SILCloner.h"
+#include "swift/SILOptimizer/Analysis/ArraySemantic.h"
 #include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/CFG.h"
 #include "swift/SILOptimizer/Utils/SILInliner.h"
 #include "swift/SILOptimizer/Utils/SILSSAUpdater.h"
 
@@ -30,6 +34,12 @@ using llvm::MapVector;
 
 static const uint64_t SILLoopUnrollThreshold = 250;
 
+/// The largest number of copies of the body of a loop whose trip count is
+/// only known at runtime. 0 or 1 disables partial unrolling.
+static llvm::cl::opt<unsigned>
+SILLoopPartialUnrollFactor("sil-loop-partial-unroll-factor",
+                           llvm::cl::init(4));
+
 namespace {
 
 /// Clone the basic blocks in a loop.
@@ -101,42 +111,59 @@ void LoopCloner::cloneLoop() {
     }
 }
 
-/// Determine the number of iterations the loop is at most executed. The loop
-/// might contain early exits so this is the maximum if no early exits are
-/// taken.
-static Optional<uint64_t> getMaxLoopTripCount(SILLoop *Loop,
-                                              SILBasicBlock *Preheader,
-                                              SILBasicBlock *Header,
-                                              SILBasicBlock *Latch) {
-
+/// Match a loop which counts up by one from the value the preheader passes
+/// to \p RecArg, and exits at the latch once the next value equals \p End:
+///
+///   %next = tuple_extract (sadd_with_overflow %RecArg, 1), 0
+///   cond_br (cmp_eq %next, %End), exit, backedge(%next)
+static bool matchCountedLoop(SILLoop *Loop, SILBasicBlock *Header,
+                             SILBasicBlock *Latch, SILArgument *&RecArg,
+                             SILValue &End) {
   // Skip a split backedge.
   SILBasicBlock *OrigLatch = Latch;
   if (!Loop->isLoopExiting(Latch) && !(Latch = Latch->getSinglePredecessor()))
-    return None;
+    return false;
   if (!Loop->isLoopExiting(Latch))
-    return None;
+    return false;
 
   // Get the loop exit condition.
   auto *CondBr = dyn_cast<CondBranchInst>(Latch->getTerminator());
   if (!CondBr)
-    return None;
+    return false;
 
   // Match an add 1 recurrence.
-  SILArgument *RecArg;
-  IntegerLiteralInst *End;
   SILValue RecNext;
 
   if (!match(CondBr->getCondition(),
              m_BuiltinInst(BuiltinValueKind::ICMP_EQ, m_SILValue(RecNext),
-                           m_IntegerLiteralInst(End))))
-    return None;
+                           m_SILValue(End))))
+    return false;
   if (!match(RecNext,
              m_TupleExtractInst(m_ApplyInst(BuiltinValueKind::SAddOver,
                                             m_SILArgument(RecArg), m_One()),
                                 0)))
-    return None;
+    return false;
 
   if (RecArg->getParent() != Header)
+    return false;
+
+  return RecNext == RecArg->getIncomingValue(OrigLatch);
+}
+
+/// Determine the number of iterations the loop is at most executed. The loop
+/// might contain early exits so this is the maximum if no early exits are
+/// taken.
+static Optional<uint64_t> getMaxLoopTripCount(SILLoop *Loop,
+                                              SILBasicBlock *Preheader,
+                                              SILBasicBlock *Header,
+                                              SILBasicBlock *Latch) {
+  SILArgument *RecArg;
+  SILValue EndValue;
+  if (!matchCountedLoop(Loop, Header, Latch, RecArg, EndValue))
+    return None;
+
+  auto *End = dyn_cast<IntegerLiteralInst>(EndValue);
+  if (!End)
     return None;
 
   auto *Start = dyn_cast_or_null<IntegerLiteralInst>(
@@ -144,9 +171,6 @@ static Optional<uint64_t> getMaxLoopTripCount(SILLoop *Loop,
   if (!Start)
     return None;
 
-  if (RecNext != RecArg->getIncomingValue(OrigLatch))
-    return None;
-
   auto StartVal = Start->getValue();
   auto EndVal = End->getValue();
   if (StartVal.sgt(EndVal))
@@ -185,6 +209,78 @@ static bool canAndShouldUnrollLoop(SILLoop *Loop, uint64_t TripCount) {
   return true;
 }
 
+/// Returns true if the loop counts up to a loop-invariant bound, which may
+/// only be known at runtime.
+static bool hasRuntimeTripCount(SILLoop *Loop, SILBasicBlock *Header,
+                                SILBasicBlock *Latch) {
+  SILArgument *RecArg;
+  SILValue End;
+  if (!matchCountedLoop(Loop, Header, Latch, RecArg, End))
+    return false;
+  auto *EndBB = End->getParentBB();
+  return !EndBB || !Loop->contains(EndBB);
+}
+
+/// Returns the number of copies to make of the body of a loop with a runtime
+/// trip count, or 0 if the loop should not be partially unrolled.
+///
+/// Every copy keeps the exits of the loop, so the copies only pay off if
+/// later passes remove instructions at the boundaries between them. The cost
+/// model counts pairs of a retain and a release of the same loop-invariant
+/// value: ARC optimization matches the release at the end of one copy with
+/// the retain at the start of the next one, which saves two instructions
+/// for every copy after the first. Loops with bounds checks are left alone,
+/// because ABCOpts hoists the checks out of a loop with a simple induction
+/// variable, which unrolling would hide.
+static unsigned getPartialUnrollFactor(SILLoop *Loop) {
+  assert(Loop->getSubLoops().empty() && "Expect innermost loops");
+  if (SILLoopPartialUnrollFactor < 2)
+    return 0;
+
+  uint64_t Cost = 0;
+  llvm::SmallDenseMap<SILValue, std::pair<unsigned, unsigned>, 8>
+    InvariantRefCounts;
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      if (!Loop->canDuplicate(&Inst))
+        return 0;
+      if (ArraySemanticsCall(&Inst, "array.check_subscript"))
+        return 0;
+      if (instructionInlineCost(Inst) != InlineCost::Free)
+        ++Cost;
+      if (Cost > SILLoopUnrollThreshold)
+        return 0;
+
+      bool IsRetain = isa<StrongRetainInst>(&Inst) ||
+                      isa<RetainValueInst>(&Inst);
+      bool IsRelease = isa<StrongReleaseInst>(&Inst) ||
+                       isa<ReleaseValueInst>(&Inst);
+      if (!IsRetain && !IsRelease)
+        continue;
+      SILValue Ref = stripCasts(Inst.getOperand(0));
+      auto *RefBB = Ref->getParentBB();
+      if (RefBB && Loop->contains(RefBB))
+        continue;
+      auto &Counts = InvariantRefCounts[Ref];
+      if (IsRetain)
+        ++Counts.first;
+      else
+        ++Counts.second;
+    }
+  }
+
+  uint64_t Removable = 0;
+  for (auto &Entry : InvariantRefCounts)
+    Removable += 2 * std::min(Entry.second.first, Entry.second.second);
+  if (Removable == 0)
+    return 0;
+
+  for (unsigned Factor = SILLoopPartialUnrollFactor; Factor >= 2; --Factor)
+    if (Cost * Factor - Removable * (Factor - 1) <= SILLoopUnrollThreshold)
+      return Factor;
+  return 0;
+}
+
 /// Redirect the terminator of the current loop iteration's latch to the next
 /// iterations header or if this is the last iteration remove the backedge to
 /// the header.
@@ -324,50 +420,19 @@ updateSSA(SILLoop *Loop,
   }
 }
 
-/// Try to fully unroll the loop if we can determine the trip count and the trip
-/// count lis below a threshold.
-static bool tryToUnrollLoop(SILLoop *Loop) {
-  assert(Loop->getSubLoops().empty() && "Expecting innermost loops");
-
-  auto *Preheader = Loop->getLoopPreheader();
-  if (!Preheader)
-    return false;
-
-  auto *Latch = Loop->getLoopLatch();
-  if (!Latch)
-    return false;
-
+/// Clone the body of the loop \p Count - 1 times. Collects the headers and
+/// latches of the original loop and of the copies, in this order, and the
+/// values of every copy for the values which are used outside of the loop.
+static void cloneLoopBody(
+    SILLoop *Loop, uint64_t Count, SmallVectorImpl<SILBasicBlock *> &Headers,
+    SmallVectorImpl<SILBasicBlock *> &Latches,
+    DenseMap<SILValue, SmallVector<SILValue, 8>> &LoopLiveOutValues) {
   auto *Header = Loop->getHeader();
-
-  Optional<uint64_t> MaxTripCount =
-      getMaxLoopTripCount(Loop, Preheader, Header, Latch);
-  if (!MaxTripCount)
-    return false;
-
-  if (!canAndShouldUnrollLoop(Loop, MaxTripCount.getValue()))
-    return false;
-
-  // TODO: We need to split edges from non-condbr exits for the SSA updater. For
-  // now just don't handle loops containing such exits.
-  SmallVector<SILBasicBlock *, 16> ExitingBlocks;
-  Loop->getExitingBlocks(ExitingBlocks);
-  for (auto &Exit : ExitingBlocks)
-    if (!isa<CondBranchInst>(Exit->getTerminator()))
-      return false;
-
-  DEBUG(llvm::dbgs() << "Unrolling loop in " << Header->getParent()->getName()
-                     << " " << *Loop << "\n");
-
-  SmallVector<SILBasicBlock *, 16> Headers;
+  auto *Latch = Loop->getLoopLatch();
   Headers.push_back(Header);
-
-  SmallVector<SILBasicBlock *, 16> Latches;
   Latches.push_back(Latch);
 
-  DenseMap<SILValue, SmallVector<SILValue, 8>> LoopLiveOutValues;
-
-  // Copy the body MaxTripCount-1 times.
-  for (uint64_t Cnt = 1; Cnt < *MaxTripCount; ++Cnt) {
+  for (uint64_t Cnt = 1; Cnt < Count; ++Cnt) {
     // Clone the blocks in the loop.
     LoopCloner Cloner(Loop);
     Cloner.cloneLoop();
@@ -396,19 +461,78 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
       }
     }
   }
+}
+
+/// Try to fully unroll the loop if we can determine the trip count and the trip
+/// count lis below a threshold. Otherwise, if the loop counts up to a bound
+/// only known at runtime, try to replace its body by several copies of it,
+/// each of which keeps the exits of the loop.
+static bool tryToUnrollLoop(SILLoop *Loop) {
+  assert(Loop->getSubLoops().empty() && "Expecting innermost loops");
 
-  // Thread the loop clones by redirecting the loop latches to the successor
-  // iteration's header.
-  for (unsigned Iteration = 0, End = Latches.size(); Iteration != End;
-       ++Iteration) {
-    auto *CurrentLatch = Latches[Iteration];
-    auto LastIteration = End - 1;
-    auto *OriginalHeader = Headers[0];
-    auto *NextIterationsHeader =
-        Iteration == LastIteration ? nullptr : Headers[Iteration + 1];
-
-    redirectTerminator(CurrentLatch, Iteration, LastIteration, OriginalHeader,
-                       NextIterationsHeader);
+  auto *Preheader = Loop->getLoopPreheader();
+  if (!Preheader)
+    return false;
+
+  auto *Latch = Loop->getLoopLatch();
+  if (!Latch)
+    return false;
+
+  auto *Header = Loop->getHeader();
+
+  uint64_t Count = 0;
+  bool IsFullUnroll = false;
+  Optional<uint64_t> MaxTripCount =
+      getMaxLoopTripCount(Loop, Preheader, Header, Latch);
+  if (MaxTripCount && canAndShouldUnrollLoop(Loop, MaxTripCount.getValue())) {
+    Count = MaxTripCount.getValue();
+    IsFullUnroll = true;
+  } else if (hasRuntimeTripCount(Loop, Header, Latch)) {
+    Count = getPartialUnrollFactor(Loop);
+  }
+  if (Count == 0)
+    return false;
+
+  // TODO: We need to split edges from non-condbr exits for the SSA updater. For
+  // now just don't handle loops containing such exits.
+  SmallVector<SILBasicBlock *, 16> ExitingBlocks;
+  Loop->getExitingBlocks(ExitingBlocks);
+  for (auto &Exit : ExitingBlocks)
+    if (!isa<CondBranchInst>(Exit->getTerminator()))
+      return false;
+
+  DEBUG(llvm::dbgs() << (IsFullUnroll ? "Unrolling" : "Partially unrolling")
+                     << " loop in " << Header->getParent()->getName()
+                     << " " << *Loop << "\n");
+
+  SmallVector<SILBasicBlock *, 16> Headers;
+  SmallVector<SILBasicBlock *, 16> Latches;
+  DenseMap<SILValue, SmallVector<SILValue, 8>> LoopLiveOutValues;
+
+  // Copy the body Count-1 times.
+  cloneLoopBody(Loop, Count, Headers, Latches, LoopLiveOutValues);
+
+  if (IsFullUnroll) {
+    // Thread the loop clones by redirecting the loop latches to the successor
+    // iteration's header.
+    for (unsigned Iteration = 0, End = Latches.size(); Iteration != End;
+         ++Iteration) {
+      auto *CurrentLatch = Latches[Iteration];
+      auto LastIteration = End - 1;
+      auto *OriginalHeader = Headers[0];
+      auto *NextIterationsHeader =
+          Iteration == LastIteration ? nullptr : Headers[Iteration + 1];
+
+      redirectTerminator(CurrentLatch, Iteration, LastIteration,
+                         OriginalHeader, NextIterationsHeader);
+    }
+  } else {
+    // Chain the copies by redirecting the backedge of every copy to the
+    // header of the next one, and the backedge of the last copy to the
+    // original header.
+    for (unsigned Copy = 0, End = Latches.size(); Copy != End; ++Copy)
+      replaceBranchTarget(Latches[Copy]->getTerminator(), Headers[Copy],
+                          Headers[(Copy + 1) % End], /*PreserveArgs=*/true);
   }
 
   // Fixup SSA form for loop values used outside the loop.
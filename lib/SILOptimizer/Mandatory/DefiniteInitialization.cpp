@@ -29,6 +29,8 @@
 using namespace swift;
 
 STATISTIC(NumAssignRewritten, "Number of assigns rewritten");
+STATISTIC(NumTriviallyInitialized,
+          "Number of memory objects skipped as trivially initialized");
 
 template<typename ...ArgTypes>
 static void diagnose(SILModule &M, SILLocation loc, ArgTypes... args) {
@@ -2494,8 +2496,83 @@ bool LifetimeChecker::isInitializedAtUse(const DIMemoryUse &Use,
 //                           Top Level Driver
 //===----------------------------------------------------------------------===//
 
+/// Returns true if \p MUI is a local variable which is completely initialized
+/// before any other use, and whose remaining uses neither write to a part of
+/// it nor let it escape. Running the full analysis on such a variable would
+/// neither diagnose nor change anything: its assigns are reassignments, and
+/// lowerRawSILOperations lowers them as such.
+///
+/// This is by far the most common kind of memory object, e.g. for
+/// 'var x = y', so checking for it up front saves the use collection and the
+/// dataflow in most functions.
+static bool isTriviallyInitialized(MarkUninitializedInst *MUI) {
+  if (!MUI->isVar())
+    return false;
+
+  // A 'let' must be diagnosed if it is assigned again.
+  bool AllowAssign = false;
+  if (auto *Decl = MUI->getLoc().getAsASTNode<VarDecl>())
+    AllowAssign = !Decl->isLet();
+
+  // Find the first instruction which uses the variable. All other uses are
+  // dominated by the definition of MUI, and thus by this one.
+  SILInstruction *FirstUse = nullptr;
+  for (auto It = std::next(MUI->getIterator()), E = MUI->getParent()->end();
+       It != E; ++It) {
+    if (isa<DebugValueAddrInst>(*It))
+      continue;
+    for (auto &Op : It->getAllOperands()) {
+      if (Op.get() == MUI) {
+        FirstUse = &*It;
+        break;
+      }
+    }
+    if (FirstUse)
+      break;
+  }
+
+  if (auto *SI = dyn_cast_or_null<StoreInst>(FirstUse)) {
+    if (SI->getDest() != MUI || SI->getSrc() == MUI)
+      return false;
+  } else if (auto *CAI = dyn_cast_or_null<CopyAddrInst>(FirstUse)) {
+    if (CAI->getDest() != MUI || CAI->getSrc() == MUI ||
+        !CAI->isInitializationOfDest())
+      return false;
+  } else {
+    return false;
+  }
+
+  for (auto *Use : MUI->getUses()) {
+    SILInstruction *User = Use->getUser();
+    if (User == FirstUse)
+      continue;
+    if (isa<LoadInst>(User) || isa<DebugValueAddrInst>(User) ||
+        isa<DestroyAddrInst>(User))
+      continue;
+    if (auto *CAI = dyn_cast<CopyAddrInst>(User)) {
+      if (CAI->getSrc() == MUI && CAI->getDest() != MUI && !CAI->isTakeOfSrc())
+        continue;
+      return false;
+    }
+    if (auto *AI = dyn_cast<AssignInst>(User)) {
+      if (AllowAssign && AI->getDest() == MUI && AI->getSrc() != MUI)
+        continue;
+      return false;
+    }
+    return false;
+  }
+  return true;
+}
+
 static bool processMemoryObject(SILInstruction *I) {
   DEBUG(llvm::dbgs() << "*** Definite Init looking at: " << *I << "\n");
+
+  if (isTriviallyInitialized(cast<MarkUninitializedInst>(I))) {
+    DEBUG(llvm::dbgs() << "    trivially initialized, skipping\n");
+    ++NumTriviallyInitialized;
+    return false;
+  }
+
   DIMemoryObjectInfo MemInfo(I);
 
   // Set up the datastructure used to collect the uses of the allocation.
@@ -13,6 +13,7 @@
 #define DEBUG_TYPE "sil-passmanager"
 
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
@@ -27,10 +28,20 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/GraphWriter.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 using namespace swift;
 
 STATISTIC(NumOptzIterations, "Number of optimization iterations");
+STATISTIC(NumParallelPassRuns,
+          "Number of function pass runs executed in parallel");
+STATISTIC(NumSkippedPassRuns,
+          "Number of function pass runs skipped on unchanged functions");
+STATISTIC(NumSkippedVerifications,
+          "Number of functions not verified after a module pass which "
+          "didn't change them");
 
 llvm::cl::opt<bool> SILPrintAll(
     "sil-print-all", llvm::cl::init(false),
@@ -90,10 +101,20 @@ llvm::cl::list<std::string>
                      llvm::cl::desc("Disable passes "
                                     "which contain a string from this list"));
 
+llvm::cl::opt<unsigned> SILParallelFunctionPassesMinFunctions(
+    "sil-parallel-function-passes-min-functions", llvm::cl::init(4),
+    llvm::cl::desc("The minimum number of independent functions for which a "
+                   "function pass is run in parallel"));
+
 llvm::cl::opt<bool> SILVerifyWithoutInvalidation(
     "sil-verify-without-invalidation", llvm::cl::init(false),
     llvm::cl::desc("Verify after passes even if the pass has not invalidated"));
 
+llvm::cl::opt<unsigned> SILVerifyUnchangedSampleRate(
+    "sil-verify-unchanged-sample-rate", llvm::cl::init(0),
+    llvm::cl::desc("After a module pass, also verify one in this many of the "
+                   "functions which the pass did not change"));
+
 static bool doPrintBefore(SILTransform *T, SILFunction *F) {
   if (!SILPrintOnlyFun.empty() && F && F->getName() != SILPrintOnlyFun)
     return false;
@@ -181,6 +202,12 @@ bool SILPassManager::continueTransforming() {
          NumPassesRun < SILNumOptPassesToRun;
 }
 
+void SILPassManager::countSkippedPassRuns(unsigned Count) {
+  NumSkippedPassRuns += Count;
+  if (auto *Stats = Mod->getASTContext().Stats)
+    Stats->getFrontendCounters().NumSILFunctionPassRunsSkipped += Count;
+}
+
 bool SILPassManager::analysesUnlocked() {
   for (auto A : Analysis)
     if (A->isLocked())
@@ -205,14 +232,78 @@ static bool breakBeforeRunning(StringRef fnName, StringRef passName) {
   return fnName == SILBreakOnFun && passName == SILBreakOnPass;
 }
 
+/// Returns the number of instructions in \p F.
+static size_t countInstructions(SILFunction *F) {
+  size_t Count = 0;
+  for (auto &BB : *F)
+    Count += std::distance(BB.begin(), BB.end());
+  return Count;
+}
+
+/// Returns the number of instructions in all functions of \p M.
+static size_t countInstructions(SILModule *M) {
+  size_t Count = 0;
+  for (auto &F : *M)
+    Count += countInstructions(&F);
+  return Count;
+}
+
+namespace {
+/// Measures one run of a pass for -sil-pass-stats.
+class PassRunProfiler {
+  UnifiedStatsReporter *Stats = nullptr;
+  std::chrono::steady_clock::time_point StartTime;
+  size_t InstructionsBefore = 0;
+  size_t PeakInstructionBytesBefore = 0;
+
+public:
+  /// Starts measuring if \p Options ask for SIL pass statistics. \p F is the
+  /// function the pass runs on, or null for module passes.
+  PassRunProfiler(SILModule *M, const SILOptions &Options, SILFunction *F) {
+    if (!Options.PassStats)
+      return;
+    Stats = M->getASTContext().Stats;
+    if (!Stats)
+      return;
+    InstructionsBefore = F ? countInstructions(F) : countInstructions(M);
+    PeakInstructionBytesBefore = M->getPeakInstructionMemoryUsage();
+    StartTime = std::chrono::steady_clock::now();
+  }
+
+  /// Records the run of \p T in the statistics.
+  void finish(SILTransform *T, SILModule *M, const SILOptions &Options,
+              SILFunction *F, bool Invalidated) {
+    if (!Stats)
+      return;
+    std::chrono::duration<double> Elapsed =
+        std::chrono::steady_clock::now() - StartTime;
+    size_t InstructionsAfter = F ? countInstructions(F) : countInstructions(M);
+
+    UnifiedStatsReporter::SILPassProfile Run;
+    Run.Runs = 1;
+    Run.WallTime = Elapsed.count();
+    if (InstructionsAfter > InstructionsBefore)
+      Run.InstructionsAdded = InstructionsAfter - InstructionsBefore;
+    else
+      Run.InstructionsRemoved = InstructionsBefore - InstructionsAfter;
+    Run.Invalidations = Invalidated;
+    Run.PeakInstructionBytesGrowth =
+        M->getPeakInstructionMemoryUsage() - PeakInstructionBytesBefore;
+
+    StringRef Function;
+    if (F && Options.PassStatsPerFunction)
+      Function = F->getName();
+    Stats->recordSILPassRun(T->getName(), Function, Run);
+  }
+};
+} // end anonymous namespace
+
 void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
                                          SILFunction *F,
                                          bool runToCompletion) {
 
   const SILOptions &Options = getOptions();
 
-  CompletedPasses &completedPasses = CompletedPassesMap[F];
-
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
 
   for (auto SFT : FuncTransforms) {
@@ -222,11 +313,12 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
 
     // If nothing changed since the last run of this pass, we can skip this
     // pass.
-    if (completedPasses.test((size_t)SFT->getPassKind())) {
+    if (CompletedPassesMap[F].test((size_t)SFT->getPassKind())) {
       if (SILPrintPassName)
         llvm::dbgs() << "(Skip) Stage: " << StageName
                      << " Pass: " << SFT->getName()
                      << ", Function: " << F->getName() << "\n";
+      countSkippedPassRuns(1);
       continue;
     }
 
@@ -253,12 +345,18 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
     }
 
     llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
+    PassRunProfiler Profiler(Mod, Options, F);
     Mod->registerDeleteNotificationHandler(SFT);
     if (breakBeforeRunning(F->getName(), SFT->getName()))
       LLVM_BUILTIN_DEBUGTRAP;
-    SFT->run();
+    {
+      StatsTraceScope Trace(Mod->getASTContext().Stats, "sil-pass",
+                            SFT->getName(), F->getName());
+      SFT->run();
+    }
     assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
     Mod->removeDeleteNotificationHandler(SFT);
+    Profiler.finish(SFT, Mod, Options, F, CurrentPassHasInvalidated);
 
     // Did running the transform result in new functions being added
     // to the top of our worklist?
@@ -279,9 +377,11 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
       F->dump(Options.EmitVerboseSIL);
     }
 
-    // Remember if this pass didn't change anything.
-    if (!CurrentPassHasInvalidated)
-      completedPasses.set((size_t)SFT->getPassKind());
+    // Remember if this pass didn't change anything, or if running it again
+    // wouldn't change anything. Look up the mask again: the pass may have
+    // invalidated other functions, which can grow the map.
+    if (!CurrentPassHasInvalidated || SFT->isIdempotent())
+      CompletedPassesMap[F].set((size_t)SFT->getPassKind());
 
     if (Options.VerifyAll &&
         (CurrentPassHasInvalidated || SILVerifyWithoutInvalidation)) {
@@ -290,6 +390,8 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
     }
 
     ++NumPassesRun;
+    if (auto *Stats = Mod->getASTContext().Stats)
+      Stats->getFrontendCounters().NumSILFunctionPassRuns++;
 
     if (!continueTransforming())
       return;
@@ -308,10 +410,16 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
 void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
   BasicCalleeAnalysis *BCA = getAnalysis<BasicCalleeAnalysis>();
   BottomUpFunctionOrder BottomUpOrder(*Mod, BCA);
-  auto BottomUpFunctions = BottomUpOrder.getFunctions();
 
   assert(FunctionWorklist.empty() && "Expected empty function worklist!");
 
+  if (shouldRunFunctionPassesInParallel(FuncTransforms)) {
+    runFunctionPassesInParallel(FuncTransforms, BottomUpOrder);
+    return;
+  }
+
+  auto BottomUpFunctions = BottomUpOrder.getFunctions();
+
   FunctionWorklist.reserve(BottomUpFunctions.size());
   for (auto I = BottomUpFunctions.rbegin(), E = BottomUpFunctions.rend();
        I != E; ++I) {
@@ -323,6 +431,10 @@ void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
       FunctionWorklist.push_back(*I);
   }
 
+  processFunctionWorklist(FuncTransforms);
+}
+
+void SILPassManager::processFunctionWorklist(PassList FuncTransforms) {
   // Used to track how many times a given function has been
   // (partially) optimized by the function pass pipeline in this
   // invocation.
@@ -403,6 +515,214 @@ void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
   }
 }
 
+/// Create a new instance of the transform of kind \p Kind.
+static SILTransform *createTransform(PassKind Kind) {
+  SILTransform *T = nullptr;
+  switch (Kind) {
+#define PASS(ID, NAME, DESCRIPTION)                                            \
+  case PassKind::ID:                                                           \
+    T = swift::create##ID();                                                   \
+    break;
+#include "swift/SILOptimizer/PassManager/Passes.def"
+  case PassKind::invalidPassKind:
+    llvm_unreachable("invalid pass kind");
+  }
+  T->setPassKind(Kind);
+  return T;
+}
+
+bool SILPassManager::shouldRunFunctionPassesInParallel(
+    PassList FuncTransforms) {
+  const SILOptions &Options = getOptions();
+  if (!Options.ParallelFunctionPasses || Options.NumThreads < 2)
+    return false;
+
+  // The debugging options rely on passes being run one after another.
+  if (SILPrintAll || SILPrintPassName || SILPrintPassTime ||
+      SILNumOptPassesToRun != UINT_MAX || !SILBreakOnFun.empty() ||
+      !SILBreakOnPass.empty() || !SILPrintBefore.empty() ||
+      !SILPrintAfter.empty() || !SILPrintAround.empty())
+    return false;
+
+  // It is only worth to schedule the functions in groups if at least one of
+  // the passes can make use of it.
+  for (auto *SFT : FuncTransforms)
+    if (SFT->canRunInParallel())
+      return true;
+
+  return false;
+}
+
+void SILPassManager::runFunctionPassesInParallel(
+    PassList FuncTransforms, BottomUpFunctionOrder &BottomUpOrder) {
+  BasicCalleeAnalysis *BCA = getAnalysis<BasicCalleeAnalysis>();
+
+  // Partition the functions into groups. A function is put into the group
+  // after the latest group of any function it calls, so that all callees are
+  // completely optimized before a caller is looked at, as in the sequential
+  // bottom-up order. Functions in one SCC are independent for passes which
+  // only look at the function they are run on, so they share a group.
+  // Within a group the functions keep their bottom-up order, which makes the
+  // result independent of the thread scheduling.
+  llvm::DenseMap<SILFunction *, unsigned> GroupOfFunction;
+  SmallVector<SmallVector<SILFunction *, 16>, 8> Groups;
+  for (auto &SCC : BottomUpOrder.getSCCs()) {
+    unsigned Group = 0;
+    for (SILFunction *F : SCC) {
+      for (auto &BB : *F) {
+        for (auto &I : BB) {
+          auto FAS = FullApplySite::isa(&I);
+          if (!FAS)
+            continue;
+          for (SILFunction *Callee : BCA->getCalleeList(FAS)) {
+            auto Iter = GroupOfFunction.find(Callee);
+            if (Iter != GroupOfFunction.end())
+              Group = std::max(Group, Iter->second + 1);
+          }
+        }
+      }
+    }
+    for (SILFunction *F : SCC)
+      GroupOfFunction[F] = Group;
+
+    if (Groups.size() <= Group)
+      Groups.resize(Group + 1);
+    for (SILFunction *F : SCC) {
+      if (F->isDefinition() && F->shouldOptimize())
+        Groups[Group].push_back(F);
+    }
+  }
+
+  for (auto &Group : Groups) {
+    for (auto *SFT : FuncTransforms) {
+      if (SFT->canRunInParallel() &&
+          Group.size() >= SILParallelFunctionPassesMinFunctions) {
+        runPassOnFunctionsInParallel(SFT, Group);
+        continue;
+      }
+
+      for (SILFunction *F : Group) {
+        // The pass may add new functions (e.g. specializations) on top of F
+        // or ask for a restart of the pipeline on F. Keep F on the worklist
+        // below the new functions if either happens, so that they all are
+        // processed with the whole pipeline after this group is done.
+        unsigned Idx = FunctionWorklist.size();
+        FunctionWorklist.push_back(F);
+        runPassesOnFunction(SFT, F, /*runToCompletion*/ true);
+        bool AlreadyOnWorklist =
+            std::find(FunctionWorklist.begin(),
+                      FunctionWorklist.begin() + Idx,
+                      F) != FunctionWorklist.begin() + Idx;
+        if (!shouldRestartPipeline() || AlreadyOnWorklist)
+          FunctionWorklist.erase(FunctionWorklist.begin() + Idx);
+        clearRestartPipeline();
+      }
+    }
+
+    // Run the whole pipeline on all the functions which need it before we
+    // continue with the callers in the next group.
+    processFunctionWorklist(FuncTransforms);
+  }
+}
+
+void SILPassManager::runPassOnFunctionsInParallel(
+    SILFunctionTransform *SFT, ArrayRef<SILFunction *> Functions) {
+  const SILOptions &Options = getOptions();
+
+  if (isDisabled(SFT))
+    return;
+
+  // Make sure that no map is restructured while the threads access it.
+  for (SILFunction *F : Functions)
+    (void)CompletedPassesMap[F];
+  for (SILAnalysis *A : Analysis)
+    A->prepareForParallelAccess(Functions);
+
+  // Each thread works on its own instance of the pass, because the pass
+  // stores the function it is run on.
+  unsigned NumThreads = std::min((unsigned)Options.NumThreads,
+                                 (unsigned)Functions.size());
+  SmallVector<std::unique_ptr<SILFunctionTransform>, 8> Instances;
+  for (unsigned Idx = 0; Idx < NumThreads; ++Idx) {
+    auto *T = cast<SILFunctionTransform>(createTransform(SFT->getPassKind()));
+    assert(!T->needsNotifications() &&
+           "Passes running in parallel cannot handle delete notifications");
+    T->injectPassManager(this);
+    Instances.push_back(std::unique_ptr<SILFunctionTransform>(T));
+  }
+
+  // The index of the next function which is not yet processed.
+  std::atomic<unsigned> NextFunction(0);
+  std::atomic<unsigned> NumSkipped(0);
+  // Which functions were changed by the pass. Each thread only writes the
+  // entries of the functions it processes.
+  std::vector<char> Changed(Functions.size(), false);
+
+  auto ThreadEntryPoint = [&](SILFunctionTransform *T) {
+    for (unsigned Idx = NextFunction++; Idx < Functions.size();
+         Idx = NextFunction++) {
+      SILFunction *F = Functions[Idx];
+      CompletedPasses &completedPasses = CompletedPassesMap[F];
+
+      // If nothing changed since the last run of this pass, we can skip this
+      // pass.
+      if (completedPasses.test((size_t)T->getPassKind())) {
+        ++NumSkipped;
+        continue;
+      }
+
+      // Optimistically mark the pass as completed. If the pass changes the
+      // function, invalidateAnalysis() resets all bits of the function.
+      completedPasses.set((size_t)T->getPassKind());
+
+      T->injectFunction(F);
+      PassRunProfiler Profiler(Mod, Options, F);
+      {
+        StatsTraceScope Trace(Mod->getASTContext().Stats, "sil-pass",
+                              T->getName(), F->getName());
+        T->run();
+      }
+
+      Changed[Idx] = !completedPasses.test((size_t)T->getPassKind());
+      Profiler.finish(T, Mod, Options, F, Changed[Idx]);
+      if (T->isIdempotent())
+        completedPasses.set((size_t)T->getPassKind());
+    }
+  };
+
+  Mod->setMultiThreaded(true);
+  RunningInParallel = true;
+
+  std::vector<std::thread> Threads;
+  for (unsigned Idx = 1; Idx < NumThreads; ++Idx)
+    Threads.push_back(std::thread(ThreadEntryPoint, Instances[Idx].get()));
+
+  ThreadEntryPoint(Instances[0].get());
+
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  RunningInParallel = false;
+  Mod->setMultiThreaded(false);
+
+  unsigned NumRun = Functions.size() - NumSkipped;
+  NumPassesRun += NumRun;
+  NumParallelPassRuns += NumRun;
+  if (auto *Stats = Mod->getASTContext().Stats)
+    Stats->getFrontendCounters().NumSILFunctionPassRuns += NumRun;
+  countSkippedPassRuns(NumSkipped);
+
+  // Verify after all threads are done. The verifier is not thread-safe.
+  if (Options.VerifyAll) {
+    for (unsigned Idx = 0; Idx < Functions.size(); ++Idx) {
+      if (!Changed[Idx] && !SILVerifyWithoutInvalidation)
+        continue;
+      Functions[Idx]->verify();
+      verifyAnalyses(Functions[Idx]);
+    }
+  }
+}
+
 void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   if (isDisabled(SMT))
     return;
@@ -415,6 +735,8 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   SMT->injectModule(Mod);
 
   CurrentPassHasInvalidated = false;
+  CurrentPassHasInvalidatedModule = false;
+  InvalidatedFunctions.clear();
 
   if (SILPrintPassName)
     llvm::dbgs() << "#" << NumPassesRun << " Stage: " << StageName
@@ -428,11 +750,17 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   }
 
   llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
+  PassRunProfiler Profiler(Mod, Options, nullptr);
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
   Mod->registerDeleteNotificationHandler(SMT);
-  SMT->run();
+  {
+    StatsTraceScope Trace(Mod->getASTContext().Stats, "sil-pass",
+                          SMT->getName());
+    SMT->run();
+  }
   Mod->removeDeleteNotificationHandler(SMT);
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
+  Profiler.finish(SMT, Mod, Options, nullptr, CurrentPassHasInvalidated);
 
   if (SILPrintPassTime) {
     auto Delta = llvm::sys::TimeValue::now().nanoseconds() -
@@ -449,11 +777,43 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     printModule(Mod, Options.EmitVerboseSIL);
   }
 
-  if (Options.VerifyAll &&
-      (CurrentPassHasInvalidated || !SILVerifyWithoutInvalidation)) {
-    Mod->verify();
-    verifyAnalyses();
+  if (Options.VerifyAll) {
+    if (CurrentPassHasInvalidatedModule || SILVerifyWithoutInvalidation) {
+      Mod->verify();
+      verifyAnalyses();
+    } else if (CurrentPassHasInvalidated) {
+      verifyInvalidatedFunctions();
+    }
+  }
+}
+
+void SILPassManager::verifyInvalidatedFunctions() {
+  llvm::SmallPtrSet<const SILFunction *, 16> ToVerify;
+  unsigned NumSkipped = 0;
+  for (SILFunction &F : *Mod) {
+    if (InvalidatedFunctions.count(&F)) {
+      ToVerify.insert(&F);
+      continue;
+    }
+    // Check a few of the other functions as well, different ones after
+    // every pass, in case a pass changed a function without telling us.
+    if (SILVerifyUnchangedSampleRate &&
+        NumUnchangedFunctionsSeen++ % SILVerifyUnchangedSampleRate == 0) {
+      ToVerify.insert(&F);
+      continue;
+    }
+    ++NumSkipped;
   }
+
+  Mod->verify([&](const SILFunction &F) { return ToVerify.count(&F); });
+  for (SILFunction &F : *Mod)
+    if (ToVerify.count(&F))
+      verifyAnalyses(&F);
+
+  NumSkippedVerifications += NumSkipped;
+  if (auto *Stats = Mod->getASTContext().Stats)
+    Stats->getFrontendCounters().NumSILFunctionVerificationsSkipped +=
+      NumSkipped;
 }
 
 void SILPassManager::runOneIteration() {
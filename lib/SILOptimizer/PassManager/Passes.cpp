@@ -384,6 +384,10 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.addDCE();
   PM.addSimplifyCFG();
 
+  // Move rarely executed code out of the hot functions. This has only an
+  // effect if there is profile data.
+  PM.addColdBlockOutliner();
+
   // Try to hoist all releases, including epilogue releases. This should be
   // after FSO.
   PM.addLateReleaseHoisting();
@@ -391,7 +395,11 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.runOneIteration();
 
   PM.resetAndRemoveTransformations();
-  
+
+  // Summarize the final state of the public functions for the optimizer of
+  // client modules.
+  PM.addFunctionSummaryExport();
+
   // Has only an effect if the -gsil option is specified.
   PM.addSILDebugInfoGenerator();
 
@@ -21,6 +21,7 @@
 #define DEBUG_TYPE "sil-combine"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "SILCombiner.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SIL/SILVisitor.h"
 #include "swift/SIL/DebugUtils.h"
@@ -132,12 +133,14 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
     // skip them.
     if (I == 0)
       continue;
+    ++NumVisited;
 
     // Check to see if we can DCE the instruction.
     if (isInstructionTriviallyDead(I)) {
       DEBUG(llvm::dbgs() << "SC: DCE: " << *I << '\n');
       eraseInstFromFunction(*I);
       ++NumDeadInst;
+      ++NumChanged;
       MadeChange = true;
       continue;
     }
@@ -145,6 +148,7 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
     // Check to see if we can instsimplify the instruction.
     if (SILValue Result = simplifyInstruction(I)) {
       ++NumSimplified;
+      ++NumChanged;
 
       DEBUG(llvm::dbgs() << "SC: Simplify Old = " << *I << '\n'
                          << "    New = " << *Result << '\n');
@@ -172,6 +176,7 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
 
     if (SILInstruction *Result = visit(I)) {
       ++NumCombined;
+      ++NumChanged;
       // Should we replace the old instruction with a new one?
       if (Result != I) {
         assert(&*std::prev(SILBasicBlock::iterator(I)) == Result &&
@@ -246,6 +251,13 @@ bool SILCombiner::runOnFunction(SILFunction &F) {
     Iteration++;
   }
 
+  if (auto *Stats = F.getModule().getASTContext().Stats) {
+    auto &Counters = Stats->getFrontendCounters();
+    Counters.NumSILCombineIterations += Iteration + 1;
+    Counters.NumSILCombineInstructionsVisited += NumVisited;
+    Counters.NumSILCombineInstructionsChanged += NumChanged;
+  }
+
   // Cleanup the builder and return whether or not we made any changes.
   return Changed;
 }
@@ -349,6 +361,9 @@ class SILCombine : public SILFunctionTransform {
   
   virtual bool needsNotifications() override { return true; }
 
+  /// The combiner iterates until it doesn't find anything to combine.
+  bool isIdempotent() override { return true; }
+
   StringRef getName() override { return "SIL Combine"; }
 };
 
@@ -119,6 +119,11 @@ class SILCombiner :
   /// The current iteration of the SILCombine.
   unsigned Iteration;
 
+  /// The number of instructions taken from the worklist, and the number of
+  /// those which were erased, simplified or combined, in this run.
+  unsigned NumVisited = 0;
+  unsigned NumChanged = 0;
+
   /// Builder used to insert instructions.
   SILBuilder &Builder;
 
@@ -140,6 +145,8 @@ public:
 
   void clear() {
     Iteration = 0;
+    NumVisited = 0;
+    NumChanged = 0;
     Worklist.zap();
     MadeChange = false;
   }
@@ -262,6 +269,7 @@ private:
   SILInstruction *propagateConcreteTypeOfInitExistential(FullApplySite AI,
                                                          WitnessMethodInst *WMI);
   SILInstruction *propagateConcreteTypeOfInitExistential(FullApplySite AI);
+  SILInstruction *propagateConcreteTypeIntoGenericArgument(FullApplySite AI);
 
   /// Perform one SILCombine iteration.
   bool doOneIteration(SILFunction &F, unsigned Iteration);
@@ -934,6 +934,157 @@ SILCombiner::propagateConcreteTypeOfInitExistential(FullApplySite AI) {
   return propagateConcreteTypeOfInitExistential(AI, PD, PropagateIntoOperand);
 }
 
+/// Returns true if one of \p Conformances is a conformance to \p Protocol
+/// or to a protocol inheriting from it.
+static bool hasConformanceTo(ArrayRef<ProtocolConformanceRef> Conformances,
+                             ProtocolDecl *Protocol) {
+  for (auto Conformance : Conformances) {
+    auto *Requirement = Conformance.getRequirement();
+    if (Requirement == Protocol || Requirement->inheritsFrom(Protocol))
+      return true;
+  }
+  return false;
+}
+
+/// Replace the opened archetype of an existential, which is passed to a
+/// generic function, by the concrete type the existential was initialized
+/// with. For example:
+///
+///   %e = init_existential_addr %p : $*P, $C
+///   ...
+///   %o = open_existential_addr %p : $*P to $*@opened("...") P
+///   apply %f<@opened("...") P>(%o)
+///
+/// is rewritten to pass %o, cast to $*C, and to substitute C for the generic
+/// parameter. This lets the generic specializer specialize the callee for C,
+/// as if the existential had never been formed.
+SILInstruction *
+SILCombiner::propagateConcreteTypeIntoGenericArgument(FullApplySite AI) {
+  if (!AI.hasSubstitutions())
+    return nullptr;
+  auto *Callee = AI.getReferencedFunction();
+  if (!Callee)
+    return nullptr;
+  auto FnTy = AI.getCallee()->getType().getAs<SILFunctionType>();
+  if (!FnTy || !FnTy->isPolymorphic())
+    return nullptr;
+
+  // Find an argument of an opened archetype type whose existential was
+  // initialized with a known concrete type.
+  unsigned ArgIdx = 0;
+  CanType OpenedArchetype;
+  SILInstruction *InitExistential = nullptr;
+  auto Args = AI.getArguments();
+  for (unsigned Idx = AI.getNumIndirectResults(), End = Args.size();
+       Idx != End; ++Idx) {
+    SILValue Arg = Args[Idx];
+    if (!Arg->getType().getSwiftRValueType()->isOpenedExistential())
+      continue;
+    InitExistential = findInitExistential(AI, Arg, OpenedArchetype);
+    if (InitExistential &&
+        OpenedArchetype == Arg->getType().getSwiftRValueType()) {
+      ArgIdx = Idx;
+      break;
+    }
+    InitExistential = nullptr;
+  }
+  if (!InitExistential)
+    return nullptr;
+
+  // The opened archetype must not appear anywhere else in the apply, except
+  // as the replacement of generic parameters.
+  auto *Opened = cast<ArchetypeType>(OpenedArchetype);
+  if (AI.getType().getSwiftRValueType()->hasOpenedExistential(Opened))
+    return nullptr;
+  for (unsigned Idx = 0, End = Args.size(); Idx != End; ++Idx) {
+    CanType ArgTy = Args[Idx]->getType().getSwiftRValueType();
+    if (Idx != ArgIdx && ArgTy->hasOpenedExistential(Opened))
+      return nullptr;
+  }
+
+  ArrayRef<ProtocolConformanceRef> Conformances;
+  if (auto *IEA = dyn_cast<InitExistentialAddrInst>(InitExistential))
+    Conformances = IEA->getConformances();
+  else if (auto *IER = dyn_cast<InitExistentialRefInst>(InitExistential))
+    Conformances = IER->getConformances();
+  else
+    return nullptr;
+
+  // Form a new set of substitutions where the opened archetype is replaced
+  // by the concrete type, together with the concrete conformances.
+  ASTContext &Ctx = AI.getModule().getASTContext();
+  CanType ConcreteType;
+  SILValue NewArg;
+  SmallVector<Substitution, 8> Substitutions;
+  for (auto Subst : AI.getSubstitutions()) {
+    CanType Replacement = Subst.getReplacement()->getCanonicalType();
+    if (Replacement != OpenedArchetype) {
+      if (Replacement->hasOpenedExistential(Opened))
+        return nullptr;
+      Substitutions.push_back(Subst);
+      continue;
+    }
+    // A generic parameter without protocol requirements wouldn't benefit
+    // from specialization enough to be worth it.
+    auto OldConformances = Subst.getConformances();
+    if (OldConformances.empty())
+      return nullptr;
+    SmallVector<ProtocolConformanceRef, 4> NewConformances;
+    for (auto OldConformance : OldConformances) {
+      ProtocolDecl *Protocol = OldConformance.getRequirement();
+      if (!hasConformanceTo(Conformances, Protocol))
+        return nullptr;
+      SILValue NewSelf;
+      auto ConformanceAndConcreteType =
+        getConformanceAndConcreteType(AI, InitExistential, Protocol,
+                                      NewSelf, Conformances);
+      if (!ConformanceAndConcreteType)
+        return nullptr;
+      NewConformances.push_back(ConformanceAndConcreteType->first);
+      ConcreteType = ConformanceAndConcreteType->second;
+      NewArg = NewSelf;
+    }
+    Substitutions.push_back(Substitution(ConcreteType,
+                                         Ctx.AllocateCopy(NewConformances)));
+  }
+  if (!ConcreteType)
+    return nullptr;
+
+  CanSILFunctionType SFT =
+    FnTy->substGenericArgs(AI.getModule(), AI.getModule().getSwiftModule(),
+                           Substitutions);
+  SILType NewSubstCalleeType = SILType::getPrimitiveObjectType(SFT);
+  Builder.setCurrentDebugScope(AI.getDebugScope());
+
+  // An address argument is cast rather than replaced by the address of the
+  // init_existential_addr, because it may be a copy, which the callee
+  // consumes.
+  SILValue OldArg = Args[ArgIdx];
+  if (OldArg->getType().isAddress())
+    NewArg = Builder.createUncheckedAddrCast(AI.getLoc(), OldArg,
+                                             SFT->getSILArgumentType(ArgIdx));
+  SmallVector<SILValue, 8> NewArgs(Args.begin(), Args.end());
+  NewArgs[ArgIdx] = NewArg;
+
+  FullApplySite NewAI;
+  if (auto *TAI = dyn_cast<TryApplyInst>(AI))
+    NewAI = Builder.createTryApply(AI.getLoc(), AI.getCallee(),
+                                   NewSubstCalleeType,
+                                   Substitutions, NewArgs,
+                                   TAI->getNormalBB(), TAI->getErrorBB());
+  else
+    NewAI = Builder.createApply(AI.getLoc(), AI.getCallee(),
+                                NewSubstCalleeType,
+                                AI.getType(), Substitutions, NewArgs,
+                                cast<ApplyInst>(AI)->isNonThrowing());
+
+  if (isa<ApplyInst>(NewAI))
+    replaceInstUsesWith(*AI.getInstruction(), NewAI.getInstruction());
+  eraseInstFromFunction(*AI.getInstruction());
+
+  return NewAI.getInstruction();
+}
+
 /// \brief Check that all users of the apply are retain/release ignoring one
 /// user.
 static bool
@@ -1164,6 +1315,11 @@ SILInstruction *SILCombiner::visitApplyInst(ApplyInst *AI) {
     if (propagateConcreteTypeOfInitExistential(AI)) {
       return nullptr;
     }
+    // (apply (function_ref generic_function)) with an opened existential
+    // argument -> substitute the concrete type of the existential.
+    if (propagateConcreteTypeIntoGenericArgument(AI)) {
+      return nullptr;
+    }
   }
 
   // Optimize f_inverse(f(x)) -> x.
@@ -1295,6 +1451,11 @@ SILInstruction *SILCombiner::visitTryApplyInst(TryApplyInst *AI) {
     if (propagateConcreteTypeOfInitExistential(AI)) {
       return nullptr;
     }
+    // (apply (function_ref generic_function)) with an opened existential
+    // argument -> substitute the concrete type of the existential.
+    if (propagateConcreteTypeIntoGenericArgument(AI)) {
+      return nullptr;
+    }
   }
 
   return nullptr;
@@ -403,6 +403,28 @@ public:
   /// their lookup.
   ScopedHTType *AvailableValues;
 
+  /// The value of a read-only call, together with the memory generation in
+  /// which it was computed.
+  typedef std::pair<ValueBase *, unsigned> ReadOnlyCallValue;
+  typedef llvm::ScopedHashTableVal<SimpleValue, ReadOnlyCallValue>
+  ReadOnlyCallHTValue;
+  typedef llvm::RecyclingAllocator<llvm::BumpPtrAllocator, ReadOnlyCallHTValue>
+  ReadOnlyCallAllocatorTy;
+  typedef llvm::ScopedHashTable<SimpleValue, ReadOnlyCallValue,
+                                llvm::DenseMapInfo<SimpleValue>,
+                                ReadOnlyCallAllocatorTy> ReadOnlyCallHTType;
+
+  /// AvailableReadOnlyCalls - This scoped hash table contains the calls of
+  /// functions which read memory but have no other effects. A call can only
+  /// be reused in the same memory generation, i.e. if no instruction which may
+  /// write to memory is on the way from the available call.
+  ReadOnlyCallHTType *AvailableReadOnlyCalls;
+
+  /// The current memory generation. It is incremented after every instruction
+  /// which may write to memory, and at blocks with several predecessors, where
+  /// other paths may have written to memory.
+  unsigned CurrentGeneration = 0;
+
   SideEffectAnalysis *SEA;
 
   CSE(bool RunsOnHighLevelSil, SideEffectAnalysis *SEA)
@@ -412,6 +434,8 @@ public:
   
   bool canHandle(SILInstruction *Inst);
 
+  bool isReadOnlyCall(SILInstruction *Inst);
+
 private:
   
   /// True if CSE is done on high-level SIL, i.e. semantic calls are not inlined
@@ -423,13 +447,16 @@ private:
   // that the scope gets popped when the NodeScope is destroyed.
   class NodeScope {
    public:
-    NodeScope(ScopedHTType *availableValues) : Scope(*availableValues) {}
+    NodeScope(ScopedHTType *availableValues,
+              ReadOnlyCallHTType *availableReadOnlyCalls)
+        : Scope(*availableValues), ReadOnlyCallScope(*availableReadOnlyCalls) {}
 
    private:
     NodeScope(const NodeScope &) = delete;
     void operator=(const NodeScope &) = delete;
 
     ScopedHTType::ScopeTy Scope;
+    ReadOnlyCallHTType::ScopeTy ReadOnlyCallScope;
   };
 
   // StackNode - contains all the needed information to create a stack for doing
@@ -438,13 +465,20 @@ private:
   // children do not need to be store separately.
   class StackNode {
    public:
-    StackNode(ScopedHTType *availableValues, DominanceInfoNode *n,
-              DominanceInfoNode::iterator child,
+    StackNode(ScopedHTType *availableValues,
+              ReadOnlyCallHTType *availableReadOnlyCalls, unsigned generation,
+              DominanceInfoNode *n, DominanceInfoNode::iterator child,
               DominanceInfoNode::iterator end)
-        : Node(n), ChildIter(child), EndIter(end), Scopes(availableValues),
-      Processed(false) {}
+        : Generation(generation), ChildGeneration(generation), Node(n),
+          ChildIter(child), EndIter(end),
+          Scopes(availableValues, availableReadOnlyCalls), Processed(false) {}
 
     // Accessors.
+    unsigned generation() { return Generation; }
+    unsigned childGeneration() { return ChildGeneration; }
+    void setChildGeneration(unsigned generation) {
+      ChildGeneration = generation;
+    }
     DominanceInfoNode *node() { return Node; }
     DominanceInfoNode::iterator childIter() { return ChildIter; }
     DominanceInfoNode *nextChild() {
@@ -461,6 +495,8 @@ private:
     void operator=(const StackNode &) = delete;
 
     // Members.
+    unsigned Generation;
+    unsigned ChildGeneration;
     DominanceInfoNode *Node;
     DominanceInfoNode::iterator ChildIter;
     DominanceInfoNode::iterator EndIter;
@@ -482,12 +518,15 @@ bool CSE::processFunction(SILFunction &Fm, DominanceInfo *DT) {
   // Tables that the pass uses when walking the domtree.
   ScopedHTType AVTable;
   AvailableValues = &AVTable;
+  ReadOnlyCallHTType ROCTable;
+  AvailableReadOnlyCalls = &ROCTable;
 
   bool Changed = false;
 
   // Process the root node.
-  nodesToProcess.push_back(new StackNode(AvailableValues, DT->getRootNode(),
-                  DT->getRootNode()->begin(),
+  nodesToProcess.push_back(new StackNode(AvailableValues,
+                  AvailableReadOnlyCalls, CurrentGeneration,
+                  DT->getRootNode(), DT->getRootNode()->begin(),
                   DT->getRootNode()->end()));
 
   // Process the stack.
@@ -495,18 +534,22 @@ bool CSE::processFunction(SILFunction &Fm, DominanceInfo *DT) {
     // Grab the first item off the stack. Set the current generation, remove
     // the node from the stack, and process it.
     StackNode *NodeToProcess = nodesToProcess.back();
+    CurrentGeneration = NodeToProcess->generation();
 
     // Check if the node needs to be processed.
     if (!NodeToProcess->isProcessed()) {
       // Process the node.
       Changed |= processNode(NodeToProcess->node());
+      NodeToProcess->setChildGeneration(CurrentGeneration);
       NodeToProcess->process();
 
     } else if (NodeToProcess->childIter() != NodeToProcess->end()) {
       // Push the next child onto the stack.
       DominanceInfoNode *child = NodeToProcess->nextChild();
       nodesToProcess.push_back(
-          new StackNode(AvailableValues, child, child->begin(), child->end()));
+          new StackNode(AvailableValues, AvailableReadOnlyCalls,
+                        NodeToProcess->childGeneration(), child,
+                        child->begin(), child->end()));
     } else {
       // It has been processed, and there are no more children to process,
       // so delete it and pop it off the stack.
@@ -522,6 +565,11 @@ bool CSE::processNode(DominanceInfoNode *Node) {
   SILBasicBlock *BB = Node->getBlock();
   bool Changed = false;
 
+  // If the block has several predecessors, the other predecessors than the
+  // immediate dominator may have written to memory.
+  if (!BB->getSinglePredecessor())
+    ++CurrentGeneration;
+
   // See if any instructions in the block can be eliminated.  If so, do it.  If
   // not, add them to AvailableValues.
   for (SILBasicBlock::iterator I = BB->begin(), E = BB->end(); I != E;) {
@@ -551,6 +599,29 @@ bool CSE::processNode(DominanceInfoNode *Node) {
       continue;
     }
 
+    // Reuse a read-only call if memory didn't change since the available
+    // call.
+    if (isReadOnlyCall(Inst)) {
+      auto Available = AvailableReadOnlyCalls->lookup(Inst);
+      if (Available.first && Available.second == CurrentGeneration) {
+        DEBUG(llvm::dbgs() << "SILCSE CSE: " << *Inst << "  to: "
+                           << *Available.first << '\n');
+        Inst->replaceAllUsesWith(Available.first);
+        Inst->eraseFromParent();
+        Changed = true;
+        ++NumCSE;
+        continue;
+      }
+      AvailableReadOnlyCalls->insert(Inst, {Inst, CurrentGeneration});
+      continue;
+    }
+
+    // Retains don't change the contents of memory. Everything else which may
+    // write to memory, including releases, starts a new generation.
+    if (Inst->mayWriteToMemory() && !isa<StrongRetainInst>(Inst) &&
+        !isa<RetainValueInst>(Inst))
+      ++CurrentGeneration;
+
     // If this is not a simple instruction that we can value number, skip it.
     if (!canHandle(Inst))
       continue;
@@ -685,6 +756,27 @@ bool CSE::canHandle(SILInstruction *Inst) {
   }
 }
 
+/// Returns true if \p Inst is a call of a function which may read memory, but
+/// doesn't write memory, retain or release. Such calls can only be reused if
+/// memory didn't change in between.
+bool CSE::isReadOnlyCall(SILInstruction *Inst) {
+  auto *AI = dyn_cast<ApplyInst>(Inst);
+  if (!AI || !AI->mayReadOrWriteMemory())
+    return false;
+
+  // Semantic calls are optimized as a whole on high-level SIL, see canHandle.
+  if (RunsOnHighLevelSil) {
+    SILFunction *Callee = AI->getReferencedFunction();
+    if (Callee && Callee->hasSemanticsAttrs())
+      return false;
+  }
+
+  SideEffectAnalysis::FunctionEffects Effects;
+  SEA->getEffects(Effects, AI);
+  auto MB = Effects.getMemBehavior(RetainObserveKind::ObserveRetains);
+  return MB == SILInstruction::MemoryBehavior::MayRead;
+}
+
 using ApplyWitnessPair = std::pair<ApplyInst *, WitnessMethodInst *>;
 
 /// Returns the Apply and WitnessMethod instructions that use the
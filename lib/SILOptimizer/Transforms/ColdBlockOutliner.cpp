@@ -0,0 +1,320 @@
+//===--- ColdBlockOutliner.cpp - Move cold code into separate functions ---===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Uses the profile data from -profile-use to find code which is (almost) never
+// executed and moves it into separate functions. This keeps the hot code small
+// and dense.
+//
+// A cold region consists of a cold block and all the blocks it dominates. It
+// is only outlined if control leaves the region only by returning from the
+// function or by trapping. In the original function the region is replaced by
+// a call of the outlined function. Values which are defined outside the region
+// and used inside are passed as arguments.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "cold-block-outliner"
+#include "swift/SILOptimizer/Analysis/ColdBlockInfo.h"
+#include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/Local.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILCloner.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumColdRegionsOutlined, "Number of cold regions outlined");
+
+llvm::cl::opt<unsigned> ColdRegionMinSize(
+    "sil-cold-region-min-size", llvm::cl::init(16),
+    llvm::cl::desc("The minimum number of instructions in a cold region to be "
+                   "outlined"));
+
+namespace {
+
+/// A cold block and the blocks it dominates.
+struct ColdRegion {
+  SILBasicBlock *Entry;
+
+  /// All blocks of the region, in dominance order, starting with Entry.
+  llvm::SmallVector<SILBasicBlock *, 8> Blocks;
+
+  /// Values which are defined outside the region and used inside.
+  llvm::SmallSetVector<SILValue, 8> LiveIns;
+
+  /// The location of the return in the region, if there is one.
+  Optional<SILLocation> ReturnLoc;
+
+  ColdRegion(SILBasicBlock *Entry) : Entry(Entry) {}
+};
+
+/// Clones the blocks of a ColdRegion into the body of a new function.
+class ColdRegionCloner : public SILClonerWithScopes<ColdRegionCloner> {
+  using SuperTy = SILClonerWithScopes<ColdRegionCloner>;
+  friend class SILVisitor<ColdRegionCloner>;
+  friend class SILCloner<ColdRegionCloner>;
+
+public:
+  ColdRegionCloner(SILFunction *OutlinedF) : SuperTy(*OutlinedF) {}
+
+  void cloneRegion(ColdRegion &Region) {
+    SILFunction &OutlinedF = getBuilder().getFunction();
+    SILModule &M = OutlinedF.getModule();
+
+    // The arguments of the region entry and the live-in values become the
+    // arguments of the function.
+    auto *ClonedEntry = new (M) SILBasicBlock(&OutlinedF);
+    for (SILArgument *Arg : Region.Entry->getBBArgs()) {
+      auto *NewArg =
+          new (M) SILArgument(ClonedEntry, Arg->getType(), Arg->getDecl());
+      ValueMap.insert(std::make_pair(Arg, SILValue(NewArg)));
+    }
+    for (SILValue LiveIn : Region.LiveIns) {
+      auto *NewArg = new (M) SILArgument(ClonedEntry, LiveIn->getType());
+      ValueMap.insert(std::make_pair(LiveIn, SILValue(NewArg)));
+    }
+
+    BBMap.insert(std::make_pair(Region.Entry, ClonedEntry));
+    getBuilder().setInsertionPoint(ClonedEntry);
+    visitSILBasicBlock(Region.Entry);
+
+    // Now iterate over the BBs and fix up the terminators.
+    for (auto BI = BBMap.begin(), BE = BBMap.end(); BI != BE; ++BI) {
+      getBuilder().setInsertionPoint(BI->second);
+      visit(BI->first->getTerminator());
+      BI->second->setExecutionCount(BI->first->getExecutionCount());
+    }
+  }
+};
+
+class ColdBlockOutliner : public SILFunctionTransform {
+
+  /// Collects the region which is dominated by \p Region.Entry. Returns false
+  /// if the region cannot or should not be outlined.
+  bool collectRegion(ColdRegion &Region, DominanceInfo *DT) {
+    DominanceOrder DomOrder(Region.Entry, DT);
+    while (SILBasicBlock *BB = DomOrder.getNext()) {
+      Region.Blocks.push_back(BB);
+      DomOrder.pushChildren(BB);
+    }
+    llvm::SmallPtrSet<SILBasicBlock *, 16> InRegion(Region.Blocks.begin(),
+                                                    Region.Blocks.end());
+
+    // The entry of the region becomes the entry of the outlined function,
+    // which cannot have predecessors.
+    for (SILBasicBlock *Pred : Region.Entry->getPreds()) {
+      if (InRegion.count(Pred))
+        return false;
+    }
+
+    auto isDefinedInRegion = [&](SILValue V) -> bool {
+      if (auto *Arg = dyn_cast<SILArgument>(V))
+        return InRegion.count(Arg->getParent());
+      if (auto *I = dyn_cast<SILInstruction>(V))
+        return InRegion.count(I->getParent());
+      return false;
+    };
+
+    unsigned NumInsts = 0;
+    for (SILBasicBlock *BB : Region.Blocks) {
+      // All predecessors of inner blocks must be in the region, because the
+      // blocks are removed from the function. This is only violated by
+      // unreachable predecessors, which are not in the dominator tree.
+      if (BB != Region.Entry) {
+        for (SILBasicBlock *Pred : BB->getPreds()) {
+          if (!InRegion.count(Pred))
+            return false;
+        }
+      }
+      for (const SILSuccessor &Succ : BB->getSuccessors()) {
+        if (!InRegion.count(Succ.getBB()))
+          return false;
+      }
+      TermInst *Term = BB->getTerminator();
+      // The outlined function doesn't have an error result.
+      if (isa<ThrowInst>(Term))
+        return false;
+      if (isa<ReturnInst>(Term))
+        Region.ReturnLoc = Term->getLoc();
+
+      for (SILArgument *Arg : BB->getBBArgs()) {
+        if (Arg->getType().hasArchetype())
+          return false;
+      }
+      for (SILInstruction &I : *BB) {
+        // Stack allocations must be balanced within a function.
+        if (I.isAllocatingStack() || I.isDeallocatingStack())
+          return false;
+        // The outlined function is not generic. Opened archetypes are local
+        // to their function as well.
+        if (I.hasValue() && I.getType().hasArchetype())
+          return false;
+        for (const Operand &Op : I.getAllOperands()) {
+          SILValue V = Op.get();
+          if (V->getType().hasArchetype())
+            return false;
+          if (!isa<SILUndef>(V) && !isDefinedInRegion(V))
+            Region.LiveIns.insert(V);
+        }
+        if (!isa<DebugValueInst>(I) && !isa<DebugValueAddrInst>(I))
+          ++NumInsts;
+      }
+    }
+    // A small region is not worth the overhead of a call.
+    return NumInsts >= ColdRegionMinSize;
+  }
+
+  /// Creates a function which contains the blocks of \p Region.
+  SILFunction *createOutlinedFunction(ColdRegion &Region) {
+    SILFunction *F = getFunction();
+    SILModule &M = F->getModule();
+    CanSILFunctionType FTy = F->getLoweredFunctionType();
+
+    llvm::SmallVector<SILParameterInfo, 8> Params;
+    auto addParam = [&](SILValue V) {
+      SILType Ty = V->getType();
+      // Don't make any assumptions about the ownership of the live-in values.
+      // The region just continues to use them as the original function did.
+      Params.push_back(SILParameterInfo(
+          Ty.getSwiftRValueType(),
+          Ty.isAddress() ? ParameterConvention::Indirect_InoutAliasable
+                         : ParameterConvention::Direct_Unowned));
+    };
+    for (SILArgument *Arg : Region.Entry->getBBArgs())
+      addParam(Arg);
+    for (SILValue LiveIn : Region.LiveIns)
+      addParam(LiveIn);
+
+    // If the region returns, the outlined function returns the direct results
+    // of the original function. Indirect results are live-in addresses.
+    ArrayRef<SILResultInfo> Results;
+    if (Region.ReturnLoc)
+      Results = FTy->getDirectResults();
+
+    SILFunctionType::ExtInfo ExtInfo(SILFunctionTypeRepresentation::Thin,
+                                     /*isNoReturn*/ !Region.ReturnLoc,
+                                     /*isPseudogeneric*/ false);
+    CanSILFunctionType OutlinedTy = SILFunctionType::get(
+        /*genericSig*/ nullptr, ExtInfo, ParameterConvention::Direct_Unowned,
+        Params, Results, /*errorResult*/ None, M.getASTContext());
+
+    std::string Name;
+    for (unsigned Idx = 0; Name.empty() || M.lookUpFunction(Name); ++Idx)
+      Name = (F->getName() + "_cold" + llvm::Twine(Idx)).str();
+
+    // Fragile functions can only reference fragile, non-private functions.
+    IsFragile_t Fragile = F->isFragile();
+    SILFunction *OutlinedF = M.createFunction(
+        Fragile ? SILLinkage::Shared : SILLinkage::Private, Name, OutlinedTy,
+        /*contextGenericParams*/ nullptr, F->getLocation(), IsBare,
+        IsNotTransparent, Fragile, IsNotThunk,
+        SILFunction::NotRelevant, NoInline, EffectsKind::Unspecified,
+        /*InsertBefore*/ nullptr, F->getDebugScope(), F->getDeclContext());
+    OutlinedF->setDeclCtx(F->getDeclContext());
+    OutlinedF->setEntryCount(Region.Entry->getExecutionCount());
+
+    ColdRegionCloner Cloner(OutlinedF);
+    Cloner.cloneRegion(Region);
+    return OutlinedF;
+  }
+
+  /// Replaces the blocks of \p Region with a call of \p OutlinedF.
+  void replaceRegion(ColdRegion &Region, SILFunction *OutlinedF) {
+    SILBasicBlock *Entry = Region.Entry;
+    SILInstruction *FirstInst = &Entry->front();
+    SILBuilderWithScope Builder(FirstInst);
+    SILLocation Loc = FirstInst->getLoc();
+
+    llvm::SmallVector<SILValue, 8> Args(Entry->bbarg_begin(),
+                                        Entry->bbarg_end());
+    Args.append(Region.LiveIns.begin(), Region.LiveIns.end());
+
+    auto *FRI = Builder.createFunctionRef(Loc, OutlinedF);
+    auto *Call = Builder.createApply(Loc, FRI, Args, /*isNonThrowing*/ false);
+    if (Region.ReturnLoc)
+      Builder.createReturn(*Region.ReturnLoc, Call);
+    else
+      Builder.createUnreachable(ArtificialUnreachableLocation());
+
+    // Values which are defined in the region are only used in the region, so
+    // after dropping all references they are dead.
+    for (SILBasicBlock *BB : Region.Blocks) {
+      auto Begin = (BB == Entry ? FirstInst->getIterator() : BB->begin());
+      for (auto I = Begin, E = BB->end(); I != E; ++I)
+        I->dropAllReferences();
+    }
+    for (SILBasicBlock *BB : Region.Blocks) {
+      if (BB == Entry) {
+        while (&Entry->back() != FirstInst)
+          Entry->back().eraseFromParent();
+        FirstInst->eraseFromParent();
+        continue;
+      }
+      BB->eraseFromParent();
+    }
+  }
+
+  void run() override {
+    SILFunction *F = getFunction();
+
+    auto EntryCount = F->getEntryCount();
+    if (!EntryCount || *EntryCount == 0)
+      return;
+    if (!F->shouldOptimize() || F->isThunk() || F->isTransparent() ||
+        F->getInlineStrategy() == AlwaysInline ||
+        F->getLoweredFunctionType()->isPolymorphic())
+      return;
+
+    DominanceInfo *DT = PM->getAnalysis<DominanceAnalysis>()->get(F);
+
+    // Find the roots of the cold subtrees of the dominator tree.
+    llvm::SmallVector<ColdRegion, 4> Regions;
+    DominanceOrder DomOrder(&F->front(), DT, F->size());
+    while (SILBasicBlock *BB = DomOrder.getNext()) {
+      if (BB != &F->front() && ColdBlockInfo::isColdByProfile(BB)) {
+        ColdRegion Region(BB);
+        if (collectRegion(Region, DT)) {
+          Regions.push_back(std::move(Region));
+          continue;
+        }
+      }
+      DomOrder.pushChildren(BB);
+    }
+    if (Regions.empty())
+      return;
+
+    for (ColdRegion &Region : Regions) {
+      SILFunction *OutlinedF = createOutlinedFunction(Region);
+      DEBUG(llvm::dbgs() << "  outline cold region of " << Region.Blocks.size()
+                         << " blocks of " << F->getName() << " into "
+                         << OutlinedF->getName() << '\n');
+      replaceRegion(Region, OutlinedF);
+      notifyPassManagerOfFunction(OutlinedF);
+      ++NumColdRegionsOutlined;
+    }
+    invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
+  }
+
+  StringRef getName() override { return "Cold Block Outliner"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createColdBlockOutliner() {
+  return new ColdBlockOutliner();
+}
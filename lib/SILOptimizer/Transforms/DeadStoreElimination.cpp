@@ -158,16 +158,20 @@ namespace {
 /// If this function has too many basic blocks or too many locations, it may
 /// take a long time to compute the genset and killset. The number of memory
 /// behavior or alias query we need to do in worst case is roughly linear to
-/// # of BBs x(times) # of locations.
+/// # of BBs which access memory x(times) # of locations.
 ///
-/// we could run DSE on functions with 256 basic blocks and 256 locations,
-/// which is a large function.  
+/// we could run DSE on functions with 256 basic blocks accessing memory and 256
+/// locations, which is a large function.
 constexpr unsigned MaxLSLocationBBMultiplicationNone = 256*256;
 
 /// we could run optimistic DSE on functions with less than 64 basic blocks
-/// and 64 locations which is a sizeable function.
+/// accessing memory and 64 locations which is a sizeable function.
 constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 64*64;
 
+/// Every basic block has bit vectors as wide as the number of locations,
+/// whether it accesses memory or not. Keep them to a few megabytes.
+constexpr unsigned MaxLSLocationBBMultiplicationBitVectors = 2048*2048;
+
 /// forward declaration.
 class DSEContext;
 /// BlockState summarizes how LSLocations are used in a basic block.
@@ -523,6 +527,7 @@ DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount)
 
   bool RunOneIteration = true;
   unsigned BBCount = 0;
+  unsigned MemoryBBCount = 0;
   unsigned LocationCount = LocationVault.size();
 
   // If all basic blocks will have their successors processed if
@@ -533,6 +538,8 @@ DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount)
   llvm::DenseSet<SILBasicBlock *> HandledBBs;
   for (SILBasicBlock *B : PO->getPostOrder()) {
     ++BBCount;
+    if (mayAccessMemory(B))
+      ++MemoryBBCount;
     for (auto &X : B->getSuccessors()) {
       if (HandledBBs.find(X) == HandledBBs.end()) {
         RunOneIteration = false;
@@ -542,8 +549,10 @@ DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount)
     HandledBBs.insert(B);
   }
 
-  // Data flow may take too long to run.
-  if (BBCount * LocationCount > MaxLSLocationBBMultiplicationNone)
+  // Data flow may take too long to run, or its bit vectors may take too much
+  // memory.
+  if (MemoryBBCount * LocationCount > MaxLSLocationBBMultiplicationNone ||
+      BBCount * LocationCount > MaxLSLocationBBMultiplicationBitVectors)
     return ProcessKind::ProcessNone;
 
   // This function's data flow would converge in 1 iteration.
@@ -552,7 +561,7 @@ DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount)
   
   // We run one pessimistic data flow to do dead store elimination on
   // the function.
-  if (BBCount * LocationCount > MaxLSLocationBBMultiplicationPessimistic)
+  if (MemoryBBCount * LocationCount > MaxLSLocationBBMultiplicationPessimistic)
     return ProcessKind::ProcessPessimistic;
 
   return ProcessKind::ProcessOptimistic;
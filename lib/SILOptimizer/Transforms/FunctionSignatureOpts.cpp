@@ -32,6 +32,7 @@
 #define DEBUG_TYPE "sil-function-signature-opt"
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
+#include "swift/SILOptimizer/Analysis/ARCSummaryAnalysis.h"
 #include "swift/SILOptimizer/Analysis/CallerAnalysis.h"
 #include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
@@ -106,6 +107,9 @@ class FunctionSignatureTransform {
   /// The RC identity analysis we are using.
   RCIdentityAnalysis *RCIA;
 
+  /// The ARC summary analysis we are using.
+  ARCSummaryAnalysis *ASA;
+
   // The function signature mangler we are using.
   FunctionSignatureSpecializationMangler &FM;
 
@@ -235,11 +239,12 @@ public:
   /// Constructor.
   FunctionSignatureTransform(SILFunction *F, bool hasCaller, SILPassManager *PM,
                              AliasAnalysis *AA, RCIdentityAnalysis *RCIA,
+                             ARCSummaryAnalysis *ASA,
                              FunctionSignatureSpecializationMangler &FM,
                              ArgumentIndexMap &AIM,
                              llvm::SmallVector<ArgumentDescriptor, 4> &ADL,
                              llvm::SmallVector<ResultDescriptor, 4> &RDL)
-    : F(F), NewF(nullptr), PM(PM), AA(AA), RCIA(RCIA), FM(FM),
+    : F(F), NewF(nullptr), PM(PM), AA(AA), RCIA(RCIA), ASA(ASA), FM(FM),
       AIM(AIM), shouldModifySelfArgument(false), ArgumentDescList(ADL),
       ResultDescList(RDL), MayDynamicBindSelf(computeMayBindDynamicSelf(F)),
       hasCaller(hasCaller) {}
@@ -595,6 +600,15 @@ bool FunctionSignatureTransform::OwnedToGuaranteedAnalyzeParameters() {
           A.OwnedToGuaranteed = true;
           SignatureOptimize = true;
         }
+      } else if (!ArgToThrowReleaseMap.hasBlock()) {
+        // The parameter is not released here, but forwarded to a callee which
+        // consumes it. Retain it for the callee instead. Once the callee is
+        // @guaranteed as well, ARC can pair that retain with a release.
+        if (ApplyInst *Call = ASA->findConsumingCall(A.Arg)) {
+          A.ConsumingCall = Call;
+          A.OwnedToGuaranteed = true;
+          SignatureOptimize = true;
+        }
       }
     }
 
@@ -642,6 +656,11 @@ void FunctionSignatureTransform::OwnedToGuaranteedTransformFunctionParameters()
     for (auto &X : AD.CalleeReleaseInThrowBlock) { 
       X->eraseFromParent();
     }
+    if (AD.ConsumingCall) {
+      SILBuilderWithScope Builder(AD.ConsumingCall);
+      Builder.createRetainValue(AD.ConsumingCall->getLoc(), AD.Arg,
+                                Atomicity::Atomic);
+    }
   }
 }
 
@@ -843,6 +862,7 @@ public:
 
     auto *AA = PM->getAnalysis<AliasAnalysis>();
     auto *RCIA = getAnalysis<RCIdentityAnalysis>();
+    auto *ASA = PM->getAnalysis<ARCSummaryAnalysis>();
 
     // As we optimize the function more and more, the name of the function is
     // going to change, make sure the mangler is aware of all the changes done
@@ -871,7 +891,7 @@ public:
     }
 
     // Owned to guaranteed optimization.
-    FunctionSignatureTransform FST(F, hasCaller, PM, AA, RCIA, FM, AIM,
+    FunctionSignatureTransform FST(F, hasCaller, PM, AA, RCIA, ASA, FM, AIM,
                                    ArgumentDescList, ResultDescList);
     if (FST.run()) {
       ++ NumFunctionSignaturesOptimized;
@@ -984,6 +984,10 @@ class SILPerformanceInliner {
 
   ColdBlockInfo CBI;
 
+  /// Call sites whose profiled execution count is at least this high are hot.
+  /// Zero if there is no profile data.
+  uint64_t HotCallSiteCount;
+
   /// The following constants define the cost model for inlining. Some constants
   /// are also defined in ShortestPathAnalysis.
   enum {
@@ -1014,6 +1018,9 @@ class SILPerformanceInliner {
     /// The benefit of a onFastPath builtin.
     FastPathBuiltinBenefit = RemovedCallBenefit + 40,
 
+    /// The additional benefit if the profile shows that the call site is hot.
+    HotCallSiteBenefit = RemovedCallBenefit + 80,
+
     /// Approximately up to this cost level a function can be inlined without
     /// increasing the code size.
     TrivialFunctionThreshold = 18,
@@ -1060,8 +1067,9 @@ class SILPerformanceInliner {
 
 public:
   SILPerformanceInliner(InlineSelection WhatToInline, DominanceAnalysis *DA,
-                        SILLoopAnalysis *LA)
-      : WhatToInline(WhatToInline), DA(DA), LA(LA), CBI(DA) {}
+                        SILLoopAnalysis *LA, uint64_t HotCallSiteCount)
+      : WhatToInline(WhatToInline), DA(DA), LA(LA), CBI(DA),
+        HotCallSiteCount(HotCallSiteCount) {}
 
   bool inlineCallsIntoFunction(SILFunction *F);
 };
@@ -1261,6 +1269,13 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
     return true;
   }
 
+  // Be more aggressive at call sites which are known to be executed often.
+  auto CallSiteCount = AI.getParent()->getExecutionCount();
+  bool IsHot = HotCallSiteCount != 0 && CallSiteCount &&
+               *CallSiteCount >= HotCallSiteCount;
+  if (IsHot)
+    Benefit += HotCallSiteBenefit;
+
   // We reduce the benefit if the caller is too large. For this we use a
   // cubic function on the number of caller blocks. This starts to prevent
   // inlining at about 800 - 1000 caller blocks.
@@ -1281,7 +1296,8 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
     llvm::dbgs() << "    decision {c=" << CalleeCost << ", b=" << Benefit <<
         ", l=" << SPA->getScopeLength(CalleeEntry, 0) <<
         ", c-w=" << CallerWeight << ", bb=" << Callee->size() <<
-        ", c-bb=" << NumCallerBlocks << "} " << Callee->getName() << '\n';
+        ", c-bb=" << NumCallerBlocks << (IsHot ? ", hot" : "") << "} " <<
+        Callee->getName() << '\n';
   );
   return true;
 }
@@ -1522,6 +1538,15 @@ class SILPerformanceInlinerPass : public SILFunctionTransform {
   InlineSelection WhatToInline;
   std::string PassName;
 
+  /// See SILPerformanceInliner::HotCallSiteCount. Computed on the first run.
+  Optional<uint64_t> HotCallSiteCount;
+
+  uint64_t getHotCallSiteCount() {
+    if (!HotCallSiteCount)
+      HotCallSiteCount = ColdBlockInfo::getHotCount(getFunction()->getModule());
+    return *HotCallSiteCount;
+  }
+
 public:
   SILPerformanceInlinerPass(InlineSelection WhatToInline, StringRef LevelName):
     WhatToInline(WhatToInline), PassName(LevelName) {
@@ -1536,7 +1561,8 @@ public:
       return;
     }
 
-    SILPerformanceInliner Inliner(WhatToInline, DA, LA);
+    SILPerformanceInliner Inliner(WhatToInline, DA, LA,
+                                  getHotCallSiteCount());
 
     assert(getFunction()->isDefinition() &&
            "Expected only functions with bodies!");
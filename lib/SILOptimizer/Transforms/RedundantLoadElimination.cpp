@@ -172,16 +172,20 @@ namespace {
 /// If this function has too many basic blocks or too many locations, it may
 /// take a long time to compute the genset and killset. The number of memory
 /// behavior or alias query we need to do in worst case is roughly linear to
-/// # of BBs x(times) # of locations.
+/// # of BBs which access memory x(times) # of locations.
 ///
-/// we could run RLE on functions with 128 basic blocks and 128 locations,
-/// which is a large function.  
+/// we could run RLE on functions with 128 basic blocks accessing memory and 128
+/// locations, which is a large function.
 constexpr unsigned MaxLSLocationBBMultiplicationNone = 128*128;
 
 /// we could run optimistic RLE on functions with less than 64 basic blocks
-/// and 64 locations which is a sizeable function.
+/// accessing memory and 64 locations which is a sizeable function.
 constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 64*64;
 
+/// Every basic block has bit vectors as wide as the number of locations,
+/// whether it accesses memory or not. Keep them to a few megabytes.
+constexpr unsigned MaxLSLocationBBMultiplicationBitVectors = 2048*2048;
+
 /// forward declaration.
 class RLEContext;
 
@@ -1082,6 +1086,7 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
 
   bool RunOneIteration = true;
   unsigned BBCount = 0;
+  unsigned MemoryBBCount = 0;
   unsigned LocationCount = LocationVault.size();
 
   if (LocationCount == 0) 
@@ -1095,6 +1100,8 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
   llvm::DenseSet<SILBasicBlock *> HandledBBs;
   for (SILBasicBlock *B : PO->getReversePostOrder()) {
     ++BBCount;
+    if (mayAccessMemory(B))
+      ++MemoryBBCount;
     for (auto X : B->getPreds()) {
       if (HandledBBs.find(X) == HandledBBs.end()) {
         RunOneIteration = false;
@@ -1104,8 +1111,10 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
     HandledBBs.insert(B);
   }
 
-  // Data flow may take too long to run.
-  if (BBCount * LocationCount > MaxLSLocationBBMultiplicationNone)
+  // Data flow may take too long to run, or its bit vectors may take too much
+  // memory.
+  if (MemoryBBCount * LocationCount > MaxLSLocationBBMultiplicationNone ||
+      BBCount * LocationCount > MaxLSLocationBBMultiplicationBitVectors)
     return ProcessKind::ProcessNone;
 
   // This function's data flow would converge in 1 iteration.
@@ -1114,7 +1123,7 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
   
   // We run one pessimistic data flow to do dead store elimination on
   // the function.
-  if (BBCount * LocationCount > MaxLSLocationBBMultiplicationPessimistic)
+  if (MemoryBBCount * LocationCount > MaxLSLocationBBMultiplicationPessimistic)
     return ProcessKind::ProcessOneIteration;
 
   return ProcessKind::ProcessMultipleIterations;
@@ -645,6 +645,8 @@ public:
     if (FalseBB) Constraints.push_back(Constraint(FalseBB, Right, Left, Rel));
   }
 
+  bool canRunInParallel() override { return true; }
+
   StringRef getName() override {
     return "Removes overflow checks that are proven to be redundant";
   }
@@ -2710,7 +2710,8 @@ bool SimplifyCFG::run() {
 
   RemoveUnreachable RU(Fn);
 
-  // First remove any block not reachable from the entry.
+  // First remove any block not reachable from the entry. The dominator tree
+  // has no nodes for such blocks, so removing them keeps it valid.
   bool Changed = RU.run();
 
   // Find the set of loop headers. We don't want to jump-thread through headers.
@@ -2718,21 +2719,24 @@ bool SimplifyCFG::run() {
 
   DT = nullptr;
 
-  // Perform SROA on BB arguments.
+  // Perform SROA on BB arguments. This replaces terminators by terminators to
+  // the same successors, which keeps the dominator tree valid, too.
   Changed |= splitBBArguments(Fn);
 
+  bool ChangedDominators = false;
   if (simplifyBlocks()) {
     // Simplifying other blocks might have resulted in unreachable
     // loops.
     RU.run();
 
     Changed = true;
+    ChangedDominators = true;
   }
 
   // Do simplifications that require the dominator tree to be accurate.
   DominanceAnalysis *DA = PM->getAnalysis<DominanceAnalysis>();
 
-  if (Changed) {
+  if (ChangedDominators) {
     // Force dominator recomputation since we modified the cfg.
     DA->invalidate(&Fn, SILAnalysis::InvalidationKind::Everything);
   }
@@ -3471,6 +3475,8 @@ public:
     }
   }
 
+  bool canRunInParallel() override { return true; }
+
   StringRef getName() override { return "Split Critical Edges"; }
 };
 
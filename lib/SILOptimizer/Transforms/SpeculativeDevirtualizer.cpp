@@ -13,6 +13,12 @@
 // Speculatively devirtualizes witness- and class-method calls into direct
 // calls.
 //
+// The subclasses to test for in class_method calls are found with the class
+// hierarchy analysis. If the module has a receiver profile, see
+// SILReceiverProfile, the sampled implementations of the method decide which
+// classes are tested and in which order. witness_method calls on opened
+// existentials are only speculated with a receiver profile.
+//
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "sil-speculative-devirtualizer"
@@ -24,7 +30,10 @@
 #include "swift/SIL/SILInstruction.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/SIL/InstructionUtils.h"
+#include "swift/SIL/SILDebugScope.h"
+#include "swift/SIL/SILReceiverProfile.h"
 #include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
+#include "swift/SILOptimizer/Analysis/ColdBlockInfo.h"
 #include "swift/SILOptimizer/Utils/Generics.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
@@ -45,6 +54,42 @@ using namespace swift;
 static const int MaxNumSpeculativeTargets = 6;
 
 STATISTIC(NumTargetsPredicted, "Number of monomorphic functions predicted");
+STATISTIC(NumProfiledTargetsPredicted,
+          "Number of functions predicted from the receiver profile");
+STATISTIC(NumWitnessTargetsPredicted, "Number of witness methods predicted");
+
+static llvm::cl::opt<bool> SpeculateHotCallSitesOnly(
+    "sil-speculative-devirt-hot-only", llvm::cl::init(false),
+    llvm::cl::desc("Only speculatively devirtualize calls in blocks which the "
+                   "profile shows to be hot"));
+
+/// Returns the number of samples of the receiver profile \p RP in which the
+/// dynamically dispatched call \p AI reached \p Target.
+static uint64_t getSampleCount(const SILReceiverProfile *RP, FullApplySite AI,
+                               SILFunction *Target) {
+  if (!Target)
+    return 0;
+  // The samples of inlined code were taken in the function it comes from.
+  SILFunction *Caller = AI.getFunction();
+  if (auto *DS = AI.getDebugScope()) {
+    if (auto *InlinedFrom = DS->getInlinedFunction())
+      Caller = InlinedFrom;
+  }
+  return RP->getCount(Caller->getName(), Target->getName());
+}
+
+/// Sorts the sampled targets of a call by descending sample count and drops
+/// the ones which exceed the limit of speculative targets.
+template <typename T>
+static void sortSampledTargets(SmallVectorImpl<std::pair<T, uint64_t>> &S) {
+  std::stable_sort(S.begin(), S.end(),
+                   [](const std::pair<T, uint64_t> &LHS,
+                      const std::pair<T, uint64_t> &RHS) {
+                     return LHS.second > RHS.second;
+                   });
+  if (S.size() > MaxNumSpeculativeTargets)
+    S.resize(MaxNumSpeculativeTargets);
+}
 
 // A utility function for cloning the apply instruction.
 static FullApplySite CloneApply(FullApplySite AI, SILBuilder &Builder) {
@@ -307,10 +352,29 @@ static bool isDefaultCaseKnown(ClassHierarchyAnalysis *CHA,
   return true;
 }
 
+/// Returns the type to check for in a speculative call for the subclass \p S,
+/// where \p SubType is the type of the instance or metatype, or a null type if
+/// the subclass cannot be handled. This happens e.g. if it is a generic class.
+static SILType getSpeculatedSubclassType(ClassDecl *S, SILType SubType) {
+  CanType CanClassType = S->getDeclaredType()->getCanonicalType();
+  SILType ClassType = SILType::getPrimitiveObjectType(CanClassType);
+  if (!ClassType.getClassOrBoundGenericClass())
+    return SILType();
+
+  if (auto EMT = SubType.getAs<AnyMetatypeType>()) {
+    auto InstTy = ClassType.getSwiftRValueType();
+    auto *MetaTy = MetatypeType::get(InstTy, EMT->getRepresentation());
+    auto CanMetaTy = CanMetatypeType::CanTypeWrapper(MetaTy);
+    return SILType::getPrimitiveObjectType(CanMetaTy);
+  }
+  return ClassType;
+}
+
 /// \brief Try to speculate the call target for the call \p AI. This function
 /// returns true if a change was made.
 static bool tryToSpeculateTarget(FullApplySite AI,
-                                 ClassHierarchyAnalysis *CHA) {
+                                 ClassHierarchyAnalysis *CHA,
+                                 const SILReceiverProfile *RP) {
   ClassMethodInst *CMI = cast<ClassMethodInst>(AI.getCallee());
 
   // We cannot devirtualize in cases where dynamic calls are
@@ -392,6 +456,55 @@ static bool tryToSpeculateTarget(FullApplySite AI,
     Subs.erase(RemovedIt, Subs.end());
   }
 
+  // Try to devirtualize the static class of instance
+  // if it is possible.
+  if (auto F = getTargetClassMethod(M, SubType, CMI)) {
+    // Do not devirtualize if a method in the base class is marked
+    // as non-optimizable. This way it is easy to disable the
+    // devirtualization of this method in the base class and
+    // any classes derived from it.
+    if (!F->shouldOptimize())
+      return false;
+  }
+
+  // If the receiver profile has samples of the implementations which the
+  // call can reach, check only for the classes which use a sampled
+  // implementation, most frequently sampled first. This also handles a
+  // dominant subclass beyond the first MaxNumSpeculativeTargets ones. The
+  // default case always stays a class_method call.
+  if (RP) {
+    SmallVector<std::pair<ClassDecl *, uint64_t>, 8> Sampled;
+    auto addIfSampled = [&](ClassDecl *C) {
+      auto *Impl = M.lookUpFunctionInVTable(C, CMI->getMember());
+      if (uint64_t Count = getSampleCount(RP, AI, Impl))
+        Sampled.push_back({C, Count});
+    };
+    addIfSampled(CD);
+    for (auto S : Subs)
+      addIfSampled(S);
+
+    if (!Sampled.empty()) {
+      sortSampledTargets(Sampled);
+      for (auto &Target : Sampled) {
+        SILType Ty = Target.first == CD
+                         ? SubType
+                         : getSpeculatedSubclassType(Target.first, SubType);
+        if (!Ty)
+          continue;
+        DEBUG(llvm::dbgs() << "Inserting a speculative call for sampled class "
+              << Target.first->getName() << " (" << Target.second
+              << " samples)\n");
+        auto NewAI = speculateMonomorphicTarget(AI, Ty, LastCCBI);
+        if (!NewAI)
+          continue;
+        AI = NewAI;
+        Changed = true;
+        NumProfiledTargetsPredicted++;
+      }
+      return Changed;
+    }
+  }
+
   // Number of subclasses which cannot be handled by checked_cast_br checks.
   int NotHandledSubsNum = 0;
   if (Subs.size() > MaxNumSpeculativeTargets) {
@@ -407,17 +520,6 @@ static bool tryToSpeculateTarget(FullApplySite AI,
   DEBUG(llvm::dbgs() << "Class " << CD->getName() << " is a superclass. "
         "Inserting polymorphic speculative call.\n");
 
-  // Try to devirtualize the static class of instance
-  // if it is possible.
-  if (auto F = getTargetClassMethod(M, SubType, CMI)) {
-    // Do not devirtualize if a method in the base class is marked
-    // as non-optimizable. This way it is easy to disable the
-    // devirtualization of this method in the base class and
-    // any classes derived from it.
-    if (!F->shouldOptimize())
-      return false;
-  }
-
   auto FirstAI = speculateMonomorphicTarget(AI, SubType, LastCCBI);
   if (FirstAI) {
     Changed = true;
@@ -465,23 +567,12 @@ static bool tryToSpeculateTarget(FullApplySite AI,
     DEBUG(llvm::dbgs() << "Inserting a speculative call for class "
           << CD->getName() << " and subclass " << S->getName() << "\n");
 
-    CanType CanClassType = S->getDeclaredType()->getCanonicalType();
-    SILType ClassType = SILType::getPrimitiveObjectType(CanClassType);
-    if (!ClassType.getClassOrBoundGenericClass()) {
-      // This subclass cannot be handled. This happens e.g. if it is
-      // a generic class.
+    auto ClassOrMetatypeType = getSpeculatedSubclassType(S, SubType);
+    if (!ClassOrMetatypeType) {
       NotHandledSubsNum++;
       continue;
     }
 
-    auto ClassOrMetatypeType = ClassType;
-    if (auto EMT = SubType.getAs<AnyMetatypeType>()) {
-      auto InstTy = ClassType.getSwiftRValueType();
-      auto *MetaTy = MetatypeType::get(InstTy, EMT->getRepresentation());
-      auto CanMetaTy = CanMetatypeType::CanTypeWrapper(MetaTy);
-      ClassOrMetatypeType = SILType::getPrimitiveObjectType(CanMetaTy);
-    }
-
     // Pass the metatype of the subclass.
     auto NewAI = speculateMonomorphicTarget(AI, ClassOrMetatypeType, LastCCBI);
     if (!NewAI) {
@@ -525,31 +616,221 @@ static bool tryToSpeculateTarget(FullApplySite AI,
   return Changed;
 }
 
+/// Insert a check whether the opened existential which is the self argument of
+/// the witness_method call \p AI has the type of \p Conformance, and a direct
+/// call of the witness on the success path. Returns the witness_method call on
+/// the failure path or a null apply site if the call cannot be speculated.
+static FullApplySite
+speculateWitnessTarget(FullApplySite AI,
+                       NormalProtocolConformance *Conformance) {
+  auto *WMI = cast<WitnessMethodInst>(AI.getCallee());
+  auto *OEI = cast<OpenExistentialAddrInst>(AI.getSelfArgument());
+  SILFunction *F = AI.getFunction();
+  SILModule &M = AI.getModule();
+  ASTContext &Ctx = M.getASTContext();
+
+  auto ConformanceRef = ProtocolConformanceRef(Conformance);
+  SILFunction *Witness;
+  std::tie(Witness, std::ignore, std::ignore) =
+      M.lookUpFunctionInWitnessTable(ConformanceRef, WMI->getMember());
+  if (!Witness ||
+      (F->isFragile() && !Witness->hasValidLinkageForFragileRef()))
+    return FullApplySite();
+
+  // Substitute the conforming type for the opened archetype. All other
+  // arguments and the result don't depend on the opened archetype, so they
+  // keep their types.
+  CanType ConcreteTy = Conformance->getType()->getCanonicalType();
+  ArrayRef<ProtocolConformanceRef> Conformances =
+      Ctx.AllocateCopy(ArrayRef<ProtocolConformanceRef>(ConformanceRef));
+  Substitution NewSub(ConcreteTy, Conformances);
+  SILType SubstCalleeTy = WMI->getType().substGenericArgs(M, NewSub);
+  auto SubstFnTy = SubstCalleeTy.castTo<SILFunctionType>();
+  unsigned NumArgs = AI.getNumArguments();
+  if (SubstFnTy->getNumSILArguments() != NumArgs ||
+      SubstFnTy->getSILResult() != AI.getType())
+    return FullApplySite();
+  for (unsigned Idx = 0; Idx + 1 < NumArgs; ++Idx) {
+    if (SubstFnTy->getSILArgumentType(Idx) != AI.getArgument(Idx)->getType())
+      return FullApplySite();
+  }
+  SILType SelfTy = SubstFnTy->getSILArgumentType(NumArgs - 1);
+  if (!SelfTy.isAddress())
+    return FullApplySite();
+
+  // Compare the dynamic type of the existential with the conforming type.
+  // A subclass of a conforming class passes the check, but it inherits the
+  // conformance and therefore uses the same witness.
+  SILBasicBlock *Entry = AI.getParent();
+  SILBasicBlock *Iden = F->createBasicBlock();
+  SILBasicBlock *Virt = F->createBasicBlock();
+  SILBasicBlock *Continue =
+      Entry->splitBasicBlock(AI.getInstruction()->getIterator());
+
+  auto getThickMetatype = [&](CanType Ty) {
+    return SILType::getPrimitiveObjectType(
+        CanMetatypeType::get(Ty, MetatypeRepresentation::Thick));
+  };
+  SILType ConcreteMetaTy = getThickMetatype(ConcreteTy);
+  Iden->createBBArg(ConcreteMetaTy);
+
+  SILBuilderWithScope Builder(Entry, AI.getInstruction());
+  auto *DynamicTy = Builder.createValueMetatype(
+      AI.getLoc(), getThickMetatype(OEI->getType().getSwiftRValueType()), OEI);
+  Builder.createCheckedCastBranch(AI.getLoc(), /*exact*/ false, DynamicTy,
+                                  ConcreteMetaTy, Iden, Virt);
+
+  // The success path calls the witness of the conformance.
+  SILBuilderWithScope IdenBuilder(Iden, AI.getInstruction());
+  SmallVector<SILValue, 8> Args;
+  for (auto Arg : AI.getArguments())
+    Args.push_back(Arg);
+  Args.back() = IdenBuilder.createUncheckedAddrCast(AI.getLoc(), OEI, SelfTy);
+  auto *NewWMI = IdenBuilder.createWitnessMethod(
+      AI.getLoc(), ConcreteTy, ConformanceRef, WMI->getMember(),
+      WMI->getType(), SILValue());
+  FullApplySite IdenAI = IdenBuilder.createApply(
+      AI.getLoc(), NewWMI, SubstCalleeTy, AI.getType(), NewSub, Args,
+      cast<ApplyInst>(AI)->isNonThrowing());
+
+  SILBuilderWithScope VirtBuilder(Virt, AI.getInstruction());
+  FullApplySite VirtAI = CloneApply(AI, VirtBuilder);
+
+  SILArgument *Arg = Continue->createBBArg(AI.getType());
+  IdenBuilder.createBranch(AI.getLoc(), Continue,
+                           ArrayRef<SILValue>(IdenAI.getInstruction()));
+  VirtBuilder.createBranch(AI.getLoc(), Continue,
+                           ArrayRef<SILValue>(VirtAI.getInstruction()));
+
+  assert(AI.getInstruction() == &Continue->front() &&
+         "AI should be the first instruction in the split Continue block");
+  AI.getInstruction()->replaceAllUsesWith(Arg);
+  AI.getInstruction()->eraseFromParent();
+
+  NumWitnessTargetsPredicted++;
+
+  auto NewInstPair = tryDevirtualizeWitnessMethod(IdenAI);
+  assert(NewInstPair.first && "Expected to be able to devirtualize apply!");
+  replaceDeadApply(IdenAI, NewInstPair.first);
+  if (NewWMI->use_empty())
+    NewWMI->eraseFromParent();
+
+  return VirtAI;
+}
+
+/// Try to speculate the targets of the witness_method call \p AI on an opened
+/// existential, using the witnesses which were sampled in the receiver profile
+/// \p RP. Returns true if a change was made.
+static bool tryToSpeculateWitnessTarget(FullApplySite AI,
+                                        const SILReceiverProfile *RP) {
+  auto *WMI = cast<WitnessMethodInst>(AI.getCallee());
+  if (WMI->isVolatile() || !isa<ApplyInst>(AI) || !AI.hasSelfArgument())
+    return false;
+
+  // Only handle a call on the address of an opaque existential, where the
+  // opened archetype is the only substitution and doesn't appear anywhere
+  // else in the call.
+  auto *OEI = dyn_cast<OpenExistentialAddrInst>(AI.getSelfArgument());
+  if (!OEI || WMI->getLookupType() != OEI->getType().getSwiftRValueType() ||
+      AI.getSubstitutions().size() != 1)
+    return false;
+  if (AI.getType().getSwiftRValueType()->hasOpenedExistential())
+    return false;
+  for (unsigned Idx = 0, End = AI.getNumArguments() - 1; Idx < End; ++Idx) {
+    if (AI.getArgument(Idx)->getType().getSwiftRValueType()
+            ->hasOpenedExistential())
+      return false;
+  }
+
+  // Collect the non-generic conformances whose witnesses were sampled.
+  SILModule &M = AI.getModule();
+  ProtocolDecl *Proto = WMI->getLookupProtocol();
+  SmallVector<std::pair<NormalProtocolConformance *, uint64_t>, 4> Sampled;
+  for (SILWitnessTable &WT : M.getWitnessTables()) {
+    NormalProtocolConformance *Conformance = WT.getConformance();
+    if (WT.isDeclaration() || Conformance->getProtocol() != Proto)
+      continue;
+    CanType ConcreteTy = Conformance->getType()->getCanonicalType();
+    if (!isa<StructType>(ConcreteTy) && !isa<EnumType>(ConcreteTy) &&
+        !isa<ClassType>(ConcreteTy))
+      continue;
+
+    for (const SILWitnessTable::Entry &E : WT.getEntries()) {
+      if (E.getKind() != SILWitnessTable::Method ||
+          E.getMethodWitness().Requirement != WMI->getMember())
+        continue;
+      if (uint64_t Count = getSampleCount(RP, AI, E.getMethodWitness().Witness))
+        Sampled.push_back({Conformance, Count});
+      break;
+    }
+  }
+
+  sortSampledTargets(Sampled);
+  bool Changed = false;
+  for (auto &Target : Sampled) {
+    DEBUG(llvm::dbgs() << "Inserting a speculative call for sampled type "
+          << Target.first->getType() << " of protocol " << Proto->getName()
+          << " (" << Target.second << " samples)\n");
+    auto NewAI = speculateWitnessTarget(AI, Target.first);
+    if (!NewAI)
+      continue;
+    AI = NewAI;
+    Changed = true;
+  }
+  return Changed;
+}
+
 namespace {
   /// Speculate the targets of virtual calls by assuming that the requested
   /// class is at the bottom of the class hierarchy.
   class SpeculativeDevirtualization : public SILFunctionTransform {
+    /// Blocks with a profiled execution count of at least this value are hot.
+    /// Computed on the first run if -sil-speculative-devirt-hot-only is set.
+    Optional<uint64_t> HotCount;
+
+    /// Returns true if calls in \p BB should not be speculated because they
+    /// are not known to be hot.
+    bool isSkippedBlock(SILBasicBlock &BB) {
+      if (!SpeculateHotCallSitesOnly)
+        return false;
+      if (!HotCount)
+        HotCount = ColdBlockInfo::getHotCount(getFunction()->getModule());
+      auto Count = BB.getExecutionCount();
+      return *HotCount == 0 || !Count || *Count < *HotCount;
+    }
+
   public:
     virtual ~SpeculativeDevirtualization() {}
 
     void run() override {
       ClassHierarchyAnalysis *CHA = PM->getAnalysis<ClassHierarchyAnalysis>();
+      const SILReceiverProfile *RP =
+          getFunction()->getModule().getReceiverProfile();
 
       bool Changed = false;
 
-      // Collect virtual calls that may be specialized.
+      // Collect virtual calls that may be specialized. Without a receiver
+      // profile nothing is known about the conforming types of an
+      // existential, so witness_method calls are only collected with one.
       SmallVector<FullApplySite, 16> ToSpecialize;
       for (auto &BB : *getFunction()) {
+        if (isSkippedBlock(BB))
+          continue;
         for (auto II = BB.begin(), IE = BB.end(); II != IE; ++II) {
           FullApplySite AI = FullApplySite::isa(&*II);
-          if (AI && isa<ClassMethodInst>(AI.getCallee()))
+          if (AI && (isa<ClassMethodInst>(AI.getCallee()) ||
+                     (RP && isa<WitnessMethodInst>(AI.getCallee()))))
             ToSpecialize.push_back(AI);
         }
       }
 
       // Go over the collected calls and try to insert speculative calls.
-      for (auto AI : ToSpecialize)
-        Changed |= tryToSpeculateTarget(AI, CHA);
+      for (auto AI : ToSpecialize) {
+        if (isa<WitnessMethodInst>(AI.getCallee()))
+          Changed |= tryToSpeculateWitnessTarget(AI, RP);
+        else
+          Changed |= tryToSpeculateTarget(AI, CHA, RP);
+      }
 
       if (Changed) {
         invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
@@ -44,6 +44,13 @@ using namespace swift;
 ///    The solution to this problem is that we need native support for tail-
 ///    allocated arrays in SIL so that we can do the array buffer allocations
 ///    with alloc_ref instructions.
+///
+/// TODO: Closure contexts of partial_apply and boxes of alloc_box which
+/// AllocBoxToStack cannot promote would benefit from the same treatment.
+/// Neither instruction has a [stack] attribute, and IRGen allocates both
+/// through the runtime, with a layout that may only be known at runtime.
+/// Supporting them needs the attribute in SIL, a stack-allocating lowering
+/// for fixed-size layouts in IRGen, and a heap fallback for the others.
 class StackPromoter {
 
   // Some analysis we need.
@@ -0,0 +1,67 @@
+//===--- ARCSummaryDumper.cpp - Dumps the retain/release summaries --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "dump-arc-summary"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/Analysis/ARCSummaryAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+
+using namespace swift;
+
+namespace {
+
+#ifndef NDEBUG
+static StringRef getKindName(ARCArgumentKind Kind) {
+  switch (Kind) {
+  case ARCArgumentKind::Unknown: return "unknown";
+  case ARCArgumentKind::ReadOnly: return "readonly";
+  case ARCArgumentKind::Guaranteed: return "guaranteed";
+  case ARCArgumentKind::Consumed: return "consumed";
+  }
+  llvm_unreachable("Unhandled ARCArgumentKind");
+}
+#endif
+
+/// Dumps the ARC summaries of the arguments of all functions in the module.
+/// Only dumps if the compiler is built with assertions.
+/// For details see ARCSummaryAnalysis.
+class ARCSummaryDumper : public SILModuleTransform {
+
+  void run() override {
+
+    DEBUG(llvm::dbgs() << "** ARCSummaryDumper **\n");
+
+#ifndef NDEBUG
+    auto *ASA = PM->getAnalysis<ARCSummaryAnalysis>();
+
+    llvm::outs() << "ARC summaries of module\n";
+    for (auto &F : *getModule()) {
+      if (F.isExternalDeclaration())
+        continue;
+      llvm::outs() << "  sil @" << F.getName() << '\n';
+      for (SILArgument *Arg : F.begin()->getBBArgs()) {
+        unsigned Idx = Arg->getIndex();
+        llvm::outs() << "    %" << Idx << ": "
+                     << getKindName(ASA->getArgumentKind(&F, Idx)) << '\n';
+      }
+    }
+#endif
+  }
+
+  StringRef getName() override { return "ARCSummaryDumper"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createARCSummaryDumper() {
+  return new ARCSummaryDumper();
+}
@@ -24,6 +24,8 @@ class ComputeDominanceInfo : public SILFunctionTransform {
     PM->getAnalysis<PostDominanceAnalysis>()->get(getFunction());
   }
 
+  bool canRunInParallel() override { return true; }
+
   StringRef getName() override { return "Compute Dominance Info"; }
 };
 
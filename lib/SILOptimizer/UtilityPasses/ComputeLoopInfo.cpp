@@ -23,6 +23,8 @@ class ComputeLoopInfo : public SILFunctionTransform {
     PM->getAnalysis<SILLoopAnalysis>()->get(getFunction());
   }
 
+  bool canRunInParallel() override { return true; }
+
   StringRef getName() override { return "Compute Loop Info"; }
 };
 
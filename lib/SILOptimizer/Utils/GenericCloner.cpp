@@ -40,7 +40,7 @@ SILFunction *GenericCloner::initCloned(SILFunction *Orig,
   // Create a new empty function.
   SILFunction *NewF = Orig->getModule().createFunction(
       getSpecializedLinkage(Orig, Orig->getLinkage()), NewName,
-      ReInfo.getSpecializedType(), nullptr,
+      ReInfo.getSpecializedType(), ReInfo.getSpecializedGenericParams(),
       Orig->getLocation(), Orig->isBare(), Orig->isTransparent(),
       Fragile, Orig->isThunk(), Orig->getClassVisibility(),
       Orig->getInlineStrategy(), Orig->getEffectsKind(), Orig,
@@ -15,20 +15,85 @@
 #include "swift/Strings.h"
 #include "swift/SILOptimizer/Utils/Generics.h"
 #include "swift/SILOptimizer/Utils/GenericCloner.h"
+#include "swift/Basic/JSONSerialization.h"
 #include "swift/SIL/DebugUtils.h"
+#include "llvm/ADT/Statistic.h"
 
 using namespace swift;
 
+STATISTIC(NumSpecializationsRejected,
+          "Number of specializations rejected by the cost model");
+
 // =============================================================================
 // ReabstractionInfo
 // =============================================================================
 
+static llvm::cl::opt<bool> EnablePartialSpecialization(
+    "sil-partial-specialization", llvm::cl::init(false),
+    llvm::cl::desc("Specialize generic functions for call sites which have "
+                   "both concrete and generic substitutions"));
+
+/// Returns true if a call with substitutions \p ParamSubs in \p Caller can
+/// be partially specialized, i.e. if some replacement types are concrete and
+/// all others are archetypes of the caller.
+static bool canSpecializePartially(SILFunction *Caller,
+                                   ArrayRef<Substitution> ParamSubs) {
+  if (!EnablePartialSpecialization || !Caller ||
+      !Caller->getContextGenericParams())
+    return false;
+
+  bool HasConcreteSub = false;
+  for (const Substitution &Sub : ParamSubs) {
+    CanType Replacement = Sub.getReplacement()->getCanonicalType();
+    if (!Replacement->hasArchetype()) {
+      HasConcreteSub = true;
+      continue;
+    }
+    // Generic types which are bound to archetypes, like Array<S>, would need
+    // conformances which refer to the caller's archetypes. Opened existentials
+    // can't be mapped out of the caller's context.
+    auto *Archetype = dyn_cast<ArchetypeType>(Replacement);
+    if (!Archetype || Archetype->getOpenedExistentialType())
+      return false;
+    if (Caller->mapTypeOutOfContext(Archetype)->hasArchetype())
+      return false;
+  }
+  return HasConcreteSub;
+}
+
+/// Maps the contextual function type \p FTy out of the generic context of
+/// \p F. The result has the generic signature of \p F.
+static CanSILFunctionType mapTypeOutOfContext(SILFunction *F,
+                                              CanSILFunctionType FTy) {
+  auto mapType = [&](CanType Ty) -> CanType {
+    return F->mapTypeOutOfContext(Ty)->getCanonicalType();
+  };
+
+  SmallVector<SILResultInfo, 8> Results;
+  for (SILResultInfo RI : FTy->getAllResults())
+    Results.push_back(SILResultInfo(mapType(RI.getType()), RI.getConvention()));
+
+  SmallVector<SILParameterInfo, 8> Params;
+  for (SILParameterInfo PI : FTy->getParameters()) {
+    Params.push_back(SILParameterInfo(mapType(PI.getType()),
+                                      PI.getConvention()));
+  }
+
+  // The error result never depends on generic parameters.
+  return SILFunctionType::get(
+      F->getLoweredFunctionType()->getGenericSignature(), FTy->getExtInfo(),
+      FTy->getCalleeConvention(), Params, Results,
+      FTy->getOptionalErrorResult(), F->getASTContext());
+}
+
 // Initialize SpecializedType iff the specialization is allowed.
 ReabstractionInfo::ReabstractionInfo(SILFunction *OrigF,
-                                     ArrayRef<Substitution> ParamSubs) {
+                                     ArrayRef<Substitution> ParamSubs,
+                                     SILFunction *Caller) {
   if (!OrigF->shouldOptimize()) {
     DEBUG(llvm::dbgs() << "    Cannot specialize function " << OrigF->getName()
                        << " marked to be excluded from optimizations.\n");
+    RejectReason = "not optimizable";
     return;
   }
 
@@ -37,22 +102,39 @@ ReabstractionInfo::ReabstractionInfo(SILFunction *OrigF,
     InterfaceSubs = OrigF->getLoweredFunctionType()->getGenericSignature()
       ->getSubstitutionMap(ParamSubs);
 
-  // We do not support partial specialization.
+  // If some substitutions are unbound, we can only do a partial
+  // specialization, which stays generic over the caller's generic parameters.
   if (hasUnboundGenericTypes(InterfaceSubs)) {
-    DEBUG(llvm::dbgs() <<
-          "    Cannot specialize with unbound interface substitutions.\n");
-    DEBUG(for (auto Sub : ParamSubs) {
-            Sub.dump();
-          });
-    return;
+    if (!canSpecializePartially(Caller, ParamSubs)) {
+      DEBUG(llvm::dbgs() <<
+            "    Cannot specialize with unbound interface substitutions.\n");
+      DEBUG(for (auto Sub : ParamSubs) {
+              Sub.dump();
+            });
+      RejectReason = "unbound generic types";
+      return;
+    }
+    PartialContext = Caller;
+    for (const Substitution &Sub : ParamSubs) {
+      InterfaceParamSubs.push_back(
+          Substitution(Caller->mapTypeOutOfContext(Sub.getReplacement()),
+                       Sub.getConformances()));
+    }
+    DEBUG(llvm::dbgs() << "    Partially specializing in the context of "
+                       << Caller->getName() << ".\n");
   }
   if (hasDynamicSelfTypes(InterfaceSubs)) {
     DEBUG(llvm::dbgs() << "    Cannot specialize with dynamic self.\n");
+    RejectReason = "dynamic self";
+    PartialContext = nullptr;
     return;
   }
   SILModule &M = OrigF->getModule();
   Module *SM = M.getSwiftModule();
 
+  // For a partial specialization the substituted type still contains the
+  // caller's archetypes, which lower like any concrete type. It is mapped out
+  // of the caller's context at the end.
   SubstitutedType = SILType::substFuncType(M, SM, InterfaceSubs,
                                            OrigF->getLoweredFunctionType(),
                                            /*dropGenerics = */ true);
@@ -84,6 +166,11 @@ ReabstractionInfo::ReabstractionInfo(SILFunction *OrigF,
     ++IdxForParam;
   }
   SpecializedType = createSpecializedType(SubstitutedType, M);
+
+  if (PartialContext) {
+    SubstitutedType = mapTypeOutOfContext(PartialContext, SubstitutedType);
+    SpecializedType = mapTypeOutOfContext(PartialContext, SpecializedType);
+  }
 }
 
 // Convert the substituted function type into a specialized function type based
@@ -156,9 +243,16 @@ GenericFuncSpecializer::GenericFuncSpecializer(SILFunction *GenericFunc,
       ->getSubstitutionMap(ParamSubs);
 
   Mangle::Mangler Mangler;
-  GenericSpecializationMangler GenericMangler(Mangler, GenericFunc,
-                                              ParamSubs, Fragile);
-  GenericMangler.mangle();
+  if (ReInfo.isPartialSpecialization()) {
+    PartialSpecializationMangler PartialMangler(
+        Mangler, GenericFunc, ReInfo.getSpecializedType()->getGenericSignature(),
+        ReInfo.getInterfaceParamSubs(), Fragile);
+    PartialMangler.mangle();
+  } else {
+    GenericSpecializationMangler GenericMangler(Mangler, GenericFunc,
+                                                ParamSubs, Fragile);
+    GenericMangler.mangle();
+  }
   ClonedName = Mangler.finalize();
 
   DEBUG(llvm::dbgs() << "    Specialized function " << ClonedName << '\n');
@@ -227,6 +321,14 @@ static ApplySite replaceWithSpecializedCallee(ApplySite AI,
   SILLocation Loc = AI.getLoc();
   SmallVector<SILValue, 4> Arguments;
   SILValue StoreResultTo;
+
+  // A partial specialization is still generic over the caller's generic
+  // parameters.
+  ArrayRef<Substitution> Subs = ReInfo.getCallerSubstitutions();
+  SILType SubstCalleeTy = Callee->getType();
+  if (!Subs.empty())
+    SubstCalleeTy = SubstCalleeTy.substGenericArgs(Builder.getModule(), Subs);
+
   unsigned Idx = ReInfo.getIndexOfFirstArg(AI);
   for (auto &Op : AI.getArgumentOperands()) {
     if (ReInfo.isArgConverted(Idx)) {
@@ -251,7 +353,7 @@ static ApplySite replaceWithSpecializedCallee(ApplySite AI,
     SILBasicBlock *ResultBB = TAI->getNormalBB();
     assert(ResultBB->getSinglePredecessor() == TAI->getParent());
     auto *NewTAI =
-      Builder.createTryApply(Loc, Callee, Callee->getType(), {},
+      Builder.createTryApply(Loc, Callee, SubstCalleeTy, Subs,
                              Arguments, ResultBB, TAI->getErrorBB());
     if (StoreResultTo) {
       // The original normal result of the try_apply is an empty tuple.
@@ -268,7 +370,10 @@ static ApplySite replaceWithSpecializedCallee(ApplySite AI,
     return NewTAI;
   }
   if (auto *A = dyn_cast<ApplyInst>(AI)) {
-    auto *NewAI = Builder.createApply(Loc, Callee, Arguments, A->isNonThrowing());
+    auto *NewAI = Builder.createApply(
+        Loc, Callee, SubstCalleeTy,
+        SubstCalleeTy.castTo<SILFunctionType>()->getSILResult(), Subs,
+        Arguments, A->isNonThrowing());
     if (StoreResultTo) {
       // Store the direct result to the original result address.
       fixUsedVoidType(A, Loc, Builder);
@@ -278,6 +383,8 @@ static ApplySite replaceWithSpecializedCallee(ApplySite AI,
     return NewAI;
   }
   if (auto *PAI = dyn_cast<PartialApplyInst>(AI)) {
+    assert(!ReInfo.isPartialSpecialization() &&
+           "partial_apply sites are not partially specialized");
     CanSILFunctionType NewPAType =
       ReInfo.createSpecializedType(PAI->getFunctionType(), Builder.getModule());
     SILType PTy = SILType::getPrimitiveObjectType(ReInfo.getSpecializedType());
@@ -399,6 +506,19 @@ static SILFunction *createReabstractionThunk(const ReabstractionInfo &ReInfo,
   return Thunk;
 }
 
+/// Returns true if \p F refers to itself.
+static bool isSelfRecursive(SILFunction *F) {
+  for (SILBasicBlock &BB : *F) {
+    for (SILInstruction &I : BB) {
+      if (auto *FRI = dyn_cast<FunctionRefInst>(&I)) {
+        if (FRI->getReferencedFunction() == F)
+          return true;
+      }
+    }
+  }
+  return false;
+}
+
 void swift::trySpecializeApplyOfGeneric(
     ApplySite Apply, DeadInstructionSet &DeadApplies,
     llvm::SmallVectorImpl<SILFunction *> &NewFunctions) {
@@ -410,13 +530,22 @@ void swift::trySpecializeApplyOfGeneric(
   DEBUG(llvm::dbgs() << "  ApplyInst:\n";
         Apply.getInstruction()->dumpInContext());
 
+  SpecializationRemark Remark;
+  Remark.Pass = "generic-specializer";
+  Remark.Decision = "rejected";
+  Remark.Caller = F->getName();
+  Remark.Callee = RefF->getName();
+
   // If the caller is fragile but the callee is not, bail out.
   // Specializations have shared linkage, which means they do
   // not have an external entry point, Since the callee is not
   // fragile we cannot serialize the body of the specialized
   // callee either.
-  if (F->isFragile() && !RefF->hasValidLinkageForFragileInline())
-      return;
+  if (F->isFragile() && !RefF->hasValidLinkageForFragileInline()) {
+    Remark.Reason = "fragile caller of non-fragile callee";
+    Remark.emit(F->getModule());
+    return;
+  }
 
   // If the caller and callee are both fragile, preserve the fragility when
   // cloning the callee. Otherwise, strip it off so that we can optimize
@@ -425,11 +554,25 @@ void swift::trySpecializeApplyOfGeneric(
   if (F->isFragile() && RefF->isFragile())
     Fragile = IsFragile;
 
-  ReabstractionInfo ReInfo(RefF, Apply.getSubstitutions());
-  if (!ReInfo.getSpecializedType())
+  SILModule &M = F->getModule();
+
+  // Only full apply sites are partially specialized. A partial_apply would
+  // need a generic re-abstraction thunk.
+  SILFunction *PartialContext = isa<PartialApplyInst>(Apply) ? nullptr : F;
+  ReabstractionInfo ReInfo(RefF, Apply.getSubstitutions(), PartialContext);
+  if (!ReInfo.getSpecializedType()) {
+    Remark.Reason = ReInfo.getRejectReason();
+    Remark.emit(M);
     return;
+  }
 
-  SILModule &M = F->getModule();
+  // The cloner rewrites recursive calls to the specialization without
+  // substitutions, which is only correct for a full specialization.
+  if (ReInfo.isPartialSpecialization() && isSelfRecursive(RefF)) {
+    Remark.Reason = "recursive partial specialization";
+    Remark.emit(M);
+    return;
+  }
 
   bool needAdaptUsers = false;
   bool replacePartialApplyWithoutReabstraction = false;
@@ -469,18 +612,47 @@ void swift::trySpecializeApplyOfGeneric(
 
   GenericFuncSpecializer FuncSpecializer(RefF, Apply.getSubstitutions(),
                                          Fragile, ReInfo);
+  // Callers whose generic signatures only differ in redundant requirements
+  // get the same name for a partial specialization, but not the same type.
+  if (ReInfo.isPartialSpecialization()) {
+    SILFunction *Existing = M.lookUpFunction(FuncSpecializer.getClonedName());
+    if (Existing &&
+        Existing->getLoweredFunctionType() != ReInfo.getSpecializedType()) {
+      Remark.Reason = "conflicting partial specialization";
+      Remark.emit(M);
+      return;
+    }
+  }
+
   SILFunction *SpecializedF = FuncSpecializer.lookupSpecialization();
   if (SpecializedF) {
     // Even if the pre-specialization exists already, try to preserve it
     // if it is whitelisted.
     linkSpecialization(M, SpecializedF);
+    Remark.Decision = "reused";
   } else {
+    // An existing specialization doesn't cost anything, but a new one must be
+    // worth its size.
+    Remark.Reason = checkSpecializationCost(Apply, RefF, Remark.Cost);
+    if (!Remark.Reason.empty()) {
+      ++NumSpecializationsRejected;
+      Remark.emit(M);
+      return;
+    }
+
     SpecializedF = FuncSpecializer.tryCreateSpecialization();
-    if (!SpecializedF)
+    if (!SpecializedF) {
+      Remark.Reason = "cannot create specialization";
+      Remark.emit(M);
       return;
+    }
 
+    M.addSpecializedInstructions(Remark.Cost.Size);
     NewFunctions.push_back(SpecializedF);
+    Remark.Decision = "created";
   }
+  Remark.Specialization = SpecializedF->getName();
+  Remark.emit(M);
 
   assert(ReInfo.getSpecializedType()
          == SpecializedF->getLoweredFunctionType() &&
@@ -543,6 +715,123 @@ void swift::trySpecializeApplyOfGeneric(
   }
 }
 
+// =============================================================================
+// Specialization cost model
+// =============================================================================
+
+static llvm::cl::opt<unsigned> SpecializationBudget(
+    "sil-specialization-budget", llvm::cl::init(0),
+    llvm::cl::desc("The maximum number of instructions which new generic "
+                   "specializations may add to a module (0 means no limit)"));
+
+static llvm::cl::opt<unsigned> SpecializationSmallSize(
+    "sil-specialization-small-size", llvm::cl::init(32),
+    llvm::cl::desc("Generic functions with up to this number of instructions "
+                   "are always specialized"));
+
+static llvm::cl::opt<unsigned> SpecializationSizeRatio(
+    "sil-specialization-size-ratio", llvm::cl::init(32),
+    llvm::cl::desc("The maximum size of a specialization per generic "
+                   "instruction, weighted by the call frequency"));
+
+/// Returns true if \p I depends on the generic parameters of its function,
+/// i.e. if it gets cheaper when the function is specialized.
+static bool isGenericInstruction(SILInstruction &I) {
+  if (isa<WitnessMethodInst>(&I))
+    return true;
+  if (auto Apply = ApplySite::isa(&I)) {
+    if (Apply.hasSubstitutions())
+      return true;
+  }
+  if (I.hasValue() && I.getType().hasArchetype())
+    return true;
+  for (const Operand &Op : I.getAllOperands()) {
+    if (Op.get()->getType().hasArchetype())
+      return true;
+  }
+  return false;
+}
+
+void swift::computeSpecializationSize(SILFunction *F,
+                                      SpecializationCost &Cost) {
+  Cost.Size = 0;
+  Cost.GenericInsts = 0;
+  for (SILBasicBlock &BB : *F) {
+    for (SILInstruction &I : BB) {
+      if (isDebugInst(&I))
+        continue;
+      ++Cost.Size;
+      if (isGenericInstruction(I))
+        ++Cost.GenericInsts;
+    }
+  }
+}
+
+StringRef swift::checkSpecializationCost(ApplySite Apply, SILFunction *Callee,
+                                         SpecializationCost &Cost) {
+  computeSpecializationSize(Callee, Cost);
+
+  SILBasicBlock *CallBB = Apply.getInstruction()->getParent();
+  Optional<uint64_t> Count = CallBB->getExecutionCount();
+  Cost.Frequency = Count ? std::max(*Count, uint64_t(1)) : 1;
+
+  // Small specializations don't increase code size much, and they often get
+  // inlined afterwards. They are accounted for, but never rejected.
+  SILModule &M = Callee->getModule();
+  if (Cost.Size > SpecializationSmallSize) {
+    if (Count && *Count == 0)
+      return "cold call site";
+
+    if (Cost.GenericInsts == 0)
+      return "no benefit";
+
+    // Limit the frequency so that the product below cannot overflow.
+    uint64_t Frequency = std::min(Cost.Frequency, uint64_t(UINT32_MAX));
+    uint64_t Benefit = uint64_t(Cost.GenericInsts) * Frequency;
+    if (Benefit * SpecializationSizeRatio < Cost.Size)
+      return "too large for its benefit";
+
+    if (SpecializationBudget &&
+        M.getNumSpecializedInstructions() + Cost.Size > SpecializationBudget)
+      return "budget exhausted";
+  }
+  return StringRef();
+}
+
+namespace swift {
+namespace json {
+
+template <> struct ObjectTraits<SpecializationRemark> {
+  static void mapping(Output &out, SpecializationRemark &R) {
+    out.mapRequired("pass", R.Pass);
+    out.mapRequired("decision", R.Decision);
+    out.mapOptional("reason", R.Reason, StringRef());
+    out.mapOptional("caller", R.Caller, StringRef());
+    out.mapRequired("callee", R.Callee);
+    out.mapOptional("specialization", R.Specialization, StringRef());
+    out.mapRequired("size", R.Cost.Size);
+    out.mapRequired("generic-insts", R.Cost.GenericInsts);
+    out.mapRequired("frequency", R.Cost.Frequency);
+  }
+};
+
+} // end namespace json
+} // end namespace swift
+
+void SpecializationRemark::emit(SILModule &M) const {
+  DEBUG(llvm::dbgs() << "  " << Decision << " specialization of "
+                     << Callee << (Reason.empty() ? "" : ": ") << Reason
+                     << "\n");
+
+  llvm::raw_ostream *OS = M.getSpecializationRemarkStream();
+  if (!OS)
+    return;
+  SpecializationRemark Copy = *this;
+  json::Output Out(*OS, /*PrettyPrint=*/false);
+  Out << Copy;
+  *OS << '\n';
+}
+
 // =============================================================================
 // Prespecialized symbol lookup.
 //
@@ -262,3 +262,10 @@ LSLocation::enumerateLSLocations(SILFunction &F,
     }
   }
 }
+
+bool swift::mayAccessMemory(SILBasicBlock *BB) {
+  for (auto &I : *BB)
+    if (I.mayReadOrWriteMemory())
+      return true;
+  return false;
+}
@@ -106,6 +106,20 @@ bool SILInliner::inlineFunction(FullApplySite AI, ArrayRef<SILValue> Args) {
   // entry block, cloning all instructions other than terminators.
   visitSILBasicBlock(CalleeEntryBB);
 
+  // Scale the profiled execution counts of the callee's blocks to the call
+  // site.
+  auto CallSiteCount = AI.getParent()->getExecutionCount();
+  auto CalleeEntryCount = CalleeFunction->getEntryCount();
+  if (CallSiteCount && CalleeEntryCount && *CalleeEntryCount != 0) {
+    double Scale = double(*CallSiteCount) / double(*CalleeEntryCount);
+    for (auto &Entry : BBMap) {
+      if (Entry.first == CalleeEntryBB)
+        continue;
+      if (auto Count = Entry.first->getExecutionCount())
+        Entry.second->setExecutionCount(uint64_t(double(*Count) * Scale));
+    }
+  }
+
   // If we're inlining into a normal apply and the callee's entry
   // block ends in a return, then we can avoid a split.
   if (auto nonTryAI = dyn_cast<ApplyInst>(AI)) {
@@ -1071,6 +1071,168 @@ namespace {
     favorCallOverloads(expr, CS, isFavoredDecl, createReplacements);
   }
   
+  /// Determine whether the argument \p arg, if it is a literal, cannot be
+  /// passed to a parameter of type \p paramTy because the parameter type
+  /// does not conform to the literal protocol.
+  ///
+  /// This is conservative: it only answers true for concrete struct and
+  /// enum parameter types, which a literal can only reach by being of that
+  /// type (or of its optional), never through a subtype or existential.
+  bool isMismatchedLiteralArg(ConstraintSystem &CS, Expr *arg,
+                              Type paramTy) {
+    arg = arg->getSemanticsProvidingExpr();
+    if (!arg->getType())
+      return false;
+    auto argTypeVar = arg->getType()->getAs<TypeVariableType>();
+    if (!argTypeVar)
+      return false;
+    auto proto = argTypeVar->getImpl().literalConformanceProto;
+    if (!proto ||
+        proto->isSpecificProtocol(KnownProtocolKind::NilLiteralConvertible))
+      return false;
+
+    if (paramTy->hasArchetype() || paramTy->hasTypeParameter() ||
+        paramTy->hasTypeVariable() || paramTy->is<InOutType>())
+      return false;
+
+    // Look through optionals, which admit the literal by value-to-optional
+    // conversion.
+    Type objTy = paramTy;
+    while (auto optObjTy = objTy->getAnyOptionalObjectType())
+      objTy = optObjTy;
+
+    // String literals convert to pointers, and bridged types may be reached
+    // from an Objective-C class conforming to the literal protocol.
+    if (objTy->getAnyPointerElementType())
+      return false;
+    if (!objTy->getStructOrBoundGenericStruct() &&
+        !objTy->getEnumOrBoundGenericEnum())
+      return false;
+    if (CS.TC.Context.LangOpts.EnableObjCInterop &&
+        CS.TC.getBridgedToObjC(CS.DC, objTy))
+      return false;
+
+    return !CS.TC.conformsToProtocol(objTy, proto, CS.DC,
+                                     ConformanceCheckFlags::InExpression);
+  }
+
+  /// Determine whether the overload \p decl cannot be called with the
+  /// arguments of \p expr, judging by the argument labels, the number of
+  /// arguments and the kinds of literal arguments.
+  bool isMismatchedCallOverload(ApplyExpr *expr, ValueDecl *decl,
+                                ConstraintSystem &CS,
+                                const ConstraintSystem::ArgumentLabelState
+                                    *labels) {
+    auto fn = dyn_cast<AbstractFunctionDecl>(decl);
+    if (!fn || !fn->hasType() || fn->isInvalid())
+      return false;
+
+    unsigned parameterDepth = fn->getDeclContext()->isTypeContext() ? 1 : 0;
+    if (parameterDepth >= fn->getNumParameterLists())
+      return false;
+
+    if (labels &&
+        !areConservativelyCompatibleArgumentLabels(fn, parameterDepth,
+                                                   labels->Labels,
+                                                   labels->HasTrailingClosure))
+      return true;
+
+    // Match up literal arguments with parameters positionally. This is only
+    // possible if every argument binds to its own parameter.
+    SmallVector<Expr *, 4> args;
+    auto argExpr = expr->getArg();
+    if (auto tuple = dyn_cast<TupleExpr>(argExpr))
+      args.append(tuple->getElements().begin(), tuple->getElements().end());
+    else if (auto paren = dyn_cast<ParenExpr>(argExpr))
+      args.push_back(paren->getSubExpr());
+    else
+      return false;
+
+    auto &params = *fn->getParameterList(parameterDepth);
+    if (args.size() != params.size())
+      return false;
+    for (unsigned i = 0, e = args.size(); i != e; ++i) {
+      auto param = params.get(i);
+      if (param->isVariadic() || !param->hasType())
+        return false;
+    }
+    for (unsigned i = 0, e = args.size(); i != e; ++i) {
+      if (isMismatchedLiteralArg(CS, args[i], params.get(i)->getType()))
+        return true;
+    }
+    return false;
+  }
+
+  /// Remove the terms of the overload set bound to the callee of \p expr
+  /// which cannot match the call site, so that the solver never attempts
+  /// them.
+  void pruneMismatchedCallOverloads(ApplyExpr *expr, ConstraintSystem &CS) {
+    // Pruned terms are still needed to diagnose failures with fixes.
+    if (CS.shouldAttemptFixes())
+      return;
+
+    if (!isa<OverloadedDeclRefExpr>(expr->getFn()))
+      return;
+    auto tyvarType = expr->getFn()->getType()->getAs<TypeVariableType>();
+    if (!tyvarType)
+      return;
+
+    auto csLoc = CS.getConstraintLocator(expr->getFn());
+    const ConstraintSystem::ArgumentLabelState *labels = nullptr;
+    auto knownLabels = CS.ArgumentLabels.find(csLoc);
+    if (knownLabels != CS.ArgumentLabels.end())
+      labels = &knownLabels->second;
+
+    auto &CG = CS.getConstraintGraph();
+    SmallVector<Constraint *, 4> constraints;
+    CG.gatherConstraints(tyvarType, constraints);
+
+    for (auto constraint : constraints) {
+      if (constraint->getKind() != ConstraintKind::Disjunction)
+        continue;
+
+      auto oldConstraints = constraint->getNestedConstraints();
+      bool isOverloadSet = true;
+      for (auto oldConstraint : oldConstraints) {
+        if (oldConstraint->getKind() != ConstraintKind::BindOverload ||
+            oldConstraint->getOverloadChoice().getKind() !=
+                OverloadChoiceKind::Decl) {
+          isOverloadSet = false;
+          break;
+        }
+      }
+      if (!isOverloadSet)
+        continue;
+
+      SmallVector<Constraint *, 4> keptConstraints;
+      for (auto oldConstraint : oldConstraints) {
+        auto decl = oldConstraint->getOverloadChoice().getDecl();
+        if (!isMismatchedCallOverload(expr, decl, CS, labels))
+          keptConstraints.push_back(oldConstraint);
+      }
+
+      // Leave it to the solver to diagnose a call which matches no
+      // overload at all.
+      if (keptConstraints.empty() ||
+          keptConstraints.size() == oldConstraints.size())
+        break;
+
+      CS.NumPrunedDisjunctionTerms +=
+          oldConstraints.size() - keptConstraints.size();
+      CS.removeInactiveConstraint(constraint);
+
+      auto prunedConstraint =
+          Constraint::createDisjunction(CS, keptConstraints, csLoc);
+      if (constraint->isFavored()) {
+        if (keptConstraints.size() == 1)
+          prunedConstraint = prunedConstraint->clone(CS);
+        prunedConstraint->setFavored();
+      }
+      CS.addConstraint(prunedConstraint);
+      break;
+    }
+  }
+
   class ConstraintOptimizer : public ASTWalker {
     
     ConstraintSystem &CS;
@@ -1083,6 +1245,8 @@ namespace {
     std::pair<bool, Expr *> walkToExprPre(Expr *expr) override {
       
       if (auto applyExpr = dyn_cast<ApplyExpr>(expr)) {
+        pruneMismatchedCallOverloads(applyExpr, CS);
+
         if (isa<PrefixUnaryExpr>(applyExpr) ||
             isa<PostfixUnaryExpr>(applyExpr)) {
           favorMatchingUnaryOperators(applyExpr, CS);
@@ -1797,6 +1961,45 @@ namespace {
                                      decl);
     }
     
+    /// Determine whether \p expr is a simple literal whose type is a fresh
+    /// literal type variable that may be merged with other literals of the
+    /// same kind.
+    static bool isMergeableLiteral(Expr *expr) {
+      if (!isa<IntegerLiteralExpr>(expr) && !isa<FloatLiteralExpr>(expr) &&
+          !isa<BooleanLiteralExpr>(expr) && !isa<StringLiteralExpr>(expr))
+        return false;
+      return expr->getType() && expr->getType()->is<TypeVariableType>();
+    }
+
+    /// If the elements of an array literal are all literals of the same kind,
+    /// merge the equivalence classes of their type variables, so that the
+    /// solver only has to find a type for one of them, and return true.
+    ///
+    /// All of the elements are converted to the same element type, so they
+    /// would end up with the same type anyway. Generated tables with
+    /// thousands of elements would otherwise make the solver juggle
+    /// thousands of type variables and conversions.
+    bool mergeHomogeneousLiteralElements(ArrayRef<Expr *> elements) {
+      if (elements.size() < 2)
+        return false;
+
+      auto first = elements.front();
+      if (!isMergeableLiteral(first))
+        return false;
+      for (auto element : elements.slice(1)) {
+        if (element->getKind() != first->getKind() ||
+            !isMergeableLiteral(element))
+          return false;
+      }
+
+      auto firstTyvar = first->getType()->castTo<TypeVariableType>();
+      for (auto element : elements.slice(1)) {
+        mergeRepresentativeEquivalenceClasses(
+          CS, firstTyvar, element->getType()->castTo<TypeVariableType>());
+      }
+      return true;
+    }
+
     Type visitArrayExpr(ArrayExpr *expr) {
       // An array expression can be of a type T that conforms to the
       // ArrayLiteralConvertible protocol.
@@ -1832,7 +2035,19 @@ namespace {
         CS.addConstraint(ConstraintKind::ConformsTo, contextualType,
                          arrayProto->getDeclaredType(),
                          locator);
-        
+
+        // If all of the elements share one type variable, a single
+        // conversion covers all of them.
+        if (mergeHomogeneousLiteralElements(expr->getElements())) {
+          CS.addConstraint(ConstraintKind::Conversion,
+                           expr->getElements().front()->getType(),
+                           contextualArrayElementType,
+                           CS.getConstraintLocator(expr,
+                                                   LocatorPathElt::
+                                                     getTupleElement(0)));
+          return contextualArrayType;
+        }
+
         unsigned index = 0;
         for (auto element : expr->getElements()) {
           CS.addConstraint(ConstraintKind::Conversion,
@@ -1863,6 +2078,18 @@ namespace {
                                                ConstraintLocator::Member),
                                              /*options=*/0);
 
+      // If all of the elements share one type variable, a single conversion
+      // covers all of them.
+      if (mergeHomogeneousLiteralElements(expr->getElements())) {
+        CS.addConstraint(ConstraintKind::Conversion,
+                         expr->getElements().front()->getType(),
+                         arrayElementTy,
+                         CS.getConstraintLocator(
+                           expr,
+                           LocatorPathElt::getTupleElement(0)));
+        return arrayTy;
+      }
+
       // Introduce conversions from each element to the element type of the
       // array.
       unsigned index = 0;
@@ -1940,47 +2167,52 @@ namespace {
 
       // If no contextual type is present, Merge equivalence classes of key 
       // and value types as necessary.
+      //
+      // Merging is transitive, so rather than merging every pair of elements,
+      // merge all keys into the first key and each value into the first value
+      // of the same kind. The element with that first value keeps its
+      // conversion; any later element whose key and value type variables
+      // both end up in its classes can skip its own.
       if (!CS.getContextualType(expr)) {
-        for (auto element1 : expr->getElements()) {
-          for (auto element2 : expr->getElements()) {
-            if (element1 == element2)
-              continue;
-
-            auto tty1 = element1->getType()->getAs<TupleType>();
-            auto tty2 = element2->getType()->getAs<TupleType>();
-
-            if (tty1 && tty2) {
-              auto mergedKey = false;
-              auto mergedValue = false;
-
-              auto keyTyvar1 = tty1->getElementTypes()[0]->
-                                getAs<TypeVariableType>();
-              auto keyTyvar2 = tty2->getElementTypes()[0]->
-                                getAs<TypeVariableType>();
-
-              mergedKey = mergeRepresentativeEquivalenceClasses(CS, 
-                            keyTyvar1, keyTyvar2);
-
-              auto valueTyvar1 = tty1->getElementTypes()[1]->
-                                  getAs<TypeVariableType>();
-              auto valueTyvar2 = tty2->getElementTypes()[1]->
-                                  getAs<TypeVariableType>();
-
-              auto elemExpr1 = dyn_cast<TupleExpr>(element1)->getElements()[1];
-              auto elemExpr2 = dyn_cast<TupleExpr>(element2)->getElements()[1];
-
-              if (elemExpr1->getKind() == elemExpr2->getKind() &&
-                isMergeableValueKind(elemExpr1)) {
-                mergedValue = mergeRepresentativeEquivalenceClasses(CS, 
-                                valueTyvar1, valueTyvar2);
-              }
-
-              if (mergedKey && mergedValue)
-                mergedElements.insert(element2);
-            }
-          }
+        TypeVariableType *firstKeyTyvar = nullptr;
+        llvm::SmallDenseMap<unsigned, TupleType *, 4> firstOfValueKind;
+        for (auto element : expr->getElements()) {
+          auto tty = element->getType()->getAs<TupleType>();
+          auto tupleExpr = dyn_cast<TupleExpr>(element);
+          if (!tty || !tupleExpr)
+            continue;
+
+          auto keyTyvar = tty->getElementTypes()[0]->getAs<TypeVariableType>();
+          if (!firstKeyTyvar)
+            firstKeyTyvar = keyTyvar;
+          mergeRepresentativeEquivalenceClasses(CS, firstKeyTyvar, keyTyvar);
+
+          auto valueExpr = tupleExpr->getElements()[1];
+          if (!isMergeableValueKind(valueExpr))
+            continue;
+          auto valueKind = static_cast<unsigned>(valueExpr->getKind());
+          auto inserted = firstOfValueKind.insert({valueKind, tty});
+          if (inserted.second)
+            continue;
+
+          auto firstTTy = inserted.first->second;
+          auto valueTyvar =
+            tty->getElementTypes()[1]->getAs<TypeVariableType>();
+          auto firstValueTyvar =
+            firstTTy->getElementTypes()[1]->getAs<TypeVariableType>();
+          mergeRepresentativeEquivalenceClasses(CS, firstValueTyvar,
+                                                valueTyvar);
+
+          auto firstElemKeyTyvar =
+            firstTTy->getElementTypes()[0]->getAs<TypeVariableType>();
+          if (keyTyvar && firstElemKeyTyvar && valueTyvar && firstValueTyvar &&
+              CS.getRepresentative(keyTyvar) ==
+                CS.getRepresentative(firstElemKeyTyvar) &&
+              CS.getRepresentative(valueTyvar) ==
+                CS.getRepresentative(firstValueTyvar))
+            mergedElements.insert(element);
         }
-      }      
+      }
 
       // Introduce conversions from each element to the element type of the
       // dictionary. (If the equivalence class of an element has already been
@@ -15,9 +15,12 @@
 //===----------------------------------------------------------------------===//
 #include "ConstraintSystem.h"
 #include "ConstraintGraph.h"
+#include "swift/Basic/Statistic.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include <algorithm>
 #include <memory>
 #include <tuple>
 using namespace swift;
@@ -251,6 +254,66 @@ void ConstraintSystem::applySolution(const Solution &solution) {
   Fixes.append(solution.Fixes.begin(), solution.Fixes.end());
 }
 
+Solution ConstraintSystem::extractComponentSolution(const Solution &solution) {
+  Solution result(*this, solution.getFixedScore());
+
+  // Type variables which are already bound were not bound by the component.
+  for (auto binding : solution.typeBindings) {
+    if (!getFixedType(binding.first))
+      result.typeBindings.insert(binding);
+  }
+
+  llvm::SmallPtrSet<ConstraintLocator *, 8> knownLocators;
+  for (auto resolved = resolvedOverloadSets;
+       resolved; resolved = resolved->Previous)
+    knownLocators.insert(resolved->Locator);
+  for (auto &overload : solution.overloadChoices) {
+    if (!knownLocators.count(overload.first))
+      result.overloadChoices.insert(overload);
+  }
+
+  llvm::DenseSet<std::pair<CanType, CanType>> knownRestrictions;
+  for (auto &restriction : ConstraintRestrictions) {
+    using std::get;
+    knownRestrictions.insert(
+        {simplifyType(get<0>(restriction))->getCanonicalType(),
+         simplifyType(get<1>(restriction))->getCanonicalType()});
+  }
+  for (auto &restriction : solution.ConstraintRestrictions) {
+    if (!knownRestrictions.count(restriction.first))
+      result.ConstraintRestrictions.insert(restriction);
+  }
+
+  // The fixes of a partial solution are already limited to its own.
+  result.Fixes.append(solution.Fixes.begin(), solution.Fixes.end());
+
+  knownLocators.clear();
+  for (auto &choice : DisjunctionChoices)
+    knownLocators.insert(choice.first);
+  for (auto &choice : solution.DisjunctionChoices) {
+    if (!knownLocators.count(choice.first))
+      result.DisjunctionChoices.insert(choice);
+  }
+
+  knownLocators.clear();
+  for (auto &opened : OpenedTypes)
+    knownLocators.insert(opened.first);
+  for (auto &opened : solution.OpenedTypes) {
+    if (!knownLocators.count(opened.first))
+      result.OpenedTypes.insert(opened);
+  }
+
+  knownLocators.clear();
+  for (auto &openedExistential : OpenedExistentialTypes)
+    knownLocators.insert(openedExistential.first);
+  for (auto &openedExistential : solution.OpenedExistentialTypes) {
+    if (!knownLocators.count(openedExistential.first))
+      result.OpenedExistentialTypes.insert(openedExistential);
+  }
+
+  return result;
+}
+
 /// \brief Restore the type variable bindings to what they were before
 /// we attempted to solve this constraint system.
 void ConstraintSystem::restoreTypeVariableBindings(unsigned numBindings) {
@@ -395,6 +458,10 @@ ConstraintSystem::SolverState::SolverState(ConstraintSystem &cs) : CS(cs) {
   ++NumSolutionAttempts;
   SolutionAttempt = NumSolutionAttempts;
 
+  // Account for the disjunction terms pruned before solving started.
+  NumDisjunctionTermsPruned = CS.NumPrunedDisjunctionTerms;
+  CS.NumPrunedDisjunctionTerms = 0;
+
   // If we're supposed to debug a specific constraint solver attempt,
   // turn on debugging now.
   ASTContext &ctx = CS.getTypeChecker().Context;
@@ -414,9 +481,20 @@ ConstraintSystem::SolverState::~SolverState() {
   LangOptions &langOpts = CS.getTypeChecker().Context.LangOpts;
   langOpts.DebugConstraintSolver = OldDebugConstraintSolver;
 
-  // Write our local statistics back to the overall statistics.
+  // Write our local statistics back to the overall statistics, and to the
+  // statistics of the constraint system.
   #define CS_STATISTIC(Name, Description) JOIN2(Overall,Name) += Name;
   #include "ConstraintSolverStats.def"
+  #define CS_STATISTIC(Name, Description) CS.solverStats.Name += Name;
+  #include "ConstraintSolverStats.def"
+
+  // And to the statistics of this compilation job, if we collect them.
+  if (auto *Stats = CS.getTypeChecker().Context.Stats) {
+    auto &Counters = Stats->getFrontendCounters();
+    ++Counters.NumSolutionAttempts;
+    #define CS_STATISTIC(Name, Description) Counters.Name += Name;
+    #include "ConstraintSolverStats.def"
+  }
 
   // Update the "largest" statistics if this system is larger than the
   // previous one.  
@@ -431,6 +509,33 @@ ConstraintSystem::SolverState::~SolverState() {
   }
 }
 
+bool ConstraintSystem::SolverState::SolvedComponent::isSameState(
+    const SolvedComponent &other) const {
+  if (RecordFixes != other.RecordFixes ||
+      AllowFreeTypeVariables != other.AllowFreeTypeVariables)
+    return false;
+  if (!(CurrentScore == other.CurrentScore))
+    return false;
+  if (BestScore.hasValue() != other.BestScore.hasValue() ||
+      (BestScore && !(*BestScore == *other.BestScore)))
+    return false;
+  return Constraints == other.Constraints && TypeVars == other.TypeVars;
+}
+
+ConstraintSystem::SolverState::SolvedComponent *
+ConstraintSystem::SolverState::findSolvedComponent(
+    const SolvedComponent &key) {
+  auto known = SolvedComponents.find(key.Constraints.front());
+  if (known == SolvedComponents.end())
+    return nullptr;
+
+  for (auto &solved : known->second) {
+    if (solved.isSameState(key))
+      return &solved;
+  }
+  return nullptr;
+}
+
 ConstraintSystem::SolverScope::SolverScope(ConstraintSystem &cs)
   : cs(cs), CGScope(cs.CG)
 {
@@ -1343,9 +1448,12 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
   // owning component.
   llvm::DenseMap<TypeVariableType *, unsigned> typeVarComponent;
   llvm::DenseMap<Constraint *, unsigned> constraintComponent;
+  std::unique_ptr<SmallVector<TypeVariableType *, 4>[]> componentTypeVars(
+      new SmallVector<TypeVariableType *, 4>[numComponents]);
   for (unsigned i = 0, n = typeVars.size(); i != n; ++i) {
     // Record the component of this type variable.
     typeVarComponent[typeVars[i]] = components[i];
+    componentTypeVars[components[i]].push_back(typeVars[i]);
 
     // Record the component of each of the constraints.
     for (auto constraint : CG[typeVars[i]].getConstraints())
@@ -1398,7 +1506,54 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
 
       TypeVariables.push_back(typeVar);
     }
-    
+
+    // Describe the state this component is solved in. If the component was
+    // solved in the same state along an earlier path, reuse its partial
+    // solutions instead of solving it again.
+    SolverState::SolvedComponent solved;
+    for (auto &constraint : InactiveConstraints) {
+      solved.Constraints.push_back(&constraint);
+      for (auto typeVar : constraint.getTypeVariables())
+        solved.TypeVars.push_back({typeVar,
+                                   simplifyType(typeVar).getPointer()});
+    }
+    for (auto typeVar : componentTypeVars[component])
+      solved.TypeVars.push_back({typeVar, simplifyType(typeVar).getPointer()});
+    std::sort(solved.Constraints.begin(), solved.Constraints.end());
+    std::sort(solved.TypeVars.begin(), solved.TypeVars.end());
+    solved.TypeVars.erase(std::unique(solved.TypeVars.begin(),
+                                      solved.TypeVars.end()),
+                          solved.TypeVars.end());
+    solved.CurrentScore = CurrentScore;
+    solved.BestScore = solverState->BestScore;
+    solved.RecordFixes = solverState->recordFixes;
+    solved.AllowFreeTypeVariables = allowFreeTypeVariables;
+
+    if (!solved.Constraints.empty()) {
+      if (auto known = solverState->findSolvedComponent(solved)) {
+        ++solverState->NumComponentsReused;
+        if (TC.getLangOpts().DebugConstraintSolver) {
+          auto &log = getASTContext().TypeCheckerDebug->getStream();
+          log.indent(solverState->depth * 2) << "(reusing component #"
+                                             << component << ")\n";
+        }
+
+        auto &bucket = constraintBuckets[component];
+        bucket.splice(bucket.end(), InactiveConstraints);
+        TypeVariables = std::move(allTypeVariables);
+        if (known->Solutions.empty()) {
+          returnAllConstraints();
+          return true;
+        }
+
+        for (auto &solution : known->Solutions) {
+          partialSolutions[component].push_back(
+              extractComponentSolution(solution));
+        }
+        continue;
+      }
+    }
+
     // Solve for this component. If it fails, we're done.
     bool failed;
     if (TC.getLangOpts().DebugConstraintSolver) {
@@ -1428,6 +1583,11 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
       }
       
       TypeVariables = std::move(allTypeVariables);
+      if (!solved.Constraints.empty()) {
+        auto firstConstraint = solved.Constraints.front();
+        solverState->SolvedComponents[firstConstraint].push_back(
+            std::move(solved));
+      }
       returnAllConstraints();
       return true;
     }
@@ -1449,6 +1609,16 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
     for (auto &solution : partialSolutions[component])
       solution.getFixedScore() -= CurrentScore;
 
+    // Remember the partial solutions for other paths reaching this
+    // component in the same state.
+    if (!solved.Constraints.empty()) {
+      for (auto &solution : partialSolutions[component])
+        solved.Solutions.push_back(extractComponentSolution(solution));
+      auto firstConstraint = solved.Constraints.front();
+      solverState->SolvedComponents[firstConstraint].push_back(
+          std::move(solved));
+    }
+
     // Restore the previous best score.
     solverState->BestScore = PreviousBestScore;
   }
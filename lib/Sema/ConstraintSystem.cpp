@@ -18,6 +18,7 @@
 #include "ConstraintSystem.h"
 #include "ConstraintGraph.h"
 #include "swift/AST/ArchetypeBuilder.h"
+#include "swift/Basic/Statistic.h"
 #include "llvm/ADT/SmallString.h"
 
 using namespace swift;
@@ -32,12 +33,28 @@ ConstraintSystem::ConstraintSystem(TypeChecker &tc, DeclContext *dc,
                                  ConstraintLocatorBuilder(nullptr),
                                  /*options=*/0);
           }),
+    EnclosingSystem(tc.InnermostConstraintSystem),
     CG(*new ConstraintGraph(*this))
 {
   assert(DC && "context required");
+  tc.InnermostConstraintSystem = this;
 }
 
 ConstraintSystem::~ConstraintSystem() {
+  // The enclosing systems don't allocate while this one is alive, so the
+  // memory in use peaks when the innermost system goes away.
+  if (auto *Stats = TC.Context.Stats) {
+    size_t Bytes = 0;
+    for (auto *CS = this; CS; CS = CS->EnclosingSystem)
+      Bytes += CS->Allocator.getTotalMemory();
+    auto &Counters = Stats->getFrontendCounters();
+    Counters.ConstraintSolverPeakBytes =
+      std::max(Counters.ConstraintSolverPeakBytes, Bytes);
+  }
+
+  assert(TC.InnermostConstraintSystem == this &&
+         "constraint systems destroyed out of order");
+  TC.InnermostConstraintSystem = EnclosingSystem;
   delete &CG;
 }
 
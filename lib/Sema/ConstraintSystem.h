@@ -904,6 +904,9 @@ private:
   /// allocations.
   ConstraintCheckerArenaRAII Arena;
 
+  /// The constraint system which was alive when this one was created.
+  ConstraintSystem *EnclosingSystem;
+
   /// \brief Counter for type variables introduced.
   unsigned TypeCounter = 0;
   
@@ -1029,6 +1032,39 @@ private:
     /// Refers to the innermost partial solution scope.
     SolverScope *PartialSolutionScope = nullptr;
 
+    /// A connected component of the constraint graph which was solved along
+    /// some path, together with the state it was solved in.
+    ///
+    /// A component does not interact with the rest of the system, so solving
+    /// it again in the same state produces the same partial solutions.
+    struct SolvedComponent {
+      /// The constraints of the component, sorted by address.
+      SmallVector<Constraint *, 8> Constraints;
+
+      /// The type variables of the component and those referenced by its
+      /// constraints, sorted and paired with their simplified types.
+      SmallVector<std::pair<TypeVariableType *, TypeBase *>, 8> TypeVars;
+
+      Score CurrentScore;
+      Optional<Score> BestScore;
+      bool RecordFixes;
+      FreeTypeVariableBinding AllowFreeTypeVariables;
+
+      /// The partial solutions of the component, limited to what was decided
+      /// within the component. Empty if the component has no solution.
+      SmallVector<Solution, 4> Solutions;
+
+      /// Whether \p other describes the same component in the same state.
+      bool isSameState(const SolvedComponent &other) const;
+    };
+
+    /// The components solved so far, indexed by their first constraint.
+    llvm::DenseMap<Constraint *, std::vector<SolvedComponent>>
+      SolvedComponents;
+
+    /// Find a component which was solved in the state described by \p key.
+    SolvedComponent *findSolvedComponent(const SolvedComponent &key);
+
     // Statistics
     #define CS_STATISTIC(Name, Description) unsigned Name = 0;
     #include "ConstraintSolverStats.def"
@@ -1042,6 +1078,18 @@ public:
   /// we're exploring. 
   SolverState *solverState = nullptr;
 
+  /// The statistics of all the solver runs on this constraint system.
+  struct SolverStatistics {
+    #define CS_STATISTIC(Name, Description) unsigned Name = 0;
+    #include "ConstraintSolverStats.def"
+  };
+  SolverStatistics solverStats;
+
+  /// The number of disjunction terms removed while optimizing the generated
+  /// constraints. There is no solver state yet at that point, so the count
+  /// is handed over to the next solver state.
+  unsigned NumPrunedDisjunctionTerms = 0;
+
   struct ArgumentLabelState {
     ArrayRef<Identifier> Labels;
     bool HasTrailingClosure;
@@ -1162,6 +1210,13 @@ private:
   /// constraint system for further exploration.
   void applySolution(const Solution &solution);
 
+  /// \brief Copy the parts of the given partial solution which are not
+  /// already part of the current state of the constraint system.
+  ///
+  /// This is used to remember the partial solutions of a connected component
+  /// independently of the path which led to them.
+  Solution extractComponentSolution(const Solution &solution);
+
   /// Emit the fixes computed as part of the solution, returning true if we were
   /// able to emit an error message, or false if none of the fixits worked out.
   bool applySolutionFixes(Expr *E, const Solution &solution);
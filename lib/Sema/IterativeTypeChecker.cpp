@@ -21,6 +21,7 @@
 #include "swift/AST/Decl.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/Basic/Defer.h"
+#include "swift/Basic/Statistic.h"
 using namespace swift;
 
 ASTContext &IterativeTypeChecker::getASTContext() const {
@@ -66,8 +67,14 @@ bool IterativeTypeChecker::breakCycle(TypeCheckRequest request) {
 }
 
 void IterativeTypeChecker::satisfy(TypeCheckRequest request) {
+  auto *Stats = getASTContext().Stats;
+
   // If the request has already been satisfied, we're done.
-  if (isSatisfied(request)) return;
+  if (isSatisfied(request)) {
+    if (Stats)
+      Stats->getFrontendCounters().NumTypeCheckRequestsCached++;
+    return;
+  }
 
   // Check for circular dependencies in our requests.
   // FIXME: This stack operation is painfully inefficient.
@@ -90,6 +97,8 @@ void IterativeTypeChecker::satisfy(TypeCheckRequest request) {
     // Process this requirement, enumerating dependencies if anything else needs
     // to be handled first.
     SmallVector<TypeCheckRequest, 4> unsatisfied;
+    if (Stats)
+      Stats->getFrontendCounters().NumTypeCheckRequestsEvaluated++;
     process(request, [&](TypeCheckRequest dependency) -> bool {
       if (isSatisfied(dependency)) return false;
 
@@ -26,6 +26,7 @@
 #include "swift/AST/PrettyStackTrace.h"
 #include "swift/AST/TypeCheckerDebugConsumer.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Parse/Lexer.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/DenseMap.h"
@@ -35,8 +36,10 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Timer.h"
 #include <iterator>
 #include <map>
 #include <memory>
@@ -1211,6 +1214,69 @@ Expr *ExprTypeCheckListener::appliedSolution(Solution &solution, Expr *expr) {
   return expr;
 }
 
+namespace {
+  /// Measures the time and the solver work it takes to solve the constraint
+  /// system of one expression, for -debug-time-expression-type-checking and
+  /// -warn-long-expression-type-checking. The work of expressions which are
+  /// solved while diagnosing this one is included.
+  class ExpressionTimer {
+    ConstraintSystem &CS;
+    SourceRange Range;
+    llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime();
+    unsigned WarnLimit;
+    bool ShouldDump;
+
+  public:
+    ExpressionTimer(ConstraintSystem &CS, Expr *E, bool shouldDump,
+                    unsigned warnLimit)
+        : CS(CS), Range(E->getSourceRange()), WarnLimit(warnLimit),
+          ShouldDump(shouldDump) {}
+
+    ~ExpressionTimer() {
+      llvm::TimeRecord endTime = llvm::TimeRecord::getCurrentTime(false);
+
+      auto elapsed = endTime.getProcessTime() - StartTime.getProcessTime();
+      unsigned elapsedMS = static_cast<unsigned>(elapsed * 1000);
+
+      ASTContext &ctx = CS.getASTContext();
+      auto &stats = CS.solverStats;
+
+      if (ShouldDump) {
+        std::string rangeStr;
+        if (Range.isValid()) {
+          llvm::raw_string_ostream rangeOS(rangeStr);
+          Range.Start.print(rangeOS, ctx.SourceMgr);
+          rangeOS << "-";
+          Range.End.printLineAndColumn(rangeOS, ctx.SourceMgr);
+        } else {
+          rangeStr = "<invalid loc>";
+        }
+
+        llvm::errs() << llvm::format("%0.1f", elapsed * 1000) << "ms\t"
+                     << rangeStr << "\t" << stats.NumStatesExplored
+                     << " states\t" << stats.NumDisjunctions
+                     << " disjunctions\n";
+
+        if (auto *reporter = ctx.Stats) {
+          UnifiedStatsReporter::ExpressionProfile profile;
+          profile.Range = std::move(rangeStr);
+          profile.Milliseconds = elapsed * 1000;
+          #define CS_STATISTIC(Name, Description) \
+            profile.Counters.push_back({ #Name, stats.Name });
+          #include "ConstraintSolverStats.def"
+          reporter->recordExpressionProfile(std::move(profile));
+        }
+      }
+
+      if (WarnLimit != 0 && elapsedMS >= WarnLimit && Range.isValid()) {
+        ctx.Diags.diagnose(Range.Start, diag::debug_long_expression,
+                           elapsedMS, WarnLimit)
+          .highlight(Range);
+      }
+    }
+  };
+}
+
 bool TypeChecker::
 solveForExpression(Expr *&expr, DeclContext *dc, Type convertType,
                    FreeTypeVariableBinding allowFreeTypeVariables,
@@ -1223,6 +1289,11 @@ solveForExpression(Expr *&expr, DeclContext *dc, Type convertType,
   if (preCheckExpression(*this, expr, dc))
     return true;
 
+  Optional<ExpressionTimer> timer;
+  if (DebugTimeExpressions || WarnLongExpressionTypeChecking)
+    timer.emplace(cs, expr, DebugTimeExpressions,
+                  WarnLongExpressionTypeChecking);
+
   if (auto generatedExpr = cs.generateConstraints(expr))
     expr = generatedExpr;
   else {
@@ -36,6 +36,7 @@
 #include "swift/Serialization/SerializedModuleLoader.h"
 #include "swift/Strings.h"
 #include "swift/Basic/Defer.h"
+#include "swift/Basic/Statistic.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/APSInt.h"
@@ -6227,6 +6228,8 @@ bool TypeChecker::isAvailabilitySafeForConformance(
 
 void TypeChecker::typeCheckDecl(Decl *D, bool isFirstPass) {
   PrettyStackTraceDecl StackTrace("type-checking", D);
+  StatsTraceScope Trace(Context.Stats, "type-check-decl");
+  setTraceEventName(Trace, D);
   checkForForbiddenPrefix(D);
   bool isSecondPass =
     !isFirstPass && D->getDeclContext()->isModuleScopeContext();
@@ -26,6 +26,7 @@
 #include "swift/Basic/Range.h"
 #include "swift/Basic/STLExtras.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Parse/Lexer.h"
 #include "swift/Parse/LocalContext.h"
 #include "llvm/ADT/DenseMap.h"
@@ -1248,13 +1249,38 @@ bool TypeChecker::typeCheckAbstractFunctionBodyUntil(AbstractFunctionDecl *AFD,
   return typeCheckDestructorBodyUntil(DD, EndTypeCheckLoc);
 }
 
+/// Determine whether the body of \p AFD is not needed for the module because
+/// it is never serialized.
+///
+/// Constructors and destructors are always emitted with their bodies, and
+/// local functions may be captured, so only non-local functions are skipped.
+static bool isNonInlinableFunctionBody(AbstractFunctionDecl *AFD) {
+  auto FD = dyn_cast<FuncDecl>(AFD);
+  if (!FD || FD->isImplicit() || FD->getDeclContext()->isLocalContext())
+    return false;
+  return FD->getResilienceExpansion() == ResilienceExpansion::Maximal;
+}
+
 bool TypeChecker::typeCheckAbstractFunctionBody(AbstractFunctionDecl *AFD) {
   if (!AFD->getBody())
     return false;
 
+  if (SkipNonInlinableFunctionBodies && isNonInlinableFunctionBody(AFD)) {
+    // Default argument generators are still emitted into the module.
+    unsigned nextArgIndex = 0;
+    for (auto paramList : AFD->getParameterLists())
+      checkDefaultArguments(*this, paramList, nextArgIndex, AFD);
+
+    AFD->setBodySkipped(AFD->getBodySourceRange());
+    AFD->getCaptureInfo().setCaptures({});
+    return false;
+  }
+
   Optional<FunctionBodyTimer> timer;
   if (DebugTimeFunctionBodies || WarnLongFunctionBodies)
     timer.emplace(AFD, DebugTimeFunctionBodies, WarnLongFunctionBodies);
+  StatsTraceScope Trace(Context.Stats, "type-check-body");
+  setTraceEventName(Trace, AFD);
 
   if (typeCheckAbstractFunctionBodyUntil(AFD, SourceLoc()))
     return true;
@@ -27,6 +27,7 @@
 #include "swift/AST/PrettyStackTrace.h"
 #include "swift/AST/TypeRefinementContext.h"
 #include "swift/Basic/STLExtras.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/Timer.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Parse/Lexer.h"
@@ -397,6 +398,14 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
     // Type check the body of each of the function in turn.  Note that outside
     // functions must be visited before nested functions for type-checking to
     // work correctly.
+    //
+    // FIXME: Most bodies are independent of each other, but they cannot be
+    // checked concurrently yet. Checking a body lazily validates the
+    // declarations and conformances it references, enqueues new functions
+    // and external definitions here, and mutates shared caches of the
+    // ASTContext and the TypeChecker (name lookup, conformances,
+    // specializations), none of which is synchronized. Diagnostics are also
+    // emitted directly rather than buffered per body.
     for (unsigned n = TC.definedFunctions.size(); currentFunctionIdx != n;
          ++currentFunctionIdx) {
       auto *AFD = TC.definedFunctions[currentFunctionIdx];
@@ -492,6 +501,13 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
     }
 
     // Complete any conformances that we used.
+    //
+    // This includes conformances declared in other files of the module,
+    // because SIL optimizations look up their witnesses after type checking.
+    // FIXME: Every frontend job repeats this for the conformances it uses.
+    // Their results cannot come from the partial modules of other jobs,
+    // which run concurrently and are only merged afterwards; jobs checking
+    // several primary files share them through the ASTContext instead.
     for (unsigned i = 0; i != TC.UsedConformances.size(); ++i) {
       auto conformance = TC.UsedConformances[i];
       if (conformance->isIncomplete())
@@ -527,6 +543,20 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
   }
 }
 
+void swift::setTraceEventName(StatsTraceScope &Trace, const Decl *D) {
+  if (!Trace.isActive())
+    return;
+  StringRef Kind = Decl::getDescriptiveKindName(D->getDescriptiveKind());
+  Trace.setDetail(Kind);
+  if (auto *VD = dyn_cast<ValueDecl>(D)) {
+    std::string Name;
+    llvm::raw_string_ostream(Name) << VD->getFullName();
+    Trace.setName(Name);
+  } else {
+    Trace.setName(Kind);
+  }
+}
+
 void swift::typeCheckExternalDefinitions(SourceFile &SF) {
   assert(SF.ASTStage == SourceFile::TypeChecked);
   auto &Ctx = SF.getASTContext();
@@ -537,7 +567,8 @@ void swift::typeCheckExternalDefinitions(SourceFile &SF) {
 void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
                                 OptionSet<TypeCheckingFlags> Options,
                                 unsigned StartElem,
-                                unsigned WarnLongFunctionBodies) {
+                                unsigned WarnLongFunctionBodies,
+                                unsigned WarnLongExpressionTypeChecking) {
   if (SF.ASTStage == SourceFile::TypeChecked)
     return;
 
@@ -559,8 +590,15 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
     if (Options.contains(TypeCheckingFlags::DebugTimeFunctionBodies))
       TC.enableDebugTimeFunctionBodies();
 
+    TC.setWarnLongExpressionTypeChecking(WarnLongExpressionTypeChecking);
+    if (Options.contains(TypeCheckingFlags::DebugTimeExpressionTypeChecking))
+      TC.enableDebugTimeExpressions();
+
     if (Options.contains(TypeCheckingFlags::ForImmediateMode))
       TC.setInImmediateMode(true);
+
+    if (Options.contains(TypeCheckingFlags::SkipNonInlinableFunctionBodies))
+      TC.enableSkipNonInlinableFunctionBodies();
     
     // Lookup the swift module.  This ensures that we record all known
     // protocols in the AST.
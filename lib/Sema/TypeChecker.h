@@ -39,6 +39,7 @@ class ArchetypeBuilder;
 class GenericTypeResolver;
 class NominalTypeDecl;
 class NormalProtocolConformance;
+class StatsTraceScope;
 class TopLevelContext;
 class TypeChecker;
 
@@ -476,6 +477,11 @@ public:
   // flag is set to 'true' once the bridge functions have been checked.
   bool HasCheckedBridgeFunctions = false;
 
+  /// The innermost constraint system which is alive, if any. Constraint
+  /// systems nest when closure bodies are type-checked while the solution of
+  /// the enclosing expression is applied.
+  constraints::ConstraintSystem *InnermostConstraintSystem = nullptr;
+
   /// A list of closures for the most recently type-checked function, which we
   /// will need to compute captures for.
   std::vector<AnyFunctionRef> ClosuresWithUncomputedCaptures;
@@ -609,11 +615,26 @@ private:
   /// to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If non-zero, warn when an expression takes longer than this many
+  /// milliseconds to type-check.
+  ///
+  /// Intended for debugging purposes only.
+  unsigned WarnLongExpressionTypeChecking = 0;
+
+  /// If true, the time and solver work it takes to type-check each
+  /// expression will be dumped to llvm::errs(), and recorded by the
+  /// statistics reporter, if any.
+  bool DebugTimeExpressions = false;
+
   /// Indicate that the type checker is checking code that will be
   /// immediately executed. This will suppress certain warnings
   /// when executing scripts.
   bool InImmediateMode = false;
 
+  /// If true, the bodies of functions which cannot be inlined into other
+  /// modules are skipped instead of type-checked.
+  bool SkipNonInlinableFunctionBodies = false;
+
   /// A helper to construct and typecheck call to super.init().
   ///
   /// \returns NULL if the constructed expression does not typecheck.
@@ -639,6 +660,25 @@ public:
     WarnLongFunctionBodies = timeInMS;
   }
 
+  /// Dump the time it takes to type-check each expression to llvm::errs().
+  void enableDebugTimeExpressions() {
+    DebugTimeExpressions = true;
+  }
+
+  /// Skip the bodies of functions which cannot be inlined into other
+  /// modules, for when only a module is emitted.
+  void enableSkipNonInlinableFunctionBodies() {
+    SkipNonInlinableFunctionBodies = true;
+  }
+
+  /// If \p timeInMS is non-zero, warn when an expression takes longer than
+  /// this many milliseconds to type-check.
+  ///
+  /// Intended for debugging purposes only.
+  void setWarnLongExpressionTypeChecking(unsigned timeInMS) {
+    WarnLongExpressionTypeChecking = timeInMS;
+  }
+
   bool getInImmediateMode() {
     return InImmediateMode;
   }
@@ -1977,6 +2017,9 @@ public:
   }
 };
 
+/// Name the trace event of \p Trace after \p D, if it is recorded.
+void setTraceEventName(StatsTraceScope &Trace, const Decl *D);
+
 /// Temporary on-stack storage and unescaping for encoded diagnostic
 /// messages.
 ///
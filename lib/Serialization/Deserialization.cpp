@@ -16,6 +16,7 @@
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/ForeignErrorConvention.h"
 #include "swift/AST/PrettyStackTrace.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Parse/Parser.h"
 #include "swift/Serialization/BCReadingExtras.h"
@@ -1412,7 +1413,7 @@ Identifier ModuleFile::getIdentifier(IdentifierID IID) {
 
   size_t rawID = IID - NUM_SPECIAL_MODULES;
   assert(rawID < Identifiers.size() && "invalid identifier ID");
-  auto identRecord = Identifiers[rawID];
+  auto &identRecord = Identifiers[rawID];
 
   if (identRecord.Offset == 0)
     return identRecord.Ident;
@@ -1424,7 +1425,12 @@ Identifier ModuleFile::getIdentifier(IdentifierID IID) {
   assert(terminatorOffset != StringRef::npos &&
          "unterminated identifier string data");
 
-  return getContext().getIdentifier(rawStrPtr.slice(0, terminatorOffset));
+  // Remember the identifier, so that later references don't look up the
+  // string in the ASTContext again.
+  identRecord.Ident =
+      getContext().getIdentifier(rawStrPtr.slice(0, terminatorOffset));
+  identRecord.Offset = 0;
+  return identRecord.Ident;
 }
 
 DeclContext *ModuleFile::getLocalDeclContext(DeclContextID DCID) {
@@ -1824,6 +1830,11 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
   if (declOrOffset.isComplete())
     return declOrOffset;
 
+  if (auto *Stats = getContext().Stats)
+    Stats->getFrontendCounters().NumDeclsDeserialized++;
+  ASTContext::AllocationOriginRAII allocationOrigin(
+      getContext(), AllocationOrigin::Deserialization);
+
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(declOrOffset);
   auto entry = DeclTypeCursor.advance();
@@ -2319,6 +2330,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theStruct, rawInheritedIDs);
 
     theStruct->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    NamedMemberContexts[theStruct] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theStruct->setConformanceLoader(
       this,
@@ -2911,6 +2923,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theClass, rawInheritedIDs);
 
     theClass->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    NamedMemberContexts[theClass] = DID;
     theClass->setHasDestructor();
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theClass->setConformanceLoader(
@@ -2978,6 +2991,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theEnum, rawInheritedIDs);
 
     theEnum->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    NamedMemberContexts[theEnum] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theEnum->setConformanceLoader(
       this,
@@ -3173,6 +3187,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     }
 
     extension->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    NamedMemberContexts[extension] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     extension->setConformanceLoader(
       this,
@@ -3350,6 +3365,11 @@ Type ModuleFile::getType(TypeID TID) {
   if (typeOrOffset.isComplete())
     return typeOrOffset;
 
+  if (auto *Stats = getContext().Stats)
+    Stats->getFrontendCounters().NumTypesDeserialized++;
+  ASTContext::AllocationOriginRAII allocationOrigin(
+      getContext(), AllocationOrigin::Deserialization);
+
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(typeOrOffset);
   auto entry = DeclTypeCursor.advance();
@@ -4104,6 +4124,34 @@ void ModuleFile::loadAllMembers(Decl *D, uint64_t contextData) {
   }
 }
 
+bool ModuleFile::loadNamedMembers(const IterableDeclContext *IDC,
+                                  Identifier name, uint64_t contextData,
+                                  SmallVectorImpl<ValueDecl *> &members) {
+  if (!DeclMemberNames)
+    return true;
+
+  // Protocols also read their default witness table along with their members,
+  // so they are never registered here.
+  auto knownID = NamedMemberContexts.find(IDC);
+  if (knownID == NamedMemberContexts.end())
+    return true;
+
+  if (auto *Stats = getContext().Stats)
+    Stats->getFrontendCounters().NumNamedMemberLoads++;
+
+  auto iter = DeclMemberNames->find({knownID->second, name.str()});
+  if (iter == DeclMemberNames->end())
+    return false;
+
+  for (DeclID memberID : *iter) {
+    auto *member = cast_or_null<ValueDecl>(getDecl(memberID));
+    if (!member)
+      return true;
+    members.push_back(member);
+  }
+  return false;
+}
+
 void
 ModuleFile::loadAllConformances(const Decl *D, uint64_t contextData,
                           SmallVectorImpl<ProtocolConformance*> &conformances) {
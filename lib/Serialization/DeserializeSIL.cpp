@@ -97,6 +97,62 @@ public:
   }
 };
 
+/// Used to deserialize entries in the on-disk function summary hash table.
+class SILDeserializer::FuncSummaryTableInfo {
+public:
+  using internal_key_type = StringRef;
+  using external_key_type = StringRef;
+  using data_type = SILFunctionSummary;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type ID) { return ID; }
+
+  external_key_type GetExternalKey(internal_key_type ID) { return ID; }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    return StringRef(reinterpret_cast<const char *>(data), length);
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    assert(length >= 8 &&
+           "Expect effects, flags, body cost and the number of arguments.");
+    uint8_t globalEffects = *data++;
+    uint8_t flags = *data++;
+    uint32_t bodyCost = endian::readNext<uint32_t, little, unaligned>(data);
+    unsigned numArgs = endian::readNext<uint16_t, little, unaligned>(data);
+    assert(length == 8 + numArgs && "Expect one byte per argument.");
+
+    data_type result(numArgs);
+    result.setGlobalEffects(globalEffects & SILFunctionSummary::AllEffects);
+    result.setFlags(flags & SILFunctionSummary::AllFlags);
+    if (bodyCost != SILFunctionSummary::UnknownBodyCost)
+      result.setBodyCost(bodyCost);
+    for (unsigned i = 0; i != numArgs; ++i) {
+      uint8_t argBits = *data++;
+      auto &arg = result.getArgument(i);
+      arg.Effects = argBits & SILFunctionSummary::AllEffects;
+      arg.MayEscape = (argBits & 0x10) != 0;
+    }
+    return result;
+  }
+};
+
 SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
                                  SerializedSILLoader::Callback *callback)
     : MF(MF), SILMod(M), Callback(callback) {
@@ -112,11 +168,11 @@ SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
 
   llvm::BitstreamCursor cursor = SILIndexCursor;
   // We expect SIL_FUNC_NAMES first, then SIL_VTABLE_NAMES, then
-  // SIL_GLOBALVAR_NAMES, then SIL_WITNESS_TABLE_NAMES, and finally
-  // SIL_DEFAULT_WITNESS_TABLE_NAMES. But each one can be
-  // omitted if no entries exist in the module file.
+  // SIL_GLOBALVAR_NAMES, then SIL_WITNESS_TABLE_NAMES, then
+  // SIL_DEFAULT_WITNESS_TABLE_NAMES, and finally SIL_FUNC_SUMMARIES. But each
+  // one can be omitted if no entries exist in the module file.
   unsigned kind = 0;
-  while (kind != sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES) {
+  while (kind != sil_index_block::SIL_FUNC_SUMMARIES) {
     auto next = cursor.advance();
     if (next.Kind == llvm::BitstreamEntry::EndBlock)
       return;
@@ -131,11 +187,19 @@ SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
              kind == sil_index_block::SIL_VTABLE_NAMES ||
              kind == sil_index_block::SIL_GLOBALVAR_NAMES ||
              kind == sil_index_block::SIL_WITNESS_TABLE_NAMES ||
-             kind == sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES)) &&
+             kind == sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES ||
+             kind == sil_index_block::SIL_FUNC_SUMMARIES)) &&
          "Expect SIL_FUNC_NAMES, SIL_VTABLE_NAMES, SIL_GLOBALVAR_NAMES, \
-          SIL_WITNESS_TABLE_NAMES, or SIL_DEFAULT_WITNESS_TABLE_NAMES.");
+          SIL_WITNESS_TABLE_NAMES, SIL_DEFAULT_WITNESS_TABLE_NAMES, or \
+          SIL_FUNC_SUMMARIES.");
     (void)prevKind;
 
+    // The summary table is not followed by an offsets record.
+    if (kind == sil_index_block::SIL_FUNC_SUMMARIES) {
+      FuncSummaryTable = readFuncSummaryTable(scratch, blobData);
+      break;
+    }
+
     if (kind == sil_index_block::SIL_FUNC_NAMES)
       FuncTable = readFuncTable(scratch, blobData);
     else if (kind == sil_index_block::SIL_VTABLE_NAMES)
@@ -192,6 +256,18 @@ SILDeserializer::readFuncTable(ArrayRef<uint64_t> fields, StringRef blobData) {
                                                 base + sizeof(uint32_t), base));
 }
 
+std::unique_ptr<SILDeserializer::SerializedFuncSummaryTable>
+SILDeserializer::readFuncSummaryTable(ArrayRef<uint64_t> fields,
+                                      StringRef blobData) {
+  uint32_t tableOffset;
+  sil_index_block::ListLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedFuncSummaryTable>;
+  return OwnedTable(SerializedFuncSummaryTable::Create(
+      base + tableOffset, base + sizeof(uint32_t), base));
+}
+
 /// A high-level overview of how forward references work in serializer and
 /// deserializer:
 /// In serializer, we pre-assign a value ID in order, to each basic block
@@ -1824,6 +1900,16 @@ SILFunction *SILDeserializer::lookupSILFunction(SILFunction *InFunc) {
 /// Check for existence of a function with a given name and required linkage.
 /// This function is modeled after readSILFunction. But it does not
 /// create a SILFunction object.
+Optional<SILFunctionSummary>
+SILDeserializer::lookupFunctionSummary(StringRef Name) {
+  if (!FuncSummaryTable)
+    return None;
+  auto iter = FuncSummaryTable->find(Name);
+  if (iter == FuncSummaryTable->end())
+    return None;
+  return *iter;
+}
+
 bool SILDeserializer::hasSILFunction(StringRef Name,
                                      SILLinkage Linkage) {
   if (!FuncTable)
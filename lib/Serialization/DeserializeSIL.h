@@ -53,6 +53,12 @@ namespace swift {
     std::vector<ModuleFile::PartiallySerialized<SILDefaultWitnessTable *>>
     DefaultWitnessTables;
 
+    class FuncSummaryTableInfo;
+    using SerializedFuncSummaryTable =
+      llvm::OnDiskIterableChainedHashTable<FuncSummaryTableInfo>;
+
+    std::unique_ptr<SerializedFuncSummaryTable> FuncSummaryTable;
+
     /// A declaration will only
     llvm::DenseMap<NormalProtocolConformance *, SILWitnessTable *>
     ConformanceToWitnessTableMap;
@@ -89,6 +95,9 @@ namespace swift {
     std::unique_ptr<SerializedFuncTable>
     readFuncTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+    std::unique_ptr<SerializedFuncSummaryTable>
+    readFuncSummaryTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
     /// When an instruction or block argument is defined, this method is used to
     /// register it and update our symbol table.
     void setLocalValue(ValueBase *Value, serialization::ValueID Id);
@@ -118,6 +127,7 @@ public:
     SILFunction *lookupSILFunction(StringRef Name,
                                    bool declarationOnly = false);
     bool hasSILFunction(StringRef Name, SILLinkage Linkage);
+    Optional<SILFunctionSummary> lookupFunctionSummary(StringRef Name);
     SILVTable *lookupVTable(Identifier Name);
     SILWitnessTable *lookupWitnessTable(SILWitnessTable *wt);
     SILDefaultWitnessTable *
@@ -22,7 +22,9 @@
 #include "swift/Serialization/BCReadingExtras.h"
 #include "swift/Serialization/SerializedModuleLoader.h"
 
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -114,6 +116,9 @@ static bool readOptionsBlock(llvm::BitstreamCursor &cursor,
       options_block::ResilienceStrategyLayout::readRecord(scratch, Strategy);
       extendedInfo.setResilienceStrategy(ResilienceStrategy(Strategy));
       break;
+    case options_block::RESILIENCE_DOMAIN:
+      extendedInfo.setResilienceDomain(blobData);
+      break;
     default:
       // Unknown options record, possibly for use by a future version of the
       // module format.
@@ -204,6 +209,9 @@ validateControlBlock(llvm::BitstreamCursor &cursor,
     case control_block::TARGET:
       result.targetTriple = blobData;
       break;
+    case control_block::INTERFACE_HASH:
+      result.interfaceHash = blobData;
+      break;
     default:
       // Unknown metadata record, possibly for use by a future version of the
       // module format.
@@ -458,6 +466,78 @@ ModuleFile::readObjCMethodTable(ArrayRef<uint64_t> fields, StringRef blobData) {
                                              base + sizeof(uint32_t), base));
 }
 
+/// Used to deserialize entries in the on-disk member name table.
+class ModuleFile::DeclMemberNamesTableInfo {
+public:
+  using internal_key_type = std::pair<uint32_t, StringRef>;
+  using external_key_type = internal_key_type;
+  using data_type = SmallVector<DeclID, 2>;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type key) {
+    return key;
+  }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key.second, key.first);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    uint32_t parentID = endian::readNext<uint32_t, little, unaligned>(data);
+    return { parentID, StringRef(reinterpret_cast<const char *>(data),
+                                 length - sizeof(uint32_t)) };
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    data_type result;
+    while (length > 0) {
+      DeclID memberID = endian::readNext<uint32_t, little, unaligned>(data);
+      result.push_back(memberID);
+      length -= sizeof(uint32_t);
+    }
+
+    return result;
+  }
+};
+
+std::unique_ptr<ModuleFile::SerializedDeclMemberNamesTable>
+ModuleFile::readDeclMemberNamesTable(ArrayRef<uint64_t> fields,
+                                     StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::DeclMemberNamesLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedDeclMemberNamesTable>;
+  return OwnedTable(
+           SerializedDeclMemberNamesTable::Create(base + tableOffset,
+                                                  base + sizeof(uint32_t),
+                                                  base));
+}
+
+std::unique_ptr<ModuleFile::SerializedDeclTable>
+ModuleFile::readProtocolConformersTable(ArrayRef<uint64_t> fields,
+                                        StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::ProtocolConformersLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedDeclTable>;
+  return OwnedTable(SerializedDeclTable::Create(base + tableOffset,
+                                                base + sizeof(uint32_t), base));
+}
+
 bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
   cursor.EnterSubBlock(INDEX_BLOCK_ID);
 
@@ -534,6 +614,12 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
         assert(blobData.empty());
         NormalConformances.assign(scratch.begin(), scratch.end());
         break;
+      case index_block::DECL_MEMBER_NAMES:
+        DeclMemberNames = readDeclMemberNamesTable(scratch, blobData);
+        break;
+      case index_block::PROTOCOL_CONFORMERS:
+        ProtocolConformers = readProtocolConformersTable(scratch, blobData);
+        break;
 
       default:
         // Unknown index kind, which this version of the compiler won't use.
@@ -584,9 +670,10 @@ public:
     data_type result;
 
     {
+      unsigned BriefOffset =
+          endian::readNext<uint32_t, little, unaligned>(data);
       unsigned BriefSize = endian::readNext<uint32_t, little, unaligned>(data);
-      result.Brief = StringRef(reinterpret_cast<const char *>(data), BriefSize);
-      data += BriefSize;
+      result.Brief = F.getCommentText(BriefOffset, BriefSize);
     }
 
     unsigned NumComments = endian::readNext<uint32_t, little, unaligned>(data);
@@ -596,9 +683,9 @@ public:
     for (unsigned i = 0; i != NumComments; ++i) {
       unsigned StartColumn =
           endian::readNext<uint32_t, little, unaligned>(data);
+      unsigned RawOffset = endian::readNext<uint32_t, little, unaligned>(data);
       unsigned RawSize = endian::readNext<uint32_t, little, unaligned>(data);
-      auto RawText = StringRef(reinterpret_cast<const char *>(data), RawSize);
-      data += RawSize;
+      auto RawText = F.getCommentText(RawOffset, RawSize);
 
       new (&Comments[i]) SingleRawComment(RawText, StartColumn);
     }
@@ -637,6 +724,63 @@ ModuleFile::readGroupTable(ArrayRef<uint64_t> Fields, StringRef BlobData) {
   return pMap;
 }
 
+bool ModuleFile::readCommentTextBlocks(StringRef blobData) {
+  auto data = reinterpret_cast<const uint8_t *>(blobData.data());
+  auto end = data + blobData.size();
+  if (end - data < 4)
+    return false;
+  unsigned numBlocks = endian::readNext<uint32_t, little, unaligned>(data);
+  if (uint64_t(end - data) < uint64_t(numBlocks) * 8)
+    return false;
+
+  CommentTextBlocks.clear();
+  CommentTextBlocks.reserve(numBlocks);
+  uint32_t offset = 0;
+  auto stored = reinterpret_cast<const char *>(data + numBlocks * 8);
+  for (unsigned i = 0; i != numBlocks; ++i) {
+    uint32_t size = endian::readNext<uint32_t, little, unaligned>(data);
+    uint32_t storedSize = endian::readNext<uint32_t, little, unaligned>(data);
+    if (uint64_t(reinterpret_cast<const char *>(end) - stored) < storedSize)
+      return false;
+    CommentTextBlocks.push_back({offset, size, StringRef(stored, storedSize),
+                                 StringRef()});
+    offset += size;
+    stored += storedSize;
+  }
+  return true;
+}
+
+StringRef ModuleFile::getCommentText(uint32_t offset, uint32_t size) {
+  if (size == 0)
+    return StringRef();
+
+  auto iter = std::upper_bound(
+      CommentTextBlocks.begin(), CommentTextBlocks.end(), offset,
+      [](uint32_t offset, const CommentTextBlock &block) {
+        return offset < block.Offset;
+      });
+  if (iter == CommentTextBlocks.begin())
+    return StringRef();
+  CommentTextBlock &block = *--iter;
+  if (offset - block.Offset + uint64_t(size) > block.Size)
+    return StringRef();
+
+  if (block.Text.empty()) {
+    if (block.Stored.size() >= block.Size) {
+      block.Text = block.Stored;
+    } else {
+      SmallVector<char, 0> text;
+      if (llvm::zlib::uncompress(block.Stored, text, block.Size) !=
+            llvm::zlib::StatusOK ||
+          text.size() != block.Size)
+        return StringRef();
+      block.Text = getContext().AllocateCopy(StringRef(text.data(),
+                                                       text.size()));
+    }
+  }
+  return block.Text.substr(offset - block.Offset, size);
+}
+
 bool ModuleFile::readCommentBlock(llvm::BitstreamCursor &cursor) {
   cursor.EnterSubBlock(COMMENT_BLOCK_ID);
 
@@ -669,6 +813,10 @@ bool ModuleFile::readCommentBlock(llvm::BitstreamCursor &cursor) {
       case comment_block::GROUP_NAMES:
         GroupNamesMap = readGroupTable(scratch, blobData);
         break;
+      case comment_block::COMMENT_TEXT:
+        if (!readCommentTextBlocks(blobData))
+          return false;
+        break;
       default:
         // Unknown index kind, which this version of the compiler won't use.
         break;
@@ -787,6 +935,7 @@ ModuleFile::ModuleFile(
       }
       Name = info.name;
       TargetTriple = info.targetTriple;
+      InterfaceHash = info.interfaceHash;
 
       hasValidControlBlock = true;
       break;
@@ -1493,6 +1642,30 @@ void ModuleFile::getTopLevelDecls(SmallVectorImpl<Decl *> &results) {
   }
 }
 
+void ModuleFile::lookupConformancesTo(
+    ProtocolDecl *protocol, SmallVectorImpl<ProtocolConformance *> &results) {
+  PrettyModuleFileDeserialization stackEntry(*this);
+  if (!ProtocolConformers)
+    return;
+
+  auto iter = ProtocolConformers->find(protocol->getName());
+  if (iter == ProtocolConformers->end())
+    return;
+
+  // A context is listed once for each protocol with this name it conforms to.
+  llvm::SmallPtrSet<Decl *, 8> visited;
+  for (auto item : *iter) {
+    Decl *D = getDecl(item.second);
+    if (!D || !visited.insert(D).second)
+      continue;
+
+    for (auto conformance : cast<DeclContext>(D)->getLocalConformances()) {
+      if (conformance->getProtocol() == protocol)
+        results.push_back(conformance);
+    }
+  }
+}
+
 void
 ModuleFile::getLocalTypeDecls(SmallVectorImpl<TypeDecl *> &results) {
   PrettyModuleFileDeserialization stackEntry(*this);
@@ -30,6 +30,7 @@
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/ClangImporter/ClangModule.h"
 #include "swift/Serialization/SerializationOptions.h"
+#include "swift/Serialization/SerializedModuleLoader.h"
 
 #include "clang/Basic/Module.h"
 // FIXME: We're just using CompilerInstance::createOutputFile.
@@ -42,6 +43,7 @@
 #include "llvm/Bitcode/RecordLayout.h"
 #include "llvm/Config/config.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -434,6 +436,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(control_block, METADATA);
   BLOCK_RECORD(control_block, MODULE_NAME);
   BLOCK_RECORD(control_block, TARGET);
+  BLOCK_RECORD(control_block, INTERFACE_HASH);
 
   BLOCK(OPTIONS_BLOCK);
   BLOCK_RECORD(options_block, SDK_PATH);
@@ -441,6 +444,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(options_block, IS_SIB);
   BLOCK_RECORD(options_block, IS_TESTABLE);
   BLOCK_RECORD(options_block, RESILIENCE_STRATEGY);
+  BLOCK_RECORD(options_block, RESILIENCE_DOMAIN);
 
   BLOCK(INPUT_BLOCK);
   BLOCK_RECORD(input_block, IMPORTED_MODULE);
@@ -472,6 +476,8 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(index_block, DECL_CONTEXT_OFFSETS);
   BLOCK_RECORD(index_block, LOCAL_TYPE_DECLS);
   BLOCK_RECORD(index_block, NORMAL_CONFORMANCE_OFFSETS);
+  BLOCK_RECORD(index_block, DECL_MEMBER_NAMES);
+  BLOCK_RECORD(index_block, PROTOCOL_CONFORMERS);
 
   BLOCK(SIL_BLOCK);
   BLOCK_RECORD(sil_block, SIL_FUNCTION);
@@ -559,17 +565,56 @@ void Serializer::writeDocBlockInfoBlock() {
   BLOCK(COMMENT_BLOCK);
   BLOCK_RECORD(comment_block, DECL_COMMENTS);
   BLOCK_RECORD(comment_block, GROUP_NAMES);
+  BLOCK_RECORD(comment_block, COMMENT_TEXT);
 
 #undef BLOCK
 #undef BLOCK_RECORD
 }
 
+/// Computes the interface hash of \p files, from the interface hashes of
+/// the source files, or of the partial modules being merged.
+///
+/// Returns false if some file has no interface hash.
+static bool computeInterfaceHash(ArrayRef<const FileUnit *> files,
+                                 SmallVectorImpl<char> &result) {
+  llvm::MD5 hash;
+  for (auto file : files) {
+    llvm::SmallString<32> fileHash;
+    if (auto SF = dyn_cast<SourceFile>(file)) {
+      // Don't disturb the hash state of the file, which is also used for
+      // its dependencies file.
+      llvm::MD5 state = SF->getInterfaceHashState();
+      llvm::MD5::MD5Result digest;
+      state.final(digest);
+      llvm::MD5::stringifyResult(digest, fileHash);
+    } else if (auto AST = dyn_cast<SerializedASTFile>(file)) {
+      fileHash = AST->getInterfaceHash();
+    } else {
+      continue;
+    }
+    if (fileHash.empty())
+      return false;
+    hash.update(fileHash);
+    // Add null byte to separate the hashes.
+    uint8_t separator[1] = {0};
+    hash.update(separator);
+  }
+
+  llvm::MD5::MD5Result digest;
+  hash.final(digest);
+  llvm::SmallString<32> str;
+  llvm::MD5::stringifyResult(digest, str);
+  result.assign(str.begin(), str.end());
+  return true;
+}
+
 void Serializer::writeHeader(const SerializationOptions &options) {
   {
     BCBlockRAII restoreBlock(Out, CONTROL_BLOCK_ID, 3);
     control_block::ModuleNameLayout ModuleName(Out);
     control_block::MetadataLayout Metadata(Out);
     control_block::TargetLayout Target(Out);
+    control_block::InterfaceHashLayout InterfaceHash(Out);
 
     ModuleName.emit(ScratchRecord, M->getName().str());
 
@@ -584,6 +629,11 @@ void Serializer::writeHeader(const SerializationOptions &options) {
 
     Target.emit(ScratchRecord, M->getASTContext().LangOpts.Target.str());
 
+    ArrayRef<const FileUnit *> files = SF ? SF : M->getFiles();
+    llvm::SmallString<32> interfaceHash;
+    if (computeInterfaceHash(files, interfaceHash))
+      InterfaceHash.emit(ScratchRecord, interfaceHash);
+
     {
       llvm::BCBlockRAII restoreBlock(Out, OPTIONS_BLOCK_ID, 3);
 
@@ -600,6 +650,11 @@ void Serializer::writeHeader(const SerializationOptions &options) {
         Strategy.emit(ScratchRecord, unsigned(M->getResilienceStrategy()));
       }
 
+      if (!M->getResilienceDomain().empty()) {
+        options_block::ResilienceDomainLayout Domain(Out);
+        Domain.emit(ScratchRecord, M->getResilienceDomain().str());
+      }
+
       if (options.SerializeOptionsForDebugging) {
         options_block::SDKPathLayout SDKPath(Out);
         options_block::XCCLayout XCC(Out);
@@ -1247,7 +1302,8 @@ static bool shouldSerializeMember(Decl *D) {
   }
 }
 
-void Serializer::writeMembers(DeclRange members, bool isClass) {
+void Serializer::writeMembers(DeclID parentID, DeclRange members,
+                              bool isClass) {
   using namespace decls_block;
 
   unsigned abbrCode = DeclTypeAbbrCodes[MembersLayout::Code];
@@ -1259,6 +1315,13 @@ void Serializer::writeMembers(DeclRange members, bool isClass) {
     DeclID memberID = addDeclRef(member);
     memberIDs.push_back(memberID);
 
+    if (auto VD = dyn_cast<ValueDecl>(member)) {
+      if (VD->hasName()) {
+        auto &list = DeclMembersByName[{parentID, VD->getName()}];
+        list.push_back(memberID);
+      }
+    }
+
     if (isClass) {
       if (auto VD = dyn_cast<ValueDecl>(member)) {
         if (VD->canBeAccessedByDynamicLookup()) {
@@ -2088,7 +2151,8 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(extension->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(extension->getGenericRequirements());
-    writeMembers(extension->getMembers(), isClassExtension);
+    writeMembers(addDeclRef(extension), extension->getMembers(),
+                 isClassExtension);
     writeConformances(conformances, DeclTypeAbbrCodes);
 
     break;
@@ -2267,7 +2331,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theStruct->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theStruct->getGenericRequirements());
-    writeMembers(theStruct->getMembers(), false);
+    writeMembers(addDeclRef(theStruct), theStruct->getMembers(), false);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2301,7 +2365,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theEnum->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theEnum->getGenericRequirements());
-    writeMembers(theEnum->getMembers(), false);
+    writeMembers(addDeclRef(theEnum), theEnum->getMembers(), false);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2338,7 +2402,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theClass->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theClass->getGenericRequirements());
-    writeMembers(theClass->getMembers(), true);
+    writeMembers(addDeclRef(theClass), theClass->getMembers(), true);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2374,7 +2438,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(proto->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(proto->getGenericRequirements());
-    writeMembers(proto->getMembers(), true);
+    writeMembers(addDeclRef(proto), proto->getMembers(), true);
     writeDefaultWitnessTable(proto, DeclTypeAbbrCodes);
     break;
   }
@@ -3417,6 +3481,29 @@ static void writeDeclTable(const index_block::DeclListLayout &DeclList,
   DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
 }
 
+static void
+writeProtocolConformersTable(const index_block::ProtocolConformersLayout &out,
+                             const Serializer::DeclTable &table) {
+  if (table.empty())
+    return;
+
+  SmallVector<uint64_t, 8> scratch;
+  llvm::SmallString<4096> hashTableBlob;
+  uint32_t tableOffset;
+  {
+    llvm::OnDiskChainedHashTableGenerator<DeclTableInfo> generator;
+    for (auto &entry : table)
+      generator.insert(entry.first, entry.second);
+
+    llvm::raw_svector_ostream blobStream(hashTableBlob);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(blobStream).write<uint32_t>(0);
+    tableOffset = generator.Emit(blobStream);
+  }
+
+  out.emit(scratch, tableOffset, hashTableBlob);
+}
+
 static void writeLocalDeclTable(const index_block::DeclListLayout &DeclList,
                                 index_block::RecordKind kind,
                                 LocalTypeHashTableGenerator &generator) {
@@ -3442,7 +3529,70 @@ struct DeclCommentTableData {
   uint32_t Order;
 };
 
+/// Collects the text of all comments into blocks which are compressed one by
+/// one, so that a reader only has to decompress the blocks which contain the
+/// comments it looks up.
+class CommentTextWriter {
+  std::vector<std::string> Blocks;
+  std::string CurrentBlock;
+  uint32_t NextOffset = 0;
+
+  void finishBlock() {
+    Blocks.push_back(std::move(CurrentBlock));
+    CurrentBlock.clear();
+  }
+
+public:
+  /// Comments are added to the current block until it reaches this size.
+  static const size_t BlockSize = 16 * 1024;
+
+  /// Adds \p text and returns its offset in the uncompressed text.
+  uint32_t add(StringRef text) {
+    if (!CurrentBlock.empty() &&
+        CurrentBlock.size() + text.size() > BlockSize)
+      finishBlock();
+    uint32_t offset = NextOffset;
+    CurrentBlock.append(text.begin(), text.end());
+    NextOffset += text.size();
+    return offset;
+  }
+
+  void emit(const comment_block::CommentTextLayout &out) {
+    if (!CurrentBlock.empty())
+      finishBlock();
+
+    SmallVector<SmallString<0>, 4> storedBlocks;
+    for (const std::string &block : Blocks) {
+      storedBlocks.emplace_back();
+      SmallString<0> &stored = storedBlocks.back();
+      if (!llvm::zlib::isAvailable() ||
+          llvm::zlib::compress(block, stored) != llvm::zlib::StatusOK ||
+          stored.size() >= block.size()) {
+        stored = block;
+      }
+    }
+
+    SmallString<0> blob;
+    {
+      llvm::raw_svector_ostream blobStream(blob);
+      endian::Writer<little> writer(blobStream);
+      writer.write<uint32_t>(Blocks.size());
+      for (size_t i = 0, e = Blocks.size(); i != e; ++i) {
+        writer.write<uint32_t>(Blocks[i].size());
+        writer.write<uint32_t>(storedBlocks[i].size());
+      }
+      for (auto &stored : storedBlocks)
+        blobStream << stored;
+    }
+
+    SmallVector<uint64_t, 8> scratch;
+    out.emit(scratch, blob);
+  }
+};
+
 class DeclCommentTableInfo {
+  CommentTextWriter &Text;
+
 public:
   using key_type = StringRef;
   using key_type_ref = key_type;
@@ -3451,6 +3601,8 @@ public:
   using hash_value_type = uint32_t;
   using offset_type = unsigned;
 
+  explicit DeclCommentTableInfo(CommentTextWriter &text) : Text(text) {}
+
   hash_value_type ComputeHash(key_type_ref key) {
     assert(!key.empty());
     return llvm::HashString(key);
@@ -3461,14 +3613,13 @@ public:
     uint32_t keyLength = key.size();
     const unsigned numLen = 4;
 
-    // Data consists of brief comment length and brief comment text,
-    uint32_t dataLength = numLen + data.Brief.size();
+    // Data consists of the offset and the length of the brief comment text,
+    uint32_t dataLength = numLen + numLen;
     // number of raw comments,
     dataLength += numLen;
-    // for each raw comment: column number of the first line, length of each
-    // raw comment and its text.
-    for (auto C : data.Raw.Comments)
-      dataLength += numLen + numLen + C.RawText.size();
+    // for each raw comment: column number of the first line, and the offset
+    // and the length of its text.
+    dataLength += (numLen + numLen + numLen) * data.Raw.Comments.size();
 
     // Group Id.
     dataLength += numLen;
@@ -3488,13 +3639,13 @@ public:
   void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
                 unsigned len) {
     endian::Writer<little> writer(out);
+    writer.write<uint32_t>(Text.add(data.Brief));
     writer.write<uint32_t>(data.Brief.size());
-    out << data.Brief;
     writer.write<uint32_t>(data.Raw.Comments.size());
     for (auto C : data.Raw.Comments) {
       writer.write<uint32_t>(C.StartColumn);
+      writer.write<uint32_t>(Text.add(C.RawText));
       writer.write<uint32_t>(C.RawText.size());
-      out << C.RawText;
     }
     writer.write<uint32_t>(data.Group);
     writer.write<uint32_t>(data.Order);
@@ -3696,6 +3847,7 @@ static void writeGroupNames(const comment_block::GroupNamesLayout &GroupNames,
 
 static void writeDeclCommentTable(
     const comment_block::DeclCommentListLayout &DeclCommentList,
+    const comment_block::CommentTextLayout &CommentText,
     const SourceFile *SF, const Module *M,
     DeclGroupNameContext &GroupContext) {
 
@@ -3795,13 +3947,18 @@ static void writeDeclCommentTable(
   SmallVector<uint64_t, 8> scratch;
   llvm::SmallString<32> hashTableBlob;
   uint32_t tableOffset;
+  CommentTextWriter Text;
   {
     llvm::raw_svector_ostream blobStream(hashTableBlob);
     // Make sure that no bucket is at offset 0
     endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = Writer.generator.Emit(blobStream);
+    DeclCommentTableInfo Info(Text);
+    tableOffset = Writer.generator.Emit(blobStream, Info);
   }
 
+  // The text has to come first, so that it is available when the reader
+  // looks up comments.
+  Text.emit(CommentText);
   DeclCommentList.emit(scratch, tableOffset, hashTableBlob);
 }
 
@@ -3882,6 +4039,97 @@ static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
   out.emit(scratch, tableOffset, hashTableBlob);
 }
 
+namespace {
+  /// Used to serialize the on-disk member name hash table.
+  ///
+  /// The key is the ID of a nominal type or extension together with a member
+  /// name, so that a lookup only has to deserialize the members of that one
+  /// context with that name.
+  class DeclMemberNamesTableInfo {
+  public:
+    using key_type = Serializer::DeclMemberNamesKey;
+    using key_type_ref = const key_type &;
+    using data_type = Serializer::DeclMemberNamesData;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      return llvm::HashString(key.second.str(), key.first);
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = sizeof(uint32_t) + key.second.str().size();
+      uint32_t dataLength = sizeof(uint32_t) * data.size();
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      endian::Writer<little>(out).write<uint32_t>(key.first);
+      out << key.second.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      static_assert(declIDFitsIn32Bits(), "DeclID too large");
+      endian::Writer<little> writer(out);
+      for (DeclID memberID : data)
+        writer.write<uint32_t>(memberID);
+    }
+  };
+} // end anonymous namespace
+
+static void
+writeDeclMemberNamesTable(const index_block::DeclMemberNamesLayout &out,
+                          const Serializer::DeclMemberNamesTable &table) {
+  llvm::OnDiskChainedHashTableGenerator<DeclMemberNamesTableInfo> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+
+  llvm::SmallString<32> hashTableBlob;
+  uint32_t tableOffset;
+  {
+    llvm::raw_svector_ostream blobStream(hashTableBlob);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(blobStream).write<uint32_t>(0);
+    tableOffset = generator.Emit(blobStream);
+  }
+
+  SmallVector<uint64_t, 8> scratch;
+  out.emit(scratch, tableOffset, hashTableBlob);
+}
+
+/// Records the protocols which \p D conforms to in \p protocolConformers, and
+/// recursively does the same for the nominal types nested in \p D.
+static void addProtocolConformers(Serializer &S, const Decl *D,
+                                  Serializer::DeclTable &protocolConformers) {
+  const IterableDeclContext *IDC;
+  if (auto ED = dyn_cast<ExtensionDecl>(D))
+    IDC = ED;
+  else if (auto NTD = dyn_cast<NominalTypeDecl>(D))
+    IDC = NTD;
+  else
+    return;
+
+  if (isa<ProtocolDecl>(D))
+    return;
+
+  auto conformances = cast<DeclContext>(D)->getLocalConformances(
+                        ConformanceLookupKind::All, nullptr, /*sorted=*/true);
+  for (auto conformance : conformances) {
+    protocolConformers[conformance->getProtocol()->getName()]
+      .push_back({ getKindForTable(D), S.addDeclRef(D) });
+  }
+
+  for (const Decl *member : IDC->getMembers())
+    addProtocolConformers(S, member, protocolConformers);
+}
+
 /// Add operator methods from the given declaration type.
 ///
 /// Recursively walks the members and derived global decls of any nested
@@ -3940,8 +4188,21 @@ static void addOperatorsAndTopLevel(Serializer &S, Range members,
   }
 }
 
+/// Whether \p TD is declared in a function body which was skipped, and so was
+/// never type-checked.
+static bool isInSkippedFunctionBody(const TypeDecl *TD) {
+  for (auto DC = TD->getDeclContext(); DC->isLocalContext();
+       DC = DC->getParent()) {
+    if (auto AFD = dyn_cast<AbstractFunctionDecl>(DC))
+      if (AFD->getBodyKind() == AbstractFunctionDecl::BodyKind::Skipped)
+        return true;
+  }
+  return false;
+}
+
 void Serializer::writeAST(ModuleOrSourceFile DC) {
   DeclTable topLevelDecls, extensionDecls, operatorDecls, operatorMethodDecls;
+  DeclTable protocolConformers;
   ObjCMethodTable objcMethods;
   LocalTypeHashTableGenerator localTypeGenerator;
   bool hasLocalTypes = false;
@@ -3976,6 +4237,8 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
           .push_back({ getStableFixity(OD->getKind()), addDeclRef(D) });
       }
 
+      addProtocolConformers(*this, D, protocolConformers);
+
       // If this is a global variable, force the accessors to be
       // serialized.
       if (auto VD = dyn_cast<VarDecl>(D)) {
@@ -4002,6 +4265,8 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     nextFile->getLocalTypeDecls(localTypeDecls);
 
     for (auto TD : localTypeDecls) {
+      if (isInSkippedFunctionBody(TD))
+        continue;
       hasLocalTypes = true;
 
       Mangle::Mangler DebugMangler(false);
@@ -4050,6 +4315,12 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     index_block::ObjCMethodTableLayout ObjCMethodTable(Out);
     writeObjCMethodTable(ObjCMethodTable, objcMethods);
 
+    index_block::DeclMemberNamesLayout DeclMemberNames(Out);
+    writeDeclMemberNamesTable(DeclMemberNames, DeclMembersByName);
+
+    index_block::ProtocolConformersLayout ProtocolConformers(Out);
+    writeProtocolConformersTable(ProtocolConformers, protocolConformers);
+
     if (entryPointClassID.hasValue()) {
       index_block::EntryPointLayout EntryPoint(Out);
       EntryPoint.emit(ScratchRecord, entryPointClassID.getValue());
@@ -4105,7 +4376,9 @@ void Serializer::writeDocToStream(raw_ostream &os, ModuleOrSourceFile DC,
       BCBlockRAII restoreBlock(S.Out, COMMENT_BLOCK_ID, 4);
       DeclGroupNameContext GroupContext(GroupInfoPath, Ctx);
       comment_block::DeclCommentListLayout DeclCommentList(S.Out);
-      writeDeclCommentTable(DeclCommentList, S.SF, S.M, GroupContext);
+      comment_block::CommentTextLayout CommentText(S.Out);
+      writeDeclCommentTable(DeclCommentList, CommentText, S.SF, S.M,
+                            GroupContext);
       comment_block::GroupNamesLayout GroupNames(S.Out);
 
       // FIXME: Multi-file compilation may cause group id collision.
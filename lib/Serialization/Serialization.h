@@ -123,12 +123,26 @@ public:
   // hash table of all defined Objective-C methods.
   using ObjCMethodTable = llvm::DenseMap<ObjCSelector, ObjCMethodTableData>;
 
+  using DeclMemberNamesKey = std::pair<uint32_t, Identifier>;
+  using DeclMemberNamesData = SmallVector<DeclID, 2>;
+
+  // In-memory representation of what will eventually be an on-disk hash
+  // table mapping a nominal type or extension and a name to its members with
+  // that name.
+  using DeclMemberNamesTable =
+      llvm::MapVector<DeclMemberNamesKey, DeclMemberNamesData>;
+
 private:
   /// A map from identifiers to methods and properties with the given name.
   ///
   /// This is used for id-style lookup.
   DeclTable ClassMembersByName;
 
+  /// The members of each nominal type and extension, by name.
+  ///
+  /// This is used to deserialize only the members with a given name.
+  DeclMemberNamesTable DeclMembersByName;
+
   /// The queue of types and decls that need to be serialized.
   ///
   /// This is a queue and not simply a vector because serializing one
@@ -254,10 +268,11 @@ private:
 
   /// Writes an array of members for a decl context.
   ///
+  /// \param parentID The ID of the context itself
   /// \param members The decls within the context
   /// \param isClass True if the context could be a class context (class,
   ///        class extension, or protocol).
-  void writeMembers(DeclRange members, bool isClass);
+  void writeMembers(DeclID parentID, DeclRange members, bool isClass);
 
   /// Write a default witness table for a protocol.
   ///
@@ -107,6 +107,54 @@ namespace {
     }
   };
 
+  /// Used to serialize the on-disk function summary hash table.
+  class FuncSummaryTableInfo {
+  public:
+    using key_type = Identifier;
+    using key_type_ref = key_type;
+    using data_type = const SILFunctionSummary *;
+    using data_type_ref = data_type;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.empty());
+      return llvm::HashString(key.str());
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = key.str().size();
+      // The global effects, the flags, the body cost, the number of arguments
+      // and one byte per argument.
+      uint32_t dataLength = 2 + sizeof(uint32_t) + sizeof(uint16_t) +
+                            data->getNumArguments();
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      out << key.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      endian::Writer<little> writer(out);
+      writer.write<uint8_t>(data->getGlobalEffects());
+      writer.write<uint8_t>(data->getFlags());
+      writer.write<uint32_t>(data->getBodyCost());
+      writer.write<uint16_t>(data->getNumArguments());
+      for (unsigned i = 0, e = data->getNumArguments(); i != e; ++i) {
+        const auto &arg = data->getArgument(i);
+        // The effects fit into the low four bits.
+        writer.write<uint8_t>(arg.Effects | (arg.MayEscape ? 0x10 : 0));
+      }
+    }
+  };
+
   class SILSerializer {
     Serializer &S;
     ASTContext &Ctx;
@@ -156,6 +204,9 @@ namespace {
     std::vector<BitOffset> DefaultWitnessTableOffset;
     uint32_t /*DeclID*/ NextDefaultWitnessTableID = 1;
 
+    /// Maps function name to the summary of the function.
+    llvm::MapVector<Identifier, const SILFunctionSummary *> FuncSummaries;
+
     /// Give each SILBasicBlock a unique ID.
     llvm::DenseMap<const SILBasicBlock *, unsigned> BasicBlockMap;
 
@@ -1581,6 +1632,26 @@ static void writeIndexTable(const sil_index_block::ListLayout &List,
   List.emit(scratch, kind, tableOffset, hashTableBlob);
 }
 
+static void writeFuncSummaryTable(
+    const sil_index_block::ListLayout &List,
+    const llvm::MapVector<Identifier, const SILFunctionSummary *> &table) {
+  llvm::SmallString<4096> hashTableBlob;
+  uint32_t tableOffset;
+  {
+    llvm::OnDiskChainedHashTableGenerator<FuncSummaryTableInfo> generator;
+    for (auto &entry : table)
+      generator.insert(entry.first, entry.second);
+
+    llvm::raw_svector_ostream blobStream(hashTableBlob);
+    // Make sure that no bucket is at offset 0.
+    endian::Writer<little>(blobStream).write<uint32_t>(0);
+    tableOffset = generator.Emit(blobStream);
+  }
+  SmallVector<uint64_t, 8> scratch;
+  List.emit(scratch, sil_index_block::SIL_FUNC_SUMMARIES, tableOffset,
+            hashTableBlob);
+}
+
 void SILSerializer::writeIndexTables() {
   BCBlockRAII restoreBlock(Out, SIL_INDEX_BLOCK_ID, 4);
 
@@ -1617,6 +1688,9 @@ void SILSerializer::writeIndexTables() {
                 sil_index_block::SIL_DEFAULT_WITNESS_TABLE_OFFSETS,
                 DefaultWitnessTableOffset);
   }
+
+  if (!FuncSummaries.empty())
+    writeFuncSummaryTable(List, FuncSummaries);
 }
 
 void SILSerializer::writeSILGlobalVar(const SILGlobalVariable &g) {
@@ -1882,6 +1956,16 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
     }
   }
 
+  // Collect the summaries the optimizer computed for functions defined in
+  // this module. They are also useful for functions whose bodies are not
+  // serialized.
+  for (const SILFunction &F : *SILMod) {
+    if (!F.isDefinition() || F.isAvailableExternally())
+      continue;
+    if (auto *Summary = SILMod->getFunctionSummary(&F))
+      FuncSummaries[Ctx.getIdentifier(F.getName())] = Summary;
+  }
+
   assert(Worklist.empty() && "Did not emit everything in worklist");
 }
 
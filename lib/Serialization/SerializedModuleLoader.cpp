@@ -19,6 +19,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/Version.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Debug.h"
@@ -30,24 +31,98 @@ namespace {
 typedef std::pair<Identifier, SourceLoc> AccessPathElem;
 } // end unnamed namespace
 
+/// Opens a module or module doc file. Module files don't need a null
+/// terminator, so the file is always mapped read-only instead of being copied
+/// when its size is a multiple of the page size. Concurrent compiler processes
+/// then share the pages of the imported modules.
+static llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+getModuleFileBuffer(StringRef path) {
+  return llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                     /*RequiresNullTerminator=*/false);
+}
+
+namespace {
+/// A buffer which shares the contents of a file in a ModuleBufferCache.
+class SharedModuleBuffer final : public llvm::MemoryBuffer {
+  std::shared_ptr<llvm::MemoryBuffer> Contents;
+
+public:
+  explicit SharedModuleBuffer(std::shared_ptr<llvm::MemoryBuffer> contents)
+      : Contents(std::move(contents)) {
+    init(Contents->getBufferStart(), Contents->getBufferEnd(),
+         /*RequiresNullTerminator=*/false);
+  }
+
+  const char *getBufferIdentifier() const override {
+    return Contents->getBufferIdentifier();
+  }
+
+  BufferKind getBufferKind() const override {
+    return Contents->getBufferKind();
+  }
+};
+} // end unnamed namespace
+
+llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+ModuleBufferCache::getFile(StringRef path) {
+  llvm::sys::fs::file_status status;
+  if (std::error_code err = llvm::sys::fs::status(path, status))
+    return err;
+  // Let MemoryBuffer report directories and other special files.
+  if (!llvm::sys::fs::is_regular_file(status))
+    return getModuleFileBuffer(path);
+
+  std::lock_guard<std::mutex> guard(Lock);
+  Entry &entry = Entries[path];
+  if (!entry.Buffer ||
+      entry.ModificationTime != status.getLastModificationTime() ||
+      entry.Size != status.getSize()) {
+    auto bufferOrErr = getModuleFileBuffer(path);
+    if (!bufferOrErr) {
+      Entries.erase(path);
+      return bufferOrErr.getError();
+    }
+    entry.Buffer = std::move(bufferOrErr.get());
+    entry.ModificationTime = status.getLastModificationTime();
+    entry.Size = status.getSize();
+  }
+  return std::unique_ptr<llvm::MemoryBuffer>(
+      new SharedModuleBuffer(entry.Buffer));
+}
+
+void ModuleBufferCache::clear() {
+  std::lock_guard<std::mutex> guard(Lock);
+  Entries.clear();
+}
+
 // Defined out-of-line so that we can see ~ModuleFile.
 SerializedModuleLoader::SerializedModuleLoader(ASTContext &ctx,
-                                               DependencyTracker *tracker)
-  : ModuleLoader(tracker), Ctx(ctx) {}
+                                               DependencyTracker *tracker,
+                                               ModuleBufferCache *sharedBuffers)
+  : ModuleLoader(tracker), Ctx(ctx), SharedBuffers(sharedBuffers) {}
 SerializedModuleLoader::~SerializedModuleLoader() = default;
 
+static llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+getModuleFileBuffer(StringRef Path, ModuleBufferCache *SharedBuffers) {
+  if (SharedBuffers)
+    return SharedBuffers->getFile(Path);
+  return getModuleFileBuffer(Path);
+}
+
 static std::error_code
 openModuleFiles(StringRef DirName, StringRef ModuleFilename,
                 StringRef ModuleDocFilename,
                 std::unique_ptr<llvm::MemoryBuffer> &ModuleBuffer,
                 std::unique_ptr<llvm::MemoryBuffer> &ModuleDocBuffer,
-                llvm::SmallVectorImpl<char> &Scratch) {
+                llvm::SmallVectorImpl<char> &Scratch,
+                ModuleBufferCache *SharedBuffers) {
   // Try to open the module file first.  If we fail, don't even look for the
   // module documentation file.
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    getModuleFileBuffer(StringRef(Scratch.data(), Scratch.size()),
+                        SharedBuffers);
   if (!ModuleOrErr)
     return ModuleOrErr.getError();
 
@@ -56,7 +131,8 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleDocFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleDocOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    getModuleFileBuffer(StringRef(Scratch.data(), Scratch.size()),
+                        SharedBuffers);
   if (!ModuleDocOrErr &&
       ModuleDocOrErr.getError() != std::errc::no_such_file_or_directory) {
     return ModuleDocOrErr.getError();
@@ -71,7 +147,7 @@ static std::error_code
 findModule(ASTContext &ctx, AccessPathElem moduleID,
            std::unique_ptr<llvm::MemoryBuffer> &moduleBuffer,
            std::unique_ptr<llvm::MemoryBuffer> &moduleDocBuffer,
-           bool &isFramework) {
+           bool &isFramework, ModuleBufferCache *sharedBuffers) {
   llvm::SmallString<64> moduleFilename(moduleID.first.str());
   moduleFilename += '.';
   moduleFilename += SERIALIZED_MODULE_EXTENSION;
@@ -101,14 +177,14 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
     auto err = openModuleFiles(path,
                                moduleFilename.str(), moduleDocFilename.str(),
                                moduleBuffer, moduleDocBuffer,
-                               scratch);
+                               scratch, sharedBuffers);
     if (err == std::errc::is_a_directory) {
       currPath = path;
       llvm::sys::path::append(currPath, moduleFilename.str());
       err = openModuleFiles(currPath,
                             archFile.str(), archDocFile.str(),
                             moduleBuffer, moduleDocBuffer,
-                            scratch);
+                            scratch, sharedBuffers);
     }
     if (!err || err != std::errc::no_such_file_or_directory)
       return err;
@@ -126,7 +202,7 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
       auto err = openModuleFiles(currPath,
                                  archFile.str(), archDocFile.str(),
                                  moduleBuffer, moduleDocBuffer,
-                                 scratch);
+                                 scratch, sharedBuffers);
       if (!err || err != std::errc::no_such_file_or_directory)
         return err;
     }
@@ -140,7 +216,8 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
   isFramework = false;
   return openModuleFiles(ctx.SearchPathOpts.RuntimeLibraryImportPath,
                          moduleFilename.str(), moduleDocFilename.str(),
-                         moduleBuffer, moduleDocBuffer, scratch);
+                         moduleBuffer, moduleDocBuffer, scratch,
+                         sharedBuffers);
 }
 
 FileUnit *SerializedModuleLoader::loadAST(
@@ -173,6 +250,9 @@ FileUnit *SerializedModuleLoader::loadAST(
     Ctx.bumpGeneration();
 
     M.setResilienceStrategy(extendedInfo.getResilienceStrategy());
+    if (!extendedInfo.getResilienceDomain().empty())
+      M.setResilienceDomain(
+          Ctx.getIdentifier(extendedInfo.getResilienceDomain()));
 
     // We've loaded the file. Now try to bring it into the AST.
     auto fileUnit = new (Ctx) SerializedASTFile(M, *loadedModuleFile,
@@ -380,7 +460,7 @@ Module *SerializedModuleLoader::loadModule(SourceLoc importLoc,
   if (!moduleInputBuffer) {
     if (std::error_code err = findModule(Ctx, moduleID, moduleInputBuffer,
                                          moduleDocInputBuffer,
-                                         isFramework)) {
+                                         isFramework, SharedBuffers)) {
       if (err != std::errc::no_such_file_or_directory) {
         Ctx.Diags.diagnose(moduleID.second, diag::sema_opening_import,
                            moduleID.first, err.message());
@@ -557,6 +637,12 @@ SerializedASTFile::getLocalTypeDecls(SmallVectorImpl<TypeDecl*> &results) const{
   File.getLocalTypeDecls(results);
 }
 
+void SerializedASTFile::lookupConformancesTo(
+    ProtocolDecl *protocol,
+    SmallVectorImpl<ProtocolConformance *> &results) const {
+  File.lookupConformancesTo(protocol, results);
+}
+
 void SerializedASTFile::getDisplayDecls(SmallVectorImpl<Decl*> &results) const {
   File.getDisplayDecls(results);
 }
@@ -565,6 +651,10 @@ StringRef SerializedASTFile::getFilename() const {
   return File.getModuleFilename();
 }
 
+StringRef SerializedASTFile::getInterfaceHash() const {
+  return File.getInterfaceHash();
+}
+
 const clang::Module *SerializedASTFile::getUnderlyingClangModule() {
   if (auto *ShadowedModule = File.getShadowedModule())
     return ShadowedModule->findUnderlyingClangModule();
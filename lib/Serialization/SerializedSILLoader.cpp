@@ -131,6 +131,15 @@ SILWitnessTable *SerializedSILLoader::lookupWitnessTable(SILWitnessTable *WT) {
   return nullptr;
 }
 
+Optional<SILFunctionSummary>
+SerializedSILLoader::lookupFunctionSummary(StringRef Name) {
+  for (auto &Des : LoadedSILSections) {
+    if (auto Summary = Des->lookupFunctionSummary(Name))
+      return Summary;
+  }
+  return None;
+}
+
 SILDefaultWitnessTable *SerializedSILLoader::
 lookupDefaultWitnessTable(SILDefaultWitnessTable *WT) {
   for (auto &Des : LoadedSILSections)
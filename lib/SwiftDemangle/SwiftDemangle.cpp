@@ -32,6 +32,12 @@ static size_t swift_demangle_getDemangledName_Options(const char *MangledName,
   if (!isSwiftPrefixed(MangledName))
     return 0; // Not a mangled name
 
+  // Demangle simple names without building a tree.
+  if (size_t Length = swift::Demangle::demangleSimpleSymbol(
+          MangledName, strlen(MangledName), OutputBuffer, Length,
+          DemangleOptions))
+    return Length;
+
   std::string Result = swift::demangle_wrappers::demangleSymbolAsString(
       MangledName, DemangleOptions);
 
@@ -43,6 +43,7 @@ public enum InstanceKind : UInt8 {
   case Existential
   case ErrorExistential
   case Closure
+  case RuntimeCounters
 }
 
 /// Represents a section in a loaded image in this process.
@@ -476,6 +477,12 @@ public func reflect(function: (Int, String, AnyObject?) -> ()) {
   fn.deallocateCapacity(sizeof(ThickFunction3.self))
 }
 
+/// Ask the parent to read and print this process's runtime performance
+/// counters.
+public func reflectRuntimeCounters() {
+  reflect(instanceAddress: 0, kind: .RuntimeCounters)
+}
+
 /// Call this function to indicate to the parent that there are
 /// no more instances to look at.
 public func doneReflecting() {
@@ -28,26 +28,58 @@ using namespace reflection;
 
 TypeRefBuilder::TypeRefBuilder() : TC(*this) {}
 
+void TypeRefBuilder::updateIndexes() {
+  for (; NumIndexedReflectionInfos != ReflectionInfos.size();
+       ++NumIndexedReflectionInfos) {
+    auto &Info = ReflectionInfos[NumIndexedReflectionInfos];
+
+    // Earlier images take precedence, as they do in a linear search, so
+    // emplace doesn't replace existing entries.
+    for (auto &FD : Info.fieldmd) {
+      if (!FD.hasMangledTypeName())
+        continue;
+      FieldTypeInfoIndex.emplace(FD.getMangledTypeName(), &FD);
+    }
+
+    for (auto &BuiltinTypeDescriptor : Info.builtin) {
+      assert(BuiltinTypeDescriptor.Size > 0);
+      assert(BuiltinTypeDescriptor.Alignment > 0);
+      assert(BuiltinTypeDescriptor.Stride > 0);
+      if (!BuiltinTypeDescriptor.hasMangledTypeName())
+        continue;
+      BuiltinTypeInfoIndex.emplace(BuiltinTypeDescriptor.getMangledTypeName(),
+                                   &BuiltinTypeDescriptor);
+    }
+
+    for (const auto &AssocTyDescriptor : Info.assocty) {
+      std::string ConformingTypeName(AssocTyDescriptor.ConformingTypeName);
+      AssociatedTypeIndex[ConformingTypeName].push_back(&AssocTyDescriptor);
+    }
+  }
+}
+
 const AssociatedTypeDescriptor * TypeRefBuilder::
 lookupAssociatedTypes(const std::string &MangledTypeName,
                       const DependentMemberTypeRef *DependentMember) {
-  // Cache missed - we need to look through all of the assocty sections
-  // for all images that we've been notified about.
-  for (auto &Info : ReflectionInfos) {
-    for (const auto &AssocTyDescriptor : Info.assocty) {
-      std::string ConformingTypeName(AssocTyDescriptor.ConformingTypeName);
-      if (ConformingTypeName.compare(MangledTypeName) != 0)
+  // Look through the assocty descriptors of the conformances of the type,
+  // in all images that we've been notified about.
+  updateIndexes();
+  auto Found = AssociatedTypeIndex.find(MangledTypeName);
+  if (Found == AssociatedTypeIndex.end())
+    return nullptr;
+
+  Demangle::NodeFactory Factory;
+  for (auto *AssocTyDescriptor : Found->second) {
+    std::string ProtocolMangledName(AssocTyDescriptor->ProtocolTypeName);
+    auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName,
+                                                       Factory);
+    auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
+
+    auto &Conformance = *DependentMember->getProtocol();
+    if (auto Protocol = dyn_cast<ProtocolTypeRef>(TR)) {
+      if (*Protocol != Conformance)
         continue;
-      std::string ProtocolMangledName(AssocTyDescriptor.ProtocolTypeName);
-      auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName);
-      auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
-
-      auto &Conformance = *DependentMember->getProtocol();
-      if (auto Protocol = dyn_cast<ProtocolTypeRef>(TR)) {
-        if (*Protocol != Conformance)
-          continue;
-        return &AssocTyDescriptor;
-      }
+      return AssocTyDescriptor;
     }
   }
   return nullptr;
@@ -63,7 +95,9 @@ getDependentMemberTypeRef(const std::string &MangledTypeName,
         continue;
 
       auto SubstitutedTypeName = AssocTy.getMangledSubstitutedTypeName();
-      auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName);
+      Demangle::NodeFactory Factory;
+      auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName,
+                                                    Factory);
       return swift::remote::decodeMangledType(*this, Demangled);
     }
   }
@@ -82,19 +116,11 @@ TypeRefBuilder::getFieldTypeInfo(const TypeRef *TR) {
   else
     return {};
 
-  std::vector<std::pair<std::string, const TypeRef *>> Fields;
-  for (auto Info : ReflectionInfos) {
-    for (auto &FD : Info.fieldmd) {
-      if (!FD.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = FD.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &FD;
-    }
-  }
-
-  return nullptr;
+  updateIndexes();
+  auto Found = FieldTypeInfoIndex.find(MangledName);
+  if (Found == FieldTypeInfoIndex.end())
+    return nullptr;
+  return Found->second;
 }
 
 std::vector<std::pair<std::string, const TypeRef *>> TypeRefBuilder::
@@ -102,9 +128,15 @@ getFieldTypeRefs(const TypeRef *TR, const FieldDescriptor *FD) {
   if (FD == nullptr)
     return {};
 
+  // TypeRefs are uniqued, so the results can be memoized by TypeRef.
+  auto Cached = FieldTypeRefsCache.find(TR);
+  if (Cached != FieldTypeRefsCache.end() && Cached->second.first == FD)
+    return Cached->second.second;
+
   auto Subs = TR->getSubstMap();
 
   std::vector<std::pair<std::string, const TypeRef *>> Fields;
+  Demangle::NodeFactory Factory;
   for (auto &Field : *FD) {
     auto FieldName = Field.getFieldName();
 
@@ -116,7 +148,7 @@ getFieldTypeRefs(const TypeRef *TR, const FieldDescriptor *FD) {
     }
 
     auto Demangled
-      = Demangle::demangleTypeAsNode(Field.getMangledTypeName());
+      = Demangle::demangleTypeAsNode(Field.getMangledTypeName(), Factory);
     auto Unsubstituted = swift::remote::decodeMangledType(*this, Demangled);
     if (!Unsubstituted)
       return {};
@@ -124,6 +156,7 @@ getFieldTypeRefs(const TypeRef *TR, const FieldDescriptor *FD) {
     auto Substituted = Unsubstituted->subst(*this, Subs);
     Fields.push_back({FieldName, Substituted});
   }
+  FieldTypeRefsCache[TR] = {FD, Fields};
   return Fields;
 }
 
@@ -137,21 +170,11 @@ TypeRefBuilder::getBuiltinTypeInfo(const TypeRef *TR) {
   else
     return nullptr;
 
-  for (auto Info : ReflectionInfos) {
-    for (auto &BuiltinTypeDescriptor : Info.builtin) {
-      assert(BuiltinTypeDescriptor.Size > 0);
-      assert(BuiltinTypeDescriptor.Alignment > 0);
-      assert(BuiltinTypeDescriptor.Stride > 0);
-      if (!BuiltinTypeDescriptor.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = BuiltinTypeDescriptor.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &BuiltinTypeDescriptor;
-    }
-  }
-
-  return nullptr;
+  updateIndexes();
+  auto Found = BuiltinTypeInfoIndex.find(MangledName);
+  if (Found == BuiltinTypeInfoIndex.end())
+    return nullptr;
+  return Found->second;
 }
 
 const CaptureDescriptor *
@@ -173,12 +196,13 @@ TypeRefBuilder::getCaptureDescriptor(uintptr_t RemoteAddress) {
 ClosureContextInfo
 TypeRefBuilder::getClosureContextInfo(const CaptureDescriptor &CD) {
   ClosureContextInfo Info;
+  Demangle::NodeFactory Factory;
 
   for (auto i = CD.capture_begin(), e = CD.capture_end(); i != e; ++i) {
     const TypeRef *TR = nullptr;
     if (i->hasMangledTypeName()) {
       auto MangledName = i->getMangledTypeName();
-      auto DemangleTree = Demangle::demangleTypeAsNode(MangledName);
+      auto DemangleTree = Demangle::demangleTypeAsNode(MangledName, Factory);
       TR = swift::remote::decodeMangledType(*this, DemangleTree);
     }
     Info.CaptureTypes.push_back(TR);
@@ -188,7 +212,7 @@ TypeRefBuilder::getClosureContextInfo(const CaptureDescriptor &CD) {
     const TypeRef *TR = nullptr;
     if (i->hasMangledTypeName()) {
       auto MangledName = i->getMangledTypeName();
-      auto DemangleTree = Demangle::demangleTypeAsNode(MangledName);
+      auto DemangleTree = Demangle::demangleTypeAsNode(MangledName, Factory);
       TR = swift::remote::decodeMangledType(*this, DemangleTree);
     }
 
@@ -216,7 +240,8 @@ TypeRefBuilder::dumpTypeRef(const std::string &MangledName,
   auto TypeName = Demangle::demangleTypeAsString(MangledName);
   OS << TypeName << '\n';
 
-  auto DemangleTree = Demangle::demangleTypeAsNode(MangledName);
+  Demangle::NodeFactory Factory;
+  auto DemangleTree = Demangle::demangleTypeAsNode(MangledName, Factory);
   auto TR = swift::remote::decodeMangledType(*this, DemangleTree);
   if (!TR) {
     OS << "!!! Invalid typeref: " << MangledName << '\n';
@@ -56,6 +56,12 @@ swift_reflection_addReflectionInfo(SwiftReflectionContextRef ContextRef,
   Context->addReflectionInfo(*reinterpret_cast<ReflectionInfo *>(&Info));
 }
 
+void
+swift_reflection_invalidateMemoryCache(SwiftReflectionContextRef ContextRef) {
+  auto Context = reinterpret_cast<NativeReflectionContext *>(ContextRef);
+  Context->Reader->invalidateCache();
+}
+
 int
 swift_reflection_readIsaMask(SwiftReflectionContextRef ContextRef,
                              uintptr_t *outIsaMask) {
@@ -65,6 +71,29 @@ swift_reflection_readIsaMask(SwiftReflectionContextRef ContextRef,
   return isaMask.first;
 }
 
+size_t
+swift_reflection_readRuntimeCounters(SwiftReflectionContextRef ContextRef,
+                                     uint64_t *OutCounts,
+                                     size_t MaxCount) {
+  auto Context = reinterpret_cast<NativeReflectionContext *>(ContextRef);
+  std::vector<uint64_t> Counts;
+  if (!Context->readRuntimeCounters(Counts))
+    return 0;
+  for (size_t i = 0; i < Counts.size() && i < MaxCount; ++i)
+    OutCounts[i] = Counts[i];
+  return Counts.size();
+}
+
+const char *swift_reflection_runtimeCounterName(size_t Index) {
+  static const char *const Names[] = {
+#define RUNTIME_COUNTER(Name) #Name,
+#include "swift/Runtime/RuntimeCounters.def"
+  };
+  if (Index >= sizeof(Names) / sizeof(Names[0]))
+    return nullptr;
+  return Names[Index];
+}
+
 swift_typeref_t
 swift_reflection_typeRefForMetadata(SwiftReflectionContextRef ContextRef,
                                     uintptr_t Metadata) {
@@ -253,6 +282,66 @@ swift_reflection_childOfInstance(SwiftReflectionContextRef ContextRef,
   return convertChild(TI, Index);
 }
 
+/// Appends the offsets of the strong references in a value of layout \p TI,
+/// which starts at \p Base, to \p Offsets.
+static void collectReferenceOffsets(const TypeInfo *TI, unsigned Base,
+                                    std::vector<unsigned> &Offsets) {
+  if (auto *ReferenceTI = dyn_cast<ReferenceTypeInfo>(TI)) {
+    if (ReferenceTI->getReferenceKind() == ReferenceKind::Strong)
+      Offsets.push_back(Base);
+    return;
+  }
+  if (auto *RecordTI = dyn_cast<RecordTypeInfo>(TI))
+    for (auto &Field : RecordTI->getFields())
+      collectReferenceOffsets(&Field.TI, Base + Field.Offset, Offsets);
+}
+
+size_t
+swift_reflection_infoForInstances(SwiftReflectionContextRef ContextRef,
+                                  const uintptr_t *Objects,
+                                  size_t Count,
+                                  swift_typeinfo_t *OutInfos,
+                                  unsigned *OutNumReferences,
+                                  unsigned *OutReferenceOffsets,
+                                  size_t MaxReferenceOffsets) {
+  auto Context = reinterpret_cast<NativeReflectionContext *>(ContextRef);
+
+  // Class instances share the layout of their class, whose references are
+  // collected once. The layout of a closure context is computed for each
+  // context, so its references are collected each time.
+  llvm::DenseMap<const TypeInfo *, std::vector<unsigned>> ClassReferences;
+  std::vector<unsigned> ContextReferences;
+
+  size_t NumStored = 0;
+  for (size_t i = 0; i < Count; ++i) {
+    auto *TI = Context->getInstanceTypeInfo(Objects[i]);
+    OutInfos[i] = convertTypeInfo(TI);
+    OutNumReferences[i] = 0;
+    if (TI == nullptr)
+      continue;
+
+    const std::vector<unsigned> *References;
+    if (OutInfos[i].Kind == SWIFT_CLASS_INSTANCE) {
+      auto Inserted = ClassReferences.insert({TI, {}});
+      if (Inserted.second)
+        collectReferenceOffsets(TI, 0, Inserted.first->second);
+      References = &Inserted.first->second;
+    } else {
+      ContextReferences.clear();
+      collectReferenceOffsets(TI, 0, ContextReferences);
+      References = &ContextReferences;
+    }
+
+    OutNumReferences[i] = References->size();
+    for (unsigned Offset : *References) {
+      if (NumStored < MaxReferenceOffsets)
+        OutReferenceOffsets[NumStored] = Offset;
+      ++NumStored;
+    }
+  }
+  return NumStored;
+}
+
 int swift_reflection_projectExistential(SwiftReflectionContextRef ContextRef,
                                         swift_addr_t ExistentialAddress,
                                         swift_typeref_t ExistentialTypeRef,
@@ -51,6 +51,15 @@ struct HeapObject {
     , refCount(StrongRefCount::Initialized)
     , weakRefCount(WeakRefCount::Initialized)
   { }
+
+  // Initialize a HeapObject header for a statically initialized object,
+  // which is never deallocated.
+  constexpr HeapObject(HeapMetadata const *newMetadata,
+                       StrongRefCount::Immortal_t immortal)
+    : metadata(newMetadata)
+    , refCount(immortal)
+    , weakRefCount(WeakRefCount::Initialized)
+  { }
 #endif
 };
 
@@ -48,6 +48,8 @@ int _swift_stdlib_putchar_unlocked(int c);
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_size_t _swift_stdlib_fwrite_stdout(const void *ptr, __swift_size_t size,
                                            __swift_size_t nitems);
+SWIFT_RUNTIME_STDLIB_INTERFACE
+int _swift_stdlib_fflush_stdout(void);
 
 // String handling <string.h>
 __attribute__((__pure__)) SWIFT_RUNTIME_STDLIB_INTERFACE __swift_size_t
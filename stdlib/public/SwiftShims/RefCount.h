@@ -56,6 +56,14 @@ class StrongRefCount {
   // The next bit is the deallocating marker.
   // The remaining bits are the reference count.
   // refCount == RC_ONE means reference count == 1.
+  //
+  // The high bit of the reference count marks immortal objects, which are
+  // never deallocated. No other object gets anywhere near that many
+  // references. Retains and releases of immortal objects don't write the
+  // reference count at all, so that threads sharing one don't contend for
+  // its cache line. Immortal objects start out with a count in the middle of
+  // the immortal range, so that even unchecked changes of the count can't
+  // carry them out of it.
   enum : uint32_t {
     RC_PINNED_FLAG = 0x1,
     RC_DEALLOCATING_FLAG = 0x2,
@@ -64,7 +72,10 @@ class StrongRefCount {
     RC_FLAGS_MASK = 3,
     RC_COUNT_MASK = ~RC_FLAGS_MASK,
 
-    RC_ONE = RC_FLAGS_MASK + 1
+    RC_ONE = RC_FLAGS_MASK + 1,
+
+    RC_IMMORTAL_FLAG = 0x80000000,
+    RC_IMMORTAL_INITIAL_VALUE = RC_IMMORTAL_FLAG | (RC_IMMORTAL_FLAG >> 1)
   };
 
   static_assert(RC_ONE == RC_DEALLOCATING_FLAG << 1,
@@ -76,6 +87,7 @@ class StrongRefCount {
 
  public:
   enum Initialized_t { Initialized };
+  enum Immortal_t { Immortal };
 
   // StrongRefCount must be trivially constructible to avoid ObjC++
   // destruction overhead at runtime. Use StrongRefCount(Initialized) to produce
@@ -86,28 +98,41 @@ class StrongRefCount {
   constexpr StrongRefCount(Initialized_t)
     : refCount(RC_ONE) { }
 
+  // Refcount of an object which is never deallocated, for objects which are
+  // initialized statically.
+  constexpr StrongRefCount(Immortal_t)
+    : refCount(RC_IMMORTAL_INITIAL_VALUE) { }
+
   void init() {
     refCount = RC_ONE;
   }
 
   // Increment the reference count.
   void increment() {
+    if (isImmortal())
+      return;
     __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
   }
 
   void incrementNonAtomic() {
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    if (val & RC_IMMORTAL_FLAG)
+      return;
     val += RC_ONE;
     __atomic_store_n(&refCount, val, __ATOMIC_RELAXED);
   }
 
   // Increment the reference count by n.
   void increment(uint32_t n) {
+    if (isImmortal())
+      return;
     __atomic_fetch_add(&refCount, n << RC_FLAGS_COUNT, __ATOMIC_RELAXED);
   }
 
   void incrementNonAtomic(uint32_t n) {
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    if (val & RC_IMMORTAL_FLAG)
+      return;
     val += n << RC_FLAGS_COUNT;
     __atomic_store_n(&refCount, val, __ATOMIC_RELAXED);
  }
@@ -120,12 +145,14 @@ class StrongRefCount {
   //
   // Returns true if the flag was set by this operation.
   //
-  // Postcondition: the flag is set.
+  // Postcondition: the flag is set, or the object is immortal. Immortal
+  // objects are never pinned, so they are never uniquely referenced or
+  // pinned either.
   bool tryIncrementAndPin() {
     uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
     while (true) {
       // If the flag is already set, just fail.
-      if (oldval & RC_PINNED_FLAG) {
+      if (oldval & (RC_PINNED_FLAG | RC_IMMORTAL_FLAG)) {
         return false;
       }
 
@@ -143,7 +170,7 @@ class StrongRefCount {
   bool tryIncrementAndPinNonAtomic() {
     uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
     // If the flag is already set, just fail.
-    if (oldval & RC_PINNED_FLAG) {
+    if (oldval & (RC_PINNED_FLAG | RC_IMMORTAL_FLAG)) {
       return false;
     }
 
@@ -155,6 +182,8 @@ class StrongRefCount {
 
   // Increment the reference count, unless the object is deallocating.
   bool tryIncrement() {
+    if (isImmortal())
+      return true;
     // FIXME: this could be better on LL/SC architectures like arm64
     uint32_t oldval = __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
     if (oldval & RC_DEALLOCATING_FLAG) {
@@ -237,6 +266,11 @@ class StrongRefCount {
     return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_DEALLOCATING_FLAG;
   }
 
+  // Return true if the object is immortal.
+  bool isImmortal() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_IMMORTAL_FLAG;
+  }
+
 private:
   template <bool ClearPinnedFlag>
   bool doDecrementShouldDeallocate() {
@@ -244,6 +278,8 @@ private:
     // it's already set.
     constexpr uint32_t quantum =
       (ClearPinnedFlag ? RC_ONE + RC_PINNED_FLAG : RC_ONE);
+    if (isImmortal())
+      return false;
     uint32_t newval = __atomic_sub_fetch(&refCount, quantum, __ATOMIC_RELEASE);
 
     assert((!ClearPinnedFlag || !(newval & RC_PINNED_FLAG)) &&
@@ -282,6 +318,8 @@ private:
     constexpr uint32_t quantum =
       (ClearPinnedFlag ? RC_ONE + RC_PINNED_FLAG : RC_ONE);
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    if (val & RC_IMMORTAL_FLAG)
+      return false;
     val -= quantum;
     __atomic_store_n(&refCount, val, __ATOMIC_RELEASE);
     uint32_t newval = refCount;
@@ -320,6 +358,8 @@ private:
     // If we're being asked to clear the pinned flag, we can assume
     // it's already set.
     uint32_t delta = (n << RC_FLAGS_COUNT) + (ClearPinnedFlag ? RC_PINNED_FLAG : 0);
+    if (isImmortal())
+      return false;
     uint32_t newval = __atomic_sub_fetch(&refCount, delta, __ATOMIC_RELEASE);
 
     assert((!ClearPinnedFlag || !(newval & RC_PINNED_FLAG)) &&
@@ -357,6 +397,8 @@ private:
     // it's already set.
     uint32_t delta = (n << RC_FLAGS_COUNT) + (ClearPinnedFlag ? RC_PINNED_FLAG : 0);
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    if (val & RC_IMMORTAL_FLAG)
+      return false;
     val -= delta;
     __atomic_store_n(&refCount, val, __ATOMIC_RELEASE);
     uint32_t newval = val;
@@ -478,6 +520,175 @@ class WeakRefCount {
   }
 };
 
+
+// Biased strong reference count.
+//
+// Most objects are only ever retained and released by the thread that
+// created them. A biased reference count splits the count into a biased
+// count, which only the owning thread updates and which needs no atomic
+// operations, and a shared count, which all other threads update atomically.
+//
+// The object can only be deallocated once the two counts are merged. The
+// owning thread merges them when the biased count drops to zero. If another
+// thread's release drops the shared count below zero, the references of the
+// owner have been handed over to other threads, and the owning thread must
+// be asked to merge (decrementShouldDeallocate returns NeedsMerge exactly
+// once per object); it does so by calling merge().
+//
+// Barriers are the same as for StrongRefCount.
+//
+// The layout of HeapObject is fixed by the ABI, so objects use
+// StrongRefCount. This count is available to runtime clients which manage
+// their own object headers.
+
+class BiasedRefCount {
+  // The thread which owns the biased count, or 0 once the counts are merged.
+  uintptr_t ownerThread;
+
+  // Only accessed by the owning thread.
+  uint32_t biasedCount;
+
+  // The low bits are flags.
+  // The remaining bits are the shared reference count, which may be
+  // negative until the counts are merged.
+  int32_t sharedCount;
+
+  enum : int32_t {
+    RC_MERGED_FLAG = 0x1,
+    RC_QUEUED_FLAG = 0x2,
+
+    RC_FLAGS_COUNT = 2,
+    RC_FLAGS_MASK = 3,
+
+    RC_ONE = RC_FLAGS_MASK + 1
+  };
+
+  static uintptr_t getCurrentThread() {
+    static thread_local char threadMarker;
+    return reinterpret_cast<uintptr_t>(&threadMarker);
+  }
+
+  static int32_t getSharedCount(int32_t value) {
+    return value >> RC_FLAGS_COUNT;
+  }
+
+  bool isOwnedByCurrentThread() const {
+    return __atomic_load_n(&ownerThread, __ATOMIC_RELAXED) ==
+      getCurrentThread();
+  }
+
+ public:
+  enum class DecrementResult {
+    // The object is still referenced, or another release deallocates it.
+    Done,
+    // The caller should now deallocate the object.
+    Deallocate,
+    // The caller must ask the owning thread to call merge().
+    NeedsMerge
+  };
+
+  BiasedRefCount() = default;
+
+  // Refcount of a new object is 1, owned by the current thread.
+  void init() {
+    ownerThread = getCurrentThread();
+    biasedCount = 1;
+    sharedCount = 0;
+  }
+
+  // Increment the reference count.
+  void increment() {
+    if (isOwnedByCurrentThread()) {
+      ++biasedCount;
+      return;
+    }
+    __atomic_fetch_add(&sharedCount, RC_ONE, __ATOMIC_RELAXED);
+  }
+
+  // Decrement the reference count.
+  DecrementResult decrementShouldDeallocate() {
+    if (isOwnedByCurrentThread()) {
+      assert(biasedCount > 0 && "releasing reference with a count of zero");
+      if (--biasedCount != 0)
+        return DecrementResult::Done;
+      return doMerge(/*FromQueue=*/false) ? DecrementResult::Deallocate
+                                          : DecrementResult::Done;
+    }
+
+    int32_t newval =
+      __atomic_sub_fetch(&sharedCount, RC_ONE, __ATOMIC_RELEASE);
+    if (newval & RC_MERGED_FLAG) {
+      assert(getSharedCount(newval) >= 0 &&
+             "releasing reference with a count of zero");
+      if (getSharedCount(newval) != 0)
+        return DecrementResult::Done;
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      return DecrementResult::Deallocate;
+    }
+    if (getSharedCount(newval) >= 0 || (newval & RC_QUEUED_FLAG))
+      return DecrementResult::Done;
+
+    // The owner holds fewer references than its biased count says. Ask it to
+    // merge, unless it merged in the meantime: then the merge accounted for
+    // this release and whoever drops the merged count to zero deallocates.
+    int32_t oldval = newval;
+    while (!(oldval & (RC_MERGED_FLAG | RC_QUEUED_FLAG))) {
+      if (__atomic_compare_exchange_n(&sharedCount, &oldval,
+                                      oldval | RC_QUEUED_FLAG, false,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        return DecrementResult::NeedsMerge;
+    }
+    return DecrementResult::Done;
+  }
+
+  // Merge the biased count into the shared count on behalf of another
+  // thread's NeedsMerge request.
+  // Return true if the caller should now deallocate the object.
+  //
+  // Precondition: called on the owning thread.
+  bool merge() {
+    assert(isOwnedByCurrentThread() && "merging on a non-owning thread");
+    return doMerge(/*FromQueue=*/true);
+  }
+
+  // Return the reference count. Only exact on the owning thread or after the
+  // counts are merged.
+  uint32_t getCount() const {
+    int32_t shared = getSharedCount(
+      __atomic_load_n(&sharedCount, __ATOMIC_RELAXED));
+    if (!isOwnedByCurrentThread())
+      return shared;
+    return biasedCount + shared;
+  }
+
+  // Return true if the biased count has been merged into the shared count.
+  bool isMerged() const {
+    return __atomic_load_n(&sharedCount, __ATOMIC_RELAXED) & RC_MERGED_FLAG;
+  }
+
+private:
+  bool doMerge(bool FromQueue) {
+    int32_t oldval = __atomic_load_n(&sharedCount, __ATOMIC_RELAXED);
+    while (true) {
+      assert(!(oldval & RC_MERGED_FLAG) && "counts are already merged");
+      // A queued merge is pending, so this object is still referenced by the
+      // queue; let the queued merge decide.
+      if (!FromQueue && (oldval & RC_QUEUED_FLAG))
+        return false;
+      int32_t newval =
+        (oldval + int32_t(biasedCount) * RC_ONE) | RC_MERGED_FLAG;
+      if (__atomic_compare_exchange_n(&sharedCount, &oldval, newval, false,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        biasedCount = 0;
+        __atomic_store_n(&ownerThread, 0, __ATOMIC_RELAXED);
+        assert(getSharedCount(newval) >= 0 &&
+               "releasing reference with a count of zero");
+        return getSharedCount(newval) == 0;
+      }
+    }
+  }
+};
+
 static_assert(swift::IsTriviallyConstructible<StrongRefCount>::value,
               "StrongRefCount must be trivially initializable");
 static_assert(swift::IsTriviallyConstructible<WeakRefCount>::value,
@@ -486,6 +697,8 @@ static_assert(std::is_trivially_destructible<StrongRefCount>::value,
               "StrongRefCount must be trivially destructible");
 static_assert(std::is_trivially_destructible<WeakRefCount>::value,
               "WeakRefCount must be trivially destructible");
+static_assert(std::is_trivially_destructible<BiasedRefCount>::value,
+              "BiasedRefCount must be trivially destructible");
 
 // __cplusplus
 #endif
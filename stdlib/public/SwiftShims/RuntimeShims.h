@@ -75,6 +75,24 @@ int _swift_stdlib_putc_stderr(int C);
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_size_t _swift_stdlib_getHardwareConcurrency();
 
+/// Resize the allocation of a uniquely referenced native object to \p Size
+/// bytes with `realloc`, and update the reference at \p ObjectRef.  The
+/// contents of the object are moved bitwise.
+///
+/// Returns 0, leaving the object untouched, if the object can't be
+/// reallocated, e.g. because it is not on the heap, it has unowned or weak
+/// references, or it requires more alignment than `realloc` provides.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+int _swift_stdlib_reallocateUniqueObject(
+  void * _Nonnull ObjectRef, __swift_size_t Size, __swift_size_t AlignMask);
+
+/// Calls `Body(Context, I)` for every `I` in `0..<Count`, concurrently on up
+/// to one thread per processor, and returns when all calls have returned.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+void _swift_stdlib_parallelFor(
+  __swift_intptr_t Count, void * _Nonnull Context,
+  void (* _Nonnull Body)(void * _Nonnull Context, __swift_intptr_t I));
+
 #ifdef __cplusplus
 }} // extern "C", namespace swift
 #endif
@@ -31,6 +31,37 @@ SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_ssize_t
 swift_stdlib_readLine_stdin(char * _Nullable * _Nonnull LinePtr);
 
+/// The state of a SipHash-1-3 hasher.  This is the storage of `_Hasher`.
+struct _SwiftHasherState {
+  __swift_uint64_t v0;
+  __swift_uint64_t v1;
+  __swift_uint64_t v2;
+  __swift_uint64_t v3;
+  /// The appended bytes which do not fill a word yet, starting with the
+  /// lowest byte.  The other bytes are zero.
+  __swift_uint64_t tail;
+  /// The number of bytes appended so far.
+  __swift_uint64_t byteCount;
+};
+
+/// The key for hashing with SipHash.
+struct _SwiftHashingSeed {
+  __swift_uint64_t k0;
+  __swift_uint64_t k1;
+};
+
+/// Returns a random seed for the hash values of this process, or a fixed seed
+/// if the environment variable SWIFT_DETERMINISTIC_HASHING is set.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+struct _SwiftHashingSeed _swift_stdlib_Hashing_makeSeed(void);
+
+/// Appends `Count` bytes starting at `Bytes` to the hasher `State`.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+void
+_swift_stdlib_Hasher_appendBytes(struct _SwiftHasherState * _Nonnull State,
+                                 const void * _Nonnull Bytes,
+                                 __swift_intptr_t Count);
+
 SWIFT_END_NULLABILITY_ANNOTATIONS
 
 #ifdef __cplusplus
@@ -96,6 +96,22 @@ __swift_int32_t _swift_stdlib_unicode_strToLower(
   __swift_uint16_t *Destination, __swift_int32_t DestinationCapacity,
   const __swift_uint16_t *Source, __swift_int32_t SourceLength);
 
+/// Returns the number of UTF-16 code units needed to represent the UTF-8
+/// data `[Src, Src + Length)`, or -1 if the data is ill-formed. The data is
+/// ASCII if and only if the result is `Length`.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+__attribute__((__pure__)) __swift_intptr_t
+_swift_stdlib_utf8_validated_utf16_length(const __swift_uint8_t *Src,
+                                          __swift_intptr_t Length);
+
+/// Transcodes the well-formed UTF-8 data `[Src, Src + Length)` to UTF-16.
+/// `Dest` must have room for the number of code units returned by
+/// `_swift_stdlib_utf8_validated_utf16_length`.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+void _swift_stdlib_utf8_to_utf16(const __swift_uint8_t *Src,
+                                 __swift_intptr_t Length,
+                                 __swift_uint16_t *Dest);
+
 #ifdef __cplusplus
 }} // extern "C", namespace swift
 #endif
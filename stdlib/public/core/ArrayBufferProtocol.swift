@@ -53,6 +53,18 @@ public protocol _ArrayBufferProtocol
     minimumCapacity: Int
   ) -> _ContiguousArrayBuffer<Element>?
 
+  /// If this buffer is backed by a uniquely-referenced mutable
+  /// `_ContiguousArrayBuffer` whose storage can be reallocated, grows the
+  /// storage to hold at least `minimumCapacity` elements and returns `true`.
+  /// Otherwise, returns `false`.
+  ///
+  /// - Note: This function must remain mutating; otherwise the buffer
+  ///   may acquire spurious extra references, which will cause
+  ///   unnecessary reallocation.
+  mutating func reallocateUniqueMutableBackingBuffer(
+    minimumCapacity: Int
+  ) -> Bool
+
   /// Returns `true` iff this buffer is backed by a uniquely-referenced mutable
   /// _ContiguousArrayBuffer.
   ///
@@ -131,6 +143,12 @@ extension _ArrayBufferProtocol where Index == Int {
     return firstElementAddress
   }
 
+  public mutating func reallocateUniqueMutableBackingBuffer(
+    minimumCapacity: Int
+  ) -> Bool {
+    return false
+  }
+
   public mutating func replace<C>(
     subRange: Range<Int>,
     with newCount: Int,
@@ -40,6 +40,9 @@ internal enum _BridgeStyle {
 
 /// Implements `source as! [TargetElement]`.
 ///
+/// O(1) if both `SourceElement` and `TargetElement` are class types or ObjC
+/// existentials: the elements are checked when they are accessed.
+///
 /// - Precondition: At least one of `SourceElement` and `TargetElement` is a
 /// class type or ObjC existential.  May trap for other "valid" inputs when
 /// `TargetElement` is not bridged verbatim, if an element can't be converted.
@@ -53,12 +56,14 @@ public func _arrayForceCast<SourceElement, TargetElement>(
     let native = source._buffer.requestNativeBuffer()
     
     if _fastPath(native != nil) {
-      if _fastPath(native!.storesOnlyElementsOfType(TargetElement.self)) {
-        // A native buffer that is known to store only elements of the
+      if _fastPath(native!._storage.staticElementType is TargetElement.Type) {
+        // A native buffer whose storage can only hold elements of the
         // TargetElement can be used directly
         return Array(source._buffer.cast(toBufferOf: TargetElement.self))
       }
-      // Other native buffers must use deferred element type checking
+      // Other native buffers use deferred element type checking, instead of
+      // checking all elements first, so that casting the same storage again
+      // is O(1)
       return Array(
         source._buffer.downcast(
           toBufferWithDeferredTypeCheckOf: TargetElement.self))
@@ -138,6 +138,16 @@ extension String {
       return nil
     }
     let len = encoding._nullCodeUnitOffset(in: cString)
+    if encoding == UTF8.self {
+      let utf8 = UnsafeBufferPointer<UTF8.CodeUnit>(
+        start: UnsafePointer(cString), count: len)
+      if let core = _StringCore._fromShortASCII(utf8) {
+        return (result: String(core), repairsMade: false)
+      }
+      if let stringBuffer = _StringBuffer._fromUTF8(utf8) {
+        return (result: String(_storage: stringBuffer), repairsMade: false)
+      }
+    }
     let buffer = UnsafeBufferPointer<Encoding.CodeUnit>(
       start: cString, count: len)
 
@@ -300,6 +300,37 @@ public struct _ContiguousArrayBuffer<Element> : _ArrayBufferProtocol {
     return nil
   }
 
+  /// Grows the storage with `realloc`, which doesn't need to copy the
+  /// elements if the allocator can extend the allocation in place.  The new
+  /// capacity includes all of the space the allocator gives us.
+  ///
+  /// Only storage of POD elements is reallocated, since other elements may
+  /// not be moved bitwise.  The empty array storage is statically allocated
+  /// and never reallocated.
+  public mutating func reallocateUniqueMutableBackingBuffer(
+    minimumCapacity: Int
+  ) -> Bool {
+    if !_isPOD(Element.self) || capacity == 0 || !isUniquelyReferenced() {
+      return false
+    }
+    typealias Manager = ManagedBufferPointer<_ArrayBody, Element>
+    let size = Manager._elementOffset
+      + Swift.max(minimumCapacity, count) * strideof(Element.self)
+    let reallocated = withUnsafeMutablePointer(&__bufferPointer) {
+      _swift_stdlib_reallocateUniqueObject(
+        UnsafeMutablePointer($0), UInt(size), UInt(Manager._alignmentMask))
+    }
+    if reallocated == 0 {
+      return false
+    }
+    let body = __bufferPointer.value
+    __bufferPointer._valuePointer.pointee = _ArrayBody(
+      count: body.count,
+      capacity: __bufferPointer.capacity,
+      elementTypeIsBridgedVerbatim: body.elementTypeIsBridgedVerbatim)
+    return true
+  }
+
   public mutating func isMutableAndUniquelyReferenced() -> Bool {
     return isUniquelyReferenced()
   }
@@ -506,6 +537,12 @@ public func += <Element, C : Collection>(
     lhs.count = newCount
     (lhs.firstElementAddress + oldCount).initializeFrom(rhs)
   }
+  else if lhs.reallocateUniqueMutableBackingBuffer(
+    minimumCapacity: Swift.max(newCount, _growArrayCapacity(lhs.capacity))
+  ) {
+    lhs.count = newCount
+    (lhs.firstElementAddress + oldCount).initializeFrom(rhs)
+  }
   else {
     var newLHS = _ContiguousArrayBuffer<Element>(
       uninitializedCount: newCount,
@@ -647,7 +684,16 @@ internal struct _UnsafePartiallyInitializedContiguousArrayBuffer<Element> {
   mutating func add(_ element: Element) {
     if remainingCapacity == 0 {
       // Reallocate.
-      let newCapacity = max(_growArrayCapacity(result.capacity), 1)
+      let oldCapacity = result.capacity
+      let newCapacity = max(_growArrayCapacity(oldCapacity), 1)
+      if result.reallocateUniqueMutableBackingBuffer(
+        minimumCapacity: newCapacity
+      ) {
+        p = result.firstElementAddress + oldCapacity
+        remainingCapacity = result.capacity - oldCapacity
+        addWithExistingCapacity(element)
+        return
+      }
       var newResult = _ContiguousArrayBuffer<Element>(
         uninitializedCount: newCapacity, minimumCapacity: 0)
       p = newResult.firstElementAddress + result.capacity
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+//
+// This file implements a streaming hasher for combining the components of a
+// hash value.
+//
+// The hasher implements SipHash-1-3, keyed with a seed which the runtime
+// chooses randomly for each process.  Hash values computed with it are thus
+// not stable across executions.  Setting the environment variable
+// SWIFT_DETERMINISTIC_HASHING makes the runtime use a fixed seed.
+//
+
+import SwiftShims
+
+@inline(__always)
+internal func _rotateLeft(_ x: UInt64, by amount: UInt64) -> UInt64 {
+  return (x << amount) | (x >> (64 - amount))
+}
+
+/// A hasher which combines a sequence of words and bytes into a hash value.
+///
+/// Use a hasher to implement `hashValue` for a type with several components,
+/// instead of combining their hash values with `^` or `&+`, which maps many
+/// different values to the same hash value:
+///
+///     var hasher = _Hasher()
+///     hasher.append(x)
+///     hasher.append(y)
+///     return hasher.finalize()
+///
+/// The hash value depends on the order in which components are appended.
+public struct _Hasher {
+  internal var _state: _SwiftHasherState
+
+  internal static let _executionSeed: (UInt64, UInt64) = {
+    let seed = _swift_stdlib_Hashing_makeSeed()
+    return (seed.k0, seed.k1)
+  }()
+
+  /// Creates a hasher keyed with the seed of this process.
+  public init() {
+    let seedOverride = _HashingDetail.fixedSeedOverride
+    if _slowPath(seedOverride != 0) {
+      self.init(seed: (seedOverride, 0))
+    } else {
+      self.init(seed: _Hasher._executionSeed)
+    }
+  }
+
+  /// Creates a hasher keyed with `seed`.
+  public // @testable
+  init(seed: (UInt64, UInt64)) {
+    _state = _SwiftHasherState(
+      v0: seed.0 ^ 0x736f_6d65_7073_6575,
+      v1: seed.1 ^ 0x646f_7261_6e64_6f6d,
+      v2: seed.0 ^ 0x6c79_6765_6e65_7261,
+      v3: seed.1 ^ 0x7465_6462_7974_6573,
+      tail: 0,
+      byteCount: 0)
+  }
+
+  /// Mixes one message word into `state`.  Must match `sipCompress` in
+  /// Stubs.cpp.
+  @inline(__always)
+  internal static func _compress(
+    _ state: inout _SwiftHasherState, _ m: UInt64
+  ) {
+    state.v3 ^= m
+    _round(&state)
+    state.v0 ^= m
+  }
+
+  @inline(__always)
+  internal static func _round(_ state: inout _SwiftHasherState) {
+    state.v0 = state.v0 &+ state.v1
+    state.v1 = _rotateLeft(state.v1, by: 13)
+    state.v1 ^= state.v0
+    state.v0 = _rotateLeft(state.v0, by: 32)
+    state.v2 = state.v2 &+ state.v3
+    state.v3 = _rotateLeft(state.v3, by: 16)
+    state.v3 ^= state.v2
+    state.v0 = state.v0 &+ state.v3
+    state.v3 = _rotateLeft(state.v3, by: 21)
+    state.v3 ^= state.v0
+    state.v2 = state.v2 &+ state.v1
+    state.v1 = _rotateLeft(state.v1, by: 17)
+    state.v1 ^= state.v2
+    state.v2 = _rotateLeft(state.v2, by: 32)
+  }
+
+  /// Appends the eight bytes of `value`, in little-endian order.
+  @inline(__always)
+  public mutating func append(_ value: UInt64) {
+    let tailByteCount = _state.byteCount & 7
+    if _fastPath(tailByteCount == 0) {
+      _Hasher._compress(&_state, value)
+    } else {
+      let shift = tailByteCount << 3
+      _Hasher._compress(&_state, _state.tail | (value << shift))
+      _state.tail = value >> (64 - shift)
+    }
+    _state.byteCount = _state.byteCount &+ 8
+  }
+
+  /// Appends `value` as a 64-bit word, on all platforms.
+  @inline(__always)
+  public mutating func append(_ value: Int) {
+    append(UInt64(bitPattern: Int64(value)))
+  }
+
+  /// Appends the hash value of `value`.
+  @inline(__always)
+  public mutating func append<H : Hashable>(_ value: H) {
+    append(value.hashValue)
+  }
+
+  /// Appends the `count` bytes starting at `bytes`.
+  public mutating func append(bytes: UnsafePointer<UInt8>, count: Int) {
+    _precondition(count >= 0, "Can't append a negative number of bytes")
+    _swift_stdlib_Hasher_appendBytes(&_state, bytes, count)
+  }
+
+  /// Returns the hash value of everything appended so far.
+  public func finalize() -> Int {
+    var state = _state
+    _Hasher._compress(&state, state.tail | (state.byteCount << 56))
+    state.v2 ^= 0xff
+    _Hasher._round(&state)
+    _Hasher._round(&state)
+    _Hasher._round(&state)
+    let result = state.v0 ^ state.v1 ^ state.v2 ^ state.v3
+    return Int(truncatingBitPattern: result)
+  }
+}
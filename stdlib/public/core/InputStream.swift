@@ -59,10 +59,15 @@ public func readLine(strippingNewline: Bool = true) -> String? {
       }
     }
   }
-  let result = String._fromCodeUnitSequenceWithRepair(UTF8.self,
-    input: UnsafeMutableBufferPointer(
-      start: UnsafeMutablePointer<UTF8.CodeUnit>(linePtr),
-      count: readBytes)).0
+  let lineBytes = UnsafeBufferPointer(
+    start: UnsafePointer<UTF8.CodeUnit>(linePtr), count: readBytes)
+  let result: String
+  if let stringBuffer = _StringBuffer._fromUTF8(lineBytes) {
+    result = String(_storage: stringBuffer)
+  } else {
+    result = String._fromCodeUnitSequenceWithRepair(UTF8.self,
+      input: lineBytes).0
+  }
   _swift_stdlib_free(linePtr)
   return result
 }
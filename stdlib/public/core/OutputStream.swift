@@ -463,29 +463,78 @@ internal func _dumpPrint_unlocked<T, TargetStream : OutputStream>(
 // OutputStreams
 //===----------------------------------------------------------------------===//
 
+/// The number of bytes `_Stdout` collects before passing them to stdio.
+internal var _stdoutBufferCapacity: Int {
+  return 4096
+}
+
+/// Storage for the UTF-8 which `_Stdout` has collected.  It is only used
+/// while the stdout lock is held, so it is never accessed concurrently.
+internal struct _StdoutBuffer {
+  let start = UnsafeMutablePointer<UTF8.CodeUnit>(
+    allocatingCapacity: _stdoutBufferCapacity)
+  var count = 0
+}
+
+internal var _stdoutBuffer = _StdoutBuffer()
+
+/// Writes to the standard output.
+///
+/// The text of a whole `print` call is collected in `_stdoutBuffer` and
+/// passed to stdio with a single call when the stream is unlocked.  Long
+/// ASCII strings are passed to stdio directly, without copying.
 internal struct _Stdout : OutputStream {
   mutating func _lock() {
     _swift_stdlib_flockfile_stdout()
   }
 
   mutating func _unlock() {
+    _flushBuffer()
     _swift_stdlib_funlockfile_stdout()
   }
 
+  internal func _flushBuffer() {
+    let count = _stdoutBuffer.count
+    if count != 0 {
+      _swift_stdlib_fwrite_stdout(_stdoutBuffer.start, count, 1)
+      _stdoutBuffer.count = 0
+    }
+  }
+
   mutating func write(_ string: String) {
     if string.isEmpty { return }
 
     if string._core.isASCII {
       defer { _fixLifetime(string) }
 
-      _swift_stdlib_fwrite_stdout(UnsafePointer(string._core.startASCII),
-                                  string._core.count, 1)
+      let count = string._core.count
+      if count > _stdoutBufferCapacity - _stdoutBuffer.count {
+        _flushBuffer()
+        if count >= _stdoutBufferCapacity {
+          _swift_stdlib_fwrite_stdout(
+            UnsafePointer(string._core.startASCII), count, 1)
+          return
+        }
+      }
+      _memcpy(
+        dest: UnsafeMutablePointer(_stdoutBuffer.start + _stdoutBuffer.count),
+        src: UnsafeMutablePointer(string._core.startASCII),
+        size: UInt(count))
+      _stdoutBuffer.count += count
       return
     }
 
+    let start = _stdoutBuffer.start
+    var count = _stdoutBuffer.count
     for c in string.utf8 {
-      _swift_stdlib_putchar_unlocked(Int32(c))
+      if count == _stdoutBufferCapacity {
+        _swift_stdlib_fwrite_stdout(start, count, 1)
+        count = 0
+      }
+      start[count] = c
+      count += 1
     }
+    _stdoutBuffer.count = count
   }
 }
 
@@ -71,6 +71,15 @@ public func debugPrint(
   }
 }
 
+/// Writes the output of `print`, `debugPrint` and `dump`, which the C
+/// standard library may still be buffering, to the standard output.
+///
+/// Every call of `print` hands its output to the C standard library before
+/// it returns, so the output of all finished calls is written.
+public func _flushStandardOutput() {
+  _swift_stdlib_fflush_stdout()
+}
+
 /// Writes the textual representations of `items`, separated by
 /// `separator` and terminated by `terminator`, into `output`.
 ///
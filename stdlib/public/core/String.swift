@@ -348,6 +348,12 @@ extension String : _BuiltinUnicodeScalarLiteralConvertible {
   @effects(readonly)
   public // @testable
   init(_builtinUnicodeScalarLiteral value: Builtin.Int32) {
+    let scalar = UInt32(value)
+    if scalar <= 0x7f {
+      self = String(_StringCore(
+        _singleASCII: UTF8.CodeUnit(truncatingBitPattern: scalar)))
+      return
+    }
     self = String._fromWellFormedCodeUnitSequence(
       UTF32.self, input: CollectionOfOne(UInt32(value)))
   }
@@ -529,6 +535,57 @@ public func ==(lhs: String, rhs: String) -> Bool {
   return lhs._compareString(rhs) == 0
 }
 
+/// Returns the number of the case of a `switch` over a `String` which is
+/// equal to `string`, or -1 if there is none.
+///
+/// The compiler calls this for the cases of a `switch` which are distinct
+/// ASCII string literals, and compares the result with the number of each
+/// case, rather than calling `~=` for every case in turn. The cases are laid
+/// out one after the other, each preceded by a byte with its length.
+@_semantics("stdlib_binary_only")
+public // COMPILER_INTRINSIC
+func _findStringSwitchCase(
+  _ string: String,
+  _casesStart: Builtin.RawPointer,
+  _casesLength: Builtin.Word
+) -> Builtin.Word {
+  let cases = UnsafePointer<UInt8>(_casesStart)
+  let end = Int(_casesLength)
+  var offset = 0
+  var number = 0
+  if string._core.isASCII {
+    // ASCII strings are only equal to strings with the same bytes.
+    let count = string._core.count
+    while offset < end {
+      let caseCount = Int(cases[offset])
+      offset += 1
+      if caseCount == count &&
+         _swift_stdlib_memcmp(string._core.startASCII, cases + offset,
+                              count) == 0 {
+        return number._builtinWordValue
+      }
+      offset += caseCount
+      number += 1
+    }
+    return (-1)._builtinWordValue
+  }
+
+  // Other strings may still be canonically equivalent to an ASCII case.
+  while offset < end {
+    let caseCount = Int(cases[offset])
+    offset += 1
+    let caseString = String._fromWellFormedCodeUnitSequence(
+      UTF8.self,
+      input: UnsafeBufferPointer(start: cases + offset, count: caseCount))
+    if string == caseString {
+      return number._builtinWordValue
+    }
+    offset += caseCount
+    number += 1
+  }
+  return (-1)._builtinWordValue
+}
+
 extension String : Comparable {
 }
 
@@ -97,6 +97,18 @@ internal func _cocoaStringReadAll(
       location: 0, length: _swift_stdlib_CFStringGetLength(source)), destination)
 }
 
+/// Copies the UTF-16 code units of `source` in `range` to `destination`
+/// with a single call into CF.
+@inline(never) @_semantics("stdlib_binary_only") // Hide the CF dependency
+internal func _cocoaStringRead(
+  _ source: _CocoaString, _ range: Range<Int>,
+  _ destination: UnsafeMutablePointer<UTF16.CodeUnit>
+) {
+  _swift_stdlib_CFStringGetCharacters(
+    source, _swift_shims_CFRange(
+      location: range.lowerBound, length: range.count), destination)
+}
+
 @inline(never) @_semantics("stdlib_binary_only") // Hide the CF dependency
 internal func _cocoaStringSlice(
   _ target: _StringCore, _ bounds: Range<Int>
@@ -252,6 +264,19 @@ public final class _NSContiguousString : _SwiftNativeNSString {
     return _core.elementWidth == 2 ? _core.startUTF16 : nil
   }
 
+  /// Lets Foundation and CF read ASCII storage in place instead of one
+  /// character at a time.  Swift string storage isn't nul-terminated, so
+  /// there is no pointer to give out when termination is required.
+  @objc
+  func _fastCStringContents(
+    _ nullTerminationRequired: Bool
+  ) -> UnsafeMutablePointer<CChar>? {
+    if _core.elementWidth == 1 && !nullTerminationRequired {
+      return UnsafeMutablePointer(_core.startASCII)
+    }
+    return nil
+  }
+
   //
   // Implement sub-slicing without adding layers of wrapping
   //
@@ -135,6 +135,42 @@ public struct _StringBuffer {
     }
   }
 
+  /// Creates a buffer holding the UTF-8 data `input`, or returns `nil` if
+  /// the data is ill-formed.
+  ///
+  /// Validation and transcoding are done in bulk by the runtime, which is
+  /// much faster than decoding one scalar at a time.  Callers fall back to
+  /// `fromCodeUnits` for ill-formed data, which takes care of repairs.
+  static func _fromUTF8(
+    _ input: UnsafeBufferPointer<UTF8.CodeUnit>, minimumCapacity: Int = 0
+  ) -> _StringBuffer? {
+    guard let src = input.baseAddress else {
+      return _StringBuffer(
+        capacity: minimumCapacity, initialSize: 0, elementWidth: 1)
+    }
+    let utf16Count = _swift_stdlib_utf8_validated_utf16_length(
+      src, input.count)
+    if utf16Count < 0 {
+      return nil
+    }
+
+    let isAscii = utf16Count == input.count
+    let result = _StringBuffer(
+        capacity: max(utf16Count, minimumCapacity),
+        initialSize: utf16Count,
+        elementWidth: isAscii ? 1 : 2)
+    if isAscii {
+      _memcpy(
+        dest: UnsafeMutablePointer(result.start),
+        src: UnsafeMutablePointer(src),
+        size: UInt(utf16Count))
+    } else {
+      _swift_stdlib_utf8_to_utf16(
+        src, input.count, result._storage.baseAddress)
+    }
+    return result
+  }
+
   /// A pointer to the start of this buffer's data area.
   public // @testable
   var start: UnsafeMutablePointer<_RawByte> {
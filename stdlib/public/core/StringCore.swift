@@ -173,6 +173,34 @@ public struct _StringCore {
     )
   }
 
+  /// Create the implementation of a string consisting of the single ASCII
+  /// code unit `u`.  The string refers to static storage, like a string
+  /// literal, so creating it does not allocate.
+  init(_singleASCII u: UTF8.CodeUnit) {
+    _sanityCheck(u <= 0x7f, "Code unit is not ASCII")
+    self = _StringCore(
+      baseAddress: OpaquePointer(_singleASCIIStringStorage + 2 * Int(u)),
+      count: 1,
+      elementShift: 0,
+      hasCocoaBuffer: false,
+      owner: nil)
+  }
+
+  /// Returns the implementation of a string containing `input` if it can be
+  /// created without allocating, i.e. if `input` is empty or a single ASCII
+  /// code unit.
+  static func _fromShortASCII(
+    _ input: UnsafeBufferPointer<UTF8.CodeUnit>
+  ) -> _StringCore? {
+    if input.count == 0 {
+      return _StringCore()
+    }
+    if input.count == 1 && input[0] <= 0x7f {
+      return _StringCore(_singleASCII: input[0])
+    }
+    return nil
+  }
+
   /// Create the implementation of an empty string.
   ///
   /// - Note: There is no null terminator in an empty string.
@@ -727,3 +755,15 @@ var _emptyStringBase: OpaquePointer {
   return OpaquePointer(
     UnsafeMutablePointer<UInt16>(Builtin.addressof(&_emptyStringStorage)))
 }
+
+/// The storage of all strings consisting of a single ASCII character, see
+/// `_StringCore(_singleASCII:)`.  Each character is followed by a null
+/// terminator.  The storage is never freed.
+let _singleASCIIStringStorage: UnsafeMutablePointer<UTF8.CodeUnit> = {
+  let storage = UnsafeMutablePointer<UTF8.CodeUnit>(allocatingCapacity: 256)
+  for u in 0..<128 {
+    storage[2 * u] = UTF8.CodeUnit(u)
+    storage[2 * u + 1] = 0
+  }
+  return storage
+}()
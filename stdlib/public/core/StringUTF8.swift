@@ -78,13 +78,19 @@ extension _StringCore {
     _sanityCheck(elementWidth == 2)
     _sanityCheck(_baseAddress == nil)
 
-    let storage = _CollectionOf<Int, UInt16>(
-      _startIndex: 0, endIndex: self.count
-    ) {
-      (i: Int) -> UInt16 in
-      return _cocoaStringSubscript(self, i)
+    // A chunk holds at most 8 UTF-8 code units, so the transcoder reads at
+    // most 9 UTF-16 code units: the 9th only to complete a surrogate pair.
+    // Copy them out of the NSString at once instead of asking for each.
+    let utf16Count = Swift.min(sizeof(_UTF8Chunk.self) + 1, count - i)
+    var buffer = _Buffer32()
+    return withUnsafeMutablePointer(&buffer) {
+      (bufferPtr) -> (Int, _UTF8Chunk) in
+      let units = UnsafeMutablePointer<UTF16.CodeUnit>(bufferPtr)
+      _cocoaStringRead(cocoaBuffer.unsafelyUnwrapped, i..<i + utf16Count, units)
+      let (next, chunk) = _transcodeSomeUTF16AsUTF8(
+        UnsafeBufferPointer(start: units, count: utf16Count), 0)
+      return (i + next, chunk)
     }
-    return _transcodeSomeUTF16AsUTF8(storage, i)
   }
 #endif
 }
@@ -18,13 +18,14 @@
 #include "swift/Basic/Demangle.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Enum.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
-#include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/PointerIntPair.h"
+#include "swift/Runtime/RuntimeCounters.h"
+#include "llvm/ADT/StringRef.h"
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
 #include "ExistentialMetadataImpl.h"
@@ -32,6 +33,7 @@
 #include "../SwiftShims/RuntimeShims.h"
 #include "stddef.h"
 
+#include <algorithm>
 #include <cstring>
 #include <type_traits>
 
@@ -72,6 +74,101 @@ namespace {
     /// Function types must be parenthesized.
     TypeSimple,
   };
+
+  struct NameCacheKey {
+    const void *Object;
+    bool Qualified;
+  };
+
+  /// A name in a NameCache. The characters are allocated together with the
+  /// entry and live as long as the process.
+  class NameCacheEntry {
+    const void *Object;
+    bool Qualified;
+    size_t Length;
+
+    char *getNameBuffer() {
+      return reinterpret_cast<char *>(this + 1);
+    }
+    const char *getNameBuffer() const {
+      return reinterpret_cast<const char *>(this + 1);
+    }
+
+  public:
+    NameCacheEntry(NameCacheKey key, llvm::StringRef name)
+      : Object(key.Object), Qualified(key.Qualified), Length(name.size()) {
+      memcpy(getNameBuffer(), name.data(), Length);
+      getNameBuffer()[Length] = '\0';
+    }
+
+    int compareWithKey(NameCacheKey key) const {
+      if (key.Object != Object)
+        return (uintptr_t(key.Object) < uintptr_t(Object) ? -1 : 1);
+      if (key.Qualified != Qualified)
+        return (key.Qualified < Qualified ? -1 : 1);
+      return 0;
+    }
+
+    static size_t getExtraAllocationSize(NameCacheKey key,
+                                         llvm::StringRef name) {
+      return name.size() + 1;
+    }
+
+    /// Returns the null-terminated name.
+    const char *getName() const { return getNameBuffer(); }
+
+    size_t getLength() const { return Length; }
+  };
+
+  /// An insert-only cache of names. It is split into shards so that threads
+  /// looking up different names don't all hit the same tree and search
+  /// cache.
+  class NameCache {
+    enum : unsigned { NumShards = 16 };
+    ConcurrentMap<NameCacheEntry> Shards[NumShards];
+
+    ConcurrentMap<NameCacheEntry> &getShard(NameCacheKey key) {
+      auto bits = uintptr_t(key.Object);
+      return Shards[((bits >> 4) ^ (bits >> 12)) % NumShards];
+    }
+
+  public:
+    /// Return the name for \p key, calling \p buildName to append it to a
+    /// string if it isn't cached yet. No lock is held while the name is
+    /// built. If two threads race to build the same name, one of them wins
+    /// and the other name is dropped.
+    template <class BuildFn>
+    const NameCacheEntry &get(NameCacheKey key, BuildFn &&buildName) {
+      auto &shard = getShard(key);
+      if (auto entry = shard.find(key))
+        return *entry;
+
+      std::string name;
+      buildName(name);
+      return *shard.getOrInsert(key, llvm::StringRef(name)).first;
+    }
+  };
+}
+
+/// The results of swift_getTypeName.
+static Lazy<NameCache> TypeNameCache;
+
+/// Demangled nominal type and protocol names. Generic types are usually
+/// named with many different arguments, so each instance only has to
+/// demangle its arguments that were not named before.
+static Lazy<NameCache> DemangledNameCache;
+
+/// Append the demangled form of the mangled type name \p name to \p result.
+static void _appendDemangledTypeName(const char *name, bool qualified,
+                                     std::string &result) {
+  auto &entry = DemangledNameCache->get({name, qualified},
+                                        [&](std::string &demangled) {
+    auto options = Demangle::DemangleOptions();
+    options.DisplayDebuggerGeneratedModule = false;
+    options.QualifyEntities = qualified;
+    demangled = Demangle::demangleTypeAsString(name, strlen(name), options);
+  });
+  result.append(entry.getName(), entry.getLength());
 }
 
 static void _buildNameForMetadata(const Metadata *type,
@@ -83,14 +180,8 @@ static void _buildNominalTypeName(const NominalTypeDescriptor *ntd,
                                   const Metadata *type,
                                   bool qualified,
                                   std::string &result) {
-  auto options = Demangle::DemangleOptions();
-  options.DisplayDebuggerGeneratedModule = false;
-  options.QualifyEntities = qualified;
-
   // Demangle the basic type name.
-  result += Demangle::demangleTypeAsString(ntd->Name,
-                                           strlen(ntd->Name),
-                                           options);
+  _appendDemangledTypeName(ntd->Name, qualified, result);
   
   // If generic, demangle the type parameters.
   if (ntd->GenericParams.NumPrimaryParams > 0) {
@@ -129,19 +220,13 @@ static const char *_getProtocolName(const ProtocolDescriptor *protocol) {
 static void _buildExistentialTypeName(const ProtocolDescriptorList *protocols,
                                       bool qualified,
                                       std::string &result) {
-  auto options = Demangle::DemangleOptions();
-  options.QualifyEntities = qualified;
-  options.DisplayDebuggerGeneratedModule = false;
-
   // If there's only one protocol, the existential type name is the protocol
   // name.
   auto descriptors = protocols->getProtocols();
   
   if (protocols->NumProtocols == 1) {
-    auto name = _getProtocolName(descriptors[0]);
-    result += Demangle::demangleTypeAsString(name,
-                                             strlen(name),
-                                             options);
+    _appendDemangledTypeName(_getProtocolName(descriptors[0]), qualified,
+                             result);
     return;
   }
   
@@ -149,10 +234,8 @@ static void _buildExistentialTypeName(const ProtocolDescriptorList *protocols,
   for (unsigned i = 0, e = protocols->NumProtocols; i < e; ++i) {
     if (i > 0)
       result += ", ";
-    auto name = _getProtocolName(descriptors[i]);
-    result += Demangle::demangleTypeAsString(name,
-                                             strlen(name),
-                                             options);
+    _appendDemangledTypeName(_getProtocolName(descriptors[i]), qualified,
+                             result);
   }
   result += ">";
 }
@@ -191,9 +274,6 @@ static void _buildNameForMetadata(const Metadata *type,
                                   TypeSyntaxLevel level,
                                   bool qualified,
                                   std::string &result) {
-  auto options = Demangle::DemangleOptions();
-  options.DisplayDebuggerGeneratedModule = false;
-                             
   switch (type->getKind()) {
   case MetadataKind::Class: {
     auto classType = static_cast<const ClassMetadata *>(type);
@@ -230,9 +310,7 @@ static void _buildNameForMetadata(const Metadata *type,
   }
   case MetadataKind::ForeignClass: {
     auto foreign = static_cast<const ForeignClassMetadata *>(type);
-    const char *name = foreign->getName();
-    size_t len = strlen(name);
-    result += Demangle::demangleTypeAsString(name, len, options);
+    _appendDemangledTypeName(foreign->getName(), /*qualified*/ true, result);
     return;
   }
   case MetadataKind::Existential: {
@@ -323,49 +401,12 @@ extern "C"
 TwoWordPair<const char *, uintptr_t>::Return
 swift_getTypeName(const Metadata *type, bool qualified) {
   using Pair = TwoWordPair<const char *, uintptr_t>;
-  using Key = llvm::PointerIntPair<const Metadata *, 1, bool>;
-
-  static StaticReadWriteLock TypeNameCacheLock;
-  static Lazy<llvm::DenseMap<Key, std::pair<const char *, size_t>>>
-    TypeNameCache;
-  
-  Key key(type, qualified);
-  auto &cache = TypeNameCache.get();
-
-  // Attempt read-only lookup of cache entry.
-  {
-    StaticScopedReadLock guard(TypeNameCacheLock);
-
-    auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
-    }
-  }
 
-  // Read-only lookup failed to find item, we may need to create it.
-  {
-    StaticScopedWriteLock guard(TypeNameCacheLock);
-
-    // Do lookup again just to make sure it wasn't created by another
-    // thread before we acquired the write lock.
-    auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
-    }
-
-    // Build the metadata name.
-    auto name = nameForMetadata(type, qualified);
-    // Copy it to memory we can reference forever.
-    auto size = name.size();
-    auto result = (char *)malloc(size + 1);
-    memcpy(result, name.data(), size);
-    result[size] = 0;
-
-    cache.insert({key, {result, size}});
-    return Pair{result, size};
-  }
+  auto &entry = TypeNameCache->get({type, qualified},
+                                   [&](std::string &name) {
+    _buildNameForMetadata(type, TypeSyntaxLevel::Type, qualified, name);
+  });
+  return Pair{entry.getName(), entry.getLength()};
 }
 
 /// Report a dynamic cast failure.
@@ -646,6 +687,97 @@ static bool _conformsToProtocols(const OpaqueValue *value,
   return true;
 }
 
+namespace {
+  struct ExistentialCastCacheKey {
+    const Metadata *SrcType;
+    const ExistentialTypeMetadata *TargetType;
+  };
+
+  /// A successful conformance check of a type against the protocols of an
+  /// existential type, together with the witness tables it produced.
+  struct ExistentialCastCacheEntry {
+    /// Existentials with more witness tables are not cached.
+    enum : unsigned { MaxWitnessTables = 4 };
+
+  private:
+    const Metadata *SrcType;
+    const ExistentialTypeMetadata *TargetType;
+    const WitnessTable *WitnessTables[MaxWitnessTables];
+
+  public:
+    ExistentialCastCacheEntry(ExistentialCastCacheKey key,
+                              const WitnessTable * const *witnessTables,
+                              unsigned numWitnessTables)
+      : SrcType(key.SrcType), TargetType(key.TargetType) {
+      assert(numWitnessTables <= MaxWitnessTables);
+      std::copy(witnessTables, witnessTables + numWitnessTables,
+                WitnessTables);
+    }
+
+    int compareWithKey(const ExistentialCastCacheKey &key) const {
+      if (key.SrcType != SrcType) {
+        return (uintptr_t(key.SrcType) < uintptr_t(SrcType) ? -1 : 1);
+      } else if (key.TargetType != TargetType) {
+        return (uintptr_t(key.TargetType) < uintptr_t(TargetType) ? -1 : 1);
+      } else {
+        return 0;
+      }
+    }
+
+    template <class... Args>
+    static size_t getExtraAllocationSize(Args &&... ignored) {
+      return 0;
+    }
+
+    const WitnessTable * const *getWitnessTables() const {
+      return WitnessTables;
+    }
+  };
+}
+
+/// Successful existential conformance checks. Failures are not cached
+/// because loading an image can add conformances.
+static Lazy<ConcurrentMap<ExistentialCastCacheEntry>> ExistentialCastCache;
+
+/// Check whether a type conforms to the protocols of an existential type,
+/// filling in the witness tables of the existential container.
+///
+/// If the answer does not depend on the value, i.e. there are no
+/// Objective-C protocols involved, a successful check is cached, so that
+/// repeated casts of the same type only have to copy the witness tables.
+static bool _conformsToExistentialProtocols(
+                                    const OpaqueValue *value,
+                                    const Metadata *type,
+                                    const ExistentialTypeMetadata *targetType,
+                                    const WitnessTable **conformances) {
+  const auto &protocols = targetType->Protocols;
+  unsigned numWitnessTables = targetType->Flags.getNumWitnessTables();
+
+  bool isCacheable =
+    numWitnessTables <= ExistentialCastCacheEntry::MaxWitnessTables;
+  for (unsigned i = 0, n = protocols.NumProtocols; isCacheable && i != n;
+       ++i) {
+    auto protocolFlags = protocols[i]->Flags;
+    isCacheable = protocolFlags.needsWitnessTable() ||
+      protocolFlags.getSpecialProtocol() == SpecialProtocol::AnyObject;
+  }
+  if (!isCacheable)
+    return _conformsToProtocols(value, type, protocols, conformances);
+
+  ExistentialCastCacheKey key = { type, targetType };
+  auto &cache = ExistentialCastCache.get();
+  if (auto entry = cache.find(key)) {
+    std::copy(entry->getWitnessTables(),
+              entry->getWitnessTables() + numWitnessTables, conformances);
+    return true;
+  }
+
+  if (!_conformsToProtocols(value, type, protocols, conformances))
+    return false;
+  cache.getOrInsert(key, conformances, numWitnessTables);
+  return true;
+}
+
 static bool shouldDeallocateSource(bool castSucceeded, DynamicCastFlags flags) {
   return (castSucceeded && (flags & DynamicCastFlags::TakeOnSuccess)) ||
         (!castSucceeded && (flags & DynamicCastFlags::DestroyOnFailure));
@@ -966,9 +1098,9 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     }
 
     // Check for protocol conformances and fill in the witness tables.
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables())) {
+    if (!_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType,
+                                         destExistential->getWitnessTables())) {
       return _fail(src, srcType, targetType, flags, srcDynamicType);
     }
 
@@ -985,9 +1117,9 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
       reinterpret_cast<OpaqueExistentialContainer*>(dest);
 
     // Check for protocol conformances and fill in the witness tables.
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables()))
+    if (!_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType,
+                                         destExistential->getWitnessTables()))
       return _fail(src, srcType, targetType, flags, srcDynamicType);
 
     // Fill in the type and value.
@@ -2049,6 +2181,7 @@ bool swift::swift_dynamicCast(OpaqueValue *dest,
                               const Metadata *targetType,
                               DynamicCastFlags flags)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_RUNTIME_COUNT(DynamicCast);
   auto unwrapResult = checkDynamicCastFromOptional(dest, src, srcType,
                                                    targetType, flags);
   srcType = unwrapResult.payloadType;
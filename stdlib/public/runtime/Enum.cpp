@@ -49,27 +49,27 @@ static unsigned getNumTagBytes(size_t size, unsigned emptyCases,
           numTags < 65536 ? 2 : 4);
 }
 
-/// This is a small and fast implementation of memcpy with a constant count. It
-/// should be a performance win for small constant values where the function
-/// can be inlined, the loop unrolled and the memory accesses merged.
-template <unsigned count> static void small_memcpy(void *dest, const void *src) {
-  uint8_t *d8 = (uint8_t*)dest, *s8 = (uint8_t*)src;
-  for (unsigned i = 0; i < count; i++) {
-    *d8++ = *s8++;
+/// Load a tag value of \p count bytes. The tag is stored as an integer of
+/// that width in native byte order, so a single load of the right type reads
+/// it on both little and big endian targets.
+static inline unsigned loadTagValue(const void *src, unsigned count) {
+  switch (count) {
+  case 1: {
+    uint8_t tag;
+    memcpy(&tag, src, sizeof(tag));
+    return tag;
   }
-}
-
-static inline void small_memcpy(void *dest, const void *src, unsigned count) {
-  // This is specialization of the memcpy line below with
-  // specialization for values of 1, 2 and 4.
-  // memcpy(dst, src, count)
-  if (count == 1) {
-    small_memcpy<1>(dest, src);
-  } else if (count == 2) {
-    small_memcpy<2>(dest, src);
-  } else if (count == 4) {
-    small_memcpy<4>(dest, src);
-  } else {
+  case 2: {
+    uint16_t tag;
+    memcpy(&tag, src, sizeof(tag));
+    return tag;
+  }
+  case 4: {
+    uint32_t tag;
+    memcpy(&tag, src, sizeof(tag));
+    return tag;
+  }
+  default:
     crash("Tagbyte values should be 1, 2 or 4.");
   }
 }
@@ -153,17 +153,10 @@ swift::swift_getEnumCaseSinglePayload(const OpaqueValue *value,
   if (emptyCases > payloadNumExtraInhabitants) {
     auto *valueAddr = reinterpret_cast<const uint8_t*>(value);
     auto *extraTagBitAddr = valueAddr + payloadSize;
-    unsigned extraTagBits = 0;
     unsigned numBytes = getNumTagBytes(payloadSize,
                                        emptyCases-payloadNumExtraInhabitants,
                                        1 /*payload case*/);
-
-#if defined(__BIG_ENDIAN__)
-    small_memcpy(reinterpret_cast<uint8_t*>(&extraTagBits) + 4 - numBytes,
-                 extraTagBitAddr, numBytes);
-#else
-    small_memcpy(&extraTagBits, extraTagBitAddr, numBytes);
-#endif
+    unsigned extraTagBits = loadTagValue(extraTagBitAddr, numBytes);
 
     // If the extra tag bits are zero, we have a valid payload or
     // extra inhabitant (checked below). If nonzero, form the case index from
@@ -274,47 +267,6 @@ swift::swift_storeEnumTagSinglePayload(OpaqueValue *value,
 #endif
 }
 
-void
-swift::swift_initEnumMetadataMultiPayload(ValueWitnessTable *vwtable,
-                                     EnumMetadata *enumType,
-                                     unsigned numPayloads,
-                                     const TypeLayout * const *payloadLayouts) {
-  // Accumulate the layout requirements of the payloads.
-  size_t payloadSize = 0, alignMask = 0;
-  bool isPOD = true, isBT = true;
-  for (unsigned i = 0; i < numPayloads; ++i) {
-    const TypeLayout *payloadLayout = payloadLayouts[i];
-    payloadSize
-      = std::max(payloadSize, (size_t)payloadLayout->size);
-    alignMask |= payloadLayout->flags.getAlignmentMask();
-    isPOD &= payloadLayout->flags.isPOD();
-    isBT &= payloadLayout->flags.isBitwiseTakable();
-  }
-  
-  // Store the max payload size in the metadata.
-  assignUnlessEqual(enumType->getPayloadSize(), payloadSize);
-  
-  // The total size includes space for the tag.
-  unsigned totalSize = payloadSize + getNumTagBytes(payloadSize,
-                                enumType->Description->Enum.getNumEmptyCases(),
-                                numPayloads);
-  
-  // Set up the layout info in the vwtable.
-  vwtable->size = totalSize;
-  vwtable->flags = ValueWitnessFlags()
-    .withAlignmentMask(alignMask)
-    .withPOD(isPOD)
-    .withBitwiseTakable(isBT)
-    // TODO: Extra inhabitants
-    .withExtraInhabitants(false)
-    .withEnumWitnesses(true)
-    .withInlineStorage(ValueWitnessTable::isValueInline(totalSize, alignMask+1))
-    ;
-  vwtable->stride = (totalSize + alignMask) & ~alignMask;
-  
-  installCommonValueWitnesses(vwtable);
-}
-
 namespace {
 struct MultiPayloadLayout {
   size_t payloadSize;
@@ -328,19 +280,6 @@ static MultiPayloadLayout getMultiPayloadLayout(const EnumMetadata *enumType) {
   return {payloadSize, totalSize - payloadSize};
 }
 
-static void storeMultiPayloadTag(OpaqueValue *value,
-                                 MultiPayloadLayout layout,
-                                 unsigned tag) {
-  auto tagBytes = reinterpret_cast<char *>(value) + layout.payloadSize;
-#if defined(__BIG_ENDIAN__)
-  small_memcpy(tagBytes,
-               reinterpret_cast<char *>(&tag) + 4 - layout.numTagBytes,
-               layout.numTagBytes);
-#else
-  small_memcpy(tagBytes, &tag, layout.numTagBytes);
-#endif
-}
-
 static void storeMultiPayloadValue(OpaqueValue *value,
                                    MultiPayloadLayout layout,
                                    unsigned payloadValue) {
@@ -361,21 +300,6 @@ static void storeMultiPayloadValue(OpaqueValue *value,
            layout.payloadSize - sizeof(payloadValue));
 }
 
-static unsigned loadMultiPayloadTag(const OpaqueValue *value,
-                                    MultiPayloadLayout layout) {
-  auto tagBytes = reinterpret_cast<const char *>(value) + layout.payloadSize;
-
-  unsigned tag = 0;
-#if defined(__BIG_ENDIAN__)
-  small_memcpy(reinterpret_cast<char *>(&tag) + 4 - layout.numTagBytes,
-               tagBytes, layout.numTagBytes);
-#else
-  small_memcpy(&tag, tagBytes, layout.numTagBytes);
-#endif
-
-  return tag;
-}
-
 static unsigned loadMultiPayloadValue(const OpaqueValue *value,
                                       MultiPayloadLayout layout) {
   auto bytes = reinterpret_cast<const char *>(value);
@@ -392,53 +316,196 @@ static unsigned loadMultiPayloadValue(const OpaqueValue *value,
   return payloadValue;
 }
 
-void
-swift::swift_storeEnumTagMultiPayload(OpaqueValue *value,
-                                      const EnumMetadata *enumType,
-                                      unsigned whichCase) {
-  auto layout = getMultiPayloadLayout(enumType);
-  unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
-  if (whichCase < numPayloads) {
+namespace {
+/// The case accessors of multi-payload enums whose tag bytes, following the
+/// payload area, are an integer of type \p TagTy, and whose payload area is
+/// at least four bytes (\p LargePayload), so that it holds the index of any
+/// empty case by itself.
+template <typename TagTy, bool LargePayload>
+struct MultiPayloadEnumOps {
+  static unsigned getCase(const OpaqueValue *value,
+                          const EnumMetadata *enumType) {
+    size_t payloadSize = enumType->getPayloadSize();
+    unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
+    auto bytes = reinterpret_cast<const char *>(value);
+
+    TagTy tag;
+    memcpy(&tag, bytes + payloadSize, sizeof(tag));
+    // If the tag indicates a payload, then we're done.
+    if (tag < numPayloads)
+      return tag;
+
+    // Otherwise, the other part of the discriminator is in the payload.
+    if (LargePayload) {
+      uint32_t payloadValue;
+      memcpy(&payloadValue, bytes, sizeof(payloadValue));
+      return numPayloads + payloadValue;
+    }
+    unsigned payloadValue =
+      loadMultiPayloadValue(value, {payloadSize, sizeof(TagTy)});
+    unsigned numPayloadBits = payloadSize * CHAR_BIT;
+    return (payloadValue | (unsigned(tag) - numPayloads) << numPayloadBits)
+           + numPayloads;
+  }
+
+  static void storeCase(OpaqueValue *value, const EnumMetadata *enumType,
+                        unsigned whichCase) {
+    size_t payloadSize = enumType->getPayloadSize();
+    unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
+    auto bytes = reinterpret_cast<char *>(value);
+
     // For a payload case, store the tag after the payload area.
-    storeMultiPayloadTag(value, layout, whichCase);
-  } else {
+    if (whichCase < numPayloads) {
+      TagTy tag = whichCase;
+      memcpy(bytes + payloadSize, &tag, sizeof(tag));
+      return;
+    }
+
     // For an empty case, factor out the parts that go in the payload and
     // tag areas.
     unsigned whichEmptyCase = whichCase - numPayloads;
     unsigned whichTag, whichPayloadValue;
-    if (layout.payloadSize >= 4) {
+    if (LargePayload) {
       whichTag = numPayloads;
       whichPayloadValue = whichEmptyCase;
     } else {
-      unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
+      unsigned numPayloadBits = payloadSize * CHAR_BIT;
       whichTag = numPayloads + (whichEmptyCase >> numPayloadBits);
-      whichPayloadValue = whichEmptyCase & ((1U << numPayloads) - 1U);
+      whichPayloadValue = whichEmptyCase & ((1U << numPayloadBits) - 1U);
     }
-    storeMultiPayloadTag(value, layout, whichTag);
-    storeMultiPayloadValue(value, layout, whichPayloadValue);
+    TagTy tag = whichTag;
+    memcpy(bytes + payloadSize, &tag, sizeof(tag));
+    storeMultiPayloadValue(value, {payloadSize, sizeof(TagTy)},
+                           whichPayloadValue);
+  }
+
+  // The enum value witnesses, which take and return resilient tag indices in
+  // the range [-ElementsWithPayload..ElementsWithNoPayload-1].
+
+  static int getEnumTag(const OpaqueValue *value, const Metadata *self) {
+    auto enumType = static_cast<const EnumMetadata *>(self);
+    unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
+    return int(getCase(value, enumType)) - int(numPayloads);
+  }
+
+  static void destructiveProjectEnumData(OpaqueValue *value,
+                                         const Metadata *self) {
+    // The tag of an enum laid out at runtime is never stored in the spare
+    // bits of the payload, so there is nothing to strip.
+  }
+
+  static void destructiveInjectEnumTag(OpaqueValue *value, int tag,
+                                       const Metadata *self) {
+    auto enumType = static_cast<const EnumMetadata *>(self);
+    unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
+    storeCase(value, enumType, unsigned(tag + int(numPayloads)));
+  }
+};
+
+/// The entry points specialized by MultiPayloadEnumOps for one layout.
+struct MultiPayloadEnumImpl {
+  unsigned (*getCase)(const OpaqueValue *value, const EnumMetadata *enumType);
+  void (*storeCase)(OpaqueValue *value, const EnumMetadata *enumType,
+                    unsigned whichCase);
+  value_witness_types::getEnumTag *getEnumTag;
+  value_witness_types::destructiveProjectEnumData *destructiveProjectEnumData;
+  value_witness_types::destructiveInjectEnumTag *destructiveInjectEnumTag;
+};
+}
+
+#define MULTI_PAYLOAD_ENUM_IMPL(TagTy, LargePayload) \
+  { &MultiPayloadEnumOps<TagTy, LargePayload>::getCase, \
+    &MultiPayloadEnumOps<TagTy, LargePayload>::storeCase, \
+    &MultiPayloadEnumOps<TagTy, LargePayload>::getEnumTag, \
+    &MultiPayloadEnumOps<TagTy, LargePayload>::destructiveProjectEnumData, \
+    &MultiPayloadEnumOps<TagTy, LargePayload>::destructiveInjectEnumTag }
+
+/// Indexed by the log2 of the number of tag bytes, and by whether the
+/// payload area is at least four bytes.
+static const MultiPayloadEnumImpl MultiPayloadEnumImpls[3][2] = {
+  { MULTI_PAYLOAD_ENUM_IMPL(uint8_t, false),
+    MULTI_PAYLOAD_ENUM_IMPL(uint8_t, true) },
+  { MULTI_PAYLOAD_ENUM_IMPL(uint16_t, false),
+    MULTI_PAYLOAD_ENUM_IMPL(uint16_t, true) },
+  { MULTI_PAYLOAD_ENUM_IMPL(uint32_t, false),
+    MULTI_PAYLOAD_ENUM_IMPL(uint32_t, true) },
+};
+
+#undef MULTI_PAYLOAD_ENUM_IMPL
+
+static const MultiPayloadEnumImpl &
+getMultiPayloadEnumImpl(MultiPayloadLayout layout) {
+  bool largePayload = layout.payloadSize >= 4;
+  switch (layout.numTagBytes) {
+  case 1: return MultiPayloadEnumImpls[0][largePayload];
+  case 2: return MultiPayloadEnumImpls[1][largePayload];
+  case 4: return MultiPayloadEnumImpls[2][largePayload];
+  default:
+    crash("Tagbyte values should be 1, 2 or 4.");
   }
 }
 
+void
+swift::swift_initEnumMetadataMultiPayload(ValueWitnessTable *vwtable,
+                                     EnumMetadata *enumType,
+                                     unsigned numPayloads,
+                                     const TypeLayout * const *payloadLayouts) {
+  // Accumulate the layout requirements of the payloads.
+  size_t payloadSize = 0, alignMask = 0;
+  bool isPOD = true, isBT = true;
+  for (unsigned i = 0; i < numPayloads; ++i) {
+    const TypeLayout *payloadLayout = payloadLayouts[i];
+    payloadSize
+      = std::max(payloadSize, (size_t)payloadLayout->size);
+    alignMask |= payloadLayout->flags.getAlignmentMask();
+    isPOD &= payloadLayout->flags.isPOD();
+    isBT &= payloadLayout->flags.isBitwiseTakable();
+  }
+  
+  // Store the max payload size in the metadata.
+  assignUnlessEqual(enumType->getPayloadSize(), payloadSize);
+  
+  // The total size includes space for the tag.
+  unsigned totalSize = payloadSize + getNumTagBytes(payloadSize,
+                                enumType->Description->Enum.getNumEmptyCases(),
+                                numPayloads);
+  
+  // Set up the layout info in the vwtable.
+  vwtable->size = totalSize;
+  vwtable->flags = ValueWitnessFlags()
+    .withAlignmentMask(alignMask)
+    .withPOD(isPOD)
+    .withBitwiseTakable(isBT)
+    // TODO: Extra inhabitants
+    .withExtraInhabitants(false)
+    .withEnumWitnesses(true)
+    .withInlineStorage(ValueWitnessTable::isValueInline(totalSize, alignMask+1))
+    ;
+  vwtable->stride = (totalSize + alignMask) & ~alignMask;
+
+  // Replace the enum witnesses by the ones specialized for the layout, so
+  // that generic code switching over the enum doesn't have to dispatch on
+  // the number of tag bytes again.
+  auto &impl = getMultiPayloadEnumImpl({payloadSize, totalSize - payloadSize});
+  auto enumVWT = static_cast<EnumValueWitnessTable *>(vwtable);
+  enumVWT->getEnumTag = impl.getEnumTag;
+  enumVWT->destructiveProjectEnumData = impl.destructiveProjectEnumData;
+  enumVWT->destructiveInjectEnumTag = impl.destructiveInjectEnumTag;
+
+  installCommonValueWitnesses(vwtable);
+}
+
+void
+swift::swift_storeEnumTagMultiPayload(OpaqueValue *value,
+                                      const EnumMetadata *enumType,
+                                      unsigned whichCase) {
+  auto &impl = getMultiPayloadEnumImpl(getMultiPayloadLayout(enumType));
+  impl.storeCase(value, enumType, whichCase);
+}
+
 unsigned
 swift::swift_getEnumCaseMultiPayload(const OpaqueValue *value,
                                      const EnumMetadata *enumType) {
-  auto layout = getMultiPayloadLayout(enumType);
-  unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
-
-  unsigned tag = loadMultiPayloadTag(value, layout);
-  if (tag < numPayloads) {
-    // If the tag indicates a payload, then we're done.
-    return tag;
-  } else {
-    // Otherwise, the other part of the discriminator is in the payload.
-    unsigned payloadValue = loadMultiPayloadValue(value, layout);
-    
-    if (layout.payloadSize >= 4) {
-      return numPayloads + payloadValue;
-    } else {
-      unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
-      return (payloadValue | (tag - numPayloads) << numPayloadBits)
-             + numPayloads;
-    }
-  }
+  auto &impl = getMultiPayloadEnumImpl(getMultiPayloadLayout(enumType));
+  return impl.getCase(value, enumType);
 }
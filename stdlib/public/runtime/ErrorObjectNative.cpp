@@ -17,7 +17,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <new>
 #include <stdio.h>
+#include <string.h>
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
 #include "Private.h"
@@ -62,6 +66,74 @@ static const FullMetadata<HeapMetadata> ErrorProtocolMetadata{
   Metadata{MetadataKind::ErrorObject},
 };
 
+namespace {
+  struct SharedErrorBoxKey {
+    const Metadata *type;
+    const WitnessTable *errorConformance;
+    uint8_t value;
+  };
+
+  /// An immortal ErrorProtocol box, which holds a value of a trivial type
+  /// that is at most a byte in size, such as a case of an enum without
+  /// payloads. There are at most 256 of them per type.
+  class SharedErrorBoxCacheEntry {
+    SharedErrorBoxKey Key;
+    SwiftError *Box;
+
+  public:
+    SharedErrorBoxCacheEntry(const SharedErrorBoxKey &key) : Key(key) {
+      auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(key.type);
+      void *memory = swift_slowAlloc(sizeAndAlign.first, sizeAndAlign.second);
+      Box = reinterpret_cast<SwiftError *>(memory);
+      new (Box) HeapObject(&ErrorProtocolMetadata, StrongRefCount::Immortal);
+      Box->type = key.type;
+      Box->errorConformance = key.errorConformance;
+      memcpy(Box->getValue(), &key.value,
+             key.type->getValueWitnesses()->getSize());
+    }
+
+    int compareWithKey(const SharedErrorBoxKey &key) const {
+      if (key.type != Key.type)
+        return (uintptr_t(key.type) < uintptr_t(Key.type) ? -1 : 1);
+      if (key.errorConformance != Key.errorConformance)
+        return (uintptr_t(key.errorConformance) <
+                uintptr_t(Key.errorConformance) ? -1 : 1);
+      if (key.value != Key.value)
+        return (key.value < Key.value ? -1 : 1);
+      return 0;
+    }
+
+    template <class... Args>
+    static size_t getExtraAllocationSize(Args &&... ignored) {
+      return 0;
+    }
+
+    SwiftError *getBox() const { return Box; }
+  };
+}
+
+static Lazy<ConcurrentMap<SharedErrorBoxCacheEntry>> SharedErrorBoxes;
+
+/// Returns a shared, immortal box for the error value \p initialValue of
+/// \p type, or null if values of the type need a box of their own.
+///
+/// The compiler fills in the box after allocating it unless it passes the
+/// value, so a box without a value can only be shared by empty types.
+static SwiftError *getSharedErrorBox(const Metadata *type,
+                                     const WitnessTable *errorConformance,
+                                     OpaqueValue *initialValue) {
+  auto vw = type->getValueWitnesses();
+  if (!vw->isPOD() || vw->getSize() > 1)
+    return nullptr;
+  SharedErrorBoxKey key = { type, errorConformance, 0 };
+  if (vw->getSize() != 0) {
+    if (!initialValue)
+      return nullptr;
+    key.value = *reinterpret_cast<const uint8_t *>(initialValue);
+  }
+  return SharedErrorBoxes.get().getOrInsert(key).first->getBox();
+}
+
 SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
 extern "C"
 BoxPair::Return
@@ -69,6 +141,11 @@ swift::swift_allocError(const swift::Metadata *type,
                         const swift::WitnessTable *errorConformance,
                         OpaqueValue *initialValue,
                         bool isTake) {
+  // Throwing a value of a small trivial type doesn't allocate. Destroying
+  // or taking such a value is a no-op.
+  if (auto shared = getSharedErrorBox(type, errorConformance, initialValue))
+    return BoxPair{shared, shared->getValue()};
+
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
   
   auto allocated = swift_allocObject(&ErrorProtocolMetadata,
@@ -93,6 +170,9 @@ swift::swift_allocError(const swift::Metadata *type,
 
 void
 swift::swift_deallocError(SwiftError *error, const Metadata *type) {
+  // Shared boxes are never deallocated.
+  if (error->refCount.isImmortal())
+    return;
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
   swift_deallocObject(error, sizeAndAlign.first, sizeAndAlign.second);
 }
@@ -18,13 +18,145 @@
 #include "swift/Runtime/Heap.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
+#include <atomic>
+#include <cstddef>
 #include <stdlib.h>
 
 using namespace swift;
 
+#if SWIFT_RUNTIME_ENABLE_HEAP_CACHE
+
+// The heap cache keeps blocks of small, freed allocations on per-thread free
+// lists, one for each size class, so that most allocations and deallocations
+// of short-lived objects don't have to go through malloc's locking.
+//
+// The cached blocks are ordinary malloc blocks, so malloc_size and free keep
+// working on them. Small allocations are rounded up to the size of their
+// class when they are first malloc'ed. swift_slowDealloc trusts the size it
+// is passed. That size may be smaller than the allocated size, as it is for
+// objects with tail-allocated elements, but never larger. So a block always
+// ends up on a list of a class no bigger than the block itself.
+
+namespace {
+
+/// Size classes are multiples of this.
+constexpr size_t HeapCacheGranule = 16;
+
+/// The number of size classes; larger allocations go straight to malloc.
+constexpr size_t HeapCacheNumClasses = 16;
+
+/// The largest allocation which is served by the cache.
+constexpr size_t HeapCacheMaxSize = HeapCacheGranule * HeapCacheNumClasses;
+
+/// Don't keep more than this many free blocks per class and thread.
+constexpr unsigned HeapCacheMaxBlocksPerClass = 64;
+
+/// The alignment guaranteed by malloc. Allocations with a stricter alignment
+/// are never cached.
+constexpr size_t MallocAlignMask = alignof(std::max_align_t) - 1;
+
+struct FreeBlock {
+  FreeBlock *Next;
+};
+
+/// The heap cache of a thread. This is trivially destructible, so it can
+/// still be used while other thread-local destructors run after the reaper
+/// below has drained it.
+struct ThreadHeapCache {
+  FreeBlock *Lists[HeapCacheNumClasses];
+  unsigned Counts[HeapCacheNumClasses];
+  HeapCacheStatistics Stats;
+
+  /// Set once the thread's reaper has been created.
+  bool HasReaper;
+
+  /// Set once the thread is exiting and the cache has been drained. All
+  /// later allocations and deallocations go straight to malloc and free.
+  bool Disabled;
+};
+
+thread_local ThreadHeapCache CurrentCache = {};
+
+/// Counters of all threads which have already exited.
+std::atomic<uint64_t> ExitedAllocations(0);
+std::atomic<uint64_t> ExitedAllocationHits(0);
+std::atomic<uint64_t> ExitedDeallocations(0);
+std::atomic<uint64_t> ExitedDeallocationHits(0);
+
+/// Returns the thread's free blocks to malloc when the thread exits.
+struct ThreadHeapCacheReaper {
+  ~ThreadHeapCacheReaper() {
+    auto &cache = CurrentCache;
+    for (size_t i = 0; i < HeapCacheNumClasses; ++i) {
+      while (FreeBlock *block = cache.Lists[i]) {
+        cache.Lists[i] = block->Next;
+        free(block);
+      }
+      cache.Counts[i] = 0;
+    }
+    cache.Disabled = true;
+
+    ExitedAllocations += cache.Stats.Allocations;
+    ExitedAllocationHits += cache.Stats.AllocationHits;
+    ExitedDeallocations += cache.Stats.Deallocations;
+    ExitedDeallocationHits += cache.Stats.DeallocationHits;
+    cache.Stats = HeapCacheStatistics();
+  }
+};
+
+thread_local ThreadHeapCacheReaper CurrentCacheReaper;
+
+/// Return the size class of an allocation of \p size bytes.
+inline size_t getSizeClass(size_t size) {
+  return size ? (size - 1) / HeapCacheGranule : 0;
+}
+
+/// Returns true if an allocation of this size and alignment can be cached.
+inline bool isCacheable(size_t size, size_t alignMask) {
+  return size <= HeapCacheMaxSize && alignMask <= MallocAlignMask;
+}
+
+} // end anonymous namespace
+
+HeapCacheStatistics swift::_swift_getHeapCacheStatistics() {
+  const auto &stats = CurrentCache.Stats;
+  HeapCacheStatistics result;
+  result.Allocations = stats.Allocations + ExitedAllocations;
+  result.AllocationHits = stats.AllocationHits + ExitedAllocationHits;
+  result.Deallocations = stats.Deallocations + ExitedDeallocations;
+  result.DeallocationHits = stats.DeallocationHits + ExitedDeallocationHits;
+  return result;
+}
+
+#else
+
+HeapCacheStatistics swift::_swift_getHeapCacheStatistics() {
+  return HeapCacheStatistics();
+}
+
+#endif
+
 SWIFT_RT_ENTRY_VISIBILITY
 void *swift::swift_slowAlloc(size_t size, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+#if SWIFT_RUNTIME_ENABLE_HEAP_CACHE
+  if (isCacheable(size, alignMask)) {
+    auto &cache = CurrentCache;
+    size_t sizeClass = getSizeClass(size);
+    ++cache.Stats.Allocations;
+    if (FreeBlock *block = cache.Lists[sizeClass]) {
+      cache.Lists[sizeClass] = block->Next;
+      --cache.Counts[sizeClass];
+      ++cache.Stats.AllocationHits;
+      return block;
+    }
+
+    // Round the allocation up to its size class, so that the block can be
+    // reused for any allocation of the class once it is freed.
+    size = (sizeClass + 1) * HeapCacheGranule;
+  }
+#endif
+
   // FIXME: use posix_memalign if alignMask is larger than the system guarantee.
   void *p = malloc(size);
   if (!p) swift::crash("Could not allocate memory.");
@@ -34,5 +166,28 @@ void *swift::swift_slowAlloc(size_t size, size_t alignMask)
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+#if SWIFT_RUNTIME_ENABLE_HEAP_CACHE
+  if (isCacheable(bytes, alignMask)) {
+    auto &cache = CurrentCache;
+    size_t sizeClass = getSizeClass(bytes);
+    ++cache.Stats.Deallocations;
+    if (!cache.Disabled &&
+        cache.Counts[sizeClass] < HeapCacheMaxBlocksPerClass) {
+      // Make sure the blocks are released when the thread exits.
+      if (!cache.HasReaper) {
+        (void)&CurrentCacheReaper;
+        cache.HasReaper = true;
+      }
+
+      auto block = reinterpret_cast<FreeBlock *>(ptr);
+      block->Next = cache.Lists[sizeClass];
+      cache.Lists[sizeClass] = block;
+      ++cache.Counts[sizeClass];
+      ++cache.Stats.DeallocationHits;
+      return;
+    }
+  }
+#endif
+
   free(ptr);
 }
@@ -18,6 +18,7 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
 #include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/RuntimeCounters.h"
 #include "swift/ABI/System.h"
 #include "llvm/Support/MathExtras.h"
 #include "MetadataCache.h"
@@ -25,6 +26,7 @@
 #include "swift/Runtime/Debug.h"
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
@@ -59,6 +61,7 @@ SWIFT_RT_ENTRY_IMPL(swift_allocObject)(HeapMetadata const *metadata,
                                        size_t requiredAlignmentMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
   assert(isAlignmentMask(requiredAlignmentMask));
+  SWIFT_RUNTIME_COUNT(AllocObject);
   auto object = reinterpret_cast<HeapObject *>(
       SWIFT_RT_ENTRY_CALL(swift_slowAlloc)(requiredSize,
                                            requiredAlignmentMask));
@@ -73,6 +76,29 @@ SWIFT_RT_ENTRY_IMPL(swift_allocObject)(HeapMetadata const *metadata,
   return object;
 }
 
+int swift::_swift_stdlib_reallocateUniqueObject(void *ObjectRef, size_t Size,
+                                                size_t AlignMask) {
+  auto &objectRef = *reinterpret_cast<HeapObject **>(ObjectRef);
+  HeapObject *object = objectRef;
+  assert(object->refCount.isUniquelyReferenced());
+
+  // Stack promoted objects and objects with unowned or weak references have
+  // a weak reference count above one. They must stay where they are.
+  if (AlignMask > alignof(std::max_align_t) - 1 ||
+      object->weakRefCount.getCount() != 1)
+    return 0;
+
+  SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
+  auto newObject = reinterpret_cast<HeapObject *>(realloc(object, Size));
+  if (!newObject) {
+    SWIFT_LEAKS_START_TRACKING_OBJECT(object);
+    return 0;
+  }
+  SWIFT_LEAKS_START_TRACKING_OBJECT(newObject);
+  objectRef = newObject;
+  return 1;
+}
+
 HeapObject *
 swift::swift_initStackObject(HeapMetadata const *metadata,
                              HeapObject *object) {
@@ -245,6 +271,7 @@ void swift::swift_nonatomic_retain(HeapObject *object) {
 SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_retain)(HeapObject *object) {
+  SWIFT_RUNTIME_COUNT(Retain);
   _swift_nonatomic_retain_inlined(object);
 }
 
@@ -257,6 +284,7 @@ void swift::swift_nonatomic_release(HeapObject *object) {
 SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_release)(HeapObject *object) {
+  SWIFT_RUNTIME_COUNT(Release);
   if (object  &&  object->refCount.decrementShouldDeallocateNonAtomic()) {
     // TODO: Use non-atomic _swift_release_dealloc?
     _swift_release_dealloc(object);
@@ -267,6 +295,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_retain)(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_RUNTIME_COUNT(Retain);
   _swift_retain_inlined(object);
 }
 
@@ -281,6 +310,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_retain_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_RUNTIME_COUNT(Retain);
   if (object) {
     object->refCount.increment(n);
   }
@@ -297,6 +327,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_retain_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_RUNTIME_COUNT(Retain);
   if (object) {
     object->refCount.incrementNonAtomic(n);
   }
@@ -313,6 +344,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_release)(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_RUNTIME_COUNT(Release);
   if (object  &&  object->refCount.decrementShouldDeallocate()) {
     _swift_release_dealloc(object);
   }
@@ -328,11 +360,37 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_release_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_RUNTIME_COUNT(Release);
   if (object && object->refCount.decrementShouldDeallocateN(n)) {
     _swift_release_dealloc(object);
   }
 }
 
+void swift::swift_bulkRetain(void *base, const uint32_t *offsets,
+                             uint32_t count) {
+  auto bytes = reinterpret_cast<char *>(base);
+  for (uint32_t i = 0; i != count; ++i) {
+    auto object = *reinterpret_cast<HeapObject **>(bytes + offsets[i]);
+    if (object) {
+      SWIFT_RUNTIME_COUNT(Retain);
+      object->refCount.increment();
+    }
+  }
+}
+
+void swift::swift_bulkRelease(void *base, const uint32_t *offsets,
+                              uint32_t count) {
+  auto bytes = reinterpret_cast<char *>(base);
+  for (uint32_t i = 0; i != count; ++i) {
+    auto object = *reinterpret_cast<HeapObject **>(bytes + offsets[i]);
+    if (object) {
+      SWIFT_RUNTIME_COUNT(Release);
+      if (object->refCount.decrementShouldDeallocate())
+        _swift_release_dealloc(object);
+    }
+  }
+}
+
 void swift::swift_setDeallocating(HeapObject *object) {
   object->refCount.decrementFromOneAndDeallocateNonAtomic();
 }
@@ -347,6 +405,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_release_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_RUNTIME_COUNT(Release);
   if (object && object->refCount.decrementShouldDeallocateNNonAtomic(n)) {
     _swift_release_dealloc(object);
   }
@@ -642,6 +701,7 @@ void swift::swift_deallocObject(HeapObject *object,
     SWIFT_CC(RegisterPreservingCC_IMPL) {
   assert(isAlignmentMask(allocatedAlignMask));
   assert(object->refCount.isDeallocating());
+  SWIFT_RUNTIME_COUNT(DeallocObject);
 #ifdef SWIFT_RUNTIME_CLOBBER_FREED_OBJECTS
   memset_pattern8((uint8_t *)object + sizeof(HeapObject),
                   "\xAB\xAD\x1D\xEA\xF4\xEE\xD0\bB9",
@@ -743,6 +803,37 @@ bool swift::isNativeSwiftWeakReference(WeakReference *ref) {
   return (ref->Value & WR_NATIVEMASK) == WR_NATIVE;
 }
 
+/// Wait until no other thread is reading \p ref and lock it.
+LLVM_ATTRIBUTE_NOINLINE
+static uintptr_t weakLockContended(WeakReference *ref) {
+  uintptr_t ptr;
+  do {
+    short c = 0;
+    while (__atomic_load_n(&ref->Value, __ATOMIC_RELAXED) & WR_READING) {
+      if (++c == WR_SPINLIMIT) {
+        sched_yield();
+        c -= 1;
+      }
+    }
+    ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_ACQUIRE);
+  } while (ptr & WR_READING);
+  return ptr;
+}
+
+/// Lock \p ref against other readers and return its unlocked value.
+/// Uncontended, this is a single atomic operation.
+static inline uintptr_t weakLock(WeakReference *ref) {
+  auto ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_ACQUIRE);
+  if (LLVM_UNLIKELY(ptr & WR_READING))
+    return weakLockContended(ref);
+  return ptr;
+}
+
+/// Unlock \p ref, storing \p value into it.
+static inline void weakUnlock(WeakReference *ref, uintptr_t value) {
+  __atomic_store_n(&ref->Value, value, __ATOMIC_RELEASE);
+}
+
 void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
   ref->Value = (uintptr_t)value | WR_NATIVE;
   SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(value);
@@ -761,31 +852,22 @@ HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
   }
 
   // ref might be visible to other threads
-  auto ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&ref->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        sched_yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
+  auto ptr = weakLock(ref);
   auto object = (HeapObject*)(ptr & ~WR_NATIVE);
   if (object == nullptr) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
+    weakUnlock(ref, (uintptr_t)nullptr);
     return nullptr;
   }
-  if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    return nullptr;
+
+  // Retaining the object fails exactly if it is deallocating. A live object
+  // therefore costs the lock and a single refcount update.
+  if (LLVM_LIKELY(object->refCount.tryIncrement())) {
+    weakUnlock(ref, ptr);
+    return object;
   }
-  auto result = swift_tryRetain(object);
-  __atomic_store_n(&ref->Value, ptr, __ATOMIC_RELAXED);
-  return result;
+  weakUnlock(ref, (uintptr_t)nullptr);
+  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
+  return nullptr;
 }
 
 HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
@@ -810,29 +892,18 @@ void swift::swift_weakCopyInit(WeakReference *dest, WeakReference *src) {
   }
 
   // src might be visible to other threads
-  auto ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&src->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        sched_yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
+  auto ptr = weakLock(src);
   auto object = (HeapObject*)(ptr & ~WR_NATIVE);
   if (object == nullptr) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
+    weakUnlock(src, (uintptr_t)nullptr);
     dest->Value = (uintptr_t)nullptr;
   } else if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
+    weakUnlock(src, (uintptr_t)nullptr);
     SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
     dest->Value = (uintptr_t)nullptr;
   } else {
-    SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(object);
-    __atomic_store_n(&src->Value, ptr, __ATOMIC_RELAXED);
+    object->weakRefCount.increment();
+    weakUnlock(src, ptr);
     dest->Value = (uintptr_t)object | WR_NATIVE;
   }
 }
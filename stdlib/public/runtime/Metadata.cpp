@@ -22,6 +22,7 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/RuntimeCounters.h"
 #include "swift/Strings.h"
 #include "MetadataCache.h"
 #include <algorithm>
@@ -277,15 +278,20 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
   auto genericArgs = (const void * const *) arguments;
   size_t numGenericArgs = pattern->NumKeyArguments;
 
+  bool created = false;
   auto entry = getCache(pattern).findOrAdd(genericArgs, numGenericArgs,
     [&]() -> GenericCacheEntry* {
       // Create new metadata to cache.
       auto metadata = pattern->CreateFunction(pattern, arguments);
       auto entry = GenericCacheEntry::getFromMetadata(pattern, metadata);
       entry->Value = metadata;
+      created = true;
+      SWIFT_RUNTIME_COUNT(MetadataCacheMiss);
       return entry;
     });
 
+  if (created)
+    _swift_traceMetadataInstantiation(entry->Value);
   return entry->Value;
 }
 
@@ -466,8 +472,12 @@ swift::swift_getFunctionTypeMetadata(const void *flagsArgsAndResult[]) {
     1;
   auto &Types = FunctionTypes.get();
   
+  bool created = false;
   auto entry = Types.findOrAdd(flagsArgsAndResult, numKeyArguments,
     [&]() -> FunctionCacheEntry* {
+      created = true;
+      SWIFT_RUNTIME_COUNT(MetadataCacheMiss);
+
       // Create a new entry for the cache.
       auto entry = FunctionCacheEntry::allocate(
         Types.getAllocator(),
@@ -491,6 +501,8 @@ swift::swift_getFunctionTypeMetadata(const void *flagsArgsAndResult[]) {
       return entry;
     });
 
+  if (created)
+    _swift_traceMetadataInstantiation(entry->getData());
   return entry->getData();
 }
 
@@ -1000,8 +1012,12 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
   // FIXME: include labels when uniquing!
   auto genericArgs = (const void * const *) elements;
   auto &Types = TupleTypes.get();
+  bool created = false;
   auto entry = Types.findOrAdd(genericArgs, numElements,
     [&]() -> TupleCacheEntry* {
+      created = true;
+      SWIFT_RUNTIME_COUNT(MetadataCacheMiss);
+
       // Create a new entry for the cache.
 
       typedef TupleTypeMetadata::Element Element;
@@ -1084,6 +1100,8 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
       return entry;
     });
 
+  if (created)
+    _swift_traceMetadataInstantiation(entry->getData());
   return entry->getData();
 }
 
@@ -1454,15 +1472,14 @@ static inline ClassROData *getROData(ClassMetadata *theClass) {
 
 static void _swift_initGenericClassObjCName(ClassMetadata *theClass) {
   // Use the remangler to generate a mangled name from the type metadata.
-  auto demangling = _swift_buildDemanglingForMetadata(theClass);
+  Demangle::NodeFactory Factory;
+  auto demangling = _swift_buildDemanglingForMetadata(theClass, Factory);
 
   // Remangle that into a new type mangling string.
-  auto typeNode
-    = Demangle::NodeFactory::create(Demangle::Node::Kind::TypeMangling);
-  typeNode->addChild(demangling);
-  auto globalNode
-    = Demangle::NodeFactory::create(Demangle::Node::Kind::Global);
-  globalNode->addChild(typeNode);
+  auto typeNode = Factory.createNode(Demangle::Node::Kind::TypeMangling);
+  typeNode->addChild(demangling, Factory);
+  auto globalNode = Factory.createNode(Demangle::Node::Kind::Global);
+  globalNode->addChild(typeNode, Factory);
   
   auto string = Demangle::mangleNode(globalNode);
   
@@ -1983,10 +2000,41 @@ namespace {
       return &Metadata;
     }
   };
+
+  /// An entry of the cache of existential types with exactly one protocol,
+  /// which is keyed by the protocol descriptor itself, so that looking it up
+  /// doesn't need to sort or hash an argument array.
+  class SingleProtocolExistentialCacheEntry {
+    const ProtocolDescriptor *Protocol;
+
+  public:
+    const ExistentialTypeMetadata *Metadata;
+
+    SingleProtocolExistentialCacheEntry(
+        const ProtocolDescriptor *protocol,
+        const ExistentialTypeMetadata *metadata)
+      : Protocol(protocol), Metadata(metadata) {}
+
+    int compareWithKey(const ProtocolDescriptor *protocol) const {
+      if (protocol == Protocol)
+        return 0;
+      return (uintptr_t(protocol) < uintptr_t(Protocol) ? -1 : 1);
+    }
+
+    static size_t getExtraAllocationSize(
+        const ProtocolDescriptor *protocol,
+        const ExistentialTypeMetadata *metadata) {
+      return 0;
+    }
+  };
 }
 
 struct ExistentialTypeState {
   MetadataCache<ExistentialCacheEntry> Types;
+  /// The metadata for the empty protocol composition, \c Any.
+  std::atomic<const ExistentialTypeMetadata *> AnyMetadata{nullptr};
+  /// The metadata for existentials of a single protocol, by protocol.
+  ConcurrentMap<SingleProtocolExistentialCacheEntry> SingleProtocolTypes;
   llvm::DenseMap<unsigned, const ValueWitnessTable*> OpaqueValueWitnessTables;
   llvm::DenseMap<unsigned, const ExtraInhabitantsValueWitnessTable*>
     ClassValueWitnessTables;
@@ -2279,15 +2327,16 @@ ExistentialTypeMetadata::getWitnessTable(const OpaqueValue *container,
   return witnessTables[i];
 }
 
-/// \brief Fetch a uniqued metadata for an existential type. The array
-/// referenced by \c protocols will be sorted in-place.
-SWIFT_RT_ENTRY_VISIBILITY
-const ExistentialTypeMetadata *
-swift::swift_getExistentialTypeMetadata(size_t numProtocols,
-                                        const ProtocolDescriptor **protocols)
-    SWIFT_CC(RegisterPreservingCC_IMPL) {
-  // Sort the protocol set.
-  std::sort(protocols, protocols + numProtocols);
+/// Look up or instantiate the metadata for an existential type in the
+/// general cache, which is keyed by the sorted protocol array.
+static const ExistentialTypeMetadata *
+getExistentialTypeMetadataImpl(ExistentialTypeState &E, size_t numProtocols,
+                               const ProtocolDescriptor **protocols) {
+  // Sort the protocol set.  IRGen emits the protocols of a composition in
+  // a fixed order, so the set is often sorted already; don't write to it
+  // then.
+  if (!std::is_sorted(protocols, protocols + numProtocols))
+    std::sort(protocols, protocols + numProtocols);
 
   // Calculate the class constraint and number of witness tables for the
   // protocol set.
@@ -2305,7 +2354,6 @@ swift::swift_getExistentialTypeMetadata(size_t numProtocols,
 
   auto protocolArgs = reinterpret_cast<const void * const *>(protocols);
 
-  auto &E = Existentials.get();
   auto entry = E.Types.findOrAdd(protocolArgs, numProtocols,
     [&]() -> ExistentialCacheEntry* {
       // Create a new entry for the cache.
@@ -2338,6 +2386,39 @@ swift::swift_getExistentialTypeMetadata(size_t numProtocols,
   return entry->getData();
 }
 
+/// \brief Fetch a uniqued metadata for an existential type. The array
+/// referenced by \c protocols will be sorted in-place.
+SWIFT_RT_ENTRY_VISIBILITY
+const ExistentialTypeMetadata *
+swift::swift_getExistentialTypeMetadata(size_t numProtocols,
+                                        const ProtocolDescriptor **protocols)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  auto &E = Existentials.get();
+
+  // Fast path for 'Any'.
+  if (numProtocols == 0) {
+    if (auto metadata = E.AnyMetadata.load(std::memory_order_acquire))
+      return metadata;
+    auto metadata = getExistentialTypeMetadataImpl(E, 0, protocols);
+    E.AnyMetadata.store(metadata, std::memory_order_release);
+    return metadata;
+  }
+
+  // Fast path for existentials of a single protocol, which are looked up by
+  // the protocol descriptor alone.  Racing threads get the same uniqued
+  // metadata from the general cache, so it doesn't matter whose entry wins.
+  if (numProtocols == 1) {
+    const ProtocolDescriptor *protocol = protocols[0];
+    if (auto entry = E.SingleProtocolTypes.find(protocol))
+      return entry->Metadata;
+    auto metadata = getExistentialTypeMetadataImpl(E, 1, protocols);
+    E.SingleProtocolTypes.getOrInsert(protocol, metadata);
+    return metadata;
+  }
+
+  return getExistentialTypeMetadataImpl(E, numProtocols, protocols);
+}
+
 /// \brief Perform a copy-assignment from one existential container to another.
 /// Both containers must be of the same existential type representable with no
 /// witness tables.
@@ -319,6 +319,15 @@ public:
            ValueTy::getName(), this, key.Hash);
 #endif
 
+    // Fast path: if the entry exists and has been initialized, return it.
+    // This doesn't allocate, take the lock, or write to the map unless the
+    // last-search cache changes, so concurrent lookups of metadata that has
+    // already been instantiated don't contend with each other.
+    if (Entry *entry = Map.find(key)) {
+      if (auto value = entry->getValue())
+        return value;
+    }
+
     // Ensure the existence of a map entry.
     auto insertResult = Map.getOrInsert(key);
     Entry *entry = insertResult.first;
@@ -362,19 +371,21 @@ public:
     // creating the metadata.
     auto value = builder();
 
-    // Update the linked list.
-    value->Next = Head;
-    Head = value;
-
 #if SWIFT_DEBUG_RUNTIME
         printf("%s(%p): created %p\n",
                ValueTy::getName(), (void*) this, value);
 #endif
 
-    // Acquire the lock, set the value, and notify any waiters.
+    // Acquire the lock, update the linked list, set the value, and notify
+    // any waiters. Different entries can be built by different threads at
+    // the same time, so the list must be updated under the lock.
     auto concurrency = Concurrency.get();
     concurrency->Lock.withLockThenNotifyAll(
-        concurrency->Queue, [&entry, &value] { entry->setValue(value); });
+        concurrency->Queue, [&entry, &value, this] {
+          value->Next = Head;
+          Head = value;
+          entry->setValue(value);
+        });
 
     return value;
   }
@@ -250,6 +250,28 @@ _searchTypeMetadataRecords(const TypeMetadataState &T,
   return nullptr;
 }
 
+const NominalTypeDescriptor *
+swift::_searchNominalTypeDescriptorByMangledName(
+                                            const llvm::StringRef typeName) {
+  auto &T = TypeMetadataRecords.get();
+
+  ScopedLock guard(T.SectionsToScanLock);
+
+  for (auto &section : T.SectionsToScan) {
+    for (const auto &record : section) {
+      const NominalTypeDescriptor *ntd = nullptr;
+      if (auto metadata = record.getCanonicalTypeMetadata())
+        ntd = metadata->getNominalTypeDescriptor().get();
+      else
+        ntd = record.getNominalTypeDescriptor();
+
+      if (ntd && ntd->Name.get() == typeName)
+        return ntd;
+    }
+  }
+  return nullptr;
+}
+
 static const Metadata *
 _typeByMangledName(const llvm::StringRef typeName) {
   const Metadata *foundMetadata = nullptr;
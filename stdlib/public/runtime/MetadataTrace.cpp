@@ -0,0 +1,239 @@
+//===--- MetadataTrace.cpp - Metadata instantiation trace -----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Recording which metadata and conformances a process instantiates, and
+// prewarming the runtime caches from such a recording.
+//
+// If the environment variable SWIFT_DEBUG_METADATA_TRACE names a file, the
+// runtime appends a line to it for every generic, tuple and function type
+// metadata it instantiates, and for every conformance it looks up for the
+// first time, in instantiation order:
+//
+//   metadata <type> # <readable name>
+//   conformance <type> <mangled protocol name> # <readable name>
+//
+// where <type> is one of
+//
+//   N <mangled nominal type name> <number of arguments> <type>...
+//   T <number of elements> <type>...
+//   ?
+//
+// '?' stands for types which cannot be looked up by name, like function
+// types, labeled tuples and generic types with witness table arguments.
+//
+// If the environment variable SWIFT_METADATA_PREWARM names such a file, the
+// first metadata instantiation of the process starts a background thread
+// which replays the file, so that the caches are already populated when the
+// main thread gets to the types.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Mutex.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "Private.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+using namespace swift;
+
+extern "C" const Metadata *
+swift_getTypeByMangledName(const char *typeName, size_t typeNameLength);
+
+namespace {
+  struct MetadataTraceState {
+    FILE *TraceFile = nullptr;
+    Mutex TraceLock;
+
+    MetadataTraceState();
+  };
+}
+
+static Lazy<MetadataTraceState> MetadataTrace;
+
+/// Instantiations by the prewarming thread are not traced.
+static thread_local bool IsPrewarmingThread = false;
+
+/// Append the trace encoding of \p type to \p result.
+static void encodeTypeForTrace(const Metadata *type, std::string &result) {
+  switch (type->getKind()) {
+  case MetadataKind::Class:
+  case MetadataKind::Struct:
+  case MetadataKind::Enum:
+  case MetadataKind::Optional: {
+    auto ntd = type->getNominalTypeDescriptor().get();
+    if (!ntd)
+      break;
+    auto &params = ntd->GenericParams;
+    if (params.Flags.hasGenericParent() ||
+        params.NumGenericRequirements != params.NumPrimaryParams)
+      break;
+    result += "N ";
+    result += ntd->Name.get();
+    result += " ";
+    result += std::to_string(params.NumPrimaryParams);
+    auto typeBytes = reinterpret_cast<const char *>(type);
+    auto genericParam = reinterpret_cast<const Metadata * const *>(
+                         typeBytes + sizeof(void*) * params.Offset);
+    for (unsigned i = 0; i != params.NumPrimaryParams; ++i) {
+      result += " ";
+      encodeTypeForTrace(genericParam[i], result);
+    }
+    return;
+  }
+  case MetadataKind::Tuple: {
+    auto tuple = static_cast<const TupleTypeMetadata *>(type);
+    if (tuple->Labels)
+      break;
+    result += "T ";
+    result += std::to_string(tuple->NumElements);
+    for (unsigned i = 0, e = tuple->NumElements; i != e; ++i) {
+      result += " ";
+      encodeTypeForTrace(tuple->getElement(i).Type, result);
+    }
+    return;
+  }
+  default:
+    break;
+  }
+  result += "?";
+}
+
+static void writeTraceLine(MetadataTraceState &T, const std::string &line) {
+  ScopedLock guard(T.TraceLock);
+  fputs(line.c_str(), T.TraceFile);
+  fflush(T.TraceFile);
+}
+
+void swift::_swift_traceMetadataInstantiation(const Metadata *type) {
+  auto &T = MetadataTrace.get();
+  if (!T.TraceFile || IsPrewarmingThread)
+    return;
+
+  std::string line = "metadata ";
+  encodeTypeForTrace(type, line);
+  line += " # " + nameForMetadata(type) + "\n";
+  writeTraceLine(T, line);
+}
+
+void swift::_swift_traceConformanceLookup(const Metadata *type,
+                                          const ProtocolDescriptor *protocol) {
+  auto &T = MetadataTrace.get();
+  if (!T.TraceFile || IsPrewarmingThread)
+    return;
+
+  std::string line = "conformance ";
+  encodeTypeForTrace(type, line);
+  line += " ";
+  line += protocol->Name;
+  line += " # " + nameForMetadata(type) + "\n";
+  writeTraceLine(T, line);
+}
+
+/// Parse and instantiate one type of a trace line. Returns null if the type
+/// cannot be instantiated.
+static const Metadata *
+decodeTypeFromTrace(llvm::SmallVectorImpl<llvm::StringRef>::iterator &token,
+                    llvm::SmallVectorImpl<llvm::StringRef>::iterator end) {
+  if (token == end)
+    return nullptr;
+  llvm::StringRef kind = *token++;
+
+  unsigned numArgs;
+  if (kind == "N") {
+    if (token == end)
+      return nullptr;
+    llvm::StringRef name = *token++;
+    if (token == end || (token++)->getAsInteger(10, numArgs))
+      return nullptr;
+
+    llvm::SmallVector<const Metadata *, 4> args;
+    for (unsigned i = 0; i != numArgs; ++i) {
+      auto arg = decodeTypeFromTrace(token, end);
+      if (!arg)
+        return nullptr;
+      args.push_back(arg);
+    }
+    if (numArgs == 0)
+      return swift_getTypeByMangledName(name.data(), name.size());
+
+    auto ntd = _searchNominalTypeDescriptorByMangledName(name);
+    if (!ntd || ntd->GenericParams.NumPrimaryParams != numArgs ||
+        ntd->GenericParams.NumGenericRequirements != numArgs ||
+        ntd->GenericParams.Flags.hasGenericParent())
+      return nullptr;
+    auto pattern = ntd->getGenericMetadataPattern();
+    if (!pattern || pattern->NumKeyArguments != numArgs)
+      return nullptr;
+    return swift_getGenericMetadata(pattern, args.data());
+  }
+
+  if (kind == "T") {
+    if (token == end || (token++)->getAsInteger(10, numArgs))
+      return nullptr;
+    llvm::SmallVector<const Metadata *, 4> elements;
+    for (unsigned i = 0; i != numArgs; ++i) {
+      auto element = decodeTypeFromTrace(token, end);
+      if (!element)
+        return nullptr;
+      elements.push_back(element);
+    }
+    return swift_getTupleTypeMetadata(numArgs, elements.data(),
+                                      /*labels*/ nullptr,
+                                      /*proposedWitnesses*/ nullptr);
+  }
+
+  return nullptr;
+}
+
+/// Replay the trace file \p path. Lines which cannot be replayed, e.g. because
+/// the types are not loaded in this process, are skipped.
+static void prewarmFromTrace(std::string path) {
+  IsPrewarmingThread = true;
+
+  FILE *file = fopen(path.c_str(), "r");
+  if (!file)
+    return;
+
+  char buffer[4096];
+  while (fgets(buffer, sizeof(buffer), file)) {
+    llvm::StringRef line(buffer);
+    line = line.split('#').first;
+
+    llvm::SmallVector<llvm::StringRef, 16> tokens;
+    line.split(tokens, ' ', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    if (tokens.empty())
+      continue;
+
+    auto token = tokens.begin() + 1;
+    auto type = decodeTypeFromTrace(token, tokens.end());
+    if (!type || tokens[0] != "conformance")
+      continue;
+    if (token == tokens.end())
+      continue;
+    if (auto protocol = _searchProtocolDescriptorByMangledName(*token))
+      (void)swift_conformsToProtocol(type, protocol);
+  }
+  fclose(file);
+}
+
+MetadataTraceState::MetadataTraceState() {
+  if (const char *tracePath = getenv("SWIFT_DEBUG_METADATA_TRACE"))
+    TraceFile = fopen(tracePath, "a");
+
+  if (const char *prewarmPath = getenv("SWIFT_METADATA_PREWARM"))
+    std::thread(prewarmFromTrace, std::string(prewarmPath)).detach();
+}
@@ -18,9 +18,18 @@
 #include "swift/Runtime/Mutex.h"
 
 #include "swift/Runtime/Debug.h"
+#include "swift/Runtime/RuntimeCounters.h"
+#include "llvm/Support/Compiler.h"
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 
+#if SWIFT_READWRITELOCK_USES_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using namespace swift;
 
 #define reportError(PThreadFunction)                                           \
@@ -109,6 +118,8 @@ bool MutexPlatformHelper::try_lock(pthread_mutex_t &mutex) {
                           /* returnFalseOnEBUSY = */ true);
 }
 
+#if !SWIFT_READWRITELOCK_USES_FUTEX
+
 void ReadWriteLockPlatformHelper::init(pthread_rwlock_t &rwlock) {
   reportError(pthread_rwlock_init(&rwlock, nullptr));
 }
@@ -142,3 +153,145 @@ void ReadWriteLockPlatformHelper::readUnlock(pthread_rwlock_t &rwlock) {
 void ReadWriteLockPlatformHelper::writeUnlock(pthread_rwlock_t &rwlock) {
   reportError(pthread_rwlock_unlock(&rwlock));
 }
+
+#else // SWIFT_READWRITELOCK_USES_FUTEX
+
+// The whole state of the lock is one 32-bit word, on which threads also wait
+// with futex(2). Taking or releasing the lock without contention is a single
+// atomic operation, and readers never serialize on anything but that word.
+//
+// Writers have priority: once a thread is waiting for the lock, new readers
+// wait as well, so that a steady stream of readers cannot starve a writer.
+
+namespace {
+enum : uint32_t {
+  /// A writer holds the lock.
+  WriterBit = 1U << 31,
+  /// At least one thread is waiting, or about to wait, on the futex. The
+  /// thread which releases the lock last clears it and wakes all waiters.
+  WaitersBit = 1U << 30,
+  /// The number of readers holding the lock.
+  ReaderCountMask = WaitersBit - 1
+};
+}
+
+static uint32_t loadState(ReadWriteLockHandle &rwlock) {
+  return __atomic_load_n(&rwlock.State, __ATOMIC_RELAXED);
+}
+
+/// Replaces the state \p expected by \p desired, or loads the current state
+/// into \p expected if it is a different one.
+static bool compareAndSwapState(ReadWriteLockHandle &rwlock,
+                                uint32_t &expected, uint32_t desired) {
+  return __atomic_compare_exchange_n(&rwlock.State, &expected, desired,
+                                     /*weak=*/false, __ATOMIC_ACQUIRE,
+                                     __ATOMIC_RELAXED);
+}
+
+static void wakeAllWaiters(ReadWriteLockHandle &rwlock) {
+  syscall(SYS_futex, &rwlock.State, FUTEX_WAKE_PRIVATE, INT_MAX,
+          nullptr, nullptr, 0);
+}
+
+/// Blocks until the lock may have changed from \p state, which was found to
+/// be held. Wake-ups may be spurious.
+static void waitForLock(ReadWriteLockHandle &rwlock, uint32_t state) {
+  if (!(state & WaitersBit)) {
+    if (!compareAndSwapState(rwlock, state, state | WaitersBit))
+      return;
+    state |= WaitersBit;
+  }
+  // Fails right away, with EAGAIN, if the state already changed again.
+  syscall(SYS_futex, &rwlock.State, FUTEX_WAIT_PRIVATE, state,
+          nullptr, nullptr, 0);
+}
+
+/// Takes a read lock if neither a writer holds the lock nor threads wait for
+/// it. \p state is the last known state of the lock.
+static bool tryAcquireRead(ReadWriteLockHandle &rwlock, uint32_t &state) {
+  while (!(state & (WriterBit | WaitersBit))) {
+    if ((state & ReaderCountMask) == ReaderCountMask)
+      fatalError(/* flags = */ 0, "too many readers of a ReadWriteLock\n");
+    if (compareAndSwapState(rwlock, state, state + 1))
+      return true;
+  }
+  return false;
+}
+
+/// Takes the write lock if nobody holds the lock. \p state is the last known
+/// state of the lock.
+static bool tryAcquireWrite(ReadWriteLockHandle &rwlock, uint32_t &state) {
+  while (!(state & ~WaitersBit)) {
+    if (compareAndSwapState(rwlock, state, state | WriterBit))
+      return true;
+  }
+  return false;
+}
+
+void ReadWriteLockPlatformHelper::init(ReadWriteLockHandle &rwlock) {
+  rwlock.State = 0;
+}
+
+void ReadWriteLockPlatformHelper::destroy(ReadWriteLockHandle &rwlock) {
+  if (loadState(rwlock) & ~WaitersBit)
+    fatalError(/* flags = */ 0, "destroying a locked ReadWriteLock\n");
+}
+
+void ReadWriteLockPlatformHelper::readLock(ReadWriteLockHandle &rwlock) {
+  SWIFT_RUNTIME_COUNT(ReadWriteLockAcquire);
+  uint32_t state = loadState(rwlock);
+  if (LLVM_LIKELY(tryAcquireRead(rwlock, state)))
+    return;
+
+  SWIFT_RUNTIME_COUNT(ReadWriteLockContention);
+  do {
+    waitForLock(rwlock, state);
+    state = loadState(rwlock);
+  } while (!tryAcquireRead(rwlock, state));
+}
+
+bool ReadWriteLockPlatformHelper::try_readLock(ReadWriteLockHandle &rwlock) {
+  uint32_t state = loadState(rwlock);
+  if (!tryAcquireRead(rwlock, state))
+    return false;
+  SWIFT_RUNTIME_COUNT(ReadWriteLockAcquire);
+  return true;
+}
+
+void ReadWriteLockPlatformHelper::writeLock(ReadWriteLockHandle &rwlock) {
+  SWIFT_RUNTIME_COUNT(ReadWriteLockAcquire);
+  uint32_t state = 0;
+  if (LLVM_LIKELY(compareAndSwapState(rwlock, state, WriterBit)))
+    return;
+
+  SWIFT_RUNTIME_COUNT(ReadWriteLockContention);
+  while (!tryAcquireWrite(rwlock, state)) {
+    waitForLock(rwlock, state);
+    state = loadState(rwlock);
+  }
+}
+
+bool ReadWriteLockPlatformHelper::try_writeLock(ReadWriteLockHandle &rwlock) {
+  uint32_t state = loadState(rwlock);
+  if (!tryAcquireWrite(rwlock, state))
+    return false;
+  SWIFT_RUNTIME_COUNT(ReadWriteLockAcquire);
+  return true;
+}
+
+void ReadWriteLockPlatformHelper::readUnlock(ReadWriteLockHandle &rwlock) {
+  uint32_t state = __atomic_sub_fetch(&rwlock.State, 1, __ATOMIC_RELEASE);
+  // If this was the last reader and threads are waiting, let them retry.
+  // Whoever takes the lock in between keeps the waiters bit and wakes the
+  // waiters when it unlocks.
+  if (state == WaitersBit && compareAndSwapState(rwlock, state, 0))
+    wakeAllWaiters(rwlock);
+}
+
+void ReadWriteLockPlatformHelper::writeUnlock(ReadWriteLockHandle &rwlock) {
+  uint32_t state = __atomic_exchange_n(&rwlock.State, 0, __ATOMIC_RELEASE);
+  if (state & WaitersBit)
+    wakeAllWaiters(rwlock);
+}
+
+#endif // SWIFT_READWRITELOCK_USES_FUTEX
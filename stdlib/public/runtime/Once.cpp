@@ -19,6 +19,14 @@
 #include "swift/Runtime/Debug.h"
 #include <type_traits>
 
+#if defined(__linux__)
+#include <atomic>
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using namespace swift;
 
 #ifdef __APPLE__
@@ -35,6 +43,70 @@ static_assert(std::is_same<swift_once_t, dispatch_once_t>::value,
 static_assert(sizeof(swift_once_t) <= sizeof(void*),
               "swift_once_t must be no larger than the platform word");
 
+#if defined(__linux__)
+
+// The states of a swift_once_t on Linux. The compiler inlines the check for
+// OnceDone, so it is ABI; see SwiftTargetInfo.
+enum : intptr_t {
+  OnceUninitialized = 0,
+  OnceRunning = 1,
+  OnceRunningWithWaiters = 2,
+  OnceDone = -1
+};
+
+static_assert(sizeof(std::atomic<intptr_t>) == sizeof(swift_once_t),
+              "swift_once_t is accessed atomically");
+
+/// Returns the address of the half of the predicate which holds the low 32
+/// bits of its value. Futexes only operate on 32-bit words. All states
+/// except OnceDone fit into the low half, and OnceDone sets all bits, so
+/// waiting on the low half sees every state change.
+static int *getFutexWord(swift_once_t *predicate) {
+  auto word = reinterpret_cast<int *>(predicate);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  if (sizeof(swift_once_t) > sizeof(int))
+    word += sizeof(swift_once_t) / sizeof(int) - 1;
+#endif
+  return word;
+}
+
+static void futexWait(swift_once_t *predicate, int expected) {
+  syscall(SYS_futex, getFutexWord(predicate), FUTEX_WAIT_PRIVATE, expected,
+          nullptr, nullptr, 0);
+}
+
+static void futexWakeAll(swift_once_t *predicate) {
+  syscall(SYS_futex, getFutexWord(predicate), FUTEX_WAKE_PRIVATE, INT_MAX,
+          nullptr, nullptr, 0);
+}
+
+/// The out-of-line part of swift_once, for predicates which are not done yet.
+LLVM_ATTRIBUTE_NOINLINE
+static void onceSlow(std::atomic<intptr_t> &state,
+                            swift_once_t *predicate, void (*fn)(void *)) {
+  intptr_t value = OnceUninitialized;
+  if (state.compare_exchange_strong(value, OnceRunning,
+                                    std::memory_order_acquire)) {
+    fn(nullptr);
+    if (state.exchange(OnceDone, std::memory_order_release)
+          == OnceRunningWithWaiters)
+      futexWakeAll(predicate);
+    return;
+  }
+
+  // Another thread is running the initializer. Wait for it to finish.
+  while (value != OnceDone) {
+    if (value == OnceRunning &&
+        !state.compare_exchange_weak(value, OnceRunningWithWaiters,
+                                     std::memory_order_acquire))
+      continue;
+    futexWait(predicate, int(OnceRunningWithWaiters));
+    value = state.load(std::memory_order_acquire);
+  }
+}
+
+#endif
+
 /// Runs the given function with the given context argument exactly once.
 /// The predicate argument must point to a global or static variable of static
 /// extent of type swift_once_t.
@@ -43,6 +115,11 @@ void swift::swift_once(swift_once_t *predicate, void (*fn)(void *)) {
   dispatch_once_f(predicate, nullptr, fn);
 #elif defined(__CYGWIN__)
   _swift_once_f(predicate, nullptr, fn);
+#elif defined(__linux__)
+  auto &state = *reinterpret_cast<std::atomic<intptr_t> *>(predicate);
+  if (LLVM_LIKELY(state.load(std::memory_order_acquire) == OnceDone))
+    return;
+  onceSlow(state, predicate, fn);
 #else
   // FIXME: We're relying here on the coincidence that libstdc++ uses pthread's
   // pthread_once, and that on glibc pthread_once follows a compatible init
@@ -156,8 +156,27 @@ namespace swift {
   const Metadata *
   _searchConformancesByMangledTypeName(const llvm::StringRef typeName);
 
+  const NominalTypeDescriptor *
+  _searchNominalTypeDescriptorByMangledName(const llvm::StringRef typeName);
+
+  const ProtocolDescriptor *
+  _searchProtocolDescriptorByMangledName(const llvm::StringRef protocolName);
+
+  /// Record a newly instantiated metadata in the metadata trace, if
+  /// SWIFT_DEBUG_METADATA_TRACE is set. See MetadataTrace.cpp.
+  void _swift_traceMetadataInstantiation(const Metadata *type);
+
+  /// Record a conformance which was found for the first time in the metadata
+  /// trace, if SWIFT_DEBUG_METADATA_TRACE is set.
+  void _swift_traceConformanceLookup(const Metadata *type,
+                                     const ProtocolDescriptor *protocol);
+
 #if SWIFT_OBJC_INTEROP
-  Demangle::NodePointer _swift_buildDemanglingForMetadata(const Metadata *type);
+  /// Build a demangle tree for \p type. The tree is allocated in, and owned
+  /// by, \p Factory.
+  Demangle::NodePointer
+  _swift_buildDemanglingForMetadata(const Metadata *type,
+                                    Demangle::NodeFactory &Factory);
 #endif
 
   /// A helper function which avoids performing a store if the destination
@@ -29,6 +29,7 @@
 #include <link.h>
 #endif
 
+#include <algorithm>
 #include <dlfcn.h>
 
 using namespace swift;
@@ -151,12 +152,82 @@ const {
 namespace {
   struct ConformanceSection {
     const ProtocolConformanceRecord *Begin, *End;
+
+    /// The records of this section sorted by protocol, so that a lookup only
+    /// visits the records for the protocol it is looking for. This is built
+    /// the first time the section is searched, under the SectionsToScanLock.
+    std::vector<const ProtocolConformanceRecord *> ByProtocol;
+
+    using RecordRange =
+      std::pair<std::vector<const ProtocolConformanceRecord *>::iterator,
+                std::vector<const ProtocolConformanceRecord *>::iterator>;
+
+    ConformanceSection(const ProtocolConformanceRecord *begin,
+                       const ProtocolConformanceRecord *end)
+      : Begin(begin), End(end) {}
+
     const ProtocolConformanceRecord *begin() const {
       return Begin;
     }
     const ProtocolConformanceRecord *end() const {
       return End;
     }
+
+    /// Build the ByProtocol index.
+    ///
+    /// The compiler emits the records of each object file grouped by
+    /// protocol, so a section consists of a few runs of records for the same
+    /// protocol. Sorting the runs instead of the records keeps building the
+    /// index linear in the number of records.
+    void buildByProtocolIndex() {
+      struct Run {
+        const ProtocolConformanceRecord *Begin, *End;
+      };
+      std::vector<Run> runs;
+      for (auto record = Begin; record != End; ++record) {
+        if (runs.empty() ||
+            runs.back().Begin->getProtocol() != record->getProtocol())
+          runs.push_back({record, record});
+        runs.back().End = record + 1;
+      }
+      std::stable_sort(runs.begin(), runs.end(),
+                       [](const Run &lhs, const Run &rhs) {
+        return uintptr_t(lhs.Begin->getProtocol())
+             < uintptr_t(rhs.Begin->getProtocol());
+      });
+
+      ByProtocol.reserve(End - Begin);
+      for (auto &run : runs)
+        for (auto record = run.Begin; record != run.End; ++record)
+          ByProtocol.push_back(record);
+    }
+
+    /// Return the records in this section which conform a type to
+    /// \p protocol. Must be called with the SectionsToScanLock held.
+    RecordRange getRecordsForProtocol(const ProtocolDescriptor *protocol) {
+      if (ByProtocol.empty() && Begin != End)
+        buildByProtocolIndex();
+
+      auto first = std::lower_bound(ByProtocol.begin(), ByProtocol.end(),
+                                    protocol,
+                                    [](const ProtocolConformanceRecord *record,
+                                       const ProtocolDescriptor *protocol) {
+        return uintptr_t(record->getProtocol()) < uintptr_t(protocol);
+      });
+      auto last = std::upper_bound(first, ByProtocol.end(), protocol,
+                                   [](const ProtocolDescriptor *protocol,
+                                      const ProtocolConformanceRecord *record) {
+        return uintptr_t(protocol) < uintptr_t(record->getProtocol());
+      });
+      return RecordRange(first, last);
+    }
+
+    /// Returns true if this section has any conformances to \p protocol.
+    /// Must be called with the SectionsToScanLock held.
+    bool hasRecordsForProtocol(const ProtocolDescriptor *protocol) {
+      auto range = getRecordsForProtocol(protocol);
+      return range.first != range.second;
+    }
   };
 
   struct ConformanceCacheKey {
@@ -291,7 +362,7 @@ _registerProtocolConformances(ConformanceState &C,
                               const ProtocolConformanceRecord *begin,
                               const ProtocolConformanceRecord *end) {
   ScopedLock guard(C.SectionsToScanLock);
-  C.SectionsToScan.push_back(ConformanceSection{begin, end});
+  C.SectionsToScan.push_back(ConformanceSection(begin, end));
 }
 
 static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
@@ -562,6 +633,9 @@ recur:
   // it may mean that all of the superclasses do not have this conformance,
   // but the actual type may still have this conformance.
   if (FoundConformance.second) {
+    // Only trace conformances which we had to find in the records.
+    if (FoundConformance.first && numSections != 0)
+      _swift_traceConformanceLookup(origType, protocol);
     if (FoundConformance.first || foundEntry)
       return FoundConformance.first;
   }
@@ -596,18 +670,40 @@ recur:
   unsigned sectionIdx = foundEntry ? foundEntry->getFailureGeneration() : 0;
   unsigned endSectionIdx = C.SectionsToScan.size();
 
+  // If we have a cached negative result and none of the sections loaded
+  // since then conform anything to this protocol, the negative result is
+  // still valid. Images which only add conformances to other protocols
+  // don't invalidate it.
+  if (foundEntry) {
+    bool sectionsHaveProtocol = false;
+    for (unsigned i = sectionIdx; i < endSectionIdx; ++i) {
+      if (C.SectionsToScan[i].hasRecordsForProtocol(protocol)) {
+        sectionsHaveProtocol = true;
+        break;
+      }
+    }
+
+    if (!sectionsHaveProtocol) {
+      C.cacheFailure(type, protocol);
+      C.SectionsToScanLock.unlock();
+      return nullptr;
+    }
+  }
+
   for (; sectionIdx < endSectionIdx; ++sectionIdx) {
     auto &section = C.SectionsToScan[sectionIdx];
-    // Eagerly pull records for nondependent witnesses into our cache.
-    for (const auto &record : section) {
+    // Eagerly pull records for nondependent witnesses into our cache. Only
+    // the records for this protocol can match, so skip all others.
+    auto records = section.getRecordsForProtocol(protocol);
+    for (auto recordIt = records.first; recordIt != records.second;
+         ++recordIt) {
+      const auto &record = **recordIt;
+      assert(record.getProtocol() == protocol);
+
       // If the record applies to a specific type, cache it.
       if (auto metadata = record.getCanonicalTypeMetadata()) {
         auto P = record.getProtocol();
 
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
         if (!isRelatedType(type, metadata, /*isMetadata=*/true))
           continue;
 
@@ -632,10 +728,6 @@ recur:
         auto R = record.getNominalTypeDescriptor();
         auto P = record.getProtocol();
 
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
         if (!isRelatedType(type, R, /*isMetadata=*/false))
           continue;
 
@@ -679,3 +771,20 @@ swift::_searchConformancesByMangledTypeName(const llvm::StringRef typeName) {
 
   return foundMetadata;
 }
+
+const ProtocolDescriptor *
+swift::_searchProtocolDescriptorByMangledName(
+                                      const llvm::StringRef protocolName) {
+  auto &C = Conformances.get();
+
+  ScopedLock guard(C.SectionsToScanLock);
+
+  for (auto &section : C.SectionsToScan) {
+    for (const auto &record : section) {
+      auto protocol = record.getProtocol();
+      if (protocol && protocolName == protocol->Name)
+        return protocol;
+    }
+  }
+  return nullptr;
+}
@@ -16,6 +16,8 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Enum.h"
 #include "swift/Basic/Demangle.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Debug.h"
 #include "swift/Runtime/Portability.h"
 #include "Private.h"
@@ -24,6 +26,7 @@
 #include <cstring>
 #include <new>
 #include <string>
+#include <vector>
 
 #if SWIFT_OBJC_INTEROP
 #include "swift/Runtime/ObjCBridge.h"
@@ -462,6 +465,112 @@ static const char *getFieldName(const char *fieldNames, size_t i) {
   return fieldName;
 }
 
+// -- Field tables.
+
+/// The name, offset and type of a stored property of a struct or class.
+struct FieldInfo {
+  const char *Name;
+  uintptr_t Offset;
+  FieldType Type;
+};
+
+/// The fields of a struct or class metadata, in declaration order.
+///
+/// Looking up a field name walks the list of field names, and the field
+/// type vector is produced by a function which may instantiate metadata, so
+/// a mirror asking for every child in turn would do quadratic work. The
+/// table is built the first time a type is reflected and kept forever, like
+/// the metadata it describes.
+class FieldTableCacheEntry {
+  const Metadata *Type;
+  size_t NumFields;
+
+  FieldInfo *getFieldStorage() {
+    return reinterpret_cast<FieldInfo *>(this + 1);
+  }
+
+public:
+  FieldTableCacheEntry(const Metadata *type, size_t numFields,
+                       const char *fieldNames, const uintptr_t *offsets,
+                       const FieldType *fieldTypes)
+    : Type(type), NumFields(numFields) {
+    FieldInfo *fields = getFieldStorage();
+    const char *fieldName = fieldNames;
+    for (size_t i = 0; i != numFields; ++i) {
+      fields[i] = { fieldName, offsets[i], fieldTypes[i] };
+      fieldName += strlen(fieldName) + 1;
+    }
+  }
+
+  int compareWithKey(const Metadata *type) const {
+    if (type == Type)
+      return 0;
+    return (uintptr_t(type) < uintptr_t(Type) ? -1 : 1);
+  }
+
+  static size_t getExtraAllocationSize(const Metadata *type, size_t numFields,
+                                       const char *fieldNames,
+                                       const uintptr_t *offsets,
+                                       const FieldType *fieldTypes) {
+    return numFields * sizeof(FieldInfo);
+  }
+
+  size_t getNumFields() const { return NumFields; }
+
+  const FieldInfo &getField(size_t i) const {
+    assert(i < NumFields);
+    return reinterpret_cast<const FieldInfo *>(this + 1)[i];
+  }
+};
+
+static Lazy<ConcurrentMap<FieldTableCacheEntry>> FieldTables;
+
+static const FieldTableCacheEntry &
+getStructFieldTable(const StructMetadata *Struct) {
+  auto &cache = FieldTables.get();
+  if (auto entry = cache.find(Struct))
+    return *entry;
+
+  const auto &Description = Struct->Description->Struct;
+  return *cache.getOrInsert(static_cast<const Metadata *>(Struct),
+                            size_t(Description.NumFields),
+                            Description.FieldNames.get(),
+                            Struct->getFieldOffsets(),
+                            Struct->getFieldTypes()).first;
+}
+
+static const FieldTableCacheEntry &
+getClassFieldTable(const ClassMetadata *Clas) {
+  auto &cache = FieldTables.get();
+  if (auto entry = cache.find(Clas))
+    return *entry;
+
+  const auto &Description = Clas->getDescription()->Class;
+  size_t numFields = Description.NumFields;
+
+  // FIXME: If the class has ObjC heritage, get the field offsets using the
+  // ObjC metadata, because we don't update the field offsets in the face of
+  // resilient base classes.
+  std::vector<uintptr_t> offsets;
+  if (usesNativeSwiftReferenceCounting(Clas)) {
+    auto fieldOffsets = Clas->getFieldOffsets();
+    offsets.assign(fieldOffsets, fieldOffsets + numFields);
+  } else {
+#if SWIFT_OBJC_INTEROP
+    Ivar *ivars = class_copyIvarList((Class)Clas, nullptr);
+    for (size_t i = 0; i != numFields; ++i)
+      offsets.push_back(ivar_getOffset(ivars[i]));
+    free(ivars);
+#else
+    swift::crash("Object appears to be Objective-C, but no runtime.");
+#endif
+  }
+
+  return *cache.getOrInsert(static_cast<const Metadata *>(Clas), numFields,
+                            Description.FieldNames.get(), offsets.data(),
+                            Clas->getFieldTypes()).first;
+}
+
 // -- Struct destructuring.
   
 SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
@@ -484,17 +593,16 @@ void swift_StructMirror_subscript(String *outString,
                                   const Metadata *type) {
   auto Struct = static_cast<const StructMetadata *>(type);
   
-  if (i < 0 || (size_t)i > Struct->Description->Struct.NumFields)
+  if (i < 0 || (size_t)i >= Struct->Description->Struct.NumFields)
     swift::crash("Swift mirror subscript bounds check failure");
   
-  // Load the type and offset from their respective vectors.
-  auto fieldType = Struct->getFieldTypes()[i];
-  auto fieldOffset = Struct->getFieldOffsets()[i];
+  const FieldInfo &field = getStructFieldTable(Struct).getField(i);
+  auto fieldType = field.Type;
   
   auto bytes = reinterpret_cast<const char*>(value);
-  auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
+  auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + field.Offset);
 
-  new (outString) String(getFieldName(Struct->Description->Struct.FieldNames, i));
+  new (outString) String(field.Name);
 
   // 'owner' is consumed by this call.
   assert(!fieldType.isIndirect() && "indirect struct fields not implemented");
@@ -700,34 +808,18 @@ void swift_ClassMirror_subscript(String *outString,
     --i;
   }
   
-  if (i < 0 || (size_t)i > Clas->getDescription()->Class.NumFields)
+  if (i < 0 || (size_t)i >= Clas->getDescription()->Class.NumFields)
     swift::crash("Swift mirror subscript bounds check failure");
   
-  // Load the type and offset from their respective vectors.
-  auto fieldType = Clas->getFieldTypes()[i];
+  const FieldInfo &field = getClassFieldTable(Clas).getField(i);
+  auto fieldType = field.Type;
   assert(!fieldType.isIndirect()
          && "class indirect properties not implemented");
   
-  // FIXME: If the class has ObjC heritage, get the field offset using the ObjC
-  // metadata, because we don't update the field offsets in the face of
-  // resilient base classes.
-  uintptr_t fieldOffset;
-  if (usesNativeSwiftReferenceCounting(Clas)) {
-    fieldOffset = Clas->getFieldOffsets()[i];
-  } else {
-#if SWIFT_OBJC_INTEROP
-    Ivar *ivars = class_copyIvarList((Class)Clas, nullptr);
-    fieldOffset = ivar_getOffset(ivars[i]);
-    free(ivars);
-#else
-    swift::crash("Object appears to be Objective-C, but no runtime.");
-#endif
-  }
-  
   auto bytes = *reinterpret_cast<const char * const*>(value);
-  auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
+  auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + field.Offset);
   
-  new (outString) String(getFieldName(Clas->getDescription()->Class.FieldNames, i));
+  new (outString) String(field.Name);
   // 'owner' is consumed by this call.
   new (outMirror) Mirror(reflect(owner, fieldData, fieldType.getType()));
 }
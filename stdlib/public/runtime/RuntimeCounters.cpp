@@ -0,0 +1,146 @@
+//===--- RuntimeCounters.cpp - Runtime performance counters ---------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Per-thread counters of calls into the runtime. See RuntimeCounters.h for
+// the layout which out-of-process readers rely on.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/RuntimeCounters.h"
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+using namespace swift;
+
+static const char *const RuntimeCounterNames[] = {
+#define RUNTIME_COUNTER(Name) #Name,
+#include "swift/Runtime/RuntimeCounters.def"
+};
+
+const char *swift::swift_getRuntimeCounterName(size_t index) {
+  if (index >= NumRuntimeCounters)
+    return nullptr;
+  return RuntimeCounterNames[index];
+}
+
+#if SWIFT_RUNTIME_ENABLE_COUNTERS
+
+namespace {
+
+/// The counters of one thread.
+struct RuntimeCounterBlock {
+  /// Only the owning thread writes the counts, so they are incremented with
+  /// a relaxed load and store instead of a read-modify-write.
+  std::atomic<uint64_t> Counts[NumRuntimeCounters];
+
+  /// The next block in the list. Set before the block is published and never
+  /// changed afterwards.
+  RuntimeCounterBlock *Next;
+
+  /// Set while a thread is counting into this block.
+  std::atomic<bool> InUse;
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) &&
+              offsetof(RuntimeCounterBlock, Next) ==
+                sizeof(uint64_t) * NumRuntimeCounters,
+              "counter block layout is read by out-of-process tools");
+
+/// Counts of threads which keep calling into the runtime after their block
+/// was given up at thread exit. These counts are lost.
+RuntimeCounterBlock DiscardedCounts;
+
+thread_local RuntimeCounterBlock *CurrentBlock = nullptr;
+
+/// Gives up the thread's block when the thread exits, so that the next new
+/// thread can continue counting into it.
+struct RuntimeCounterBlockReaper {
+  ~RuntimeCounterBlockReaper() {
+    if (CurrentBlock && CurrentBlock != &DiscardedCounts)
+      CurrentBlock->InUse.store(false, std::memory_order_release);
+    CurrentBlock = &DiscardedCounts;
+  }
+};
+
+thread_local RuntimeCounterBlockReaper CurrentBlockReaper;
+
+} // end anonymous namespace
+
+SWIFT_RUNTIME_EXPORT
+extern "C" const uint32_t _swift_runtimeCounterCount = NumRuntimeCounters;
+
+SWIFT_RUNTIME_EXPORT
+extern "C" std::atomic<RuntimeCounterBlock *> _swift_runtimeCounterBlocks;
+std::atomic<RuntimeCounterBlock *> _swift_runtimeCounterBlocks(nullptr);
+
+/// Find a block for the current thread, reusing the block of an exited
+/// thread if there is one.
+LLVM_ATTRIBUTE_NOINLINE
+static RuntimeCounterBlock *claimRuntimeCounterBlock() {
+  // Make sure the block is given up when the thread exits.
+  (void)&CurrentBlockReaper;
+
+  auto head = _swift_runtimeCounterBlocks.load(std::memory_order_acquire);
+  for (auto block = head; block; block = block->Next) {
+    bool inUse = false;
+    if (!block->InUse.load(std::memory_order_relaxed) &&
+        block->InUse.compare_exchange_strong(inUse, true,
+                                             std::memory_order_acquire)) {
+      CurrentBlock = block;
+      return block;
+    }
+  }
+
+  auto block = new RuntimeCounterBlock();
+  for (auto &count : block->Counts)
+    count.store(0, std::memory_order_relaxed);
+  block->InUse.store(true, std::memory_order_relaxed);
+  block->Next = head;
+  while (!_swift_runtimeCounterBlocks.compare_exchange_weak(
+             block->Next, block, std::memory_order_release,
+             std::memory_order_relaxed)) {
+  }
+  CurrentBlock = block;
+  return block;
+}
+
+void swift::_swift_incrementRuntimeCounter(RuntimeCounter counter) {
+  auto block = CurrentBlock;
+  if (LLVM_UNLIKELY(!block))
+    block = claimRuntimeCounterBlock();
+  auto &count = block->Counts[unsigned(counter)];
+  count.store(count.load(std::memory_order_relaxed) + 1,
+              std::memory_order_relaxed);
+}
+
+size_t swift::swift_getRuntimeCounters(uint64_t *counts, size_t maxCount) {
+  size_t n = maxCount < NumRuntimeCounters ? maxCount : NumRuntimeCounters;
+  memset(counts, 0, n * sizeof(uint64_t));
+  for (auto block = _swift_runtimeCounterBlocks.load(std::memory_order_acquire);
+       block; block = block->Next) {
+    for (size_t i = 0; i < n; ++i)
+      counts[i] += block->Counts[i].load(std::memory_order_relaxed);
+  }
+  return NumRuntimeCounters;
+}
+
+#else
+
+size_t swift::swift_getRuntimeCounters(uint64_t *counts, size_t maxCount) {
+  size_t n = maxCount < NumRuntimeCounters ? maxCount : NumRuntimeCounters;
+  memset(counts, 0, n * sizeof(uint64_t));
+  return NumRuntimeCounters;
+}
+
+#endif
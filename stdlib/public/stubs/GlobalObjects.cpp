@@ -30,6 +30,7 @@ swift::_SwiftEmptyArrayStorage swift::_swiftEmptyArrayStorage = {
   // HeapObject header;
   {
     &_TMCs18_EmptyArrayStorage, // isa pointer
+    StrongRefCount::Immortal    // every empty array shares it
   },
   
   // _SwiftArrayBodyStorage body;
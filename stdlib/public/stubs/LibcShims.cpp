@@ -37,6 +37,10 @@ __swift_size_t swift::_swift_stdlib_fwrite_stdout(const void *ptr,
   return fwrite(ptr, size, nitems, stdout);
 }
 
+int swift::_swift_stdlib_fflush_stdout() {
+  return fflush(stdout);
+}
+
 __swift_size_t swift::_swift_stdlib_strlen(const char *s) {
   return strlen(s);
 }
@@ -56,7 +56,12 @@ static long double swift_strtold_l(const char *nptr,
 #else
 #include <xlocale.h>
 #endif
+#include <algorithm>
+#include <atomic>
 #include <limits>
+#include <random>
+#include <thread>
+#include <vector>
 #include "llvm/ADT/StringExtras.h"
 #include "swift/Runtime/Debug.h"
 #include "swift/Basic/Lazy.h"
@@ -64,31 +69,63 @@ static long double swift_strtold_l(const char *nptr,
 #include "../SwiftShims/RuntimeShims.h"
 #include "../SwiftShims/RuntimeStubs.h"
 
+/// The decimal digits of 00 to 99.
+static const char TwoDecimalDigits[] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
 static uint64_t uint64ToStringImpl(char *Buffer, uint64_t Value,
                                    int64_t Radix, bool Uppercase,
                                    bool Negative) {
-  char *P = Buffer;
+  // Digits are produced from the least significant one, so fill a scratch
+  // buffer from its end. 64 binary digits and a sign are the longest result.
+  char Scratch[65];
+  char *End = Scratch + sizeof(Scratch);
+  char *P = End;
   uint64_t Y = Value;
 
-  if (Y == 0) {
-    *P++ = '0';
-  } else if (Radix == 10) {
-    while (Y) {
-      *P++ = '0' + char(Y % 10);
-      Y /= 10;
+  if (Radix == 10) {
+    // Two digits per division.
+    while (Y >= 100) {
+      unsigned TwoDigits = unsigned(Y % 100) * 2;
+      Y /= 100;
+      P -= 2;
+      memcpy(P, TwoDecimalDigits + TwoDigits, 2);
+    }
+    if (Y >= 10) {
+      P -= 2;
+      memcpy(P, TwoDecimalDigits + Y * 2, 2);
+    } else {
+      *--P = '0' + char(Y);
     }
+  } else if (Radix == 16) {
+    // Two digits per byte.
+    const char *HexDigits =
+        Uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+    while (Y >= 16) {
+      P -= 2;
+      P[0] = HexDigits[(Y >> 4) & 0xF];
+      P[1] = HexDigits[Y & 0xF];
+      Y >>= 8;
+    }
+    if (Y != 0 || P == End)
+      *--P = HexDigits[Y];
   } else {
     unsigned Radix32 = Radix;
-    while (Y) {
-      *P++ = llvm::hexdigit(Y % Radix32, !Uppercase);
+    do {
+      *--P = llvm::hexdigit(Y % Radix32, !Uppercase);
       Y /= Radix32;
-    }
+    } while (Y);
   }
 
   if (Negative)
-    *P++ = '-';
-  std::reverse(Buffer, P);
-  return size_t(P - Buffer);
+    *--P = '-';
+  size_t Length = End - P;
+  memcpy(Buffer, P, Length);
+  return Length;
 }
 
 SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
@@ -174,6 +211,189 @@ static int swift_snprintf_l(char *Str, size_t StrSize, locale_t Locale,
 }
 #endif
 
+#if defined(__SIZEOF_INT128__)
+/// Returns 10^\p N for \p N <= 38.
+static unsigned __int128 powerOf10(int N) {
+  static const uint64_t Powers[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL
+  };
+  if (N <= 19)
+    return Powers[N];
+  return (unsigned __int128)Powers[19] * Powers[N - 19];
+}
+
+/// Formats \p Value like "%.*g" with precision \p Precision in the C locale,
+/// without going through printf.
+///
+/// The digits are computed exactly with 128-bit arithmetic, so the result is
+/// the same as printf's. Returns the length of the result, or -1 if \p Value
+/// is infinite, a NaN or too large or small for 128-bit arithmetic; the
+/// caller has to fall back to printf then.
+static int formatDoubleLikePrintf(char *Buffer, double Value, int Precision) {
+  typedef unsigned __int128 uint128;
+
+  if (Precision < 1 || Precision > 17)
+    return -1;
+
+  uint64_t Bits;
+  memcpy(&Bits, &Value, sizeof(Bits));
+  int BiasedExponent = (Bits >> 52) & 0x7FF;
+  uint64_t Mantissa = Bits & ((1ULL << 52) - 1);
+  if (BiasedExponent == 0x7FF)
+    return -1;
+
+  char *P = Buffer;
+  if (Bits >> 63)
+    *P++ = '-';
+  if (BiasedExponent == 0 && Mantissa == 0) {
+    *P++ = '0';
+    *P = '\0';
+    return P - Buffer;
+  }
+
+  // Value == Mantissa * 2^Exponent2.
+  int Exponent2 = -1074;
+  if (BiasedExponent != 0) {
+    Mantissa |= 1ULL << 52;
+    Exponent2 = BiasedExponent - 1075;
+  }
+
+  // Estimate the decimal exponent from the binary one. The estimate is at
+  // most one too small, which is corrected below.
+  int TopBit = Exponent2 + 63 - __builtin_clzll(Mantissa);
+  int Exponent10 = (TopBit * 78913) >> 18;
+
+  // Compute Value / 10^(Exponent10 - Precision + 1) as a quotient and a
+  // remainder of a division by Divisor, and round it to nearest, ties to
+  // even, like printf does.
+  uint64_t Digits = 0;
+  for (int Attempt = 0; ; ++Attempt) {
+    if (Attempt == 3)
+      return -1;
+    int Scale = Exponent10 - Precision + 1;
+    uint128 Quotient, Remainder, Divisor;
+    if (Scale <= 0) {
+      if (-Scale > 22)
+        return -1;
+      uint128 N = Mantissa * powerOf10(-Scale);
+      if (Exponent2 >= 0) {
+        if (Exponent2 > 127 || (N >> (127 - Exponent2)) != 0)
+          return -1;
+        Quotient = N << Exponent2;
+        Remainder = 0;
+        Divisor = 1;
+      } else {
+        if (-Exponent2 > 127)
+          return -1;
+        Divisor = uint128(1) << -Exponent2;
+        Quotient = N >> -Exponent2;
+        Remainder = N & (Divisor - 1);
+      }
+    } else {
+      if (Scale > 38)
+        return -1;
+      Divisor = powerOf10(Scale);
+      uint128 N = Mantissa;
+      if (Exponent2 >= 0) {
+        if (Exponent2 > 74)
+          return -1;
+        N <<= Exponent2;
+      } else {
+        if (-Exponent2 > 127 || (Divisor >> (127 + Exponent2)) != 0)
+          return -1;
+        Divisor <<= -Exponent2;
+      }
+      Quotient = N / Divisor;
+      Remainder = N % Divisor;
+    }
+
+    if (Quotient >= powerOf10(Precision)) {
+      ++Exponent10;
+      continue;
+    }
+    if (Quotient < powerOf10(Precision - 1)) {
+      --Exponent10;
+      continue;
+    }
+    uint128 TwiceRemainder = Remainder << 1;
+    if (TwiceRemainder > Divisor ||
+        (TwiceRemainder == Divisor && (Quotient & 1)))
+      ++Quotient;
+    if (Quotient == powerOf10(Precision)) {
+      Quotient = powerOf10(Precision - 1);
+      ++Exponent10;
+    }
+    Digits = uint64_t(Quotient);
+    break;
+  }
+
+  char DigitChars[17];
+  for (int i = Precision - 1; i >= 0; --i) {
+    DigitChars[i] = '0' + Digits % 10;
+    Digits /= 10;
+  }
+  // %g drops trailing zeros.
+  int NumDigits = Precision;
+  while (NumDigits > 1 && DigitChars[NumDigits - 1] == '0')
+    --NumDigits;
+
+  if (Exponent10 < -4 || Exponent10 >= Precision) {
+    // Scientific notation: d.ddde+XX
+    *P++ = DigitChars[0];
+    if (NumDigits > 1) {
+      *P++ = '.';
+      memcpy(P, DigitChars + 1, NumDigits - 1);
+      P += NumDigits - 1;
+    }
+    *P++ = 'e';
+    *P++ = Exponent10 < 0 ? '-' : '+';
+    unsigned AbsExponent = Exponent10 < 0 ? -Exponent10 : Exponent10;
+    if (AbsExponent >= 100)
+      *P++ = '0' + AbsExponent / 100;
+    *P++ = '0' + AbsExponent / 10 % 10;
+    *P++ = '0' + AbsExponent % 10;
+  } else if (Exponent10 >= 0) {
+    for (int i = 0; i <= Exponent10; ++i)
+      *P++ = i < NumDigits ? DigitChars[i] : '0';
+    if (NumDigits > Exponent10 + 1) {
+      *P++ = '.';
+      memcpy(P, DigitChars + Exponent10 + 1, NumDigits - Exponent10 - 1);
+      P += NumDigits - Exponent10 - 1;
+    }
+  } else {
+    *P++ = '0';
+    *P++ = '.';
+    for (int i = -1; i > Exponent10; --i)
+      *P++ = '0';
+    memcpy(P, DigitChars, NumDigits);
+    P += NumDigits;
+  }
+  *P = '\0';
+  return P - Buffer;
+}
+#else
+static int formatDoubleLikePrintf(char *Buffer, double Value, int Precision) {
+  return -1;
+}
+#endif
+
+static int formatLikePrintf(char *Buffer, float Value, int Precision) {
+  return formatDoubleLikePrintf(Buffer, Value, Precision);
+}
+
+static int formatLikePrintf(char *Buffer, double Value, int Precision) {
+  return formatDoubleLikePrintf(Buffer, Value, Precision);
+}
+
+static int formatLikePrintf(char *Buffer, long double Value, int Precision) {
+  return -1;
+}
+
 template <typename T>
 static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
                                             T Value, const char *Format, 
@@ -185,35 +405,40 @@ static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
   if (Debug) {
     Precision = std::numeric_limits<T>::max_digits10;
   }
-  
-#if defined(__CYGWIN__)
-  // Cygwin does not support uselocale(), but we can use the locale feature 
-  // in stringstream object.
-  std::ostringstream ValueStream;
-  ValueStream.width(0);
-  ValueStream.precision(Precision);
-  ValueStream.imbue(std::locale::classic());
-  ValueStream << Value;
-  std::string ValueString(ValueStream.str());
-  size_t i = ValueString.length();
 
-  if (i < BufferLength) {
-    std::copy(ValueString.begin(), ValueString.end(), Buffer);
-    Buffer[i] = '\0';
-  } else {
-    swift::crash("swift_floatingPointToString: insufficient buffer size");
-  }
+  // Most values are formatted without printf, which is slow and depends on
+  // the locale.
+  int i = formatLikePrintf(Buffer, Value, Precision);
+  if (i < 0) {
+#if defined(__CYGWIN__)
+    // Cygwin does not support uselocale(), but we can use the locale feature
+    // in stringstream object.
+    std::ostringstream ValueStream;
+    ValueStream.width(0);
+    ValueStream.precision(Precision);
+    ValueStream.imbue(std::locale::classic());
+    ValueStream << Value;
+    std::string ValueString(ValueStream.str());
+    i = ValueString.length();
+
+    if (size_t(i) < BufferLength) {
+      std::copy(ValueString.begin(), ValueString.end(), Buffer);
+      Buffer[i] = '\0';
+    } else {
+      swift::crash("swift_floatingPointToString: insufficient buffer size");
+    }
 #else
-  // Pass a null locale to use the C locale.
-  int i = swift_snprintf_l(Buffer, BufferLength, /*locale=*/nullptr, Format,
-                           Precision, Value);
-
-  if (i < 0)
-    swift::crash(
-        "swift_floatingPointToString: unexpected return value from sprintf");
-  if (size_t(i) >= BufferLength)
-    swift::crash("swift_floatingPointToString: insufficient buffer size");
+    // Pass a null locale to use the C locale.
+    i = swift_snprintf_l(Buffer, BufferLength, /*locale=*/nullptr, Format,
+                         Precision, Value);
+
+    if (i < 0)
+      swift::crash(
+          "swift_floatingPointToString: unexpected return value from sprintf");
+    if (size_t(i) >= BufferLength)
+      swift::crash("swift_floatingPointToString: insufficient buffer size");
 #endif
+  }
 
   // Add ".0" to a float that (a) is not in scientific notation, (b) does not
   // already have a fractional part, (c) is not infinite, and (d) is not a NaN
@@ -258,6 +483,73 @@ ssize_t swift::swift_stdlib_readLine_stdin(char **LinePtr) {
   return getline(LinePtr, &Capacity, stdin);
 }
 
+_SwiftHashingSeed swift::_swift_stdlib_Hashing_makeSeed() {
+  if (getenv("SWIFT_DETERMINISTIC_HASHING"))
+    return {0xff51afd7ed558ccdULL, 0xc4ceb9fe1a85ec53ULL};
+
+  _SwiftHashingSeed Seed;
+#if defined(__APPLE__) || defined(__FreeBSD__)
+  arc4random_buf(&Seed, sizeof(Seed));
+#else
+  std::random_device Device;
+  Seed.k0 = (uint64_t(Device()) << 32) | Device();
+  Seed.k1 = (uint64_t(Device()) << 32) | Device();
+#endif
+  return Seed;
+}
+
+static inline uint64_t rotateLeft(uint64_t X, unsigned Amount) {
+  return (X << Amount) | (X >> (64 - Amount));
+}
+
+/// Mixes the message word \p M into the SipHash-1-3 state \p S.  Must match
+/// `_Hasher._compress` in Hasher.swift.
+static inline void sipCompress(_SwiftHasherState &S, uint64_t M) {
+  S.v3 ^= M;
+  S.v0 += S.v1; S.v1 = rotateLeft(S.v1, 13); S.v1 ^= S.v0;
+  S.v0 = rotateLeft(S.v0, 32);
+  S.v2 += S.v3; S.v3 = rotateLeft(S.v3, 16); S.v3 ^= S.v2;
+  S.v0 += S.v3; S.v3 = rotateLeft(S.v3, 21); S.v3 ^= S.v0;
+  S.v2 += S.v1; S.v1 = rotateLeft(S.v1, 17); S.v1 ^= S.v2;
+  S.v2 = rotateLeft(S.v2, 32);
+  S.v0 ^= M;
+}
+
+void swift::_swift_stdlib_Hasher_appendBytes(_SwiftHasherState *State,
+                                             const void *Bytes,
+                                             intptr_t Count) {
+  auto Ptr = static_cast<const uint8_t *>(Bytes);
+  auto End = Ptr + Count;
+  _SwiftHasherState S = *State;
+  unsigned TailBytes = S.byteCount & 7;
+  S.byteCount += Count;
+
+  // Complete the word in the tail first.
+  while (TailBytes != 0 && Ptr != End) {
+    S.tail |= uint64_t(*Ptr++) << (TailBytes * 8);
+    if (++TailBytes == 8) {
+      sipCompress(S, S.tail);
+      S.tail = 0;
+      TailBytes = 0;
+    }
+  }
+
+  // The message words are little-endian.
+  while (End - Ptr >= 8) {
+    uint64_t Word;
+    memcpy(&Word, Ptr, sizeof(Word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    Word = __builtin_bswap64(Word);
+#endif
+    sipCompress(S, Word);
+    Ptr += 8;
+  }
+
+  while (Ptr != End)
+    S.tail |= uint64_t(*Ptr++) << (TailBytes++ * 8);
+  *State = S;
+}
+
 SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
 extern "C" float _swift_fmodf(float lhs, float rhs) {
     return fmodf(lhs, rhs);
@@ -467,3 +759,24 @@ int swift::_swift_stdlib_putc_stderr(int C) {
 size_t swift::_swift_stdlib_getHardwareConcurrency() {
   return sysconf(_SC_NPROCESSORS_ONLN);
 }
+
+void swift::_swift_stdlib_parallelFor(
+    intptr_t Count, void *Context, void (*Body)(void *Context, intptr_t I)) {
+  intptr_t ThreadCount = std::min<intptr_t>(
+      Count, _swift_stdlib_getHardwareConcurrency());
+
+  // The workers, including the calling thread, take the next index until
+  // there are none left, so that uneven work balances out.
+  std::atomic<intptr_t> NextIndex(0);
+  auto Work = [&] {
+    for (intptr_t I = NextIndex++; I < Count; I = NextIndex++)
+      Body(Context, I);
+  };
+
+  std::vector<std::thread> Workers;
+  for (intptr_t T = 1; T < ThreadCount; ++T)
+    Workers.emplace_back(Work);
+  Work();
+  for (auto &Worker : Workers)
+    Worker.join();
+}
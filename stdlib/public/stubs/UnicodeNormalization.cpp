@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <mutex>
 #include <assert.h>
+#include <string.h>
 
 #include <unicode/ustring.h>
 #include <unicode/ucol.h>
@@ -124,6 +125,58 @@ private:
   ASCIICollation(const ASCIICollation &) = delete;
 };
 
+/// Returns true if all of the \p Length characters at \p Str are ASCII.
+/// Checks eight bytes at a time.
+template <typename CharT>
+static bool isASCII(const CharT *Str, int32_t Length) {
+  const uint64_t NonASCIIBits =
+      sizeof(CharT) == 1 ? 0x8080808080808080ULL : 0xFF80FF80FF80FF80ULL;
+  const int32_t CharsPerWord = sizeof(uint64_t) / sizeof(CharT);
+  int32_t Pos = 0;
+  for (; Pos + CharsPerWord <= Length; Pos += CharsPerWord) {
+    uint64_t Word;
+    memcpy(&Word, Str + Pos, sizeof(Word));
+    if (Word & NonASCIIBits)
+      return false;
+  }
+  for (; Pos < Length; ++Pos)
+    if (uint16_t(Str[Pos]) >= 0x80)
+      return false;
+  return true;
+}
+
+/// Compares two ASCII strings like ucol_strcoll does, but with the cached
+/// collation elements of the ASCII characters.
+///
+/// Every ASCII character has exactly one collation element and there are no
+/// contractions among ASCII characters, so the Unicode Collation Algorithm
+/// reduces to comparing the non-zero primary, then secondary, then tertiary
+/// weights of the characters in order.
+template <typename LeftCharT, typename RightCharT>
+static int32_t compareASCII(const LeftCharT *LeftString, int32_t LeftLength,
+                            const RightCharT *RightString,
+                            int32_t RightLength) {
+  const ASCIICollation *Table = ASCIICollation::getTable();
+  for (unsigned Shift : {16, 8, 0}) {
+    uint32_t Mask = Shift == 16 ? 0xFFFF : 0xFF;
+    int32_t LeftPos = 0, RightPos = 0;
+    while (true) {
+      uint32_t LeftWeight = 0, RightWeight = 0;
+      while (LeftWeight == 0 && LeftPos < LeftLength)
+        LeftWeight = (uint32_t(Table->map(LeftString[LeftPos++])) >> Shift) &
+                     Mask;
+      while (RightWeight == 0 && RightPos < RightLength)
+        RightWeight =
+            (uint32_t(Table->map(RightString[RightPos++])) >> Shift) & Mask;
+      if (LeftWeight != RightWeight)
+        return LeftWeight < RightWeight ? -1 : 1;
+      if (LeftWeight == 0)
+        break;
+    }
+  }
+  return 0;
+}
+
 /// Compares the strings via the Unicode Collation Algorithm on the root locale.
 /// Results are the usual string comparison results:
 ///  <0 the left string is less than the right string.
@@ -134,6 +187,12 @@ swift::_swift_stdlib_unicode_compare_utf16_utf16(const uint16_t *LeftString,
                                                  int32_t LeftLength,
                                                  const uint16_t *RightString,
                                                  int32_t RightLength) {
+  if (LeftLength == RightLength &&
+      memcmp(LeftString, RightString, LeftLength * sizeof(uint16_t)) == 0)
+    return 0;
+  if (isASCII(LeftString, LeftLength) && isASCII(RightString, RightLength))
+    return compareASCII(LeftString, LeftLength, RightString, RightLength);
+
 #if defined(__CYGWIN__) || defined(_MSC_VER)
   // ICU UChar type is platform dependent. In Cygwin, it is defined
   // as wchar_t which size is 2. It seems that the underlying binary
@@ -158,6 +217,9 @@ swift::_swift_stdlib_unicode_compare_utf8_utf16(const char *LeftString,
                                                 int32_t LeftLength,
                                                 const uint16_t *RightString,
                                                 int32_t RightLength) {
+  if (isASCII(LeftString, LeftLength) && isASCII(RightString, RightLength))
+    return compareASCII(LeftString, LeftLength, RightString, RightLength);
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -188,6 +250,12 @@ swift::_swift_stdlib_unicode_compare_utf8_utf8(const char *LeftString,
                                                int32_t LeftLength,
                                                const char *RightString,
                                                int32_t RightLength) {
+  if (LeftLength == RightLength &&
+      memcmp(LeftString, RightString, LeftLength) == 0)
+    return 0;
+  if (isASCII(LeftString, LeftLength) && isASCII(RightString, RightLength))
+    return compareASCII(LeftString, LeftLength, RightString, RightLength);
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -255,26 +323,16 @@ static intptr_t hashFinish(intptr_t HashState) {
   return HashState;
 }
 
-intptr_t
-swift::_swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
-  UErrorCode ErrorCode = U_ZERO_ERROR;
-  intptr_t HashState = HASH_SEED;
-  HashState = hashChunk(GetRootCollator(), HashState, Str, Length, &ErrorCode);
-
-  if (U_FAILURE(ErrorCode)) {
-    swift::crash("hashChunk: Unexpected error hashing unicode string.");
-  }
-  return hashFinish(HashState);
-}
-
-intptr_t swift::_swift_stdlib_unicode_hash_ascii(const char *Str,
-                                                 int32_t Length) {
+/// Hashes an ASCII string like hashChunk does, but with the cached collation
+/// elements of the ASCII characters.
+template <typename CharT>
+static intptr_t hashASCII(const CharT *Str, int32_t Length) {
   const ASCIICollation *Table = ASCIICollation::getTable();
   intptr_t HashState = HASH_SEED;
   int32_t Pos = 0;
   while (Pos < Length) {
-    const char c = Str[Pos++];
-    assert((c & 0x80) == 0 && "This table only exists for the ASCII subset");
+    const CharT c = Str[Pos++];
+    assert(uint16_t(c) < 0x80 && "This table only exists for the ASCII subset");
     intptr_t Elem = Table->map(c);
     // Ignore zero valued collation elements. They don't participate in the
     // ordering relation.
@@ -290,6 +348,28 @@ intptr_t swift::_swift_stdlib_unicode_hash_ascii(const char *Str,
   return hashFinish(HashState);
 }
 
+intptr_t
+swift::_swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
+  // UTF-16 strings often only contain ASCII characters, e.g. after removing
+  // the non-ASCII ones.
+  if (isASCII(Str, Length))
+    return hashASCII(Str, Length);
+
+  UErrorCode ErrorCode = U_ZERO_ERROR;
+  intptr_t HashState = HASH_SEED;
+  HashState = hashChunk(GetRootCollator(), HashState, Str, Length, &ErrorCode);
+
+  if (U_FAILURE(ErrorCode)) {
+    swift::crash("hashChunk: Unexpected error hashing unicode string.");
+  }
+  return hashFinish(HashState);
+}
+
+intptr_t swift::_swift_stdlib_unicode_hash_ascii(const char *Str,
+                                                 int32_t Length) {
+  return hashASCII(Str, Length);
+}
+
 /// Convert the unicode string to uppercase. This function will return the
 /// required buffer length as a result. If this length does not match the
 /// 'DestinationCapacity' this function must be called again with a buffer of
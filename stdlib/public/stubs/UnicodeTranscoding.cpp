@@ -0,0 +1,179 @@
+//===--- UnicodeTranscoding.cpp - UTF-8 validation and transcoding --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Bulk validation and transcoding of UTF-8 for the construction of strings.
+// Runs of ASCII, which are by far the most common input, are processed a
+// vector at a time; everything else is decoded one scalar at a time.
+//
+// Validation is exactly as strict as the UTF8 codec in the standard library:
+// overlong encodings, surrogates and scalars above U+10FFFF are ill-formed.
+// The callers fall back to the codec for ill-formed input, which is what
+// implements the repair of ill-formed sequences.
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "../SwiftShims/UnicodeShims.h"
+
+/// Returns the number of ASCII bytes at the start of [Src, End), looking at
+/// whole vectors or words only. The caller handles the remaining bytes.
+static intptr_t countASCIIBlocks(const uint8_t *Src, const uint8_t *End) {
+  const uint8_t *Ptr = Src;
+#if defined(__SSE2__)
+  while (End - Ptr >= 16) {
+    __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+    if (int Mask = _mm_movemask_epi8(Chunk))
+      return Ptr - Src + __builtin_ctz(Mask);
+    Ptr += 16;
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  while (End - Ptr >= 16) {
+    if (vmaxvq_u8(vld1q_u8(Ptr)) & 0x80)
+      break;
+    Ptr += 16;
+  }
+#endif
+  while (End - Ptr >= 8) {
+    uint64_t Word;
+    memcpy(&Word, Ptr, sizeof(Word));
+    if (Word & 0x8080808080808080ULL)
+      break;
+    Ptr += 8;
+  }
+  return Ptr - Src;
+}
+
+/// Decodes the non-ASCII scalar starting at \p Ptr, which must be before
+/// \p End. On success, advances \p Ptr past the scalar and returns it.
+/// Returns -1 if the sequence is ill-formed.
+static int32_t decodeMultiByteScalar(const uint8_t *&Ptr, const uint8_t *End) {
+  uint8_t Lead = Ptr[0];
+  intptr_t Available = End - Ptr;
+  auto isContinuation = [](uint8_t Byte) { return (Byte & 0xC0) == 0x80; };
+
+  if (Lead >= 0xC2 && Lead <= 0xDF) {
+    if (Available < 2 || !isContinuation(Ptr[1]))
+      return -1;
+    int32_t Scalar = ((Lead & 0x1F) << 6) | (Ptr[1] & 0x3F);
+    Ptr += 2;
+    return Scalar;
+  }
+
+  if (Lead >= 0xE0 && Lead <= 0xEF) {
+    if (Available < 3 || !isContinuation(Ptr[1]) || !isContinuation(Ptr[2]))
+      return -1;
+    // Reject overlong encodings and surrogates.
+    if ((Lead == 0xE0 && Ptr[1] < 0xA0) || (Lead == 0xED && Ptr[1] > 0x9F))
+      return -1;
+    int32_t Scalar =
+        ((Lead & 0x0F) << 12) | ((Ptr[1] & 0x3F) << 6) | (Ptr[2] & 0x3F);
+    Ptr += 3;
+    return Scalar;
+  }
+
+  if (Lead >= 0xF0 && Lead <= 0xF4) {
+    if (Available < 4 || !isContinuation(Ptr[1]) ||
+        !isContinuation(Ptr[2]) || !isContinuation(Ptr[3]))
+      return -1;
+    // Reject overlong encodings and scalars above U+10FFFF.
+    if ((Lead == 0xF0 && Ptr[1] < 0x90) || (Lead == 0xF4 && Ptr[1] > 0x8F))
+      return -1;
+    int32_t Scalar = ((Lead & 0x07) << 18) | ((Ptr[1] & 0x3F) << 12) |
+                     ((Ptr[2] & 0x3F) << 6) | (Ptr[3] & 0x3F);
+    Ptr += 4;
+    return Scalar;
+  }
+
+  // Continuation bytes, overlong two-byte leads and leads above F4.
+  return -1;
+}
+
+__swift_intptr_t
+swift::_swift_stdlib_utf8_validated_utf16_length(const __swift_uint8_t *Src,
+                                                 __swift_intptr_t Length) {
+  const uint8_t *Ptr = Src;
+  const uint8_t *End = Src + Length;
+  intptr_t UTF16Length = 0;
+  while (Ptr != End) {
+    intptr_t ASCIICount = countASCIIBlocks(Ptr, End);
+    Ptr += ASCIICount;
+    UTF16Length += ASCIICount;
+    if (Ptr == End)
+      break;
+    if (*Ptr < 0x80) {
+      ++Ptr;
+      ++UTF16Length;
+      continue;
+    }
+    int32_t Scalar = decodeMultiByteScalar(Ptr, End);
+    if (Scalar < 0)
+      return -1;
+    UTF16Length += Scalar > 0xFFFF ? 2 : 1;
+  }
+  return UTF16Length;
+}
+
+void swift::_swift_stdlib_utf8_to_utf16(const __swift_uint8_t *Src,
+                                        __swift_intptr_t Length,
+                                        __swift_uint16_t *Dest) {
+  const uint8_t *Ptr = Src;
+  const uint8_t *End = Src + Length;
+  while (Ptr != End) {
+#if defined(__SSE2__)
+    // Widen whole vectors of ASCII by interleaving them with zeros.
+    const __m128i Zero = _mm_setzero_si128();
+    while (End - Ptr >= 16) {
+      __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+      if (_mm_movemask_epi8(Chunk))
+        break;
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(Dest),
+                       _mm_unpacklo_epi8(Chunk, Zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(Dest + 8),
+                       _mm_unpackhi_epi8(Chunk, Zero));
+      Ptr += 16;
+      Dest += 16;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    while (End - Ptr >= 16) {
+      uint8x16_t Chunk = vld1q_u8(Ptr);
+      if (vmaxvq_u8(Chunk) & 0x80)
+        break;
+      vst1q_u16(Dest, vmovl_u8(vget_low_u8(Chunk)));
+      vst1q_u16(Dest + 8, vmovl_high_u8(Chunk));
+      Ptr += 16;
+      Dest += 16;
+    }
+#endif
+    if (Ptr == End)
+      break;
+    if (*Ptr < 0x80) {
+      *Dest++ = *Ptr++;
+      continue;
+    }
+    int32_t Scalar = decodeMultiByteScalar(Ptr, End);
+    if (Scalar > 0xFFFF) {
+      Scalar -= 0x10000;
+      *Dest++ = 0xD800 + (Scalar >> 10);
+      *Dest++ = 0xDC00 + (Scalar & 0x3FF);
+    } else {
+      *Dest++ = Scalar;
+    }
+  }
+}
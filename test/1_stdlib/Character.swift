@@ -243,6 +243,25 @@ CharacterTests.test(
     { x in { String(Character(x)) < String(Character($0)) } } as PredicateFn)
 }
 
+CharacterTests.test("String(Character)/ASCII/StaticStorage") {
+  for i in 0..<128 {
+    let c = Character(UnicodeScalar(i))
+    var s = String(c)
+    expectTrue(s._core._owner == nil)
+    expectEqual([UInt16(i)], Array(s.utf16))
+    expectEqual(String(UnicodeScalar(i)), s)
+    expectEqual(String(UnicodeScalar(i)).hashValue, s.hashValue)
+    expectEqual([UInt8(i), 0], Array(s.nulTerminatedUTF8))
+
+    // Mutating the string must not touch the storage shared by all strings
+    // of this character.
+    s.append("x")
+    s.append(c)
+    expectEqual([UInt16(i), 0x78, UInt16(i)], Array(s.utf16))
+    expectEqual([UInt16(i)], Array(String(c).utf16))
+  }
+}
+
 CharacterTests.test("String.append(_: Character)") {
   for test in testCharacters {
     let character = Character(test)
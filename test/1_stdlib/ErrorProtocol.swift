@@ -143,5 +143,38 @@ ErrorProtocolTests.test("existential in lvalue") {
   expectEqual(0, LifetimeTracked.instances)
 }
 
+enum Direction : ErrorProtocol {
+  case North, South, East, West
+}
+
+struct EmptyError : ErrorProtocol {}
+
+ErrorProtocolTests.test("small trivial errors") {
+  // Errors of small trivial types may share their boxes, which must keep
+  // each of the values apart.
+  func fail(_ direction: Direction) throws {
+    throw direction
+  }
+  var caught: [Direction] = []
+  for _ in 0..<2 {
+    for direction in [Direction.North, .South, .East, .West] {
+      do {
+        try fail(direction)
+      } catch let error as Direction {
+        caught.append(error)
+      } catch {
+        expectUnreachable()
+      }
+    }
+  }
+  expectEqual([.North, .South, .East, .West, .North, .South, .East, .West],
+              caught)
+
+  let errors: [ErrorProtocol] = [EmptyError(), Direction.East, EmptyError()]
+  expectTrue(errors[0] is EmptyError)
+  expectEqual(.East, errors[1] as? Direction)
+  expectTrue(errors[2] is EmptyError)
+}
+
 runAllTests()
 
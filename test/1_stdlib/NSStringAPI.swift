@@ -723,6 +723,17 @@ NSStringAPIs.test("getCString(_:maxLength:encoding:)") {
   }
 }
 
+NSStringAPIs.test("utf8/NonContiguousNSString") {
+  // Surrogate pairs at every offset, so that some of them straddle the
+  // chunks the UTF-8 view reads from the NSString.
+  for prefixCount in 0..<10 {
+    let expected = String(repeating: "a" as Character, count: prefixCount) +
+      "\u{1F425}x\u{E9}\u{1F425}\u{1F425}yz"
+    let s = NonContiguousNSString(Array(expected.utf16)) as String
+    expectEqualSequence(expected.utf8, s.utf8)
+  }
+}
+
 NSStringAPIs.test("getLineStart(_:end:contentsEnd:forRange:)") {
   let s = "Глокая куздра\nштеко будланула\nбокра и кудрячит\nбокрёнка."
   let r = s.index(s.startIndex, offsetBy: 16)..<s.index(s.startIndex, offsetBy: 35)
@@ -128,6 +128,10 @@ PrintTests.test("Printable") {
   expectPrinted("1.25e-17", asFloat32(0.0000000000000000125))
 
   expectPrinted("1.00000000000001", asFloat64(1.00000000000001))
+  expectPrinted("1e+15", asFloat64(999999999999999.9))
+  expectPrinted("0.3", asFloat64(0.1 + 0.2))
+  expectPrinted("0.0001", asFloat64(0.00009999999999999999))
+  expectPrinted("2.5e-300", asFloat64(2.5e-300))
   expectPrinted("1.25e+17", asFloat64(125000000000000000.0))
   expectPrinted("1.25e+16", asFloat64(12500000000000000.0))
   expectPrinted("1.25e+15", asFloat64(1250000000000000.0))
@@ -229,6 +233,7 @@ PrintTests.test("Printable") {
 #endif
 
   expectDebugPrinted("1.1000000000000001", asFloat64(1.1))
+  expectDebugPrinted("0.30000000000000004", asFloat64(0.1 + 0.2))
   expectDebugPrinted("1.25e+17", asFloat64(125000000000000000.0))
   expectDebugPrinted("1.25", asFloat64(1.25))
   expectDebugPrinted("1.2500000000000001e-05", asFloat64(0.0000125))
@@ -0,0 +1,32 @@
+// RUN: %target-run-simple-swift | FileCheck %s
+// REQUIRES: executable_test
+
+#if os(OSX) || os(iOS) || os(watchOS) || os(tvOS)
+import Darwin
+#else
+import Glibc
+#endif
+
+// CHECK: ascii|1|µ|2.5
+print("ascii", 1, "µ", 2.5, separator: "|")
+
+// Strings longer than the buffer of print.
+let longASCII = String(repeating: "a" as Character, count: 10_000)
+let longUTF16 = String(repeating: "é" as Character, count: 10_000)
+// CHECK-NEXT: {{^a+$}}
+print(longASCII)
+// CHECK-NEXT: {{^(é)+$}}
+print(longUTF16)
+// CHECK-NEXT: {{^a+\|(é)+\|z$}}
+print(longASCII, longUTF16, "z", separator: "|")
+
+// The output of print is passed to stdio before print returns, so it is
+// ordered with the output of C functions.
+// CHECK-NEXT: before|C|after
+print("before", terminator: "")
+fputs("|C|", stdout)
+print("after")
+
+// CHECK-NEXT: flushed
+print("flushed")
+_flushStandardOutput()
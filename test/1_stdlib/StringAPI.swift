@@ -437,5 +437,27 @@ CStringTests.test("String.decodeCString") {
   }
 }
 
+CStringTests.test("String(cString:)/LongStrings") {
+  // Put non-ASCII and ill-formed sequences at every offset of a string that
+  // is longer than the blocks the runtime validates at once.
+  let tails: [(bytes: [UInt8], expected: String)] = [
+    ([], ""),
+    ([0xd0, 0xb0], "а"),
+    ([0xe6, 0x97, 0xa5], "日"),
+    ([0xf0, 0x9f, 0x90, 0xbc], "🐼"),
+    ([0xed, 0xa0, 0x80], "\u{fffd}\u{fffd}\u{fffd}"),
+  ]
+  for prefixLength in 0..<40 {
+    for (bytes, expected) in tails {
+      let prefix = String(repeating: Character("x"), count: prefixLength)
+      let utf8 = Array(prefix.utf8) + bytes + Array("yz".utf8) + [0]
+      let s = utf8.withUnsafeBufferPointer {
+        String(cString: UnsafePointer($0.baseAddress!))
+      }
+      expectEqual(prefix + expected + "yz", s)
+    }
+  }
+}
+
 runAllTests()
 
@@ -0,0 +1,53 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+
+var StringSwitchTestSuite = TestSuite("StringSwitch")
+
+// Enough cases for the switch to look up the matching case with
+// _findStringSwitchCase.
+func classify(_ s: String, allowLet: Bool = true) -> String {
+  switch s {
+  case "let" where allowLet:
+    return "binding"
+  case "var", "func":
+    return "declaration"
+  case "let":
+    return "disallowed binding"
+  case "":
+    return "empty"
+  case "K":
+    return "kelvin"
+  case "struct":
+    return "type"
+  default:
+    return "other"
+  }
+}
+
+StringSwitchTestSuite.test("ASCII") {
+  expectEqual("binding", classify("let"))
+  expectEqual("declaration", classify("var"))
+  expectEqual("declaration", classify("func"))
+  expectEqual("type", classify("struct"))
+  expectEqual("empty", classify(""))
+  expectEqual("other", classify("le"))
+  expectEqual("other", classify("lets"))
+  expectEqual("other", classify("Struct"))
+}
+
+StringSwitchTestSuite.test("Guards") {
+  // A case whose guard fails doesn't keep later cases with the same literal
+  // from matching.
+  expectEqual("disallowed binding", classify("let", allowLet: false))
+}
+
+StringSwitchTestSuite.test("NonASCII") {
+  // U+212A KELVIN SIGN is canonically equivalent to "K".
+  expectEqual("kelvin", classify("\u{212A}"))
+  expectEqual("other", classify("l\u{e9}t"))
+}
+
+runAllTests()
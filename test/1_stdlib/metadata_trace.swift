@@ -0,0 +1,37 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-build-swift %s -o %t/main
+// RUN: env SWIFT_DEBUG_METADATA_TRACE=%t/trace %target-run %t/main | FileCheck %s --check-prefix=CHECK-OUTPUT
+// RUN: FileCheck %s --check-prefix=CHECK-TRACE < %t/trace
+// RUN: env SWIFT_METADATA_PREWARM=%t/trace %target-run %t/main | FileCheck %s --check-prefix=CHECK-OUTPUT
+// REQUIRES: executable_test
+
+protocol P {
+  func doIt() -> Int
+}
+
+struct Box<T> : P {
+  var value: T
+  func doIt() -> Int { return 42 }
+}
+
+@inline(never)
+func makeBox<T>(_ value: T) -> Any {
+  return Box(value: value)
+}
+
+@inline(never)
+func makePair<T, U>(_ t: T, _ u: U) -> Any {
+  return (t, u)
+}
+
+let box = makeBox(1)
+let pair = makePair(1, "one")
+
+// CHECK-TRACE-DAG: metadata N {{[^ ]*}}3Box 1 N {{[^ ]+}} 0 # main.Box<Swift.Int>
+// CHECK-TRACE-DAG: metadata T 2 N {{[^ ]+}} 0 N {{[^ ]+}} 0 # (Swift.Int, Swift.String)
+// CHECK-TRACE-DAG: conformance N {{[^ ]*}}3Box 1 N {{[^ ]+}} 0 {{[^ ]*}}1P{{[^ ]*}} # main.Box<Swift.Int>
+
+// CHECK-OUTPUT: 42
+print((box as! P).doIt())
+// CHECK-OUTPUT: (1, "one")
+print(pair)
@@ -102,4 +102,17 @@ func longArray() {
   var _=["1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1", "1"]
 }
 
+// Arrays of literals of one kind share a single element type.
+func homogeneousLiterals() {
+  let ints = [1, 2, 3, 4, 5, 6, 7, 8]
+  let _: [Int] = ints
+  let doubles: [Double] = [1, 2, 3, 4, 5, 6, 7, 8]
+  let _: [Double] = doubles
+  let optionals: [Int?] = [1, 2, 3]
+  let _: [Int?] = optionals
+  let anys: [Any] = ["a", "b", "c"]
+  let _: [Any] = anys
+  let _: DoubleList = [1, 2, 3]
+}
+
 [1,2].map // expected-error {{expression type '(@noescape (Int) throws -> _) throws -> [_]' is ambiguous without more context}}
@@ -0,0 +1,26 @@
+// RUN: %target-parse-verify-swift
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -parse -stats-output-dir %t %s
+// RUN: cat %t/stats-*.json | FileCheck %s
+
+// Overloads which cannot match the labels, the number of arguments or the
+// literal arguments of a call are pruned before solving.
+
+// CHECK: "Sema.NumDisjunctionTermsPruned": {{[1-9][0-9]*}}
+
+struct Meters {}
+
+func measure(_ x: Int) -> Int { return x }
+func measure(_ x: String) -> String { return x }
+func measure(_ x: Meters) -> Meters { return x }
+func measure(_ x: Int, _ y: Int) -> Int { return x + y }
+func measure(from x: Int) -> Double { return 0 }
+func measure(_ x: Int, scale: Double = 1) -> Float { return 0 }
+
+let i: Int = measure(1)
+let s: String = measure("one")
+let d: Double = measure(from: 1)
+let f: Float = measure(1, scale: 2)
+let j: Int = measure(1, 2)
+let m: Meters = measure(Meters())
+let o: Int? = measure(1)
@@ -0,0 +1,11 @@
+public func f() -> Int {
+#if CHANGE_BODY
+  return 1
+#else
+  return 0
+#endif
+}
+
+#if CHANGE_INTERFACE
+public func g() {}
+#endif
@@ -0,0 +1,3 @@
+# Dependencies after compilation:
+depends-top-level: [f]
+depends-external: ["./Lib.swiftmodule"]
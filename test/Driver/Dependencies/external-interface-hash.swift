@@ -0,0 +1,25 @@
+/// "./Lib.swiftmodule" ==> main
+
+// RUN: rm -rf %t && cp -r %S/Inputs/external-interface-hash/ %t
+// RUN: %target-swift-frontend -emit-module -module-name Lib -o %t/Lib.swiftmodule %t/Lib.swift
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
+// RUN: FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+
+// CHECK-FIRST-NOT: warning
+// CHECK-FIRST: Handled main.swift
+
+// CHECK-RECORD: external_interface_hashes:
+// CHECK-RECORD-NEXT: "./Lib.swiftmodule": "{{[0-9a-f]+}}"
+
+// A module whose function bodies changed has the same interface hash.
+// RUN: %target-swift-frontend -emit-module -module-name Lib -o %t/Lib.swiftmodule %t/Lib.swift -D CHANGE_BODY
+// RUN: touch -t 203704010005 %t/Lib.swiftmodule
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-SECOND %s
+
+// CHECK-SECOND-NOT: Handled
+
+// RUN: %target-swift-frontend -emit-module -module-name Lib -o %t/Lib.swiftmodule %t/Lib.swift -D CHANGE_INTERFACE
+// RUN: touch -t 203704010005 %t/Lib.swiftmodule
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
@@ -0,0 +1,16 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: touch %t/file-01.swift %t/file-02.swift %t/file-03.swift %t/file-04.swift
+
+// RUN: %swiftc_driver -driver-skip-execution -v -enable-batch-mode -j2 -c -module-name main %t/file-01.swift %t/file-02.swift %t/file-03.swift %t/file-04.swift 2>&1 | FileCheck %s
+// CHECK: -frontend -c {{.*}}-primary-file {{.*}}file-01.swift {{.*}}-primary-file {{.*}}file-02.swift {{.*}}-o {{.*}}file-01.o -o {{.*}}file-02.o
+// CHECK: -frontend -c {{.*}}-primary-file {{.*}}file-03.swift {{.*}}-primary-file {{.*}}file-04.swift {{.*}}-o {{.*}}file-03.o -o {{.*}}file-04.o
+// CHECK-NOT: -frontend -c
+
+// Jobs that write serialized diagnostics are not combined.
+// RUN: %swiftc_driver -driver-skip-execution -v -enable-batch-mode -j2 -c -serialize-diagnostics -module-name main %t/file-01.swift %t/file-02.swift %t/file-03.swift %t/file-04.swift 2>&1 | FileCheck -check-prefix=NO-BATCH %s
+
+// Without -enable-batch-mode every file gets its own frontend job.
+// RUN: %swiftc_driver -driver-skip-execution -v -j2 -c -module-name main %t/file-01.swift %t/file-02.swift %t/file-03.swift %t/file-04.swift 2>&1 | FileCheck -check-prefix=NO-BATCH %s
+// NO-BATCH-NOT: -primary-file {{.*}} -primary-file
+// NO-BATCH: -primary-file {{[^ ]*}}file-04.swift
+// NO-BATCH-NOT: -primary-file {{.*}} -primary-file
@@ -0,0 +1,19 @@
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/../Inputs/empty.h -enable-bridging-pch -c %s 2>&1 | FileCheck %s -check-prefix=YESPCHACT
+// YESPCHACT: 0: input, "{{.*}}bridging-pch.swift", swift
+// YESPCHACT: 1: input, "{{.*}}Inputs/empty.h", objc-header
+// YESPCHACT: 2: generate-pch, {1}, pch
+// YESPCHACT: 3: compile, {0, 2}, object
+
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/../Inputs/empty.h -c %s 2>&1 | FileCheck %s -check-prefix=NOPCHACT
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/../Inputs/empty.h -enable-bridging-pch -disable-bridging-pch -c %s 2>&1 | FileCheck %s -check-prefix=NOPCHACT
+// NOPCHACT: 0: input, "{{.*}}bridging-pch.swift", swift
+// NOPCHACT-NOT: generate-pch
+// NOPCHACT: 1: compile, {0}, object
+
+// RUN: %swiftc_driver -driver-print-jobs -import-objc-header %S/../Inputs/empty.h -enable-bridging-pch -c %s 2>&1 | FileCheck %s -check-prefix=YESPCHJOB
+// YESPCHJOB: {{.*}}swift -frontend -emit-pch {{.*}}Inputs/empty.h {{.*}}-o [[PCH:.*empty.*\.pch]]
+// YESPCHJOB: {{.*}}swift -frontend -c {{.*}}-import-objc-header {{.*}}Inputs/empty.h {{.*}}-import-objc-pch [[PCH]]
+
+// RUN: %swiftc_driver -driver-print-jobs -import-objc-header %S/../Inputs/empty.h -enable-bridging-pch -pch-output-dir %t/pch -c %s 2>&1 | FileCheck %s -check-prefix=PERSISTENT
+// PERSISTENT: {{.*}}swift -frontend -emit-pch {{.*}}-o {{.*}}/pch/empty-{{[0-9a-f]+}}.pch
+// PERSISTENT: {{.*}}swift -frontend -c {{.*}}-import-objc-pch {{.*}}/pch/empty-{{[0-9a-f]+}}.pch
@@ -0,0 +1,26 @@
+// The driver starts the jobs on the longest paths through the job graph
+// first. Without a build record, it estimates the length of a compile job
+// from the size of its input.
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'public func small() {}' > %t/small.swift
+// RUN: %{python} -c 'import sys; sys.stdout.write("public func big() {}\n" * 2000)' > %t/big.swift
+// RUN: %swiftc_driver_plain -c %t/small.swift %t/big.swift -module-name main -j1 -parseable-output -driver-skip-execution 2>&1 | FileCheck %s
+
+// CHECK: "kind": "began",
+// CHECK: "inputs": [
+// CHECK-NEXT: "{{.*}}/big.swift"
+// CHECK: "kind": "began",
+// CHECK: "inputs": [
+// CHECK-NEXT: "{{.*}}/small.swift"
+
+// The driver reports how busy the job slots were.
+// RUN: %swiftc_driver_plain -c %t/small.swift %t/big.swift -module-name main -j2 -driver-skip-execution -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-*-swift-driver-*.json | FileCheck -check-prefix=STATS %s
+
+// STATS: {
+// STATS: "Driver.NumDriverJobsRun": 2
+// STATS: "Driver.NumDriverParallelJobSlots": 2
+// STATS: "Driver.DriverJobSlotUtilizationPercent": {{[0-9]+}}
+// STATS: "Driver.DriverCriticalPathEstimateMilliseconds": {{[1-9][0-9]*}}
+// STATS: }
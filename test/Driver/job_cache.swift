@@ -0,0 +1,35 @@
+// With -driver-job-cache-path, the driver restores the outputs of compile
+// jobs which ran before with the same flags and inputs, instead of running
+// them again.
+
+// RUN: rm -rf %t && mkdir -p %t/build
+// RUN: echo 'public func other() {}' > %t/other.swift
+// RUN: cd %t/build && %target-swiftc_driver -c %s %t/other.swift -module-name main -emit-dependencies -driver-job-cache-path %t/cache -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-*-swift-driver-*.json | FileCheck -check-prefix=FIRST %s
+
+// FIRST: "Driver.NumDriverJobCacheHits": 0
+// FIRST: "Driver.NumDriverJobCacheMisses": 2
+
+// RUN: rm -rf %t/stats %t/build/*.o
+// RUN: cd %t/build && %target-swiftc_driver -c %s %t/other.swift -module-name main -emit-dependencies -driver-job-cache-path %t/cache -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-*-swift-driver-*.json | FileCheck -check-prefix=SECOND %s
+// RUN: ls %t/build | FileCheck -check-prefix=OUTPUTS %s
+
+// SECOND: "Driver.NumDriverJobsRun": 0
+// SECOND: "Driver.NumDriverJobCacheHits": 2
+// SECOND: "Driver.NumDriverJobCacheMisses": 0
+
+// OUTPUTS-DAG: job_cache.o
+// OUTPUTS-DAG: other.o
+
+// Changing a file which the jobs read means the jobs have to run again. Both
+// jobs read other.swift.
+// RUN: rm -rf %t/stats
+// RUN: echo 'public func changed() {}' >> %t/other.swift
+// RUN: cd %t/build && %target-swiftc_driver -c %s %t/other.swift -module-name main -emit-dependencies -driver-job-cache-path %t/cache -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-*-swift-driver-*.json | FileCheck -check-prefix=CHANGED %s
+
+// CHANGED: "Driver.NumDriverJobCacheHits": 0
+// CHANGED: "Driver.NumDriverJobCacheMisses": 2
+
+public func main() {}
@@ -0,0 +1,46 @@
+// With -driver-job-cache-path, the driver skips merging the partial modules
+// when their contents are the same as in an earlier build, even if the
+// compile jobs which produced them had to run again.
+
+// RUN: rm -rf %t && mkdir -p %t/build
+// RUN: echo 'public func other() -> Int { return 1 }' > %t/other.swift
+// RUN: cd %t/build && %target-swiftc_driver -c %s %t/other.swift -module-name main -emit-module -emit-dependencies -driver-job-cache-path %t/cache -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-*-swift-driver-*.json | FileCheck -check-prefix=FIRST %s
+
+// FIRST: "Driver.DriverMergeModulesMilliseconds": {{[0-9]+}}
+// FIRST: "Driver.NumDriverJobCacheHits": 0
+// FIRST: "Driver.NumDriverJobCacheMisses": 3
+
+// RUN: rm -rf %t/stats %t/build/*
+// RUN: cd %t/build && %target-swiftc_driver -c %s %t/other.swift -module-name main -emit-module -emit-dependencies -driver-job-cache-path %t/cache -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-*-swift-driver-*.json | FileCheck -check-prefix=SECOND %s
+// RUN: ls %t/build | FileCheck -check-prefix=OUTPUTS %s
+
+// SECOND: "Driver.NumDriverJobsRun": 0
+// SECOND: "Driver.DriverMergeModulesMilliseconds": 0
+// SECOND: "Driver.NumDriverJobCacheHits": 3
+// SECOND: "Driver.NumDriverJobCacheMisses": 0
+
+// OUTPUTS-DAG: main.swiftmodule
+// OUTPUTS-DAG: main.swiftdoc
+
+// Changing the body of a function changes neither partial module, so the
+// compile jobs run again, but the merged module is restored.
+// RUN: rm -rf %t/stats
+// RUN: echo 'public func other() -> Int { return 2 }' > %t/other.swift
+// RUN: cd %t/build && %target-swiftc_driver -c %s %t/other.swift -module-name main -emit-module -emit-dependencies -driver-job-cache-path %t/cache -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-*-swift-driver-*.json | FileCheck -check-prefix=BODY %s
+
+// BODY: "Driver.NumDriverJobCacheHits": 1
+// BODY: "Driver.NumDriverJobCacheMisses": 2
+
+// Changing the interface changes the partial modules, so the merge runs too.
+// RUN: rm -rf %t/stats
+// RUN: echo 'public func changed() {}' >> %t/other.swift
+// RUN: cd %t/build && %target-swiftc_driver -c %s %t/other.swift -module-name main -emit-module -emit-dependencies -driver-job-cache-path %t/cache -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-*-swift-driver-*.json | FileCheck -check-prefix=INTERFACE %s
+
+// INTERFACE: "Driver.NumDriverJobCacheHits": 0
+// INTERFACE: "Driver.NumDriverJobCacheMisses": 3
+
+public func main() {}
@@ -46,3 +46,13 @@
 // LINUX: clang++{{"? }}
 // LINUX: lib/swift/clang/lib/linux/libclang_rt.profile-x86_64.a
 
+
+// RUN: %swiftc_driver -driver-print-jobs -profile-use=%t.profdata -target x86_64-unknown-linux-gnu %s | FileCheck -check-prefix=USE %s
+
+// USE: swift
+// USE: -profile-use={{.*}}.profdata
+
+// RUN: %swiftc_driver -driver-print-jobs -receiver-profile-use=%t.txt -target x86_64-unknown-linux-gnu %s | FileCheck -check-prefix=RECEIVER %s
+
+// RECEIVER: swift
+// RECEIVER: -receiver-profile-use={{.*}}.txt
@@ -0,0 +1,5 @@
+import SkipBodies
+
+public func client() -> Int {
+  return transparent() + notInlinable()
+}
@@ -0,0 +1,9 @@
+func otherFunction() -> Int {
+  let = 1
+  return 0
+}
+
+@_transparent
+func otherTransparent() -> Int {
+  return 1
+}
@@ -0,0 +1,40 @@
+// RUN: rm -rf %t && mkdir %t
+
+// RUN: %target-swift-frontend -emit-silgen -module-name batch -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -o %t/main.sil -o %t/other.sil
+// RUN: FileCheck -check-prefix=CHECK-MAIN %s < %t/main.sil
+// RUN: FileCheck -check-prefix=CHECK-OTHER %s < %t/other.sil
+
+// CHECK-MAIN: sil hidden @_TF5batch8mainFuncFT_T_
+// CHECK-MAIN-NOT: sil hidden @_TF5batch9otherFuncFT_T_
+
+// CHECK-OTHER: sil hidden @_TF5batch9otherFuncFT_T_
+// CHECK-OTHER-NOT: sil hidden @_TF5batch8mainFuncFT_T_
+
+// The primary files can also come from a filelist, in any order.
+// RUN: echo '%S/Inputs/batch-mode-other.swift' > %t/input.txt
+// RUN: echo '%s' >> %t/input.txt
+// RUN: %target-swift-frontend -parse -module-name batch -filelist %t/input.txt -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -emit-reference-dependencies-path %t/main.swiftdeps -emit-reference-dependencies-path %t/other.swiftdeps
+// RUN: FileCheck -check-prefix=CHECK-MAIN-DEPS %s < %t/main.swiftdeps
+// RUN: FileCheck -check-prefix=CHECK-OTHER-DEPS %s < %t/other.swiftdeps
+
+// CHECK-MAIN-DEPS-LABEL: {{^provides-top-level:$}}
+// CHECK-MAIN-DEPS-NEXT: "mainFunc"
+// CHECK-MAIN-DEPS-LABEL: {{^depends-top-level:$}}
+// CHECK-MAIN-DEPS: "otherFunc"
+
+// CHECK-OTHER-DEPS-LABEL: {{^provides-top-level:$}}
+// CHECK-OTHER-DEPS-NEXT: "otherFunc"
+// CHECK-OTHER-DEPS-NOT: "mainFunc"
+
+// RUN: not %target-swift-frontend -emit-silgen -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -o %t/main.sil 2>&1 | FileCheck -check-prefix=CHECK-OUTPUT-COUNT %s
+// CHECK-OUTPUT-COUNT: error: '-o' must be given once for each -primary-file (1 given for 2 primary files)
+
+// RUN: not %target-swift-frontend -emit-silgen -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -o %t/main.sil -o %t/other.sil -serialize-diagnostics-path %t/main.dia 2>&1 | FileCheck -check-prefix=CHECK-UNSUPPORTED %s
+// CHECK-UNSUPPORTED: error: '-serialize-diagnostics-path' is not supported with more than one -primary-file
+
+// RUN: not %target-swift-frontend -dump-ast -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift 2>&1 | FileCheck -check-prefix=CHECK-MODE %s
+// CHECK-MODE: error: this mode does not support more than one -primary-file
+
+func mainFunc() {
+  otherFunc()
+}
@@ -0,0 +1,35 @@
+// RUN: rm -rf %t && mkdir -p %t/stats1 %t/stats2 %t/stats3
+// RUN: cp %s %t/main.swift
+
+// The first compile writes the record of the file.
+// RUN: %target-swift-frontend -c -primary-file %t/main.swift -o %t/main.o -index-records-path %t/records -stats-output-dir %t/stats1
+// RUN: cat %t/stats1/stats-*.json | FileCheck -check-prefix=WRITTEN %s
+// RUN: ls %t/records | FileCheck -check-prefix=RECORD %s
+// RUN: FileCheck -check-prefix=CONTENTS %s < %t/records/main.swift-*.swiftindex
+
+// The file isn't indexed again while it is unchanged.
+// RUN: %target-swift-frontend -c -primary-file %t/main.swift -o %t/main.o -index-records-path %t/records -stats-output-dir %t/stats2
+// RUN: cat %t/stats2/stats-*.json | FileCheck -check-prefix=UPTODATE %s
+
+// Changing the file gives it a new record.
+// RUN: echo 'public func other() {}' >> %t/main.swift
+// RUN: %target-swift-frontend -c -primary-file %t/main.swift -o %t/main.o -index-records-path %t/records -stats-output-dir %t/stats3
+// RUN: cat %t/stats3/stats-*.json | FileCheck -check-prefix=WRITTEN %s
+// RUN: ls %t/records | FileCheck -check-prefix=TWO-RECORDS %s
+
+// WRITTEN: "Index.NumIndexRecordsWritten": 1
+// UPTODATE: "Index.NumIndexRecordsUpToDate": 1
+// RECORD: {{^main.swift-[0-9a-z]+.swiftindex$}}
+// TWO-RECORDS: {{^main.swift-[0-9a-z]+.swiftindex$}}
+// TWO-RECORDS-NEXT: {{^main.swift-[0-9a-z]+.swiftindex$}}
+// CONTENTS: SIDX
+// CONTENTS-DAG: indexedFunction
+// CONTENTS-DAG: IndexedStruct
+
+public struct IndexedStruct {
+  public var value: Int
+}
+
+public func indexedFunction(_ s: IndexedStruct) -> Int {
+  return s.value
+}
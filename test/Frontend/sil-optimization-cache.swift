@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir -p %t/stats1 %t/stats2 %t/stats3
+// RUN: cp %s %t/main.swift
+
+// The first compile saves its output in the cache.
+// RUN: %target-swift-frontend -c -O %t/main.swift -o %t/first.o -sil-optimization-cache-path %t/cache -stats-output-dir %t/stats1
+// RUN: cat %t/stats1/stats-*.json | FileCheck -check-prefix=MISS %s
+// RUN: ls %t/cache | FileCheck -check-prefix=ENTRY %s
+
+// The second compile of the same SIL reuses it.
+// RUN: %target-swift-frontend -c -O %t/main.swift -o %t/second.o -sil-optimization-cache-path %t/cache -stats-output-dir %t/stats2
+// RUN: cat %t/stats2/stats-*.json | FileCheck -check-prefix=HIT %s
+// RUN: cmp %t/first.o %t/second.o
+
+// Changing the code changes the key.
+// RUN: echo 'public func other() {}' >> %t/main.swift
+// RUN: %target-swift-frontend -c -O %t/main.swift -o %t/third.o -sil-optimization-cache-path %t/cache -stats-output-dir %t/stats3
+// RUN: cat %t/stats3/stats-*.json | FileCheck -check-prefix=MISS %s
+
+// Jobs that also emit a module aren't cached.
+// RUN: %target-swift-frontend -c -O %t/main.swift -o %t/fourth.o -emit-module-path %t/main.swiftmodule -sil-optimization-cache-path %t/uncached
+// RUN: not ls %t/uncached/*.o
+
+// MISS: "SILModule.NumSILOptCacheMisses": 1
+// HIT: "SILModule.NumSILOptCacheHits": 1
+// ENTRY: {{^[0-9a-f]+}}.o
+
+public func compute(_ values: [Int]) -> Int {
+  return values.map { $0 * 2 }.reduce(0, +)
+}
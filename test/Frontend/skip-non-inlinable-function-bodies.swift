@@ -0,0 +1,24 @@
+// RUN: rm -rf %t && mkdir %t
+
+// The body of notInlinable() is not type-checked, so its error is not found.
+// RUN: %target-swift-frontend -emit-module -experimental-skip-non-inlinable-function-bodies -module-name SkipBodies -o %t %s
+// RUN: not %target-swift-frontend -parse -module-name SkipBodies %s 2>&1 | FileCheck -check-prefix=CHECK-FULL %s
+
+// CHECK-FULL: error: cannot convert value of type 'String' to specified type 'Int'
+
+// Transparent functions keep their bodies and are still inlined into clients.
+// RUN: %target-swift-frontend -emit-sil -module-name Client -I %t %S/Inputs/skip-function-bodies-client.swift | FileCheck -check-prefix=CHECK-CLIENT %s
+
+// CHECK-CLIENT-LABEL: sil @_TF6Client6clientFT_Si
+// CHECK-CLIENT-NOT: function_ref @_TF10SkipBodies11transparentFT_Si
+// CHECK-CLIENT: function_ref @_TF10SkipBodies12notInlinableFT_Si
+
+@_transparent
+public func transparent() -> Int {
+  return 1
+}
+
+public func notInlinable() -> Int {
+  let x: Int = "not an int"
+  return x
+}
@@ -0,0 +1,11 @@
+// The bodies of functions in non-primary files are not parsed, so the error
+// in otherFunction() is only found when its file is parsed fully.
+// RUN: %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-non-primary-other.swift
+// RUN: not %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-non-primary-other.swift -parse-non-primary-function-bodies 2>&1 | FileCheck %s
+// RUN: not %target-swift-frontend -parse %s %S/Inputs/skip-non-primary-other.swift 2>&1 | FileCheck %s
+
+// CHECK: skip-non-primary-other.swift:2:7: error:
+
+func useOtherFunctions() -> Int {
+  return otherFunction() + otherTransparent()
+}
@@ -0,0 +1,11 @@
+#define LT_INT 1
+#define LT_NEGATIVE -1
+#define LT_SHIFT (1 << 4)
+#define LT_STRING "string"
+#define LT_ALIAS LT_INT
+
+#define LT_CALL lt_function(1)
+#define LT_CAST ((int)3)
+#define LT_EXPR (LT_INT + 2)
+
+int lt_function(int);
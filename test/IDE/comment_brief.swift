@@ -117,6 +117,21 @@ func briefMixed2() {}
 */
 func briefMixed3() {}
 
+/// Aaa.
+/// - Returns: Bbb.
+///
+/// Ccc.
+func briefFollowedByField() {}
+
+/// Aaa [bbb].
+///
+/// [bbb]: http://swift.org
+func briefWithLinkReference() {}
+
+///
+/// - Returns: Aaa.
+func briefNotParagraph() {}
+
 struct Indentation {
   /**
    * Aaa.
@@ -147,6 +162,9 @@ struct Indentation {
 // CHECK-NEXT: Func/briefMixed1 {{.*}} BriefComment=[Aaa. Bbb.]
 // CHECK-NEXT: Func/briefMixed2 {{.*}} BriefComment=[Aaa.]
 // CHECK-NEXT: Func/briefMixed3 {{.*}} BriefComment=[Aaa.]
+// CHECK-NEXT: Func/briefFollowedByField {{.*}} BriefComment=[Aaa.]
+// CHECK-NEXT: Func/briefWithLinkReference {{.*}} BriefComment=[Aaa bbb.]
+// CHECK-NEXT: Func/briefNotParagraph {{.*}} BriefComment=none
 // CHECK-NEXT: Struct/Indentation RawComment=none
 // CHECK-NEXT: Func/Indentation.briefBlockWithASCIIArt1 {{.*}} BriefComment=[Aaa.]
 
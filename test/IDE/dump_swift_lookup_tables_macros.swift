@@ -0,0 +1,18 @@
+// RUN: %target-swift-ide-test -dump-importer-lookup-table -source-filename %s -import-objc-header %S/Inputs/lookup_table_macros.h > %t.log 2>&1
+// RUN: FileCheck %s < %t.log
+
+// Macros whose expansions cannot be imported are left out of the table.
+
+// CHECK-LABEL: <<Bridging header lookup table>>
+// CHECK:         LT_ALIAS:
+// CHECK-NEXT:      TU: Macro
+// CHECK-NEXT:    LT_INT:
+// CHECK-NEXT:      TU: Macro
+// CHECK-NEXT:    LT_NEGATIVE:
+// CHECK-NEXT:      TU: Macro
+// CHECK-NEXT:    LT_SHIFT:
+// CHECK-NEXT:      TU: Macro
+// CHECK-NEXT:    LT_STRING:
+// CHECK-NEXT:      TU: Macro
+// CHECK-NEXT:    lt_function:
+// CHECK-NEXT:      TU: lt_function
@@ -0,0 +1,3 @@
+public func otherArrayMetadata() -> Any.Type {
+  return metadataOf([1, 2, 3])
+}
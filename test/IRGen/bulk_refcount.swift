@@ -0,0 +1,38 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | FileCheck %s --check-prefix=CHECK --check-prefix=CHECK-%target-ptrsize
+
+// Value witnesses of aggregates whose non-POD contents are several native
+// references retain and release them all with one runtime call.
+
+class C {}
+
+struct ThreeRefs {
+  var a: C
+  var n: Int
+  var b: C
+  var c: C?
+}
+
+struct OneRef {
+  var a: C
+  var n: Int
+}
+
+// CHECK-64: @bulk_refcount_offsets = private unnamed_addr constant [3 x i32] [i32 0, i32 16, i32 24]
+// CHECK-32: @bulk_refcount_offsets = private unnamed_addr constant [3 x i32] [i32 0, i32 8, i32 12]
+
+// CHECK-LABEL: define linkonce_odr hidden void @_TwxxV13bulk_refcount9ThreeRefs
+// CHECK:         call void @swift_bulkRelease(i8* {{%.*}}, i32* getelementptr inbounds ([3 x i32], [3 x i32]* @bulk_refcount_offsets{{(\.[0-9]+)?}}, i32 0, i32 0), i32 3)
+// CHECK-NOT:     call void @swift_release
+// CHECK:         ret void
+
+// CHECK-LABEL: define linkonce_odr hidden %swift.opaque* @_TwcpV13bulk_refcount9ThreeRefs
+// CHECK:         call void @llvm.memcpy
+// CHECK:         call void @swift_bulkRetain(i8* {{%.*}}, i32* getelementptr inbounds ([3 x i32], [3 x i32]* @bulk_refcount_offsets{{(\.[0-9]+)?}}, i32 0, i32 0), i32 3)
+// CHECK-NOT:     call void @swift_retain
+// CHECK:         ret
+
+// A single reference is still retained directly.
+// CHECK-LABEL: define linkonce_odr hidden %swift.opaque* @_TwcpV13bulk_refcount6OneRef
+// CHECK-NOT:     swift_bulkRetain
+// CHECK:         call void @swift_retain
+// CHECK:         ret
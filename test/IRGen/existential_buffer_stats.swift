@@ -0,0 +1,33 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-ir %s -stats-output-dir %t -o /dev/null
+// RUN: cat %t/stats-*.json | FileCheck %s
+
+// CHECK: "IRModule.NumExistentialInitsBoxed": 1
+// CHECK: "IRModule.NumExistentialInitsDynamic": 1
+// CHECK: "IRModule.NumExistentialInitsInline": 1
+
+protocol Shape {}
+
+struct Small : Shape {
+  var x: Int
+}
+
+struct Large : Shape {
+  var a, b, c, d: Int
+}
+
+struct Generic<T> : Shape {
+  var t: T
+}
+
+func makeSmall() -> Shape {
+  return Small(x: 0)
+}
+
+func makeLarge() -> Shape {
+  return Large(a: 0, b: 0, c: 0, d: 0)
+}
+
+func makeGeneric<T>(_ t: T) -> Shape {
+  return Generic(t: t)
+}
@@ -0,0 +1,47 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir -enable-layout-value-witnesses | FileCheck %s --check-prefix=CHECK --check-prefix=CHECK-%target-ptrsize
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | FileCheck %s --check-prefix=NOLAYOUT
+
+// Types whose values only hold native references share their copy and
+// destroy value witnesses with all types of the same layout.
+
+class C {}
+class D {}
+
+struct A {
+  var x: C
+  var n: Int
+  var y: C
+}
+
+struct B {
+  var p: D
+  var m: Int
+  var q: D?
+}
+
+// CHECK-64: @_TWVV22layout_value_witnesses1A = {{.*}} @__swift_destroy_refs24_8_0_16 {{.*}} @__swift_initWithCopy_refs24_8_0_16 {{.*}} @__swift_assignWithCopy_refs24_8_0_16
+// CHECK-64: @_TWVV22layout_value_witnesses1B = {{.*}} @__swift_destroy_refs24_8_0_16 {{.*}} @__swift_initWithCopy_refs24_8_0_16 {{.*}} @__swift_assignWithCopy_refs24_8_0_16
+// CHECK-32: @_TWVV22layout_value_witnesses1A = {{.*}} @__swift_destroy_refs12_4_0_8 {{.*}} @__swift_initWithCopy_refs12_4_0_8 {{.*}} @__swift_assignWithCopy_refs12_4_0_8
+// CHECK-32: @_TWVV22layout_value_witnesses1B = {{.*}} @__swift_destroy_refs12_4_0_8 {{.*}} @__swift_initWithCopy_refs12_4_0_8 {{.*}} @__swift_assignWithCopy_refs12_4_0_8
+
+// CHECK-NOT: define {{.*}} @_TwxxV22layout_value_witnesses1A
+// CHECK-NOT: define {{.*}} @_TwxxV22layout_value_witnesses1B
+
+// CHECK-LABEL: define linkonce_odr hidden void @__swift_destroy_refs
+// CHECK:         call void @swift_bulkRelease(i8* {{%.*}}, i32* getelementptr inbounds ([2 x i32], [2 x i32]* @bulk_refcount_offsets{{(\.[0-9]+)?}}, i32 0, i32 0), i32 2)
+// CHECK:         ret void
+
+// CHECK-LABEL: define linkonce_odr hidden i8* @__swift_initWithCopy_refs
+// CHECK:         call void @llvm.memcpy
+// CHECK:         call void @swift_bulkRetain(i8* {{%.*}}, i32* getelementptr inbounds ([2 x i32], [2 x i32]* @bulk_refcount_offsets{{(\.[0-9]+)?}}, i32 0, i32 0), i32 2)
+// CHECK:         ret i8*
+
+// CHECK-LABEL: define linkonce_odr hidden i8* @__swift_assignWithCopy_refs
+// CHECK:         call void @swift_bulkRetain
+// CHECK:         call void @llvm.memcpy
+// CHECK:         call void @llvm.memcpy
+// CHECK:         call void @swift_bulkRelease
+// CHECK:         ret i8*
+
+// NOLAYOUT-NOT: __swift_destroy_refs
+// NOLAYOUT: define linkonce_odr hidden void @_TwxxV22layout_value_witnesses1A
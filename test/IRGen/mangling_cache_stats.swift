@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-ir %s -stats-output-dir %t -o /dev/null
+// RUN: cat %t/stats-*.json | FileCheck %s
+
+// The field types of both structs are mangled only once.
+// CHECK: "IRModule.NumLinkEntityManglings": {{[1-9][0-9]*}}
+// CHECK: "IRModule.NumLinkEntityManglingCacheHits": {{[1-9][0-9]*}}
+
+public struct Point {
+  public var x: Int
+  public var y: Int
+}
+
+public struct Size {
+  public var width: Int
+  public var height: Int
+}
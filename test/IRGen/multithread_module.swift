@@ -4,6 +4,13 @@
 // RUN: FileCheck --check-prefix=CHECK-MAINLL %s <%t/main.ll
 // RUN: FileCheck --check-prefix=CHECK-MODULELL %s <%t/mt_module.ll
 
+// Each LLVM thread records how long it was busy.
+// RUN: mkdir -p %t/stats
+// RUN: %target-swift-frontend %S/Inputs/multithread_module/main.swift -emit-ir -o %t/main.ll %s -o %t/mt_module.ll -num-threads 2 -module-name test -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-*.json | FileCheck --check-prefix=CHECK-STATS %s
+// CHECK-STATS-DAG: "time.swift.LLVM.thread0.wall": {{[0-9.e-]+}}
+// CHECK-STATS-DAG: "time.swift.LLVM.thread1.wall": {{[0-9.e-]+}}
+
 // RUN: %target-swift-frontend -c %S/Inputs/multithread_module/main.swift -o %t/main.o %s -o %t/mt_module.o -num-threads 2 -O -g -module-name test
 // RUN: %target-build-swift %t/main.o %t/mt_module.o -o %t/a.out
 // RUN: %target-run %t/a.out | FileCheck %s
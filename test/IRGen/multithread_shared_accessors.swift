@@ -0,0 +1,21 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-ir %s %S/Inputs/multithread_shared_accessors_other.swift -o %t/main.ll -o %t/other.ll -num-threads 2 -module-name test
+// RUN: FileCheck --check-prefix=CHECK-MAIN %s < %t/main.ll
+// RUN: FileCheck --check-prefix=CHECK-OTHER %s < %t/other.ll
+
+// In multi-threaded compilation a non-unique metadata accessor is only
+// defined in the LLVM module of the first file. The other modules call it.
+
+// CHECK-MAIN: define weak_odr hidden %swift.type* @_TMaGSaSi_()
+
+// CHECK-OTHER-NOT: define {{.*}} @_TMaGSaSi_()
+// CHECK-OTHER: declare hidden %swift.type* @_TMaGSaSi_()
+// CHECK-OTHER-NOT: define {{.*}} @_TMaGSaSi_()
+
+public func metadataOf<T>(_ value: T) -> Any.Type {
+  return T.self
+}
+
+public func mainArrayMetadata() -> Any.Type {
+  return metadataOf([4, 5, 6])
+}
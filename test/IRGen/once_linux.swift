@@ -0,0 +1,18 @@
+// RUN: %swift -target x86_64-unknown-linux-gnu -parse-stdlib -disable-objc-interop -module-name main %s -emit-ir -o - | FileCheck %s
+
+// On Linux, the runtime's swift_once uses -1 as the "done" value, so the
+// check for an already initialized predicate is emitted inline.
+
+// CHECK-LABEL: define hidden void @_TF4main8testOnce{{.*}}(i8*, i8*)
+// CHECK:         [[PRED_PTR:%.*]] = bitcast i8* %0 to i64*
+// CHECK:         [[PRED:%.*]] = load {{.*}} i64* [[PRED_PTR]]
+// CHECK:         [[IS_DONE:%.*]] = icmp eq i64 [[PRED]], -1
+// CHECK:         br i1 [[IS_DONE]], label %[[DONE:.*]], label %[[NOT_DONE:.*]]
+// CHECK:       [[NOT_DONE]]:
+// CHECK:         call void @swift_once(i64* [[PRED_PTR]], i8* %1)
+// CHECK:         br label %[[DONE]]
+// CHECK:       [[DONE]]:
+// CHECK:         call void @llvm.assume(i1
+func testOnce(_ p: Builtin.RawPointer, f: @convention(thin) () -> ()) {
+  Builtin.once(p, f)
+}
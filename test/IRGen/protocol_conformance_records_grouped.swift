@@ -0,0 +1,23 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | FileCheck %s
+
+// The conformance records of an object file are grouped by protocol, in order
+// of the first conformance to each protocol.
+
+protocol Runcible {}
+protocol Fungible {}
+
+struct A: Runcible {}
+struct B: Fungible {}
+struct C: Runcible {}
+struct D: Fungible {}
+
+// CHECK-LABEL: @"\01l_protocol_conformances" = private constant [4 x
+// CHECK:         @_TMp34protocol_conformance_records_grouped8Runcible
+// CHECK:         @_TMfV34protocol_conformance_records_grouped1A
+// CHECK:         @_TMp34protocol_conformance_records_grouped8Runcible
+// CHECK:         @_TMfV34protocol_conformance_records_grouped1C
+// CHECK:         @_TMp34protocol_conformance_records_grouped8Fungible
+// CHECK:         @_TMfV34protocol_conformance_records_grouped1B
+// CHECK:         @_TMp34protocol_conformance_records_grouped8Fungible
+// CHECK:         @_TMfV34protocol_conformance_records_grouped1D
+// CHECK:       ]
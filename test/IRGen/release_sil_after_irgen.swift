@@ -0,0 +1,31 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-ir -O -module-name main %s -o %t/default.ll
+// RUN: %target-swift-frontend -emit-ir -O -module-name main %s -release-sil-after-irgen -o %t/released.ll
+// RUN: diff %t/default.ll %t/released.ll
+// RUN: FileCheck %s < %t/released.ll
+
+// Freeing the SIL of the functions as soon as they are lowered doesn't
+// change the IR: not of functions which are referenced after they are
+// emitted, nor of globals with static initializers.
+
+// CHECK: @_Tv4main6globalSi = {{.*}} 42 }>
+public let global = 42
+
+@inline(never)
+private func helper(_ x: Int) -> Int {
+  return x &* global
+}
+
+// CHECK-LABEL: define {{.*}} @_TF4main5firstFSiSi
+public func first(_ x: Int) -> Int {
+  return helper(x) &+ 1
+}
+
+// CHECK-LABEL: define {{.*}} @_TF4main6secondFSiSi
+public func second(_ x: Int) -> Int {
+  return helper(x) &+ 2
+}
+
+public class C {
+  public func method() -> Int { return helper(3) }
+}
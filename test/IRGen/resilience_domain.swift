@@ -0,0 +1,33 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -enable-resilience -resilience-domain Frameworks -module-name resilient_struct -o %t %S/../Inputs/resilient_struct.swift
+// RUN: %target-swift-frontend -I %t -emit-ir -enable-resilience -resilience-domain Frameworks %s | FileCheck %s --check-prefix=SAME
+// RUN: %target-swift-frontend -I %t -emit-ir -enable-resilience %s | FileCheck %s --check-prefix=OTHER
+
+import resilient_struct
+
+// Resilient structs from a module in our resilience domain have a fixed
+// layout, so they are copied and accessed directly. Outside of the domain
+// we have to go through their metadata and accessors.
+
+// SAME-LABEL: define{{( protected)?}} {{.*}} @_TF17resilience_domain8copySizeFV16resilient_struct4SizeS1_(
+// SAME-NOT: call %swift.type* @_TMaV16resilient_struct4Size()
+// SAME: ret
+
+// OTHER-LABEL: define{{( protected)?}} {{.*}} @_TF17resilience_domain8copySizeFV16resilient_struct4SizeS1_(
+// OTHER: call %swift.type* @_TMaV16resilient_struct4Size()
+// OTHER: ret
+public func copySize(_ s: Size) -> Size {
+  return s
+}
+
+// SAME-LABEL: define{{( protected)?}} {{.*}} @_TF17resilience_domain8getWidthFV16resilient_struct4SizeSi(
+// SAME-NOT: call {{.*}} @_TFV16resilient_struct4Sizeg1wSi(
+// SAME: ret
+
+// OTHER-LABEL: define{{( protected)?}} {{.*}} @_TF17resilience_domain8getWidthFV16resilient_struct4SizeSi(
+// OTHER: call {{.*}} @_TFV16resilient_struct4Sizeg1wSi(
+// OTHER: ret
+public func getWidth(_ s: Size) -> Int {
+  return s.w
+}
@@ -0,0 +1,44 @@
+// RUN: %target-swift-frontend %s -emit-ir -strip-unused-conformance-records | FileCheck %s
+// RUN: %target-swift-frontend %s -emit-ir | FileCheck -check-prefix=NOSTRIP %s
+
+// Conformances to internal protocols which are never used as existential
+// types don't need records: nothing can dynamically cast to them.
+
+protocol OnlyGeneric {
+  func f() -> Int
+}
+
+protocol UsedAsExistential {
+  func g() -> Int
+}
+
+public protocol Public {
+  func h() -> Int
+}
+
+struct A: OnlyGeneric, UsedAsExistential, Public {
+  func f() -> Int { return 1 }
+  func g() -> Int { return 2 }
+  func h() -> Int { return 3 }
+}
+
+func useGeneric<T: OnlyGeneric>(_ x: T) -> Int {
+  return x.f()
+}
+
+public func test(_ x: Any) -> Int {
+  var result = useGeneric(A())
+  if let e = x as? UsedAsExistential {
+    result += e.g()
+  }
+  return result
+}
+
+// CHECK-LABEL: @"\01l_protocol_conformances" = private constant [2 x
+// CHECK-NOT:     @_TMp32strip_unused_conformance_records11OnlyGeneric
+// CHECK:         @_TMp32strip_unused_conformance_records17UsedAsExistential
+// CHECK-NOT:     @_TMp32strip_unused_conformance_records11OnlyGeneric
+// CHECK:         @_TMp32strip_unused_conformance_records6Public
+// CHECK:       ]
+
+// NOSTRIP-LABEL: @"\01l_protocol_conformances" = private constant [3 x
@@ -553,5 +553,43 @@ presentEitherOr(EitherOr<(), String>.Right("foo")) // CHECK-NEXT: Right(foo)
 // CHECK-NEXT: Right(foo)
 presentEitherOrsOf(t: (), u: "foo")
 
+// Empty cases of a multi-payload enum with a one-byte payload are split
+// between the payload and the tag bytes.
+enum ManyEmpty<T, U> {
+  case Left(T), Right(U)
+  case E0, E1, E2, E3, E4, E5
+}
+
+func presentManyEmpty<T, U>(_ e: ManyEmpty<T, U>) {
+  switch e {
+  case let .Left(l): print("Left(\(l))")
+  case let .Right(r): print("Right(\(r))")
+  case .E0: print("E0")
+  case .E1: print("E1")
+  case .E2: print("E2")
+  case .E3: print("E3")
+  case .E4: print("E4")
+  case .E5: print("E5")
+  }
+}
+
+@inline(never)
+func presentManyEmptiesOf<T, U>(t: T, u: U) {
+  presentManyEmpty(ManyEmpty<T, U>.Left(t))
+  presentManyEmpty(ManyEmpty<T, U>.Right(u))
+  presentManyEmpty(ManyEmpty<T, U>.E0)
+  presentManyEmpty(ManyEmpty<T, U>.E3)
+  presentManyEmpty(ManyEmpty<T, U>.E4)
+  presentManyEmpty(ManyEmpty<T, U>.E5)
+}
+
+// CHECK-NEXT: Left(1)
+// CHECK-NEXT: Right(2)
+// CHECK-NEXT: E0
+// CHECK-NEXT: E3
+// CHECK-NEXT: E4
+// CHECK-NEXT: E5
+presentManyEmptiesOf(t: UInt8(1), u: Int8(2))
+
 // CHECK-NEXT: done
 print("done")
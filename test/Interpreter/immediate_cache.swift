@@ -0,0 +1,16 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-jit-run %s -immediate-cache-path %t/cache | FileCheck %s
+// RUN: ls %t/cache | FileCheck -check-prefix=ENTRY %s
+// RUN: %target-jit-run %s -immediate-cache-path %t/cache -Xllvm -debug-only=swift-immediate 2>&1 | FileCheck -check-prefix=REUSED %s
+// RUN: %target-jit-run %s -immediate-cache-path %t/cache | FileCheck %s
+// REQUIRES: swift_interpreter
+// REQUIRES: asserts
+
+// ENTRY: {{^[0-9a-f]+\.o$}}
+// REUSED: Reusing machine code from
+
+// CHECK: 55
+func fib(_ n: Int) -> Int {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2)
+}
+print(fib(10))
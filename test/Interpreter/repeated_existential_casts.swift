@@ -0,0 +1,77 @@
+// RUN: %target-run-simple-swift | FileCheck %s
+// REQUIRES: executable_test
+
+// Repeated casts of the same type to the same existential type are answered
+// from a cache. Make sure the cached witness tables are the right ones.
+
+protocol Named {
+  var name: String { get }
+}
+
+protocol Counted {
+  var count: Int { get }
+}
+
+class Base {}
+
+struct Apple : Named, Counted {
+  var name: String { return "apple" }
+  var count: Int { return 1 }
+}
+
+struct Pear : Named, Counted {
+  var name: String { return "pear" }
+  var count: Int { return 2 }
+}
+
+final class Plum : Base, Named {
+  var name: String { return "plum" }
+}
+
+struct Stone {}
+
+func describe(_ values: [Any]) {
+  for x in values {
+    if let nc = x as? protocol<Named, Counted> {
+      print("\(nc.name) \(nc.count)")
+    } else if let n = x as? Named {
+      print("\(n.name)")
+    } else {
+      print("none")
+    }
+  }
+}
+
+let values: [Any] = [Apple(), Pear(), Plum(), Stone()]
+
+// CHECK: apple 1
+// CHECK-NEXT: pear 2
+// CHECK-NEXT: plum
+// CHECK-NEXT: none
+describe(values)
+// CHECK-NEXT: apple 1
+// CHECK-NEXT: pear 2
+// CHECK-NEXT: plum
+// CHECK-NEXT: none
+describe(values)
+
+// Class-bounded existentials use the same cache.
+protocol ClassNamed : class {
+  var name: String { get }
+}
+extension Plum : ClassNamed {}
+
+var found = 0
+for _ in 0..<100 {
+  let b: AnyObject = Plum()
+  if let n = b as? ClassNamed {
+    if n.name == "plum" {
+      found += 1
+    }
+  }
+  if Stone() as Any is ClassNamed {
+    found -= 1000
+  }
+}
+// CHECK-NEXT: found 100
+print("found \(found)")
@@ -6,12 +6,17 @@ target triple = "x86_64-apple-macosx10.9"
 %swift.refcounted = type { %swift.heapmetadata*, i64 }
 %swift.heapmetadata = type { i64 (%swift.refcounted*)*, i64 (%swift.refcounted*)* }
 %objc_object = type opaque
+%swift.bridge = type opaque
 
 declare %objc_object* @objc_retain(%objc_object*)
 declare void @objc_release(%objc_object*)
 declare %swift.refcounted* @swift_allocObject(%swift.heapmetadata* , i64, i64) nounwind
 declare void @swift_release(%swift.refcounted* nocapture)
 declare void @swift_retain(%swift.refcounted* ) nounwind
+declare void @swift_unknownRetain(%swift.refcounted*)
+declare void @swift_unknownRelease(%swift.refcounted*)
+declare %swift.bridge* @swift_bridgeObjectRetain(%swift.bridge*)
+declare void @swift_bridgeObjectRelease(%swift.bridge*)
 declare { i64, i64, i64 } @swift_retainAndReturnThree(%swift.refcounted* , i64, i64 , i64 )
 
 ; rdar://11542743
@@ -80,5 +85,19 @@ entry:
 ; CHECK-NEXT: entry:
 ; CHECK-NEXT: ret void
 
-
-
+; trivial_alloc_eliminate_bridged - Show that unknown and bridge object
+; retains and releases of the allocated object do not block its elimination.
+define void @trivial_alloc_eliminate_bridged(i64 %x) nounwind {
+entry:
+  %0 = tail call noalias %swift.refcounted* @swift_allocObject(%swift.heapmetadata* @trivial_dtor_metadata, i64 24, i64 8) nounwind
+  %1 = bitcast %swift.refcounted* %0 to %swift.bridge*
+  %2 = tail call %swift.bridge* @swift_bridgeObjectRetain(%swift.bridge* %1)
+  tail call void @swift_unknownRetain(%swift.refcounted* %0)
+  tail call void @swift_release(%swift.refcounted* %0) nounwind
+  tail call void @swift_unknownRelease(%swift.refcounted* %0)
+  tail call void @swift_bridgeObjectRelease(%swift.bridge* %1)
+  ret void
+}
+; CHECK-LABEL: @trivial_alloc_eliminate_bridged(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: ret void
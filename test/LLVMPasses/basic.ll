@@ -126,6 +126,17 @@ entry:
   ret void
 }
 
+; CHECK-LABEL: @bridge_retain_release_null(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: ret void
+
+define void @bridge_retain_release_null() {
+entry:
+  tail call void @swift_bridgeObjectRelease(%swift.bridge* null)
+  %0 = tail call %swift.bridge* @swift_bridgeObjectRetain(%swift.bridge* null)
+  ret void
+}
+
 ; rdar://11583269 - Useless objc_retain/release optimization.
 
 ; CHECK-LABEL: @objc_retain_release_opt(
@@ -369,6 +380,26 @@ bb1:
   ret void
 }
 
+; The empty array storage of the runtime is immortal, so retaining and
+; releasing it does nothing.
+
+%swift.empty_array_storage = type { %swift.refcounted, i64, i64 }
+@_swiftEmptyArrayStorage = external global %swift.empty_array_storage
+
+; CHECK-LABEL: @retain_release_immortal(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: call void @user
+; CHECK-NEXT: ret void
+define void @retain_release_immortal() {
+entry:
+  tail call void @swift_retain(%swift.refcounted* bitcast (%swift.empty_array_storage* @_swiftEmptyArrayStorage to %swift.refcounted*))
+  tail call void @swift_unknownRetain(%swift.refcounted* bitcast (%swift.empty_array_storage* @_swiftEmptyArrayStorage to %swift.refcounted*))
+  call void @user(%swift.refcounted* bitcast (%swift.empty_array_storage* @_swiftEmptyArrayStorage to %swift.refcounted*)) nounwind
+  tail call void @swift_unknownRelease(%swift.refcounted* bitcast (%swift.empty_array_storage* @_swiftEmptyArrayStorage to %swift.refcounted*))
+  tail call void @swift_release(%swift.refcounted* bitcast (%swift.empty_array_storage* @_swiftEmptyArrayStorage to %swift.refcounted*))
+  ret void
+}
+
 
 !llvm.dbg.cu = !{!1}
 !llvm.module.flags = !{!4}
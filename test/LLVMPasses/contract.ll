@@ -505,8 +505,7 @@ bb3:
 ; CHECK-LABEL: define{{( protected)?}} %swift.bridge* @swift_contractBridgeRetainWithBridge(%swift.bridge* %A) {
 ; CHECK: bb1:
 ; CHECK-NEXT: [[RET0:%.+]] = tail call %swift.bridge* @swift_bridgeObjectRetain_n(%swift.bridge* %A, i32 2)
-; CHECK-NEXT: tail call void @swift_bridgeObjectRelease(%swift.bridge* [[RET0:%.+]])
-; CHECK-NEXT: tail call void @swift_bridgeObjectRelease(%swift.bridge* %A)
+; CHECK-NEXT: tail call void @swift_bridgeObjectRelease_n(%swift.bridge* %A, i32 2)
 ; CHECK-NEXT: ret %swift.bridge* %A
 define %swift.bridge* @swift_contractBridgeRetainWithBridge(%swift.bridge* %A) {
 bb1:
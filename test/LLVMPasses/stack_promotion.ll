@@ -1,4 +1,4 @@
-; RUN: %swift-llvm-opt -swift-stack-promotion -stack-promotion-limit=100 %s | FileCheck %s
+; RUN: %swift-llvm-opt -swift-stack-promotion -stack-promotion-limit=100 -stack-promotion-dynamic-limit=32 %s | FileCheck %s
 
 target datalayout = "e-p:64:64:64-S128-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f128:128:128-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
 target triple = "x86_64-apple-macosx10.9"
@@ -86,6 +86,27 @@ entry:
   ret void
 }
 
+; CHECK-LABEL: define{{( protected)?}} void @promote_buffer_with_runtime_size(i64 %size)
+; CHECK: [[B:%.+]] = alloca i8, i32 32, align 8
+; CHECK: [[M:%.+]] = call %swift.type* @get_buffer_metadata()
+; CHECK: [[FITS:%.+]] = icmp ule i64 %size, 32
+; CHECK: br i1 [[FITS]], label %stack.buffer, label %heap.buffer
+; CHECK: stack.buffer:
+; CHECK: [[BC:%.+]] = bitcast i8* [[B]] to %objc_object*
+; CHECK: [[I:%.+]] = call %objc_object* @swift_initStackObject(%swift.type* [[M]], %objc_object* [[BC]])
+; CHECK: heap.buffer:
+; CHECK: [[H:%.+]] = call %objc_object* @swift_bufferAllocate(%swift.type* [[M]], i64 %size, i64 7)
+; CHECK: phi %objc_object* [ [[I]], %stack.buffer ], [ [[H]], %heap.buffer ]
+; CHECK: call void @llvm.lifetime.end(i64 -1, i8* [[B]])
+; CHECK: ret void
+define void @promote_buffer_with_runtime_size(i64 %size) {
+entry:
+  %0 = call %swift.type* @get_buffer_metadata()
+  %1 = call %objc_object* @swift_bufferAllocateOnStack(%swift.type* %0, i64 %size, i64 7)
+  call void @swift_bufferDeallocateFromStack(%objc_object* %1)
+  ret void
+}
+
 declare %swift.type* @get_buffer_metadata()
 declare %objc_object* @swift_bufferAllocateOnStack(%swift.type*, i64, i64)
 declare void @swift_bufferDeallocateFromStack(%objc_object*)
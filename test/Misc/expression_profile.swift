@@ -0,0 +1,14 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -parse -debug-time-expression-type-checking -stats-output-dir %t %s 2>&1 | FileCheck -check-prefix=DUMP %s
+// RUN: cat %t/expressions-*.json | FileCheck -check-prefix=PROFILE %s
+
+// DUMP: {{[0-9.]+}}ms	{{.*}}expression_profile.swift:[[@LINE+9]]:{{[0-9]+}}-[[@LINE+9]]:{{[0-9]+}}	{{[1-9][0-9]*}} states	{{[0-9]+}} disjunctions
+
+// PROFILE: [
+// PROFILE-NEXT: {"range": "{{.*}}expression_profile.swift:[[@LINE+6]]:{{[0-9]+}}-[[@LINE+6]]:{{[0-9]+}}",
+// PROFILE-SAME: "time.ms": {{[0-9.e-]+}}
+// PROFILE-SAME: "NumDisjunctions": {{[0-9]+}}
+// PROFILE-SAME: "NumStatesExplored": {{[1-9][0-9]*}}
+// PROFILE: ]
+
+let x = 1 + 2 * 3
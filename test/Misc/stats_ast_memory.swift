@@ -0,0 +1,13 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -parse -module-name main -stats-output-dir %t %s
+// RUN: cat %t/stats-*.json | FileCheck %s
+
+// CHECK: "AST.ASTDeclBytes": {{[1-9][0-9]*}}
+// CHECK: "AST.ASTTypeBytes": {{[1-9][0-9]*}}
+// CHECK: "AST.ASTExprBytes": {{[1-9][0-9]*}}
+// CHECK: "AST.ASTDeserializedBytes": {{[1-9][0-9]*}}
+// CHECK: "AST.ASTConstraintSolverBytes": {{[1-9][0-9]*}}
+
+public func foo() -> Int {
+  return [1, 2, 3].map { $0 * 2 }.reduce(0, +)
+}
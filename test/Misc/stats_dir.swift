@@ -0,0 +1,28 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c -o %t/main.o -module-name main -stats-output-dir %t %s
+// RUN: cat %t/stats-*.json | FileCheck %s
+
+// The driver passes the directory on to each frontend job.
+// RUN: rm -rf %t/driver && mkdir -p %t/driver
+// RUN: %target-swiftc_driver -c -o %t/driver/main.o -module-name main -stats-output-dir %t/driver %s
+// RUN: cat %t/driver/stats-*.json | FileCheck %s
+
+// CHECK: {
+// CHECK: "AST.NumSourceBuffers": {{[1-9][0-9]*}}
+// CHECK: "AST.NumDeclsDeserialized": {{[1-9][0-9]*}}
+// CHECK: "Sema.NumSolutionAttempts": {{[1-9][0-9]*}}
+// CHECK: "SILModule.NumSILGenFunctions": {{[1-9][0-9]*}}
+// CHECK: "SILModule.NumSILOptFunctions": {{[1-9][0-9]*}}
+// CHECK: "SILModule.SILPeakInstructionBytes": {{[1-9][0-9]*}}
+// CHECK: "SILModule.NumSILDebugScopes": {{[1-9][0-9]*}}
+// CHECK: "SILModule.NumTypeLoweringsComputed": {{[1-9][0-9]*}}
+// CHECK: "SILModule.NumTypeLoweringCacheHits": {{[1-9][0-9]*}}
+// CHECK: "IRModule.NumIRFunctions": {{[1-9][0-9]*}}
+// CHECK: "time.swift.IRGen.wall": {{[0-9.e-]+}}
+// CHECK: "time.swift.Parsing.wall": {{[0-9.e-]+}}
+// CHECK: "time.swift.SILGen.wall": {{[0-9.e-]+}}
+// CHECK: }
+
+public func foo() -> Int {
+  return [1, 2, 3].map { $0 * 2 }.reduce(0, +)
+}
@@ -0,0 +1,21 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c -O -o %t/main.o -module-name main -stats-output-dir %t -sil-pass-stats-per-function %s
+// RUN: cat %t/stats-*.json | FileCheck %s
+// RUN: cat %t/sil-pass-functions-*.json | FileCheck -check-prefix=FUNCTIONS %s
+
+// CHECK: {
+// CHECK: "sil-pass.{{[^"]+}}.runs": {{[1-9][0-9]*}}
+// CHECK-NEXT: "sil-pass.{{[^"]+}}.wall": {{[0-9.e-]+}}
+// CHECK-NEXT: "sil-pass.{{[^"]+}}.instructions-added": {{[0-9]+}}
+// CHECK-NEXT: "sil-pass.{{[^"]+}}.instructions-removed": {{[0-9]+}}
+// CHECK-NEXT: "sil-pass.{{[^"]+}}.invalidations": {{[0-9]+}}
+// CHECK-NEXT: "sil-pass.{{[^"]+}}.peak-instruction-bytes-growth": {{[0-9]+}}
+// CHECK: }
+
+// FUNCTIONS: [
+// FUNCTIONS: {"pass": "{{[^"]+}}", "function": "_TF4main3fooFT_Si", "runs": {{[1-9][0-9]*}}, "wall": {{[0-9.e-]+}}, "instructions-added": {{[0-9]+}}, "instructions-removed": {{[0-9]+}}, "invalidations": {{[0-9]+}}, "peak-instruction-bytes-growth": {{[0-9]+}}}
+// FUNCTIONS: ]
+
+public func foo() -> Int {
+  return [1, 2, 3].map { $0 * 2 }.reduce(0, +)
+}
@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c -O -o %t/main.o -module-name main -stats-output-dir %t -trace-stats-events %s
+// RUN: cat %t/trace-*.json | FileCheck %s
+
+// The driver merges the traces of its jobs into one.
+// RUN: rm -rf %t/driver && mkdir -p %t/driver
+// RUN: %target-swiftc_driver -c -o %t/driver/main.o -module-name main -stats-output-dir %t/driver -trace-stats-events %s
+// RUN: cat %t/driver/driver-trace-*.json | FileCheck -check-prefix=DRIVER %s
+
+// CHECK: [
+// CHECK-NEXT: {"name": "process_name", "ph": "M", "pid": [[PID:[0-9]+]], "args": {"name": "swift-frontend {{.*}}"}}
+// CHECK-DAG: {"cat": "import", "name": "Swift", "ph": "X", "ts": {{[0-9]+}}, "dur": {{[0-9]+}}, "pid": [[PID]], "tid": 0}
+// CHECK-DAG: {"cat": "type-check-body", "name": "foo()", {{.*}}"args": {"detail": "global function"}}
+// CHECK-DAG: {"cat": "sil-pass", {{.*}}"args": {"detail": "_TF4main3fooFT_Si"}}
+// CHECK-DAG: {"cat": "phase", "name": "SILGen", "ph": "X"
+// CHECK-DAG: {"cat": "silgen-file", "name": "stats_dir_trace.swift", "ph": "X"
+// CHECK-DAG: {"cat": "phase", "name": "IRGen", "ph": "X"
+// CHECK: ]
+
+// DRIVER: [
+// DRIVER-NEXT: {"name": "process_name", "ph": "M", "pid": {{[0-9]+}}, "args": {"name": "swift-driver"}}
+// DRIVER-NEXT: {"cat": "job", "name": "compile", "ph": "X", {{.*}}"tid": 0, "args": {"detail": "main.o"}}
+// DRIVER-NEXT: {"name": "process_name", "ph": "M", "pid": {{[0-9]+}}, "args": {"name": "swift-frontend {{.*}}"}}
+// DRIVER: {"cat": "phase", "name": "Parsing"
+// DRIVER: ]
+
+public func foo() -> Int {
+  return [1, 2, 3].map { $0 * 2 }.reduce(0, +)
+}
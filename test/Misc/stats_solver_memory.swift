@@ -0,0 +1,14 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -parse -module-name main -stats-output-dir %t %s
+// RUN: cat %t/stats-*.json | FileCheck %s
+
+// CHECK: "Sema.ConstraintSolverPeakBytes": {{[1-9][0-9]*}}
+
+// The body of the closure is type-checked while the constraint system of
+// the call is still alive.
+public func foo() -> [Int] {
+  return [1, 2, 3].map { x in
+    let y = x * 2
+    return y + 1
+  }
+}
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -parse -stats-output-dir %t %s
+// RUN: cat %t/stats-*.json | FileCheck %s
+
+// Repeated unqualified lookups of the same names at module scope reuse the
+// results of the first lookup instead of walking the imports again.
+
+// CHECK: "AST.NumModuleScopeLookups": {{[1-9][0-9]*}}
+// CHECK: "AST.NumModuleScopeLookupCacheHits": {{[1-9][0-9]*}}
+
+func twice(_ x: Int) -> Int {
+  return max(x, min(x, 2)) + max(x, min(x, 3))
+}
+
+func thrice(_ x: Int) -> Int {
+  return max(x, min(x, 2)) + max(x, min(x, 3)) + max(x, 4)
+}
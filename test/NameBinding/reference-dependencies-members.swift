@@ -10,6 +10,7 @@
 // RUN: FileCheck -check-prefix=DEPENDS-NOMINAL-NEGATIVE %s < %t.swiftdeps
 // RUN: FileCheck -check-prefix=DEPENDS-MEMBER %s < %t.swiftdeps
 // RUN: FileCheck -check-prefix=DEPENDS-MEMBER-NEGATIVE %s < %t.swiftdeps
+// RUN: FileCheck -check-prefix=FINGERPRINTS %s < %t.swiftdeps
 
 
 // PROVIDES-NOMINAL-LABEL: {{^provides-nominal:$}}
@@ -20,11 +21,14 @@
 // DEPENDS-NOMINAL-NEGATIVE-LABEL: {{^depends-nominal:$}}
 // DEPENDS-MEMBER-LABEL: {{^depends-member:$}}
 // DEPENDS-MEMBER-NEGATIVE-LABEL: {{^depends-member:$}}
+// FINGERPRINTS-LABEL: {{^fingerprints-nominal:$}}
 
 // PROVIDES-NOMINAL-DAG: 4Base"
+// FINGERPRINTS-DAG: - ["{{.+}}4Base", "{{[0-9a-f]+}}"]
 class Base {
   // PROVIDES-MEMBER-DAG: - ["{{.+}}4Base", ""]
-  // PROVIDES-MEMBER-NEGATIVE-NOT: - ["{{.+}}4Base", "{{.+}}"]
+  // PROVIDES-MEMBER-DAG: - ["{{.+}}4Base", "foo"]
+  // FINGERPRINTS-DAG: - ["{{.+}}4Base", "foo", "{{[0-9a-f]+}}"]
   func foo() {}
 }
   
@@ -32,7 +36,7 @@ class Base {
 // DEPENDS-NOMINAL-DAG: 9OtherBase"
 class Sub : OtherBase {
   // PROVIDES-MEMBER-DAG: - ["{{.+}}3Sub", ""]
-  // PROVIDES-MEMBER-NEGATIVE-NOT: - ["{{.+}}3Sub", "{{.+}}"]
+  // PROVIDES-MEMBER-DAG: - ["{{.+}}3Sub", "foo"]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}9OtherBase", ""]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}9OtherBase", "foo"]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}9OtherBase", "init"]
@@ -58,6 +62,7 @@ extension OtherStruct {
   // PROVIDES-MEMBER-DAG: - ["{{.+}}11OtherStruct", "foo"]
   // PROVIDES-MEMBER-DAG: - ["{{.+}}11OtherStruct", "bar"]
   // PROVIDES-MEMBER-NEGATIVE-NOT: "baz"
+  // FINGERPRINTS-DAG: - ["{{.+}}11OtherStruct", "bar", "{{[0-9a-f]+}}"]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}11OtherStruct", "foo"]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}11OtherStruct", "bar"]
   // DEPENDS-MEMBER-DAG: - !private ["{{.+}}11OtherStruct", "baz"]
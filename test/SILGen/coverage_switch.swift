@@ -7,7 +7,7 @@ func f1(_ x : Int32) {
     break
   case 2: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:16 : 3
     fallthrough
-  default: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:14 : (3 + 4)
+  default: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:14 : (1 - 2)
     f1(x - 1)
   } // CHECK: [[@LINE]]:4 -> [[@LINE+3]]:2 : 1
 
@@ -35,7 +35,7 @@ func f2(_ x : Algebraic) -> Int32 {
     if (false) { // CHECK: [[@LINE]]:16 -> [[@LINE+2]]:6 : 5
       fallthrough
     }
-  case .Type4: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : (5 + 6)
+  case .Type4: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : ((((1 + 5) - 2) - 3) - 4)
     break
   } // CHECK: [[@LINE]]:4 -> [[@LINE+1]]:11 : 1
   return 0
@@ -50,7 +50,7 @@ func f3(_ x : Simple) -> Int32 {
   switch (x) {
   case .First: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:13 : 2
     return 1
-  case .Second: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : 3
+  case .Second: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : (1 - 2)
     break
   } // CHECK: [[@LINE]]:4 -> [[@LINE+2]]:11 : 1
 
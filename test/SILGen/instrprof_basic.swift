@@ -61,3 +61,26 @@ func exceptions() {
 
   // CHECK-NOT: builtin "int_instrprof_increment"
 }
+
+// The count of the last case of a switch is derived from the other counters.
+// CHECK: sil hidden @[[F_SWITCHES:.*switches.*]] :
+// CHECK: %[[NAME:.*]] = string_literal utf8 "{{.*}}instrprof_basic.swift:[[F_SWITCHES]]"
+// CHECK: %[[HASH:.*]] = integer_literal $Builtin.Int64,
+// CHECK: %[[NCOUNTS:.*]] = integer_literal $Builtin.Int32, 4
+// CHECK: %[[INDEX:.*]] = integer_literal $Builtin.Int32, 0
+// CHECK: builtin "int_instrprof_increment"(%[[NAME]] : {{.*}}, %[[HASH]] : {{.*}}, %[[NCOUNTS]] : {{.*}}, %[[INDEX]] : {{.*}})
+func switches(a : Int32) {
+  // CHECK: builtin "int_instrprof_increment"
+  switch a {
+  // CHECK: builtin "int_instrprof_increment"
+  case 0:
+    break
+  // CHECK: builtin "int_instrprof_increment"
+  case 1:
+    break
+  default:
+    break
+  }
+
+  // CHECK-NOT: builtin "int_instrprof_increment"
+}
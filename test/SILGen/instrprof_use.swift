@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %llvm-profdata merge %S/Inputs/instrprof_use.proftext -o %t/main.profdata
+// RUN: %target-swift-frontend -parse-as-library -emit-silgen -module-name main -profile-use=%t/main.profdata %s | FileCheck %s
+
+// RUN: not %target-swift-frontend -parse-as-library -emit-silgen -module-name main -profile-use=%t/missing.profdata %s 2>&1 | FileCheck -check-prefix=MISSING %s
+// MISSING: error: failed to load profile data '{{.*}}missing.profdata'
+
+// CHECK: // Entry count: 1000
+// CHECK-NEXT: sil @_TF4main7processFSiSi
+// CHECK: bb0(%0 : $Int):{{ +}}// Count: 1000
+// CHECK: cond_br {{%[0-9]+}}, [[THEN:bb[0-9]+]], [[ELSE:bb[0-9]+]]
+// CHECK: [[THEN]]:{{ +}}// Preds: bb0 // Count: 0
+public func process(_ x: Int) -> Int {
+  if x < 0 {
+    return 0
+  }
+  return x + 1
+}
+
+// Functions which are not in the profile don't get counts.
+// CHECK-NOT: // Entry count:
+// CHECK-LABEL: sil @_TF4main10unprofiledFSiSi
+// CHECK-NOT: // Count:
+public func unprofiled(_ x: Int) -> Int {
+  if x < 0 {
+    return 0
+  }
+  return x + 1
+}
@@ -0,0 +1,54 @@
+// RUN: %target-swift-frontend -emit-silgen %s | FileCheck %s
+
+func a() {}
+func b() {}
+func c() {}
+func d() {}
+func e() {}
+func f() {}
+
+func isReady() -> Bool { return true }
+
+// A switch with enough string literal cases looks up the matching case once
+// and compares integers instead of calling '~=' for every case. A literal
+// which appears twice gets one number.
+// CHECK-LABEL: sil hidden @_TF13switch_string7keywordFSST_
+func keyword(_ s: String) {
+  // CHECK: [[TABLE:%.*]] = string_literal utf8 "\u{03}let\u{03}var\u{04}func\u{06}struct"
+  // CHECK: [[LENGTH:%.*]] = integer_literal $Builtin.Word, 20
+  // CHECK: function_ref Swift._findStringSwitchCase
+  // CHECK-NEXT: [[FIND:%.*]] = function_ref
+  // CHECK: [[NUMBER:%.*]] = apply [[FIND]]({{%.*}}, [[TABLE]], [[LENGTH]])
+  // CHECK-NOT: ~=
+  switch s {
+  // CHECK: [[ZERO:%.*]] = integer_literal $Builtin.Word, 0
+  // CHECK: builtin "cmp_eq_Word"([[NUMBER]] : $Builtin.Word, [[ZERO]] : $Builtin.Word)
+  case "let" where isReady():
+    a()
+  case "var", "func":
+    b()
+  // CHECK: [[ZERO:%.*]] = integer_literal $Builtin.Word, 0
+  // CHECK: builtin "cmp_eq_Word"([[NUMBER]] : $Builtin.Word, [[ZERO]] : $Builtin.Word)
+  case "let":
+    c()
+  case "struct":
+    d()
+  default:
+    e()
+  }
+}
+
+// Switches with few string literal cases call '~='.
+// CHECK-LABEL: sil hidden @_TF13switch_string5smallFSST_
+func small(_ s: String) {
+  // CHECK-NOT: _findStringSwitchCase
+  // CHECK: function_ref static Swift.~= infix
+  switch s {
+  case "let":
+    a()
+  case "var":
+    b()
+  default:
+    f()
+  }
+}
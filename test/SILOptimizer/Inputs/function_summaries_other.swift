@@ -0,0 +1,10 @@
+public func computeValue(_ x: Int) -> Int {
+  return x &* 3 &+ 1
+}
+
+public var counter = 0
+
+public func bumpCounter(_ x: Int) -> Int {
+  counter = counter &+ x
+  return counter
+}
@@ -0,0 +1,17 @@
+public var counter = 0
+
+public func smallFunction(_ x: Int) -> Int {
+  return x &+ 1
+}
+
+public func largeFunction(_ x: Int) -> Int {
+  counter = counter &+ x
+  counter = counter &* 3
+  counter = counter &- x
+  counter = counter &* 5
+  counter = counter &+ x
+  counter = counter &* 7
+  counter = counter &- x
+  counter = counter &* 11
+  return counter
+}
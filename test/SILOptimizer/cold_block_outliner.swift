@@ -0,0 +1,31 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %llvm-profdata merge %S/Inputs/cold_block_outliner.proftext -o %t/main.profdata
+// RUN: %target-swift-frontend -O -emit-sil -module-name main -profile-use=%t/main.profdata -Xllvm -sil-cold-region-min-size=1 %s | FileCheck %s
+
+// The path which was never executed in the profiled run is moved out of the
+// function.
+
+// CHECK: // Entry count: 1000
+// CHECK-NEXT: sil @_TF4main7processFSiSi
+// CHECK: [[F:%[0-9]+]] = function_ref @_TF4main7processFSiSi_cold0
+// CHECK: apply [[F]](
+// CHECK-NEXT: unreachable
+
+// CHECK: // Entry count: 0
+// CHECK-NEXT: sil private [noinline] @_TF4main7processFSiSi_cold0
+// CHECK: function_ref @_TF4main6reportFSiT_
+// CHECK: unreachable
+
+@inline(never)
+public func report(_ x: Int) {
+  print(x)
+}
+
+public func process(_ x: Int) -> Int {
+  if x < 0 {
+    report(x)
+    report(-x)
+    fatalError()
+  }
+  return x &+ 1
+}
@@ -0,0 +1,85 @@
+// RUN: %target-swift-frontend %s -parse-as-library -O -emit-sil -module-name main -receiver-profile-use=%S/Inputs/devirt_speculate_profile.txt | FileCheck %s
+// RUN: %target-swift-frontend %s -parse-as-library -O -emit-sil -module-name main -receiver-profile-use=%S/Inputs/devirt_speculate_profile.txt -Xllvm -sil-speculative-devirt-hot-only | FileCheck -check-prefix=CHECK-HOT-ONLY %s
+// RUN: not %target-swift-frontend %s -parse-as-library -O -emit-sil -module-name main -receiver-profile-use=%t.missing 2>&1 | FileCheck -check-prefix=CHECK-MISSING %s
+//
+// Test speculative devirtualization with a receiver profile.
+
+// CHECK-MISSING: error: failed to load profile data '{{.*}}.missing'
+
+public class Base {
+  public init() {}
+  public func foo() {}
+}
+class Sub1 : Base {
+  override func foo() {}
+}
+class Sub2 : Base {
+  override func foo() {}
+}
+class Sub3 : Base {
+  override func foo() {}
+}
+class Sub4 : Base {
+  override func foo() {}
+}
+class Sub5 : Base {
+  override func foo() {}
+}
+class Sub6 : Base {
+  override func foo() {}
+}
+class Sub7 : Base {
+  override func foo() {}
+}
+
+// Only the sampled subclasses are checked, the most frequent one first, even
+// if it is beyond the limit of speculative targets.
+// CHECK-LABEL: sil @_TF4main16testSampledClassFCS_4BaseT_
+// CHECK: checked_cast_br [exact] %0 : $Base to $Sub7
+// CHECK: checked_cast_br [exact] %0 : $Base to $Sub2
+// CHECK-NOT: checked_cast_br
+// CHECK: class_method %0 : $Base, #Base.foo!1
+// CHECK: {{^}$}}
+
+// CHECK-HOT-ONLY-LABEL: sil @_TF4main16testSampledClassFCS_4BaseT_
+// CHECK-HOT-ONLY-NOT: checked_cast_br
+// CHECK-HOT-ONLY: {{^}$}}
+public func testSampledClass(_ b: Base) {
+  b.foo()
+}
+
+protocol Shape {
+  func area() -> Double
+}
+
+struct Square : Shape {
+  var side: Double
+  func area() -> Double { return side * side }
+}
+
+struct Circle : Shape {
+  var radius: Double
+  func area() -> Double { return 3 * radius * radius }
+}
+
+// The witness_method call on the existential is speculated for the sampled
+// conforming type.
+// CHECK-LABEL: sil hidden [noinline] @_TF4main18testSampledWitnessFPS_5Shape_Sd
+// CHECK: [[OPENED:%.*]] = open_existential_addr %0
+// CHECK: [[META:%.*]] = value_metatype $@thick (@opened({{.*}}) Shape).Type, [[OPENED]]
+// CHECK: checked_cast_br [[META]] : $@thick (@opened({{.*}}) Shape).Type to $@thick Circle.Type
+// CHECK-NOT: checked_cast_br
+// CHECK: witness_method $@opened({{.*}}) Shape, #Shape.area!1
+// CHECK: {{^}$}}
+
+// CHECK-HOT-ONLY-LABEL: sil hidden [noinline] @_TF4main18testSampledWitnessFPS_5Shape_Sd
+// CHECK-HOT-ONLY-NOT: checked_cast_br
+// CHECK-HOT-ONLY: {{^}$}}
+@inline(never)
+func testSampledWitness(_ s: Shape) -> Double {
+  return s.area()
+}
+
+public func callTestSampledWitness() -> Double {
+  return testSampledWitness(Circle(radius: 1))
+}
@@ -0,0 +1,33 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend -O -parse-as-library -module-name FunctionSummariesOther %S/Inputs/function_summaries_other.swift -emit-module-path %t/FunctionSummariesOther.swiftmodule
+// RUN: %target-swift-frontend -O -parse-as-library -I %t -emit-sil %s | FileCheck %s
+
+// The bodies of the called functions are not serialized. But the module
+// contains their summaries, which tell that computeValue doesn't write
+// memory, while bumpCounter writes global memory.
+
+import FunctionSummariesOther
+
+// CHECK-LABEL: sil [noinline] @{{.*}}loadAcrossPureCall
+// CHECK: load
+// CHECK: apply
+// CHECK-NOT: load
+// CHECK: return
+@inline(never)
+public func loadAcrossPureCall(_ p: UnsafeMutablePointer<Int>) -> Int {
+  let x = p.pointee
+  let y = computeValue(x)
+  return p.pointee &+ y
+}
+
+// CHECK-LABEL: sil [noinline] @{{.*}}loadAcrossWritingCall
+// CHECK: load
+// CHECK: apply
+// CHECK: load
+// CHECK: return
+@inline(never)
+public func loadAcrossWritingCall(_ p: UnsafeMutablePointer<Int>) -> Int {
+  let x = p.pointee
+  let y = bumpCounter(x)
+  return p.pointee &+ y
+}
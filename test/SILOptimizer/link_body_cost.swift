@@ -0,0 +1,21 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend -O -parse-as-library -sil-serialize-all -module-name LinkBodyCostOther %S/Inputs/link_body_cost_other.swift -emit-module-path %t/LinkBodyCostOther.swiftmodule
+// RUN: %target-swift-frontend -O -I %t -sil-debug-serialization -Xllvm -sil-link-body-cost-limit=10 -emit-sil %s | FileCheck %s
+// RUN: %target-swift-frontend -O -I %t -sil-debug-serialization -Xllvm -sil-link-body-cost-limit=0 -emit-sil %s | FileCheck %s -check-prefix=NOLIMIT
+
+// The function summaries in the module tell the SIL linker how large the
+// serialized bodies are. The body of largeFunction exceeds the limit, so it
+// is never deserialized.
+
+import LinkBodyCostOther
+
+// CHECK-DAG: sil public_external [fragile] @{{.*}}smallFunction{{.*}} : $@convention(thin) (Int) -> Int {
+// CHECK-DAG: sil {{.*}}@{{.*}}largeFunction{{.*}} : $@convention(thin) (Int) -> Int{{$}}
+
+// NOLIMIT-DAG: sil public_external [fragile] @{{.*}}smallFunction{{.*}} : $@convention(thin) (Int) -> Int {
+// NOLIMIT-DAG: sil public_external [fragile] @{{.*}}largeFunction{{.*}} : $@convention(thin) (Int) -> Int {
+
+@inline(never)
+public func callBoth(_ x: Int) -> Int {
+  return smallFunction(x) &+ largeFunction(x)
+}
@@ -0,0 +1,13 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c -O -o %t/main.o -module-name main -stats-output-dir %t %s
+// RUN: cat %t/stats-*.json | FileCheck %s
+
+// Function passes which are scheduled again on a function they have already
+// processed, without any change in between, are not run again.
+
+// CHECK: "SILOptimizer.NumSILFunctionPassRuns": {{[1-9][0-9]*}}
+// CHECK: "SILOptimizer.NumSILFunctionPassRunsSkipped": {{[1-9][0-9]*}}
+
+public func compute(_ values: [Int]) -> Int {
+  return values.map { $0 * 2 }.reduce(0, +)
+}
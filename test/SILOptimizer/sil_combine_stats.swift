@@ -0,0 +1,14 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c -O -o %t/main.o -module-name main -stats-output-dir %t %s
+// RUN: cat %t/stats-*.json | FileCheck %s
+
+// SILCombine reports how many instructions it visits, and how many of them
+// it changes.
+
+// CHECK: "SILOptimizer.NumSILCombineIterations": {{[1-9][0-9]*}}
+// CHECK: "SILOptimizer.NumSILCombineInstructionsVisited": {{[1-9][0-9]*}}
+// CHECK: "SILOptimizer.NumSILCombineInstructionsChanged": {{[1-9][0-9]*}}
+
+public func compute(_ values: [Int]) -> Int {
+  return values.map { $0 * 2 }.reduce(0, +)
+}
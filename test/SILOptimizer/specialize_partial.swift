@@ -0,0 +1,44 @@
+// RUN: %target-swift-frontend -O -emit-sil -module-name main -Xllvm -sil-partial-specialization %s | FileCheck -check-prefix=CHECK-CALLER %s
+// RUN: %target-swift-frontend -O -emit-sil -module-name main -Xllvm -sil-partial-specialization %s | FileCheck -check-prefix=CHECK-SPEC %s
+// RUN: %target-swift-frontend -O -emit-sil -module-name main %s | FileCheck -check-prefix=CHECK-NOPARTIAL %s
+
+public protocol Codec {
+  func encode(_ x: Int) -> Int
+}
+
+public protocol Sink {
+  func put(_ x: Int)
+}
+
+public struct DoubleCodec : Codec {
+  public init() {}
+  public func encode(_ x: Int) -> Int { return x &* 2 }
+}
+
+@inline(never)
+func process<T : Codec, S : Sink>(_ codec: T, _ sink: S, _ x: Int) {
+  sink.put(codec.encode(x))
+}
+
+// The codec is known at the call site, but the sink isn't. The call goes to
+// a partial specialization which is still generic over the sink.
+
+// CHECK-CALLER-LABEL: sil [noinline] @_TF4main3run
+// CHECK-CALLER: [[F:%[0-9]+]] = function_ref @_TTSp5{{[^ ]*}}_TF4main7process
+// CHECK-CALLER: apply [[F]]<
+// CHECK-CALLER: return
+
+// CHECK-SPEC-LABEL: sil shared [noinline] @_TTSp5{{[^ ]*}}_TF4main7process{{[^ ]*}} : $@convention(thin) <τ_0_0 where τ_0_0 : Sink>
+// CHECK-SPEC-NOT: #Codec.encode
+// CHECK-SPEC: witness_method $S, #Sink.put
+// CHECK-SPEC: return
+
+// Partial specialization is off by default.
+
+// CHECK-NOPARTIAL-LABEL: sil [noinline] @_TF4main3run
+// CHECK-NOPARTIAL: function_ref @_TF4main7process
+// CHECK-NOPARTIAL: return
+@inline(never)
+public func run<S : Sink>(_ sink: S, _ x: Int) {
+  process(DoubleCodec(), sink, x)
+}
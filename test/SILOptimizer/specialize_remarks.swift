@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -O -emit-sil -module-name main -specialization-remarks-path %t/remarks.json %s -o /dev/null
+// RUN: FileCheck %s < %t/remarks.json
+// RUN: %target-swift-frontend -O -emit-sil -module-name main -specialization-remarks-path %t/budget.json -Xllvm -sil-specialization-small-size=0 -Xllvm -sil-specialization-budget=1 %s | FileCheck -check-prefix=CHECK-BUDGET-SIL %s
+// RUN: FileCheck -check-prefix=CHECK-BUDGET %s < %t/budget.json
+
+// Every decision of the generic specializer is recorded as one JSON object
+// per line.
+
+// CHECK: {"pass":"generic-specializer","decision":"created","caller":"_TF4main6callEqFSiSb","callee":"_TF4main9genericEq{{[^"]*}}","specialization":"_TTSg5Si{{[^"]*}}_TF4main9genericEq{{[^"]*}}","size":{{[1-9][0-9]*}},"generic-insts":{{[1-9][0-9]*}},"frequency":1}
+
+// A specialization which exceeds the budget of the module is rejected and the
+// call stays generic.
+
+// CHECK-BUDGET: {"pass":"generic-specializer","decision":"rejected","reason":"budget exhausted","caller":"_TF4main6callEqFSiSb","callee":"_TF4main9genericEq{{[^"]*}}",
+// CHECK-BUDGET-NOT: "decision":"created"
+
+// CHECK-BUDGET-SIL-LABEL: sil @_TF4main6callEqFSiSb
+// CHECK-BUDGET-SIL: function_ref @_TF4main9genericEq
+// CHECK-BUDGET-SIL: return
+
+@inline(never)
+func genericEq<T : Equatable>(_ a: T, _ b: T) -> Bool {
+  return a == b
+}
+
+public func callEq(_ x: Int) -> Bool {
+  return genericEq(x, x + 1)
+}
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -parse -stats-output-dir %t %s
+// RUN: cat %t/stats-*.json | FileCheck %s
+
+// Resolving the superclass and the inherited protocols goes through the
+// iterative type checker, which counts how many requests it had to evaluate
+// and how many were already satisfied.
+
+// CHECK: "Sema.NumTypeCheckRequestsEvaluated": {{[1-9][0-9]*}}
+// CHECK: "Sema.NumTypeCheckRequestsCached": {{[1-9][0-9]*}}
+
+protocol P {}
+protocol Q : P {}
+
+class Base {}
+class Derived : Base, Q {}
+class MoreDerived : Derived {}
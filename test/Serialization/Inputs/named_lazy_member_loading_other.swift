@@ -0,0 +1,27 @@
+public struct Big {
+  public init() {}
+  public func used() -> Int { return 1 }
+  public func unused1() -> Int { return 2 }
+  public func unused2() -> Int { return 3 }
+  public var unusedProperty: Int { return 4 }
+}
+
+extension Big {
+  public func usedFromExtension(_ x: Int) -> Int { return x }
+  public func unused3() {}
+}
+
+public class Base {
+  public init() {}
+  public func overloaded(_ x: Int) -> Int { return x }
+  public func unused4() {}
+}
+
+extension Base {
+  public func overloaded(_ x: String) -> String { return x }
+}
+
+public enum Choice {
+  case first
+  case second
+}
@@ -0,0 +1,31 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -module-name main -o %t/main.swiftmodule %s
+// RUN: llvm-bcanalyzer -dump %t/main.swiftmodule | grep INTERFACE_HASH > %t/original.txt
+// RUN: FileCheck %s < %t/original.txt
+
+// RUN: %target-swift-frontend -emit-module -module-name main -o %t/main.swiftmodule %s -D CHANGE_BODY
+// RUN: llvm-bcanalyzer -dump %t/main.swiftmodule | grep INTERFACE_HASH > %t/body.txt
+// RUN: diff %t/original.txt %t/body.txt
+
+// RUN: %target-swift-frontend -emit-module -module-name main -o %t/main.swiftmodule %s -D CHANGE_INTERFACE
+// RUN: llvm-bcanalyzer -dump %t/main.swiftmodule | grep INTERFACE_HASH > %t/interface.txt
+// RUN: not diff %t/original.txt %t/interface.txt
+
+// Merging a partial module keeps its interface hash.
+// RUN: %target-swift-frontend -emit-module -module-name main -o %t/merged.swiftmodule %t/main.swiftmodule
+// RUN: llvm-bcanalyzer -dump %t/merged.swiftmodule | grep INTERFACE_HASH > %t/merged.txt
+// RUN: FileCheck %s < %t/merged.txt
+
+// CHECK: <INTERFACE_HASH abbrevid={{[0-9]+}}/> blob data = '{{[0-9a-f]+}}'
+
+public func foo() -> Int {
+#if CHANGE_BODY
+  return 1
+#else
+  return 0
+#endif
+}
+
+#if CHANGE_INTERFACE
+public func bar() {}
+#endif
@@ -0,0 +1,21 @@
+// RUN: rm -rf %t && mkdir -p %t %t/stats
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/named_lazy_member_loading_other.swift
+// RUN: %target-swift-frontend -parse -I %t %s -enable-named-lazy-member-loading -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-*.json | FileCheck %s
+
+// Without the flag the lookups still work, by loading all members.
+// RUN: %target-swift-frontend -parse -I %t %s
+
+// CHECK: "AST.NumNamedMemberLoads": {{[1-9][0-9]*}}
+
+import named_lazy_member_loading_other
+
+func test(_ base: Base) -> Int {
+  let big = Big()
+  let fromType: Int = big.used() + big.usedFromExtension(1)
+  let fromExtension: String = base.overloaded("one")
+  let choice = Choice.second
+  _ = choice
+  _ = fromExtension
+  return fromType + base.overloaded(2)
+}
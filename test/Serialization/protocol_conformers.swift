@@ -0,0 +1,18 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -o %t -module-name Conformers %s
+// RUN: llvm-bcanalyzer %t/Conformers.swiftmodule | FileCheck %s
+
+// CHECK-NOT: UnknownCode
+// CHECK: <PROTOCOL_CONFORMERS
+
+public protocol Shape {}
+
+public struct Square : Shape {}
+
+public struct Outer {
+  public struct Inner : Shape {}
+}
+
+public class Circle {}
+extension Circle : Shape {}
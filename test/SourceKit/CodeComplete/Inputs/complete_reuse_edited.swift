@@ -0,0 +1,12 @@
+struct Point {
+  var x: Int
+  var y: Int
+}
+
+func test(_ p: Point) {
+  p.x
+}
+
+extension Point {
+  var z: Int { return 0 }
+}
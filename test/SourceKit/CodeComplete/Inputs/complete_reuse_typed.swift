@@ -0,0 +1,8 @@
+struct Point {
+  var x: Int
+  var y: Int
+}
+
+func test(_ p: Point) {
+  p.x
+}
@@ -0,0 +1,28 @@
+// The second request only types the identifier after the completion point,
+// and reuses the completions of the first one. The third one changes the
+// buffer after that identifier, and completes again.
+
+// RUN: %sourcekitd-test \
+// RUN:     -req=complete -pos=7:5 %S/Inputs/complete_reuse.swift \
+// RUN:       -- %S/Inputs/complete_reuse.swift == \
+// RUN:     -req=complete -pos=7:5 \
+// RUN:       -text-input %S/Inputs/complete_reuse_typed.swift \
+// RUN:       %S/Inputs/complete_reuse.swift \
+// RUN:       -- %S/Inputs/complete_reuse.swift == \
+// RUN:     -req=complete -pos=7:5 \
+// RUN:       -text-input %S/Inputs/complete_reuse_edited.swift \
+// RUN:       %S/Inputs/complete_reuse.swift \
+// RUN:       -- %S/Inputs/complete_reuse.swift | FileCheck %s
+
+// CHECK:     key.results: [
+// CHECK:     key.name: "x"
+// CHECK:     key.name: "y"
+// CHECK-NOT: key.name: "z"
+// CHECK:     key.results: [
+// CHECK:     key.name: "x"
+// CHECK:     key.name: "y"
+// CHECK-NOT: key.name: "z"
+// CHECK:     key.results: [
+// CHECK:     key.name: "x"
+// CHECK:     key.name: "y"
+// CHECK:     key.name: "z"
@@ -46,3 +46,31 @@ func test(x: X) {
 // ONE_GROUP: key.kind: source.lang.swift.codecomplete.group,
 // ONE_GROUP-NEXT: key.name: "aaa"
 // ONE_GROUP-NOT: key.name: "aaa"
+
+struct Y {
+  func abcd() {}
+  func abxy() {}
+  func axbxcx() {}
+}
+func test2(y: Y) {
+  y.
+}
+
+// Refining the filter text gives the same results as filtering from scratch.
+// RUN: %sourcekitd-test -req=complete.open -pos=56:5 -req-opts=filtertext=ab %s -- %s > %t.ab
+// RUN: %sourcekitd-test -req=complete.open -pos=56:5 -req-opts=filtertext=abc %s -- %s > %t.abc
+// RUN: %sourcekitd-test -req=complete.open -pos=56:5 -req-opts=filtertext=ab %s -- %s \
+// RUN:   == -req=complete.update -pos=56:5 -req-opts=filtertext=abc %s -- %s \
+// RUN:   == -req=complete.update -pos=56:5 -req-opts=filtertext=ab %s -- %s > %t.refined
+// RUN: cat %t.ab %t.abc %t.ab > %t.refined.check
+// RUN: diff -u %t.refined %t.refined.check
+// RUN: FileCheck %s -check-prefix=REFINED < %t.refined
+// REFINED: key.name: "abcd()"
+// REFINED: key.name: "abxy()"
+// REFINED: key.name: "axbxcx()"
+// REFINED: key.name: "abcd()"
+// REFINED-NOT: key.name: "abxy()"
+// REFINED: key.name: "axbxcx()"
+// REFINED: key.name: "abcd()"
+// REFINED: key.name: "abxy()"
+// REFINED: key.name: "axbxcx()"
@@ -0,0 +1,12 @@
+func first() {
+  foo(1)
+  if true {
+    bar()
+  }
+}
+
+func second() {
+  baz()
+}
+
+let end = 0
@@ -0,0 +1,25 @@
+// Only the syntax map and structure of the requested range are reported.
+
+// RUN: %sourcekitd-test -req=read-range -pos=8:1 -length=25 %S/Inputs/function_bodies.swift | %sed_clean | FileCheck %s
+
+// CHECK:      key.syntaxmap: [
+// CHECK-NEXT:   {
+// CHECK-NEXT:     key.kind: source.lang.swift.syntaxtype.keyword,
+// CHECK-NEXT:     key.offset: 53,
+// CHECK-NEXT:     key.length: 4
+// CHECK-NEXT:   },
+// CHECK-NEXT:   {
+// CHECK-NEXT:     key.kind: source.lang.swift.syntaxtype.identifier,
+// CHECK-NEXT:     key.offset: 58,
+// CHECK-NEXT:     key.length: 6
+// CHECK-NEXT:   },
+// CHECK-NEXT:   {
+// CHECK-NEXT:     key.kind: source.lang.swift.syntaxtype.identifier,
+// CHECK-NEXT:     key.offset: 71,
+// CHECK-NEXT:     key.length: 3
+// CHECK-NEXT:   }
+// CHECK-NEXT: ],
+// CHECK-NOT:  key.name: "first()"
+// CHECK:      key.name: "second()"
+// CHECK:      key.name: "baz"
+// CHECK-NOT:  key.name: "end"
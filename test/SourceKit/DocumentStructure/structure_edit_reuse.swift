@@ -0,0 +1,28 @@
+// Function bodies before an edit are not reparsed, but their structure is
+// still reported.
+
+// RUN: %sourcekitd-test -req=structure -pos=12:5 -length=3 -replace="last" %S/Inputs/function_bodies.swift | %sed_clean | FileCheck %s
+
+// CHECK:      key.diagnostic_stage: source.diagnostic.stage.swift.parse
+// CHECK:      key.name: "first()"
+// CHECK:      key.kind: source.lang.swift.expr.call
+// CHECK-NEXT: key.name: "foo"
+// CHECK:      key.kind: source.lang.swift.stmt.if
+// CHECK:      key.kind: source.lang.swift.expr.call
+// CHECK-NEXT: key.name: "bar"
+// CHECK:      key.name: "second()"
+// CHECK:      key.kind: source.lang.swift.expr.call
+// CHECK-NEXT: key.name: "baz"
+// CHECK:      key.name: "end"
+
+// CHECK:      key.diagnostic_stage: source.diagnostic.stage.swift.parse
+// CHECK:      key.name: "first()"
+// CHECK:      key.kind: source.lang.swift.expr.call
+// CHECK-NEXT: key.name: "foo"
+// CHECK:      key.kind: source.lang.swift.stmt.if
+// CHECK:      key.kind: source.lang.swift.expr.call
+// CHECK-NEXT: key.name: "bar"
+// CHECK:      key.name: "second()"
+// CHECK:      key.kind: source.lang.swift.expr.call
+// CHECK-NEXT: key.name: "baz"
+// CHECK:      key.name: "last"
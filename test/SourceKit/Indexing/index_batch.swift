@@ -0,0 +1,18 @@
+// RUN: %sourcekitd-test -req=index-batch %S/Inputs/implicit-vis/a.swift %S/Inputs/implicit-vis/b.swift -- %S/Inputs/implicit-vis/a.swift %S/Inputs/implicit-vis/b.swift -o implicit_vis.o | %sed_clean | FileCheck %s
+
+// The files are reported in the order of the request.
+
+// CHECK: key.results: [
+// CHECK-NEXT:   {
+// CHECK-NEXT:     key.hash: <hash>,
+// CHECK-NEXT:     key.sourcefile: "{{.*}}a.swift",
+// CHECK:          key.name: "Swift",
+// CHECK:          key.kind: source.lang.swift.decl.class,
+// CHECK-NEXT:     key.name: "A",
+// CHECK-NOT:      key.description
+// CHECK:          key.hash: <hash>,
+// CHECK-NEXT:     key.sourcefile: "{{.*}}b.swift",
+// CHECK:          key.name: "Swift",
+// CHECK:          key.kind: source.lang.swift.decl.class,
+// CHECK-NEXT:     key.name: "B",
+// CHECK-NOT:      key.description
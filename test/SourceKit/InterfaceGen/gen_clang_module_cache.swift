@@ -0,0 +1,36 @@
+// RUN: rm -rf %t.overlays %t.cache
+// RUN: mkdir %t.overlays
+//
+// RUN: %swift -emit-module -o %t.overlays -F %S/../Inputs/libIDE-mock-sdk %S/Inputs/Foo.swift
+
+// The first request prints the interface and stores it in the cache, the
+// second one reads it from there.
+// RUN: %sourcekitd-test -req=interface-gen.cache.ondisk -cache-path=%t.cache == \
+// RUN:   -req=interface-gen -module Foo -- -I %t.overlays -F %S/../Inputs/libIDE-mock-sdk \
+// RUN:         %mcp_opt %clang-importer-sdk > %t.response
+// RUN: diff -u %S/gen_clang_module.swift.response %t.response
+// RUN: ls %t.cache | FileCheck -check-prefix=CACHE %s
+// CACHE: Foo-{{[0-9a-f]+}}.interface
+
+// RUN: %sourcekitd-test -req=interface-gen.cache.ondisk -cache-path=%t.cache == \
+// RUN:   -req=interface-gen -module Foo -- -I %t.overlays -F %S/../Inputs/libIDE-mock-sdk \
+// RUN:         %mcp_opt %clang-importer-sdk > %t.cached.response
+// RUN: diff -u %S/gen_clang_module.swift.response %t.cached.response
+
+// The declarations and modules of a cached interface are resolved on demand.
+// RUN: %sourcekitd-test -req=interface-gen.cache.ondisk -cache-path=%t.cache == \
+// RUN:   -req=interface-gen-open -module Foo -- -I %t.overlays -F %S/../Inputs/libIDE-mock-sdk \
+// RUN:         %mcp_opt %clang-importer-sdk \
+// RUN:      == -req=cursor -pos=230:20 == -req=cursor -pos=203:69 \
+// RUN:      == -req=cursor -pos=1:8 | FileCheck %s
+// See 'gen_clang_module.swift.response' for the positions.
+
+// CHECK: source.lang.swift.decl.function.method.instance ({{.*}}Foo.framework/Headers/Foo.h:169:10-169:27)
+// CHECK: fooInstanceFunc0
+// CHECK: c:objc(cs)FooClassDerived(im)fooInstanceFunc0
+// CHECK: source.lang.swift.ref.class ({{.*}}Foo.framework/Headers/Foo.h:146:12-146:24)
+// CHECK: FooClassBase
+// CHECK: c:objc(cs)FooClassBase
+// CHECK: source.lang.swift.ref.module ()
+// CHECK-NEXT: Foo{{$}}
+// CHECK-NEXT: Foo{{$}}
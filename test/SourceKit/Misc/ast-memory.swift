@@ -0,0 +1,19 @@
+// RUN: %sourcekitd-test -req=ast-memory %s -- %s | FileCheck %s
+
+struct S {
+  var x: Int
+}
+
+func f(_ s: S) -> Int {
+  return s.x + 1
+}
+
+// CHECK: key.results: [
+// CHECK:   key.name: "permanent.source.decl",
+// CHECK-NEXT: key.bytes: {{[1-9][0-9]*}}
+// CHECK:   key.name: "permanent.source.expr",
+// CHECK-NEXT: key.bytes: {{[1-9][0-9]*}}
+// CHECK:   key.name: "permanent.deserialization.decl",
+// CHECK-NEXT: key.bytes: {{[1-9][0-9]*}}
+// CHECK: ],
+// CHECK-NEXT: key.bytes: {{[1-9][0-9]*}}
@@ -0,0 +1,22 @@
+func first() {
+  let _ = undefinedA
+}
+
+func second() {
+  let _ = 0
+}
+
+// An edit inside one function body keeps the diagnostics of the others.
+// RUN: %sourcekitd-test -req=open %s -- %s == -req=print-diags %s \
+// RUN:    == -req=edit -pos=6:11 -replace="undefinedB" -length=1 %s \
+// RUN:    == -req=print-diags %s | FileCheck -check-prefix=CHECK-BOTH %s
+// CHECK-BOTH: use of unresolved identifier 'undefinedA'
+// CHECK-BOTH-NOT: undefinedB
+// CHECK-BOTH: use of unresolved identifier 'undefinedA'
+// CHECK-BOTH: use of unresolved identifier 'undefinedB'
+
+// RUN: %sourcekitd-test -req=open %s -- %s == -req=print-diags %s \
+// RUN:    == -req=edit -pos=2:11 -replace="0" -length=10 %s \
+// RUN:    == -req=print-diags %s | FileCheck -check-prefix=CHECK-FIXED %s
+// CHECK-FIXED: use of unresolved identifier 'undefinedA'
+// CHECK-FIXED-NOT: undefinedA
@@ -287,6 +287,16 @@ struct RelatedIdentsInfo {
   ArrayRef<std::pair<unsigned, unsigned>> Ranges;
 };
 
+/// Filled out by LangSupport::getASTMemoryUsage().
+struct ASTMemoryUsageInfo {
+  bool IsCancelled = false;
+  /// The memory the ASTContext holds, including its side tables.
+  size_t TotalBytes = 0;
+  /// The bytes the ASTContext allocated for each kind of AST node, named
+  /// "<arena>.<origin>.<category>". Only non-zero totals are listed.
+  ArrayRef<std::pair<std::string, size_t>> Allocations;
+};
+
 /// Filled out by LangSupport::findInterfaceDocument().
 struct InterfaceDocInfo {
   /// Non-empty if an error occurred.
@@ -373,6 +383,17 @@ public:
                            ArrayRef<const char *> Args,
                            StringRef Hash) = 0;
 
+  /// Indexes each of \p Filenames, whose known hash is the corresponding
+  /// element of \p Hashes, with the same compiler arguments.
+  ///
+  /// The files are indexed concurrently, but the results of each file are
+  /// reported to the consumer that \p getConsumer returns for its index, in
+  /// order and on the calling thread.
+  virtual void
+  indexSources(ArrayRef<StringRef> Filenames, ArrayRef<StringRef> Hashes,
+               std::function<IndexingConsumer &(unsigned)> getConsumer,
+               ArrayRef<const char *> Args) = 0;
+
   virtual void codeComplete(llvm::MemoryBuffer *InputBuf, unsigned Offset,
                             CodeCompletionConsumer &Consumer,
                             ArrayRef<const char *> Args) = 0;
@@ -412,6 +433,11 @@ public:
                                    bool SynthesizedExtensions,
                                    Optional<StringRef> InterestedUSR) = 0;
 
+  /// Caches the generated interfaces of modules in the directory \p Path,
+  /// so that opening the interface of an unchanged module again, even in a
+  /// later session, doesn't need to print it.
+  virtual void editorInterfaceCacheOnDisk(StringRef Path) = 0;
+
   virtual void editorOpenHeaderInterface(EditorConsumer &Consumer,
                                          StringRef Name,
                                          StringRef HeaderName,
@@ -429,6 +455,13 @@ public:
                                  unsigned Offset, unsigned Length,
                                  EditorConsumer &Consumer) = 0;
 
+  /// Reports the syntax map, structure and semantic annotations of the text
+  /// in [Offset, Offset+Length) from the last parse of the open document
+  /// \p Name. Only the structure nodes overlapping the range, and the nodes
+  /// enclosing them, are reported.
+  virtual void editorReadRange(StringRef Name, unsigned Offset,
+                               unsigned Length, EditorConsumer &Consumer) = 0;
+
   virtual void editorApplyFormatOptions(StringRef Name,
                                         OptionsDictionary &FmtOptions) = 0;
 
@@ -456,6 +489,10 @@ public:
                                             ArrayRef<const char *> Args,
                    std::function<void(const RelatedIdentsInfo &)> Receiver) = 0;
 
+  virtual void getASTMemoryUsage(StringRef Filename,
+                                 ArrayRef<const char *> Args,
+                 std::function<void(const ASTMemoryUsageInfo &)> Receiver) = 0;
+
   virtual llvm::Optional<std::pair<unsigned, unsigned>>
       findUSRRange(StringRef DocumentName, StringRef USR) = 0;
 
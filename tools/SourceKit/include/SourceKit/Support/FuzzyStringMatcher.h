@@ -29,6 +29,9 @@ namespace SourceKit {
 class FuzzyStringMatcher {
   std::string pattern;
   std::string lowercasePattern;
+  std::string uppercasePattern;
+  /// The character mask of the pattern, see \c getCharacterMask.
+  uint64_t patternMask;
   double maxScore; ///< The maximum possible raw score for this pattern.
   /// If (and only if) c is in pattern, charactersInPattern[c] == 1
   llvm::BitVector charactersInPattern;
@@ -39,6 +42,19 @@ public:
 public:
   FuzzyStringMatcher(StringRef pattern);
 
+  /// Returns a mask with one bit for each (case-folded) class of characters
+  /// that occurs in \p str.
+  ///
+  /// Computing the mask of a candidate once allows to cheaply reject it for
+  /// any number of patterns, see \c mayMatchCandidateMask.
+  static uint64_t getCharacterMask(StringRef str);
+
+  /// Whether a candidate with the character mask \p candidateMask may match
+  /// the pattern. If this returns false, \c matchesCandidate does too.
+  bool mayMatchCandidateMask(uint64_t candidateMask) const {
+    return (patternMask & ~candidateMask) == 0;
+  }
+
   /// Whether \p candidate matches the pattern.
   ///
   /// This operation is much simpler/faster than calculating
@@ -21,14 +21,34 @@ using clang::toLowercase;
 using clang::isUppercase;
 using clang::isLowercase;
 
+/// The bit of \p c in a character mask. Letters of either case share a bit,
+/// as do digits and the remaining characters beyond what fits in the mask.
+static uint64_t getCharacterMaskBit(char c) {
+  if (clang::isLetter(c))
+    return uint64_t(1) << (toLowercase(c) - 'a');
+  if (clang::isDigit(c))
+    return uint64_t(1) << (26 + (c - '0'));
+  return uint64_t(1) << (36 + static_cast<unsigned char>(c) % 28);
+}
+
+uint64_t FuzzyStringMatcher::getCharacterMask(StringRef str) {
+  uint64_t mask = 0;
+  for (char c : str)
+    mask |= getCharacterMaskBit(c);
+  return mask;
+}
+
 FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
-    : pattern(pattern_), charactersInPattern(1 << (sizeof(char) * 8)) {
+    : pattern(pattern_), patternMask(getCharacterMask(pattern_)),
+      charactersInPattern(1 << (sizeof(char) * 8)) {
   lowercasePattern.reserve(pattern.size());
+  uppercasePattern.reserve(pattern.size());
   unsigned upperCharCount = 0;
   for (char c : pattern) {
     char lower = toLowercase(c);
     upperCharCount += (c == lower) ? 0 : 1;
     lowercasePattern.push_back(lower);
+    uppercasePattern.push_back(toUppercase(c));
     charactersInPattern.set(static_cast<unsigned char>(lower));
     charactersInPattern.set(static_cast<unsigned char>(toUppercase(c)));
   }
@@ -56,12 +76,15 @@ bool FuzzyStringMatcher::matchesCandidate(StringRef candidate) const {
   if (patternLength > candidateLength)
     return false;
 
-  // Do all of the pattern characters match the candidate in order?
+  // Do all of the pattern characters match the candidate in order? Give up as
+  // soon as the rest of the candidate is shorter than the rest of the pattern.
+  const char *c = candidate.data();
+  const char *lower = lowercasePattern.data();
+  const char *upper = uppercasePattern.data();
   unsigned pidx = 0, cidx = 0;
-  while (pidx < patternLength && cidx < candidateLength) {
-    char c = candidate[cidx];
-    char p = lowercasePattern[pidx];
-    if (p == c || p == toLowercase(c))
+  while (pidx < patternLength &&
+         candidateLength - cidx >= patternLength - pidx) {
+    if (c[cidx] == lower[pidx] || c[cidx] == upper[pidx])
       ++pidx;
     ++cidx;
   }
@@ -216,7 +216,8 @@ public:
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
                                 StringRef filterText, Options options,
                                 const FilterRules &rules,
-                                Completion *&exactMatch);
+                                Completion *&exactMatch,
+                                std::vector<Completion *> *matches);
 
   void sort(Options options);
 
@@ -291,9 +292,10 @@ void CodeCompletionOrganizer::preSortCompletions(
 
 void CodeCompletionOrganizer::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText,
-    const FilterRules &rules, Completion *&exactMatch) {
+    const FilterRules &rules, Completion *&exactMatch,
+    std::vector<Completion *> *matches) {
   impl.addCompletionsWithFilter(completions, filterText, options, rules,
-                                exactMatch);
+                                exactMatch, matches);
 }
 
 void CodeCompletionOrganizer::groupAndSort(const Options &options) {
@@ -508,7 +510,8 @@ bool FilterRules::hideCompletion(SwiftResult *completion, StringRef name, void *
 
 void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText, Options options,
-    const FilterRules &rules, Completion *&exactMatch) {
+    const FilterRules &rules, Completion *&exactMatch,
+    std::vector<Completion *> *matches) {
   assert(rootGroup);
 
   auto &contents = rootGroup->contents;
@@ -591,10 +594,13 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
 
     bool match = false;
     if (options.fuzzyMatching && filterText.size() >= options.minFuzzyLength) {
-      match = pattern.matchesCandidate(completion->getName());
+      match = pattern.mayMatchCandidateMask(completion->getNameMask()) &&
+              pattern.matchesCandidate(completion->getName());
     } else {
       match = completion->getName().startswith_lower(filterText);
     }
+    if (match && matches)
+      matches->push_back(completion);
 
     bool isExactMatch = match && completion->getName().equals_lower(filterText);
 
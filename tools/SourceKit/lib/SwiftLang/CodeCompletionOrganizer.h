@@ -48,6 +48,28 @@ struct Options {
   unsigned semanticContextWeight = 10 * Completion::numSemanticContexts;
   unsigned fuzzyMatchWeight = 9;
   unsigned popularityBonus = 5;
+
+  bool operator==(const Options &other) const {
+    return sortByName == other.sortByName &&
+           useImportDepth == other.useImportDepth &&
+           groupOverloads == other.groupOverloads &&
+           groupStems == other.groupStems &&
+           includeExactMatch == other.includeExactMatch &&
+           addInnerResults == other.addInnerResults &&
+           addInnerOperators == other.addInnerOperators &&
+           addInitsToTopLevel == other.addInitsToTopLevel &&
+           hideUnderscores == other.hideUnderscores &&
+           reallyHideAllUnderscores == other.reallyHideAllUnderscores &&
+           hideLowPriority == other.hideLowPriority &&
+           hideByNameStyle == other.hideByNameStyle &&
+           fuzzyMatching == other.fuzzyMatching &&
+           minFuzzyLength == other.minFuzzyLength &&
+           showTopNonLiteralResults == other.showTopNonLiteralResults &&
+           semanticContextWeight == other.semanticContextWeight &&
+           fuzzyMatchWeight == other.fuzzyMatchWeight &&
+           popularityBonus == other.popularityBonus;
+  }
+  bool operator!=(const Options &other) const { return !(*this == other); }
 };
 
 struct SwiftCompletionInfo {
@@ -86,10 +108,16 @@ public:
   /// Add \p completions to the organizer, removing any results that don't match
   /// \p filterText and returning \p exactMatch if there is an exact match.
   ///
+  /// If \p filterText is not empty and \p matches is not null, the
+  /// completions whose name matches \p filterText are appended to it, in
+  /// order. Since a longer filter text only matches a subset of them, they
+  /// can be passed as \p completions to refine the filter.
+  ///
   /// Precondition: \p completions should be sorted with preSortCompletions().
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
                                 StringRef filterText, const FilterRules &rules,
-                                Completion *&exactMatch);
+                                Completion *&exactMatch,
+                                std::vector<Completion *> *matches = nullptr);
 
   void groupAndSort(const Options &options);
 
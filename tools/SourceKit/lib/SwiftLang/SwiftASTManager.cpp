@@ -20,15 +20,21 @@
 #include "SourceKit/Support/Logging.h"
 #include "SourceKit/Support/Tracing.h"
 
+#include "swift/AST/ClangModuleLoader.h"
 #include "swift/Basic/Cache.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/Strings.h"
 #include "swift/Subsystems.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/Serialization/SerializedModuleLoader.h"
 // This is included only for createLazyResolver(). Move to different header ?
 #include "swift/Sema/IDETypeChecking.h"
 
+#include "clang/AST/ASTContext.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Lex/Preprocessor.h"
+
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -228,8 +234,35 @@ struct FileContent {
       Stamp(Stamp) {}
 };
 
+/// Measures the memory held by \p CompInst: the Swift and Clang AST arenas,
+/// the Clang preprocessor and source manager tables, and the source buffers.
+/// Memory mapped files are not counted since the system can reclaim them.
+static size_t getCompilerInstanceMemory(CompilerInstance &CompInst) {
+  ASTContext &Ctx = CompInst.getASTContext();
+  size_t Size = Ctx.getTotalMemory();
+
+  auto &LLVMSourceMgr = CompInst.getSourceMgr().getLLVMSourceMgr();
+  for (unsigned i = 1, e = LLVMSourceMgr.getNumBuffers(); i <= e; ++i)
+    Size += LLVMSourceMgr.getMemoryBuffer(i)->getBufferSize();
+
+  if (auto *ClangLoader = Ctx.getClangModuleLoader()) {
+    clang::ASTContext &ClangCtx = ClangLoader->getClangASTContext();
+    Size += ClangCtx.getASTAllocatedMemory();
+    Size += ClangCtx.getSideTableAllocatedMemory();
+
+    clang::Preprocessor &PP = ClangLoader->getClangPreprocessor();
+    Size += PP.getTotalMemory();
+    Size += PP.getSourceManager().getDataStructureSizes();
+    Size += PP.getSourceManager().getMemoryBufferSizes().malloc_bytes;
+  }
+  return Size;
+}
+
 class ASTProducer : public ThreadSafeRefCountedBase<ASTProducer> {
   SwiftInvocationRef InvokRef;
+  /// If not ~0U, the ASTs only contain the body of the function at this
+  /// offset in the primary file, and are not put in the cache.
+  const unsigned FocusedFunctionBodyOffset;
   SmallVector<BufferStamp, 8> Stamps;
   ThreadSafeRefCntPtr<ASTUnit> AST;
   SmallVector<std::pair<std::string, BufferStamp>, 8> DependencyStamps;
@@ -237,8 +270,10 @@ class ASTProducer : public ThreadSafeRefCountedBase<ASTProducer> {
   llvm::sys::Mutex Mtx;
 
 public:
-  explicit ASTProducer(SwiftInvocationRef InvokRef)
-    : InvokRef(std::move(InvokRef)) {}
+  explicit ASTProducer(SwiftInvocationRef InvokRef,
+                       unsigned FocusedFunctionBodyOffset = ~0U)
+    : InvokRef(std::move(InvokRef)),
+      FocusedFunctionBodyOffset(FocusedFunctionBodyOffset) {}
 
   ASTUnitRef getExistingAST() {
     // FIXME: ThreadSafeRefCntPtr is racy.
@@ -246,6 +281,16 @@ public:
     return AST;
   }
 
+  SwiftInvocationRef getInvocation() const {
+    return InvokRef;
+  }
+
+  /// Drops the AST to free its memory. It is rebuilt when it is needed again.
+  void discardAST() {
+    llvm::sys::ScopedLock L(Mtx);
+    AST = nullptr;
+  }
+
   void getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
                        ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                 std::function<void(ASTUnitRef Unit, StringRef Error)> Receiver);
@@ -255,10 +300,13 @@ public:
   void enqueueConsumer(SwiftASTConsumerRef Consumer, const void *OncePerASTToken);
   std::vector<SwiftASTConsumerRef> popQueuedConsumers();
 
+  /// Drops the queued consumers which were cancelled.
+  /// \returns false if no consumer is waiting for the AST anymore.
+  bool dropCancelledConsumers();
+
   size_t getMemoryCost() const {
-    // FIXME: Report the memory cost of the overall CompilerInstance.
     if (AST && AST->getCompilerInstance().hasASTContext())
-      return AST->Impl.CompInst.getASTContext().getTotalMemory();
+      return getCompilerInstanceMemory(AST->Impl.CompInst);
     return sizeof(*this) + sizeof(*AST);
   }
 
@@ -302,7 +350,13 @@ struct CacheKeyHashInfo<ASTKey> {
 struct SwiftASTManager::Implementation {
   explicit Implementation(SwiftLangSupport &LangSupport)
     : EditorDocs(LangSupport.getEditorDocuments()),
-      RuntimeResourcePath(LangSupport.getRuntimeResourcePath()) { }
+      RuntimeResourcePath(LangSupport.getRuntimeResourcePath()) {
+    if (const char *Budget = ::getenv("SOURCEKIT_AST_MEMORY_BUDGET_MB")) {
+      unsigned BudgetMB;
+      if (!StringRef(Budget).getAsInteger(10, BudgetMB))
+        ASTMemoryBudget = size_t(BudgetMB) << 20;
+    }
+  }
 
   SwiftEditorDocumentFileMap &EditorDocs;
   std::string RuntimeResourcePath;
@@ -310,10 +364,27 @@ struct SwiftASTManager::Implementation {
   Cache<ASTKey, ASTProducerRef> ASTCache{ "sourcekit.swift.ASTCache" };
   llvm::sys::Mutex CacheMtx;
 
+  /// The contents of the module files imported by the ASTs, shared so that
+  /// rebuilding an AST doesn't read them again.
+  ModuleBufferCache ModuleBuffers;
+
   WorkQueue ASTBuildQueue{ WorkQueue::Dequeuing::Serial,
                            "sourcekit.swift.ASTBuilding" };
 
+  /// The memory all the ASTs of all documents may use together, or 0 for no
+  /// limit. Set with the SOURCEKIT_AST_MEMORY_BUDGET_MB environment variable.
+  size_t ASTMemoryBudget = 0;
+
+  /// If there is a budget, the producers which hold an AST, least recently
+  /// used first. Protected by CacheMtx.
+  std::vector<ASTProducerRef> ProducersByUse;
+
   ASTProducerRef getASTProducer(SwiftInvocationRef InvokRef);
+
+  /// Records that the AST of \p Producer was used, and discards the least
+  /// recently used other ASTs while all of them take more than the budget.
+  void noteUsedAST(ASTProducerRef Producer);
+
   FileContent getFileContent(StringRef FilePath, std::string &Error);
   BufferStamp getBufferStamp(StringRef FilePath);
   std::unique_ptr<llvm::MemoryBuffer> getMemoryBuffer(StringRef Filename,
@@ -473,6 +544,7 @@ void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
 
   if (ASTUnitRef Unit = Producer->getExistingAST()) {
     if (ASTConsumer->canUseASTWithSnapshots(Unit->getSnapshots())) {
+      Impl.noteUsedAST(Producer);
       Unit->Impl.consumeAsync(std::move(ASTConsumer), Unit);
       return;
     }
@@ -493,10 +565,64 @@ void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
     });
 }
 
+void SwiftASTManager::processFocusedASTAsync(SwiftInvocationRef InvokRef,
+                                             SwiftASTConsumerRef ASTConsumer,
+                                             ImmutableTextSnapshotRef Snapshot,
+                                          unsigned FocusedFunctionBodyOffset) {
+  ASTProducerRef Producer = new ASTProducer(InvokRef,
+                                            FocusedFunctionBodyOffset);
+  Producer->enqueueConsumer(std::move(ASTConsumer), nullptr);
+  Producer->getASTUnitAsync(Impl, Snapshot,
+    [Producer](ASTUnitRef Unit, StringRef Error) {
+      for (auto &Consumer : Producer->popQueuedConsumers()) {
+        if (Unit)
+          Unit->Impl.consumeAsync(std::move(Consumer), Unit);
+        else
+          Consumer->failed(Error);
+      }
+    });
+}
+
 void SwiftASTManager::removeCachedAST(SwiftInvocationRef Invok) {
+  llvm::sys::ScopedLock L(Impl.CacheMtx);
+  if (auto Producer = Impl.ASTCache.get(Invok->Impl.Key)) {
+    auto &ByUse = Impl.ProducersByUse;
+    ByUse.erase(std::remove(ByUse.begin(), ByUse.end(), *Producer),
+                ByUse.end());
+  }
   Impl.ASTCache.remove(Invok->Impl.Key);
 }
 
+void SwiftASTManager::Implementation::noteUsedAST(ASTProducerRef Producer) {
+  if (!ASTMemoryBudget)
+    return;
+
+  llvm::sys::ScopedLock L(CacheMtx);
+  ProducersByUse.erase(std::remove(ProducersByUse.begin(),
+                                   ProducersByUse.end(), Producer),
+                       ProducersByUse.end());
+  ProducersByUse.push_back(Producer);
+
+  size_t TotalCost = 0;
+  for (auto &P : ProducersByUse)
+    TotalCost += P->getMemoryCost();
+
+  // Keep at least the AST which was just used.
+  auto Keep = ProducersByUse.begin();
+  while (TotalCost > ASTMemoryBudget && Keep + 1 != ProducersByUse.end()) {
+    ASTProducerRef Discarded = *Keep++;
+    size_t Cost = Discarded->getMemoryCost();
+    Discarded->discardAST();
+    TotalCost -= Cost;
+    // Re-register the object with the cache to update its memory cost.
+    ASTCache.set(Discarded->getInvocation()->Impl.Key, Discarded);
+    LOG_INFO_FUNC(High, "discarded AST of " <<
+                  Discarded->getInvocation()->Impl.Opts.PrimaryFile <<
+                  " (" << Cost << " bytes)");
+  }
+  ProducersByUse.erase(ProducersByUse.begin(), Keep);
+}
+
 ASTProducerRef
 SwiftASTManager::Implementation::getASTProducer(SwiftInvocationRef InvokRef) {
   llvm::sys::ScopedLock L(CacheMtx);
@@ -565,6 +691,12 @@ void ASTProducer::getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
   Snapshots.append(Snaps.begin(), Snaps.end());
 
   MgrImpl.ASTBuildQueue.dispatch([ThisProducer, &MgrImpl, Snapshots, Receiver] {
+    // Don't build an AST nobody is waiting for anymore, e.g. because an
+    // earlier build already served the consumers, or because the consumers
+    // were superseded while the build was queued.
+    if (!ThisProducer->dropCancelledConsumers())
+      return;
+
     std::string Error;
     ASTUnitRef Unit = ThisProducer->getASTUnitImpl(MgrImpl, Snapshots, Error);
     Receiver(Unit, Error);
@@ -595,7 +727,7 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       AST = NewAST;
     }
 
-    {
+    if (FocusedFunctionBodyOffset == ~0U) {
       llvm::sys::ScopedLock L(MgrImpl.CacheMtx);
       // Re-register the object with the cache to update its memory cost.
       ASTProducerRef ThisProducer = this;
@@ -603,6 +735,8 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
     }
   }
 
+  if (AST && FocusedFunctionBodyOffset == ~0U)
+    MgrImpl.noteUsedAST(this);
   return AST;
 }
 
@@ -632,6 +766,33 @@ std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers() {
   return Consumers;
 }
 
+bool ASTProducer::dropCancelledConsumers() {
+  std::vector<SwiftASTConsumerRef> Cancelled;
+  bool HasLiveConsumers;
+  {
+    llvm::sys::ScopedLock L(Mtx);
+    auto Live = std::stable_partition(QueuedConsumers.begin(),
+                                      QueuedConsumers.end(),
+                                      [](const std::pair<SwiftASTConsumerRef,
+                                                         const void *> &C) {
+      return !C.first->isCancelled();
+    });
+    for (auto I = Live, E = QueuedConsumers.end(); I != E; ++I)
+      Cancelled.push_back(std::move(I->first));
+    QueuedConsumers.erase(Live, QueuedConsumers.end());
+    HasLiveConsumers = !QueuedConsumers.empty();
+  }
+
+  // Notify outside of the lock, consumers may queue new requests.
+  if (!Cancelled.empty()) {
+    LOG_INFO_FUNC(Medium, "dropped " << Cancelled.size() <<
+                          " cancelled AST consumers");
+  }
+  for (auto &Consumer : Cancelled)
+    Consumer->cancelled();
+  return HasLiveConsumers;
+}
+
 bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
                                 ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
   const SwiftInvocation::Implementation &Invok = InvokRef->Impl;
@@ -771,12 +932,15 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
 
   // Display diagnostics to stderr.
   CompIns.addDiagnosticConsumer(&Consumer);
+  CompIns.setModuleBufferCache(&MgrImpl.ModuleBuffers);
 
   CompilerInvocation Invocation;
   Opts.applyTo(Invocation);
 
   for (auto &Content : Contents)
     Invocation.addInputBuffer(Content.Buffer.get());
+  if (FocusedFunctionBodyOffset != ~0U)
+    Invocation.setFocusedFunctionBodyOffset(FocusedFunctionBodyOffset);
 
   if (CompIns.setup(Invocation)) {
     // FIXME: Report the diagnostic.
@@ -63,6 +63,10 @@ class SwiftASTConsumer {
 public:
   virtual ~SwiftASTConsumer() { }
   virtual void cancelled() {}
+  /// Returns true if the result is not needed anymore, e.g. because a newer
+  /// request superseded this one. Cancelled consumers are dropped, and no AST
+  /// is built for them, before their AST is built.
+  virtual bool isCancelled() { return false; }
   /// If there is an existing AST, this is called before trying to update it.
   /// Consumers may choose to still accept it even though it may have stale parts.
   ///
@@ -98,6 +102,15 @@ public:
                        ArrayRef<ImmutableTextSnapshotRef> Snapshots =
                            ArrayRef<ImmutableTextSnapshotRef>());
 
+  /// Builds an AST of \p Snapshot and provides it to the AST consumer,
+  /// asynchronously. Only the body of the function containing
+  /// \p FocusedFunctionBodyOffset is parsed and type-checked, the bodies of
+  /// the other functions in the file are not. The AST is not cached.
+  void processFocusedASTAsync(SwiftInvocationRef Invok,
+                              SwiftASTConsumerRef ASTConsumer,
+                              ImmutableTextSnapshotRef Snapshot,
+                              unsigned FocusedFunctionBodyOffset);
+
   std::unique_ptr<llvm::MemoryBuffer> getMemoryBuffer(StringRef Filename,
                                                       std::string &Error);
 
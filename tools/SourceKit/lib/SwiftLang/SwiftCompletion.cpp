@@ -21,6 +21,7 @@
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/IDE/CodeCompletionCache.h"
 
+#include "clang/Basic/CharInfo.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 using namespace SourceKit;
@@ -218,20 +219,40 @@ void SwiftLangSupport::codeComplete(llvm::MemoryBuffer *UnresolvedInputFile,
                                     unsigned Offset,
                                     SourceKit::CodeCompletionConsumer &SKConsumer,
                                     ArrayRef<const char *> Args) {
-  SwiftCodeCompletionConsumer SwiftConsumer([&](
-      MutableArrayRef<CodeCompletionResult *> Results, SwiftCompletionInfo &) {
-    CodeCompletionContext::sortCompletionResults(Results);
+  auto forwardResults = [&](ArrayRef<CodeCompletionResult *> Results) {
     for (auto *Result : Results) {
       if (!SwiftToSourceKitCompletionAdapter::handleResult(SKConsumer, Result))
         break;
     }
+  };
+
+  using CodeCompletion::ReusableResults;
+  IntrusiveRefCntPtr<ReusableResults> Last = LastCCResults;
+  if (Last && Last->canReuse(*UnresolvedInputFile, Offset, Args)) {
+    forwardResults(Last->getResults());
+    return;
+  }
+
+  IntrusiveRefCntPtr<ReusableResults> Reusable(
+      new ReusableResults(*UnresolvedInputFile, Offset, Args));
+  bool HasResults = false;
+  SwiftCodeCompletionConsumer SwiftConsumer([&](
+      MutableArrayRef<CodeCompletionResult *> Results,
+      SwiftCompletionInfo &Info) {
+    CodeCompletionContext::sortCompletionResults(Results);
+    Reusable->setResults(Results, Info.completionContext->getResultSink());
+    HasResults = true;
+    forwardResults(Results);
   });
 
   std::string Error;
   if (!swiftCodeCompleteImpl(*this, UnresolvedInputFile, Offset, SwiftConsumer,
                              Args, Error)) {
     SKConsumer.failed(Error);
+    return;
   }
+  if (HasResults)
+    LastCCResults = Reusable;
 }
 
 static void getResultStructure(
@@ -714,6 +735,65 @@ CodeCompletion::SessionCache::getFilterRules() {
   llvm::sys::ScopedLock L(mtx);
   return filterRules;
 }
+std::shared_ptr<const CodeCompletion::SessionCache::FilteredResults>
+CodeCompletion::SessionCache::getLastResults() {
+  llvm::sys::ScopedLock L(mtx);
+  return lastResults;
+}
+void CodeCompletion::SessionCache::setLastResults(
+    std::shared_ptr<const FilteredResults> results) {
+  llvm::sys::ScopedLock L(mtx);
+  lastResults = std::move(results);
+}
+
+//===----------------------------------------------------------------------===//
+// CodeCompletion::ReusableResults
+//===----------------------------------------------------------------------===//
+
+/// The end of the identifier, possibly empty, which starts at \p offset in
+/// \p text.
+static unsigned getIdentifierEnd(StringRef text, unsigned offset) {
+  unsigned end = std::min<size_t>(offset, text.size());
+  while (end != text.size() &&
+         (clang::isIdentifierBody(text[end]) ||
+          static_cast<unsigned char>(text[end]) >= 0x80))
+    ++end;
+  return end;
+}
+
+CodeCompletion::ReusableResults::ReusableResults(
+    const llvm::MemoryBuffer &buffer, unsigned offset,
+    ArrayRef<const char *> args)
+    : bufferName(buffer.getBufferIdentifier()), offset(offset),
+      args(args.begin(), args.end()), text(buffer.getBuffer()),
+      identifierEnd(getIdentifierEnd(text, offset)) {}
+
+void CodeCompletion::ReusableResults::setResults(
+    ArrayRef<SwiftResult *> results,
+    swift::ide::CodeCompletionResultSink &resultSink) {
+  sink.adoptSwiftSink(resultSink);
+  this->results.assign(results.begin(), results.end());
+}
+
+bool CodeCompletion::ReusableResults::canReuse(
+    const llvm::MemoryBuffer &buffer, unsigned offset,
+    ArrayRef<const char *> args) const {
+  if (offset != this->offset || buffer.getBufferIdentifier() != bufferName ||
+      args.size() != this->args.size())
+    return false;
+  for (unsigned i = 0, e = args.size(); i != e; ++i)
+    if (this->args[i] != args[i])
+      return false;
+
+  // Only the identifier after the completion point may differ.
+  StringRef newText = buffer.getBuffer();
+  StringRef oldText = text;
+  unsigned start = std::min<size_t>(offset, oldText.size());
+  if (newText.substr(0, start) != oldText.substr(0, start))
+    return false;
+  return newText.substr(getIdentifierEnd(newText, offset)) ==
+         oldText.substr(identifierEnd);
+}
 
 //===----------------------------------------------------------------------===//
 // CodeCompletion::SessionCacheMap
@@ -954,6 +1034,50 @@ filterInnerResults(ArrayRef<Result *> results, bool includeInner,
   return topResults;
 }
 
+struct CodeCompletion::SessionCache::FilteredResults {
+  std::string filterText;
+  CodeCompletion::Options options;
+
+  /// The completions of the session whose name matches filterText. Only set
+  /// if filterText is not empty and the results have no early inner results.
+  Optional<std::vector<Completion *>> matches;
+
+  /// Owns the inner results the view refers to.
+  std::unique_ptr<CodeCompletion::CompletionSink> innerSink;
+  CodeCompletionViewRef view;
+};
+
+/// Whether the completions matching \p filterText are a subset of the
+/// \p last matches.
+static bool
+canRefineMatches(const CodeCompletion::SessionCache::FilteredResults &last,
+                 StringRef filterText,
+                 const CodeCompletion::Options &options) {
+  if (!last.matches || last.options != options ||
+      filterText.size() <= last.filterText.size() ||
+      !filterText.startswith(last.filterText))
+    return false;
+
+  // Prefix matching of a short filter text does not find all the fuzzy
+  // matches of a longer one.
+  auto isFuzzy = [&](StringRef text) {
+    return options.fuzzyMatching && text.size() >= options.minFuzzyLength;
+  };
+  return isFuzzy(last.filterText) == isFuzzy(filterText);
+}
+
+static void forwardResults(GroupedCodeCompletionConsumer &consumer,
+                           const CodeCompletionView &view,
+                           unsigned resultOffset, unsigned maxResults) {
+  CodeCompletion::LimitedResultView limitedResults(view, resultOffset,
+                                                   maxResults);
+
+  // Forward results to the SourceKit consumer.
+  SwiftGroupedCodeCompletionConsumer groupedConsumer(consumer);
+  limitedResults.walk(groupedConsumer);
+  consumer.setNextRequestStart(limitedResults.getNextOffset());
+}
+
 static void transformAndForwardResults(
     GroupedCodeCompletionConsumer &consumer, SwiftLangSupport &lang,
     CodeCompletion::SessionCacheRef session,
@@ -961,6 +1085,20 @@ static void transformAndForwardResults(
     CodeCompletion::Options options, unsigned offset, StringRef filterText,
     unsigned resultOffset, unsigned maxResults) {
 
+  // Requests for more results with the same filter text reuse the results of
+  // the previous request.
+  auto lastResults = session->getLastResults();
+  if (lastResults && lastResults->filterText == filterText &&
+      lastResults->options == options) {
+    forwardResults(consumer, *lastResults->view, resultOffset, maxResults);
+    return;
+  }
+
+  using FilteredResults = CodeCompletion::SessionCache::FilteredResults;
+  auto results = std::make_shared<FilteredResults>();
+  results->filterText = filterText;
+  results->options = options;
+
   CodeCompletion::CompletionSink innerSink;
   Completion *exactMatch = nullptr;
   auto buildInnerResult = [&](ArrayRef<CodeCompletionString::Chunk> chunks) {
@@ -1005,8 +1143,16 @@ static void transformAndForwardResults(
       session->getCompletionKind() == CompletionKind::PostfixExpr;
 
   if (!hasEarlyInnerResults) {
-    organizer.addCompletionsWithFilter(session->getSortedCompletions(),
-                                       filterText, rules, exactMatch);
+    // When the filter text grows, only the previous matches can match it.
+    ArrayRef<Completion *> completions = session->getSortedCompletions();
+    if (lastResults && canRefineMatches(*lastResults, filterText, options))
+      completions = *lastResults->matches;
+
+    std::vector<Completion *> matches;
+    organizer.addCompletionsWithFilter(completions, filterText, rules,
+                                       exactMatch, &matches);
+    if (!filterText.empty())
+      results->matches = std::move(matches);
   }
 
   if (hasEarlyInnerResults &&
@@ -1095,14 +1241,11 @@ static void transformAndForwardResults(
   }
 
   // Build the final results view.
-  auto view = organizer.takeResultsView();
-  CodeCompletion::LimitedResultView limitedResults(*view, resultOffset,
-                                                   maxResults);
-
-  // Forward results to the SourceKit consumer.
-  SwiftGroupedCodeCompletionConsumer groupedConsumer(consumer);
-  limitedResults.walk(groupedConsumer);
-  consumer.setNextRequestStart(limitedResults.getNextOffset());
+  results->view = organizer.takeResultsView();
+  results->innerSink =
+      llvm::make_unique<CodeCompletion::CompletionSink>(std::move(innerSink));
+  forwardResults(consumer, *results->view, resultOffset, maxResults);
+  session->setLastResults(std::move(results));
 }
 
 void SwiftLangSupport::codeCompleteOpen(
@@ -1244,6 +1387,7 @@ void SwiftLangSupport::codeCompleteCacheOnDisk(StringRef path) {
       llvm::make_unique<ide::CodeCompletionCache>(newCache->onDisk.get());
 
   CCCache = newCache; // replace the old cache.
+  LastCCResults = nullptr;
 }
 
 void SwiftLangSupport::codeCompleteSetPopularAPI(
@@ -33,15 +33,33 @@
 #include "swift/IDE/CommentConversion.h"
 #include "swift/IDE/Formatting.h"
 #include "swift/IDE/SyntaxModel.h"
+#include "swift/Parse/DelayedParsingCallbacks.h"
 #include "swift/Subsystems.h"
 
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
+#include <atomic>
 
 using namespace SourceKit;
 using namespace swift;
 using namespace ide;
 
+bool EditorDiagConsumer::wantsDiagnostic(SourceManager &SM, SourceLoc Loc,
+                                         DiagnosticKind Kind,
+                                         const DiagnosticInfo &Info) {
+  // Errors are tracked even if they aren't reported, and notes may be
+  // attached to the previous diagnostic.
+  if (Kind == DiagnosticKind::Error || Kind == DiagnosticKind::Note ||
+      Loc.isInvalid())
+    return true;
+
+  // Warnings in other buffers than the inputs are dropped, except for the
+  // ones coming from Clang.
+  if (isInputBufferID(SM.findBufferContainingLoc(Loc)))
+    return true;
+  return Info.ID == diag::warning_from_clang.ID;
+}
+
 void EditorDiagConsumer::handleDiagnostic(SourceManager &SM, SourceLoc Loc,
                                           DiagnosticKind Kind, StringRef Text,
                                           const DiagnosticInfo &Info) {
@@ -323,6 +341,29 @@ public:
     }
   }
 
+  /// Calls \p Fn with the line and token of every token which starts on the
+  /// lines [StartLine, EndLine], after the token, if any, which starts on an
+  /// earlier line and may extend into StartLine.
+  template <typename FnTy>
+  void forEachTokenInLines(unsigned StartLine, unsigned EndLine,
+                           FnTy Fn) const {
+    assert(StartLine > 0);
+    // A token which spans lines is the last one on its first line, and the
+    // lines it covers have no tokens of their own.
+    for (unsigned Line = std::min<size_t>(StartLine - 1, Lines.size());
+         Line > 0; --Line) {
+      if (!Lines[Line - 1].empty()) {
+        Fn(Line, Lines[Line - 1].back());
+        break;
+      }
+    }
+    for (unsigned Line = StartLine; Line <= EndLine && Line <= Lines.size();
+         ++Line) {
+      for (auto &Tok : Lines[Line - 1])
+        Fn(Line, Tok);
+    }
+  }
+
   void clearLineRange(unsigned StartLine, unsigned Length) {
     assert(StartLine > 0);
     unsigned LineOffset = StartLine - 1;
@@ -402,6 +443,22 @@ class SwiftDocumentSemanticInfo :
   ImmutableTextSnapshotRef DiagSnapshot;
   std::vector<DiagnosticEntryInfo> SemaDiags;
 
+  /// The semantic information of the last AST. If a document is only edited
+  /// inside one function body, the information for that body is taken from
+  /// a focused AST and the rest is reused from here.
+  ImmutableTextSnapshotRef BaseSnapshot;
+  std::vector<SwiftSemanticToken> BaseSemaToks;
+  std::vector<DiagnosticEntryInfo> BaseSemaDiags;
+
+  /// The (offset, length) of the bodies of the non-local functions of the
+  /// last AST, without the braces, in source order.
+  std::vector<std::pair<unsigned, unsigned>> BaseFunctionBodies;
+
+  /// Incremented by every \c processLatestSnapshotAsync. Work for an older
+  /// request is obsolete, since the latest request handles a snapshot at
+  /// least as new.
+  std::atomic<uint64_t> LatestRequest{0};
+
   mutable llvm::sys::Mutex Mtx;
 
 public:
@@ -414,10 +471,18 @@ public:
     return InvokRef;
   }
 
+  bool isLatestRequest(uint64_t Request) const {
+    return Request == LatestRequest;
+  }
+
   uint64_t getASTGeneration() const;
 
   void setCompilerArgs(ArrayRef<const char *> Args) {
     InvokRef = ASTMgr.getInvocation(Args, Filename, CompilerArgsError);
+
+    // The last AST was built with different arguments.
+    llvm::sys::ScopedLock L(Mtx);
+    BaseSnapshot = nullptr;
   }
 
   void readSemanticInfo(ImmutableTextSnapshotRef NewSnapshot,
@@ -425,12 +490,31 @@ public:
                         std::vector<DiagnosticEntryInfo> &Diags,
                         ArrayRef<DiagnosticEntryInfo> ParserDiags);
 
-  void processLatestSnapshotAsync(EditableTextBufferRef EditableBuffer);
+  /// Annotates and diagnoses the latest snapshot of \p EditableBuffer. If
+  /// \p AllowFocusedAST is true and the document was only edited inside one
+  /// function body since the last AST, only that body is type-checked.
+  void processLatestSnapshotAsync(EditableTextBufferRef EditableBuffer,
+                                  bool AllowFocusedAST = true);
 
   void updateSemanticInfo(std::vector<SwiftSemanticToken> Toks,
                           std::vector<DiagnosticEntryInfo> Diags,
                           ImmutableTextSnapshotRef Snapshot,
-                          uint64_t ASTGeneration);
+                          uint64_t ASTGeneration,
+                   std::vector<std::pair<unsigned, unsigned>> FunctionBodies);
+
+  /// Replaces the semantic information of the last AST inside
+  /// \p FocusedBody with the one from a focused AST of \p Snapshot.
+  ///
+  /// \returns false if the last AST is not \p FocusBase anymore, or if the
+  /// focused AST does not have \p FocusedBody, e.g. because a brace was
+  /// typed. The document needs a full AST then.
+  bool mergeFocusedSemanticInfo(std::vector<SwiftSemanticToken> Toks,
+                                std::vector<DiagnosticEntryInfo> Diags,
+                                ImmutableTextSnapshotRef Snapshot,
+                                uint64_t ASTGeneration,
+                    std::vector<std::pair<unsigned, unsigned>> FunctionBodies,
+                                ImmutableTextSnapshotRef FocusBase,
+                                std::pair<unsigned, unsigned> FocusedBody);
   void removeCachedAST() {
     if (InvokRef)
       ASTMgr.removeCachedAST(InvokRef);
@@ -443,6 +527,150 @@ private:
   std::vector<DiagnosticEntryInfo> getSemanticDiagnostics(
       ImmutableTextSnapshotRef NewSnapshot,
       ArrayRef<DiagnosticEntryInfo> ParserDiags);
+
+  /// Finds the function body of the last AST which contains all the edits
+  /// up to \p NewSnapshot, and returns its range in \p NewSnapshot.
+  bool findFocusedFunctionBody(ImmutableTextSnapshotRef NewSnapshot,
+                               ImmutableTextSnapshotRef &FocusBase,
+                               std::pair<unsigned, unsigned> &FocusedBody);
+};
+
+/// The document structure which was reported to the editor for one version
+/// of a document. When the next version is parsed, the bodies of functions
+/// before the edit are skipped, and their structure is reported again from
+/// here.
+class SwiftDocumentStructureRecord {
+public:
+  struct Element {
+    UIdent Kind;
+    unsigned Offset;
+    unsigned Length;
+  };
+
+  struct Node {
+    unsigned Offset;
+    unsigned Length;
+    UIdent Kind;
+    UIdent AccessLevel;
+    UIdent SetterAccessLevel;
+    unsigned NameOffset;
+    unsigned NameLength;
+    unsigned BodyOffset;
+    unsigned BodyLength;
+    std::string DisplayName;
+    std::string TypeName;
+    std::string RuntimeName;
+    std::string SelectorName;
+    std::vector<std::string> InheritedTypes;
+    std::vector<UIdent> Attrs;
+    std::vector<Element> Elements;
+    /// The index one past the last node nested in this one.
+    unsigned End = 0;
+    bool IsCommentMarker = false;
+    bool ContainsCommentMarker = false;
+  };
+
+private:
+  /// All nodes in the order they were reported, i.e. preorder.
+  std::vector<Node> Nodes;
+  std::vector<unsigned> OpenNodes;
+  /// Maps the body offsets of functions to their nodes.
+  llvm::DenseMap<unsigned, unsigned> FunctionBodies;
+
+public:
+  enum : unsigned { NoNode = ~0U };
+
+  void begin(Node N, bool IsFunction) {
+    if (N.IsCommentMarker) {
+      for (unsigned Open : OpenNodes)
+        Nodes[Open].ContainsCommentMarker = true;
+    }
+    if (IsFunction && N.BodyLength)
+      FunctionBodies[N.BodyOffset] = Nodes.size();
+    OpenNodes.push_back(Nodes.size());
+    Nodes.push_back(std::move(N));
+  }
+
+  void addElement(UIdent Kind, unsigned Offset, unsigned Length) {
+    assert(!OpenNodes.empty());
+    Nodes[OpenNodes.back()].Elements.push_back({Kind, Offset, Length});
+  }
+
+  void end() {
+    assert(!OpenNodes.empty());
+    Nodes[OpenNodes.back()].End = Nodes.size();
+    OpenNodes.pop_back();
+  }
+
+  /// Returns the index of the function whose body starts at \p BodyOffset,
+  /// or NoNode.
+  unsigned findFunctionBody(unsigned BodyOffset) const {
+    auto Found = FunctionBodies.find(BodyOffset);
+    return Found == FunctionBodies.end() ? NoNode : Found->second;
+  }
+
+  const Node &getNode(unsigned Index) const { return Nodes[Index]; }
+
+  unsigned size() const { return Nodes.size(); }
+};
+
+/// Skips the bodies of functions which end before the edited text and whose
+/// structure can be reported again from the previous version's record.
+class ReusedFunctionBodyCallbacks : public SkippedFunctionBodyCallbacks {
+  const SwiftDocumentStructureRecord &Previous;
+  ArrayRef<DiagnosticEntryInfo> PreviousDiags;
+  unsigned UnchangedPrefixLength;
+  unsigned BufferID;
+  unsigned NumSkipped = 0;
+
+public:
+  ReusedFunctionBodyCallbacks(const SwiftDocumentStructureRecord &Previous,
+                              ArrayRef<DiagnosticEntryInfo> PreviousDiags,
+                              unsigned UnchangedPrefixLength,
+                              unsigned BufferID)
+    : Previous(Previous), PreviousDiags(PreviousDiags),
+      UnchangedPrefixLength(UnchangedPrefixLength), BufferID(BufferID) { }
+
+  unsigned getNumSkipped() const { return NumSkipped; }
+
+  bool shouldSkipFunctionBody(Parser &TheParser, AbstractFunctionDecl *AFD,
+                              SourceLoc LBraceLoc) override {
+    unsigned LBraceOffset =
+      TheParser.SourceMgr.getLocOffsetInBuffer(LBraceLoc, BufferID);
+    unsigned Index = Previous.findFunctionBody(LBraceOffset + 1);
+    if (Index == SwiftDocumentStructureRecord::NoNode)
+      return false;
+    auto &Node = Previous.getNode(Index);
+    unsigned RBraceOffset = Node.BodyOffset + Node.BodyLength;
+    if (RBraceOffset >= UnchangedPrefixLength)
+      return false;
+
+    // Comment markers inside the body are reported while walking the tokens,
+    // so replaying the body would report them out of order.
+    if (Node.ContainsCommentMarker)
+      return false;
+
+    // Parser diagnostics inside the body must be emitted again.
+    for (auto &Diag : PreviousDiags) {
+      if (Diag.Offset >= LBraceOffset && Diag.Offset <= RBraceOffset)
+        return false;
+    }
+    return true;
+  }
+
+  bool acceptSkippedFunctionBody(Parser &TheParser, AbstractFunctionDecl *AFD,
+                                 SourceRange BodyRange) override {
+    auto &SM = TheParser.SourceMgr;
+    unsigned BodyOffset =
+      SM.getLocOffsetInBuffer(BodyRange.Start, BufferID) + 1;
+    unsigned BodyEnd = SM.getLocOffsetInBuffer(BodyRange.End, BufferID);
+    unsigned Index = Previous.findFunctionBody(BodyOffset);
+    if (Index == SwiftDocumentStructureRecord::NoNode ||
+        Previous.getNode(Index).BodyLength != BodyEnd - BodyOffset)
+      return false;
+    ++NumSkipped;
+    return true;
+  }
 };
 
 class SwiftDocumentSyntaxInfo {
@@ -452,6 +680,7 @@ class SwiftDocumentSyntaxInfo {
   unsigned BufferID;
   std::vector<std::string> Args;
   std::string PrimaryFile;
+  bool HasSkippedFunctionBodies = false;
 
 public:
   SwiftDocumentSyntaxInfo(const CompilerInvocation &CompInv,
@@ -482,7 +711,12 @@ public:
     Info.Args.Args = Args;
   }
 
-  void parse() {
+  /// Parse the document. If \p PreviousStructure is given, the bodies of
+  /// functions which end before \p UnchangedPrefixLength are skipped where
+  /// their structure can be reported again from \p PreviousStructure.
+  void parse(const SwiftDocumentStructureRecord *PreviousStructure = nullptr,
+             ArrayRef<DiagnosticEntryInfo> PreviousDiags = {},
+             unsigned UnchangedPrefixLength = 0) {
     auto &P = Parser->getParser();
 
     trace::TracedOperation TracedOp;
@@ -494,11 +728,29 @@ public:
       TracedOp.start(trace::OperationKind::SimpleParse, Info);
     }
 
+    Optional<ReusedFunctionBodyCallbacks> SkippedBodyCB;
+    if (PreviousStructure && UnchangedPrefixLength) {
+      SkippedBodyCB.emplace(*PreviousStructure, PreviousDiags,
+                            UnchangedPrefixLength, BufferID);
+      P.setSkippedFunctionBodyCallbacks(SkippedBodyCB.getPointer());
+    }
+
     bool Done = false;
     while (!Done) {
       P.parseTopLevel();
       Done = P.Tok.is(tok::eof);
     }
+
+    if (SkippedBodyCB) {
+      P.setSkippedFunctionBodyCallbacks(nullptr);
+      HasSkippedFunctionBodies = SkippedBodyCB->getNumSkipped() != 0;
+    }
+  }
+
+  /// Whether some function bodies were skipped, so that the AST is
+  /// incomplete.
+  bool hasSkippedFunctionBodies() const {
+    return HasSkippedFunctionBodies;
   }
 
   SourceFile &getSourceFile() {
@@ -541,6 +793,37 @@ void SwiftDocumentSemanticInfo::readSemanticInfo(
   Diags = getSemanticDiagnostics(NewSnapshot, ParserDiags);
 }
 
+/// Adjusts the position of \p SemaToks for the replacement \p Upd, and
+/// removes the tokens which it touches.
+static void adjustSemanticTokens(std::vector<SwiftSemanticToken> &SemaToks,
+                                 ReplaceImmutableTextUpdateRef Upd) {
+  auto ReplaceBegin = std::lower_bound(SemaToks.begin(), SemaToks.end(),
+      Upd->getByteOffset(),
+      [&](const SwiftSemanticToken &Tok, unsigned StartOffset) -> bool {
+        return Tok.ByteOffset+Tok.Length < StartOffset;
+      });
+
+  std::vector<SwiftSemanticToken>::iterator ReplaceEnd;
+  if (Upd->getLength() == 0) {
+    ReplaceEnd = ReplaceBegin;
+  } else {
+    ReplaceEnd = std::upper_bound(ReplaceBegin, SemaToks.end(),
+        Upd->getByteOffset() + Upd->getLength(),
+        [&](unsigned EndOffset, const SwiftSemanticToken &Tok) -> bool {
+          return EndOffset < Tok.ByteOffset;
+        });
+  }
+
+  unsigned InsertLen = Upd->getText().size();
+  int Delta = InsertLen - Upd->getLength();
+  if (Delta != 0) {
+    for (std::vector<SwiftSemanticToken>::iterator
+           I = ReplaceEnd, E = SemaToks.end(); I != E; ++I)
+      I->ByteOffset += Delta;
+  }
+  SemaToks.erase(ReplaceBegin, ReplaceEnd);
+}
+
 std::vector<SwiftSemanticToken>
 SwiftDocumentSemanticInfo::takeSemanticTokens(
     ImmutableTextSnapshotRef NewSnapshot) {
@@ -556,31 +839,7 @@ SwiftDocumentSemanticInfo::takeSemanticTokens(
       if (SemaToks.empty())
         return false;
 
-      auto ReplaceBegin = std::lower_bound(SemaToks.begin(), SemaToks.end(),
-          Upd->getByteOffset(),
-          [&](const SwiftSemanticToken &Tok, unsigned StartOffset) -> bool {
-            return Tok.ByteOffset+Tok.Length < StartOffset;
-          });
-
-      std::vector<SwiftSemanticToken>::iterator ReplaceEnd;
-      if (Upd->getLength() == 0) {
-        ReplaceEnd = ReplaceBegin;
-      } else {
-        ReplaceEnd = std::upper_bound(ReplaceBegin, SemaToks.end(),
-            Upd->getByteOffset() + Upd->getLength(),
-            [&](unsigned EndOffset, const SwiftSemanticToken &Tok) -> bool {
-              return EndOffset < Tok.ByteOffset;
-            });
-      }
-
-      unsigned InsertLen = Upd->getText().size();
-      int Delta = InsertLen - Upd->getLength();
-      if (Delta != 0) {
-        for (std::vector<SwiftSemanticToken>::iterator
-               I = ReplaceEnd, E = SemaToks.end(); I != E; ++I)
-          I->ByteOffset += Delta;
-      }
-      SemaToks.erase(ReplaceBegin, ReplaceEnd);
+      adjustSemanticTokens(SemaToks, Upd);
       return true;
     });
 
@@ -742,11 +1001,16 @@ void SwiftDocumentSemanticInfo::updateSemanticInfo(
     std::vector<SwiftSemanticToken> Toks,
     std::vector<DiagnosticEntryInfo> Diags,
     ImmutableTextSnapshotRef Snapshot,
-    uint64_t ASTGeneration) {
+    uint64_t ASTGeneration,
+    std::vector<std::pair<unsigned, unsigned>> FunctionBodies) {
 
   {
     llvm::sys::ScopedLock L(Mtx);
     if (ASTGeneration > this->ASTGeneration) {
+      BaseSemaToks = Toks;
+      BaseSemaDiags = Diags;
+      BaseFunctionBodies = std::move(FunctionBodies);
+      BaseSnapshot = Snapshot;
       SemaToks = std::move(Toks);
       SemaDiags = std::move(Diags);
       TokSnapshot = DiagSnapshot = std::move(Snapshot);
@@ -758,6 +1022,119 @@ void SwiftDocumentSemanticInfo::updateSemanticInfo(
   NotificationCtr.postDocumentUpdateNotification(Filename);
 }
 
+bool SwiftDocumentSemanticInfo::findFocusedFunctionBody(
+    ImmutableTextSnapshotRef NewSnapshot,
+    ImmutableTextSnapshotRef &FocusBase,
+    std::pair<unsigned, unsigned> &FocusedBody) {
+
+  llvm::sys::ScopedLock L(Mtx);
+
+  if (!BaseSnapshot || BaseFunctionBodies.empty() ||
+      !BaseSnapshot->precedesOrSame(NewSnapshot))
+    return false;
+
+  bool Found = false;
+  bool Focused = BaseSnapshot->foreachReplaceUntil(NewSnapshot,
+    [&](ReplaceImmutableTextUpdateRef Upd) -> bool {
+      unsigned ByteOffset = Upd->getByteOffset();
+      unsigned RemoveEnd = ByteOffset + Upd->getLength();
+      auto isInFocusedBody = [&]() -> bool {
+        return ByteOffset >= FocusedBody.first &&
+               RemoveEnd <= FocusedBody.first + FocusedBody.second;
+      };
+
+      if (!Found) {
+        // The bodies are in source order, so this is the last body starting
+        // before the edit.
+        auto I = std::upper_bound(BaseFunctionBodies.begin(),
+                                  BaseFunctionBodies.end(),
+                                  std::make_pair(ByteOffset, ~0U));
+        if (I == BaseFunctionBodies.begin())
+          return false;
+        FocusedBody = *(I - 1);
+        Found = true;
+      }
+      if (!isInFocusedBody())
+        return false;
+      FocusedBody.second += Upd->getText().size() - Upd->getLength();
+      return true;
+    });
+
+  if (!Found || !Focused)
+    return false;
+  FocusBase = BaseSnapshot;
+  return true;
+}
+
+bool SwiftDocumentSemanticInfo::mergeFocusedSemanticInfo(
+    std::vector<SwiftSemanticToken> Toks,
+    std::vector<DiagnosticEntryInfo> Diags,
+    ImmutableTextSnapshotRef Snapshot,
+    uint64_t ASTGeneration,
+    std::vector<std::pair<unsigned, unsigned>> FunctionBodies,
+    ImmutableTextSnapshotRef FocusBase,
+    std::pair<unsigned, unsigned> FocusedBody) {
+
+  {
+    llvm::sys::ScopedLock L(Mtx);
+    if (ASTGeneration <= this->ASTGeneration)
+      return true;
+    if (BaseSnapshot != FocusBase ||
+        !std::binary_search(FunctionBodies.begin(), FunctionBodies.end(),
+                            FocusedBody))
+      return false;
+
+    // Move the semantic information of the last AST to the new snapshot.
+    BaseSnapshot->foreachReplaceUntil(Snapshot,
+      [&](ReplaceImmutableTextUpdateRef Upd) -> bool {
+        unsigned ByteOffset = Upd->getByteOffset();
+        unsigned RemoveLen = Upd->getLength();
+        int Delta = Upd->getText().size() - RemoveLen;
+        adjustSemanticTokens(BaseSemaToks, Upd);
+        BaseSemaDiags = adjustDiagnostics(std::move(BaseSemaDiags), Filename,
+                                          ByteOffset, RemoveLen, Delta);
+        return true;
+      });
+
+    // Replace the part inside the focused body with the one of the new AST.
+    unsigned BodyBegin = FocusedBody.first;
+    unsigned BodyEnd = FocusedBody.first + FocusedBody.second;
+    auto tokenPrecedes = [](const SwiftSemanticToken &Tok, unsigned Offset) {
+      return Tok.ByteOffset < Offset;
+    };
+    auto OldBegin = std::lower_bound(BaseSemaToks.begin(), BaseSemaToks.end(),
+                                     BodyBegin, tokenPrecedes);
+    auto OldEnd = std::lower_bound(OldBegin, BaseSemaToks.end(), BodyEnd,
+                                   tokenPrecedes);
+    auto NewBegin = std::lower_bound(Toks.begin(), Toks.end(), BodyBegin,
+                                     tokenPrecedes);
+    auto NewEnd = std::lower_bound(NewBegin, Toks.end(), BodyEnd,
+                                   tokenPrecedes);
+    auto InsertPos = BaseSemaToks.erase(OldBegin, OldEnd);
+    BaseSemaToks.insert(InsertPos, NewBegin, NewEnd);
+
+    auto isInBody = [&](const DiagnosticEntryInfo &Diag) -> bool {
+      return Diag.Offset >= BodyBegin && Diag.Offset <= BodyEnd;
+    };
+    BaseSemaDiags.erase(std::remove_if(BaseSemaDiags.begin(),
+                                       BaseSemaDiags.end(), isInBody),
+                        BaseSemaDiags.end());
+    std::copy_if(Diags.begin(), Diags.end(), std::back_inserter(BaseSemaDiags),
+                 isInBody);
+
+    BaseFunctionBodies = std::move(FunctionBodies);
+    BaseSnapshot = Snapshot;
+    SemaToks = BaseSemaToks;
+    SemaDiags = BaseSemaDiags;
+    TokSnapshot = DiagSnapshot = std::move(Snapshot);
+    this->ASTGeneration = ASTGeneration;
+  }
+
+  LOG_INFO_FUNC(High, "posted document update notification for: " << Filename);
+  NotificationCtr.postDocumentUpdateNotification(Filename);
+  return true;
+}
+
 namespace {
 
 class SemanticAnnotator : public SourceEntityWalker {
@@ -800,6 +1177,36 @@ public:
   }
 };
 
+/// Collects the ranges of the bodies of the non-local functions in a source
+/// file, without the braces.
+class FunctionBodyCollector : public ASTWalker {
+  SourceManager &SM;
+  unsigned BufferID;
+public:
+
+  std::vector<std::pair<unsigned, unsigned>> FunctionBodies;
+
+  FunctionBodyCollector(SourceManager &SM, unsigned BufferID)
+    : SM(SM), BufferID(BufferID) {}
+
+  bool walkToDeclPre(Decl *D) override {
+    auto *AFD = dyn_cast<AbstractFunctionDecl>(D);
+    if (!AFD)
+      return true;
+    if (AFD->isImplicit())
+      return false;
+
+    SourceRange Range = AFD->getBodySourceRange();
+    if (Range.isInvalid())
+      return false;
+    unsigned Begin = SM.getLocOffsetInBuffer(Range.Start, BufferID) + 1;
+    unsigned End = SM.getLocOffsetInBuffer(Range.End, BufferID);
+    if (Begin <= End)
+      FunctionBodies.push_back({ Begin, End - Begin });
+    return false;
+  }
+};
+
 } // anonymous namespace
 
 namespace {
@@ -807,14 +1214,29 @@ namespace {
 class AnnotAndDiagASTConsumer : public SwiftASTConsumer {
   EditableTextBufferRef EditableBuffer;
   RefPtr<SwiftDocumentSemanticInfo> SemaInfoRef;
+  /// The \c processLatestSnapshotAsync request this consumer is for.
+  uint64_t Request;
+
+  /// For a focused AST, the snapshot of the last AST and the function body
+  /// the edits since then are in.
+  ImmutableTextSnapshotRef FocusBase;
+  std::pair<unsigned, unsigned> FocusedBody;
 
 public:
   std::vector<SwiftSemanticToken> SemaToks;
 
   AnnotAndDiagASTConsumer(EditableTextBufferRef EditableBuffer,
-                          RefPtr<SwiftDocumentSemanticInfo> SemaInfoRef)
+                          RefPtr<SwiftDocumentSemanticInfo> SemaInfoRef,
+                          uint64_t Request,
+                          ImmutableTextSnapshotRef FocusBase = nullptr,
+                          std::pair<unsigned, unsigned> FocusedBody = {})
     : EditableBuffer(std::move(EditableBuffer)),
-      SemaInfoRef(std::move(SemaInfoRef)) { }
+      SemaInfoRef(std::move(SemaInfoRef)), Request(Request),
+      FocusBase(std::move(FocusBase)), FocusedBody(FocusedBody) { }
+
+  bool isCancelled() override {
+    return !SemaInfoRef->isLatestRequest(Request);
+  }
 
   void failed(StringRef Error) override {
     LOG_WARN_FUNC("sema annotations failed: " << Error);
@@ -874,13 +1296,29 @@ public:
     Annotator.walk(AstUnit->getPrimarySourceFile());
     SemaToks = std::move(Annotator.SemaToks);
 
+    FunctionBodyCollector Bodies(CompIns.getSourceMgr(), BufferID);
+    AstUnit->getPrimarySourceFile().walk(Bodies);
+
     TracedOp.finish();
 
-    SemaInfoRef->
-      updateSemanticInfo(std::move(SemaToks),
-                     std::move(Consumer.getDiagnosticsForBuffer(BufferID)),
-                         DocSnapshot,
-                         Generation);
+    if (FocusBase) {
+      if (!SemaInfoRef->mergeFocusedSemanticInfo(std::move(SemaToks),
+                         std::move(Consumer.getDiagnosticsForBuffer(BufferID)),
+                                                 DocSnapshot, Generation,
+                                              std::move(Bodies.FunctionBodies),
+                                                 FocusBase, FocusedBody)) {
+        SemaInfoRef->processLatestSnapshotAsync(EditableBuffer,
+                                                /*AllowFocusedAST=*/false);
+        return;
+      }
+    } else {
+      SemaInfoRef->
+        updateSemanticInfo(std::move(SemaToks),
+                       std::move(Consumer.getDiagnosticsForBuffer(BufferID)),
+                           DocSnapshot,
+                           Generation,
+                           std::move(Bodies.FunctionBodies));
+    }
 
     if (DocSnapshot->getStamp() != EditableBuffer->getSnapshot()->getStamp()) {
       // Handle edits that occurred after we processed the AST.
@@ -892,15 +1330,31 @@ public:
 } // anonymous namespace
 
 void SwiftDocumentSemanticInfo::processLatestSnapshotAsync(
-    EditableTextBufferRef EditableBuffer) {
+    EditableTextBufferRef EditableBuffer, bool AllowFocusedAST) {
 
   SwiftInvocationRef Invok = InvokRef;
   if (!Invok)
     return;
 
   RefPtr<SwiftDocumentSemanticInfo> SemaInfoRef = this;
+  uint64_t Request = ++LatestRequest;
+
+  // If the document was only edited inside one function body since the last
+  // AST, only type-check that body and keep the rest of the information.
+  ImmutableTextSnapshotRef Snapshot = EditableBuffer->getSnapshot();
+  ImmutableTextSnapshotRef FocusBase;
+  std::pair<unsigned, unsigned> FocusedBody;
+  if (AllowFocusedAST &&
+      findFocusedFunctionBody(Snapshot, FocusBase, FocusedBody)) {
+    auto Consumer = std::make_shared<AnnotAndDiagASTConsumer>(
+        EditableBuffer, SemaInfoRef, Request, FocusBase, FocusedBody);
+    ASTMgr.processFocusedASTAsync(Invok, std::move(Consumer), Snapshot,
+                                  FocusedBody.first);
+    return;
+  }
   auto Consumer = std::make_shared<AnnotAndDiagASTConsumer>(EditableBuffer,
-                                                            SemaInfoRef);
+                                                            SemaInfoRef,
+                                                            Request);
 
   // Semantic annotation queries for a particular document should cancel
   // previously queued queries for the same document. Each document has a
@@ -923,12 +1377,46 @@ struct SwiftEditorDocument::Implementation {
   CodeFormatOptions FormatOptions;
 
   std::shared_ptr<SwiftDocumentSyntaxInfo> SyntaxInfo;
+  ImmutableTextSnapshotRef ParsedSnapshot;
+
+  /// The document structure last reported to the editor, and the length of
+  /// the text at the start of the document which did not change since.
+  std::unique_ptr<SwiftDocumentStructureRecord> StructureRecord;
+  unsigned UnchangedPrefixLength = 0;
+
+  /// The offsets of the lines of the text the syntax map was last updated
+  /// for. Computed on demand by getLineStarts.
+  std::vector<unsigned> LineStarts;
+
+  ArrayRef<unsigned> getLineStarts() {
+    if (LineStarts.empty()) {
+      auto &SM = SyntaxInfo->getSourceManager();
+      StringRef Text = SM.getLLVMSourceMgr()
+                         .getMemoryBuffer(SyntaxInfo->getBufferID())
+                         ->getBuffer();
+      LineStarts.push_back(0);
+      for (size_t I = 0, E = Text.size(); I != E; ++I) {
+        if (Text[I] == '\n')
+          LineStarts.push_back(I + 1);
+      }
+    }
+    return LineStarts;
+  }
 
   std::shared_ptr<SwiftDocumentSyntaxInfo> getSyntaxInfo() {
     llvm::sys::ScopedLock L(AccessMtx);
     return SyntaxInfo;
   }
 
+  /// Like getSyntaxInfo, but reparses the document if function bodies were
+  /// skipped, for clients which look at the whole AST.
+  std::shared_ptr<SwiftDocumentSyntaxInfo> getFullSyntaxInfo() {
+    llvm::sys::ScopedLock L(AccessMtx);
+    if (SyntaxInfo->hasSkippedFunctionBodies())
+      parse(ParsedSnapshot, /*ReuseFunctionBodies=*/false);
+    return SyntaxInfo;
+  }
+
   llvm::sys::Mutex AccessMtx;
 
   Implementation(StringRef FilePath, SwiftLangSupport &LangSupport,
@@ -938,8 +1426,43 @@ struct SwiftEditorDocument::Implementation {
   }
 
   void buildSwiftInv(trace::SwiftInvocation &Inv);
+
+  /// Parse \p Snapshot, skipping the unchanged function bodies before the
+  /// last edit if \p ReuseFunctionBodies is true. AccessMtx must be held.
+  void parse(ImmutableTextSnapshotRef Snapshot, bool ReuseFunctionBodies);
 };
 
+void SwiftEditorDocument::Implementation::parse(
+    ImmutableTextSnapshotRef Snapshot, bool ReuseFunctionBodies) {
+  assert(SemanticInfo && "SemanticInfo must be set");
+
+  std::vector<std::string> Args;
+  std::string PrimaryFile; // Ignored, FilePath will be used
+
+  CompilerInvocation CompInv;
+  if (SemanticInfo->getInvocation()) {
+    SemanticInfo->getInvocation()->applyTo(CompInv);
+    SemanticInfo->getInvocation()->raw(Args, PrimaryFile);
+  } else {
+    ArrayRef<const char *> Args;
+    std::string Error;
+    // Ignore possible error(s)
+    LangSupport.getASTManager().
+      initCompilerInvocation(CompInv, Args, StringRef(), Error);
+  }
+
+  // Access to SyntaxInfo is guarded by AccessMtx
+  SyntaxInfo.reset(
+    new SwiftDocumentSyntaxInfo(CompInv, Snapshot, Args, FilePath));
+  ParsedSnapshot = Snapshot;
+
+  if (ReuseFunctionBodies)
+    SyntaxInfo->parse(StructureRecord.get(), ParserDiagnostics,
+                      UnchangedPrefixLength);
+  else
+    SyntaxInfo->parse();
+}
+
 void SwiftEditorDocument::Implementation::buildSwiftInv(
                                                   trace::SwiftInvocation &Inv) {
   if (SemanticInfo->getInvocation()) {
@@ -1039,12 +1562,83 @@ class SwiftDocumentStructureWalker: public ide::SyntaxModelWalker {
   SourceManager &SrcManager;
   EditorConsumer &Consumer;
   unsigned BufferID;
+  /// If set, records the reported structure.
+  SwiftDocumentStructureRecord *Record;
+  /// If set, the structure of skipped function bodies is reported from here.
+  const SwiftDocumentStructureRecord *PreviousStructure;
+
+  void beginSubStructure(SwiftDocumentStructureRecord::Node N,
+                         bool IsFunction) {
+    SmallVector<StringRef, 4> InheritedTypes(N.InheritedTypes.begin(),
+                                             N.InheritedTypes.end());
+    Consumer.beginDocumentSubStructure(N.Offset, N.Length, N.Kind,
+                                       N.AccessLevel, N.SetterAccessLevel,
+                                       N.NameOffset, N.NameLength,
+                                       N.BodyOffset, N.BodyLength,
+                                       N.DisplayName, N.TypeName,
+                                       N.RuntimeName, N.SelectorName,
+                                       InheritedTypes, N.Attrs);
+    if (Record)
+      Record->begin(std::move(N), IsFunction);
+  }
+
+  void addSubStructureElement(UIdent Kind, unsigned Offset, unsigned Length) {
+    Consumer.handleDocumentSubStructureElement(Kind, Offset, Length);
+    if (Record)
+      Record->addElement(Kind, Offset, Length);
+  }
+
+  void endSubStructure() {
+    Consumer.endDocumentSubStructure();
+    if (Record)
+      Record->end();
+  }
+
+  /// Report the node \p Index of the previous structure and everything
+  /// nested in it again.
+  void replayPreviousNode(unsigned Index) {
+    auto &N = PreviousStructure->getNode(Index);
+    bool IsFunction =
+      PreviousStructure->findFunctionBody(N.BodyOffset) == Index;
+    beginSubStructure(N, IsFunction);
+    for (auto &Elem : N.Elements)
+      addSubStructureElement(Elem.Kind, Elem.Offset, Elem.Length);
+    for (unsigned I = Index + 1; I != N.End;
+         I = PreviousStructure->getNode(I).End)
+      replayPreviousNode(I);
+    endSubStructure();
+  }
+
+  /// Report the structure inside a function body which was skipped because
+  /// it did not change since the previous version.
+  void replaySkippedBody(SyntaxStructureNode Node) {
+    auto *AFD = dyn_cast_or_null<AbstractFunctionDecl>(Node.Dcl);
+    if (!PreviousStructure || !AFD || Node.BodyRange.isInvalid() ||
+        AFD->getBodyKind() != AbstractFunctionDecl::BodyKind::Skipped)
+      return;
+
+    unsigned BodyOffset = SrcManager.getLocOffsetInBuffer(
+                                         Node.BodyRange.getStart(), BufferID);
+    unsigned Index = PreviousStructure->findFunctionBody(BodyOffset);
+    if (Index == SwiftDocumentStructureRecord::NoNode)
+      return;
+    auto &Function = PreviousStructure->getNode(Index);
+    for (unsigned I = Index + 1; I != Function.End;
+         I = PreviousStructure->getNode(I).End) {
+      if (PreviousStructure->getNode(I).Offset >= BodyOffset)
+        replayPreviousNode(I);
+    }
+  }
 
 public:
   SwiftDocumentStructureWalker(SourceManager &SrcManager,
                                unsigned BufferID,
-                               EditorConsumer &Consumer)
-    : SrcManager(SrcManager), Consumer(Consumer), BufferID(BufferID) { }
+                               EditorConsumer &Consumer,
+                               SwiftDocumentStructureRecord *Record = nullptr,
+                               const SwiftDocumentStructureRecord *
+                                   PreviousStructure = nullptr)
+    : SrcManager(SrcManager), Consumer(Consumer), BufferID(BufferID),
+      Record(Record), PreviousStructure(PreviousStructure) { }
 
   bool walkToSubStructurePre(SyntaxStructureNode Node) override {
     unsigned StartOffset = SrcManager.getLocOffsetInBuffer(Node.Range.getStart(),
@@ -1119,16 +1713,24 @@ public:
     SmallString<64> SelectorNameBuf;
     StringRef SelectorName = getObjCSelectorName(Node.Dcl, SelectorNameBuf);
 
-    std::vector<UIdent> Attrs = SwiftLangSupport::UIDsFromDeclAttributes(Node.Attrs);
-
-    Consumer.beginDocumentSubStructure(StartOffset, EndOffset - StartOffset,
-                                       Kind, AccessLevel, SetterAccessLevel,
-                                       NameStart, NameEnd - NameStart,
-                                       BodyOffset, BodyEnd - BodyOffset,
-                                       DisplayName,
-                                       TypeName, RuntimeName,
-                                       SelectorName,
-                                       InheritedNames, Attrs);
+    SwiftDocumentStructureRecord::Node N;
+    N.Offset = StartOffset;
+    N.Length = EndOffset - StartOffset;
+    N.Kind = Kind;
+    N.AccessLevel = AccessLevel;
+    N.SetterAccessLevel = SetterAccessLevel;
+    N.NameOffset = NameStart;
+    N.NameLength = NameEnd - NameStart;
+    N.BodyOffset = BodyOffset;
+    N.BodyLength = BodyEnd - BodyOffset;
+    N.DisplayName = DisplayName;
+    N.TypeName = TypeName;
+    N.RuntimeName = RuntimeName;
+    N.SelectorName = SelectorName;
+    N.InheritedTypes.assign(InheritedNames.begin(), InheritedNames.end());
+    N.Attrs = SwiftLangSupport::UIDsFromDeclAttributes(Node.Attrs);
+    bool IsFunction = dyn_cast_or_null<AbstractFunctionDecl>(Node.Dcl);
+    beginSubStructure(std::move(N), IsFunction);
 
     for (const auto &Elem : Node.Elements) {
       if (Elem.Range.isInvalid())
@@ -1138,7 +1740,7 @@ public:
       unsigned Offset = SrcManager.getLocOffsetInBuffer(Elem.Range.getStart(),
                                                         BufferID);
       unsigned Length = Elem.Range.getByteLength();
-      Consumer.handleDocumentSubStructureElement(Kind, Offset, Length);
+      addSubStructureElement(Kind, Offset, Length);
     }
 
     return true;
@@ -1174,7 +1776,8 @@ public:
   }
 
   bool walkToSubStructurePost(SyntaxStructureNode Node) override {
-    Consumer.endDocumentSubStructure();
+    replaySkippedBody(Node);
+    endSubStructure();
     return true;
   }
 
@@ -1186,14 +1789,14 @@ public:
                                                            BufferID);
     unsigned EndOffset = SrcManager.getLocOffsetInBuffer(Node.Range.getEnd(),
                                                          BufferID);
-    UIdent Kind = SwiftLangSupport::getUIDForSyntaxNodeKind(Node.Kind);
-    Consumer.beginDocumentSubStructure(StartOffset, EndOffset - StartOffset,
-                                       Kind, UIdent(), UIdent(), 0, 0,
-                                       0, 0,
-                                       StringRef(),
-                                       StringRef(), StringRef(),
-                                       StringRef(),
-                                       {}, {});
+    SwiftDocumentStructureRecord::Node N;
+    N.Offset = StartOffset;
+    N.Length = EndOffset - StartOffset;
+    N.Kind = SwiftLangSupport::getUIDForSyntaxNodeKind(Node.Kind);
+    N.NameOffset = N.NameLength = 0;
+    N.BodyOffset = N.BodyLength = 0;
+    N.IsCommentMarker = true;
+    beginSubStructure(std::move(N), /*IsFunction=*/false);
     return true;
   }
 
@@ -1201,7 +1804,7 @@ public:
     if (Node.Kind != SyntaxNodeKind::CommentMarker)
       return true;
 
-    Consumer.endDocumentSubStructure();
+    endSubStructure();
     return true;
   }
 };
@@ -1221,11 +1824,15 @@ public:
                           LineRange EditedLineRange,
                           SwiftEditorCharRange &AffectedRange,
                           SourceManager &SrcManager, EditorConsumer &Consumer,
-                          unsigned BufferID)
+                          unsigned BufferID,
+                          SwiftDocumentStructureRecord *StructureRecord,
+                          const SwiftDocumentStructureRecord *
+                              PreviousStructure)
     : SyntaxMap(SyntaxMap), EditedLineRange(EditedLineRange),
       AffectedRange(AffectedRange), SrcManager(SrcManager), Consumer(Consumer),
       BufferID(BufferID),
-      DocStructureWalker(SrcManager, BufferID, Consumer) { }
+      DocStructureWalker(SrcManager, BufferID, Consumer, StructureRecord,
+                         PreviousStructure) { }
 
   bool walkToNodePre(SyntaxNode Node) override {
     if (Node.Kind == SyntaxNodeKind::CommentMarker)
@@ -1574,6 +2181,8 @@ ImmutableTextSnapshotRef SwiftEditorDocument::initializeText(
   Impl.EditableBuffer =
       new EditableTextBuffer(Impl.FilePath, Buf->getBuffer());
   Impl.SyntaxMap.reset();
+  Impl.StructureRecord.reset();
+  Impl.UnchangedPrefixLength = 0;
   Impl.EditedLineRange.setRange(0,0);
   Impl.AffectedRange = std::make_pair(0, Buf->getBufferSize());
   Impl.SemanticInfo =
@@ -1646,6 +2255,10 @@ ImmutableTextSnapshotRef SwiftEditorDocument::replaceText(
 
   Impl.AffectedRange.second = ImmBuf->getText().size() - Impl.AffectedRange.first;
 
+  // Function bodies before the affected range can be reused.
+  Impl.UnchangedPrefixLength = std::min(Impl.UnchangedPrefixLength,
+                                        Impl.AffectedRange.first);
+
   return Snapshot;
 }
 
@@ -1658,29 +2271,7 @@ void SwiftEditorDocument::updateSemaInfo() {
 void SwiftEditorDocument::parse(ImmutableTextSnapshotRef Snapshot,
                                 SwiftLangSupport &Lang) {
   llvm::sys::ScopedLock L(Impl.AccessMtx);
-
-  assert(Impl.SemanticInfo && "Impl.SemanticInfo must be set");
-
-  std::vector<std::string> Args;
-  std::string PrimaryFile; // Ignored, Impl.FilePath will be used
-
-  CompilerInvocation CompInv;
-  if (Impl.SemanticInfo->getInvocation()) {
-    Impl.SemanticInfo->getInvocation()->applyTo(CompInv);
-    Impl.SemanticInfo->getInvocation()->raw(Args, PrimaryFile);
-  } else {
-    ArrayRef<const char *> Args;
-    std::string Error;
-    // Ignore possible error(s)
-    Lang.getASTManager().
-      initCompilerInvocation(CompInv, Args, StringRef(), Error);
-  }
-
-  // Access to Impl.SyntaxInfo is guarded by Impl.AccessMtx
-  Impl.SyntaxInfo.reset(
-    new SwiftDocumentSyntaxInfo(CompInv, Snapshot, Args, Impl.FilePath));
-
-  Impl.SyntaxInfo->parse();
+  Impl.parse(Snapshot, /*ReuseFunctionBodies=*/true);
 }
 
 void SwiftEditorDocument::readSyntaxInfo(EditorConsumer &Consumer) {
@@ -1697,15 +2288,29 @@ void SwiftEditorDocument::readSyntaxInfo(EditorConsumer &Consumer) {
 
   ide::SyntaxModelContext ModelContext(Impl.SyntaxInfo->getSourceFile());
 
+  // Record the reported structure, so that the next parse can skip the
+  // function bodies that the next edit does not touch.
+  std::unique_ptr<SwiftDocumentStructureRecord> StructureRecord(
+      new SwiftDocumentStructureRecord());
+  const SwiftDocumentStructureRecord *PreviousStructure = nullptr;
+  if (Impl.SyntaxInfo->hasSkippedFunctionBodies())
+    PreviousStructure = Impl.StructureRecord.get();
+
   SwiftEditorSyntaxWalker SyntaxWalker(Impl.SyntaxMap,
                                        Impl.EditedLineRange,
                                        Impl.AffectedRange,
                                        Impl.SyntaxInfo->getSourceManager(),
                                        Consumer,
-                                       Impl.SyntaxInfo->getBufferID());
+                                       Impl.SyntaxInfo->getBufferID(),
+                                       StructureRecord.get(),
+                                       PreviousStructure);
 
   ModelContext.walk(SyntaxWalker);
 
+  Impl.StructureRecord = std::move(StructureRecord);
+  Impl.UnchangedPrefixLength = ~0U;
+  Impl.LineStarts.clear();
+
   Consumer.recordAffectedRange(Impl.AffectedRange.first,
                                Impl.AffectedRange.second);
 }
@@ -1752,6 +2357,89 @@ void SwiftEditorDocument::readSemanticInfo(ImmutableTextSnapshotRef Snapshot,
     Consumer.handleDiagnostic(Diag, SemaDiagStage);
 }
 
+/// Reports node \p Index of \p Record and the nodes nested in it which
+/// overlap [Offset, End].
+static void reportStructureInRange(const SwiftDocumentStructureRecord &Record,
+                                   unsigned Index, unsigned Offset,
+                                   unsigned End, EditorConsumer &Consumer) {
+  auto &N = Record.getNode(Index);
+  SmallVector<StringRef, 4> InheritedTypes(N.InheritedTypes.begin(),
+                                           N.InheritedTypes.end());
+  Consumer.beginDocumentSubStructure(N.Offset, N.Length, N.Kind,
+                                     N.AccessLevel, N.SetterAccessLevel,
+                                     N.NameOffset, N.NameLength,
+                                     N.BodyOffset, N.BodyLength,
+                                     N.DisplayName, N.TypeName,
+                                     N.RuntimeName, N.SelectorName,
+                                     InheritedTypes, N.Attrs);
+  for (auto &Elem : N.Elements)
+    Consumer.handleDocumentSubStructureElement(Elem.Kind, Elem.Offset,
+                                               Elem.Length);
+  for (unsigned I = Index + 1; I != N.End; I = Record.getNode(I).End) {
+    auto &Sub = Record.getNode(I);
+    if (Sub.Offset <= End && Sub.Offset + Sub.Length >= Offset)
+      reportStructureInRange(Record, I, Offset, End, Consumer);
+  }
+  Consumer.endDocumentSubStructure();
+}
+
+void SwiftEditorDocument::readRange(unsigned Offset, unsigned Length,
+                                    EditorConsumer &Consumer) {
+  unsigned End = Offset + Length;
+  {
+    llvm::sys::ScopedLock L(Impl.AccessMtx);
+    if (!Impl.SyntaxInfo || !Impl.StructureRecord) {
+      Consumer.handleRequestError("Document has not been parsed");
+      return;
+    }
+
+    // Only the lines of the range are looked at in the syntax map.
+    ArrayRef<unsigned> LineStarts = Impl.getLineStarts();
+    auto lineForOffset = [&](unsigned Off) -> unsigned {
+      return std::upper_bound(LineStarts.begin(), LineStarts.end(), Off) -
+             LineStarts.begin();
+    };
+    Impl.SyntaxMap.forEachTokenInLines(lineForOffset(Offset),
+                                       lineForOffset(End),
+        [&](unsigned Line, const SwiftSyntaxToken &Tok) {
+      if (Line > LineStarts.size())
+        return;
+      unsigned TokOffset = LineStarts[Line - 1] + Tok.Column - 1;
+      if (TokOffset > End || TokOffset + Tok.Length <= Offset)
+        return;
+      Consumer.handleSyntaxMap(TokOffset, Tok.Length,
+                           SwiftLangSupport::getUIDForSyntaxNodeKind(Tok.Kind));
+    });
+
+    auto &Record = *Impl.StructureRecord;
+    for (unsigned I = 0, E = Record.size(); I != E; I = Record.getNode(I).End) {
+      auto &N = Record.getNode(I);
+      if (N.Offset > End)
+        break;
+      if (N.Offset + N.Length >= Offset)
+        reportStructureInRange(Record, I, Offset, End, Consumer);
+    }
+  }
+
+  if (!Consumer.needsSemanticInfo() || !Impl.SemanticInfo)
+    return;
+
+  std::vector<SwiftSemanticToken> SemaToks;
+  std::vector<DiagnosticEntryInfo> SemaDiags;
+  Impl.SemanticInfo->readSemanticInfo(getLatestSnapshot(), SemaToks,
+                                      SemaDiags, Impl.ParserDiagnostics);
+  for (auto &SemaTok : SemaToks) {
+    unsigned TokOffset = SemaTok.ByteOffset;
+    if (TokOffset > End || TokOffset + SemaTok.Length <= Offset)
+      continue;
+    UIdent Kind = SemaTok.getUIdentForKind();
+    if (Kind.isValid())
+      if (!Consumer.handleSemanticAnnotation(TokOffset, SemaTok.Length, Kind,
+                                             SemaTok.IsSystem))
+        break;
+  }
+}
+
 void SwiftEditorDocument::removeCachedAST() {
   Impl.SemanticInfo->removeCachedAST();
 }
@@ -1772,7 +2460,7 @@ const CodeFormatOptions &SwiftEditorDocument::getFormatOptions() {
 
 void SwiftEditorDocument::formatText(unsigned Line, unsigned Length,
                                      EditorConsumer &Consumer) {
-  auto SyntaxInfo = Impl.getSyntaxInfo();
+  auto SyntaxInfo = Impl.getFullSyntaxInfo();
   SourceFile &SF = SyntaxInfo->getSourceFile();
   SourceManager &SM = SyntaxInfo->getSourceManager();
   unsigned BufID = SyntaxInfo->getBufferID();
@@ -1815,7 +2503,7 @@ bool isReturningVoid(SourceManager &SM, CharSourceRange Range) {
 
 void SwiftEditorDocument::expandPlaceholder(unsigned Offset, unsigned Length,
                                             EditorConsumer &Consumer) {
-  auto SyntaxInfo = Impl.getSyntaxInfo();
+  auto SyntaxInfo = Impl.getFullSyntaxInfo();
   SourceManager &SM = SyntaxInfo->getSourceManager();
   unsigned BufID = SyntaxInfo->getBufferID();
 
@@ -2043,6 +2731,22 @@ void SwiftLangSupport::editorReplaceText(StringRef Name, llvm::MemoryBuffer *Buf
 }
 
 
+//===----------------------------------------------------------------------===//
+// EditorReadRange
+//===----------------------------------------------------------------------===//
+
+void SwiftLangSupport::editorReadRange(StringRef Name, unsigned Offset,
+                                       unsigned Length,
+                                       EditorConsumer &Consumer) {
+  auto EditorDoc = EditorDocuments.getByUnresolvedName(Name);
+  if (!EditorDoc) {
+    Consumer.handleRequestError("No associated Editor Document");
+    return;
+  }
+
+  EditorDoc->readRange(Offset, Length, Consumer);
+}
+
 //===----------------------------------------------------------------------===//
 // EditorFormatText
 //===----------------------------------------------------------------------===//
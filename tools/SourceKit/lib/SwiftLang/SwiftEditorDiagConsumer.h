@@ -69,6 +69,10 @@ public:
   void handleDiagnostic(swift::SourceManager &SM, swift::SourceLoc Loc,
                         swift::DiagnosticKind Kind, StringRef Text,
                         const swift::DiagnosticInfo &Info) override;
+
+  bool wantsDiagnostic(swift::SourceManager &SM, swift::SourceLoc Loc,
+                       swift::DiagnosticKind Kind,
+                       const swift::DiagnosticInfo &Info) override;
 };
 
 } // namespace SourceKit.
@@ -16,6 +16,8 @@
 
 #include "swift/AST/ASTPrinter.h"
 #include "swift/AST/ASTWalker.h"
+#include "swift/Basic/Version.h"
+#include "swift/ClangImporter/ClangModule.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/IDE/ModuleInterfacePrinting.h"
@@ -25,6 +27,10 @@
 
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ConvertUTF.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
 
 using namespace SourceKit;
 using namespace swift;
@@ -40,13 +46,23 @@ public:
   struct TextReference {
     /// The declaration from the module.
     const ValueDecl *Dcl = nullptr;
-    const ModuleEntity Mod;
+    ModuleEntity Mod;
     TextRange Range;
 
+    /// For a reference read from the on-disk cache, whose declaration or
+    /// module is resolved on demand: the USR of the declaration or the full
+    /// name of the module, and the semantic annotation of the reference.
+    enum class TargetKind : uint8_t { Decl, SwiftModule, ClangModule };
+    TargetKind Kind = TargetKind::Decl;
+    std::string Target;
+    UIdent Annotation;
+    bool IsSystem = false;
+
     TextReference(const ValueDecl *D, unsigned Offset, unsigned Length)
       : Dcl(D), Mod(), Range{Offset, Length} {}
     TextReference(const ModuleEntity Mod, unsigned Offset, unsigned Length)
     : Mod(Mod), Range{Offset, Length} {}
+    TextReference(TextRange Range) : Range(Range) {}
   };
 
   struct TextDecl {
@@ -54,6 +70,9 @@ public:
     const Decl *Dcl = nullptr;
     /// The range in the interface source.
     TextRange Range;
+    /// For a declaration read from the on-disk cache, its USR, from which
+    /// \c Dcl is resolved on demand.
+    std::string USR;
 
     TextDecl(const Decl *D, TextRange Range)
       : Dcl(D), Range(Range) {}
@@ -79,6 +98,15 @@ public:
   SourceTextInfo Info;
   // This is the non-typechecked AST for the generated interface source.
   CompilerInstance TextCI;
+
+  // The group and the options the module interface was printed with, to
+  // print it again if Info was read from the on-disk cache.
+  Optional<std::string> Group;
+  bool SynthesizedExtensions = false;
+  // Whether Info was read from the on-disk cache, so that the declarations
+  // and modules it refers to are only resolved on demand.
+  bool IsFromCache = false;
+  llvm::sys::Mutex ResolveMtx;
 };
 
 typedef SwiftInterfaceGenContext::Implementation::TextRange TextRange;
@@ -250,18 +278,28 @@ static void reportDocumentStructure(CompilerInstance &CI,
   SwiftEditorDocument::reportDocumentStructure(*SF, Consumer);
 }
 
+/// Computes the semantic annotation of \p Ref, which is recorded in the
+/// on-disk cache for references that aren't resolved yet.
+static void getReferenceAnnotation(const TextReference &Ref, UIdent &Kind,
+                                   bool &IsSystem) {
+  if (Ref.Mod) {
+    Kind = SwiftLangSupport::getUIDForModuleRef();
+    IsSystem = Ref.Mod.isSystemModule();
+  } else if (Ref.Dcl) {
+    Kind = SwiftLangSupport::getUIDForDecl(Ref.Dcl, /*IsRef=*/true);
+    IsSystem = Ref.Dcl->getModuleContext()->isSystemModule();
+  } else {
+    Kind = Ref.Annotation;
+    IsSystem = Ref.IsSystem;
+  }
+}
+
 static void reportSemanticAnnotations(const SourceTextInfo &IFaceInfo,
                                       EditorConsumer &Consumer) {
   for (auto &Ref : IFaceInfo.References) {
     UIdent Kind;
     bool IsSystem;
-    if (Ref.Mod) {
-      Kind = SwiftLangSupport::getUIDForModuleRef();
-      IsSystem = Ref.Mod.isSystemModule();
-    } else if (Ref.Dcl) {
-      Kind = SwiftLangSupport::getUIDForDecl(Ref.Dcl, /*IsRef=*/true);
-      IsSystem = Ref.Dcl->getModuleContext()->isSystemModule();
-    }
+    getReferenceAnnotation(Ref, Kind, IsSystem);
     if (Kind.isInvalid())
       continue;
     unsigned Offset = Ref.Range.Offset;
@@ -270,13 +308,328 @@ static void reportSemanticAnnotations(const SourceTextInfo &IFaceInfo,
   }
 }
 
+//===----------------------------------------------------------------------===//
+// On-disk cache of generated module interfaces
+//===----------------------------------------------------------------------===//
+
+/// A version number for the format of the cached interfaces.
+///
+/// This should be incremented any time we commit a change to the format.
+static constexpr uint32_t InterfaceCacheVersion = 1;
+
+/// Returns the path of the cache file for the interface of \p Impl.Mod, or
+/// the empty string if it cannot be cached.
+///
+/// The name contains a hash of everything the printed interface depends on:
+/// the compiler, the target, the printing options and the contents of the
+/// files of the module and of the standard library.
+static std::string
+getInterfaceCachePath(StringRef CacheDirectory, ASTContext &Ctx,
+                      const SwiftInterfaceGenContext::Implementation &Impl) {
+  if (CacheDirectory.empty())
+    return "";
+
+  llvm::MD5 Hash;
+  auto addString = [&](StringRef Str) {
+    Hash.update(Str);
+    Hash.update(StringRef("\0", 1));
+  };
+  addString(version::getSwiftFullVersion());
+  addString(std::to_string(InterfaceCacheVersion));
+  addString(Ctx.LangOpts.Target.str());
+  addString(Impl.ModuleOrHeaderName);
+  addString(Impl.Group.hasValue() ? "group" : "");
+  addString(Impl.Group.hasValue() ? *Impl.Group : "");
+  addString(Impl.SynthesizedExtensions ? "synthesized" : "");
+
+  SmallVector<Module *, 2> Modules;
+  Modules.push_back(Impl.Mod);
+  Module *Stdlib = getModuleByFullName(Ctx, Ctx.StdlibModuleName);
+  if (Stdlib && Stdlib != Impl.Mod)
+    Modules.push_back(Stdlib);
+  for (Module *M : Modules) {
+    for (FileUnit *File : M->getFiles()) {
+      if (isa<DerivedFileUnit>(File))
+        continue;
+      auto *LF = dyn_cast<LoadedFile>(File);
+      if (!LF || LF->getFilename().empty())
+        return "";
+      auto Buffer =
+          llvm::MemoryBuffer::getFile(LF->getFilename(), /*FileSize=*/-1,
+                                      /*RequiresNullTerminator=*/false);
+      if (!Buffer)
+        return "";
+      addString(LF->getFilename());
+      Hash.update(Buffer.get()->getBuffer());
+    }
+  }
+
+  llvm::MD5::MD5Result Digest;
+  Hash.final(Digest);
+  SmallString<32> HashStr;
+  llvm::MD5::stringifyResult(Digest, HashStr);
+
+  SmallString<128> Path(CacheDirectory);
+  llvm::sys::path::append(Path, Impl.ModuleOrHeaderName + "-" + HashStr +
+                                    ".interface");
+  return Path.str();
+}
+
+/// Writes \p Info, which was just printed, to the cache file \p Path.
+///
+/// The file is written by way of a temporary file, so that other processes
+/// never read a partially written one. Failing to write it only means that
+/// the interface is printed again next time, so errors are ignored.
+static void writeCachedInterface(StringRef Path, const SourceTextInfo &Info) {
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path)))
+    return;
+
+  SmallString<128> TmpPath(Path);
+  TmpPath += "-%%%%%%";
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(TmpPath.str(), TmpFD, TmpPath))
+    return;
+
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    llvm::support::endian::Writer<llvm::support::little> LE(Out);
+    auto writeString = [&](StringRef Str) {
+      LE.write(static_cast<uint32_t>(Str.size()));
+      Out << Str;
+    };
+    auto writeRange = [&](TextRange Range) {
+      LE.write(Range.Offset);
+      LE.write(Range.Length);
+    };
+
+    LE.write(InterfaceCacheVersion);
+    writeString(Info.Text);
+
+    LE.write(static_cast<uint32_t>(Info.References.size()));
+    for (auto &Ref : Info.References) {
+      UIdent Kind;
+      bool IsSystem = false;
+      getReferenceAnnotation(Ref, Kind, IsSystem);
+
+      auto RefKind = TextReference::TargetKind::Decl;
+      SmallString<64> Target;
+      if (Ref.Mod) {
+        RefKind = Ref.Mod.getAsSwiftModule()
+                         ? TextReference::TargetKind::SwiftModule
+                         : TextReference::TargetKind::ClangModule;
+        Target = Ref.Mod.getFullName();
+      } else if (Ref.Dcl) {
+        llvm::raw_svector_ostream OS(Target);
+        if (SwiftLangSupport::printUSR(Ref.Dcl, OS))
+          Target.clear();
+      }
+
+      writeRange(Ref.Range);
+      LE.write(static_cast<uint8_t>(RefKind));
+      LE.write(static_cast<uint8_t>(IsSystem));
+      writeString(Kind.isValid() ? Kind.getName() : StringRef());
+      writeString(Target);
+    }
+
+    LE.write(static_cast<uint32_t>(Info.Decls.size()));
+    for (auto &Entry : Info.Decls) {
+      SmallString<64> USR;
+      auto *VD = dyn_cast_or_null<ValueDecl>(Entry.Dcl);
+      if (VD && !VD->getDeclContext()->getLocalContext()) {
+        llvm::raw_svector_ostream OS(USR);
+        if (SwiftLangSupport::printUSR(VD, OS))
+          USR.clear();
+      }
+      writeRange(Entry.Range);
+      writeString(USR);
+    }
+
+    LE.write(static_cast<uint32_t>(Info.USRMap.size()));
+    for (auto &Entry : Info.USRMap) {
+      writeString(Entry.getKey());
+      writeRange(Entry.getValue().Range);
+    }
+
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TmpPath);
+      return;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TmpPath, Path))
+    llvm::sys::fs::remove(TmpPath);
+}
+
+namespace {
+/// Reads the fields of a cached interface, remembering whether the file
+/// ended before all of them were read.
+class CachedInterfaceReader {
+  const char *Cursor;
+  const char *End;
+
+public:
+  bool Failed = false;
+
+  explicit CachedInterfaceReader(StringRef Buffer)
+    : Cursor(Buffer.begin()), End(Buffer.end()) {}
+
+  bool atEnd() const { return Cursor == End; }
+
+  uint8_t read8() {
+    if (End - Cursor < 1) {
+      Failed = true;
+      return 0;
+    }
+    return *Cursor++;
+  }
+
+  uint32_t read32() {
+    if (End - Cursor < 4) {
+      Failed = true;
+      return 0;
+    }
+    auto Result = llvm::support::endian::read32le(Cursor);
+    Cursor += 4;
+    return Result;
+  }
+
+  TextRange readRange() {
+    unsigned Offset = read32();
+    unsigned Length = read32();
+    return TextRange{Offset, Length};
+  }
+
+  StringRef readString() {
+    uint32_t Size = read32();
+    if (Failed || uint32_t(End - Cursor) < Size) {
+      Failed = true;
+      return StringRef();
+    }
+    StringRef Result(Cursor, Size);
+    Cursor += Size;
+    return Result;
+  }
+};
+} // end anonymous namespace
+
+/// Reads the cache file \p Path into \p Info, whose declarations and
+/// modules are left to be resolved on demand. Returns false if there is no
+/// such file, or it has a different format.
+static bool readCachedInterface(StringRef Path, SourceTextInfo &Info) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return false;
+
+  CachedInterfaceReader Reader(Buffer.get()->getBuffer());
+  if (Reader.read32() != InterfaceCacheVersion)
+    return false;
+
+  SourceTextInfo Result;
+  Result.Text = Reader.readString();
+
+  for (uint32_t I = 0, E = Reader.read32(); I != E && !Reader.Failed; ++I) {
+    TextReference Ref(Reader.readRange());
+    uint8_t Kind = Reader.read8();
+    if (Kind > uint8_t(TextReference::TargetKind::ClangModule))
+      return false;
+    Ref.Kind = TextReference::TargetKind(Kind);
+    Ref.IsSystem = Reader.read8();
+    StringRef Annotation = Reader.readString();
+    if (!Annotation.empty())
+      Ref.Annotation = UIdent(Annotation);
+    Ref.Target = Reader.readString();
+    Result.References.push_back(std::move(Ref));
+  }
+
+  for (uint32_t I = 0, E = Reader.read32(); I != E && !Reader.Failed; ++I) {
+    TextDecl Entry(nullptr, Reader.readRange());
+    Entry.USR = Reader.readString();
+    Result.Decls.push_back(std::move(Entry));
+  }
+
+  for (uint32_t I = 0, E = Reader.read32(); I != E && !Reader.Failed; ++I) {
+    StringRef USR = Reader.readString();
+    Result.USRMap[USR] = TextDecl(nullptr, Reader.readRange());
+  }
+
+  if (Reader.Failed || !Reader.atEnd())
+    return false;
+  Info = std::move(Result);
+  return true;
+}
+
+/// Resolves the declaration or module of \p Ref, which was read from the
+/// on-disk cache. Returns false if it cannot be found from its USR or name.
+static bool resolveCachedReference(ASTContext &Ctx, TextReference &Ref) {
+  if (Ref.Dcl || Ref.Mod)
+    return true;
+  if (Ref.Target.empty())
+    return false;
+
+  if (Ref.Kind == TextReference::TargetKind::Decl) {
+    std::string Error;
+    Ref.Dcl = dyn_cast_or_null<ValueDecl>(
+        ide::getDeclFromUSR(Ctx, Ref.Target, Error));
+    return Ref.Dcl != nullptr;
+  }
+
+  Module *M = getModuleByFullName(Ctx, Ref.Target);
+  if (!M)
+    return false;
+  if (Ref.Kind == TextReference::TargetKind::SwiftModule) {
+    Ref.Mod = ModuleEntity(M);
+  } else {
+    for (FileUnit *File : M->getFiles()) {
+      if (auto *CMU = dyn_cast<ClangModuleUnit>(File)) {
+        Ref.Mod = ModuleEntity(CMU->getClangModule());
+        break;
+      }
+    }
+  }
+  return Ref.Mod && Ref.Mod.getFullName() == Ref.Target;
+}
+
+/// Prints the interface of \p Impl.Mod, or of its submodule named
+/// \p Impl.ModuleOrHeaderName, into \p Info.
+static void printModuleInterfaceInfo(
+    SwiftInterfaceGenContext::Implementation &Impl, SourceTextInfo &Info) {
+  std::vector<StringRef> SplitModuleName;
+  StringRef ModuleName = Impl.ModuleOrHeaderName;
+  while (!ModuleName.empty()) {
+    StringRef SubModuleName;
+    std::tie(SubModuleName, ModuleName) = ModuleName.split('.');
+    SplitModuleName.push_back(SubModuleName);
+  }
+
+  Optional<StringRef> Group;
+  if (Impl.Group)
+    Group = StringRef(*Impl.Group);
+
+  PrintOptions Options = PrintOptions::printInterface();
+  ModuleTraversalOptions TraversalOptions = None; // Don't print submodules.
+  SmallString<128> Text;
+  llvm::raw_svector_ostream OS(Text);
+  AnnotatingPrinter Printer(Info, OS);
+  printSubmoduleInterface(Impl.Mod, SplitModuleName,
+    Group.hasValue() ? llvm::makeArrayRef(Group.getValue()) : ArrayRef<StringRef>(),
+                          TraversalOptions,
+                          Printer, Options,
+                          Group.hasValue() && Impl.SynthesizedExtensions);
+
+  Info.Text = OS.str();
+}
+
 static bool getModuleInterfaceInfo(ASTContext &Ctx,
                                    StringRef ModuleName,
                                    Optional<StringRef> Group,
                                  SwiftInterfaceGenContext::Implementation &Impl,
                                    std::string &ErrMsg,
                                    bool SynthesizedExtensions,
-                                   Optional<StringRef> InterestedUSR) {
+                                   Optional<StringRef> InterestedUSR,
+                                   StringRef CacheDirectory) {
   Module *&Mod = Impl.Mod;
   SourceTextInfo &Info = Impl.Info;
 
@@ -312,21 +665,22 @@ static bool getModuleInterfaceInfo(ASTContext &Ctx,
     }
   }
 
-  PrintOptions Options = PrintOptions::printInterface();
-  ModuleTraversalOptions TraversalOptions = None; // Don't print submodules.
-  SmallString<128> Text;
-  llvm::raw_svector_ostream OS(Text);
-  AnnotatingPrinter Printer(Info, OS);
   if (!Group && InterestedUSR) {
     Group = findGroupNameForUSR(Mod, InterestedUSR.getValue());
   }
-  printSubmoduleInterface(Mod, SplitModuleName,
-    Group.hasValue() ? llvm::makeArrayRef(Group.getValue()) : ArrayRef<StringRef>(),
-                          TraversalOptions,
-                          Printer, Options,
-                          Group.hasValue() && SynthesizedExtensions);
+  if (Group)
+    Impl.Group = Group->str();
+  Impl.SynthesizedExtensions = SynthesizedExtensions;
 
-  Info.Text = OS.str();
+  std::string CachePath = getInterfaceCachePath(CacheDirectory, Ctx, Impl);
+  if (!CachePath.empty() && readCachedInterface(CachePath, Info)) {
+    Impl.IsFromCache = true;
+    return false;
+  }
+
+  printModuleInterfaceInfo(Impl, Info);
+  if (!CachePath.empty())
+    writeCachedInterface(CachePath, Info);
   return false;
 }
 
@@ -382,7 +736,8 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
                                  CompilerInvocation Invocation,
                                  std::string &ErrMsg,
                                  bool SynthesizedExtensions,
-                                 Optional<StringRef> InterestedUSR) {
+                                 Optional<StringRef> InterestedUSR,
+                                 StringRef CacheDirectory) {
   SwiftInterfaceGenContextRef IFaceGenCtx{ new SwiftInterfaceGenContext() };
   IFaceGenCtx->Impl.DocumentName = DocumentName;
   IFaceGenCtx->Impl.IsModule = IsModule;
@@ -411,7 +766,8 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
 
   if (IsModule) {
     if (getModuleInterfaceInfo(Ctx, ModuleOrHeaderName, Group, IFaceGenCtx->Impl,
-                               ErrMsg, SynthesizedExtensions, InterestedUSR))
+                               ErrMsg, SynthesizedExtensions, InterestedUSR,
+                               CacheDirectory))
       return nullptr;
   } else {
     auto &FEOpts = Invocation.getFrontendOptions();
@@ -491,6 +847,7 @@ bool SwiftInterfaceGenContext::matches(StringRef ModuleName,
 }
 
 void SwiftInterfaceGenContext::reportEditorInfo(EditorConsumer &Consumer) const {
+  llvm::sys::ScopedLock L(Impl.ResolveMtx);
   Consumer.handleSourceText(Impl.Info.Text);
   reportSyntacticAnnotations(Impl.TextCI, Consumer);
   reportDocumentStructure(Impl.TextCI, Consumer);
@@ -498,8 +855,22 @@ void SwiftInterfaceGenContext::reportEditorInfo(EditorConsumer &Consumer) const
   Consumer.finished();
 }
 
+/// Prints the interface of \p Impl again, after its cached Info referred to
+/// a declaration or module which could not be resolved from its USR or name.
+static void reprintCachedInterface(
+    SwiftInterfaceGenContext::Implementation &Impl) {
+  ASTContext &Ctx = Impl.Instance.getASTContext();
+  CloseClangModuleFiles scopedCloseFiles(*Ctx.getClangModuleLoader());
+  SourceTextInfo Info;
+  printModuleInterfaceInfo(Impl, Info);
+  Impl.Info = std::move(Info);
+  Impl.IsFromCache = false;
+}
+
 SwiftInterfaceGenContext::ResolvedEntity
 SwiftInterfaceGenContext::resolveEntityForOffset(unsigned Offset) const {
+  llvm::sys::ScopedLock L(Impl.ResolveMtx);
+
   // Search among the references.
   {
     auto Pos = std::upper_bound(Impl.Info.References.begin(),
@@ -509,6 +880,11 @@ SwiftInterfaceGenContext::resolveEntityForOffset(unsigned Offset) const {
         return Offset < RHS.Range.Offset+RHS.Range.Length;
       });
     if (Pos != Impl.Info.References.end() && Pos->Range.Offset <= Offset) {
+      if (Impl.IsFromCache &&
+          !resolveCachedReference(Impl.Instance.getASTContext(), *Pos)) {
+        reprintCachedInterface(Impl);
+        return resolveEntityForOffset(Offset);
+      }
       if (Pos->Mod)
         return ResolvedEntity(Pos->Mod, true);
       else
@@ -523,7 +899,7 @@ SwiftInterfaceGenContext::resolveEntityForOffset(unsigned Offset) const {
   Offset = SM.getLocOffsetInBuffer(Loc, BufferID);
 
   // Search among the declarations.
-  {
+  auto findDecl = [&]() -> TextDecl * {
     auto Pos = std::lower_bound(Impl.Info.Decls.begin(),
                                 Impl.Info.Decls.end(),
                                 Offset,
@@ -531,7 +907,21 @@ SwiftInterfaceGenContext::resolveEntityForOffset(unsigned Offset) const {
         return LHS.Range.Offset < Offset;
       });
     if (Pos != Impl.Info.Decls.end() && Pos->Range.Offset == Offset)
-      return ResolvedEntity(dyn_cast<ValueDecl>(Pos->Dcl), false);
+      return &*Pos;
+    return nullptr;
+  };
+  if (TextDecl *Entry = findDecl()) {
+    if (Impl.IsFromCache && !Entry->Dcl && !Entry->USR.empty()) {
+      std::string Error;
+      Entry->Dcl = ide::getDeclFromUSR(Impl.Instance.getASTContext(),
+                                       Entry->USR, Error);
+      if (!Entry->Dcl) {
+        reprintCachedInterface(Impl);
+        Entry = findDecl();
+      }
+    }
+    if (Entry)
+      return ResolvedEntity(dyn_cast_or_null<ValueDecl>(Entry->Dcl), false);
   }
 
   return ResolvedEntity();
@@ -539,6 +929,7 @@ SwiftInterfaceGenContext::resolveEntityForOffset(unsigned Offset) const {
 
 llvm::Optional<std::pair<unsigned, unsigned>>
 SwiftInterfaceGenContext::findUSRRange(StringRef USR) const {
+  llvm::sys::ScopedLock L(Impl.ResolveMtx);
   auto Pos = Impl.Info.USRMap.find(USR);
   if (Pos == Impl.Info.USRMap.end())
     return None;
@@ -571,6 +962,16 @@ bool SwiftInterfaceGenMap::remove(StringRef Name) {
   return IFaceGens.erase(Name);
 }
 
+void SwiftInterfaceGenMap::setCacheDirectory(StringRef Path) {
+  llvm::sys::ScopedLock L(Mtx);
+  CacheDirectory = Path;
+}
+
+std::string SwiftInterfaceGenMap::getCacheDirectory() const {
+  llvm::sys::ScopedLock L(Mtx);
+  return CacheDirectory;
+}
+
 SwiftInterfaceGenContextRef
 SwiftInterfaceGenMap::find(StringRef ModuleName,
                            const CompilerInvocation &Invok) {
@@ -620,6 +1021,7 @@ void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
   std::string ErrMsg;
+  std::string CacheDirectory = IFaceGenContexts.getCacheDirectory();
   auto IFaceGenRef = SwiftInterfaceGenContext::create(Name,
                                                       /*IsModule=*/true,
                                                       ModuleName,
@@ -627,7 +1029,8 @@ void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
                                                       Invocation,
                                                       ErrMsg,
                                                       SynthesizedExtensions,
-                                                      InterestedUSR);
+                                                      InterestedUSR,
+                                                      CacheDirectory);
   if (!IFaceGenRef) {
     Consumer.handleRequestError(ErrMsg.c_str());
     return;
@@ -666,6 +1069,10 @@ public:
   }
 };
 
+void SwiftLangSupport::editorInterfaceCacheOnDisk(StringRef Path) {
+  IFaceGenContexts.setCacheDirectory(Path);
+}
+
 void SwiftLangSupport::editorOpenSwiftSourceInterface(StringRef Name,
                                                       StringRef SourceName,
                                                       ArrayRef<const char *> Args,
@@ -734,7 +1141,8 @@ void SwiftLangSupport::editorOpenHeaderInterface(EditorConsumer &Consumer,
                                                       Invocation,
                                                       Error,
                                                       SynthesizedExtensions,
-                                                      None);
+                                                      None,
+                                                      /*CacheDirectory=*/"");
   if (!IFaceGenRef) {
     Consumer.handleRequestError(Error.c_str());
     return;
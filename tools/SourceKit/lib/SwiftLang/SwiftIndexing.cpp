@@ -22,7 +22,11 @@
 #include "swift/Serialization/SerializedModuleLoader.h"
 // This is included only for createLazyResolver(). Move to different header ?
 #include "swift/Sema/IDETypeChecking.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace SourceKit;
 using namespace swift;
@@ -171,6 +175,239 @@ static void indexModule(llvm::MemoryBuffer *Input,
 }
 
 
+//===----------------------------------------------------------------------===//
+// IndexRecorder
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// Records what is reported for one file, to replay it later and to remember
+/// its hash and dependencies in the \c SwiftIndexHashCache.
+///
+/// If there is a consumer to forward to, everything is forwarded right away
+/// and only the hash and the dependencies are recorded.
+class IndexRecorder : public IndexingConsumer {
+  enum class EventKind {
+    Failed,
+    RecordHash,
+    StartDependency,
+    FinishDependency,
+    StartSourceEntity,
+    RecordRelatedEntity,
+    FinishSourceEntity,
+  };
+
+  struct Event {
+    EventKind K;
+    UIdent Kind;
+    StringRef Text;
+    bool Flag;
+    EntityInfo Info;
+  };
+
+  IndexingConsumer *Forward;
+  std::vector<Event> Events;
+  llvm::BumpPtrAllocator Allocator;
+
+  bool Failed = false;
+  SwiftIndexHashCache::Entry HashEntry;
+
+  StringRef copy(StringRef Str) {
+    if (Str.empty())
+      return StringRef();
+    char *Mem = Allocator.Allocate<char>(Str.size());
+    std::copy(Str.begin(), Str.end(), Mem);
+    return StringRef(Mem, Str.size());
+  }
+
+  void record(EventKind K, UIdent Kind, StringRef Text = StringRef(),
+              bool Flag = false, const EntityInfo *Info = nullptr) {
+    Events.push_back({ K, Kind, copy(Text), Flag, EntityInfo() });
+    if (!Info)
+      return;
+    EntityInfo &Copy = Events.back().Info;
+    Copy = *Info;
+    Copy.Name = copy(Info->Name);
+    Copy.USR = copy(Info->USR);
+    Copy.Group = copy(Info->Group);
+    Copy.ReceiverUSR = copy(Info->ReceiverUSR);
+    UIdent *Attrs = Allocator.Allocate<UIdent>(Info->Attrs.size());
+    std::copy(Info->Attrs.begin(), Info->Attrs.end(), Attrs);
+    Copy.Attrs = llvm::makeArrayRef(Attrs, Info->Attrs.size());
+  }
+
+public:
+  explicit IndexRecorder(IndexingConsumer *Forward = nullptr)
+    : Forward(Forward) {}
+
+  /// Reports the recorded results to \p Consumer. Must not be called after
+  /// \c takeHashEntry().
+  void replay(IndexingConsumer &Consumer) const;
+
+  /// Returns the hash and the dependencies to remember for the file, if it
+  /// was indexed successfully.
+  Optional<SwiftIndexHashCache::Entry> takeHashEntry();
+
+private:
+  void failed(StringRef ErrDescription) override {
+    Failed = true;
+    if (Forward)
+      return Forward->failed(ErrDescription);
+    record(EventKind::Failed, UIdent(), ErrDescription);
+  }
+
+  bool recordHash(StringRef Hash, bool isKnown) override {
+    HashEntry.Hash = Hash;
+    if (Forward)
+      return Forward->recordHash(Hash, isKnown);
+    record(EventKind::RecordHash, UIdent(), Hash, isKnown);
+    return true;
+  }
+
+  bool startDependency(UIdent Kind, StringRef Name, StringRef Path,
+                       bool IsSystem, StringRef Hash) override {
+    SwiftIndexHashCache::Dependency Dep{ /*IsFinish=*/false, Kind, Name, Path,
+                                         IsSystem, Hash,
+                                         llvm::sys::TimeValue(), 0 };
+    llvm::sys::fs::file_status Status;
+    if (!Path.empty() && !llvm::sys::fs::status(Path, Status)) {
+      Dep.ModificationTime = Status.getLastModificationTime();
+      Dep.Size = Status.getSize();
+    }
+    HashEntry.Dependencies.push_back(std::move(Dep));
+
+    if (Forward)
+      return Forward->startDependency(Kind, Name, Path, IsSystem, Hash);
+    record(EventKind::StartDependency, Kind);
+    return true;
+  }
+
+  bool finishDependency(UIdent Kind) override {
+    HashEntry.Dependencies.push_back({ /*IsFinish=*/true, Kind, "", "", false,
+                                       "", llvm::sys::TimeValue(), 0 });
+    if (Forward)
+      return Forward->finishDependency(Kind);
+    record(EventKind::FinishDependency, Kind);
+    return true;
+  }
+
+  bool startSourceEntity(const EntityInfo &Info) override {
+    if (Forward)
+      return Forward->startSourceEntity(Info);
+    record(EventKind::StartSourceEntity, UIdent(), StringRef(), false, &Info);
+    return true;
+  }
+
+  bool recordRelatedEntity(const EntityInfo &Info) override {
+    if (Forward)
+      return Forward->recordRelatedEntity(Info);
+    record(EventKind::RecordRelatedEntity, UIdent(), StringRef(), false,
+           &Info);
+    return true;
+  }
+
+  bool finishSourceEntity(UIdent Kind) override {
+    if (Forward)
+      return Forward->finishSourceEntity(Kind);
+    record(EventKind::FinishSourceEntity, Kind);
+    return true;
+  }
+};
+} // end anonymous namespace
+
+/// Reports a recorded dependency to \p Consumer.
+static bool replayDependency(const SwiftIndexHashCache::Dependency &Dep,
+                             IndexingConsumer &Consumer) {
+  if (Dep.IsFinish)
+    return Consumer.finishDependency(Dep.Kind);
+  return Consumer.startDependency(Dep.Kind, Dep.Name, Dep.Path, Dep.IsSystem,
+                                  Dep.Hash);
+}
+
+void IndexRecorder::replay(IndexingConsumer &Consumer) const {
+  // The dependencies are only recorded in the hash entry.
+  auto Dep = HashEntry.Dependencies.begin();
+  for (const Event &E : Events) {
+    bool Continue = true;
+    switch (E.K) {
+    case EventKind::Failed:
+      Consumer.failed(E.Text);
+      break;
+    case EventKind::RecordHash:
+      Continue = Consumer.recordHash(E.Text, E.Flag);
+      break;
+    case EventKind::StartDependency:
+    case EventKind::FinishDependency:
+      assert(Dep != HashEntry.Dependencies.end());
+      Continue = replayDependency(*Dep++, Consumer);
+      break;
+    case EventKind::StartSourceEntity:
+      Continue = Consumer.startSourceEntity(E.Info);
+      break;
+    case EventKind::RecordRelatedEntity:
+      Continue = Consumer.recordRelatedEntity(E.Info);
+      break;
+    case EventKind::FinishSourceEntity:
+      Continue = Consumer.finishSourceEntity(E.Kind);
+      break;
+    }
+    if (!Continue)
+      return;
+  }
+}
+
+Optional<SwiftIndexHashCache::Entry> IndexRecorder::takeHashEntry() {
+  if (Failed || HashEntry.Hash.empty())
+    return None;
+  return std::move(HashEntry);
+}
+
+//===----------------------------------------------------------------------===//
+// SwiftIndexHashCache
+//===----------------------------------------------------------------------===//
+
+bool SwiftIndexHashCache::replay(StringRef Filename,
+                                 llvm::hash_code ContentHash,
+                                 StringRef KnownHash,
+                                 IndexingConsumer &Consumer) const {
+  if (KnownHash.empty())
+    return false;
+
+  Entry E;
+  {
+    llvm::sys::ScopedLock L(Mtx);
+    auto It = Entries.find(Filename);
+    if (It == Entries.end() || It->getValue().ContentHash != ContentHash ||
+        It->getValue().Hash != KnownHash)
+      return false;
+    E = It->getValue();
+  }
+
+  // The hash also covers the module files of the dependencies.
+  for (auto &Dep : E.Dependencies) {
+    if (Dep.IsFinish || Dep.Path.empty())
+      continue;
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(Dep.Path, Status) ||
+        Status.getLastModificationTime() != Dep.ModificationTime ||
+        Status.getSize() != Dep.Size)
+      return false;
+  }
+
+  // This is what indexing reports for a file whose hash is known.
+  if (!Consumer.recordHash(E.Hash, /*isKnown=*/true))
+    return true;
+  for (auto &Dep : E.Dependencies) {
+    if (!replayDependency(Dep, Consumer))
+      break;
+  }
+  return true;
+}
+
+void SwiftIndexHashCache::set(StringRef Filename, Entry E) {
+  llvm::sys::ScopedLock L(Mtx);
+  Entries[Filename] = std::move(E);
+}
+
 //===----------------------------------------------------------------------===//
 // IndexSource
 //===----------------------------------------------------------------------===//
@@ -194,6 +431,11 @@ void trace::initTraceFiles(trace::SwiftInvocation &SwiftArgs,
                 });
 }
 
+static void indexSourceImpl(SwiftLangSupport &Lang, StringRef InputFile,
+                            llvm::MemoryBuffer *InputBuf,
+                            IndexingConsumer &IdxConsumer,
+                            ArrayRef<const char *> Args, StringRef Hash);
+
 void SwiftLangSupport::indexSource(StringRef InputFile,
                                    IndexingConsumer &IdxConsumer,
                                    ArrayRef<const char *> Args,
@@ -205,6 +447,81 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
     return;
   }
 
+  StringRef FileExt = llvm::sys::path::extension(InputFile);
+  if (FileExt == ".swiftmodule" || FileExt == ".pcm") {
+    indexSourceImpl(*this, InputFile, InputBuf.get(), IdxConsumer, Args, Hash);
+    return;
+  }
+
+  // Skip the file if it did not change since it was indexed with this hash.
+  llvm::hash_code ContentHash = llvm::hash_value(InputBuf->getBuffer());
+  for (const char *Arg : Args)
+    ContentHash = llvm::hash_combine(ContentHash, StringRef(Arg));
+  if (IndexHashes.replay(InputFile, ContentHash, Hash, IdxConsumer))
+    return;
+
+  IndexRecorder Recorder(&IdxConsumer);
+  indexSourceImpl(*this, InputFile, InputBuf.get(), Recorder, Args, Hash);
+  if (auto HashEntry = Recorder.takeHashEntry()) {
+    HashEntry->ContentHash = ContentHash;
+    IndexHashes.set(InputFile, std::move(*HashEntry));
+  }
+}
+
+void SwiftLangSupport::indexSources(
+    ArrayRef<StringRef> Filenames, ArrayRef<StringRef> Hashes,
+    std::function<IndexingConsumer &(unsigned)> getConsumer,
+    ArrayRef<const char *> Args) {
+  assert(Filenames.size() == Hashes.size());
+
+  struct FileResult {
+    IndexRecorder Recorder;
+    bool Done = false;
+  };
+  std::vector<std::unique_ptr<FileResult>> Results;
+  for (unsigned i = 0, e = Filenames.size(); i != e; ++i)
+    Results.emplace_back(new FileResult());
+  std::mutex Mtx;
+  std::condition_variable DoneCond;
+
+  // Only a bounded number of files are indexed at the same time, each with
+  // its own compiler instance, and at most that many are waiting to be
+  // reported.
+  unsigned MaxInFlight = std::max(1u, std::thread::hardware_concurrency());
+  unsigned NextToDispatch = 0;
+  auto dispatchNext = [&] {
+    unsigned Idx = NextToDispatch++;
+    FileResult *Result = Results[Idx].get();
+    WorkQueue::dispatchConcurrent([this, &Filenames, &Hashes, &Args, &Mtx,
+                                   &DoneCond, Idx, Result] {
+      indexSource(Filenames[Idx], Result->Recorder, Args, Hashes[Idx]);
+      {
+        std::lock_guard<std::mutex> L(Mtx);
+        Result->Done = true;
+      }
+      DoneCond.notify_all();
+    }, WorkQueue::Priority::Default, /*isStackDeep=*/true);
+  };
+
+  for (unsigned i = 0, e = Filenames.size(); i != e; ++i) {
+    while (NextToDispatch != e && NextToDispatch < i + MaxInFlight)
+      dispatchNext();
+
+    FileResult *Result = Results[i].get();
+    {
+      std::unique_lock<std::mutex> L(Mtx);
+      DoneCond.wait(L, [Result] { return Result->Done; });
+    }
+    Result->Recorder.replay(getConsumer(i));
+    Results[i].reset();
+  }
+}
+
+static void indexSourceImpl(SwiftLangSupport &Lang, StringRef InputFile,
+                            llvm::MemoryBuffer *InputBuf,
+                            IndexingConsumer &IdxConsumer,
+                            ArrayRef<const char *> Args, StringRef Hash) {
+  std::string Error;
   StringRef Filename = llvm::sys::path::filename(InputFile);
   StringRef FileExt = llvm::sys::path::extension(Filename);
 
@@ -215,10 +532,9 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
   CI.addDiagnosticConsumer(&PrintDiags);
 
   CompilerInvocation Invocation;
-  bool Failed = getASTManager().initCompilerInvocation(Invocation, Args,
-                                                       CI.getDiags(),
-                    /*PrimaryFile=*/IsModuleIndexing ? StringRef() : InputFile,
-                                                       Error);
+  bool Failed = Lang.getASTManager().initCompilerInvocation(
+      Invocation, Args, CI.getDiags(),
+      /*PrimaryFile=*/IsModuleIndexing ? StringRef() : InputFile, Error);
   if (Failed) {
     IdxConsumer.failed(Error);
     return;
@@ -233,7 +549,7 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
       return;
     }
 
-    indexModule(InputBuf.get(), llvm::sys::path::stem(Filename),
+    indexModule(InputBuf, llvm::sys::path::stem(Filename),
                 Hash, IdxConsumer, CI, Args);
     return;
   }
@@ -33,6 +33,12 @@ namespace SourceKit {
 class SwiftInterfaceGenContext :
   public swift::ThreadSafeRefCountedBase<SwiftInterfaceGenContext> {
 public:
+  /// Generates the interface of a module or a header.
+  ///
+  /// If \p CacheDirectory isn't empty, the interface of a module is read
+  /// from the cache there if it was generated before with the same module
+  /// files and options, or stored there otherwise. The declarations that a
+  /// cached interface refers to are only resolved when they are looked up.
   static SwiftInterfaceGenContextRef create(StringRef DocumentName,
                                             bool IsModule,
                                             StringRef ModuleOrHeaderName,
@@ -40,7 +46,8 @@ public:
                                             swift::CompilerInvocation Invocation,
                                             std::string &ErrorMsg,
                                             bool SynthesizedExtensions,
-                                            Optional<StringRef> InterestedUSR);
+                                            Optional<StringRef> InterestedUSR,
+                                            StringRef CacheDirectory);
 
   static SwiftInterfaceGenContextRef createForSwiftSource(StringRef DocumentName,
                                                           StringRef SourceFileName,
@@ -22,9 +22,11 @@
 #include "swift/Basic/ThreadSafeRefCounted.h"
 #include "swift/IDE/Formatting.h"
 #include "swift/Index/IndexSymbol.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/TimeValue.h"
 #include <map>
 #include <string>
 
@@ -84,6 +86,7 @@ public:
   void readSyntaxInfo(EditorConsumer& consumer);
   void readSemanticInfo(ImmutableTextSnapshotRef Snapshot,
                         EditorConsumer& Consumer);
+  void readRange(unsigned Offset, unsigned Length, EditorConsumer &Consumer);
 
   void applyFormatOptions(OptionsDictionary &FmtOptions);
   void formatText(unsigned Line, unsigned Length, EditorConsumer &Consumer);
@@ -127,6 +130,11 @@ namespace CodeCompletion {
 /// The contents of the cache can be modified asynchronously during the session,
 /// but the contained objects are immutable.
 class SessionCache : public ThreadSafeRefCountedBase<SessionCache> {
+public:
+  /// The organized results of one request of the session.
+  struct FilteredResults;
+
+private:
   std::unique_ptr<llvm::MemoryBuffer> buffer;
   std::vector<std::string> args;
   CompletionSink sink;
@@ -134,6 +142,7 @@ class SessionCache : public ThreadSafeRefCountedBase<SessionCache> {
   CompletionKind completionKind;
   bool completionHasExpectedTypes;
   FilterRules filterRules;
+  std::shared_ptr<const FilteredResults> lastResults;
   llvm::sys::Mutex mtx;
 
 public:
@@ -152,6 +161,11 @@ public:
   const FilterRules &getFilterRules();
   CompletionKind getCompletionKind();
   bool getCompletionHasExpectedTypes();
+
+  /// The results of the last request, which the next request can page
+  /// through or refine, or null.
+  std::shared_ptr<const FilteredResults> getLastResults();
+  void setLastResults(std::shared_ptr<const FilteredResults> results);
 };
 typedef RefPtr<SessionCache> SessionCacheRef;
 
@@ -171,10 +185,48 @@ public:
   bool set(StringRef name, unsigned offset, SessionCacheRef session);
   bool remove(StringRef name, unsigned offset);
 };
+
+/// The results of the last codecomplete request, which the next one reuses
+/// instead of parsing and type-checking again if it completes at the same
+/// point of the same buffer with the same arguments, and the buffer only
+/// differs in the identifier being typed after the completion point. That
+/// identifier isn't part of the completed expression; clients filter the
+/// results by it.
+///
+/// As with a \c SessionCache, changes to the other files of the module are
+/// not noticed while the results are reused.
+class ReusableResults : public ThreadSafeRefCountedBase<ReusableResults> {
+  std::string bufferName;
+  unsigned offset;
+  std::vector<std::string> args;
+  /// The text of the buffer, and the range of the identifier after the
+  /// completion point in it.
+  std::string text;
+  unsigned identifierEnd;
+  /// Keeps the results alive.
+  CompletionSink sink;
+  std::vector<SwiftResult *> results;
+
+public:
+  ReusableResults(const llvm::MemoryBuffer &buffer, unsigned offset,
+                  ArrayRef<const char *> args);
+
+  /// Takes over the sorted \p results, which are stored in \p resultSink.
+  void setResults(ArrayRef<SwiftResult *> results,
+                  swift::ide::CodeCompletionResultSink &resultSink);
+  ArrayRef<SwiftResult *> getResults() const { return results; }
+
+  /// Whether the results are those of a request with the given buffer,
+  /// offset and arguments.
+  bool canReuse(const llvm::MemoryBuffer &buffer, unsigned offset,
+                ArrayRef<const char *> args) const;
+};
+typedef RefPtr<ReusableResults> ReusableResultsRef;
 } // end namespace CodeCompletion
 
 class SwiftInterfaceGenMap {
   llvm::StringMap<SwiftInterfaceGenContextRef> IFaceGens;
+  std::string CacheDirectory;
   mutable llvm::sys::Mutex Mtx;
 
 public:
@@ -183,6 +235,51 @@ public:
   bool remove(StringRef Name);
   SwiftInterfaceGenContextRef find(StringRef ModuleName,
                                    const swift::CompilerInvocation &Invok);
+
+  /// The directory in which generated module interfaces are cached across
+  /// sessions, or the empty string if they aren't.
+  void setCacheDirectory(StringRef Path);
+  std::string getCacheDirectory() const;
+};
+
+/// A thread-safe map from source file to the hash and the dependencies that
+/// were reported the last time the file was indexed.
+///
+/// If neither the contents of the file, nor the compiler arguments, nor the
+/// files of its dependencies changed since, re-indexing it for a client which
+/// already knows the hash does not need to type-check it.
+class SwiftIndexHashCache {
+public:
+  struct Dependency {
+    bool IsFinish;
+    UIdent Kind;
+    std::string Name;
+    std::string Path;
+    bool IsSystem;
+    std::string Hash;
+    /// The status of the file at \c Path when the dependency was recorded.
+    llvm::sys::TimeValue ModificationTime;
+    uint64_t Size;
+  };
+
+  struct Entry {
+    /// The hash of the file contents and the compiler arguments.
+    llvm::hash_code ContentHash;
+    std::string Hash;
+    std::vector<Dependency> Dependencies;
+  };
+
+private:
+  llvm::StringMap<Entry> Entries;
+  mutable llvm::sys::Mutex Mtx;
+
+public:
+  /// If the entry for \p Filename is up to date with \p ContentHash and
+  /// records \p KnownHash, reports the known hash and the dependencies to
+  /// \p Consumer and returns true.
+  bool replay(StringRef Filename, llvm::hash_code ContentHash,
+              StringRef KnownHash, IndexingConsumer &Consumer) const;
+  void set(StringRef Filename, Entry E);
 };
 
 struct SwiftCompletionCache
@@ -209,9 +306,11 @@ class SwiftLangSupport : public LangSupport {
   std::unique_ptr<SwiftASTManager> ASTMgr;
   SwiftEditorDocumentFileMap EditorDocuments;
   SwiftInterfaceGenMap IFaceGenContexts;
+  SwiftIndexHashCache IndexHashes;
   ThreadSafeRefCntPtr<SwiftCompletionCache> CCCache;
   ThreadSafeRefCntPtr<SwiftPopularAPI> PopularAPI;
   CodeCompletion::SessionCacheMap CCSessions;
+  ThreadSafeRefCntPtr<CodeCompletion::ReusableResults> LastCCResults;
   ThreadSafeRefCntPtr<SwiftCustomCompletions> CustomCompletions;
 
 public:
@@ -226,6 +325,7 @@ public:
 
   SwiftEditorDocumentFileMap &getEditorDocuments() { return EditorDocuments; }
   SwiftInterfaceGenMap &getIFaceGenContexts() { return IFaceGenContexts; }
+  SwiftIndexHashCache &getIndexHashes() { return IndexHashes; }
   IntrusiveRefCntPtr<SwiftCompletionCache> getCodeCompletionCache() {
     return CCCache;
   }
@@ -293,6 +393,10 @@ public:
   void indexSource(StringRef Filename, IndexingConsumer &Consumer,
                    ArrayRef<const char *> Args, StringRef Hash) override;
 
+  void indexSources(ArrayRef<StringRef> Filenames, ArrayRef<StringRef> Hashes,
+                    std::function<IndexingConsumer &(unsigned)> getConsumer,
+                    ArrayRef<const char *> Args) override;
+
   void codeComplete(llvm::MemoryBuffer *InputBuf, unsigned Offset,
                     SourceKit::CodeCompletionConsumer &Consumer,
                     ArrayRef<const char *> Args) override;
@@ -330,6 +434,8 @@ public:
                            bool SynthesizedExtensions,
                            Optional<StringRef> InterestedUSR) override;
 
+  void editorInterfaceCacheOnDisk(StringRef Path) override;
+
   void editorOpenHeaderInterface(EditorConsumer &Consumer,
                                  StringRef Name,
                                  StringRef HeaderName,
@@ -347,6 +453,9 @@ public:
                          unsigned Offset, unsigned Length,
                          EditorConsumer &Consumer) override;
 
+  void editorReadRange(StringRef Name, unsigned Offset, unsigned Length,
+                       EditorConsumer &Consumer) override;
+
   void editorApplyFormatOptions(StringRef Name,
                                 OptionsDictionary &FmtOptions) override;
 
@@ -371,6 +480,9 @@ public:
                                     ArrayRef<const char *> Args,
               std::function<void(const RelatedIdentsInfo &)> Receiver) override;
 
+  void getASTMemoryUsage(StringRef Filename, ArrayRef<const char *> Args,
+             std::function<void(const ASTMemoryUsageInfo &)> Receiver) override;
+
   void getDocInfo(llvm::MemoryBuffer *InputBuf,
                   StringRef ModuleName,
                   ArrayRef<const char *> Args,
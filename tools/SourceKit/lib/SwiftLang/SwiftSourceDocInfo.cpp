@@ -1336,3 +1336,104 @@ void SwiftLangSupport::findRelatedIdentifiersInFile(
   static const char OncePerASTToken = 0;
   ASTMgr->processASTAsync(Invok, std::move(Consumer), &OncePerASTToken);
 }
+
+//===----------------------------------------------------------------------===//
+// SwiftLangSupport::getASTMemoryUsage
+//===----------------------------------------------------------------------===//
+
+static StringRef getAllocationArenaName(AllocationArena Arena) {
+  switch (Arena) {
+  case AllocationArena::Permanent: return "permanent";
+  case AllocationArena::ConstraintSolver: return "solver";
+  }
+  llvm_unreachable("bad arena");
+}
+
+static StringRef getAllocationOriginName(AllocationOrigin Origin) {
+  switch (Origin) {
+  case AllocationOrigin::Source: return "source";
+  case AllocationOrigin::Deserialization: return "deserialization";
+  case AllocationOrigin::ClangImporter: return "clang";
+  }
+  llvm_unreachable("bad origin");
+}
+
+static StringRef getAllocationCategoryName(AllocationCategory Category) {
+  switch (Category) {
+  case AllocationCategory::Decl: return "decl";
+  case AllocationCategory::Type: return "type";
+  case AllocationCategory::Expr: return "expr";
+  case AllocationCategory::Stmt: return "stmt";
+  case AllocationCategory::Pattern: return "pattern";
+  case AllocationCategory::Conformance: return "conformance";
+  case AllocationCategory::Other: return "other";
+  }
+  llvm_unreachable("bad category");
+}
+
+void SwiftLangSupport::getASTMemoryUsage(
+    StringRef InputFile, ArrayRef<const char *> Args,
+    std::function<void(const ASTMemoryUsageInfo &)> Receiver) {
+
+  std::string Error;
+  SwiftInvocationRef Invok = ASTMgr->getInvocation(Args, InputFile, Error);
+  if (!Invok) {
+    // FIXME: Report it as failed request.
+    LOG_WARN_FUNC("failed to create an ASTInvocation: " << Error);
+    Receiver({});
+    return;
+  }
+
+  class MemoryUsageConsumer : public SwiftASTConsumer {
+    std::function<void(const ASTMemoryUsageInfo &)> Receiver;
+
+  public:
+    explicit MemoryUsageConsumer(
+        std::function<void(const ASTMemoryUsageInfo &)> Receiver)
+      : Receiver(std::move(Receiver)) { }
+
+    void handlePrimaryAST(ASTUnitRef AstUnit) override {
+      ASTContext &Ctx = AstUnit->getCompilerInstance().getASTContext();
+
+      std::vector<std::pair<std::string, size_t>> Allocations;
+      for (auto Arena : { AllocationArena::Permanent,
+                          AllocationArena::ConstraintSolver }) {
+        for (unsigned i = 0; i != NumAllocationOrigins; ++i) {
+          for (unsigned j = 0; j != NumAllocationCategories; ++j) {
+            auto Origin = AllocationOrigin(i);
+            auto Category = AllocationCategory(j);
+            size_t Bytes = Ctx.getAllocatedBytes(Arena, Origin, Category);
+            if (Bytes == 0)
+              continue;
+            std::string Name = getAllocationArenaName(Arena);
+            Name += '.';
+            Name += getAllocationOriginName(Origin);
+            Name += '.';
+            Name += getAllocationCategoryName(Category);
+            Allocations.push_back({std::move(Name), Bytes});
+          }
+        }
+      }
+
+      ASTMemoryUsageInfo Info;
+      Info.TotalBytes = Ctx.getTotalMemory();
+      Info.Allocations = Allocations;
+      Receiver(Info);
+    }
+
+    void cancelled() override {
+      ASTMemoryUsageInfo Info;
+      Info.IsCancelled = true;
+      Receiver(Info);
+    }
+
+    void failed(StringRef Error) override {
+      LOG_WARN_FUNC("AST memory usage failed: " << Error);
+      Receiver({});
+    }
+  };
+
+  auto Consumer = std::make_shared<MemoryUsageConsumer>(Receiver);
+  static const char OncePerASTToken = 0;
+  ASTMgr->processASTAsync(Invok, std::move(Consumer), &OncePerASTToken);
+}
@@ -101,11 +101,13 @@ bool TestOptions::parseArgs(llvm::ArrayRef<const char *> Args) {
   for (auto InputArg : ParsedArgs) {
     switch (InputArg->getOption().getID()) {
     case OPT_req:
+      RequestName = InputArg->getValue();
       Request = llvm::StringSwitch<SourceKitRequest>(InputArg->getValue())
         .Case("version", SourceKitRequest::ProtocolVersion)
         .Case("demangle", SourceKitRequest::DemangleNames)
         .Case("mangle", SourceKitRequest::MangleSimpleClasses)
         .Case("index", SourceKitRequest::Index)
+        .Case("index-batch", SourceKitRequest::IndexBatch)
         .Case("complete", SourceKitRequest::CodeComplete)
         .Case("complete.open", SourceKitRequest::CodeCompleteOpen)
         .Case("complete.close", SourceKitRequest::CodeCompleteClose)
@@ -114,14 +116,18 @@ bool TestOptions::parseArgs(llvm::ArrayRef<const char *> Args) {
         .Case("complete.setpopularapi", SourceKitRequest::CodeCompleteSetPopularAPI)
         .Case("cursor", SourceKitRequest::CursorInfo)
         .Case("related-idents", SourceKitRequest::RelatedIdents)
+        .Case("ast-memory", SourceKitRequest::ASTMemory)
         .Case("syntax-map", SourceKitRequest::SyntaxMap)
         .Case("structure", SourceKitRequest::Structure)
         .Case("format", SourceKitRequest::Format)
         .Case("expand-placeholder", SourceKitRequest::ExpandPlaceholder)
+        .Case("read-range", SourceKitRequest::ReadRange)
         .Case("doc-info", SourceKitRequest::DocInfo)
         .Case("sema", SourceKitRequest::SemanticInfo)
         .Case("interface-gen", SourceKitRequest::InterfaceGen)
         .Case("interface-gen-open", SourceKitRequest::InterfaceGenOpen)
+        .Case("interface-gen.cache.ondisk",
+              SourceKitRequest::InterfaceGenCacheOnDisk)
         .Case("find-usr", SourceKitRequest::FindUSR)
         .Case("find-interface", SourceKitRequest::FindInterfaceDoc)
         .Case("open", SourceKitRequest::Open)
@@ -133,8 +139,8 @@ bool TestOptions::parseArgs(llvm::ArrayRef<const char *> Args) {
         .Default(SourceKitRequest::None);
       if (Request == SourceKitRequest::None) {
         llvm::errs() << "error: invalid request, expected one of "
-            << "version/demangle/mangle/index/complete/cursor/related-idents/syntax-map/structure/"
-               "format/expand-placeholder/doc-info/sema/interface-gen/interface-gen-open/"
+            << "version/demangle/mangle/index/index-batch/complete/cursor/related-idents/syntax-map/structure/"
+               "format/expand-placeholder/read-range/doc-info/sema/interface-gen/interface-gen-open/"
                "find-usr/find-interface/open/edit/print-annotations/extract-comment/"
                "module-groups\n";
         return true;
@@ -223,6 +229,10 @@ bool TestOptions::parseArgs(llvm::ArrayRef<const char *> Args) {
       PrintRawResponse = true;
       break;
 
+    case OPT_print_latency:
+      PrintLatency = true;
+      break;
+
     case OPT_INPUT:
       SourceFile = InputArg->getValue();
       SourceText = llvm::None;
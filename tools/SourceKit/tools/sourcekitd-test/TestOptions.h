@@ -25,6 +25,7 @@ enum class SourceKitRequest {
   DemangleNames,
   MangleSimpleClasses,
   Index,
+  IndexBatch,
   CodeComplete,
   CodeCompleteOpen,
   CodeCompleteClose,
@@ -33,14 +34,17 @@ enum class SourceKitRequest {
   CodeCompleteSetPopularAPI,
   CursorInfo,
   RelatedIdents,
+  ASTMemory,
   SyntaxMap,
   Structure,
   Format,
   ExpandPlaceholder,
+  ReadRange,
   DocInfo,
   SemanticInfo,
   InterfaceGen,
   InterfaceGenOpen,
+  InterfaceGenCacheOnDisk,
   FindUSR,
   FindInterfaceDoc,
   Open,
@@ -76,6 +80,8 @@ struct TestOptions {
   bool UsedSema = false;
   bool PrintResponseAsJSON = false;
   bool PrintRawResponse = false;
+  bool PrintLatency = false;
+  std::string RequestName;
   bool SimplifiedDemangling = false;
   bool SynthesizedExtensions = false;
   bool parseArgs(llvm::ArrayRef<const char *> Args);
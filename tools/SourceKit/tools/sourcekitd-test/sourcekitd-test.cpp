@@ -23,9 +23,11 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/FileSystem.h"
+#include <chrono>
 #include <fstream>
 #include <unistd.h>
 #include <sys/param.h>
+#include <sys/resource.h>
 
 // FIXME: Platform compatibility.
 #include <dispatch/dispatch.h>
@@ -81,6 +83,7 @@ static sourcekitd_uid_t KeyRequest;
 static sourcekitd_uid_t KeyCompilerArgs;
 static sourcekitd_uid_t KeyOffset;
 static sourcekitd_uid_t KeySourceFile;
+static sourcekitd_uid_t KeySourceFiles;
 static sourcekitd_uid_t KeyModuleName;
 static sourcekitd_uid_t KeyGroupName;
 static sourcekitd_uid_t KeySynthesizedExtension;
@@ -124,6 +127,7 @@ static sourcekitd_uid_t RequestProtocolVersion;
 static sourcekitd_uid_t RequestDemangle;
 static sourcekitd_uid_t RequestMangleSimpleClass;
 static sourcekitd_uid_t RequestIndex;
+static sourcekitd_uid_t RequestIndexBatch;
 static sourcekitd_uid_t RequestCodeComplete;
 static sourcekitd_uid_t RequestCodeCompleteOpen;
 static sourcekitd_uid_t RequestCodeCompleteClose;
@@ -132,14 +136,17 @@ static sourcekitd_uid_t RequestCodeCompleteCacheOnDisk;
 static sourcekitd_uid_t RequestCodeCompleteSetPopularAPI;
 static sourcekitd_uid_t RequestCursorInfo;
 static sourcekitd_uid_t RequestRelatedIdents;
+static sourcekitd_uid_t RequestASTMemory;
 static sourcekitd_uid_t RequestEditorOpen;
 static sourcekitd_uid_t RequestEditorOpenInterface;
+static sourcekitd_uid_t RequestEditorInterfaceCacheOnDisk;
 static sourcekitd_uid_t RequestEditorOpenSwiftSourceInterface;
 static sourcekitd_uid_t RequestEditorOpenHeaderInterface;
 static sourcekitd_uid_t RequestEditorExtractTextFromComment;
 static sourcekitd_uid_t RequestEditorReplaceText;
 static sourcekitd_uid_t RequestEditorFormatText;
 static sourcekitd_uid_t RequestEditorExpandPlaceholder;
+static sourcekitd_uid_t RequestEditorReadRange;
 static sourcekitd_uid_t RequestEditorFindUSR;
 static sourcekitd_uid_t RequestEditorFindInterfaceDoc;
 static sourcekitd_uid_t RequestDocInfo;
@@ -177,6 +184,7 @@ static int skt_main(int argc, const char **argv) {
   KeyCompilerArgs = sourcekitd_uid_get_from_cstr("key.compilerargs");
   KeyOffset = sourcekitd_uid_get_from_cstr("key.offset");
   KeySourceFile = sourcekitd_uid_get_from_cstr("key.sourcefile");
+  KeySourceFiles = sourcekitd_uid_get_from_cstr("key.sourcefiles");
   KeyModuleName = sourcekitd_uid_get_from_cstr("key.modulename");
   KeyGroupName = sourcekitd_uid_get_from_cstr("key.groupname");
   KeySynthesizedExtension = sourcekitd_uid_get_from_cstr("key.synthesizedextensions");
@@ -228,6 +236,8 @@ static int skt_main(int argc, const char **argv) {
   RequestDemangle = sourcekitd_uid_get_from_cstr("source.request.demangle");
   RequestMangleSimpleClass = sourcekitd_uid_get_from_cstr("source.request.mangle_simple_class");
   RequestIndex = sourcekitd_uid_get_from_cstr("source.request.indexsource");
+  RequestIndexBatch =
+      sourcekitd_uid_get_from_cstr("source.request.indexsource.batch");
   RequestCodeComplete = sourcekitd_uid_get_from_cstr("source.request.codecomplete");
   RequestCodeCompleteOpen = sourcekitd_uid_get_from_cstr("source.request.codecomplete.open");
   RequestCodeCompleteClose = sourcekitd_uid_get_from_cstr("source.request.codecomplete.close");
@@ -236,14 +246,17 @@ static int skt_main(int argc, const char **argv) {
   RequestCodeCompleteSetPopularAPI = sourcekitd_uid_get_from_cstr("source.request.codecomplete.setpopularapi");
   RequestCursorInfo = sourcekitd_uid_get_from_cstr("source.request.cursorinfo");
   RequestRelatedIdents = sourcekitd_uid_get_from_cstr("source.request.relatedidents");
+  RequestASTMemory = sourcekitd_uid_get_from_cstr("source.request.ast.memory");
   RequestEditorOpen = sourcekitd_uid_get_from_cstr("source.request.editor.open");
   RequestEditorOpenInterface = sourcekitd_uid_get_from_cstr("source.request.editor.open.interface");
+  RequestEditorInterfaceCacheOnDisk = sourcekitd_uid_get_from_cstr("source.request.editor.open.interface.cache.ondisk");
   RequestEditorOpenSwiftSourceInterface = sourcekitd_uid_get_from_cstr("source.request.editor.open.interface.swiftsource");
   RequestEditorOpenHeaderInterface = sourcekitd_uid_get_from_cstr("source.request.editor.open.interface.header");
   RequestEditorExtractTextFromComment = sourcekitd_uid_get_from_cstr("source.request.editor.extract.comment");
   RequestEditorReplaceText = sourcekitd_uid_get_from_cstr("source.request.editor.replacetext");
   RequestEditorFormatText = sourcekitd_uid_get_from_cstr("source.request.editor.formattext");
   RequestEditorExpandPlaceholder = sourcekitd_uid_get_from_cstr("source.request.editor.expand_placeholder");
+  RequestEditorReadRange = sourcekitd_uid_get_from_cstr("source.request.editor.readrange");
   RequestEditorFindUSR = sourcekitd_uid_get_from_cstr("source.request.editor.find_usr");
   RequestEditorFindInterfaceDoc = sourcekitd_uid_get_from_cstr("source.request.editor.find_interface_doc");
   RequestDocInfo = sourcekitd_uid_get_from_cstr("source.request.docinfo");
@@ -284,6 +297,30 @@ static inline const char *getInterfaceGenDocumentName() {
 static int printAnnotations();
 static int printDiags();
 
+/// Prints the latency of a request, measured from \p Start, and the peak
+/// resident set size of the process so far, in the format which
+/// Benchmark_SourceKit reads:
+///
+///   LATENCY <request> <microseconds> <peak RSS in bytes>
+///
+/// The peak RSS includes the service only if sourcekitd runs in-process.
+static void printLatency(StringRef RequestName,
+                         std::chrono::steady_clock::time_point Start) {
+  auto Elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - Start);
+  struct rusage Usage;
+  uint64_t PeakRSS = 0;
+  if (getrusage(RUSAGE_SELF, &Usage) == 0) {
+    PeakRSS = Usage.ru_maxrss;
+#if !defined(__APPLE__)
+    // ru_maxrss is in kilobytes everywhere but on Darwin.
+    PeakRSS *= 1024;
+#endif
+  }
+  llvm::errs() << "LATENCY " << RequestName << ' ' << Elapsed.count() << ' '
+               << PeakRSS << '\n';
+}
+
 static void getSemanticInfo(sourcekitd_variant_t Info, StringRef Filename);
 
 static void addCodeCompleteOptions(sourcekitd_object_t Req, TestOptions &Opts) {
@@ -423,6 +460,22 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestIndex);
     break;
 
+  case SourceKitRequest::IndexBatch: {
+    sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestIndexBatch);
+    sourcekitd_object_t Files = sourcekitd_request_array_create(nullptr, 0);
+    for (auto &Input : Opts.Inputs) {
+      sourcekitd_object_t File =
+          sourcekitd_request_dictionary_create(nullptr, nullptr, 0);
+      sourcekitd_request_dictionary_set_string(File, KeySourceFile,
+                                               Input.c_str());
+      sourcekitd_request_array_set_value(Files, SOURCEKITD_ARRAY_APPEND, File);
+      sourcekitd_request_release(File);
+    }
+    sourcekitd_request_dictionary_set_value(Req, KeySourceFiles, Files);
+    sourcekitd_request_release(Files);
+    break;
+  }
+
   case SourceKitRequest::CodeComplete:
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestCodeComplete);
     sourcekitd_request_dictionary_set_int64(Req, KeyOffset, ByteOffset);
@@ -507,6 +560,10 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     sourcekitd_request_dictionary_set_int64(Req, KeyOffset, ByteOffset);
     break;
 
+  case SourceKitRequest::ASTMemory:
+    sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestASTMemory);
+    break;
+
   case SourceKitRequest::SyntaxMap:
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestEditorOpen);
     sourcekitd_request_dictionary_set_string(Req, KeyName, SourceFile.c_str());
@@ -532,6 +589,7 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     break;
       
   case SourceKitRequest::ExpandPlaceholder:
+  case SourceKitRequest::ReadRange:
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestEditorOpen);
     sourcekitd_request_dictionary_set_string(Req, KeyName, SourceFile.c_str());
     sourcekitd_request_dictionary_set_int64(Req, KeyEnableSyntaxMap, false);
@@ -604,6 +662,13 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
                                                Opts.InterestedUSR.c_str());
     break;
 
+  case SourceKitRequest::InterfaceGenCacheOnDisk:
+    sourcekitd_request_dictionary_set_uid(Req, KeyRequest,
+                                          RequestEditorInterfaceCacheOnDisk);
+    sourcekitd_request_dictionary_set_string(Req, KeyName,
+                                             Opts.CachePath.c_str());
+    break;
+
   case SourceKitRequest::FindInterfaceDoc:
     if (Opts.ModuleName.empty()) {
       llvm::errs() << "Missing '-module <module name>'\n";
@@ -663,6 +728,7 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
   }
 
   sourcekitd_request_description_dump(Req);
+  auto Start = std::chrono::steady_clock::now();
   sourcekitd_response_t Resp = sourcekitd_send_request_sync(Req);
   bool KeepResponseAlive = false;
   bool IsError = sourcekitd_response_is_error(Resp);
@@ -703,12 +769,14 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
 
     case SourceKitRequest::ProtocolVersion:
     case SourceKitRequest::Index:
+    case SourceKitRequest::IndexBatch:
     case SourceKitRequest::CodeComplete:
     case SourceKitRequest::CodeCompleteOpen:
     case SourceKitRequest::CodeCompleteClose:
     case SourceKitRequest::CodeCompleteUpdate:
     case SourceKitRequest::CodeCompleteCacheOnDisk:
     case SourceKitRequest::CodeCompleteSetPopularAPI:
+    case SourceKitRequest::ASTMemory:
       sourcekitd_response_description_dump_filedesc(Resp, STDOUT_FILENO);
       break;
 
@@ -744,6 +812,11 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
           sourcekitd_variant_dictionary_get_string(Info, KeySourceText);
       break;
 
+    case SourceKitRequest::InterfaceGenCacheOnDisk:
+      // Nothing to print, so that the output of the subsequent request can
+      // be compared with the one of an uncached request.
+      break;
+
     case SourceKitRequest::FindInterfaceDoc:
       printFoundInterface(Info, llvm::outs());
       break;
@@ -821,12 +894,36 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
       case SourceKitRequest::ExpandPlaceholder:
         expandPlaceholders(SourceBuf.get(), llvm::outs());
         break;
+      case SourceKitRequest::ReadRange:
+        {
+          unsigned Offset = resolveFromLineCol(Opts.Line, Opts.Col, SourceFile);
+          sourcekitd_object_t RR = sourcekitd_request_dictionary_create(nullptr,
+                                                                    nullptr, 0);
+          sourcekitd_request_dictionary_set_uid(RR, KeyRequest,
+                                                RequestEditorReadRange);
+          sourcekitd_request_dictionary_set_string(RR, KeyName,
+                                                   SourceFile.c_str());
+          sourcekitd_request_dictionary_set_int64(RR, KeyOffset, Offset);
+          sourcekitd_request_dictionary_set_int64(RR, KeyLength, Opts.Length);
+          sourcekitd_request_dictionary_set_int64(RR, KeySyntacticOnly,
+                                                  !Opts.UsedSema);
+          sourcekitd_response_t RRResp = sourcekitd_send_request_sync(RR);
+          sourcekitd_response_description_dump_filedesc(RRResp, STDOUT_FILENO);
+          sourcekitd_response_dispose(RRResp);
+          sourcekitd_request_release(RR);
+        }
+        break;
       case SourceKitRequest::ModuleGroups:
         printModuleGroupNames(Info, llvm::outs());
         break;
     }
   }
 
+  // The latency includes waiting for the semantic info after opening or
+  // editing a document, and printing the response.
+  if (Opts.PrintLatency)
+    printLatency(Opts.RequestName, Start);
+
   if (!KeepResponseAlive)
     sourcekitd_response_dispose(Resp);
   sourcekitd_request_release(Req);
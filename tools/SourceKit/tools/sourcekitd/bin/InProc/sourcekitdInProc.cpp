@@ -15,6 +15,7 @@
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/UIdent.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/Path.h"
 
@@ -115,25 +116,90 @@ sourcekitd_response_t sourcekitd_send_request_sync(sourcekitd_object_t req) {
   return ReturnedResp;
 }
 
+namespace {
+/// The asynchronous requests which did not deliver their response yet.
+///
+/// A request handle is the ID of the request. IDs are never reused, so
+/// cancelling a request after its response was delivered has no effect.
+class InFlightRequests {
+  llvm::sys::Mutex Mtx;
+  /// Whether the request with the ID was cancelled.
+  llvm::DenseMap<uintptr_t, bool> Requests;
+  uintptr_t NextID = 1;
+
+public:
+  uintptr_t add() {
+    llvm::sys::ScopedLock L(Mtx);
+    uintptr_t ID = NextID++;
+    Requests[ID] = false;
+    return ID;
+  }
+
+  void cancel(uintptr_t ID) {
+    llvm::sys::ScopedLock L(Mtx);
+    auto It = Requests.find(ID);
+    if (It != Requests.end())
+      It->second = true;
+  }
+
+  bool isCancelled(uintptr_t ID) {
+    llvm::sys::ScopedLock L(Mtx);
+    auto It = Requests.find(ID);
+    return It != Requests.end() && It->second;
+  }
+
+  /// Removes the request when its response is delivered.
+  /// \returns true if the request was cancelled.
+  bool remove(uintptr_t ID) {
+    llvm::sys::ScopedLock L(Mtx);
+    auto It = Requests.find(ID);
+    if (It == Requests.end())
+      return false;
+    bool Cancelled = It->second;
+    Requests.erase(It);
+    return Cancelled;
+  }
+};
+} // end anonymous namespace
+
+static InFlightRequests &getInFlightRequests() {
+  static InFlightRequests Requests;
+  return Requests;
+}
+
 void sourcekitd_send_request(sourcekitd_object_t req,
                              sourcekitd_request_handle_t *out_handle,
                              sourcekitd_response_receiver_t receiver) {
-  // FIXME: Implement request handle.
+  uintptr_t ID = getInFlightRequests().add();
+  if (out_handle)
+    *out_handle = reinterpret_cast<sourcekitd_request_handle_t>(ID);
 
   sourcekitd_request_retain(req);
   receiver = Block_copy(receiver);
   WorkQueue::dispatchConcurrent([=]{
-    sourcekitd::handleRequest(req, [&](sourcekitd_response_t resp) {
+    auto respond = [receiver, ID](sourcekitd_response_t resp) {
+      // The work for a request cancelled while it was running is not undone,
+      // but the receiver only learns that it was cancelled.
+      if (getInFlightRequests().remove(ID)) {
+        sourcekitd_response_dispose(resp);
+        resp = sourcekitd::createErrorRequestCancelled();
+      }
       // The receiver accepts ownership of the response.
       receiver(resp);
       Block_release(receiver);
-    });
+    };
+
+    // Don't start a request which was cancelled while it was queued.
+    if (getInFlightRequests().isCancelled(ID))
+      respond(sourcekitd::createErrorRequestCancelled());
+    else
+      sourcekitd::handleRequest(req, respond);
     sourcekitd_request_release(req);
   });
 }
 
 void sourcekitd_cancel_request(sourcekitd_request_handle_t handle) {
-  // FIXME: Implement cancelling.
+  getInFlightRequests().cancel(reinterpret_cast<uintptr_t>(handle));
 }
 
 void
@@ -0,0 +1,65 @@
+//===--- BinaryVariant.h - --------------------------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A compact binary encoding of sourcekitd variants, for transports which
+// cannot pass XPC objects, like pipes and sockets. The receiver reads the
+// values in place; strings point straight into the message buffer.
+//
+// UIDs are not sent as strings in every message. Both ends of a connection
+// keep a BinaryUIDTable: a message announces the UIDs which its sender uses
+// for the first time and otherwise refers to UIDs by their table index.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SOURCEKITD_BINARYVARIANT_H
+#define LLVM_SOURCEKITD_BINARYVARIANT_H
+
+#include "sourcekitd/Internal.h"
+#include "llvm/ADT/DenseMap.h"
+#include <vector>
+
+namespace sourcekitd {
+
+/// The UIDs which were exchanged on one connection, in the order they were
+/// first sent.
+class BinaryUIDTable {
+  llvm::DenseMap<sourcekitd_uid_t, unsigned> Indices;
+  std::vector<sourcekitd_uid_t> UIDs;
+
+public:
+  /// Returns the index of \p UID. If the table does not contain it yet it is
+  /// added and \p IsNew is set to true.
+  unsigned getOrAddIndex(sourcekitd_uid_t UID, bool &IsNew);
+
+  /// Returns the UID at \p Index, or null if there is no such entry.
+  sourcekitd_uid_t getUID(unsigned Index) const {
+    return Index < UIDs.size() ? UIDs[Index] : nullptr;
+  }
+
+  size_t size() const { return UIDs.size(); }
+};
+
+/// Appends the encoding of \p Var to \p Buf. UIDs which are not in \p UIDs
+/// yet are added to it and announced in the message.
+void encodeBinaryVariant(sourcekitd_variant_t Var, BinaryUIDTable &UIDs,
+                         llvm::SmallVectorImpl<char> &Buf);
+
+/// Returns a variant which reads the message in \p Buf, which must have been
+/// produced by encodeBinaryVariant, in place. The UIDs the message announces
+/// are added to \p UIDs. Both \p Buf and \p UIDs must outlive the returned
+/// variant. Returns a null variant if the message header is malformed.
+sourcekitd_variant_t decodeBinaryVariant(llvm::StringRef Buf,
+                                         BinaryUIDTable &UIDs);
+
+}
+
+#endif
@@ -15,6 +15,7 @@
 
 #include "sourcekitd/Internal.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 
 namespace sourcekitd {
 
@@ -38,6 +39,9 @@ private:
 
   llvm::SmallVector<uint8_t, 256> EntriesBuffer;
   llvm::SmallString<256> StringBuffer;
+  /// The offsets of the strings in StringBuffer. Entries refer to the same
+  /// copy of a string they have in common, like the type names of results.
+  llvm::StringMap<unsigned> StringOffsets;
 };
 
 template <typename ...EntryTypes>
@@ -0,0 +1,341 @@
+//===--- BinaryVariant.cpp ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A message is laid out as
+//
+//   uint32_t NumNewUIDs
+//   { uint32_t Length; char Name[Length]; } [NumNewUIDs]
+//   Value
+//
+// and a value as a uint8_t variant type followed by
+//
+//   NULL:       nothing
+//   BOOL:       uint8_t
+//   INT64:      int64_t
+//   STRING:     uint32_t Length; char Chars[Length]; '\0'
+//   UID:        uint32_t Index
+//   ARRAY:      uint32_t Count; uint32_t Offset[Count]; Value...
+//   DICTIONARY: uint32_t Count; { uint32_t Key; uint32_t Offset; } [Count];
+//               Value...
+//
+// where the offsets of the elements are relative to the start of the
+// containing value. All scalars are in host byte order and unaligned.
+//
+//===----------------------------------------------------------------------===//
+
+#include "sourcekitd/BinaryVariant.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ErrorHandling.h"
+#include <string.h>
+
+using namespace sourcekitd;
+using llvm::SmallVectorImpl;
+using llvm::StringRef;
+
+unsigned BinaryUIDTable::getOrAddIndex(sourcekitd_uid_t UID, bool &IsNew) {
+  auto Result = Indices.insert({ UID, unsigned(UIDs.size()) });
+  IsNew = Result.second;
+  if (IsNew)
+    UIDs.push_back(UID);
+  return Result.first->second;
+}
+
+//===----------------------------------------------------------------------===//
+// Encoding
+//===----------------------------------------------------------------------===//
+
+template <typename T>
+static void addScalar(T Val, SmallVectorImpl<char> &Buf) {
+  const char *ValPtr = reinterpret_cast<const char *>(&Val);
+  Buf.append(ValPtr, ValPtr + sizeof(Val));
+}
+
+template <typename T>
+static void setScalar(T Val, SmallVectorImpl<char> &Buf, size_t Offset) {
+  memcpy(Buf.data() + Offset, &Val, sizeof(Val));
+}
+
+namespace {
+class BinaryVariantEncoder {
+  BinaryUIDTable &UIDs;
+  SmallVectorImpl<char> &Buf;
+  std::vector<sourcekitd_uid_t> &NewUIDs;
+
+public:
+  BinaryVariantEncoder(BinaryUIDTable &UIDs, SmallVectorImpl<char> &Buf,
+                       std::vector<sourcekitd_uid_t> &NewUIDs)
+    : UIDs(UIDs), Buf(Buf), NewUIDs(NewUIDs) {}
+
+  void addUID(sourcekitd_uid_t UID) {
+    bool IsNew;
+    addScalar(uint32_t(UIDs.getOrAddIndex(UID, IsNew)), Buf);
+    if (IsNew)
+      NewUIDs.push_back(UID);
+  }
+
+  void addValue(sourcekitd_variant_t Var) {
+    auto Type = sourcekitd_variant_get_type(Var);
+    addScalar(uint8_t(Type), Buf);
+
+    switch (Type) {
+    case SOURCEKITD_VARIANT_TYPE_NULL:
+      return;
+    case SOURCEKITD_VARIANT_TYPE_BOOL:
+      addScalar(uint8_t(sourcekitd_variant_bool_get_value(Var)), Buf);
+      return;
+    case SOURCEKITD_VARIANT_TYPE_INT64:
+      addScalar(sourcekitd_variant_int64_get_value(Var), Buf);
+      return;
+    case SOURCEKITD_VARIANT_TYPE_STRING: {
+      size_t Length = sourcekitd_variant_string_get_length(Var);
+      const char *Ptr = sourcekitd_variant_string_get_ptr(Var);
+      addScalar(uint32_t(Length), Buf);
+      Buf.append(Ptr, Ptr + Length);
+      Buf.push_back('\0');
+      return;
+    }
+    case SOURCEKITD_VARIANT_TYPE_UID:
+      addUID(sourcekitd_variant_uid_get_value(Var));
+      return;
+    case SOURCEKITD_VARIANT_TYPE_ARRAY: {
+      size_t Start = Buf.size() - 1;
+      size_t Count = sourcekitd_variant_array_get_count(Var);
+      addScalar(uint32_t(Count), Buf);
+      size_t OffsetTable = Buf.size();
+      Buf.resize(Buf.size() + Count * sizeof(uint32_t));
+      for (size_t i = 0; i != Count; ++i) {
+        setScalar(uint32_t(Buf.size() - Start), Buf,
+                  OffsetTable + i * sizeof(uint32_t));
+        addValue(sourcekitd_variant_array_get_value(Var, i));
+      }
+      return;
+    }
+    case SOURCEKITD_VARIANT_TYPE_DICTIONARY:
+      addDictionary(Var);
+      return;
+    }
+    llvm_unreachable("unknown variant type");
+  }
+
+private:
+  void addDictionary(sourcekitd_variant_t Dict) {
+    size_t Start = Buf.size() - 1;
+    typedef llvm::SmallVector<std::pair<sourcekitd_uid_t,
+                                        sourcekitd_variant_t>, 16> EntryList;
+    EntryList Entries;
+    sourcekitd_variant_dictionary_apply_f(Dict,
+      [](sourcekitd_uid_t Key, sourcekitd_variant_t Value, void *Ctx) {
+        static_cast<EntryList *>(Ctx)->push_back({ Key, Value });
+        return true;
+      }, &Entries);
+
+    addScalar(uint32_t(Entries.size()), Buf);
+    size_t EntryTable = Buf.size();
+    for (auto &Entry : Entries) {
+      addUID(Entry.first);
+      addScalar(uint32_t(0), Buf);
+    }
+    for (size_t i = 0, e = Entries.size(); i != e; ++i) {
+      setScalar(uint32_t(Buf.size() - Start), Buf,
+                EntryTable + (2 * i + 1) * sizeof(uint32_t));
+      addValue(Entries[i].second);
+    }
+  }
+};
+}
+
+void sourcekitd::encodeBinaryVariant(sourcekitd_variant_t Var,
+                                     BinaryUIDTable &UIDs,
+                                     SmallVectorImpl<char> &Buf) {
+  // The new UIDs are only known once the value is encoded, so encode it into
+  // a side buffer and put the UID names in front of it.
+  std::vector<sourcekitd_uid_t> NewUIDs;
+  llvm::SmallVector<char, 256> ValueBuf;
+  BinaryVariantEncoder(UIDs, ValueBuf, NewUIDs).addValue(Var);
+
+  addScalar(uint32_t(NewUIDs.size()), Buf);
+  for (auto UID : NewUIDs) {
+    StringRef Name = sourcekitd_uid_get_string_ptr(UID);
+    addScalar(uint32_t(Name.size()), Buf);
+    Buf.append(Name.begin(), Name.end());
+  }
+  Buf.append(ValueBuf.begin(), ValueBuf.end());
+}
+
+//===----------------------------------------------------------------------===//
+// Decoding
+//===----------------------------------------------------------------------===//
+
+// A decoded variant stores a pointer to the encoded value in data[1] and the
+// UID table in data[2].
+
+template <typename T>
+static T readScalar(const char *Ptr) {
+  T Val;
+  memcpy(&Val, Ptr, sizeof(Val));
+  return Val;
+}
+
+namespace {
+struct BinaryVariantFuncs {
+  static const char *getValue(sourcekitd_variant_t Var) {
+    return reinterpret_cast<const char *>(Var.data[1]);
+  }
+
+  static const BinaryUIDTable &getUIDs(sourcekitd_variant_t Var) {
+    return *reinterpret_cast<const BinaryUIDTable *>(Var.data[2]);
+  }
+
+  static sourcekitd_variant_t makeVariant(const char *Value,
+                                          const BinaryUIDTable &UIDs);
+
+  static sourcekitd_variant_type_t get_type(sourcekitd_variant_t Var) {
+    return sourcekitd_variant_type_t(uint8_t(*getValue(Var)));
+  }
+
+  static const char *getPayload(sourcekitd_variant_t Var) {
+    return getValue(Var) + 1;
+  }
+
+  static bool bool_get_value(sourcekitd_variant_t Var) {
+    return readScalar<uint8_t>(getPayload(Var));
+  }
+
+  static int64_t int64_get_value(sourcekitd_variant_t Var) {
+    return readScalar<int64_t>(getPayload(Var));
+  }
+
+  static size_t string_get_length(sourcekitd_variant_t Var) {
+    return readScalar<uint32_t>(getPayload(Var));
+  }
+
+  static const char *string_get_ptr(sourcekitd_variant_t Var) {
+    return getPayload(Var) + sizeof(uint32_t);
+  }
+
+  static sourcekitd_uid_t uid_get_value(sourcekitd_variant_t Var) {
+    return getUIDs(Var).getUID(readScalar<uint32_t>(getPayload(Var)));
+  }
+
+  static size_t array_get_count(sourcekitd_variant_t Array) {
+    return readScalar<uint32_t>(getPayload(Array));
+  }
+
+  static sourcekitd_variant_t array_get_value(sourcekitd_variant_t Array,
+                                              size_t Index) {
+    if (Index >= array_get_count(Array))
+      return makeNullVariant();
+    const char *Offsets = getPayload(Array) + sizeof(uint32_t);
+    auto Offset = readScalar<uint32_t>(Offsets + Index * sizeof(uint32_t));
+    return makeVariant(getValue(Array) + Offset, getUIDs(Array));
+  }
+
+  static bool array_apply(sourcekitd_variant_t Array,
+                          sourcekitd_variant_array_applier_t Applier) {
+    for (size_t i = 0, e = array_get_count(Array); i != e; ++i) {
+      if (!Applier(i, array_get_value(Array, i)))
+        return false;
+    }
+    return true;
+  }
+
+  static sourcekitd_variant_t
+  dictionary_get_value(sourcekitd_variant_t Dict, sourcekitd_uid_t Key) {
+    const BinaryUIDTable &UIDs = getUIDs(Dict);
+    const char *Entries = getPayload(Dict) + sizeof(uint32_t);
+    for (size_t i = 0, e = readScalar<uint32_t>(getPayload(Dict)); i != e;
+         ++i, Entries += 2 * sizeof(uint32_t)) {
+      if (UIDs.getUID(readScalar<uint32_t>(Entries)) != Key)
+        continue;
+      auto Offset = readScalar<uint32_t>(Entries + sizeof(uint32_t));
+      return makeVariant(getValue(Dict) + Offset, UIDs);
+    }
+    return makeNullVariant();
+  }
+
+  static bool
+  dictionary_apply(sourcekitd_variant_t Dict,
+                   sourcekitd_variant_dictionary_applier_t Applier) {
+    const BinaryUIDTable &UIDs = getUIDs(Dict);
+    const char *Entries = getPayload(Dict) + sizeof(uint32_t);
+    for (size_t i = 0, e = readScalar<uint32_t>(getPayload(Dict)); i != e;
+         ++i, Entries += 2 * sizeof(uint32_t)) {
+      auto Key = UIDs.getUID(readScalar<uint32_t>(Entries));
+      auto Offset = readScalar<uint32_t>(Entries + sizeof(uint32_t));
+      if (!Applier(Key, makeVariant(getValue(Dict) + Offset, UIDs)))
+        return false;
+    }
+    return true;
+  }
+
+  static sourcekitd_variant_t makeNullVariant() {
+    return {{ 0, 0, 0 }};
+  }
+
+  static VariantFunctions Funcs;
+};
+}
+
+VariantFunctions BinaryVariantFuncs::Funcs = {
+  get_type,
+  array_apply,
+  nullptr/*Annot_array_get_bool*/,
+  array_get_count,
+  nullptr/*Annot_array_get_int64*/,
+  nullptr/*Annot_array_get_string*/,
+  nullptr/*Annot_array_get_uid*/,
+  array_get_value,
+  bool_get_value,
+  dictionary_apply,
+  nullptr/*Annot_dictionary_get_bool*/,
+  nullptr/*Annot_dictionary_get_int64*/,
+  nullptr/*Annot_dictionary_get_string*/,
+  dictionary_get_value,
+  nullptr/*Annot_dictionary_get_uid*/,
+  string_get_length,
+  string_get_ptr,
+  int64_get_value,
+  uid_get_value,
+};
+
+sourcekitd_variant_t
+BinaryVariantFuncs::makeVariant(const char *Value,
+                                const BinaryUIDTable &UIDs) {
+  return {{ (uintptr_t)&Funcs, (uintptr_t)Value, (uintptr_t)&UIDs }};
+}
+
+sourcekitd_variant_t sourcekitd::decodeBinaryVariant(StringRef Buf,
+                                                     BinaryUIDTable &UIDs) {
+  const char *Ptr = Buf.begin();
+  const char *End = Buf.end();
+  if (End - Ptr < (ptrdiff_t)sizeof(uint32_t))
+    return BinaryVariantFuncs::makeNullVariant();
+  auto NumNewUIDs = readScalar<uint32_t>(Ptr);
+  Ptr += sizeof(uint32_t);
+
+  for (uint32_t i = 0; i != NumNewUIDs; ++i) {
+    if (End - Ptr < (ptrdiff_t)sizeof(uint32_t))
+      return BinaryVariantFuncs::makeNullVariant();
+    auto Length = readScalar<uint32_t>(Ptr);
+    Ptr += sizeof(uint32_t);
+    if (End - Ptr < (ptrdiff_t)Length)
+      return BinaryVariantFuncs::makeNullVariant();
+    bool IsNew;
+    UIDs.getOrAddIndex(sourcekitd_uid_get_from_buf(Ptr, Length), IsNew);
+    Ptr += Length;
+  }
+
+  if (Ptr == End)
+    return BinaryVariantFuncs::makeNullVariant();
+  return BinaryVariantFuncs::makeVariant(Ptr, UIDs);
+}
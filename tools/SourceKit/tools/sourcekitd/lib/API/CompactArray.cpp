@@ -59,9 +59,14 @@ unsigned CompactArrayBuilderImpl::getOffsetForString(StringRef Str) {
   if (Str.empty())
     return 0;
 
+  auto Inserted = StringOffsets.insert(std::make_pair(Str, 0));
+  if (!Inserted.second)
+    return Inserted.first->second;
+
   unsigned Offset = StringBuffer.size();
   StringBuffer += Str;
   StringBuffer += '\0';
+  Inserted.first->second = Offset;
   return Offset;
 }
 
@@ -26,6 +26,7 @@ extern SourceKit::UIdent KeyRequest;
 extern SourceKit::UIdent KeyCompilerArgs;
 extern SourceKit::UIdent KeyOffset;
 extern SourceKit::UIdent KeySourceFile;
+extern SourceKit::UIdent KeySourceFiles;
 extern SourceKit::UIdent KeySourceText;
 extern SourceKit::UIdent KeyModuleName;
 extern SourceKit::UIdent KeyGroupName;
@@ -118,6 +119,7 @@ extern SourceKit::UIdent KeyObsoleted;
 extern SourceKit::UIdent KeyRemoveCache;
 extern SourceKit::UIdent KeyTypeInterface;
 extern SourceKit::UIdent KeyModuleGroups;
+extern SourceKit::UIdent KeyBytes;
 
 /// \brief Used for determining the printing order of dictionary keys.
 bool compareDictKeys(SourceKit::UIdent LHS, SourceKit::UIdent RHS);
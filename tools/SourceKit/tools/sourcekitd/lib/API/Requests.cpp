@@ -66,6 +66,7 @@ static LazySKDUID RequestDemangle("source.request.demangle");
 static LazySKDUID RequestMangleSimpleClass("source.request.mangle_simple_class");
 
 static LazySKDUID RequestIndex("source.request.indexsource");
+static LazySKDUID RequestIndexBatch("source.request.indexsource.batch");
 static LazySKDUID RequestDocInfo("source.request.docinfo");
 static LazySKDUID RequestCodeComplete("source.request.codecomplete");
 static LazySKDUID RequestCodeCompleteOpen("source.request.codecomplete.open");
@@ -80,17 +81,21 @@ static LazySKDUID
     RequestCodeCompleteSetCustom("source.request.codecomplete.setcustom");
 static LazySKDUID RequestCursorInfo("source.request.cursorinfo");
 static LazySKDUID RequestRelatedIdents("source.request.relatedidents");
+static LazySKDUID RequestASTMemory("source.request.ast.memory");
 static LazySKDUID RequestEditorOpen("source.request.editor.open");
 static LazySKDUID RequestEditorOpenInterface(
     "source.request.editor.open.interface");
 static LazySKDUID RequestEditorOpenHeaderInterface(
     "source.request.editor.open.interface.header");
+static LazySKDUID RequestEditorInterfaceCacheOnDisk(
+    "source.request.editor.open.interface.cache.ondisk");
 static LazySKDUID RequestEditorOpenSwiftSourceInterface(
     "source.request.editor.open.interface.swiftsource");
 static LazySKDUID RequestEditorExtractTextFromComment(
     "source.request.editor.extract.comment");
 static LazySKDUID RequestEditorClose("source.request.editor.close");
 static LazySKDUID RequestEditorReplaceText("source.request.editor.replacetext");
+static LazySKDUID RequestEditorReadRange("source.request.editor.readrange");
 static LazySKDUID RequestEditorFormatText("source.request.editor.formattext");
 static LazySKDUID RequestEditorExpandPlaceholder(
     "source.request.editor.expand_placeholder");
@@ -156,6 +161,10 @@ static sourcekitd_response_t indexSource(StringRef Filename,
                                          ArrayRef<const char *> Args,
                                          StringRef KnownHash);
 
+static sourcekitd_response_t indexSources(ArrayRef<StringRef> Filenames,
+                                          ArrayRef<StringRef> KnownHashes,
+                                          ArrayRef<const char *> Args);
+
 static sourcekitd_response_t reportDocInfo(llvm::MemoryBuffer *InputBuf,
                                            StringRef ModuleName,
                                            ArrayRef<const char *> Args);
@@ -167,6 +176,10 @@ static void findRelatedIdents(StringRef Filename,
                               ArrayRef<const char *> Args,
                               ResponseReceiver Rec);
 
+static void reportASTMemoryUsage(StringRef Filename,
+                                 ArrayRef<const char *> Args,
+                                 ResponseReceiver Rec);
+
 static sourcekitd_response_t codeComplete(llvm::MemoryBuffer *InputBuf,
                                           int64_t Offset,
                                           ArrayRef<const char *> Args);
@@ -214,6 +227,11 @@ editorReplaceText(StringRef Name, llvm::MemoryBuffer *Buf, unsigned Offset,
                   unsigned Length, bool EnableSyntaxMap, bool EnableStructure,
                   bool EnableDiagnostics, bool SyntacticOnly);
 
+static sourcekitd_response_t
+editorReadRange(StringRef Name, unsigned Offset, unsigned Length,
+                bool EnableSyntaxMap, bool EnableStructure,
+                bool SyntacticOnly);
+
 static void
 editorApplyFormatOptions(StringRef Name, RequestDict &FmtOptions);
 
@@ -440,6 +458,23 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
                                  EnableSyntaxMap, EnableStructure,
                                  EnableDiagnostics, SyntacticOnly));
   }
+  if (ReqUID == RequestEditorReadRange) {
+    Optional<StringRef> Name = Req.getString(KeyName);
+    if (!Name.hasValue())
+      return Rec(createErrorRequestInvalid("missing 'key.name'"));
+    int64_t Offset = 0;
+    Req.getInt64(KeyOffset, Offset, /*isOptional=*/false);
+    int64_t Length = 0;
+    Req.getInt64(KeyLength, Length, /*isOptional=*/false);
+    int64_t EnableSyntaxMap = true;
+    Req.getInt64(KeyEnableSyntaxMap, EnableSyntaxMap, /*isOptional=*/true);
+    int64_t EnableStructure = true;
+    Req.getInt64(KeyEnableStructure, EnableStructure, /*isOptional=*/true);
+    int64_t SyntacticOnly = false;
+    Req.getInt64(KeySyntacticOnly, SyntacticOnly, /*isOptional=*/true);
+    return Rec(editorReadRange(*Name, Offset, Length, EnableSyntaxMap,
+                               EnableStructure, SyntacticOnly));
+  }
   if (ReqUID == RequestEditorFormatText) {
     Optional<StringRef> Name = Req.getString(KeyName);
     if (!Name.hasValue())
@@ -556,6 +591,16 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     return Rec(b.createResponse());
   }
 
+  if (ReqUID == RequestEditorInterfaceCacheOnDisk) {
+    Optional<StringRef> Name = Req.getString(KeyName);
+    if (!Name.hasValue())
+      return Rec(createErrorRequestInvalid("missing 'key.name'"));
+    LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
+    Lang.editorInterfaceCacheOnDisk(*Name);
+    ResponseBuilder b;
+    return Rec(b.createResponse());
+  }
+
   if (ReqUID == RequestCodeCompleteSetPopularAPI) {
     llvm::SmallVector<const char *, 0> popular;
     llvm::SmallVector<const char *, 0> unpopular;
@@ -689,6 +734,31 @@ handleSemanticRequest(RequestDict Req,
     return Rec(codeCompleteUpdate(*Name, Offset, options));
   }
 
+  if (ReqUID == RequestIndexBatch) {
+    SmallVector<StringRef, 16> Filenames;
+    SmallVector<StringRef, 16> Hashes;
+    sourcekitd_response_t err = nullptr;
+    bool failed = Req.dictionaryArrayApply(KeySourceFiles,
+                                           [&](RequestDict dict) {
+      Optional<StringRef> Filename = dict.getString(KeySourceFile);
+      if (!Filename.hasValue()) {
+        err = createErrorRequestInvalid("missing 'key.sourcefile'");
+        return true;
+      }
+      Filenames.push_back(*Filename);
+      Hashes.push_back(dict.getString(KeyHash).getValueOr(StringRef()));
+      return false;
+    });
+
+    if (failed) {
+      if (!err)
+        err = createErrorRequestInvalid("missing 'key.sourcefiles'");
+      return Rec(err);
+    }
+
+    return Rec(indexSources(Filenames, Hashes, Args));
+  }
+
   if (!SourceFile.hasValue())
     return Rec(createErrorRequestInvalid("missing 'key.sourcefile'"));
 
@@ -728,6 +798,9 @@ handleSemanticRequest(RequestDict Req,
     return findRelatedIdents(*SourceFile, Offset, Args, Rec);
   }
 
+  if (ReqUID == RequestASTMemory)
+    return reportASTMemoryUsage(*SourceFile, Args, Rec);
+
   {
     llvm::raw_svector_ostream OSErr(ErrBuf);
     OSErr << "unknown request: " << UIdentFromSKDUID(ReqUID).getName();
@@ -762,8 +835,11 @@ class SKIndexingConsumer : public IndexingConsumer {
 public:
   std::string ErrorDescription;
 
-  explicit SKIndexingConsumer(ResponseBuilder &RespBuilder) {
-    TopDict = RespBuilder.getDictionary();
+  explicit SKIndexingConsumer(ResponseBuilder &RespBuilder)
+    : SKIndexingConsumer(RespBuilder.getDictionary()) {}
+
+  explicit SKIndexingConsumer(ResponseBuilder::Dictionary Dict) {
+    TopDict = Dict;
 
     // First in stack is the top-level "key.entities" container.
     EntitiesStack.push_back(
@@ -814,6 +890,36 @@ static sourcekitd_response_t indexSource(StringRef Filename,
   return RespBuilder.createResponse();
 }
 
+static sourcekitd_response_t indexSources(ArrayRef<StringRef> Filenames,
+                                          ArrayRef<StringRef> KnownHashes,
+                                          ArrayRef<const char *> Args) {
+  ResponseBuilder RespBuilder;
+  auto Results = RespBuilder.getDictionary().setArray(KeyResults);
+
+  // Each file gets its own entry in 'key.results', with the same contents as
+  // the response of a 'source.request.indexsource' request, or with a
+  // 'key.description' if indexing the file failed.
+  std::unique_ptr<SKIndexingConsumer> IdxConsumer;
+  ResponseBuilder::Dictionary Elem;
+  auto finishElem = [&] {
+    if (IdxConsumer && !IdxConsumer->ErrorDescription.empty())
+      Elem.set(KeyDescription, IdxConsumer->ErrorDescription);
+  };
+
+  LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
+  Lang.indexSources(Filenames, KnownHashes,
+                    [&](unsigned Idx) -> IndexingConsumer & {
+    finishElem();
+    Elem = Results.appendDictionary();
+    Elem.set(KeySourceFile, Filenames[Idx]);
+    IdxConsumer.reset(new SKIndexingConsumer(Elem));
+    return *IdxConsumer;
+  }, Args);
+  finishElem();
+
+  return RespBuilder.createResponse();
+}
+
 void SKIndexingConsumer::failed(StringRef ErrDescription) {
   ErrorDescription = ErrDescription;
 }
@@ -1050,17 +1156,18 @@ static std::string mangleSimpleClass(StringRef moduleName,
                                      StringRef className) {
   using namespace swift::Demangle;
 
-  auto moduleNode = NodeFactory::create(Node::Kind::Module, moduleName);
-  auto IdNode = NodeFactory::create(Node::Kind::Identifier, className);
-  auto classNode = NodeFactory::create(Node::Kind::Class);
-  auto typeNode = NodeFactory::create(Node::Kind::Type);
-  auto typeManglingNode = NodeFactory::create(Node::Kind::TypeMangling);
-  auto globalNode = NodeFactory::create(Node::Kind::Global);
-
-  classNode->addChildren(moduleNode, IdNode);
-  typeNode->addChild(classNode);
-  typeManglingNode->addChild(typeNode);
-  globalNode->addChild(typeManglingNode);
+  NodeFactory Factory;
+  auto moduleNode = Factory.createNode(Node::Kind::Module, moduleName);
+  auto IdNode = Factory.createNode(Node::Kind::Identifier, className);
+  auto classNode = Factory.createNode(Node::Kind::Class);
+  auto typeNode = Factory.createNode(Node::Kind::Type);
+  auto typeManglingNode = Factory.createNode(Node::Kind::TypeMangling);
+  auto globalNode = Factory.createNode(Node::Kind::Global);
+
+  classNode->addChildren(moduleNode, IdNode, Factory);
+  typeNode->addChild(classNode, Factory);
+  typeManglingNode->addChild(typeNode, Factory);
+  globalNode->addChild(typeManglingNode, Factory);
   return mangleNode(globalNode);
 }
 
@@ -1356,6 +1463,33 @@ static void findRelatedIdents(StringRef Filename,
   });
 }
 
+//===----------------------------------------------------------------------===//
+// ASTMemory
+//===----------------------------------------------------------------------===//
+
+static void reportASTMemoryUsage(StringRef Filename,
+                                 ArrayRef<const char *> Args,
+                                 ResponseReceiver Rec) {
+  LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
+  Lang.getASTMemoryUsage(Filename, Args,
+                         [Rec](const ASTMemoryUsageInfo &Info) {
+    if (Info.IsCancelled)
+      return Rec(createErrorRequestCancelled());
+
+    ResponseBuilder RespBuilder;
+    auto Dict = RespBuilder.getDictionary();
+    Dict.set(KeyBytes, int64_t(Info.TotalBytes));
+    auto Arr = Dict.setArray(KeyResults);
+    for (auto &Allocation : Info.Allocations) {
+      auto Elem = Arr.appendDictionary();
+      Elem.set(KeyName, Allocation.first);
+      Elem.set(KeyBytes, int64_t(Allocation.second));
+    }
+
+    Rec(RespBuilder.createResponse());
+  });
+}
+
 //===----------------------------------------------------------------------===//
 // CodeComplete
 //===----------------------------------------------------------------------===//
@@ -1861,6 +1995,17 @@ editorReplaceText(StringRef Name, llvm::MemoryBuffer *Buf, unsigned Offset,
   return EditC.createResponse();
 }
 
+static sourcekitd_response_t
+editorReadRange(StringRef Name, unsigned Offset, unsigned Length,
+                bool EnableSyntaxMap, bool EnableStructure,
+                bool SyntacticOnly) {
+  SKEditorConsumer EditC(EnableSyntaxMap, EnableStructure,
+                         /*EnableDiagnostics=*/false, SyntacticOnly);
+  LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
+  Lang.editorReadRange(Name, Offset, Length, EditC);
+  return EditC.createResponse();
+}
+
 static void
 editorApplyFormatOptions(StringRef Name, RequestDict &FmtOptions) {
   LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
@@ -39,6 +39,7 @@ UIdent sourcekitd::KeyRequest("key.request");
 UIdent sourcekitd::KeyCompilerArgs("key.compilerargs");
 UIdent sourcekitd::KeyOffset("key.offset");
 UIdent sourcekitd::KeySourceFile("key.sourcefile");
+UIdent sourcekitd::KeySourceFiles("key.sourcefiles");
 UIdent sourcekitd::KeySourceText("key.sourcetext");
 UIdent sourcekitd::KeyModuleName("key.modulename");
 UIdent sourcekitd::KeyGroupName("key.groupname");
@@ -131,6 +132,7 @@ UIdent sourcekitd::KeyObsoleted("key.obsoleted");
 UIdent sourcekitd::KeyRemoveCache("key.removecache");
 UIdent sourcekitd::KeyTypeInterface("key.typeinterface");
 UIdent sourcekitd::KeyModuleGroups("key.modulegroups");
+UIdent sourcekitd::KeyBytes("key.bytes");
 
 /// \brief Order for the keys to use when emitting the debug description of
 /// dictionaries.
@@ -164,6 +166,7 @@ static UIdent *OrderedKeys[] = {
   &KeyOffset,
   &KeyLength,
   &KeySourceFile,
+  &KeySourceFiles,
   &KeySourceText,
   &KeyEnableSyntaxMap,
   &KeyEnableStructure,
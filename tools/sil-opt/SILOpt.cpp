@@ -32,11 +32,13 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include <chrono>
 #include <cstdio>
 using namespace swift;
 
@@ -122,6 +124,17 @@ EnableSILVerifyAll("enable-sil-verify-all",
                    llvm::cl::init(true),
                    llvm::cl::desc("Run sil verifications after every pass."));
 
+static llvm::cl::opt<bool>
+ParallelFunctionPasses("sil-parallel-function-passes", llvm::cl::Hidden,
+                       llvm::cl::init(false),
+                       llvm::cl::desc("Run function passes on independent "
+                                      "functions in parallel."));
+
+static llvm::cl::opt<unsigned>
+NumThreads("num-threads", llvm::cl::Hidden, llvm::cl::init(0),
+           llvm::cl::desc("The number of threads used by parallel function "
+                          "passes."));
+
 static llvm::cl::opt<bool>
 RemoveRuntimeAsserts("remove-runtime-asserts",
                      llvm::cl::Hidden,
@@ -160,6 +173,12 @@ ASTVerifierProcessId("ast-verifier-process-id", llvm::cl::Hidden,
 static llvm::cl::opt<bool>
 PerformWMO("wmo", llvm::cl::desc("Enable whole-module optimizations"));
 
+static llvm::cl::opt<unsigned>
+BenchmarkRuns("benchmark-runs", llvm::cl::init(0),
+              llvm::cl::desc("Run the passes this many times, each time on "
+                             "a freshly loaded module, and report the cost "
+                             "of each run instead of printing the module"));
+
 static void runCommandLineSelectedPasses(SILModule *Module) {
   SILPassManager PM(Module);
 
@@ -169,6 +188,98 @@ static void runCommandLineSelectedPasses(SILModule *Module) {
   PM.run();
 }
 
+static void runSelectedPasses(SILModule &Module) {
+  if (OptimizationGroup == OptGroup::Diagnostics) {
+    runSILDiagnosticPasses(Module);
+  } else if (OptimizationGroup == OptGroup::Performance) {
+    runSILOptimizationPasses(Module);
+  } else {
+    runCommandLineSelectedPasses(&Module);
+  }
+}
+
+/// Sets up \p CI for \p Invocation and loads the SIL of the input. Returns
+/// true if that failed.
+static bool loadModule(CompilerInstance &CI, CompilerInvocation &Invocation,
+                       bool HasSerializedAST, bool IsSIB) {
+  if (CI.setup(Invocation))
+    return true;
+
+  CI.performSema();
+
+  // If parsing produced an error, don't run any passes.
+  if (CI.getASTContext().hadError())
+    return true;
+
+  // Load the SIL if we have a module. We have to do this after SILParse
+  // creating the unfortunate double if statement.
+  if (HasSerializedAST) {
+    assert(!CI.hasSILModule() &&
+           "performSema() should not create a SILModule.");
+    CI.setSILModule(SILModule::createEmptyModule(CI.getMainModule(),
+                                                 CI.getSILOptions()));
+    std::unique_ptr<SerializedSILLoader> SL = SerializedSILLoader::create(
+        CI.getASTContext(), CI.getSILModule(), nullptr);
+
+    if (IsSIB)
+      SL->getAllForModule(CI.getMainModule()->getName(), nullptr);
+    else
+      SL->getAll();
+  }
+  return false;
+}
+
+static size_t countInstructions(const SILModule &Module) {
+  size_t Count = 0;
+  for (auto &F : Module)
+    for (auto &BB : F)
+      Count += std::distance(BB.begin(), BB.end());
+  return Count;
+}
+
+/// Runs the passes \c BenchmarkRuns times, each time on a module loaded
+/// anew, since passes change the module they run on. Only the passes are
+/// timed. Returns true if the module could not be loaded.
+static bool runBenchmark(CompilerInvocation &Invocation,
+                         bool HasSerializedAST, bool IsSIB) {
+  std::vector<double> Times;
+  llvm::outs() << "run,time(ms),instructions,instructions after,"
+                  "instructions/s,peak instruction bytes,other bytes\n";
+  for (unsigned Run = 1; Run <= BenchmarkRuns; ++Run) {
+    CompilerInstance CI;
+    PrintingDiagnosticConsumer PrintDiags;
+    CI.addDiagnosticConsumer(&PrintDiags);
+    if (loadModule(CI, Invocation, HasSerializedAST, IsSIB))
+      return true;
+
+    SILModule &Module = *CI.getSILModule();
+    size_t Instructions = countInstructions(Module);
+    size_t OtherBytes = Module.getOtherMemoryUsage();
+
+    auto Start = std::chrono::steady_clock::now();
+    runSelectedPasses(Module);
+    std::chrono::duration<double, std::milli> Time =
+      std::chrono::steady_clock::now() - Start;
+    Times.push_back(Time.count());
+
+    double Throughput =
+      Time.count() > 0 ? Instructions / Time.count() * 1000 : 0;
+    llvm::outs() << Run << ',' << llvm::format("%.3f", Time.count()) << ','
+                 << Instructions << ',' << countInstructions(Module) << ','
+                 << llvm::format("%.0f", Throughput) << ','
+                 << Module.getPeakInstructionMemoryUsage() << ','
+                 << Module.getOtherMemoryUsage() - OtherBytes << '\n';
+  }
+
+  std::sort(Times.begin(), Times.end());
+  double Median = Times[Times.size() / 2];
+  llvm::outs() << "min " << llvm::format("%.3f", Times.front())
+               << " ms, median " << llvm::format("%.3f", Median)
+               << " ms, max " << llvm::format("%.3f", Times.back())
+               << " ms\n";
+  return false;
+}
+
 // This function isn't referenced outside its translation unit, but it
 // can't use the "static" keyword because its address is used for
 // getMainExecutable (since some platforms don't support taking the
@@ -222,6 +333,8 @@ int main(int argc, char **argv) {
   SILOptions &SILOpts = Invocation.getSILOptions();
   SILOpts.InlineThreshold = SILInlineThreshold;
   SILOpts.VerifyAll = EnableSILVerifyAll;
+  SILOpts.ParallelFunctionPasses = ParallelFunctionPasses;
+  SILOpts.NumThreads = NumThreads;
   SILOpts.RemoveRuntimeAsserts = RemoveRuntimeAsserts;
   SILOpts.AssertConfig = AssertConfId;
   if (OptimizationGroup != OptGroup::Diagnostics)
@@ -257,10 +370,6 @@ int main(int argc, char **argv) {
     Invocation.setInputKind(InputFileKind::IFK_SIL);
   }
 
-  CompilerInstance CI;
-  PrintingDiagnosticConsumer PrintDiags;
-  CI.addDiagnosticConsumer(&PrintDiags);
-
   if (!PerformWMO) {
     auto &FrontendOpts = Invocation.getFrontendOptions();
     if (!InputFilename.empty() && InputFilename != "-") {
@@ -272,43 +381,22 @@ int main(int argc, char **argv) {
     }
   }
 
-  if (CI.setup(Invocation))
-    return 1;
+  if (BenchmarkRuns)
+    return runBenchmark(Invocation, HasSerializedAST, extendedInfo.isSIB());
 
-  CI.performSema();
+  CompilerInstance CI;
+  PrintingDiagnosticConsumer PrintDiags;
+  CI.addDiagnosticConsumer(&PrintDiags);
 
-  // If parsing produced an error, don't run any passes.
-  if (CI.getASTContext().hadError())
+  if (loadModule(CI, Invocation, HasSerializedAST, extendedInfo.isSIB()))
     return 1;
 
-  // Load the SIL if we have a module. We have to do this after SILParse
-  // creating the unfortunate double if statement.
-  if (HasSerializedAST) {
-    assert(!CI.hasSILModule() &&
-           "performSema() should not create a SILModule.");
-    CI.setSILModule(SILModule::createEmptyModule(CI.getMainModule(),
-                                                 CI.getSILOptions()));
-    std::unique_ptr<SerializedSILLoader> SL = SerializedSILLoader::create(
-        CI.getASTContext(), CI.getSILModule(), nullptr);
-
-    if (extendedInfo.isSIB())
-      SL->getAllForModule(CI.getMainModule()->getName(), nullptr);
-    else
-      SL->getAll();
-  }
-
   // If we're in verify mode, install a custom diagnostic handling for
   // SourceMgr.
   if (VerifyMode)
     enableDiagnosticVerifier(CI.getSourceMgr());
 
-  if (OptimizationGroup == OptGroup::Diagnostics) {
-    runSILDiagnosticPasses(*CI.getSILModule());
-  } else if (OptimizationGroup == OptGroup::Performance) {
-    runSILOptimizationPasses(*CI.getSILModule());
-  } else {
-    runCommandLineSelectedPasses(CI.getSILModule());
-  }
+  runSelectedPasses(*CI.getSILModule());
 
   if (EmitSIB) {
     llvm::SmallString<128> OutputFile;
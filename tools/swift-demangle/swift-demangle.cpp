@@ -18,12 +18,14 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
-#include "llvm/Support/Regex.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <string>
+#include <thread>
+#include <vector>
 
 static llvm::cl::opt<bool>
 ExpandMode("expand",
@@ -49,11 +51,25 @@ static llvm::cl::opt<bool>
 Simplified("simplified",
            llvm::cl::desc("Don't display module names or implicit self types"));
 
+static llvm::cl::opt<std::string>
+InputFile("input-file",
+          llvm::cl::desc("Demangle the symbols in this file instead of stdin"),
+          llvm::cl::value_desc("filename"), llvm::cl::init("-"));
+
+static llvm::cl::opt<unsigned>
+NumThreads("threads",
+           llvm::cl::desc("Number of threads demangling the symbols of the "
+                          "input (default: the number of cores)"),
+           llvm::cl::init(0));
+
 static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
 
+/// Demangles \p name into \p os. The nodes of the demangling are allocated
+/// in \p factory, which is cleared afterwards.
 static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
+                     swift::Demangle::NodeFactory &factory,
                      const swift::Demangle::DemangleOptions &options) {
   bool hadLeadingUnderscore = false;
   if (name.startswith("__")) {
@@ -61,39 +77,108 @@ static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
     name = name.substr(1);
   }
   swift::Demangle::NodePointer pointer =
-      swift::demangle_wrappers::demangleSymbolAsNode(name);
+      swift::demangle_wrappers::demangleSymbolAsNode(name, factory);
   if (ExpandMode || TreeOnly) {
-    llvm::outs() << "Demangling for " << name << '\n';
-    swift::demangle_wrappers::NodeDumper(pointer).print(llvm::outs());
+    os << "Demangling for " << name << '\n';
+    swift::demangle_wrappers::NodeDumper(pointer).print(os);
   }
   if (RemangleMode) {
-    if (hadLeadingUnderscore) llvm::outs() << '_';
+    if (hadLeadingUnderscore) os << '_';
     // Just reprint the original mangled name if it didn't demangle.
     // This makes it easier to share the same database between the
     // mangling and demangling tests.
     if (!pointer) {
-      llvm::outs() << name;
+      os << name;
     } else {
-      llvm::outs() << swift::Demangle::mangleNode(pointer);
+      os << swift::Demangle::mangleNode(pointer);
     }
-    return;
-  }
-  if (!TreeOnly) {
+  } else if (!TreeOnly) {
     std::string string = swift::Demangle::nodeToString(pointer, options);
     if (!CompactMode)
-      llvm::outs() << name << " ---> ";
-    llvm::outs() << (string.empty() ? name : llvm::StringRef(string));
+      os << name << " ---> ";
+    os << (string.empty() ? name : llvm::StringRef(string));
   }
+  factory.clear();
 }
 
-static llvm::StringRef substrBefore(llvm::StringRef whole,
-                                    llvm::StringRef part) {
-  return whole.slice(0, part.data() - whole.data());
+static bool isSymbolChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$';
 }
 
-static llvm::StringRef substrAfter(llvm::StringRef whole,
-                                   llvm::StringRef part) {
-  return whole.substr((part.data() - whole.data()) + part.size());
+/// Finds the things in \p text which look like mangled names: "_T" followed
+/// by at least one of [_a-zA-Z0-9$], as many as there are. This doesn't
+/// handle Unicode symbols, but maybe that's okay.
+static void findSymbols(llvm::StringRef text,
+                        std::vector<llvm::StringRef> &symbols) {
+  size_t pos = 0;
+  while ((pos = text.find("_T", pos)) != llvm::StringRef::npos) {
+    size_t end = pos + 2;
+    while (end != text.size() && isSymbolChar(text[end]))
+      ++end;
+    if (end == pos + 2) {
+      ++pos;
+      continue;
+    }
+    symbols.push_back(text.slice(pos, end));
+    pos = end;
+  }
+}
+
+/// The minimum number of symbols worth handing to a thread of their own.
+static const size_t MinSymbolsPerThread = 64;
+
+/// Copies \p text to stdout with the mangled names in it demangled.
+///
+/// The names are demangled in contiguous batches by several threads, each
+/// of which writes to a buffer of its own; the buffers are then printed in
+/// order, so the output does not depend on the number of threads.
+static void demangleText(llvm::StringRef text,
+                         const swift::Demangle::DemangleOptions &options) {
+  std::vector<llvm::StringRef> symbols;
+  findSymbols(text, symbols);
+
+  size_t numThreads = NumThreads;
+  if (numThreads == 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  numThreads = std::max<size_t>(1, std::min(numThreads,
+                                            symbols.size() /
+                                              MinSymbolsPerThread));
+  size_t batchSize = (symbols.size() + numThreads - 1) / numThreads;
+
+  // Each batch also prints the text between its symbols, and the text
+  // before its first one.
+  std::vector<std::string> results(numThreads);
+  auto demangleBatch = [&](size_t batch) {
+    size_t begin = std::min(symbols.size(), batch * batchSize);
+    size_t end = std::min(symbols.size(), begin + batchSize);
+    if (begin == end)
+      return;
+    llvm::raw_string_ostream os(results[batch]);
+    swift::Demangle::NodeFactory factory;
+    const char *printed =
+        begin == 0 ? text.data() : symbols[begin - 1].end();
+    for (size_t i = begin; i < end; ++i) {
+      os << llvm::StringRef(printed, symbols[i].data() - printed);
+      demangle(os, symbols[i], factory, options);
+      printed = symbols[i].end();
+    }
+    os.flush();
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t batch = 1; batch < numThreads; ++batch)
+    threads.push_back(std::thread(demangleBatch, batch));
+  demangleBatch(0);
+  for (std::thread &thread : threads)
+    thread.join();
+
+  for (const std::string &result : results)
+    llvm::outs() << result;
+  if (symbols.empty())
+    llvm::outs() << text;
+  else
+    llvm::outs() << text.substr(symbols.back().end() - text.data());
 }
 
 int main(int argc, char **argv) {
@@ -111,26 +196,18 @@ int main(int argc, char **argv) {
 
   if (InputNames.empty()) {
     CompactMode = true;
-    auto input = llvm::MemoryBuffer::getSTDIN();
+    // Input files are memory-mapped rather than read.
+    auto input = llvm::MemoryBuffer::getFileOrSTDIN(InputFile);
     if (!input) {
       llvm::errs() << input.getError().message() << '\n';
       return EXIT_FAILURE;
     }
-    llvm::StringRef inputContents = input.get()->getBuffer();
-
-    // This doesn't handle Unicode symbols, but maybe that's okay.
-    llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
-    llvm::SmallVector<llvm::StringRef, 1> matches;
-    while (maybeSymbol.match(inputContents, &matches)) {
-      llvm::outs() << substrBefore(inputContents, matches.front());
-      demangle(llvm::outs(), matches.front(), options);
-      inputContents = substrAfter(inputContents, matches.front());
-    }
-    llvm::outs() << inputContents;
+    demangleText(input.get()->getBuffer(), options);
 
   } else {
+    swift::Demangle::NodeFactory factory;
     for (llvm::StringRef name : InputNames) {
-      demangle(llvm::outs(), name, options);
+      demangle(llvm::outs(), name, factory, options);
       llvm::outs() << '\n';
     }
   }
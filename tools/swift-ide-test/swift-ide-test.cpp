@@ -1376,8 +1376,9 @@ static int doPrintAST(const CompilerInvocation &InitInvok,
 
   // If we were given a mangled name, do a very simple form of LLDB's logic to
   // look up a type based on that name.
+  Demangle::NodeFactory factory;
   Demangle::NodePointer node =
-    demangle_wrappers::demangleSymbolAsNode(MangledNameToFind);
+    demangle_wrappers::demangleSymbolAsNode(MangledNameToFind, factory);
   using NodeKind = Demangle::Node::Kind;
 
   if (!node) {
@@ -1527,10 +1528,12 @@ static int doPrintLocalTypes(const CompilerInvocation &InitInvok,
     }
 
     // Simulate the demangling / parsing process
+    Demangle::NodeFactory factory;
     for (auto MangledName : MangledNames) {
 
       // Global
-      auto node = demangle_wrappers::demangleSymbolAsNode(MangledName);
+      factory.clear();
+      auto node = demangle_wrappers::demangleSymbolAsNode(MangledName, factory);
 
       // TypeMangling
       node = node->getFirstChild();
@@ -174,6 +174,7 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
     builder.dumpAllSections(OS);
     break;
   case ActionType::DumpTypeLowering: {
+    Demangle::NodeFactory Factory;
     for (std::string line; std::getline(std::cin, line); ) {
       if (line.empty())
         continue;
@@ -181,7 +182,8 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
       if (StringRef(line).startswith("//"))
         continue;
 
-      auto demangled = Demangle::demangleTypeAsNode(line);
+      Factory.clear();
+      auto demangled = Demangle::demangleTypeAsNode(line, Factory);
       auto *typeRef = swift::remote::decodeMangledType(builder, demangled);
       if (typeRef == nullptr) {
         OS << "Invalid typeref: " << line << "\n";
@@ -24,5 +24,6 @@ typedef enum InstanceKind {
   Object,
   Existential,
   ErrorExistential,
-  Closure
+  Closure,
+  RuntimeCounters
 } InstanceKind;
@@ -379,6 +379,20 @@ int reflectExistential(SwiftReflectionContextRef RC,
   return 1;
 }
 
+void printRuntimeCounters(SwiftReflectionContextRef RC) {
+  uint64_t Counts[64];
+  size_t NumCounters = swift_reflection_readRuntimeCounters(RC, Counts, 64);
+  if (NumCounters == 0) {
+    printf("The runtime was built without counters.\n");
+    return;
+  }
+  for (size_t i = 0; i < NumCounters && i < 64; ++i) {
+    const char *Name = swift_reflection_runtimeCounterName(i);
+    printf("%s: %llu\n", Name ? Name : "<unknown>",
+           (unsigned long long)Counts[i]);
+  }
+}
+
 int doDumpHeapInstance(const char *BinaryFilename) {
   PipeMemoryReader Pipe = createPipeMemoryReader();
 
@@ -413,6 +427,9 @@ int doDumpHeapInstance(const char *BinaryFilename) {
       PipeMemoryReader_receiveReflectionInfo(RC, &Pipe);
 
       while (1) {
+        // The child ran since the last request, and may have changed memory
+        // which was read then.
+        swift_reflection_invalidateMemoryCache(RC);
         InstanceKind Kind = PipeMemoryReader_receiveInstanceKind(&Pipe);
         switch (Kind) {
         case Object:
@@ -443,6 +460,11 @@ int doDumpHeapInstance(const char *BinaryFilename) {
           if (!reflectHeapObject(RC, Pipe))
             return EXIT_SUCCESS;
           break;
+        case RuntimeCounters:
+          printf("Reading runtime counters.\n");
+          printRuntimeCounters(RC);
+          PipeMemoryReader_sendDoneMessage(&Pipe);
+          break;
         case None:
           swift_reflection_destroyReflectionContext(RC);
           printf("Done.\n");
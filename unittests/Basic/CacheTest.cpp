@@ -0,0 +1,87 @@
+//===--- CacheTest.cpp - for swift/Basic/Cache.h --------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Cache.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+using namespace swift::sys;
+
+namespace {
+struct Blob {
+  size_t Size;
+};
+} // end anonymous namespace
+
+namespace swift {
+namespace sys {
+template <>
+struct CacheValueCostInfo<Blob> {
+  static size_t getCost(const Blob &Val) { return Val.Size; }
+};
+} // end namespace sys
+} // end namespace swift
+
+// libcache decides by itself when to evict values, and doesn't count
+// lookups.
+#if !defined(__APPLE__)
+
+TEST(Cache, EvictsLeastRecentlyUsed) {
+  Cache<int, Blob> cache{"swift.unittest.cache"};
+  cache.setCostLimit(25);
+
+  cache.set(1, Blob{10});
+  cache.set(2, Blob{10});
+  EXPECT_TRUE(cache.get(1).hasValue());
+
+  // 2 is now the least recently used value.
+  cache.set(3, Blob{10});
+  EXPECT_TRUE(cache.get(1).hasValue());
+  EXPECT_FALSE(cache.get(2).hasValue());
+  EXPECT_TRUE(cache.get(3).hasValue());
+
+  auto stats = cache.getStatistics();
+  EXPECT_EQ(3u, stats.Hits);
+  EXPECT_EQ(1u, stats.Misses);
+  EXPECT_EQ(1u, stats.Evictions);
+  EXPECT_EQ(20u, stats.TotalCost);
+}
+
+TEST(Cache, LoweringTheLimitEvicts) {
+  Cache<int, Blob> cache{"swift.unittest.cache"};
+  cache.set(1, Blob{10});
+  cache.set(2, Blob{20});
+  cache.set(3, Blob{30});
+  EXPECT_EQ(60u, cache.getStatistics().TotalCost);
+
+  cache.setCostLimit(35);
+  EXPECT_FALSE(cache.get(1).hasValue());
+  EXPECT_FALSE(cache.get(2).hasValue());
+  EXPECT_TRUE(cache.get(3).hasValue());
+  EXPECT_EQ(30u, cache.getStatistics().TotalCost);
+  EXPECT_EQ(2u, cache.getStatistics().Evictions);
+}
+
+TEST(Cache, ReplaceAndRemove) {
+  Cache<int, Blob> cache{"swift.unittest.cache"};
+  cache.set(1, Blob{10});
+  cache.set(1, Blob{15});
+  EXPECT_EQ(15u, cache.get(1).getValue().Size);
+  EXPECT_EQ(15u, cache.getStatistics().TotalCost);
+
+  EXPECT_TRUE(cache.remove(1));
+  EXPECT_FALSE(cache.remove(1));
+  EXPECT_EQ(0u, cache.getStatistics().TotalCost);
+  EXPECT_EQ(0u, cache.getStatistics().Evictions);
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "swift/Basic/ClusteredBitVector.h"
+#include "llvm/ADT/APInt.h"
 #include "gtest/gtest.h"
 
 using namespace swift;
@@ -208,3 +209,41 @@ TEST(ClusteredBitVector, FlipAllBig) {
   EXPECT_EQ(true, vec[7]);
   EXPECT_EQ(1u, vec.count());
 }
+
+TEST(ClusteredBitVector, FromAPInt) {
+  llvm::APInt small(23, 7988315);
+  ClusteredBitVector vec = ClusteredBitVector::fromAPInt(small);
+  EXPECT_EQ(23u, vec.size());
+  EXPECT_EQ(true, vec[0]);
+  EXPECT_EQ(false, vec[2]);
+  EXPECT_EQ(small.countPopulation(), vec.count());
+  EXPECT_EQ(small, vec.asAPInt());
+
+  llvm::APInt big = llvm::APInt::getHighBitsSet(163, 40);
+  big.setBit(3);
+  vec = ClusteredBitVector::fromAPInt(big);
+  EXPECT_EQ(163u, vec.size());
+  EXPECT_EQ(true, vec[3]);
+  EXPECT_EQ(false, vec[122]);
+  EXPECT_EQ(true, vec[123]);
+  EXPECT_EQ(true, vec[162]);
+  EXPECT_EQ(41u, vec.count());
+  EXPECT_EQ(big, vec.asAPInt());
+
+  vec = ClusteredBitVector::fromAPInt(llvm::APInt(130, 0));
+  EXPECT_EQ(130u, vec.size());
+  EXPECT_EQ(true, vec.none());
+}
+
+TEST(ClusteredBitVector, AppendFromAPIntAtOffset) {
+  ClusteredBitVector vec;
+  vec.add(5, 0x15);
+  vec.append(ClusteredBitVector::fromAPInt(
+                                   llvm::APInt::getAllOnesValue(100)));
+  EXPECT_EQ(105u, vec.size());
+  EXPECT_EQ(true, vec[0]);
+  EXPECT_EQ(false, vec[1]);
+  EXPECT_EQ(true, vec[5]);
+  EXPECT_EQ(true, vec[104]);
+  EXPECT_EQ(103u, vec.count());
+}
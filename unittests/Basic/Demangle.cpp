@@ -1,5 +1,9 @@
+#include "swift/Basic/Demangle.h"
 #include "swift/Basic/DemangleWrappers.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#include <chrono>
+#include <cstring>
 
 using namespace swift::demangle_wrappers;
 
@@ -11,3 +15,151 @@ TEST(Demangle, DemangleWrappers) {
       demangleSymbolAsString(MangledName));
 }
 
+TEST(Demangle, NodeFactoryOwnsTree) {
+  NodeFactory Factory;
+  EXPECT_EQ(0u, Factory.getBytesAllocated());
+
+  NodePointer Root = swift::Demangle::demangleSymbolAsNode(
+      std::string("_TFC3foo3bar3basfT3zimCS_3zim_T_"), Factory);
+  ASSERT_NE(nullptr, Root);
+  EXPECT_EQ(Node::Kind::Global, Root->getKind());
+  EXPECT_EQ("foo.bar.bas (zim : foo.zim) -> ()",
+            swift::Demangle::nodeToString(Root));
+  EXPECT_EQ("_TFC3foo3bar3basfT3zimCS_3zim_T_",
+            swift::Demangle::mangleNode(Root));
+  size_t BytesForOneTree = Factory.getBytesAllocated();
+  EXPECT_NE(0u, BytesForOneTree);
+
+  // Text payloads are copied into the arena, so the tree doesn't depend on
+  // the lifetime of the mangled string.
+  NodePointer Module = Factory.createNode(Node::Kind::Module,
+                                          std::string("Swift"));
+  EXPECT_EQ("Swift", Module->getText());
+
+  // Growing a child array keeps the existing children.
+  NodePointer List = Factory.createNode(Node::Kind::TypeList);
+  for (unsigned i = 0; i < 100; ++i)
+    List->addChild(Factory.createNode(Node::Kind::Index, i), Factory);
+  ASSERT_EQ(100u, List->getNumChildren());
+  for (unsigned i = 0; i < 100; ++i)
+    EXPECT_EQ(i, List->getChild(i)->getIndex());
+
+  Factory.clear();
+  EXPECT_EQ(0u, Factory.getBytesAllocated());
+  Root = swift::Demangle::demangleSymbolAsNode(
+      std::string("_TFC3foo3bar3basfT3zimCS_3zim_T_"), Factory);
+  ASSERT_NE(nullptr, Root);
+  EXPECT_NE(0u, Factory.getBytesAllocated());
+}
+
+TEST(Demangle, DemangleSimpleSymbol) {
+  static const char *const SimpleSymbols[] = {
+    "_TtSi",
+    "_TtSq",
+    "_TtVs7CString",
+    "_TtCSo8NSObject",
+    "_TtO6Monads6Either",
+    "_TtVCC4main3Foo4Ding3Str",
+    "_TtVSi3Foo",
+    "_TtC13__lldb_expr_13Foo",
+  };
+  using swift::Demangle::DemangleOptions;
+  using swift::Demangle::demangleSimpleSymbol;
+
+  auto Simplified = DemangleOptions::SimplifiedUIDemangleOptions();
+  for (const char *Symbol : SimpleSymbols) {
+    for (auto &Options : {DemangleOptions(), Simplified}) {
+      std::string Expected = swift::Demangle::demangleSymbolAsString(
+          Symbol, strlen(Symbol), Options);
+      char Buffer[64];
+      EXPECT_EQ(Expected.size(),
+                demangleSimpleSymbol(Symbol, strlen(Symbol), Buffer,
+                                     sizeof(Buffer), Options));
+      EXPECT_EQ(Expected, Buffer);
+
+      // A short buffer gets as much of the name as fits.
+      char ShortBuffer[4];
+      EXPECT_EQ(Expected.size(),
+                demangleSimpleSymbol(Symbol, strlen(Symbol), ShortBuffer,
+                                     sizeof(ShortBuffer), Options));
+      EXPECT_EQ(Expected.substr(0, 3), ShortBuffer);
+    }
+  }
+
+  static const char *const OtherSymbols[] = {
+    "_TtC",
+    "_TtSo",
+    "_TtGSqSi_",
+    "_TtV1a1bx",
+    "_TtCXo4main3Foo",
+    "_TFC3foo3bar3basfT3zimCS_3zim_T_",
+  };
+  for (const char *Symbol : OtherSymbols) {
+    char Buffer[64];
+    EXPECT_EQ(0u, demangleSimpleSymbol(Symbol, strlen(Symbol), Buffer,
+                                       sizeof(Buffer)));
+  }
+}
+
+// Not a precise benchmark, but it shows the cost of demangling a batch of
+// symbols with a fresh arena per symbol versus a single arena which is
+// cleared between symbols, which is how batch tools should use the API.
+TEST(Demangle, DemangleBatchBenchmark) {
+  static const char *const Symbols[] = {
+    "_TFC3foo3bar3basfT3zimCS_3zim_T_",
+    "_TWPC3foo3barS_8barrables",
+    "_TFVCC6nested6AClass12AnotherClass7AStruct9aFunctionfT1aSi_S2_",
+    "_TTRXFo_dSi_dGSqSi__XFo_iSi_iGSqSi__",
+    "_TTSg5SiSis3Foos_Sf___TFSqcfT_GSqx_",
+    "_TTSf2dg___TTSf2s_d___TFVs11_StringCoreCfVs13_StringBufferS_",
+  };
+  const unsigned Rounds = 2000;
+
+  std::vector<std::string> Expected;
+  for (const char *Symbol : Symbols)
+    Expected.push_back(swift::Demangle::demangleSymbolAsString(
+        Symbol, strlen(Symbol)));
+
+  auto Start = std::chrono::steady_clock::now();
+  for (unsigned r = 0; r < Rounds; ++r) {
+    for (const char *Symbol : Symbols) {
+      NodeFactory Factory;
+      auto Root = swift::Demangle::demangleSymbolAsNode(Symbol, strlen(Symbol),
+                                                        Factory);
+      ASSERT_NE(nullptr, Root);
+    }
+  }
+  auto FreshArena = std::chrono::steady_clock::now() - Start;
+
+  NodeFactory Factory;
+  Start = std::chrono::steady_clock::now();
+  for (unsigned r = 0; r < Rounds; ++r) {
+    for (const char *Symbol : Symbols) {
+      Factory.clear();
+      auto Root = swift::Demangle::demangleSymbolAsNode(Symbol, strlen(Symbol),
+                                                        Factory);
+      ASSERT_NE(nullptr, Root);
+    }
+  }
+  auto ReusedArena = std::chrono::steady_clock::now() - Start;
+
+  // Make sure the reused arena produced the same trees.
+  unsigned i = 0;
+  for (const char *Symbol : Symbols) {
+    Factory.clear();
+    auto Root = swift::Demangle::demangleSymbolAsNode(Symbol, strlen(Symbol),
+                                                      Factory);
+    EXPECT_EQ(Expected[i++], swift::Demangle::nodeToString(Root));
+  }
+
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+  unsigned NumDemanglings = Rounds * (sizeof(Symbols) / sizeof(Symbols[0]));
+  llvm::outs() << "demangling, fresh arena: "
+               << duration_cast<nanoseconds>(FreshArena).count() /
+                      NumDemanglings
+               << " ns/symbol, reused arena: "
+               << duration_cast<nanoseconds>(ReusedArena).count() /
+                      NumDemanglings
+               << " ns/symbol\n";
+}
@@ -85,3 +85,53 @@ TEST(SourceManager, RangeContains) {
   EXPECT_TRUE(SM.rangeContains(R_ad, R_bc));
 }
 
+
+TEST(SourceManager, LineAndColumn) {
+  SourceManager SM;
+  StringRef Source = "aaa\nbb\n\nc\r\ndd";
+  unsigned ID = SM.addMemBufferCopy(Source);
+  SourceLoc Start = SM.getLocForBufferStart(ID);
+  const char *BufferStart =
+    SM.getLLVMSourceMgr().getMemoryBuffer(ID)->getBufferStart();
+
+  auto check = [&](unsigned Offset, unsigned Line, unsigned Column) {
+    SourceLoc Loc = Start.getAdvancedLoc(Offset);
+    EXPECT_EQ(std::make_pair(Line, Column), SM.getLineAndColumn(Loc));
+    EXPECT_EQ(std::make_pair(Line, Column), SM.getLineAndColumn(Loc, ID));
+    EXPECT_EQ(Line, SM.getLineNumber(Loc));
+    SMLoc RawLoc = SMLoc::getFromPointer(BufferStart + Offset);
+    EXPECT_EQ(SM.getLLVMSourceMgr().getLineAndColumn(RawLoc, ID),
+              std::make_pair(Line, Column));
+  };
+
+  check(0, 1, 1);
+  check(2, 1, 3);
+  check(3, 1, 4);
+  check(4, 2, 1);
+  check(8, 4, 1);
+  // The newline after a carriage return.
+  check(10, 4, 1);
+  check(11, 5, 1);
+  // The end of the buffer.
+  check(13, 5, 3);
+
+  // Go backwards, too.
+  check(5, 2, 2);
+  check(1, 1, 2);
+}
+
+TEST(SourceManager, ResolveFromLineCol) {
+  SourceManager SM;
+  unsigned ID = SM.addMemBufferCopy("aaa\nbb\n\ncc");
+
+  EXPECT_EQ(0u, SM.resolveFromLineCol(ID, 1, 1).getValue());
+  EXPECT_EQ(3u, SM.resolveFromLineCol(ID, 1, 4).getValue());
+  EXPECT_FALSE(SM.resolveFromLineCol(ID, 1, 5).hasValue());
+  EXPECT_EQ(5u, SM.resolveFromLineCol(ID, 2, 2).getValue());
+  EXPECT_EQ(7u, SM.resolveFromLineCol(ID, 3, 1).getValue());
+  EXPECT_FALSE(SM.resolveFromLineCol(ID, 3, 2).hasValue());
+  // The last line doesn't end with a newline.
+  EXPECT_FALSE(SM.resolveFromLineCol(ID, 4, 1).hasValue());
+  EXPECT_FALSE(SM.resolveFromLineCol(ID, 0, 1).hasValue());
+  EXPECT_FALSE(SM.resolveFromLineCol(ID, 1, 0).hasValue());
+}
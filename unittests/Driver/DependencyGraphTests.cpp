@@ -1,4 +1,9 @@
 #include "swift/Driver/DependencyGraph.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace swift;
@@ -790,3 +795,209 @@ TEST(DependencyGraph, ChainedExternalPreMarked) {
   EXPECT_TRUE(graph.isMarked(0));
   EXPECT_FALSE(graph.isMarked(1));
 }
+
+TEST(DependencyGraph, FingerprintsLimitTraversal) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "provides-member: [[x, m], [x, n]]\n"
+                                 "fingerprints-top-level: [[a, a1], [b, b1]]\n"
+                                 "fingerprints-member: [[x, m, m1], "
+                                 "[x, n, n1]]\n"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-member: [[x, m]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(4, "depends-member: [[x, n]]"),
+            LoadResult::UpToDate);
+
+  // Only 'b' and 'x.n' changed.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "provides-member: [[x, m], [x, n]]\n"
+                                 "fingerprints-top-level: [[a, a1], [b, b2]]\n"
+                                 "fingerprints-member: [[x, m, m1], "
+                                 "[x, n, n2]]\n"),
+            LoadResult::UpToDate);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(contains(marked, 2));
+  EXPECT_TRUE(contains(marked, 4));
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_FALSE(graph.isMarked(3));
+}
+
+TEST(DependencyGraph, FingerprintsRemovedAndMissing) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b, c]\n"
+                                 "fingerprints-top-level: [[a, a1], [b, b1], "
+                                 "[c, c1]]\n"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-top-level: [c]"),
+            LoadResult::UpToDate);
+
+  // 'a' is unchanged, 'b' lost its fingerprint, and 'c' was removed.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "fingerprints-top-level: [[a, a1]]\n"),
+            LoadResult::UpToDate);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(contains(marked, 2));
+  EXPECT_TRUE(contains(marked, 3));
+  EXPECT_FALSE(graph.isMarked(1));
+
+  // The changes are only used for the first traversal after a reload.
+  marked.clear();
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_TRUE(contains(marked, 1));
+}
+
+TEST(DependencyGraph, FingerprintsIgnoredAfterMarkedDependency) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0, "provides-top-level: [z]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1,
+                                 "provides-top-level: [a]\n"
+                                 "fingerprints-top-level: [[a, a1]]\n"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-top-level: [z]"),
+            LoadResult::UpToDate);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_TRUE(contains(marked, 3));
+
+  // Node 1 now depends on something that was already marked, so whatever it
+  // provides may have changed, whether or not its fingerprints say so.
+  EXPECT_EQ(graph.loadFromString(1,
+                                 "depends-top-level: [z]\n"
+                                 "provides-top-level: [a]\n"
+                                 "fingerprints-top-level: [[a, a1]]\n"),
+            LoadResult::AffectsDownstream);
+
+  marked.clear();
+  graph.markTransitive(marked, 1);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_TRUE(contains(marked, 2));
+}
+
+static void writeFile(StringRef path, StringRef contents) {
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  ASSERT_FALSE(error);
+  out << contents;
+}
+
+TEST(DependencyGraph, Snapshot) {
+  llvm::SmallString<128> dirPath;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("DependencyGraph-test",
+                                                    dirPath));
+  llvm::SmallString<128> path0 = dirPath, path1 = dirPath, path2 = dirPath;
+  llvm::SmallString<128> snapshotPath = dirPath;
+  llvm::sys::path::append(path0, "0.swiftdeps");
+  llvm::sys::path::append(path1, "1.swiftdeps");
+  llvm::sys::path::append(path2, "2.swiftdeps");
+  llvm::sys::path::append(snapshotPath, "graph.depgraph");
+
+  writeFile(path0, "provides-top-level: [a]\n"
+                   "provides-member: [[b, bb]]\n"
+                   "interface-hash: \"abc\"\n");
+  writeFile(path1, "depends-top-level: [a]\n"
+                   "provides-nominal: [c]\n");
+  writeFile(path2, "depends-nominal: [!private c]\n"
+                   "depends-member: [[b, bb]]\n"
+                   "depends-external: [/foo]\n");
+
+  {
+    DependencyGraph<uintptr_t> graph;
+    EXPECT_EQ(graph.loadFromPath(0, path0), LoadResult::UpToDate);
+    EXPECT_EQ(graph.loadFromPath(1, path1), LoadResult::UpToDate);
+    EXPECT_EQ(graph.loadFromPath(2, path2), LoadResult::UpToDate);
+    EXPECT_FALSE(graph.writeSnapshot(snapshotPath));
+  }
+
+  // The unchanged files are replayed from the snapshot and produce the same
+  // graph.
+  {
+    DependencyGraph<uintptr_t> graph;
+    EXPECT_FALSE(graph.loadSnapshot(snapshotPath));
+    EXPECT_EQ(graph.loadFromPath(0, path0), LoadResult::UpToDate);
+    EXPECT_EQ(graph.loadFromPath(1, path1), LoadResult::UpToDate);
+    EXPECT_EQ(graph.loadFromPath(2, path2), LoadResult::UpToDate);
+
+    auto externals = graph.getExternalDependencies();
+    EXPECT_EQ(1, std::distance(externals.begin(), externals.end()));
+    EXPECT_EQ("/foo", (*externals.begin()).str());
+
+    SmallVector<uintptr_t, 4> marked;
+    graph.markTransitive(marked, 0);
+    EXPECT_EQ(2u, marked.size());
+    EXPECT_TRUE(contains(marked, 1));
+    EXPECT_TRUE(contains(marked, 2));
+    EXPECT_TRUE(graph.isMarked(1));
+    EXPECT_TRUE(graph.isMarked(2));
+
+    // A changed interface hash is still noticed when reloading.
+    writeFile(path0, "provides-top-level: [a]\n"
+                     "interface-hash: \"def\"\n");
+    EXPECT_EQ(graph.loadFromPath(0, path0), LoadResult::AffectsDownstream);
+    EXPECT_FALSE(graph.writeSnapshot(snapshotPath));
+  }
+
+  // A file that changed since the snapshot was written is parsed again.
+  writeFile(path2, "depends-top-level: [a]\n");
+  {
+    DependencyGraph<uintptr_t> graph;
+    EXPECT_FALSE(graph.loadSnapshot(snapshotPath));
+    EXPECT_EQ(graph.loadFromPath(0, path0), LoadResult::UpToDate);
+    EXPECT_EQ(graph.loadFromPath(1, path1), LoadResult::UpToDate);
+    EXPECT_EQ(graph.loadFromPath(2, path2), LoadResult::UpToDate);
+
+    auto externals = graph.getExternalDependencies();
+    EXPECT_EQ(0, std::distance(externals.begin(), externals.end()));
+
+    SmallVector<uintptr_t, 4> marked;
+    graph.markTransitive(marked, 1);
+    EXPECT_EQ(0u, marked.size());
+    EXPECT_FALSE(graph.isMarked(2));
+  }
+
+  // Snapshots that are truncated or not snapshots at all are rejected.
+  llvm::SmallString<128> truncatedPath = dirPath;
+  llvm::sys::path::append(truncatedPath, "truncated.depgraph");
+  {
+    auto buffer = llvm::MemoryBuffer::getFile(snapshotPath);
+    ASSERT_TRUE(bool(buffer));
+    StringRef contents = buffer.get()->getBuffer();
+    writeFile(truncatedPath, contents.substr(0, contents.size() - 1));
+
+    DependencyGraph<uintptr_t> graph;
+    EXPECT_TRUE(graph.loadSnapshot(truncatedPath));
+    EXPECT_TRUE(graph.loadSnapshot(path0));
+    EXPECT_EQ(graph.loadFromPath(0, path0), LoadResult::UpToDate);
+  }
+
+  for (StringRef path : {path0, path1, path2, snapshotPath, truncatedPath})
+    EXPECT_FALSE(llvm::sys::fs::remove(path));
+  EXPECT_FALSE(llvm::sys::fs::remove(dirPath));
+}
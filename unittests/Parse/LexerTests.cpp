@@ -352,3 +352,47 @@ TEST_F(LexerTest, NestedPlaceholder) {
   std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
   EXPECT_EQ("<#aa#>", Toks[2].getText());
 }
+
+TEST_F(LexerTest, SpecialCharactersAtEveryOffset) {
+  // The lexer skips plain characters in chunks, so make sure that characters
+  // which end a comment or string are found at any offset within a chunk.
+  for (unsigned Offset = 0; Offset != 40; ++Offset) {
+    std::string Padding(Offset, 'x');
+    std::string Source = "/* " + Padding + " /* */ */ a // " + Padding +
+                         "\n\"" + Padding + "\\\"\\u{e9}\" b" + Padding +
+                         "\xC3\xA9";
+    std::vector<tok> ExpectedTokens{
+      tok::identifier, tok::string_literal, tok::identifier
+    };
+    std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+    ASSERT_EQ(3U, Toks.size());
+    EXPECT_EQ("a", Toks[0].getText());
+    EXPECT_TRUE(Toks[1].isAtStartOfLine());
+    EXPECT_EQ("\"" + Padding + "\\\"\\u{e9}\"", Toks[1].getText());
+    EXPECT_EQ("b" + Padding + "\xC3\xA9", Toks[2].getText());
+  }
+}
+
+TEST_F(LexerTest, LargeCorpusThroughput) {
+  // Lex a large buffer dominated by doc comments and long string literals.
+  // The running time of this test is a rough measure of lexer throughput.
+  std::string Source;
+  const unsigned NumDecls = 20000;
+  for (unsigned i = 0; i != NumDecls; ++i) {
+    Source += "/// A rather long documentation comment for the declaration\n";
+    Source += "/// which follows, describing it in some detail.\n";
+    Source += "/* Another comment, with an embedded /* nested */ comment. */\n";
+    Source += "let someRatherLongIdentifierName_" + std::to_string(i) +
+              " = \"A long string literal which contains nothing special, "
+              "but goes on for quite a while\"\n";
+  }
+
+  unsigned BufID = SourceMgr.addMemBufferCopy(Source);
+  std::vector<Token> Toks = tokenize(LangOpts, SourceMgr, BufID, 0, 0,
+                                     /*KeepComments=*/false);
+  ASSERT_EQ(NumDecls * 4, Toks.size());
+  EXPECT_EQ(tok::kw_let, Toks[Toks.size() - 4].getKind());
+  EXPECT_EQ("someRatherLongIdentifierName_" + std::to_string(NumDecls - 1),
+            Toks[Toks.size() - 3].getText());
+  EXPECT_EQ(tok::string_literal, Toks.back().getKind());
+}
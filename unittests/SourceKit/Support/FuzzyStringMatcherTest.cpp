@@ -51,6 +51,31 @@ TEST(FuzzyStringMatcher, SingleCharacterMatching) {
   EXPECT_FALSE(FuzzyStringMatcher("a").matchesCandidate(""));
 }
 
+TEST(FuzzyStringMatcher, CharacterMask) {
+  auto mayMatch = [](llvm::StringRef pattern, llvm::StringRef candidate) {
+    return FuzzyStringMatcher(pattern).mayMatchCandidateMask(
+        FuzzyStringMatcher::getCharacterMask(candidate));
+  };
+
+  // Every candidate that matches passes the mask check.
+  EXPECT_TRUE(mayMatch("ASDF", "a_s_d_f"));
+  EXPECT_TRUE(mayMatch("asDf", "xASDF"));
+  EXPECT_TRUE(mayMatch("a1", "A_1"));
+  EXPECT_TRUE(mayMatch(u8"\u2602a", u8"\u2602A"));
+  EXPECT_TRUE(mayMatch("", "abc"));
+  EXPECT_TRUE(mayMatch("", ""));
+
+  // The mask only looks at the characters, not at their order.
+  EXPECT_TRUE(mayMatch("ba", "ab"));
+  EXPECT_FALSE(FuzzyStringMatcher("ba").matchesCandidate("ab"));
+
+  // Candidates missing a character of the pattern are rejected.
+  EXPECT_FALSE(mayMatch("asdf", "asd"));
+  EXPECT_FALSE(mayMatch("a1", "a2"));
+  EXPECT_FALSE(mayMatch("a_", "a"));
+  EXPECT_FALSE(mayMatch("a", ""));
+}
+
 TEST(FuzzyStringMatcher, UnicodeMatching) {
   // Single code point matching.
   EXPECT_TRUE(FuzzyStringMatcher(u8"\u2602a\U0002000Bz")
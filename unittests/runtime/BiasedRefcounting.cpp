@@ -0,0 +1,199 @@
+//===--- BiasedRefcounting.cpp - Biased reference counting tests ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/HeapObject.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+typedef BiasedRefCount::DecrementResult DecrementResult;
+
+template <typename Body>
+static void onOtherThread(Body body) {
+  std::thread thread(body);
+  thread.join();
+}
+
+TEST(BiasedRefcountingTest, owner_retain_release) {
+  BiasedRefCount rc;
+  rc.init();
+  EXPECT_EQ(1u, rc.getCount());
+  rc.increment();
+  rc.increment();
+  EXPECT_EQ(3u, rc.getCount());
+  EXPECT_EQ(DecrementResult::Done, rc.decrementShouldDeallocate());
+  EXPECT_EQ(DecrementResult::Done, rc.decrementShouldDeallocate());
+  EXPECT_FALSE(rc.isMerged());
+  EXPECT_EQ(DecrementResult::Deallocate, rc.decrementShouldDeallocate());
+}
+
+TEST(BiasedRefcountingTest, shared_retain_release) {
+  BiasedRefCount rc;
+  rc.init();
+  onOtherThread([&] {
+    rc.increment();
+    rc.increment();
+    EXPECT_EQ(DecrementResult::Done, rc.decrementShouldDeallocate());
+  });
+  EXPECT_EQ(2u, rc.getCount());
+  EXPECT_FALSE(rc.isMerged());
+
+  // The owner drops its references first; the other thread's reference
+  // keeps the object alive.
+  EXPECT_EQ(DecrementResult::Done, rc.decrementShouldDeallocate());
+  EXPECT_TRUE(rc.isMerged());
+  onOtherThread([&] {
+    EXPECT_EQ(DecrementResult::Deallocate, rc.decrementShouldDeallocate());
+  });
+}
+
+TEST(BiasedRefcountingTest, release_after_merge_is_shared) {
+  BiasedRefCount rc;
+  rc.init();
+  onOtherThread([&] { rc.increment(); });
+  EXPECT_EQ(DecrementResult::Done, rc.decrementShouldDeallocate());
+  EXPECT_TRUE(rc.isMerged());
+
+  // After the merge the former owner uses the shared count.
+  rc.increment();
+  EXPECT_EQ(2u, rc.getCount());
+  EXPECT_EQ(DecrementResult::Done, rc.decrementShouldDeallocate());
+  EXPECT_EQ(DecrementResult::Deallocate, rc.decrementShouldDeallocate());
+}
+
+TEST(BiasedRefcountingTest, handed_over_reference_needs_merge) {
+  BiasedRefCount rc;
+  rc.init();
+  rc.increment();
+
+  // Another thread releases both of the owner's references. Only the first
+  // release which drops the shared count below zero requests a merge.
+  onOtherThread([&] {
+    EXPECT_EQ(DecrementResult::NeedsMerge, rc.decrementShouldDeallocate());
+    EXPECT_EQ(DecrementResult::Done, rc.decrementShouldDeallocate());
+  });
+  EXPECT_FALSE(rc.isMerged());
+  EXPECT_TRUE(rc.merge());
+}
+
+TEST(BiasedRefcountingTest, owner_release_with_pending_merge) {
+  BiasedRefCount rc;
+  rc.init();
+  rc.increment();
+  onOtherThread([&] {
+    EXPECT_EQ(DecrementResult::NeedsMerge, rc.decrementShouldDeallocate());
+  });
+
+  // The pending merge request decides about deallocation.
+  EXPECT_EQ(DecrementResult::Done, rc.decrementShouldDeallocate());
+  EXPECT_TRUE(rc.merge());
+}
+
+TEST(BiasedRefcountingTest, concurrent_retain_release) {
+  BiasedRefCount rc;
+  rc.init();
+  std::atomic<unsigned> deallocations(0);
+  std::atomic<unsigned> mergeRequests(0);
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < 4; ++t) {
+    rc.increment();
+    threads.push_back(std::thread([&] {
+      for (unsigned i = 0; i < 10000; ++i) {
+        rc.increment();
+        EXPECT_EQ(DecrementResult::Done, rc.decrementShouldDeallocate());
+      }
+      // Release the reference the owner handed over.
+      switch (rc.decrementShouldDeallocate()) {
+      case DecrementResult::Done:
+        break;
+      case DecrementResult::Deallocate:
+        ++deallocations;
+        break;
+      case DecrementResult::NeedsMerge:
+        ++mergeRequests;
+        break;
+      }
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(0u, deallocations);
+  EXPECT_EQ(1u, mergeRequests);
+  EXPECT_EQ(DecrementResult::Done, rc.decrementShouldDeallocate());
+  EXPECT_TRUE(rc.merge());
+}
+
+// Microbenchmarks comparing biased and atomic reference counting on
+// retain/release heavy code. Run them with --gtest_also_run_disabled_tests.
+
+static const unsigned BenchmarkIterations = 50000000;
+
+template <typename RefCount, typename Body>
+static double measureNanosecondsPerPair(RefCount &rc, Body body) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < BenchmarkIterations; ++i)
+    body(rc);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+    BenchmarkIterations;
+}
+
+TEST(BiasedRefcountingTest, DISABLED_benchmark_owner_thread) {
+  StrongRefCount atomicRC(StrongRefCount::Initialized);
+  double atomicTime = measureNanosecondsPerPair(atomicRC,
+    [](StrongRefCount &rc) {
+      rc.increment();
+      (void)rc.decrementShouldDeallocate();
+    });
+
+  BiasedRefCount biasedRC;
+  biasedRC.init();
+  double biasedTime = measureNanosecondsPerPair(biasedRC,
+    [](BiasedRefCount &rc) {
+      rc.increment();
+      (void)rc.decrementShouldDeallocate();
+    });
+
+  printf("owner thread retain/release: atomic %.2f ns, biased %.2f ns\n",
+         atomicTime, biasedTime);
+}
+
+TEST(BiasedRefcountingTest, DISABLED_benchmark_shared_thread) {
+  StrongRefCount atomicRC(StrongRefCount::Initialized);
+  double atomicTime = 0;
+  onOtherThread([&] {
+    atomicTime = measureNanosecondsPerPair(atomicRC,
+      [](StrongRefCount &rc) {
+        rc.increment();
+        (void)rc.decrementShouldDeallocate();
+      });
+  });
+
+  BiasedRefCount biasedRC;
+  biasedRC.init();
+  double biasedTime = 0;
+  onOtherThread([&] {
+    biasedTime = measureNanosecondsPerPair(biasedRC,
+      [](BiasedRefCount &rc) {
+        rc.increment();
+        (void)rc.decrementShouldDeallocate();
+      });
+  });
+
+  printf("non-owner thread retain/release: atomic %.2f ns, biased %.2f ns\n",
+         atomicTime, biasedTime);
+}
@@ -0,0 +1,72 @@
+//===--- Heap.cpp - Heap allocation tests ---------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Heap.h"
+#include "swift/Runtime/HeapObject.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+TEST(HeapTest, slowAllocRoundTrip) {
+  for (size_t size = 0; size <= 512; size += 7) {
+    std::vector<void *> blocks;
+    for (unsigned i = 0; i < 8; ++i) {
+      void *block = swift_slowAlloc(size, 7);
+      ASSERT_NE(nullptr, block);
+      EXPECT_EQ(0u, uintptr_t(block) & 7);
+      memset(block, 0xAB, size);
+      blocks.push_back(block);
+    }
+    for (void *block : blocks)
+      swift_slowDealloc(block, size, 7);
+  }
+}
+
+TEST(HeapTest, slowAllocReusesFreedBlocks) {
+  auto before = _swift_getHeapCacheStatistics();
+
+  void *block = swift_slowAlloc(48, 7);
+  swift_slowDealloc(block, 48, 7);
+  void *reused = swift_slowAlloc(40, 7);
+  swift_slowDealloc(reused, 40, 7);
+
+  auto after = _swift_getHeapCacheStatistics();
+
+  // The counters only move if the runtime was built with the heap cache.
+  if (after.Allocations == before.Allocations)
+    return;
+
+  EXPECT_EQ(before.Allocations + 2, after.Allocations);
+  EXPECT_EQ(before.Deallocations + 2, after.Deallocations);
+  EXPECT_EQ(before.DeallocationHits + 2, after.DeallocationHits);
+  EXPECT_EQ(before.AllocationHits + 1, after.AllocationHits);
+  EXPECT_EQ(block, reused);
+}
+
+TEST(HeapTest, slowAllocCountersSurviveThreadExit) {
+  auto before = _swift_getHeapCacheStatistics();
+
+  std::thread([] {
+    for (unsigned i = 0; i < 100; ++i)
+      swift_slowDealloc(swift_slowAlloc(32, 7), 32, 7);
+  }).join();
+
+  auto after = _swift_getHeapCacheStatistics();
+  if (after.Allocations == before.Allocations)
+    return;
+
+  EXPECT_EQ(before.Allocations + 100, after.Allocations);
+  EXPECT_EQ(before.AllocationHits + 99, after.AllocationHits);
+}
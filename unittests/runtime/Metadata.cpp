@@ -248,6 +248,40 @@ TEST(Concurrent, ConcurrentMap) {
   }
 }
 
+TEST(Concurrent, ConcurrentMapFind) {
+  const int numElem = 100;
+
+  struct Entry {
+    size_t Key;
+    Entry(size_t key) : Key(key) {}
+    int compareWithKey(size_t key) const {
+      return (key == Key ? 0 : (key < Key ? -1 : 1));
+    }
+    static size_t getExtraAllocationSize(size_t key) { return 0; }
+  };
+
+  ConcurrentMap<Entry> Map;
+  std::vector<Entry *> Entries;
+  for (int i = 0; i < numElem; i++)
+    Entries.push_back(Map.getOrInsert(size_t(i * 7919)).first);
+
+  // Look up the existing entries concurrently, alternating between keys so
+  // that the last-search cache keeps changing under the readers.
+  auto results = RaceTest<int*>(
+    [&]() -> int* {
+      for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < numElem; i++) {
+          EXPECT_EQ(Entries[i], Map.find(size_t(i * 7919)));
+          EXPECT_EQ(Entries[i], Map.getOrInsert(size_t(i * 7919)).first);
+        }
+      }
+      return nullptr;
+    }
+  );
+
+  EXPECT_EQ(nullptr, Map.find(size_t(1)));
+}
+
 
 TEST(MetadataTest, getGenericMetadata) {
   auto metadataTemplate = (GenericMetadata*) &MetadataTest1;
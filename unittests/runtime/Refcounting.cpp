@@ -117,6 +117,24 @@ TEST(RefcountingTest, retain_release_n) {
   EXPECT_EQ(1u, swift_retainCount(object));
 }
 
+TEST(RefcountingTest, immortal_retain_release) {
+  HeapObject object(&TestClassObjectMetadata, StrongRefCount::Immortal);
+  size_t count = swift_retainCount(&object);
+  swift_release(&object);
+  swift_release_n(&object, 32);
+  swift_nonatomic_release(&object);
+  EXPECT_EQ(count, swift_retainCount(&object));
+  swift_retain(&object);
+  swift_retain_n(&object, 32);
+  swift_nonatomic_retain(&object);
+  EXPECT_EQ(count, swift_retainCount(&object));
+  EXPECT_EQ(&object, swift_tryRetain(&object));
+  EXPECT_EQ(count, swift_retainCount(&object));
+  EXPECT_FALSE(swift_isUniquelyReferenced_nonNull_native(&object));
+  EXPECT_EQ(nullptr, swift_tryPin(&object));
+  EXPECT_FALSE(swift_isDeallocating(&object));
+}
+
 TEST(RefcountingTest, unknown_retain_release_n) {
   size_t value = 0;
   auto object = allocTestObject(&value, 1);
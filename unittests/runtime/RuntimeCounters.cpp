@@ -0,0 +1,113 @@
+//===--- RuntimeCounters.cpp - Runtime performance counter tests ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/RuntimeCounters.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <thread>
+
+using namespace swift;
+
+static uint64_t getCounter(RuntimeCounter counter) {
+  uint64_t counts[NumRuntimeCounters];
+  EXPECT_EQ(size_t(NumRuntimeCounters),
+            swift_getRuntimeCounters(counts, NumRuntimeCounters));
+  return counts[unsigned(counter)];
+}
+
+static void destroyTestObject(HeapObject *object) {
+  swift_deallocObject(object, sizeof(HeapObject), alignof(HeapObject) - 1);
+}
+
+static const FullMetadata<ClassMetadata> TestClassObjectMetadata = {
+  { { &destroyTestObject }, { &_TWVBo } },
+  { { { MetadataKind::Class } }, 0, /*rodata*/ 1,
+  ClassFlags::UsesSwift1Refcounting, nullptr, 0, 0, 0, 0, 0 }
+};
+
+static void retainAndReleaseObjects(unsigned count) {
+  for (unsigned i = 0; i < count; ++i) {
+    auto object = swift_allocObject(&TestClassObjectMetadata,
+                                    sizeof(HeapObject),
+                                    alignof(HeapObject) - 1);
+    swift_retain(object);
+    swift_release(object);
+    swift_release(object);
+  }
+}
+
+TEST(RuntimeCountersTest, names) {
+  EXPECT_STREQ("Retain", swift_getRuntimeCounterName(
+                           unsigned(RuntimeCounter::Retain)));
+  EXPECT_STREQ("MetadataCacheMiss", swift_getRuntimeCounterName(
+                           unsigned(RuntimeCounter::MetadataCacheMiss)));
+  EXPECT_EQ(nullptr, swift_getRuntimeCounterName(NumRuntimeCounters));
+}
+
+TEST(RuntimeCountersTest, countsRetainsAndAllocations) {
+  auto retainsBefore = getCounter(RuntimeCounter::Retain);
+  auto releasesBefore = getCounter(RuntimeCounter::Release);
+  auto allocsBefore = getCounter(RuntimeCounter::AllocObject);
+  auto deallocsBefore = getCounter(RuntimeCounter::DeallocObject);
+
+  retainAndReleaseObjects(10);
+
+  // The counters only move if the runtime was built with them.
+  if (getCounter(RuntimeCounter::AllocObject) == allocsBefore)
+    return;
+
+  EXPECT_EQ(retainsBefore + 10, getCounter(RuntimeCounter::Retain));
+  EXPECT_EQ(releasesBefore + 20, getCounter(RuntimeCounter::Release));
+  EXPECT_EQ(allocsBefore + 10, getCounter(RuntimeCounter::AllocObject));
+  EXPECT_EQ(deallocsBefore + 10, getCounter(RuntimeCounter::DeallocObject));
+}
+
+TEST(RuntimeCountersTest, countersSurviveThreadExit) {
+  auto before = getCounter(RuntimeCounter::AllocObject);
+
+  std::thread([] { retainAndReleaseObjects(100); }).join();
+  // The second thread reuses the counter block of the first one.
+  std::thread([] { retainAndReleaseObjects(100); }).join();
+
+  auto after = getCounter(RuntimeCounter::AllocObject);
+  if (after == before)
+    return;
+
+  EXPECT_EQ(before + 200, after);
+}
+
+#if SWIFT_READWRITELOCK_USES_FUTEX
+TEST(RuntimeCountersTest, countsReadWriteLockAcquisitions) {
+  auto acquiresBefore = getCounter(RuntimeCounter::ReadWriteLockAcquire);
+  auto contentionBefore = getCounter(RuntimeCounter::ReadWriteLockContention);
+
+  ReadWriteLock lock;
+  lock.withReadLock([&] {
+    // A second reader doesn't have to wait, a writer can't get in.
+    EXPECT_TRUE(lock.try_readLock());
+    lock.readUnlock();
+    EXPECT_FALSE(lock.try_writeLock());
+  });
+  lock.withWriteLock([] {});
+
+  auto acquiresAfter = getCounter(RuntimeCounter::ReadWriteLockAcquire);
+  if (acquiresAfter == acquiresBefore)
+    return;
+
+  EXPECT_EQ(acquiresBefore + 3, acquiresAfter);
+  EXPECT_EQ(contentionBefore,
+            getCounter(RuntimeCounter::ReadWriteLockContention));
+}
+#endif
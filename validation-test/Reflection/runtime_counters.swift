@@ -0,0 +1,33 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift -lswiftSwiftReflectionTest %s -o %t/runtime_counters
+// RUN: %target-run %target-swift-reflection-test %t/runtime_counters 2>&1 | FileCheck %s
+// REQUIRES: objc_interop
+// REQUIRES: executable_test
+// REQUIRES: runtime_counters
+
+import SwiftReflectionTest
+
+class TestClass {}
+
+var objects: [AnyObject] = []
+for _ in 0..<100 {
+  objects.append(TestClass())
+}
+for object in objects {
+  let any: Any = object
+  _ = any as? TestClass
+}
+
+reflectRuntimeCounters()
+
+// CHECK: Reading runtime counters.
+// CHECK-NEXT: Retain: {{[1-9][0-9]*}}
+// CHECK-NEXT: Release: {{[1-9][0-9]*}}
+// CHECK-NEXT: AllocObject: {{[1-9][0-9][0-9]+}}
+// CHECK-NEXT: DeallocObject: {{[0-9]+}}
+// CHECK-NEXT: DynamicCast: {{[1-9][0-9][0-9]+}}
+// CHECK-NEXT: MetadataCacheMiss: {{[0-9]+}}
+
+doneReflecting()
+
+// CHECK: Done.
@@ -1042,6 +1042,35 @@ DictionaryTestSuite.test("deleteChainCollision2") {
   assert(d[k6_0]!.value == 1060)
 }
 
+DictionaryTestSuite.test("deleteChainCollisionAcrossGroups") {
+  // Keys with equal hash values have equal hash tags, so lookups have to
+  // compare every key in the chain, which spans several groups of buckets.
+  let keys = (0..<40).map { TestKeyTy(value: $0, hashValue: 0) }
+  let missing = TestKeyTy(value: 1000, hashValue: 0)
+
+  var d = Dictionary<TestKeyTy, TestValueTy>(minimumCapacity: 64)
+  for k in keys {
+    d[k] = TestValueTy(k.value * 10)
+  }
+  for k in keys {
+    expectEqual(k.value * 10, d[k]!.value)
+  }
+  expectEmpty(d[missing])
+
+  for k in keys where k.value % 2 == 0 {
+    d[k] = nil
+  }
+  for k in keys {
+    if k.value % 2 == 0 {
+      expectEmpty(d[k])
+    } else {
+      expectEqual(k.value * 10, d[k]!.value)
+    }
+  }
+  expectEmpty(d[missing])
+  expectEqual(20, d.count)
+}
+
 func uniformRandom(_ max: Int) -> Int {
   // FIXME: this is not uniform.
   return random() % max
@@ -147,5 +147,77 @@ HashingTestSuite.test("overridePerExecutionHashSeed/overflow") {
   _HashingDetail.fixedSeedOverride = 0
 }
 
+let sipHashTestSeed: (UInt64, UInt64) =
+  (0x0706_0504_0302_0100, 0x0f0e_0d0c_0b0a_0908)
+
+func sipHash(bytes: [UInt8], chunkSize: Int) -> Int {
+  var hasher = _Hasher(seed: sipHashTestSeed)
+  bytes.withUnsafeBufferPointer { buffer in
+    var start = 0
+    while start < buffer.count {
+      let count = min(chunkSize, buffer.count - start)
+      hasher.append(bytes: buffer.baseAddress! + start, count: count)
+      start += count
+    }
+  }
+  return hasher.finalize()
+}
+
+HashingTestSuite.test("_Hasher/GoldenValues") {
+  // SipHash-1-3 of the bytes 0, 1, 2, ... with the key 0, 1, 2, ..., 15.
+  let expected: [(count: Int, hash: UInt64)] = [
+    (0, 0xabac_0158_050f_c4dc),
+    (1, 0xc9f4_9bf3_7d57_ca93),
+    (7, 0xd392_7d98_9bb1_1140),
+    (8, 0x3690_9511_8d29_9a8e),
+    (9, 0x25a4_8eb3_6c06_3de4),
+    (16, 0xcc4f_dd1a_7d90_8b66),
+    (31, 0x2370_dd1f_8c21_d1bc),
+  ]
+  for (count, hash) in expected {
+    let bytes = (0..<count).map { UInt8($0) }
+    for chunkSize in [1, 3, 8, 64] {
+      let result = UInt64(bitPattern: Int64(sipHash(bytes: bytes,
+                                                    chunkSize: chunkSize)))
+#if arch(i386) || arch(arm)
+      expectEqual(hash & 0xffff_ffff, result & 0xffff_ffff)
+#else
+      expectEqual(hash, result)
+#endif
+    }
+  }
+}
+
+HashingTestSuite.test("_Hasher/appendWords") {
+  // Appending a word is the same as appending its bytes in little-endian
+  // order, regardless of the bytes appended before.
+  let bytes = (0..<27).map { UInt8($0) }
+  var hasher = _Hasher(seed: sipHashTestSeed)
+  bytes.withUnsafeBufferPointer {
+    hasher.append(bytes: $0.baseAddress!, count: 3)
+  }
+  hasher.append(UInt64(0x0a09_0807_0605_0403))
+  hasher.append(UInt64(0x1211_100f_0e0d_0c0b))
+  hasher.append(UInt64(0x1a19_1817_1615_1413))
+  expectEqual(sipHash(bytes: bytes, chunkSize: 27), hasher.finalize())
+
+  // Int is always appended as a 64-bit word.
+  var intHasher = _Hasher(seed: sipHashTestSeed)
+  intHasher.append(-2)
+  var wordHasher = _Hasher(seed: sipHashTestSeed)
+  wordHasher.append(UInt64.max - 1)
+  expectEqual(wordHasher.finalize(), intHasher.finalize())
+}
+
+HashingTestSuite.test("_Hasher/order") {
+  var h1 = _Hasher()
+  h1.append(1)
+  h1.append(2)
+  var h2 = _Hasher()
+  h2.append(2)
+  h2.append(1)
+  expectNotEqual(h1.finalize(), h2.finalize())
+}
+
 runAllTests()
 
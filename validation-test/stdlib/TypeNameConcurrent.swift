@@ -0,0 +1,45 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+import SwiftPrivatePthreadExtras
+#if os(OSX) || os(iOS)
+import Darwin
+#elseif os(Linux)
+import Glibc
+#endif
+
+var TypeNameTestSuite = TestSuite("TypeNameConcurrent")
+
+protocol P {}
+struct G<T> {}
+struct S : P {}
+class C {}
+
+// Many threads naming the same types, most of them for the first time, must
+// all see the same names.
+func nameTypes(_ : Int) {
+  for _ in 0..<100 {
+    expectEqual("main.G<Swift.Int>", _typeName(G<Int>.self))
+    expectEqual("main.G<main.S>", _typeName(G<S>.self))
+    expectEqual("main.G<main.G<main.C>>", _typeName(G<G<C>>.self))
+    expectEqual("G<G<C>>", _typeName(G<G<C>>.self, qualified: false))
+    expectEqual("(main.S, main.P)", _typeName((S, P).self))
+    expectEqual("main.G<(Swift.Int, main.C)>", _typeName(G<(Int, C)>.self))
+  }
+}
+
+TypeNameTestSuite.test("ConcurrentNames") {
+  var threads: [pthread_t] = []
+  for i in 0..<8 {
+    let (createRet, tid) = _stdlib_pthread_create_block(nil, nameTypes, i)
+    expectEqual(0, createRet)
+    threads.append(tid!)
+  }
+  for tid in threads {
+    let (joinRet, _) = _stdlib_pthread_join(tid, Void.self)
+    expectEqual(0, joinRet)
+  }
+}
+
+runAllTests()